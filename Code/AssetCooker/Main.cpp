@@ -0,0 +1,51 @@
+//-----------------------------------------------------------------------------------
+//Command line front end for the AssetCooker.
+//  AssetCooker <source folder> <output folder> [-threads N] [-force] [-verbose]
+//
+//Debug and Release only compile the cooker, stb_image and XMLParser, so FBX files go through the stand-in step.
+//Tools Debug links the engine with the FBX SDK and cooks real meshes, skeletons and motions.
+//Outside of Visual Studio the portable configuration builds from the Code folder with:
+//  g++ -std=c++11 -O2 -I. AssetCooker/Main.cpp Engine/Tools/AssetCooker.cpp ThirdParty/Parsers/XMLParser.cpp -x c ThirdParty/stb_image.c -lpthread -o AssetCookerApp
+#include "Engine/Tools/AssetCooker.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//-----------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        printf("Usage: AssetCooker <source folder> <output folder> [-threads N] [-force] [-verbose]\n");
+        return 1;
+    }
+
+    unsigned int numThreads = 0;
+    bool forceRebuild = false;
+    bool listEveryFile = false;
+    for (int i = 3; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "-threads") == 0 && i + 1 < argc)
+        {
+            numThreads = (unsigned int)atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-force") == 0)
+        {
+            forceRebuild = true;
+        }
+        else if (strcmp(argv[i], "-verbose") == 0)
+        {
+            listEveryFile = true;
+        }
+        else
+        {
+            printf("Unknown argument '%s'\n", argv[i]);
+            return 1;
+        }
+    }
+
+    AssetCooker cooker(argv[1], argv[2], numThreads);
+    AssetCooker::CookReport report = cooker.Cook(forceRebuild);
+    cooker.PrintReport(report, listEveryFile);
+    return report.numResults[AssetCooker::FAILED] == 0 ? 0 : 2;
+}
@@ -5,8 +5,11 @@
 * 1 - Verbose
 * 2 - Insanely Verbose (Every new, every free)
 * Not defined = no memory tracking
+* The tracker walks callstacks through the Win32 debug help library, so other platforms build without it.
 */
+#if defined(_WIN32)
 #define TRACK_MEMORY 1
+#endif
 
 //Enable Profiling
 //#define PROFILING_ENABLED
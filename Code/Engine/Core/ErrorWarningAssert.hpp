@@ -34,7 +34,7 @@ enum SeverityLevel
 //-----------------------------------------------------------------------------------------------
 void DebuggerPrintf( const char* messageFormat, ... );
 bool IsDebuggerAvailable();
-__declspec( noreturn ) void FatalError( const char* filePath, const char* functionName, int lineNum, const std::string& reasonForError, const char* conditionText=nullptr );
+[[noreturn]] void FatalError( const char* filePath, const char* functionName, int lineNum, const std::string& reasonForError, const char* conditionText=nullptr );
 void RecoverableWarning( const char* filePath, const char* functionName, int lineNum, const std::string& reasonForWarning, const char* conditionText=nullptr );
 void SystemDialogue_Okay( const std::string& messageTitle, const std::string& messageText, SeverityLevel severity );
 bool SystemDialogue_OkayCancel( const std::string& messageTitle, const std::string& messageText, SeverityLevel severity );
@@ -1,7 +1,7 @@
 #pragma once
 
 #include <vector>
-#include "Engine\Core\Memory\UntrackedAllocator.hpp"
+#include "Engine/Core/Memory/UntrackedAllocator.hpp"
 
 template <typename ...Args>
 class Event
@@ -40,27 +40,27 @@ public:
     //FUNCTIONS/////////////////////////////////////////////////////////////////////
     void RegisterFunction(FunctionCallback* cb)
     {
-        RegisterSubscription(&EventFunctionCallback, cb, nullptr);
+        RegisterSubscription((void*)&EventFunctionCallback, cb, nullptr);
     }
 
     //-----------------------------------------------------------------------------------
     void UnregisterFunction(FunctionCallback* cb)
     {
-        UnregisterSubscription(&EventFunctionCallback, cb, nullptr);
+        UnregisterSubscription((void*)&EventFunctionCallback, cb, nullptr);
     }
 
     //-----------------------------------------------------------------------------------
     template <typename T>
     void RegisterMethod(T* object, void (T::*methodCallback)(Args...))
     {
-        RegisterSubscription(&MethodCallback<T, decltype(methodCallback)>, methodCallback, object);
+        RegisterSubscription((void*)&MethodCallback<T, decltype(methodCallback)>, methodCallback, object);
     }
 
     //-----------------------------------------------------------------------------------
     template <typename T>
     void UnregisterMethod(T* object, void (T::*methodCallback)(Args...))
     {
-        UnregisterSubscription(&MethodCallback<T, decltype(methodCallback)>, methodCallback, object);
+        UnregisterSubscription((void*)&MethodCallback<T, decltype(methodCallback)>, methodCallback, object);
     }
 
     //-----------------------------------------------------------------------------------
@@ -2,6 +2,7 @@
 #include "Engine/Time/Time.hpp"
 #include "Engine/Input/Logging.hpp"
 #include <atomic>
+#include <limits.h>
 
 JobSystem* JobSystem::instance = nullptr;
 std::atomic<int> gThreadNumber = 0;
@@ -26,8 +27,7 @@ void GenericJobThread()
     while (JobSystem::instance->m_isRunning)
     {
         consumer.ConsumeAll();
-        Sleep(100);
-        SwitchToThread();
+        JobSystem::instance->WaitForWork(100);
     }
 
     //In case we got a job in after yielding and cleaning up
@@ -48,6 +48,9 @@ JobSystem::JobSystem(int numExtraThreads)
     , m_jobAllocator(1024)
     , m_numberOfThreads(0)
 {
+    InitializeCriticalSection(&m_jobAllocatorLock);
+    m_workAvailableSemaphore = CreateSemaphore(nullptr, 0, LONG_MAX, nullptr);
+
     unsigned int numJobTypes = (unsigned int)JobType::NUM_TYPES;
     for (unsigned int i = 0; i < numJobTypes; ++i)
     {
@@ -65,6 +68,8 @@ JobSystem::~JobSystem()
     {
         delete queue;
     }
+    CloseHandle(m_workAvailableSemaphore);
+    DeleteCriticalSection(&m_jobAllocatorLock);
 }
 
 //-----------------------------------------------------------------------------------
@@ -83,6 +88,7 @@ void JobSystem::Initialize()
 void JobSystem::Shutdown()
 {
     m_isRunning = false;
+    ReleaseSemaphore(m_workAvailableSemaphore, (LONG)m_threadPool.size(), nullptr);
 
     //Stop all threads running
     for (std::thread* thread : m_threadPool)
@@ -107,7 +113,9 @@ void JobSystem::Shutdown()
 //-----------------------------------------------------------------------------------
 Job* JobSystem::CreateJob(JobWorkFunction* jobWorkFunction, void* data, JobCallbackFunction* finishedCallback)
 {
+    EnterCriticalSection(&m_jobAllocatorLock);
     Job* newJob = m_jobAllocator.Alloc<Job>();
+    LeaveCriticalSection(&m_jobAllocatorLock);
     newJob->workFunction = jobWorkFunction;
     newJob->data = data;
     newJob->finishedCallback = finishedCallback;
@@ -118,6 +126,7 @@ Job* JobSystem::CreateJob(JobWorkFunction* jobWorkFunction, void* data, JobCallb
 void JobSystem::DispatchJob(JobType jobType, Job* jobToDispatch)
 {
     m_jobQueues[jobType]->Enqueue(jobToDispatch);
+    ReleaseSemaphore(m_workAvailableSemaphore, 1, nullptr);
 }
 
 //-----------------------------------------------------------------------------------
@@ -129,7 +138,16 @@ void JobSystem::CreateAndDispatchJob(JobType jobType, JobWorkFunction* jobWorkFu
 //-----------------------------------------------------------------------------------
 void JobSystem::ReleaseJob(Job* finishedJob)
 {
+    EnterCriticalSection(&m_jobAllocatorLock);
     m_jobAllocator.Free(finishedJob);
+    LeaveCriticalSection(&m_jobAllocatorLock);
+}
+
+//-----------------------------------------------------------------------------------
+//Blocks the calling worker until a job is dispatched or the timeout passes.
+void JobSystem::WaitForWork(unsigned int maxMilliseconds)
+{
+    WaitForSingleObject(m_workAvailableSemaphore, maxMilliseconds);
 }
 
 //-----------------------------------------------------------------------------------
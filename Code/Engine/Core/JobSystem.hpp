@@ -51,6 +51,7 @@ public:
     void DispatchJob(JobType jobType, Job* jobToDispatch);
     void CreateAndDispatchJob(JobType jobType, JobWorkFunction* jobWorkFunction, void* data, JobCallbackFunction* finishedCallback = nullptr);
     void ReleaseJob(Job* finishedJob);
+    void WaitForWork(unsigned int maxMilliseconds);
 
     //STATIC VARIABLES/////////////////////////////////////////////////////////////////////
     static JobSystem* instance;
@@ -66,6 +67,8 @@ private:
     //MEMBER VARIABLES/////////////////////////////////////////////////////////////////////
     std::vector<std::thread*> m_threadPool;
     ObjectPool<Job> m_jobAllocator;
+    CRITICAL_SECTION m_jobAllocatorLock; //Jobs are released on worker threads while the main thread creates them.
+    HANDLE m_workAvailableSemaphore; //Signaled once per dispatched job so idle workers wake immediately.
     unsigned int m_numberOfThreads;
 };
 
@@ -40,6 +40,7 @@ void operator delete[](void *ptr)
 MemoryAnalytics::MemoryAnalytics()
     : m_isInitialized(false)
     , m_numberOfAllocations(0)
+    , m_totalNumberOfAllocations(0)
     , m_numberOfBytes(0)
     , m_startupNumberOfAllocations(0)
     , m_numberOfShaderAllocations(0)
@@ -96,6 +97,7 @@ void* MemoryAnalytics::Allocate(const size_t numBytes)
     AttemptLock();
     {
         ++m_numberOfAllocations;
+        ++m_totalNumberOfAllocations;
         m_numberOfBytes += numBytes;
         if (m_numberOfBytes > m_highwaterInBytes)
         {
@@ -104,6 +104,7 @@ public:
     bool m_isInitialized;
     unsigned int m_startupNumberOfAllocations;
     unsigned int m_numberOfAllocations;
+    size_t m_totalNumberOfAllocations; //Never goes down, so the difference across a stretch of code is how many times it allocated
     unsigned int m_numberOfShaderAllocations;
     unsigned int m_numberOfVAOAllocations;
     unsigned int m_numberOfRenderBufferAllocations;
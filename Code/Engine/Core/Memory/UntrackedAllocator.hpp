@@ -1,7 +1,9 @@
 #pragma once
 #undef max
 #include <limits.h>
-#include <xmemory0>
+#include <memory>
+#include <limits>
+#include <stdlib.h>
 #include <string>
 #include <iosfwd>
 
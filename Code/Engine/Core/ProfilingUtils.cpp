@@ -157,7 +157,8 @@ void ProfilingSystem::PrintNodeListView(ProfileSample* root, unsigned int depth)
     std::string tag = Stringf("%s%s", std::string(depth, '-').c_str(), root->id);
     float msTaken = root->GetDurationInSeconds() * 1000.0f;
     float percentageTaken = (root->GetDurationInSeconds() / GetLastFrame()->GetDurationInSeconds()) * 100.0f;
-    Console::instance->PrintLine(Stringf("%-30s%12i%12i%12i%10.02fms%10.02f%%\n", tag.c_str(), root->numDrawCalls, root->numAllocs, root->sizeAllocs, msTaken, percentageTaken), RGBA(root->startCount, 1.0f, root->endCount, 1.0f));
+    Console::instance->PrintLine(Stringf("%-30s%12i%12i%12i%12i%12i%12i%12i%10.01fms%10.01f%%%10.02fms%10.02f%%\n", tag.c_str(), root->numDrawCalls, root->numAllocs, root->sizeAllocs, root->numNetBytesSent, root->numNetBytesReceived,
+        root->numNetResends, root->numNetUnsentReliables, root->netRoundTripMs, root->netLossRate * 100.0f, msTaken, percentageTaken), RGBA(root->startCount, 1.0f, root->endCount, 1.0f));
 
     ProfileSample* currentChild = root->children;
     while (currentChild != nullptr)
@@ -176,7 +177,7 @@ void ProfilingSystem::PrintTreeListView()
 {
     if (m_previousFrameRoot)
     {
-        Console::instance->PrintLine(Stringf("%-30s%12s%12s%12s%12s%11s", "TAG", "NUM DRAWS", "NUM ALLOCS", "SIZE ALLOCS", "TIME", "%FRAME"));
+        Console::instance->PrintLine(Stringf("%-30s%12s%12s%12s%12s%12s%12s%12s%12s%11s%12s%11s", "TAG", "NUM DRAWS", "NUM ALLOCS", "SIZE ALLOCS", "NET SENT", "NET RECV", "RESENDS", "UNSENT", "RTT", "LOSS", "TIME", "%FRAME"));
         PrintNodeListView(m_previousFrameRoot, 0);
         GenerateProfilingReport();
     }
@@ -242,10 +243,11 @@ void ProfilingSystem::GenerateProfilingReport()
     DebuggerPrintf("---===Frame impact report===---\n");
     DebuggerPrintf("Frame %i's time: %10.02fms\n", g_frameNumber, m_previousFrameRoot->GetDurationInSeconds() * 1000.0f);
     DebuggerPrintf("///TOP///\n");
-    DebuggerPrintf("%-25s%12s%12s%12s%12s%12s%12s%12s%12s%11s\n", "TAG", "NUM CALLS", "NUM DRAWS", "NUM ALLOCS", "SIZE ALLOCS", "SELF TIME", "TOTAL TIME", "MAX TIME", "AVG TIME", "PERCENTAGE");
+    DebuggerPrintf("%-25s%12s%12s%12s%12s%12s%12s%12s%12s%12s%11s%12s%12s%12s%12s%11s\n", "TAG", "NUM CALLS", "NUM DRAWS", "NUM ALLOCS", "SIZE ALLOCS", "NET SENT", "NET RECV", "RESENDS", "UNSENT", "MAX RTT", "MAX LOSS", "SELF TIME", "TOTAL TIME", "MAX TIME", "AVG TIME", "PERCENTAGE");
     for (ProfileReportNode& node : g_profilingResults)
     {
-        DebuggerPrintf("%-25s%12i%12i%12i%12i%10.02fms%10.02fms%10.02fms%10.02fms%10.02f%%\n", node.m_id, (int)node.m_numSamples, node.m_numDrawCalls, node.m_numAllocs, node.m_sizeAllocs, (float)node.m_totalSelfTime * 1000.0f, (float)node.m_totalTime * 1000.0f, (float)node.m_maxTime * 1000.0f, (float)node.m_averageTime * 1000.0f, node.m_framePercentage * 100.0f);
+        DebuggerPrintf("%-25s%12i%12i%12i%12i%12i%12i%12i%12i%10.01fms%10.01f%%%10.02fms%10.02fms%10.02fms%10.02fms%10.02f%%\n", node.m_id, (int)node.m_numSamples, node.m_numDrawCalls, node.m_numAllocs, node.m_sizeAllocs, node.m_numNetBytesSent, node.m_numNetBytesReceived,
+            node.m_numNetResends, node.m_numNetUnsentReliables, node.m_maxNetRoundTripMs, node.m_maxNetLossRate * 100.0f, (float)node.m_totalSelfTime * 1000.0f, (float)node.m_totalTime * 1000.0f, (float)node.m_maxTime * 1000.0f, (float)node.m_averageTime * 1000.0f, node.m_framePercentage * 100.0f);
     }
     DebuggerPrintf("///BOTTOM///\n");
     DebuggerPrintf("---===End of Frame impact report===---\n");
@@ -285,6 +287,35 @@ double PerformanceCountToSeconds(uint64_t& performanceCount)
     return currentSeconds;
 }
 
+//-----------------------------------------------------------------------------------
+//Called once per connection that sent while this sample was active
+void ProfileSample::AddNetConnection(uint32_t numResends, uint32_t numUnsentReliables, uint32_t numUnconfirmedReliables, float roundTripMs, float lossRate)
+{
+    numNetResends += numResends;
+    numNetUnsentReliables += numUnsentReliables;
+    numNetUnconfirmedReliables += numUnconfirmedReliables;
+    netRoundTripMs = (roundTripMs > netRoundTripMs) ? roundTripMs : netRoundTripMs;
+    netLossRate = (lossRate > netLossRate) ? lossRate : netLossRate;
+}
+
+//-----------------------------------------------------------------------------------
+void ProfileSample::SumNetCounters(ProfileSample& outTotals) const
+{
+    outTotals.numNetBytesSent += numNetBytesSent;
+    outTotals.numNetBytesReceived += numNetBytesReceived;
+    outTotals.AddNetConnection((uint32_t)numNetResends, (uint32_t)numNetUnsentReliables, (uint32_t)numNetUnconfirmedReliables, netRoundTripMs, netLossRate);
+    const ProfileSample* currentChild = children;
+    while (currentChild != nullptr)
+    {
+        currentChild->SumNetCounters(outTotals);
+        currentChild = currentChild->next;
+        if (currentChild == children)
+        {
+            break;
+        }
+    }
+}
+
 //-----------------------------------------------------------------------------------
 void ProfileReportNode::AddSample(ProfileSample* otherSample)
 {
@@ -292,6 +323,12 @@ void ProfileReportNode::AddSample(ProfileSample* otherSample)
     m_sizeAllocs += otherSample->numAllocs;
     m_numAllocs += otherSample->numAllocs;
     m_numDrawCalls += otherSample->numDrawCalls;
+    m_numNetBytesSent += otherSample->numNetBytesSent;
+    m_numNetBytesReceived += otherSample->numNetBytesReceived;
+    m_numNetResends += otherSample->numNetResends;
+    m_numNetUnsentReliables += otherSample->numNetUnsentReliables;
+    m_maxNetRoundTripMs = (otherSample->netRoundTripMs > m_maxNetRoundTripMs) ? otherSample->netRoundTripMs : m_maxNetRoundTripMs;
+    m_maxNetLossRate = (otherSample->netLossRate > m_maxNetLossRate) ? otherSample->netLossRate : m_maxNetLossRate;
     m_lastTime = sampleTime;
     m_minTime = (sampleTime < m_minTime) ? sampleTime : m_minTime;
     m_maxTime = (sampleTime > m_maxTime) ? sampleTime : m_maxTime;
@@ -28,6 +28,8 @@ struct ProfileSample
     ProfileSample() : id(nullptr), startCount(0), endCount(0), parent(nullptr), children(nullptr), prev(nullptr), next(nullptr) {};
     inline double GetDurationInSeconds() { return PerformanceCountToSeconds(endCount) - PerformanceCountToSeconds(startCount); };
     inline void AddAllocation(size_t allocationSize) { sizeAllocs += allocationSize; ++numAllocs; };
+    void AddNetConnection(uint32_t numResends, uint32_t numUnsentReliables, uint32_t numUnconfirmedReliables, float roundTripMs, float lossRate);
+    void SumNetCounters(ProfileSample& outTotals) const; //This sample's network counters plus all of its children's, worst round trip and loss
     //inline void GetDurationInSeconds(ProfileSample* other) { PerformanceCountToSeconds(endCount) - PerformanceCountToSeconds(startCount); };
 
     //MEMBER VARIABLES/////////////////////////////////////////////////////////////////////
@@ -42,6 +44,13 @@ struct ProfileSample
     size_t sizeAllocs = 0;
     size_t numAllocs = 0;
     size_t numDrawCalls = 0;
+    size_t numNetBytesSent = 0; //Packets handed to the transport while this sample was active
+    size_t numNetBytesReceived = 0;
+    size_t numNetResends = 0; //Reliables sent again by connections that sent while this sample was active
+    size_t numNetUnsentReliables = 0; //Queue depths summed over those connections, as of their packet
+    size_t numNetUnconfirmedReliables = 0;
+    float netRoundTripMs = 0.0f; //The worst of those connections'
+    float netLossRate = 0.0f;
     //unsigned int numCalls;
     //double averageTime = -1.0;
 };
@@ -67,6 +76,12 @@ public:
     size_t m_sizeAllocs = 0;
     size_t m_numAllocs = 0;
     size_t m_numDrawCalls = 0;
+    size_t m_numNetBytesSent = 0;
+    size_t m_numNetBytesReceived = 0;
+    size_t m_numNetResends = 0;
+    size_t m_numNetUnsentReliables = 0;
+    float m_maxNetRoundTripMs = 0.0f;
+    float m_maxNetLossRate = 0.0f;
     float m_framePercentage = 0.0f;
     uint64_t m_start;
     uint64_t m_end;
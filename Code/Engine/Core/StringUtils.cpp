@@ -14,7 +14,7 @@ const char* CStringf(const char* format, ...)
 	char* textLiteral = new char[STRINGF_STACK_LOCAL_TEMP_LENGTH];
 	va_list variableArgumentList;
 	va_start(variableArgumentList, format);
-	vsnprintf_s(textLiteral, STRINGF_STACK_LOCAL_TEMP_LENGTH, _TRUNCATE, format, variableArgumentList);
+	vsnprintf(textLiteral, STRINGF_STACK_LOCAL_TEMP_LENGTH, format, variableArgumentList);
 	va_end(variableArgumentList);
 	textLiteral[STRINGF_STACK_LOCAL_TEMP_LENGTH - 1] = '\0'; // In case vsnprintf overran (doesn't auto-terminate)
 
@@ -27,7 +27,7 @@ const std::string Stringf( const char* format, ... )
 	char textLiteral[ STRINGF_STACK_LOCAL_TEMP_LENGTH ];
 	va_list variableArgumentList;
 	va_start( variableArgumentList, format );
-	vsnprintf_s( textLiteral, STRINGF_STACK_LOCAL_TEMP_LENGTH, _TRUNCATE, format, variableArgumentList );	
+	vsnprintf( textLiteral, STRINGF_STACK_LOCAL_TEMP_LENGTH, format, variableArgumentList );	
 	va_end( variableArgumentList );
 	textLiteral[ STRINGF_STACK_LOCAL_TEMP_LENGTH - 1 ] = '\0'; // In case vsnprintf overran (doesn't auto-terminate)
 
@@ -44,7 +44,7 @@ const std::string Stringf( const int maxLength, const char* format, ... )
 
 	va_list variableArgumentList;
 	va_start( variableArgumentList, format );
-	vsnprintf_s( textLiteral, maxLength, _TRUNCATE, format, variableArgumentList );	
+	vsnprintf( textLiteral, maxLength, format, variableArgumentList );	
 	va_end( variableArgumentList );
 	textLiteral[ maxLength - 1 ] = '\0'; // In case vsnprintf overran (doesn't auto-terminate)
 
@@ -0,0 +1,268 @@
+#include "Engine/DataStructures/BitPacker.hpp"
+#include "Engine/DataStructures/BytePacker.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Math/Quaternion.hpp"
+#include "Engine/Math/Vector3.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include <cmath>
+
+//-----------------------------------------------------------------------------------
+BitPacker::BitPacker()
+    : IBinaryReader(IBinaryReader::Endianness::BIG_ENDIAN)
+    , IBinaryWriter(IBinaryWriter::Endianness::BIG_ENDIAN)
+    , m_buffer(nullptr)
+    , m_writeSizeMaxBits(0)
+    , m_readSizeMaxBits(0)
+    , m_bitOffset(0)
+    , m_hasOverflowed(false)
+{
+}
+
+//-----------------------------------------------------------------------------------
+//Always big endian, like the packets it ends up in
+BitPacker::BitPacker(void* buffer, size_t writeSizeMaxBytes, size_t readSizeMaxBytes)
+    : IBinaryReader(IBinaryReader::Endianness::BIG_ENDIAN)
+    , IBinaryWriter(IBinaryWriter::Endianness::BIG_ENDIAN)
+    , m_buffer((byte*)buffer)
+    , m_writeSizeMaxBits(writeSizeMaxBytes * 8)
+    , m_readSizeMaxBits(readSizeMaxBytes * 8)
+    , m_bitOffset(0)
+    , m_hasOverflowed(false)
+{
+}
+
+//-----------------------------------------------------------------------------------
+//Fills the current byte, then whole bytes, then the top of the last byte. Bits past the end of what's written are left alone.
+void BitPacker::WriteBits(uint32_t value, unsigned int numBits)
+{
+    ASSERT_OR_DIE(numBits <= 32, "Can only write up to 32 bits at a time");
+    ASSERT_OR_DIE(GetWritableBits() >= numBits, "Attempted to write more bits than we had room for");
+    if (numBits < 32)
+    {
+        value &= (1u << numBits) - 1;
+    }
+    while (numBits > 0)
+    {
+        unsigned int bitsFreeInByte = 8 - (unsigned int)(m_bitOffset & 7);
+        unsigned int bitsNow = (numBits < bitsFreeInByte) ? numBits : bitsFreeInByte;
+        unsigned int shift = bitsFreeInByte - bitsNow;
+        byte chunk = (byte)((value >> (numBits - bitsNow)) & ((1u << bitsNow) - 1));
+        byte mask = (byte)(((1u << bitsNow) - 1) << shift);
+        byte& destination = m_buffer[m_bitOffset >> 3];
+        destination = (byte)((destination & ~mask) | (chunk << shift));
+        m_bitOffset += bitsNow;
+        numBits -= bitsNow;
+    }
+}
+
+//-----------------------------------------------------------------------------------
+uint32_t BitPacker::ReadBits(unsigned int numBits)
+{
+    ASSERT_OR_DIE(numBits <= 32, "Can only read up to 32 bits at a time");
+    if (m_hasOverflowed || GetReadableBits() < numBits)
+    {
+        m_hasOverflowed = true;
+        return 0;
+    }
+    uint32_t value = 0;
+    while (numBits > 0)
+    {
+        unsigned int bitsLeftInByte = 8 - (unsigned int)(m_bitOffset & 7);
+        unsigned int bitsNow = (numBits < bitsLeftInByte) ? numBits : bitsLeftInByte;
+        unsigned int shift = bitsLeftInByte - bitsNow;
+        uint32_t chunk = (m_buffer[m_bitOffset >> 3] >> shift) & ((1u << bitsNow) - 1);
+        value = (value << bitsNow) | chunk;
+        m_bitOffset += bitsNow;
+        numBits -= bitsNow;
+    }
+    return value;
+}
+
+//-----------------------------------------------------------------------------------
+void BitPacker::WriteBool(bool value)
+{
+    WriteBits(value ? 1 : 0, 1);
+}
+
+//-----------------------------------------------------------------------------------
+bool BitPacker::ReadBool()
+{
+    return ReadBits(1) != 0;
+}
+
+//-----------------------------------------------------------------------------------
+void BitPacker::WriteFloat(float value)
+{
+    uint32_t bits = 0;
+    memcpy(&bits, &value, sizeof(bits));
+    WriteBits(bits, 32);
+}
+
+//-----------------------------------------------------------------------------------
+float BitPacker::ReadFloat()
+{
+    uint32_t bits = ReadBits(32);
+    float value = 0.0f;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+//-----------------------------------------------------------------------------------
+//Maps the range onto 2^numBits evenly spaced steps with both ends exactly representable, so 0 in a symmetric range only lands
+//exactly if there's an odd number of steps. Done in double so 32 bit quantization doesn't lose the bottom bits to float.
+void BitPacker::WriteQuantizedFloat(float value, float minValue, float maxValue, unsigned int numBits)
+{
+    ASSERT_OR_DIE(numBits >= 1 && numBits <= 32 && maxValue > minValue, "Invalid quantization range");
+    double maxStep = (double)((1ull << numBits) - 1);
+    double fraction = ((double)Clamp<float>(value, minValue, maxValue) - (double)minValue) / ((double)maxValue - (double)minValue);
+    WriteBits((uint32_t)floor((fraction * maxStep) + 0.5), numBits);
+}
+
+//-----------------------------------------------------------------------------------
+float BitPacker::ReadQuantizedFloat(float minValue, float maxValue, unsigned int numBits)
+{
+    ASSERT_OR_DIE(numBits >= 1 && numBits <= 32 && maxValue > minValue, "Invalid quantization range");
+    double maxStep = (double)((1ull << numBits) - 1);
+    double fraction = (double)ReadBits(numBits) / maxStep;
+    return (float)((double)minValue + (fraction * ((double)maxValue - (double)minValue)));
+}
+
+//-----------------------------------------------------------------------------------
+//A 2 bit size class picks 4, 8, 16 or 32 bits for the value
+void BitPacker::WriteVarUInt(uint32_t value)
+{
+    if (value < (1u << 4))
+    {
+        WriteBits(0, 2);
+        WriteBits(value, 4);
+    }
+    else if (value < (1u << 8))
+    {
+        WriteBits(1, 2);
+        WriteBits(value, 8);
+    }
+    else if (value < (1u << 16))
+    {
+        WriteBits(2, 2);
+        WriteBits(value, 16);
+    }
+    else
+    {
+        WriteBits(3, 2);
+        WriteBits(value, 32);
+    }
+}
+
+//-----------------------------------------------------------------------------------
+uint32_t BitPacker::ReadVarUInt()
+{
+    static const unsigned int SIZE_CLASS_BITS[4] = { 4, 8, 16, 32 };
+    return ReadBits(SIZE_CLASS_BITS[ReadBits(2)]);
+}
+
+//-----------------------------------------------------------------------------------
+void BitPacker::WriteVarInt(int32_t value)
+{
+    uint32_t zigzag = ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+    WriteVarUInt(zigzag);
+}
+
+//-----------------------------------------------------------------------------------
+int32_t BitPacker::ReadVarInt()
+{
+    uint32_t zigzag = ReadVarUInt();
+    return (int32_t)((zigzag >> 1) ^ (~(zigzag & 1) + 1));
+}
+
+//-----------------------------------------------------------------------------------
+//Smallest three (see Quaternion::ToSmallestThree), with the dropped component's index in 2 bits
+void BitPacker::WriteQuaternion(const Quaternion& rotation, unsigned int bitsPerComponent)
+{
+    float smallestThree[3];
+    unsigned int largestIndex = Quaternion::ToSmallestThree(rotation, smallestThree);
+    WriteBits(largestIndex, 2);
+    for (float component : smallestThree)
+    {
+        WriteQuantizedFloat(component, -Quaternion::SMALLEST_THREE_RANGE, Quaternion::SMALLEST_THREE_RANGE, bitsPerComponent);
+    }
+}
+
+//-----------------------------------------------------------------------------------
+Quaternion BitPacker::ReadQuaternion(unsigned int bitsPerComponent)
+{
+    unsigned int largestIndex = ReadBits(2);
+    float smallestThree[3];
+    for (float& component : smallestThree)
+    {
+        component = ReadQuantizedFloat(-Quaternion::SMALLEST_THREE_RANGE, Quaternion::SMALLEST_THREE_RANGE, bitsPerComponent);
+    }
+    return Quaternion::FromSmallestThree(largestIndex, smallestThree);
+}
+
+//-----------------------------------------------------------------------------------
+void BitPacker::AlignToByte()
+{
+    unsigned int paddingBits = (unsigned int)((8 - (m_bitOffset & 7)) & 7);
+    WriteBits(0, paddingBits);
+}
+
+//-----------------------------------------------------------------------------------
+size_t BitPacker::WriteBytes(const void* src, const size_t numBytes)
+{
+    if (numBytes == 0)
+    {
+        return 0;
+    }
+    ASSERT_OR_DIE(GetWritableBits() >= numBytes * 8, "Attempted to write more than we had room for");
+    const byte* source = (const byte*)src;
+    if ((m_bitOffset & 7) == 0)
+    {
+        memcpy(m_buffer + (m_bitOffset >> 3), source, numBytes);
+        m_bitOffset += numBytes * 8;
+        return numBytes;
+    }
+    for (size_t i = 0; i < numBytes; ++i)
+    {
+        WriteBits(source[i], 8);
+    }
+    return numBytes;
+}
+
+//-----------------------------------------------------------------------------------
+void* BitPacker::ReadBytes(const size_t numBytes)
+{
+    byte* buffer = new byte[numBytes];
+    ReadBytes(buffer, numBytes);
+    return buffer;
+}
+
+//-----------------------------------------------------------------------------------
+size_t BitPacker::ReadBytes(void* dest, const size_t numBytes)
+{
+    byte* destination = (byte*)dest;
+    if (m_hasOverflowed || GetReadableBits() < numBytes * 8)
+    {
+        m_hasOverflowed = true;
+        memset(destination, 0, numBytes);
+        return 0;
+    }
+    if ((m_bitOffset & 7) == 0)
+    {
+        memcpy(destination, m_buffer + (m_bitOffset >> 3), numBytes);
+        m_bitOffset += numBytes * 8;
+        return numBytes;
+    }
+    for (size_t i = 0; i < numBytes; ++i)
+    {
+        destination[i] = (byte)ReadBits(8);
+    }
+    return numBytes;
+}
+
+//-----------------------------------------------------------------------------------
+void BitPacker::SetReadableBytes(size_t readSizeMaxBytes)
+{
+    m_readSizeMaxBits = readSizeMaxBytes * 8;
+    m_bitOffset = 0;
+    m_hasOverflowed = false;
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include "Engine/Input/BinaryReader.hpp"
+#include "Engine/Input/BinaryWriter.hpp"
+#include <string.h>
+
+class Quaternion;
+typedef unsigned char byte;
+
+//-----------------------------------------------------------------------------------
+//Reads and writes at bit granularity, most significant bit first within each byte. Anything written through the byte interfaces
+//(Write<T>, WriteBytes) just takes 8 bits a byte, so a BitPacker can stand in wherever a BytePacker would, but the point is the
+//narrow writes: a bool is one bit, and floats, integers and rotations only take as many bits as their range and precision need.
+//
+//To bit pack part of a NetMessage, point a BitPacker at the message's head, write, then Advance the message by GetNumBytesUsed().
+//Writing past the end is a bug and dies. Reading past the end is bad data, so it returns zeroes and flags the packer as overflowed.
+class BitPacker : public IBinaryReader, public IBinaryWriter
+{
+public:
+    //CONSTRUCTORS/////////////////////////////////////////////////////////////////////
+    BitPacker();
+    BitPacker(void* buffer, size_t writeSizeMaxBytes, size_t readSizeMaxBytes);
+
+    //FUNCTIONS/////////////////////////////////////////////////////////////////////
+    void WriteBits(uint32_t value, unsigned int numBits);
+    uint32_t ReadBits(unsigned int numBits);
+    void WriteBool(bool value);
+    bool ReadBool();
+    void WriteFloat(float value); //All 32 bits, for when nothing is known about the range
+    float ReadFloat();
+    void WriteQuantizedFloat(float value, float minValue, float maxValue, unsigned int numBits); //Clamps to the range. Error is at most half a step, (max - min) / (2^numBits - 1) / 2
+    float ReadQuantizedFloat(float minValue, float maxValue, unsigned int numBits);
+    void WriteVarUInt(uint32_t value); //Small values are cheap: 6 bits under 16, 10 under 256, 18 under 65536, 34 otherwise
+    uint32_t ReadVarUInt();
+    void WriteVarInt(int32_t value); //Zigzag encoded, so small deltas of either sign stay small
+    int32_t ReadVarInt();
+    void WriteDeltaInt(int32_t value, int32_t baseline) { WriteVarInt(value - baseline); }; //For values the reader already has a recent copy of
+    int32_t ReadDeltaInt(int32_t baseline) { return baseline + ReadVarInt(); };
+    void WriteQuaternion(const Quaternion& rotation, unsigned int bitsPerComponent = DEFAULT_QUATERNION_COMPONENT_BITS); //Smallest three, 2 + 3 * bitsPerComponent bits
+    Quaternion ReadQuaternion(unsigned int bitsPerComponent = DEFAULT_QUATERNION_COMPONENT_BITS);
+    void AlignToByte(); //Pads with zero bits
+    size_t WriteBytes(const void* src, const size_t numBytes) override;
+    virtual void* ReadBytes(const size_t numBytes) override; //Allocates, prefer the version below
+    size_t ReadBytes(void* dest, const size_t numBytes) override; //Returns 0 and flags an overflow if there weren't enough bytes left
+    void SetReadableBytes(size_t readSizeMaxBytes);
+
+    //Reads without going through the virtual, and fails once anything has overflowed
+    template<typename T>
+    bool Read(T& data)
+    {
+        ReadBytes(&data, sizeof(T));
+        if (IBinaryReader::GetLocalEndianess() != IBinaryReader::BIG_ENDIAN)
+        {
+            IBinaryReader::ByteSwap(&data, sizeof(T));
+        }
+        return !m_hasOverflowed;
+    }
+
+    //-----------------------------------------------------------------------------------
+    template<typename T>
+    bool Write(const T& data)
+    {
+        return IBinaryWriter::Write<T>(data);
+    }
+
+    //GETTERS/////////////////////////////////////////////////////////////////////
+    inline size_t GetNumBitsUsed() const { return m_bitOffset; };
+    inline size_t GetNumBytesUsed() const { return (m_bitOffset + 7) / 8; };
+    inline size_t GetWritableBits() const { return m_writeSizeMaxBits - m_bitOffset; };
+    inline size_t GetReadableBits() const { return (m_readSizeMaxBits > m_bitOffset) ? m_readSizeMaxBits - m_bitOffset : 0; };
+    inline bool HasOverflowed() const { return m_hasOverflowed; };
+
+    //CONSTANTS/////////////////////////////////////////////////////////////////////
+    static const unsigned int DEFAULT_QUATERNION_COMPONENT_BITS = 10;
+
+    //MEMBER VARIABLES/////////////////////////////////////////////////////////////////////
+    byte* m_buffer;
+    size_t m_writeSizeMaxBits;
+    size_t m_readSizeMaxBits;
+
+private:
+    size_t m_bitOffset; //write & read offset
+    bool m_hasOverflowed;
+};
@@ -0,0 +1,378 @@
+#include "Engine/DataStructures/BitPacker.hpp"
+#include "Engine/DataStructures/BytePacker.hpp"
+#include "Engine/Net/UDPIP/NetMessage.hpp"
+#include "Engine/Math/Quaternion.hpp"
+#include "Engine/Math/Vector3.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Engine/Input/Console.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include <cmath>
+
+//TESTS/////////////////////////////////////////////////////////////////////
+//-----------------------------------------------------------------------------------
+static inline uint32_t NextBitPackerTestRandom(uint32_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+//-----------------------------------------------------------------------------------
+static inline float GetBitPackerTestFloat(uint32_t& state, float minValue, float maxValue)
+{
+    float fraction = (float)(NextBitPackerTestRandom(state) & 0xFFFFFF) / (float)0xFFFFFF;
+    return minValue + (fraction * (maxValue - minValue));
+}
+
+//-----------------------------------------------------------------------------------
+static Quaternion GetBitPackerTestRotation(uint32_t& state)
+{
+    Quaternion rotation(GetBitPackerTestFloat(state, -1.0f, 1.0f), GetBitPackerTestFloat(state, -1.0f, 1.0f), GetBitPackerTestFloat(state, -1.0f, 1.0f), GetBitPackerTestFloat(state, -1.0f, 1.0f));
+    rotation.Normalize();
+    return rotation;
+}
+
+//-----------------------------------------------------------------------------------
+//Writes a random mix of every kind of value at whatever bit offset the previous one left off, then reads it all back. Returns
+//false on the first value that didn't survive: integers, bools and bytes must be exact, floats within half a quantization step,
+//and rotations within the angle the quantization allows.
+static bool RunBitPackerRoundTrip(uint32_t seed, unsigned int numValues, unsigned int& outNumBits)
+{
+    const unsigned int BUFFER_SIZE = 16 * 1024;
+    static byte s_buffer[BUFFER_SIZE];
+    memset(s_buffer, 0xCD, sizeof(s_buffer));
+    BitPacker writer(s_buffer, BUFFER_SIZE, 0);
+
+    uint32_t writeRandom = seed;
+    for (unsigned int i = 0; i < numValues && writer.GetWritableBits() > 256; ++i)
+    {
+        switch (NextBitPackerTestRandom(writeRandom) % 8)
+        {
+        case 0:
+        {
+            unsigned int numBits = 1 + (NextBitPackerTestRandom(writeRandom) % 32);
+            writer.WriteBits(NextBitPackerTestRandom(writeRandom), numBits);
+            break;
+        }
+        case 1:
+            writer.WriteBool((NextBitPackerTestRandom(writeRandom) & 1) != 0);
+            break;
+        case 2:
+        {
+            uint32_t value = NextBitPackerTestRandom(writeRandom);
+            writer.WriteVarUInt(value >> (NextBitPackerTestRandom(writeRandom) % 32));
+            break;
+        }
+        case 3:
+        {
+            int32_t value = (int32_t)NextBitPackerTestRandom(writeRandom);
+            writer.WriteVarInt(value >> (NextBitPackerTestRandom(writeRandom) % 32));
+            break;
+        }
+        case 4:
+        {
+            float minValue = GetBitPackerTestFloat(writeRandom, -1000.0f, 0.0f);
+            float maxValue = minValue + GetBitPackerTestFloat(writeRandom, 0.01f, 2000.0f);
+            unsigned int numBits = 1 + (NextBitPackerTestRandom(writeRandom) % 24);
+            float value = GetBitPackerTestFloat(writeRandom, minValue, maxValue);
+            writer.WriteQuantizedFloat(value, minValue, maxValue, numBits);
+            break;
+        }
+        case 5:
+        {
+            unsigned int bitsPerComponent = 6 + (NextBitPackerTestRandom(writeRandom) % 11);
+            writer.WriteQuaternion(GetBitPackerTestRotation(writeRandom), bitsPerComponent);
+            break;
+        }
+        case 6:
+            writer.Write<uint16_t>((uint16_t)NextBitPackerTestRandom(writeRandom));
+            writer.WriteFloat(GetBitPackerTestFloat(writeRandom, -1e6f, 1e6f));
+            break;
+        default:
+        {
+            byte bytes[13];
+            for (byte& b : bytes)
+            {
+                b = (byte)NextBitPackerTestRandom(writeRandom);
+            }
+            writer.WriteBytes(bytes, sizeof(bytes));
+            break;
+        }
+        }
+    }
+    outNumBits = (unsigned int)writer.GetNumBitsUsed();
+
+    BitPacker reader(s_buffer, 0, writer.GetNumBytesUsed());
+    uint32_t readRandom = seed;
+    for (unsigned int i = 0; i < numValues && reader.GetNumBitsUsed() < writer.GetNumBitsUsed(); ++i)
+    {
+        bool matches = true;
+        switch (NextBitPackerTestRandom(readRandom) % 8)
+        {
+        case 0:
+        {
+            unsigned int numBits = 1 + (NextBitPackerTestRandom(readRandom) % 32);
+            uint32_t expected = NextBitPackerTestRandom(readRandom);
+            uint32_t mask = (numBits == 32) ? 0xFFFFFFFF : ((1u << numBits) - 1);
+            matches = reader.ReadBits(numBits) == (expected & mask);
+            break;
+        }
+        case 1:
+            matches = reader.ReadBool() == ((NextBitPackerTestRandom(readRandom) & 1) != 0);
+            break;
+        case 2:
+        {
+            uint32_t expected = NextBitPackerTestRandom(readRandom);
+            expected >>= (NextBitPackerTestRandom(readRandom) % 32);
+            matches = reader.ReadVarUInt() == expected;
+            break;
+        }
+        case 3:
+        {
+            int32_t expected = (int32_t)NextBitPackerTestRandom(readRandom);
+            expected >>= (NextBitPackerTestRandom(readRandom) % 32);
+            matches = reader.ReadVarInt() == expected;
+            break;
+        }
+        case 4:
+        {
+            float minValue = GetBitPackerTestFloat(readRandom, -1000.0f, 0.0f);
+            float maxValue = minValue + GetBitPackerTestFloat(readRandom, 0.01f, 2000.0f);
+            unsigned int numBits = 1 + (NextBitPackerTestRandom(readRandom) % 24);
+            float expected = GetBitPackerTestFloat(readRandom, minValue, maxValue);
+            float halfStep = ((maxValue - minValue) / (float)((1u << numBits) - 1)) * 0.5f;
+            matches = fabsf(reader.ReadQuantizedFloat(minValue, maxValue, numBits) - expected) <= halfStep * 1.01f + 1e-4f;
+            break;
+        }
+        case 5:
+        {
+            unsigned int bitsPerComponent = 6 + (NextBitPackerTestRandom(readRandom) % 11);
+            Quaternion expected = GetBitPackerTestRotation(readRandom);
+            Quaternion actual = reader.ReadQuaternion(bitsPerComponent);
+            //Each of the three components is off by at most half a step, and the rebuilt largest one (at least 0.5) by at most
+            //3 * sqrt(1/2) / 0.5 half steps. The angle is about twice the error's length. acosf itself is only good to about 1e-3 near 1.
+            float halfStep = ((2.0f * Quaternion::SMALLEST_THREE_RANGE) / (float)((1u << bitsPerComponent) - 1)) * 0.5f;
+            float maxAngleRadians = Max<float>(2.0f * (sqrtf(3.0f) + (3.0f * Quaternion::SMALLEST_THREE_RANGE / 0.5f)) * halfStep, 2e-3f);
+            matches = Quaternion::AngleBetweenRadians(expected, actual) <= maxAngleRadians;
+            break;
+        }
+        case 6:
+        {
+            uint16_t expectedShort = (uint16_t)NextBitPackerTestRandom(readRandom);
+            float expectedFloat = GetBitPackerTestFloat(readRandom, -1e6f, 1e6f);
+            uint16_t actualShort = 0;
+            reader.Read<uint16_t>(actualShort);
+            matches = (actualShort == expectedShort) && (reader.ReadFloat() == expectedFloat);
+            break;
+        }
+        default:
+        {
+            byte expected[13];
+            byte actual[13];
+            for (byte& b : expected)
+            {
+                b = (byte)NextBitPackerTestRandom(readRandom);
+            }
+            reader.ReadBytes(actual, sizeof(actual));
+            matches = memcmp(expected, actual, sizeof(actual)) == 0;
+            break;
+        }
+        }
+        if (!matches || reader.HasOverflowed())
+        {
+            return false;
+        }
+    }
+
+    //Reading past what was written has to fail softly, and the bits right after the write head must be untouched
+    reader.ReadBits(32);
+    reader.ReadBits(32);
+    bool trailingBytesUntouched = s_buffer[writer.GetNumBytesUsed()] == 0xCD;
+    return reader.HasOverflowed() && reader.ReadBits(1) == 0 && trailingBytesUntouched;
+}
+
+//-----------------------------------------------------------------------------------
+//What a typical replicated entity costs on the wire
+struct BitPackerTestEntity
+{
+    uint32_t id;
+    Vector3 position;
+    Quaternion rotation;
+    Vector3 velocity;
+    uint16_t health;
+    bool isGrounded;
+    bool isCrouching;
+    bool isFiring;
+    bool isVisible;
+};
+
+//-----------------------------------------------------------------------------------
+static const float ENTITY_WORLD_EXTENT = 1024.0f; //Positions within +-this, to 1cm
+static const unsigned int ENTITY_POSITION_BITS = 18;
+static const float ENTITY_MAX_SPEED = 64.0f;
+static const unsigned int ENTITY_VELOCITY_BITS = 11;
+static const unsigned int ENTITY_HEALTH_BITS = 10;
+
+//-----------------------------------------------------------------------------------
+static void WriteBytePackedEntity(BytePacker& packer, const BitPackerTestEntity& entity)
+{
+    packer.Write<uint32_t>(entity.id);
+    packer.Write<float>(entity.position.x);
+    packer.Write<float>(entity.position.y);
+    packer.Write<float>(entity.position.z);
+    packer.Write<float>(entity.rotation.x);
+    packer.Write<float>(entity.rotation.y);
+    packer.Write<float>(entity.rotation.z);
+    packer.Write<float>(entity.rotation.w);
+    packer.Write<float>(entity.velocity.x);
+    packer.Write<float>(entity.velocity.y);
+    packer.Write<float>(entity.velocity.z);
+    packer.Write<uint16_t>(entity.health);
+    packer.Write<bool>(entity.isGrounded);
+    packer.Write<bool>(entity.isCrouching);
+    packer.Write<bool>(entity.isFiring);
+    packer.Write<bool>(entity.isVisible);
+}
+
+//-----------------------------------------------------------------------------------
+static void WriteBitPackedEntity(BitPacker& packer, const BitPackerTestEntity& entity, uint32_t previousId)
+{
+    packer.WriteDeltaInt((int32_t)entity.id, (int32_t)previousId);
+    packer.WriteQuantizedFloat(entity.position.x, -ENTITY_WORLD_EXTENT, ENTITY_WORLD_EXTENT, ENTITY_POSITION_BITS);
+    packer.WriteQuantizedFloat(entity.position.y, -ENTITY_WORLD_EXTENT, ENTITY_WORLD_EXTENT, ENTITY_POSITION_BITS);
+    packer.WriteQuantizedFloat(entity.position.z, -ENTITY_WORLD_EXTENT, ENTITY_WORLD_EXTENT, ENTITY_POSITION_BITS);
+    packer.WriteQuaternion(entity.rotation);
+    packer.WriteQuantizedFloat(entity.velocity.x, -ENTITY_MAX_SPEED, ENTITY_MAX_SPEED, ENTITY_VELOCITY_BITS);
+    packer.WriteQuantizedFloat(entity.velocity.y, -ENTITY_MAX_SPEED, ENTITY_MAX_SPEED, ENTITY_VELOCITY_BITS);
+    packer.WriteQuantizedFloat(entity.velocity.z, -ENTITY_MAX_SPEED, ENTITY_MAX_SPEED, ENTITY_VELOCITY_BITS);
+    packer.WriteBits(entity.health, ENTITY_HEALTH_BITS);
+    packer.WriteBool(entity.isGrounded);
+    packer.WriteBool(entity.isCrouching);
+    packer.WriteBool(entity.isFiring);
+    packer.WriteBool(entity.isVisible);
+}
+
+//-----------------------------------------------------------------------------------
+static void ReadBitPackedEntity(BitPacker& packer, BitPackerTestEntity& entity, uint32_t previousId)
+{
+    entity.id = (uint32_t)packer.ReadDeltaInt((int32_t)previousId);
+    entity.position.x = packer.ReadQuantizedFloat(-ENTITY_WORLD_EXTENT, ENTITY_WORLD_EXTENT, ENTITY_POSITION_BITS);
+    entity.position.y = packer.ReadQuantizedFloat(-ENTITY_WORLD_EXTENT, ENTITY_WORLD_EXTENT, ENTITY_POSITION_BITS);
+    entity.position.z = packer.ReadQuantizedFloat(-ENTITY_WORLD_EXTENT, ENTITY_WORLD_EXTENT, ENTITY_POSITION_BITS);
+    entity.rotation = packer.ReadQuaternion();
+    entity.velocity.x = packer.ReadQuantizedFloat(-ENTITY_MAX_SPEED, ENTITY_MAX_SPEED, ENTITY_VELOCITY_BITS);
+    entity.velocity.y = packer.ReadQuantizedFloat(-ENTITY_MAX_SPEED, ENTITY_MAX_SPEED, ENTITY_VELOCITY_BITS);
+    entity.velocity.z = packer.ReadQuantizedFloat(-ENTITY_MAX_SPEED, ENTITY_MAX_SPEED, ENTITY_VELOCITY_BITS);
+    entity.health = (uint16_t)packer.ReadBits(ENTITY_HEALTH_BITS);
+    entity.isGrounded = packer.ReadBool();
+    entity.isCrouching = packer.ReadBool();
+    entity.isFiring = packer.ReadBool();
+    entity.isVisible = packer.ReadBool();
+}
+
+//-----------------------------------------------------------------------------------
+//Packs a snapshot of entities both ways and reports the cost per entity and how many fit in one message's worth of a packet.
+//Also checks the bit packed copy decodes to within the precision it was packed at.
+static bool MeasureEntityPacking(uint32_t seed)
+{
+    const unsigned int NUM_ENTITIES = 256;
+    static BitPackerTestEntity s_entities[NUM_ENTITIES];
+    uint32_t random = seed;
+    uint32_t nextId = 1;
+    for (BitPackerTestEntity& entity : s_entities)
+    {
+        nextId += 1 + (NextBitPackerTestRandom(random) % 4); //Sparse ids, the way they are after some have despawned
+        entity.id = nextId;
+        entity.position = Vector3(GetBitPackerTestFloat(random, -ENTITY_WORLD_EXTENT, ENTITY_WORLD_EXTENT), GetBitPackerTestFloat(random, 0.0f, 64.0f), GetBitPackerTestFloat(random, -ENTITY_WORLD_EXTENT, ENTITY_WORLD_EXTENT));
+        entity.rotation = GetBitPackerTestRotation(random);
+        entity.velocity = Vector3(GetBitPackerTestFloat(random, -8.0f, 8.0f), GetBitPackerTestFloat(random, -20.0f, 5.0f), GetBitPackerTestFloat(random, -8.0f, 8.0f));
+        entity.health = (uint16_t)(NextBitPackerTestRandom(random) % 1001);
+        entity.isGrounded = (NextBitPackerTestRandom(random) % 4) != 0;
+        entity.isCrouching = (NextBitPackerTestRandom(random) % 8) == 0;
+        entity.isFiring = (NextBitPackerTestRandom(random) % 8) == 0;
+        entity.isVisible = (NextBitPackerTestRandom(random) % 16) != 0;
+    }
+
+    const size_t BUFFER_SIZE = NUM_ENTITIES * sizeof(BitPackerTestEntity) * 2;
+    static byte s_byteBuffer[BUFFER_SIZE];
+    static byte s_bitBuffer[BUFFER_SIZE];
+    BytePacker bytePacker(s_byteBuffer, BUFFER_SIZE, 0, IBinaryReader::BIG_ENDIAN);
+    BitPacker bitPacker(s_bitBuffer, BUFFER_SIZE, 0);
+    uint32_t previousId = 0;
+    for (const BitPackerTestEntity& entity : s_entities)
+    {
+        WriteBytePackedEntity(bytePacker, entity);
+        WriteBitPackedEntity(bitPacker, entity, previousId);
+        previousId = entity.id;
+    }
+
+    BitPacker reader(s_bitBuffer, 0, bitPacker.GetNumBytesUsed());
+    float positionTolerance = (2.0f * ENTITY_WORLD_EXTENT / (float)((1u << ENTITY_POSITION_BITS) - 1)) * 0.51f;
+    float velocityTolerance = (2.0f * ENTITY_MAX_SPEED / (float)((1u << ENTITY_VELOCITY_BITS) - 1)) * 0.51f;
+    bool decodedCorrectly = true;
+    previousId = 0;
+    for (const BitPackerTestEntity& expected : s_entities)
+    {
+        BitPackerTestEntity actual;
+        ReadBitPackedEntity(reader, actual, previousId);
+        previousId = actual.id;
+        decodedCorrectly = decodedCorrectly
+            && actual.id == expected.id
+            && fabsf(actual.position.x - expected.position.x) <= positionTolerance
+            && fabsf(actual.position.y - expected.position.y) <= positionTolerance
+            && fabsf(actual.position.z - expected.position.z) <= positionTolerance
+            && Quaternion::AngleBetweenRadians(actual.rotation, expected.rotation) <= 0.01f
+            && fabsf(actual.velocity.x - expected.velocity.x) <= velocityTolerance
+            && fabsf(actual.velocity.y - expected.velocity.y) <= velocityTolerance
+            && fabsf(actual.velocity.z - expected.velocity.z) <= velocityTolerance
+            && actual.health == expected.health
+            && actual.isGrounded == expected.isGrounded
+            && actual.isCrouching == expected.isCrouching
+            && actual.isFiring == expected.isFiring
+            && actual.isVisible == expected.isVisible;
+    }
+    decodedCorrectly = decodedCorrectly && !reader.HasOverflowed();
+
+    float bytesPerEntity = (float)bytePacker.GetTotalReadableBytes() / (float)NUM_ENTITIES;
+    float bitPackedBytesPerEntity = ((float)bitPacker.GetNumBitsUsed() / 8.0f) / (float)NUM_ENTITIES;
+    float bytesPerMessage = (float)MESSAGE_MTU;
+    Console::instance->PrintLine(Stringf("Entity snapshot (id, position, rotation, velocity, health, 4 flags), %u entities", NUM_ENTITIES), RGBA::CORNFLOWER_BLUE);
+    Console::instance->PrintLine(Stringf("  BytePacker: %6.2f bytes/entity, %3u entities per %u byte message", bytesPerEntity, (unsigned int)(bytesPerMessage / bytesPerEntity), MESSAGE_MTU), RGBA::GREEN);
+    Console::instance->PrintLine(Stringf("  BitPacker:  %6.2f bytes/entity, %3u entities per %u byte message (%.2fx)  1cm positions, %u bit quaternion components",
+        bitPackedBytesPerEntity,
+        (unsigned int)(bytesPerMessage / bitPackedBytesPerEntity),
+        MESSAGE_MTU,
+        bytesPerEntity / bitPackedBytesPerEntity,
+        BitPacker::DEFAULT_QUATERNION_COMPONENT_BITS), decodedCorrectly ? RGBA::GREEN : RGBA::RED);
+    return decodedCorrectly;
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(bitpackertest)
+{
+    if (!(args.HasArgs(0) || args.HasArgs(2)))
+    {
+        Console::instance->PrintLine("bitpackertest <runs> <seed>", RGBA::RED);
+        return;
+    }
+    int numRuns = args.HasArgs(2) ? args.GetIntArgument(0) : 200;
+    uint32_t seed = args.HasArgs(2) ? (uint32_t)args.GetIntArgument(1) : 1;
+
+    int numFailed = 0;
+    uint64_t numBits = 0;
+    for (int run = 0; run < numRuns; ++run)
+    {
+        uint32_t runSeed = (seed + (uint32_t)run * 7919) | 1;
+        unsigned int runBits = 0;
+        if (!RunBitPackerRoundTrip(runSeed, 2000, runBits))
+        {
+            ++numFailed;
+            Console::instance->PrintLine(Stringf("  FAIL: round trip with seed %u", runSeed), RGBA::RED);
+        }
+        numBits += runBits;
+    }
+    Console::instance->PrintLine(Stringf("bitpackertest: %i/%i round trips passed (%llu bits of mixed values)", numRuns - numFailed, numRuns, (unsigned long long)numBits), numFailed == 0 ? RGBA::GREEN : RGBA::RED);
+    bool entitiesPassed = MeasureEntityPacking(seed);
+    Console::instance->PrintLine(Stringf("bitpackertest: %s", (numFailed == 0 && entitiesPassed) ? "passed" : "failed"), (numFailed == 0 && entitiesPassed) ? RGBA::GREEN : RGBA::RED);
+}
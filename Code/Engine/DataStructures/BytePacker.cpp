@@ -1,5 +1,7 @@
 #include "Engine/DataStructures/BytePacker.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Math/Vector3.hpp"
+#include "Engine/Math/MathUtils.hpp"
 
 //-----------------------------------------------------------------------------------
 BytePacker::BytePacker(void* buffer, size_t writeSizeMax, size_t readSizeMax, IBinaryReader::Endianness endianness)
@@ -27,7 +29,7 @@ BytePacker::BytePacker()
 //-----------------------------------------------------------------------------------
 void* BytePacker::ReadBytes(const size_t numBytes)
 {
-    if (numBytes < 0)
+    if (numBytes > m_readSizeMax)
     {
         return nullptr;
     }
@@ -39,15 +41,16 @@ void* BytePacker::ReadBytes(const size_t numBytes)
 }
 
 //-----------------------------------------------------------------------------------
-void BytePacker::ReadBytes(void* dest, const size_t numBytes)
+size_t BytePacker::ReadBytes(void* dest, const size_t numBytes)
 {
-    if (numBytes == 0)
+    if (numBytes == 0 || numBytes > m_readSizeMax)
     {
-        return;
+        return 0;
     }
     memcpy(dest, (void*)((size_t)m_buffer + m_offset), numBytes);
     m_readSizeMax -= numBytes;
     m_offset += numBytes;
+    return numBytes;
 }
 
 //-----------------------------------------------------------------------------------
@@ -77,6 +80,7 @@ const char* BytePacker::ReadString()
         if (length <= m_readSizeMax)
         {
             Advance(length);
+            m_readSizeMax -= length;
             return buffer;
         }
         else
@@ -93,9 +97,8 @@ size_t BytePacker::WriteBytes(const void* data, const size_t dataSize)
     {
         return 0;
     }
-    ASSERT_OR_DIE(m_writeSizeMax >= dataSize, "Attempted to write more than we had room for");
+    ASSERT_OR_DIE(GetWritableBytes() >= dataSize, "Attempted to write more than we had room for");
     memcpy((void*)((size_t)m_buffer + m_offset), data, dataSize);
-    m_writeSizeMax -= dataSize;
     m_offset += dataSize;
     return dataSize;
 }
@@ -120,6 +123,13 @@ void BytePacker::Advance(size_t offset)
     m_offset += offset;
 }
 
+//-----------------------------------------------------------------------------------
+void BytePacker::Rewind(size_t offset)
+{
+    ASSERT_OR_DIE(offset <= m_offset, "Attempted to rewind past the start of the buffer");
+    m_offset -= offset;
+}
+
 //-----------------------------------------------------------------------------------
 void* BytePacker::GetHead()
 {
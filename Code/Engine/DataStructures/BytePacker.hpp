@@ -1,11 +1,18 @@
 #pragma once
 #include <algorithm>
+#include <type_traits>
+#include <string.h>
 #include "Engine/Input/BinaryReader.hpp"
 #include "Engine/Input/BinaryWriter.hpp"
+#include "Engine/Input/ByteOrder.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
 
 typedef unsigned char byte;
 
 //-----------------------------------------------------------------------------------
+//Values are copied straight in and out of the buffer, and only swapped when the packer's byte order isn't the machine's. Swaps are
+//whole words for 2, 4 and 8 byte values. A value is always swapped as one block of sizeof(T) bytes, so a struct's fields end up in
+//reverse order; write structs field by field, or as an array of their components, if the other side reads them that way.
 class BytePacker : public IBinaryReader, public IBinaryWriter
 {
 public:
@@ -16,10 +23,11 @@ public:
     //FUNCTIONS/////////////////////////////////////////////////////////////////////
     virtual void* ReadBytes(const size_t numBytes);
     const char* ReadString();
-    void ReadBytes(void* dest, const size_t numBytes);
+    size_t ReadBytes(void* dest, const size_t numBytes) override;
     size_t WriteBytes(const void* src, const size_t numBytes) override;
     void WriteString(const char* str);
     void Advance(size_t offset);
+    void Rewind(size_t offset); //Moves the head back, dropping what was written there
     void* GetHead();
     void SetReadableBytes(size_t readSizeMax);
     size_t GetReadableBytes() const { return GetTotalReadableBytes(); };
@@ -27,6 +35,86 @@ public:
     size_t GetWritableBytes() const { return GetTotalWritableBytes() - m_offset; };
     inline size_t GetTotalWritableBytes() const { return std::max<size_t>(m_offset, m_writeSizeMax); };
 
+    //-----------------------------------------------------------------------------------
+    template<typename T>
+    bool Write(const T& data)
+    {
+        ASSERT_OR_DIE(GetWritableBytes() >= sizeof(T), "Attempted to write more than we had room for");
+        byte* head = (byte*)m_buffer + m_offset;
+        memcpy(head, &data, sizeof(T));
+        if (IBinaryWriter::NeedsByteSwap())
+        {
+            ByteSwapInPlace(head, sizeof(T));
+        }
+        m_offset += sizeof(T);
+        return true;
+    }
+
+    //-----------------------------------------------------------------------------------
+    template<typename T>
+    bool Read(T& data)
+    {
+        if (sizeof(T) > m_readSizeMax)
+        {
+            return false;
+        }
+        memcpy(&data, (const byte*)m_buffer + m_offset, sizeof(T));
+        if (IBinaryReader::NeedsByteSwap())
+        {
+            ByteSwapInPlace(&data, sizeof(T));
+        }
+        m_readSizeMax -= sizeof(T);
+        m_offset += sizeof(T);
+        return true;
+    }
+
+    //-----------------------------------------------------------------------------------
+    //Same bytes as calling Write<T> on each element, but one copy for the lot and, if needed, one pass swapping them in place
+    template<typename T>
+    bool WriteArray(const T* data, const size_t numElements)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "WriteArray copies elements as raw bytes");
+        const size_t numBytes = sizeof(T) * numElements;
+        if (numBytes == 0)
+        {
+            return true;
+        }
+        ASSERT_OR_DIE(GetWritableBytes() >= numBytes, "Attempted to write more than we had room for");
+        byte* head = (byte*)m_buffer + m_offset;
+        memcpy(head, data, numBytes);
+        if (IBinaryWriter::NeedsByteSwap())
+        {
+            ByteSwapElements(head, sizeof(T), numElements);
+        }
+        m_offset += numBytes;
+        return true;
+    }
+
+    //-----------------------------------------------------------------------------------
+    //Reads nothing and returns false if fewer than numElements are left, so a count off the wire can't read past the data
+    template<typename T>
+    bool ReadArray(T* outData, const size_t numElements)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "ReadArray copies elements as raw bytes");
+        const size_t numBytes = sizeof(T) * numElements;
+        if (numBytes == 0)
+        {
+            return true;
+        }
+        if (numBytes / sizeof(T) != numElements || numBytes > m_readSizeMax)
+        {
+            return false;
+        }
+        memcpy(outData, (const byte*)m_buffer + m_offset, numBytes);
+        if (IBinaryReader::NeedsByteSwap())
+        {
+            ByteSwapElements(outData, sizeof(T), numElements);
+        }
+        m_readSizeMax -= numBytes;
+        m_offset += numBytes;
+        return true;
+    }
+
     //-----------------------------------------------------------------------------------
     template<typename T>
     T* Reserve(const T& data)
@@ -38,7 +126,7 @@ public:
 
     void* m_buffer;
     size_t m_writeSizeMax; //buffer size
-    size_t m_readSizeMax;
+    size_t m_readSizeMax; //bytes left to read
 
 private:
     size_t m_offset; //write & read offset
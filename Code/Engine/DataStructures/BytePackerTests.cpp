@@ -0,0 +1,392 @@
+#include "Engine/DataStructures/BytePacker.hpp"
+#include "Engine/Input/Console.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Math/Vector3.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Engine/Time/Time.hpp"
+
+//TESTS/////////////////////////////////////////////////////////////////////
+//-----------------------------------------------------------------------------------
+static inline uint32_t NextBytePackerTestRandom(uint32_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+//-----------------------------------------------------------------------------------
+static void ReverseBytesOneAtATime(void* data, const size_t numBytes)
+{
+    byte* start = (byte*)data;
+    byte* end = start + numBytes - 1;
+    while (start < end)
+    {
+        byte temp = *start;
+        *start = *end;
+        *end = temp;
+        ++start;
+        --end;
+    }
+}
+
+//-----------------------------------------------------------------------------------
+//How every value was packed before the fast paths, kept as the baseline: through the virtuals, a new buffer per read, and a byte at a time swap
+template<typename T>
+static inline void WriteBytewise(IBinaryWriter& writer, const T& data, bool needsSwap)
+{
+    T copy = data;
+    if (needsSwap)
+    {
+        ReverseBytesOneAtATime(&copy, sizeof(T));
+    }
+    writer.WriteBytes(&copy, sizeof(T));
+}
+
+//-----------------------------------------------------------------------------------
+template<typename T>
+static inline void ReadBytewise(IBinaryReader& reader, T& data, bool needsSwap)
+{
+    byte* readData = (byte*)reader.ReadBytes(sizeof(T));
+    memcpy(&data, readData, sizeof(T));
+    delete[] readData;
+    if (needsSwap)
+    {
+        ReverseBytesOneAtATime(&data, sizeof(T));
+    }
+}
+
+//-----------------------------------------------------------------------------------
+enum BytePackerBenchMethod
+{
+    BENCH_BYTEWISE,
+    BENCH_PER_VALUE,
+    BENCH_ARRAY,
+    NUM_BENCH_METHODS
+};
+static const char* BENCH_METHOD_NAMES[NUM_BENCH_METHODS] = { "bytewise", "Write<T>", "WriteArray" };
+
+//-----------------------------------------------------------------------------------
+template<typename T>
+static inline void WriteBenchValue(BytePacker& packer, const T& value, BytePackerBenchMethod method)
+{
+    if (method == BENCH_BYTEWISE)
+    {
+        WriteBytewise<T>(packer, value, packer.IBinaryWriter::NeedsByteSwap());
+    }
+    else
+    {
+        packer.Write<T>(value);
+    }
+}
+
+//-----------------------------------------------------------------------------------
+template<typename T>
+static inline void ReadBenchValue(BytePacker& packer, T& value, BytePackerBenchMethod method)
+{
+    if (method == BENCH_BYTEWISE)
+    {
+        ReadBytewise<T>(packer, value, packer.IBinaryReader::NeedsByteSwap());
+    }
+    else
+    {
+        packer.Read<T>(value);
+    }
+}
+
+//-----------------------------------------------------------------------------------
+//Three shapes of a large message: records of mixed scalars, entity positions, and parallel arrays of ids and health
+struct BytePackerBenchRecord
+{
+    uint8_t flags;
+    uint16_t type;
+    uint32_t id;
+    float value;
+    uint64_t timestamp;
+    double accumulated;
+};
+
+enum BytePackerBenchPayloadType
+{
+    BENCH_SCALARS,
+    BENCH_VECTORS,
+    BENCH_ARRAYS,
+    NUM_BENCH_PAYLOADS
+};
+static const char* BENCH_PAYLOAD_NAMES[NUM_BENCH_PAYLOADS] = { "scalars", "vectors", "arrays" };
+
+struct BytePackerBenchPayload
+{
+    static const unsigned int NUM_RECORDS = 128; //27 bytes each on the wire
+    static const unsigned int NUM_POSITIONS = 256;
+    static const unsigned int NUM_IDS = 512;
+
+    BytePackerBenchRecord records[NUM_RECORDS];
+    Vector3 positions[NUM_POSITIONS];
+    uint32_t ids[NUM_IDS];
+    uint16_t health[NUM_IDS];
+};
+
+//-----------------------------------------------------------------------------------
+static void WriteBenchPayload(BytePacker& packer, const BytePackerBenchPayload& payload, BytePackerBenchPayloadType type, BytePackerBenchMethod method)
+{
+    if (type == BENCH_SCALARS)
+    {
+        for (const BytePackerBenchRecord& record : payload.records)
+        {
+            WriteBenchValue<uint8_t>(packer, record.flags, method);
+            WriteBenchValue<uint16_t>(packer, record.type, method);
+            WriteBenchValue<uint32_t>(packer, record.id, method);
+            WriteBenchValue<float>(packer, record.value, method);
+            WriteBenchValue<uint64_t>(packer, record.timestamp, method);
+            WriteBenchValue<double>(packer, record.accumulated, method);
+        }
+    }
+    else if (type == BENCH_VECTORS && method == BENCH_ARRAY)
+    {
+        packer.WriteArray<float>(&payload.positions[0].x, BytePackerBenchPayload::NUM_POSITIONS * 3);
+    }
+    else if (type == BENCH_VECTORS)
+    {
+        for (const Vector3& position : payload.positions)
+        {
+            WriteBenchValue<float>(packer, position.x, method);
+            WriteBenchValue<float>(packer, position.y, method);
+            WriteBenchValue<float>(packer, position.z, method);
+        }
+    }
+    else if (method == BENCH_ARRAY)
+    {
+        packer.WriteArray<uint32_t>(payload.ids, BytePackerBenchPayload::NUM_IDS);
+        packer.WriteArray<uint16_t>(payload.health, BytePackerBenchPayload::NUM_IDS);
+    }
+    else
+    {
+        for (uint32_t id : payload.ids)
+        {
+            WriteBenchValue<uint32_t>(packer, id, method);
+        }
+        for (uint16_t health : payload.health)
+        {
+            WriteBenchValue<uint16_t>(packer, health, method);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------------
+static void ReadBenchPayload(BytePacker& packer, BytePackerBenchPayload& outPayload, BytePackerBenchPayloadType type, BytePackerBenchMethod method)
+{
+    if (type == BENCH_SCALARS)
+    {
+        for (BytePackerBenchRecord& record : outPayload.records)
+        {
+            ReadBenchValue<uint8_t>(packer, record.flags, method);
+            ReadBenchValue<uint16_t>(packer, record.type, method);
+            ReadBenchValue<uint32_t>(packer, record.id, method);
+            ReadBenchValue<float>(packer, record.value, method);
+            ReadBenchValue<uint64_t>(packer, record.timestamp, method);
+            ReadBenchValue<double>(packer, record.accumulated, method);
+        }
+    }
+    else if (type == BENCH_VECTORS && method == BENCH_ARRAY)
+    {
+        packer.ReadArray<float>(&outPayload.positions[0].x, BytePackerBenchPayload::NUM_POSITIONS * 3);
+    }
+    else if (type == BENCH_VECTORS)
+    {
+        for (Vector3& position : outPayload.positions)
+        {
+            ReadBenchValue<float>(packer, position.x, method);
+            ReadBenchValue<float>(packer, position.y, method);
+            ReadBenchValue<float>(packer, position.z, method);
+        }
+    }
+    else if (method == BENCH_ARRAY)
+    {
+        packer.ReadArray<uint32_t>(outPayload.ids, BytePackerBenchPayload::NUM_IDS);
+        packer.ReadArray<uint16_t>(outPayload.health, BytePackerBenchPayload::NUM_IDS);
+    }
+    else
+    {
+        for (uint32_t& id : outPayload.ids)
+        {
+            ReadBenchValue<uint32_t>(packer, id, method);
+        }
+        for (uint16_t& health : outPayload.health)
+        {
+            ReadBenchValue<uint16_t>(packer, health, method);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------------
+static bool DoBenchPayloadsMatch(const BytePackerBenchPayload& expected, const BytePackerBenchPayload& actual, BytePackerBenchPayloadType type)
+{
+    if (type == BENCH_SCALARS)
+    {
+        for (unsigned int i = 0; i < BytePackerBenchPayload::NUM_RECORDS; ++i)
+        {
+            const BytePackerBenchRecord& a = expected.records[i];
+            const BytePackerBenchRecord& b = actual.records[i];
+            if (a.flags != b.flags || a.type != b.type || a.id != b.id || a.value != b.value || a.timestamp != b.timestamp || a.accumulated != b.accumulated)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    else if (type == BENCH_VECTORS)
+    {
+        for (unsigned int i = 0; i < BytePackerBenchPayload::NUM_POSITIONS; ++i)
+        {
+            if (!(expected.positions[i] == actual.positions[i]))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    return memcmp(expected.ids, actual.ids, sizeof(expected.ids)) == 0 && memcmp(expected.health, actual.health, sizeof(expected.health)) == 0;
+}
+
+//-----------------------------------------------------------------------------------
+//Both byte orders have to put values on the wire the way they say, whichever way the machine is
+static bool CheckBytePackerWireOrder(IBinaryReader::Endianness endianness)
+{
+    byte buffer[16];
+    BytePacker packer(buffer, sizeof(buffer), 0, endianness);
+    const uint16_t shorts[2] = { 0x0102, 0x0304 };
+    packer.Write<uint32_t>(0x05060708);
+    packer.WriteArray<uint16_t>(shorts, 2);
+    const byte bigEndianBytes[] = { 0x05, 0x06, 0x07, 0x08, 0x01, 0x02, 0x03, 0x04 };
+    const byte littleEndianBytes[] = { 0x08, 0x07, 0x06, 0x05, 0x02, 0x01, 0x04, 0x03 };
+    return memcmp(buffer, (endianness == IBinaryReader::BIG_ENDIAN) ? bigEndianBytes : littleEndianBytes, sizeof(bigEndianBytes)) == 0;
+}
+
+//-----------------------------------------------------------------------------------
+//Every read asking for more than is left has to fail without moving the head, so a bad length off the wire can't walk off the end
+static bool CheckBytePackerShortReads(IBinaryReader::Endianness endianness)
+{
+    byte buffer[6] = { 1, 2, 3, 4, 5, 6 };
+    BytePacker packer(buffer, 0, sizeof(buffer), endianness);
+    uint32_t value = 0;
+    uint64_t tooBig = 0;
+    uint16_t elements[4] = {};
+    byte bytes[8] = {};
+    bool passed = packer.Read<uint32_t>(value);
+    passed = passed && !packer.Read<uint64_t>(tooBig);
+    passed = passed && !packer.ReadArray<uint16_t>(elements, 2);
+    passed = passed && !packer.ReadArray<uint16_t>(elements, (size_t)-1);
+    passed = passed && packer.ReadBytes(bytes, 3) == 0;
+    passed = passed && packer.ReadBytes(3) == nullptr;
+    passed = passed && packer.GetHead() == buffer + sizeof(uint32_t) && packer.m_readSizeMax == 2;
+    passed = passed && packer.ReadArray<uint16_t>(elements, 1) && packer.m_readSizeMax == 0;
+    return passed;
+}
+
+//-----------------------------------------------------------------------------------
+//Packs and unpacks each payload shape with each method, in both byte orders. Every method has to produce the same bytes as the bytewise
+//baseline and read back what was written; throughput is write and read separately, over the payload's size on the wire.
+CONSOLE_COMMAND(bytepackerbench)
+{
+    if (!(args.HasArgs(0) || args.HasArgs(1)))
+    {
+        Console::instance->PrintLine("bytepackerbench <iterations>", RGBA::RED);
+        return;
+    }
+    int numIterations = args.HasArgs(1) ? Max<int>(args.GetIntArgument(0), 1) : 2000;
+
+    static BytePackerBenchPayload s_payload;
+    static BytePackerBenchPayload s_readPayload;
+    uint32_t random = 1;
+    for (BytePackerBenchRecord& record : s_payload.records)
+    {
+        record.flags = (uint8_t)NextBytePackerTestRandom(random);
+        record.type = (uint16_t)NextBytePackerTestRandom(random);
+        record.id = NextBytePackerTestRandom(random);
+        record.value = (float)(int32_t)NextBytePackerTestRandom(random) / 1024.0f;
+        record.timestamp = ((uint64_t)NextBytePackerTestRandom(random) << 32) | NextBytePackerTestRandom(random);
+        record.accumulated = (double)NextBytePackerTestRandom(random) / 3.0;
+    }
+    for (Vector3& position : s_payload.positions)
+    {
+        position = Vector3((float)(int32_t)NextBytePackerTestRandom(random) / 65536.0f, (float)(NextBytePackerTestRandom(random) & 0xFFFF) / 256.0f, (float)(int32_t)NextBytePackerTestRandom(random) / 65536.0f);
+    }
+    for (unsigned int i = 0; i < BytePackerBenchPayload::NUM_IDS; ++i)
+    {
+        s_payload.ids[i] = NextBytePackerTestRandom(random);
+        s_payload.health[i] = (uint16_t)NextBytePackerTestRandom(random);
+    }
+
+    const size_t BUFFER_SIZE = sizeof(BytePackerBenchPayload);
+    static byte s_baselineBuffer[BUFFER_SIZE];
+    static byte s_buffer[BUFFER_SIZE];
+    const IBinaryReader::Endianness endiannesses[2] = { IBinaryReader::LITTLE_ENDIAN, IBinaryReader::BIG_ENDIAN };
+    int numChecks = 0;
+    int numPassed = 0;
+    for (IBinaryReader::Endianness endianness : endiannesses)
+    {
+        const char* endianName = (endianness == IBinaryReader::BIG_ENDIAN) ? "big endian" : "little endian";
+        bool wireOrderCorrect = CheckBytePackerWireOrder(endianness);
+        ++numChecks;
+        numPassed += wireOrderCorrect ? 1 : 0;
+        Console::instance->PrintLine(Stringf("  %s: %s values land on the wire in that order", wireOrderCorrect ? "PASS" : "FAIL", endianName), wireOrderCorrect ? RGBA::GREEN : RGBA::RED);
+        bool shortReadsRejected = CheckBytePackerShortReads(endianness);
+        ++numChecks;
+        numPassed += shortReadsRejected ? 1 : 0;
+        Console::instance->PrintLine(Stringf("  %s: %s reads past the end fail and leave the head alone", shortReadsRejected ? "PASS" : "FAIL", endianName), shortReadsRejected ? RGBA::GREEN : RGBA::RED);
+
+        for (int payloadIndex = 0; payloadIndex < NUM_BENCH_PAYLOADS; ++payloadIndex)
+        {
+            BytePackerBenchPayloadType type = (BytePackerBenchPayloadType)payloadIndex;
+            size_t baselineSize = 0;
+            for (int methodIndex = 0; methodIndex < NUM_BENCH_METHODS; ++methodIndex)
+            {
+                BytePackerBenchMethod method = (BytePackerBenchMethod)methodIndex;
+                if (type == BENCH_SCALARS && method == BENCH_ARRAY)
+                {
+                    continue; //Mixed records have no array form
+                }
+                byte* buffer = (method == BENCH_BYTEWISE) ? s_baselineBuffer : s_buffer;
+                size_t numBytes = 0;
+                double writeSeconds = 0.0;
+                double readSeconds = 0.0;
+                memset(&s_readPayload, 0, sizeof(s_readPayload));
+                for (int iteration = 0; iteration < numIterations; ++iteration)
+                {
+                    double startSeconds = GetCurrentTimeSeconds();
+                    BytePacker writer(buffer, BUFFER_SIZE, 0, endianness);
+                    WriteBenchPayload(writer, s_payload, type, method);
+                    double midSeconds = GetCurrentTimeSeconds();
+                    numBytes = writer.GetTotalReadableBytes();
+                    BytePacker reader(buffer, 0, numBytes, endianness);
+                    ReadBenchPayload(reader, s_readPayload, type, method);
+                    readSeconds += GetCurrentTimeSeconds() - midSeconds;
+                    writeSeconds += midSeconds - startSeconds;
+                }
+                if (method == BENCH_BYTEWISE)
+                {
+                    baselineSize = numBytes;
+                }
+
+                bool matchesBaseline = (numBytes == baselineSize) && memcmp(buffer, s_baselineBuffer, numBytes) == 0;
+                bool roundTripped = DoBenchPayloadsMatch(s_payload, s_readPayload, type);
+                bool passed = matchesBaseline && roundTripped;
+                ++numChecks;
+                numPassed += passed ? 1 : 0;
+                double megabytes = (double)numIterations * (double)numBytes / (1024.0 * 1024.0);
+                Console::instance->PrintLine(Stringf("  %s: %-13s %-7s %4u bytes %-10s write %7.0f MB/s, read %7.0f MB/s%s%s"
+                    , passed ? "PASS" : "FAIL"
+                    , endianName
+                    , BENCH_PAYLOAD_NAMES[type]
+                    , (unsigned int)numBytes
+                    , BENCH_METHOD_NAMES[method]
+                    , megabytes / writeSeconds
+                    , megabytes / readSeconds
+                    , matchesBaseline ? "" : ", bytes differ from bytewise"
+                    , roundTripped ? "" : ", didn't read back what was written"), passed ? RGBA::GREEN : RGBA::RED);
+            }
+        }
+    }
+    Console::instance->PrintLine(Stringf("bytepackerbench: %i/%i checks passed (%s machine, %i iterations)", numPassed, numChecks, (IBinaryReader::GetLocalEndianess() == IBinaryReader::BIG_ENDIAN) ? "big endian" : "little endian", numIterations), numPassed == numChecks ? RGBA::GREEN : RGBA::RED);
+}
@@ -0,0 +1,98 @@
+#include "Engine/DataStructures/ByteRingBuffer.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include <string.h>
+#include <algorithm>
+
+//-----------------------------------------------------------------------------------
+ByteRingBuffer::ByteRingBuffer(size_t capacity)
+    : m_data(nullptr)
+    , m_capacity(1)
+    , m_readIndex(0)
+    , m_size(0)
+{
+    while (m_capacity < capacity)
+    {
+        m_capacity <<= 1;
+    }
+    m_mask = m_capacity - 1;
+    m_data = new byte[m_capacity];
+}
+
+//-----------------------------------------------------------------------------------
+ByteRingBuffer::~ByteRingBuffer()
+{
+    delete[] m_data;
+}
+
+//-----------------------------------------------------------------------------------
+bool ByteRingBuffer::Write(const void* data, size_t numBytes)
+{
+    if (numBytes > GetFreeSpace())
+    {
+        return false;
+    }
+    const byte* source = (const byte*)data;
+    size_t writeIndex = (m_readIndex + m_size) & m_mask;
+    size_t firstPart = std::min(numBytes, m_capacity - writeIndex);
+    memcpy(m_data + writeIndex, source, firstPart);
+    memcpy(m_data, source + firstPart, numBytes - firstPart);
+    m_size += numBytes;
+    return true;
+}
+
+//-----------------------------------------------------------------------------------
+size_t ByteRingBuffer::Peek(void* outData, size_t numBytes, size_t offset) const
+{
+    if (offset >= m_size)
+    {
+        return 0;
+    }
+    numBytes = std::min(numBytes, m_size - offset);
+    byte* destination = (byte*)outData;
+    size_t peekIndex = (m_readIndex + offset) & m_mask;
+    size_t firstPart = std::min(numBytes, m_capacity - peekIndex);
+    memcpy(destination, m_data + peekIndex, firstPart);
+    memcpy(destination + firstPart, m_data, numBytes - firstPart);
+    return numBytes;
+}
+
+//-----------------------------------------------------------------------------------
+void ByteRingBuffer::Consume(size_t numBytes)
+{
+    ASSERT_OR_DIE(numBytes <= m_size, "Tried to consume more bytes than the ring buffer holds");
+    m_readIndex = (m_readIndex + numBytes) & m_mask;
+    m_size -= numBytes;
+    if (m_size == 0)
+    {
+        m_readIndex = 0; //Keeps the next write contiguous for as long as possible
+    }
+}
+
+//-----------------------------------------------------------------------------------
+void ByteRingBuffer::Clear()
+{
+    m_readIndex = 0;
+    m_size = 0;
+}
+
+//-----------------------------------------------------------------------------------
+byte* ByteRingBuffer::GetWriteRegion(size_t& outNumBytes)
+{
+    size_t writeIndex = (m_readIndex + m_size) & m_mask;
+    outNumBytes = std::min(GetFreeSpace(), m_capacity - writeIndex);
+    return m_data + writeIndex;
+}
+
+//-----------------------------------------------------------------------------------
+void ByteRingBuffer::CommitWrite(size_t numBytes)
+{
+    ASSERT_OR_DIE(numBytes <= GetFreeSpace(), "Tried to commit more bytes than the ring buffer has room for");
+    m_size += numBytes;
+}
+
+//-----------------------------------------------------------------------------------
+const byte* ByteRingBuffer::GetReadRegion(size_t& outNumBytes) const
+{
+    outNumBytes = std::min(m_size, m_capacity - m_readIndex);
+    return m_data + m_readIndex;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <stddef.h>
+
+typedef unsigned char byte;
+
+//-----------------------------------------------------------------------------------
+//Fixed size byte queue for streams, single threaded. Storage is allocated once up front and never grows, so a full buffer is the
+//caller's cue to stop producing. Sockets can read and write it in place through the contiguous regions: recv into
+//GetWriteRegion() then CommitWrite(n), send from GetReadRegion() then Consume(n). Either region may be shorter than the total
+//when the data wraps, in which case the rest is at the start of the storage and a second call picks it up.
+class ByteRingBuffer
+{
+public:
+    //CONSTRUCTORS/////////////////////////////////////////////////////////////////////
+    ByteRingBuffer(size_t capacity);
+    ~ByteRingBuffer();
+    ByteRingBuffer(const ByteRingBuffer&) = delete;
+    ByteRingBuffer& operator=(const ByteRingBuffer&) = delete;
+
+    //FUNCTIONS/////////////////////////////////////////////////////////////////////
+    bool Write(const void* data, size_t numBytes); //All or nothing, false if it doesn't fit
+    size_t Peek(void* outData, size_t numBytes, size_t offset = 0) const; //Copies without consuming, returns how many bytes were copied
+    void Consume(size_t numBytes);
+    void Clear();
+    byte* GetWriteRegion(size_t& outNumBytes);
+    void CommitWrite(size_t numBytes);
+    const byte* GetReadRegion(size_t& outNumBytes) const;
+
+    //GETTERS/////////////////////////////////////////////////////////////////////
+    inline size_t GetSize() const { return m_size; };
+    inline size_t GetCapacity() const { return m_capacity; };
+    inline size_t GetFreeSpace() const { return m_capacity - m_size; };
+    inline bool IsEmpty() const { return m_size == 0; };
+
+private:
+    //MEMBER VARIABLES/////////////////////////////////////////////////////////////////////
+    byte* m_data;
+    size_t m_capacity; //Always a power of two so offsets can be masked
+    size_t m_mask;
+    size_t m_readIndex;
+    size_t m_size;
+};
@@ -1,5 +1,5 @@
 #pragma once
-#include "Engine\Core\ErrorWarningAssert.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
 
 //-----------------------------------------------------------------------------------
 template <typename T>
@@ -31,6 +31,30 @@ void RemoveInPlace(T*& list, T* nodeToRemove)
     }
 }
 
+//-----------------------------------------------------------------------------------
+//Moves every node of otherList onto the back of list, keeping their order, and leaves otherList empty
+template <typename T>
+void AppendListInPlace(T*& list, T*& otherList)
+{
+    if (otherList == nullptr)
+    {
+        return;
+    }
+    if (list == nullptr)
+    {
+        list = otherList;
+        otherList = nullptr;
+        return;
+    }
+    T* last = list->prev;
+    T* otherLast = otherList->prev;
+    last->next = otherList;
+    otherList->prev = last;
+    otherLast->next = list;
+    list->prev = otherLast;
+    otherList = nullptr;
+}
+
 //-----------------------------------------------------------------------------------
 template <typename T>
 unsigned int GetCountInPlace(T* list)
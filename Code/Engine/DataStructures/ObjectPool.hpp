@@ -1,4 +1,6 @@
 #pragma once
+#include <stdlib.h>
+#include <new>
 
 template <typename T>
 class ObjectPool
@@ -31,13 +33,13 @@ public:
     }
 
     //-----------------------------------------------------------------------------------
-    template <typename T, typename ...ARGS>
-    T* Alloc(ARGS... args)
+    template <typename OBJECTTYPE, typename ...ARGS>
+    OBJECTTYPE* Alloc(ARGS... args)
     {
-        T *obj = (T*)m_freeList;
+        OBJECTTYPE *obj = (OBJECTTYPE*)m_freeList;
         m_freeList = m_freeList->next;
 
-        new (obj) T(args...);
+        new (obj) OBJECTTYPE(args...);
         return obj;
     }
 
@@ -0,0 +1,135 @@
+#pragma once
+#include <atomic>
+
+//-----------------------------------------------------------------------------------
+//Lock-free ring for exactly one producer thread and one consumer thread.
+//Slots are allocated once up front and are written and read in place, so big elements like packets never get copied through the queue:
+//the producer fills GetWriteSlot(0..n-1) then publishes them with CommitWrites(n), the consumer reads GetReadSlot(0..n-1) then hands them back with ReleaseReads(n).
+template <typename T>
+class SPSCRingBuffer
+{
+public:
+    SPSCRingBuffer(unsigned int capacity);
+    ~SPSCRingBuffer();
+
+    //Producer side
+    unsigned int GetNumWritable() const;
+    T* GetWriteSlot(unsigned int offset);
+    void CommitWrites(unsigned int count);
+    bool TryPush(const T& object);
+
+    //Consumer side
+    unsigned int GetNumReadable() const;
+    T* GetReadSlot(unsigned int offset);
+    void ReleaseReads(unsigned int count);
+    bool TryPop(T& outObject);
+
+    inline unsigned int GetCapacity() const { return m_capacity; };
+
+private:
+    static const unsigned int CACHE_LINE_SIZE = 64;
+
+    T* m_slots;
+    unsigned int m_capacity; //Always a power of two so indices can be masked
+    unsigned int m_mask;
+    char m_padding0[CACHE_LINE_SIZE];
+    std::atomic<unsigned int> m_writeIndex; //Free running, only advanced by the producer
+    char m_padding1[CACHE_LINE_SIZE];
+    std::atomic<unsigned int> m_readIndex; //Free running, only advanced by the consumer
+    char m_padding2[CACHE_LINE_SIZE];
+};
+
+//-----------------------------------------------------------------------------------
+template <typename T>
+SPSCRingBuffer<T>::SPSCRingBuffer(unsigned int capacity)
+    : m_slots(nullptr)
+    , m_capacity(1)
+    , m_writeIndex(0)
+    , m_readIndex(0)
+{
+    while (m_capacity < capacity)
+    {
+        m_capacity <<= 1;
+    }
+    m_mask = m_capacity - 1;
+    m_slots = new T[m_capacity];
+}
+
+//-----------------------------------------------------------------------------------
+template <typename T>
+SPSCRingBuffer<T>::~SPSCRingBuffer()
+{
+    delete[] m_slots;
+}
+
+//-----------------------------------------------------------------------------------
+template <typename T>
+unsigned int SPSCRingBuffer<T>::GetNumWritable() const
+{
+    unsigned int writeIndex = m_writeIndex.load(std::memory_order_relaxed);
+    unsigned int readIndex = m_readIndex.load(std::memory_order_acquire);
+    return m_capacity - (writeIndex - readIndex);
+}
+
+//-----------------------------------------------------------------------------------
+template <typename T>
+T* SPSCRingBuffer<T>::GetWriteSlot(unsigned int offset)
+{
+    return &m_slots[(m_writeIndex.load(std::memory_order_relaxed) + offset) & m_mask];
+}
+
+//-----------------------------------------------------------------------------------
+template <typename T>
+void SPSCRingBuffer<T>::CommitWrites(unsigned int count)
+{
+    m_writeIndex.store(m_writeIndex.load(std::memory_order_relaxed) + count, std::memory_order_release);
+}
+
+//-----------------------------------------------------------------------------------
+template <typename T>
+bool SPSCRingBuffer<T>::TryPush(const T& object)
+{
+    if (GetNumWritable() == 0)
+    {
+        return false;
+    }
+    *GetWriteSlot(0) = object;
+    CommitWrites(1);
+    return true;
+}
+
+//-----------------------------------------------------------------------------------
+template <typename T>
+unsigned int SPSCRingBuffer<T>::GetNumReadable() const
+{
+    unsigned int readIndex = m_readIndex.load(std::memory_order_relaxed);
+    unsigned int writeIndex = m_writeIndex.load(std::memory_order_acquire);
+    return writeIndex - readIndex;
+}
+
+//-----------------------------------------------------------------------------------
+template <typename T>
+T* SPSCRingBuffer<T>::GetReadSlot(unsigned int offset)
+{
+    return &m_slots[(m_readIndex.load(std::memory_order_relaxed) + offset) & m_mask];
+}
+
+//-----------------------------------------------------------------------------------
+template <typename T>
+void SPSCRingBuffer<T>::ReleaseReads(unsigned int count)
+{
+    m_readIndex.store(m_readIndex.load(std::memory_order_relaxed) + count, std::memory_order_release);
+}
+
+//-----------------------------------------------------------------------------------
+template <typename T>
+bool SPSCRingBuffer<T>::TryPop(T& outObject)
+{
+    if (GetNumReadable() == 0)
+    {
+        return false;
+    }
+    outObject = *GetReadSlot(0);
+    ReleaseReads(1);
+    return true;
+}
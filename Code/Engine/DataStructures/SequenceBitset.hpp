@@ -0,0 +1,65 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+
+//-----------------------------------------------------------------------------------
+//Fixed size bitset for a sliding window of wrapping 16 bit sequence numbers (acks, reliable ids, etc).
+//Sequence n lives in bit (n % NUM_BITS), so the owner is responsible for keeping the live window no wider than NUM_BITS
+//and for clearing bits as the window slides forward, since a bit gets reused every NUM_BITS sequence numbers.
+template <unsigned int NUM_BITS>
+class SequenceBitset
+{
+public:
+    //CONSTRUCTORS/////////////////////////////////////////////////////////////////////
+    SequenceBitset() { ClearAll(); };
+
+    //FUNCTIONS/////////////////////////////////////////////////////////////////////
+    inline void Set(uint16_t sequence) { m_words[GetWordIndex(sequence)] |= GetBitMask(sequence); };
+    inline void Clear(uint16_t sequence) { m_words[GetWordIndex(sequence)] &= ~GetBitMask(sequence); };
+    inline bool IsSet(uint16_t sequence) const { return (m_words[GetWordIndex(sequence)] & GetBitMask(sequence)) != 0; };
+    inline void ClearAll() { memset(m_words, 0, sizeof(m_words)); };
+    void ClearRange(uint16_t firstSequence, unsigned int count);
+
+    //CONSTANTS/////////////////////////////////////////////////////////////////////
+    static const unsigned int BITS_PER_WORD = 32;
+    static const unsigned int NUM_WORDS = NUM_BITS / BITS_PER_WORD;
+
+private:
+    static_assert((NUM_BITS & (NUM_BITS - 1)) == 0 && NUM_BITS >= BITS_PER_WORD && NUM_BITS <= 0x8000, "SequenceBitset size must be a power of two between 32 and half the sequence space");
+
+    //PRIVATE FUNCTIONS/////////////////////////////////////////////////////////////////////
+    static inline unsigned int GetWordIndex(uint16_t sequence) { return (sequence & (NUM_BITS - 1)) / BITS_PER_WORD; };
+    static inline uint32_t GetBitMask(uint16_t sequence) { return 1u << (sequence & (BITS_PER_WORD - 1)); };
+
+    //MEMBER VARIABLES/////////////////////////////////////////////////////////////////////
+    uint32_t m_words[NUM_WORDS];
+};
+
+//-----------------------------------------------------------------------------------
+//Clears count sequence numbers starting at firstSequence, wrapping around the window. Whole words are cleared at a time where possible.
+template <unsigned int NUM_BITS>
+void SequenceBitset<NUM_BITS>::ClearRange(uint16_t firstSequence, unsigned int count)
+{
+    if (count >= NUM_BITS)
+    {
+        ClearAll();
+        return;
+    }
+    uint16_t sequence = firstSequence;
+    while (count > 0)
+    {
+        unsigned int bitInWord = sequence & (BITS_PER_WORD - 1);
+        if (bitInWord == 0 && count >= BITS_PER_WORD)
+        {
+            m_words[GetWordIndex(sequence)] = 0;
+            sequence += BITS_PER_WORD;
+            count -= BITS_PER_WORD;
+        }
+        else
+        {
+            Clear(sequence);
+            ++sequence;
+            --count;
+        }
+    }
+}
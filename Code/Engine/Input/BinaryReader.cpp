@@ -5,12 +5,17 @@ bool BinaryFileReader::Open(const char* filePath)
 {
     const char* mode = "rb";
 
+#if defined(_WIN32)
     errno_t error = fopen_s(&fileHandle, filePath, mode);
     if (error != 0)
     {
         return false;
     }
     return true;
+#else
+    fileHandle = fopen(filePath, mode);
+    return fileHandle != nullptr;
+#endif
 }
 
 void BinaryFileReader::Close()
@@ -29,21 +34,27 @@ void* BinaryFileReader::ReadBytes(const size_t numBytes)
     return buffer;
 }
 
-IBinaryReader::Endianness IBinaryReader::GetLocalEndianess()
+size_t BinaryFileReader::ReadBytes(void* dest, const size_t numBytes)
 {
-    union {
-        byte byteData[4];
-        uint32_t uiData;
-    } data;
+    return fread(dest, sizeof(byte), numBytes, fileHandle);
+}
 
-    data.uiData = 0x04030201;
-    return(data.byteData[0] == 0x01) ? LITTLE_ENDIAN : BIG_ENDIAN;
+size_t IBinaryReader::ReadBytes(void* dest, const size_t numBytes)
+{
+    byte* readData = (byte*)ReadBytes(numBytes);
+    if (readData == nullptr)
+    {
+        return 0;
+    }
+    memcpy(dest, readData, numBytes);
+    delete[] readData;
+    return numBytes;
 }
 
 size_t IBinaryReader::ReadString(const char*& stringBuffer, size_t bufferSize)
 {
     UNUSED(bufferSize);
-    size_t bufferLength;
+    uint32_t bufferLength;
     Read<uint32_t>(bufferLength);
     if (bufferLength == 0U)
     {
@@ -1,6 +1,7 @@
 #pragma once
 #include <stdio.h>
 #include <stdint.h>
+#include "Engine/Input/ByteOrder.hpp"
 
 typedef unsigned char byte;
 
@@ -19,7 +20,12 @@ public:
     IBinaryReader(Endianness endianness) : m_endianMode(endianness) {};
 
     //GETTERS//////////////////////////////////////////////////////////////////////////
-    Endianness GetLocalEndianess();
+    static inline Endianness GetLocalEndianess()
+    {
+        const uint32_t probe = 0x04030201;
+        return (*(const byte*)&probe == 0x01) ? LITTLE_ENDIAN : BIG_ENDIAN;
+    };
+    inline bool NeedsByteSwap() const { return GetLocalEndianess() != m_endianMode; };
 
     //SETTERS//////////////////////////////////////////////////////////////////////////
     inline void SetEndianess(Endianness mode) { m_endianMode = mode; };
@@ -29,41 +35,32 @@ public:
     //Returns the number of bytes written. This is the core implementation that subclasses
     //need to support. Writes to the appropriate buffer the bytes.
     virtual void* ReadBytes(const size_t numBytes) = 0;
+    //Reads into dest rather than a new buffer, returns the number of bytes read. The default goes through the allocating
+    //version above, readers that can copy straight out should override it.
+    virtual size_t ReadBytes(void* dest, const size_t numBytes);
 
     //-----------------------------------------------------------------------------------
     template<typename T>
     void ByteSwap(T* source, const size_t numBytes)
     {
-        byte* data = (byte*)source;
-        byte* start = data;
-        byte* end = data + numBytes - 1;
-
-        while (start < end)
-        {
-            byte temp = *start;
-            *start = *end;
-            *end = temp;
-            ++start;
-            --end;
-        }
-
-        source = (T*)data;
+        ByteSwapInPlace(source, numBytes);
     }
 
     //-----------------------------------------------------------------------------------
     template<typename T>
     bool Read(T& data)
     {
-        void* readData = ReadBytes(sizeof(T));
-        memcpy(&data, readData, sizeof(T));
-        delete readData;
-        if (GetLocalEndianess() != m_endianMode)
+        if (ReadBytes(&data, sizeof(T)) != sizeof(T))
+        {
+            return false;
+        }
+        if (NeedsByteSwap())
         {
-            ByteSwap(&data, sizeof(T));
+            ByteSwapInPlace(&data, sizeof(T));
         }
         return true;
     }
-    
+
 private:
     Endianness m_endianMode;
 };
@@ -75,6 +72,7 @@ public:
     bool Open(const char* filePath);
     void Close();
     virtual void* ReadBytes(const size_t numBytes) override;
+    virtual size_t ReadBytes(void* dest, const size_t numBytes) override;
 
     //MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
     FILE* fileHandle;
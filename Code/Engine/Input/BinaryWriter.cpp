@@ -1,18 +1,6 @@
 #include "Engine/Input/BinaryWriter.hpp"
 #include <string.h>
 
-//-----------------------------------------------------------------------------------
-IBinaryWriter::Endianness IBinaryWriter::GetLocalEndianess()
-{
-	union {
-		byte byteData[4];
-		uint32_t uiData;
-	} data;
-
-	data.uiData = 0x04030201;
-	return(data.byteData[0] == 0x01) ? LITTLE_ENDIAN : BIG_ENDIAN;
-}
-
 //-----------------------------------------------------------------------------------
 //Want to be able to write
 //-nullptr
@@ -44,12 +32,17 @@ bool BinaryFileWriter::Open(const char* filename, bool append /*= false*/)
 		mode = "wb";
 	}
 
+#if defined(_WIN32)
 	errno_t error = fopen_s(&fileHandle, filename, mode);
 	if (error != 0)
 	{
 		return false;
 	}
 	return true;
+#else
+	fileHandle = fopen(filename, mode);
+	return fileHandle != nullptr;
+#endif
 }
 
 void BinaryFileWriter::Close()
@@ -1,6 +1,7 @@
 #pragma once
 #include <stdio.h>
 #include <stdint.h>
+#include "Engine/Input/ByteOrder.hpp"
 
 typedef unsigned char byte;
 
@@ -19,7 +20,12 @@ public:
     IBinaryWriter(Endianness endianness) : m_endianMode(endianness) {};
 
     //GETTERS//////////////////////////////////////////////////////////////////////////
-    Endianness GetLocalEndianess();
+    static inline Endianness GetLocalEndianess()
+    {
+        const uint32_t probe = 0x04030201;
+        return (*(const byte*)&probe == 0x01) ? LITTLE_ENDIAN : BIG_ENDIAN;
+    };
+    inline bool NeedsByteSwap() const { return GetLocalEndianess() != m_endianMode; };
 
     //SETTERS//////////////////////////////////////////////////////////////////////////
     inline void SetEndianess(Endianness mode) { m_endianMode = mode; };
@@ -34,20 +40,7 @@ public:
     template<typename T>
     void ByteSwap(T* source, const size_t numBytes)
     {
-        byte* data = (byte*)source;
-        byte* start = data;
-        byte* end = data + numBytes - 1;
-
-        while (start < end)
-        {
-            byte temp = *start;
-            *start = *end;
-            *end = temp;
-            ++start;
-            --end;
-        }
-
-        source = (T*)data;
+        ByteSwapInPlace(source, numBytes);
     }
 
     //-----------------------------------------------------------------------------------
@@ -55,9 +48,9 @@ public:
     bool Write(const T& data)
     {
         T copy = data;
-        if (GetLocalEndianess() != m_endianMode)
+        if (NeedsByteSwap())
         {
-            ByteSwap(&copy, sizeof(T));
+            ByteSwapInPlace(&copy, sizeof(T));
         }
         return WriteBytes(&copy, sizeof(T)) == sizeof(T);
     }
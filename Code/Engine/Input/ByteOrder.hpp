@@ -0,0 +1,142 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#if defined(_MSC_VER)
+#include <stdlib.h>
+#else
+//glibc defines these as macros, which would eat the Endianness enums. Most libc headers pull endian.h in anyway, so include it
+//here first and it can't come back and redefine them later.
+#include <endian.h>
+#undef LITTLE_ENDIAN
+#undef BIG_ENDIAN
+#endif
+
+typedef unsigned char byte;
+
+//-----------------------------------------------------------------------------------
+inline uint16_t ByteSwap16(uint16_t value)
+{
+#if defined(_MSC_VER)
+    return _byteswap_ushort(value);
+#else
+    return __builtin_bswap16(value);
+#endif
+}
+
+//-----------------------------------------------------------------------------------
+inline uint32_t ByteSwap32(uint32_t value)
+{
+#if defined(_MSC_VER)
+    return _byteswap_ulong(value);
+#else
+    return __builtin_bswap32(value);
+#endif
+}
+
+//-----------------------------------------------------------------------------------
+inline uint64_t ByteSwap64(uint64_t value)
+{
+#if defined(_MSC_VER)
+    return _byteswap_uint64(value);
+#else
+    return __builtin_bswap64(value);
+#endif
+}
+
+//-----------------------------------------------------------------------------------
+//Reverses numBytes bytes. 2, 4 and 8 byte values are swapped as one word, anything else a byte at a time. data doesn't need to be aligned.
+inline void ByteSwapInPlace(void* data, const size_t numBytes)
+{
+    switch (numBytes)
+    {
+    case 0:
+    case 1:
+        return;
+    case 2:
+    {
+        uint16_t word;
+        memcpy(&word, data, sizeof(word));
+        word = ByteSwap16(word);
+        memcpy(data, &word, sizeof(word));
+        return;
+    }
+    case 4:
+    {
+        uint32_t word;
+        memcpy(&word, data, sizeof(word));
+        word = ByteSwap32(word);
+        memcpy(data, &word, sizeof(word));
+        return;
+    }
+    case 8:
+    {
+        uint64_t word;
+        memcpy(&word, data, sizeof(word));
+        word = ByteSwap64(word);
+        memcpy(data, &word, sizeof(word));
+        return;
+    }
+    default:
+    {
+        byte* start = (byte*)data;
+        byte* end = start + numBytes - 1;
+        while (start < end)
+        {
+            byte temp = *start;
+            *start = *end;
+            *end = temp;
+            ++start;
+            --end;
+        }
+        return;
+    }
+    }
+}
+
+//-----------------------------------------------------------------------------------
+//Reverses each of numElements consecutive elementSize byte values, the same as calling ByteSwapInPlace on each, but with the size
+//only checked once so the 2, 4 and 8 byte loops stay tight enough for the compiler to vectorize.
+inline void ByteSwapElements(void* data, const size_t elementSize, const size_t numElements)
+{
+    byte* bytes = (byte*)data;
+    switch (elementSize)
+    {
+    case 0:
+    case 1:
+        return;
+    case 2:
+        for (size_t i = 0; i < numElements; ++i, bytes += 2)
+        {
+            uint16_t word;
+            memcpy(&word, bytes, sizeof(word));
+            word = ByteSwap16(word);
+            memcpy(bytes, &word, sizeof(word));
+        }
+        return;
+    case 4:
+        for (size_t i = 0; i < numElements; ++i, bytes += 4)
+        {
+            uint32_t word;
+            memcpy(&word, bytes, sizeof(word));
+            word = ByteSwap32(word);
+            memcpy(bytes, &word, sizeof(word));
+        }
+        return;
+    case 8:
+        for (size_t i = 0; i < numElements; ++i, bytes += 8)
+        {
+            uint64_t word;
+            memcpy(&word, bytes, sizeof(word));
+            word = ByteSwap64(word);
+            memcpy(bytes, &word, sizeof(word));
+        }
+        return;
+    default:
+        for (size_t i = 0; i < numElements; ++i, bytes += elementSize)
+        {
+            ByteSwapInPlace(bytes, elementSize);
+        }
+        return;
+    }
+}
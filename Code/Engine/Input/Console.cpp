@@ -331,12 +331,14 @@ void Console::RegisterCommand(const char* commandName, ConsoleCommandFunctionPoi
 void Console::PrintLine(std::string consoleLine, RGBA color)
 {
     m_consoleHistory.push_back(new ColoredText(consoleLine, color));
+    m_onPrintLine.Trigger(consoleLine, color);
 }
 
 //-----------------------------------------------------------------------------------
 ColoredText* Console::PrintDynamicLine(std::string consoleLine, RGBA color /*= RGBA::WHITE*/)
 {
     m_consoleHistory.push_back(new ColoredText(consoleLine, color));
+    m_onPrintLine.Trigger(consoleLine, color);
     return *(--m_consoleHistory.end());
 }
 
@@ -62,6 +62,7 @@ public:
     BitmapFont* m_font;
     Event<> m_consoleUpdate;
     Event<> m_consoleClear;
+    Event<const std::string&, const RGBA&> m_onPrintLine; //Every line as it's printed, for mirroring the console elsewhere
 
 private:
     //CONSTANTS//////////////////////////////////////////////////////////////////////////
@@ -1,20 +1,34 @@
 #include "Engine/Input/InputOutputUtils.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
+#if defined(_WIN32)
 #include "Engine/Core/Events/EventSystem.hpp"
 #include <windows.h>
 #include <strsafe.h>
+#endif
+#include <stdio.h>
 #include <fstream>
 #include <deque>
 
 //-----------------------------------------------------------------------------------
-bool LoadBufferFromBinaryFile(std::vector<unsigned char>& out_buffer, const std::string& filePath)
+static FILE* OpenFile(const std::string& filePath, const char* mode)
 {
+#if defined(_WIN32)
     FILE* file = nullptr;
-    errno_t errorCode = fopen_s(&file, filePath.c_str(), "rb"); //returns a failure state. If failure, return false.
-    if(errorCode != 0x0) 
-    { 
-        return false; 
-    };
+    errno_t errorCode = fopen_s(&file, filePath.c_str(), mode);
+    return (errorCode == 0x0) ? file : nullptr;
+#else
+    return fopen(filePath.c_str(), mode);
+#endif
+}
+
+//-----------------------------------------------------------------------------------
+bool LoadBufferFromBinaryFile(std::vector<unsigned char>& out_buffer, const std::string& filePath)
+{
+    FILE* file = OpenFile(filePath, "rb");
+    if (file == nullptr)
+    {
+        return false;
+    }
     fseek(file, 0, SEEK_END);
     long size = ftell(file);
     rewind(file);
@@ -27,17 +41,17 @@ bool LoadBufferFromBinaryFile(std::vector<unsigned char>& out_buffer, const std:
 //-----------------------------------------------------------------------------------
 bool SaveBufferToBinaryFile(const std::vector<unsigned char>& buffer, const std::string& filePath)
 {
-    FILE* file = nullptr;
-    errno_t errorCode = fopen_s(&file, filePath.c_str(), "wb"); //returns a failure state. If failure, return false.
-    if (errorCode != 0x0)
+    FILE* file = OpenFile(filePath, "wb");
+    if (file == nullptr)
     {
         return false;
-    };
+    }
     fwrite(&buffer[0], sizeof(unsigned char), buffer.size(), file);
     fclose(file);
     return true;
 }
 
+#if defined(_WIN32)
 //-----------------------------------------------------------------------------------
 bool EnsureDirectoryExists(const std::string& directoryPath)
 {
@@ -55,6 +69,7 @@ bool EnsureDirectoryExists(const std::string& directoryPath)
     }
     return success;
 }
+#endif
 
 //-----------------------------------------------------------------------------------
 bool ReadTextFileIntoVector(std::vector<std::string>& outBuffer, const std::string& filePath)
@@ -71,12 +86,11 @@ bool ReadTextFileIntoVector(std::vector<std::string>& outBuffer, const std::stri
 //-----------------------------------------------------------------------------------
 char* FileReadIntoNewBuffer(const std::string& filePath)
 {
-    FILE* file = nullptr;
-    errno_t errorCode = fopen_s(&file, filePath.c_str(), "rb"); //returns a failure state. If failure, return false.
-    if (errorCode != 0x0)
+    FILE* file = OpenFile(filePath, "rb");
+    if (file == nullptr)
     {
-        return false;
-    };
+        return nullptr;
+    }
     fseek(file, 0, SEEK_END);
     long size = ftell(file);
     rewind(file);
@@ -87,6 +101,7 @@ char* FileReadIntoNewBuffer(const std::string& filePath)
     return buffer;
 }
 
+#if defined(_WIN32)
 //-----------------------------------------------------------------------------------
 std::wstring RelativeToFullPath(const std::wstring& relativePath)
 {
@@ -261,6 +276,7 @@ std::vector<std::string> EnumerateDirectories(const std::wstring& baseDirectory,
     }
     return fileNames;
 }
+#endif
 
 //-----------------------------------------------------------------------------------
 //Modified from http://www.cplusplus.com/forum/general/1796/
@@ -271,6 +287,7 @@ bool FileExists(const std::string& filename)
     return (bool)ifile;
 }
 
+#if defined(_WIN32)
 //-----------------------------------------------------------------------------------
 //Modified from https://stackoverflow.com/a/6218445/2619871
 bool DirectoryExists(const std::wstring& directoryPath)
@@ -279,3 +296,4 @@ bool DirectoryExists(const std::wstring& directoryPath)
     DWORD dwAttrib = GetFileAttributes(wideDirectoryPath);
     return (dwAttrib != INVALID_FILE_ATTRIBUTES && (dwAttrib & FILE_ATTRIBUTE_DIRECTORY));
 }
+#endif
@@ -2,6 +2,8 @@
 #include <vector>
 #include <string>
 
+typedef unsigned char byte;
+
 bool LoadBufferFromBinaryFile(std::vector<unsigned char>& out_buffer, const std::string& filePath);
 bool SaveBufferToBinaryFile(const std::vector<unsigned char>& buffer, const std::string& filePath);
 bool EnsureDirectoryExists(const std::string& directoryPath);
@@ -50,7 +50,9 @@ void LoggerThreadMain()
 //-----------------------------------------------------------------------------------
 Logger::Logger()
     : m_file(nullptr)
+    , m_nextLineSequence(0)
 {
+    InitializeCriticalSection(&m_recentLinesCriticalSection);
     CreateLogFile();
     CleanUpOldLogFiles();
 }
@@ -67,6 +69,7 @@ Logger::~Logger()
     Logger::instance->FlushLog();
     fclose(m_file);
     Logger::instance->CopyLogFileAsLatest();
+    DeleteCriticalSection(&m_recentLinesCriticalSection);
 }
 
 //-----------------------------------------------------------------------------------
@@ -173,6 +176,7 @@ void Logger::Log(const char* message)
 void Logger::Log(LogMessage* message)
 {
     fwrite(message->formattedMessage, sizeof(unsigned char), strlen(message->formattedMessage), m_file);
+    RecordRecentLine(message->formattedMessage);
     #ifdef FORWARD_LOG_TO_OUTPUT_WINDOW
     {
         DebuggerPrintf(message->formattedMessage);
@@ -188,6 +192,50 @@ void Logger::Log(LogMessage* message)
     #endif // FORWARD_LOG_TO_CONSOLE
 }
 
+//-----------------------------------------------------------------------------------
+//Appends each line from inOutSequence on to outLines with a null after it, oldest first, stopping before outLines would pass maxBytes.
+//Moves inOutSequence past what was read. Returns how many of the lines asked for had already been overwritten.
+unsigned int Logger::ReadRecentLines(uint64_t& inOutSequence, std::string& outLines, size_t maxBytes, unsigned int& outNumLines)
+{
+    unsigned int numOverwritten = 0;
+    outNumLines = 0;
+    EnterCriticalSection(&m_recentLinesCriticalSection);
+    {
+        uint64_t oldestSequence = (m_nextLineSequence > NUM_RECENT_LINES) ? m_nextLineSequence - NUM_RECENT_LINES : 0;
+        if (inOutSequence < oldestSequence)
+        {
+            numOverwritten = (unsigned int)(oldestSequence - inOutSequence);
+            inOutSequence = oldestSequence;
+        }
+        while (inOutSequence < m_nextLineSequence)
+        {
+            const char* line = m_recentLines[inOutSequence % NUM_RECENT_LINES];
+            size_t lineLength = strlen(line);
+            if (outLines.size() + lineLength + 1 > maxBytes)
+            {
+                break;
+            }
+            outLines.append(line, lineLength + 1);
+            ++inOutSequence;
+            ++outNumLines;
+        }
+    }
+    LeaveCriticalSection(&m_recentLinesCriticalSection);
+    return numOverwritten;
+}
+
+//-----------------------------------------------------------------------------------
+void Logger::RecordRecentLine(const char* line)
+{
+    EnterCriticalSection(&m_recentLinesCriticalSection);
+    {
+        char* recentLine = m_recentLines[m_nextLineSequence % NUM_RECENT_LINES];
+        strncpy_s(recentLine, MAX_RECENT_LINE_LENGTH, line, _TRUNCATE);
+        ++m_nextLineSequence;
+    }
+    LeaveCriticalSection(&m_recentLinesCriticalSection);
+}
+
 //-----------------------------------------------------------------------------------
 static void LogPrintf(LogLevel level, const char* format, va_list args)
 {
@@ -50,6 +50,11 @@ public:
     void CreateLogFile();
     void CleanUpOldLogFiles();
     void CopyLogFileAsLatest();
+    unsigned int ReadRecentLines(uint64_t& inOutSequence, std::string& outLines, size_t maxBytes, unsigned int& outNumLines);
+
+    //CONSTANTS/////////////////////////////////////////////////////////////////////
+    static const unsigned int NUM_RECENT_LINES = 512; //Kept for following the log live, older ones are overwritten
+    static const unsigned int MAX_RECENT_LINE_LENGTH = 256; //Longer lines are cut short in the recent lines, not in the file
 
     //STATIC VARIABLES/////////////////////////////////////////////////////////////////////
     static Logger* instance;
@@ -60,7 +65,12 @@ public:
     std::string m_fileName;
 
 private:
+    void RecordRecentLine(const char* line);
+
     ThreadSafeQueue<LogMessage> m_loggingQueue;
+    char m_recentLines[NUM_RECENT_LINES][MAX_RECENT_LINE_LENGTH];
+    uint64_t m_nextLineSequence; //Sequence number the next line written will get
+    CRITICAL_SECTION m_recentLinesCriticalSection;
 };
 
 //GLOBAL FUNCTIONS/////////////////////////////////////////////////////////////////////
@@ -0,0 +1,233 @@
+#include "Engine/Math/Quaternion.hpp"
+#include "Engine/Math/Matrix4x4.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include <cmath>
+
+const Quaternion Quaternion::IDENTITY = Quaternion(0.0f, 0.0f, 0.0f, 1.0f);
+const float Quaternion::SMALLEST_THREE_RANGE = 0.70710678f;
+
+//-----------------------------------------------------------------------------------
+//Expects a pure rotation (orthonormal basis). Based off of Shoemake's method, picking the largest diagonal to stay stable.
+Quaternion Quaternion::FromMatrix(const Matrix4x4& rotationMatrix)
+{
+    const float* m = rotationMatrix.data;
+    float m00 = m[0];  float m01 = m[1];  float m02 = m[2];
+    float m10 = m[4];  float m11 = m[5];  float m12 = m[6];
+    float m20 = m[8];  float m21 = m[9];  float m22 = m[10];
+
+    Quaternion result;
+    float trace = m00 + m11 + m22;
+    if (trace > 0.0f)
+    {
+        float s = 0.5f / sqrtf(trace + 1.0f);
+        result.w = 0.25f / s;
+        result.x = (m21 - m12) * s;
+        result.y = (m02 - m20) * s;
+        result.z = (m10 - m01) * s;
+    }
+    else if (m00 > m11 && m00 > m22)
+    {
+        float s = 2.0f * sqrtf(1.0f + m00 - m11 - m22);
+        result.w = (m21 - m12) / s;
+        result.x = 0.25f * s;
+        result.y = (m01 + m10) / s;
+        result.z = (m02 + m20) / s;
+    }
+    else if (m11 > m22)
+    {
+        float s = 2.0f * sqrtf(1.0f + m11 - m00 - m22);
+        result.w = (m02 - m20) / s;
+        result.x = (m01 + m10) / s;
+        result.y = 0.25f * s;
+        result.z = (m12 + m21) / s;
+    }
+    else
+    {
+        float s = 2.0f * sqrtf(1.0f + m22 - m00 - m11);
+        result.w = (m10 - m01) / s;
+        result.x = (m02 + m20) / s;
+        result.y = (m12 + m21) / s;
+        result.z = 0.25f * s;
+    }
+    result.Normalize();
+    return result;
+}
+
+//-----------------------------------------------------------------------------------
+float Quaternion::Dot(const Quaternion& first, const Quaternion& second)
+{
+    return (first.x * second.x) + (first.y * second.y) + (first.z * second.z) + (first.w * second.w);
+}
+
+//-----------------------------------------------------------------------------------
+//Cheap approximation of slerp, good enough between neighboring keyframes.
+Quaternion Quaternion::Nlerp(const Quaternion& start, const Quaternion& end, float fraction)
+{
+    //Take the short way around the hypersphere
+    float sign = (Dot(start, end) < 0.0f) ? -1.0f : 1.0f;
+    float inverseFraction = 1.0f - fraction;
+    float endFraction = fraction * sign;
+    Quaternion result(
+        (start.x * inverseFraction) + (end.x * endFraction),
+        (start.y * inverseFraction) + (end.y * endFraction),
+        (start.z * inverseFraction) + (end.z * endFraction),
+        (start.w * inverseFraction) + (end.w * endFraction));
+    result.Normalize();
+    return result;
+}
+
+//-----------------------------------------------------------------------------------
+Quaternion Quaternion::Slerp(const Quaternion& start, const Quaternion& end, float fraction)
+{
+    float cosTheta = Dot(start, end);
+    Quaternion target = end;
+    if (cosTheta < 0.0f)
+    {
+        cosTheta = -cosTheta;
+        target = -end;
+    }
+
+    //Nearly parallel, sin(theta) goes to zero so fall back on the linear version.
+    if (cosTheta > 0.9995f)
+    {
+        return Nlerp(start, target, fraction);
+    }
+
+    float theta = acosf(cosTheta);
+    float inverseSinTheta = 1.0f / sinf(theta);
+    float startWeight = sinf((1.0f - fraction) * theta) * inverseSinTheta;
+    float endWeight = sinf(fraction * theta) * inverseSinTheta;
+    return Quaternion(
+        (start.x * startWeight) + (target.x * endWeight),
+        (start.y * startWeight) + (target.y * endWeight),
+        (start.z * startWeight) + (target.z * endWeight),
+        (start.w * startWeight) + (target.w * endWeight));
+}
+
+//-----------------------------------------------------------------------------------
+float Quaternion::AngleBetweenRadians(const Quaternion& first, const Quaternion& second)
+{
+    float absDot = fabsf(Dot(first, second));
+    absDot = (absDot > 1.0f) ? 1.0f : absDot;
+    return 2.0f * acosf(absDot);
+}
+
+//-----------------------------------------------------------------------------------
+//Splits an affine transform into translation, rotation, and per-axis scale. A mirrored basis is stored as a negative x scale.
+void Quaternion::DecomposeMatrix(const Matrix4x4& transform, Vector3& outTranslation, Quaternion& outRotation, Vector3& outScale)
+{
+    static const float MIN_SCALE = 0.000001f;
+    Vector3 right, up, forward;
+    Matrix4x4::GetBasis(transform, right, up, forward, outTranslation);
+
+    outScale = Vector3(right.CalculateMagnitude(), up.CalculateMagnitude(), forward.CalculateMagnitude());
+    if (::Dot(Vector3::Cross(right, up), forward) < 0.0f)
+    {
+        outScale.x = -outScale.x;
+    }
+
+    right = (fabsf(outScale.x) > MIN_SCALE) ? right * (1.0f / outScale.x) : Vector3::UNIT_X;
+    up = (fabsf(outScale.y) > MIN_SCALE) ? up * (1.0f / outScale.y) : Vector3::UNIT_Y;
+    forward = (fabsf(outScale.z) > MIN_SCALE) ? forward * (1.0f / outScale.z) : Vector3::UNIT_Z;
+    outRotation = FromMatrix(Matrix4x4::MatrixFromBasis(right, up, forward, Vector3::ZERO));
+}
+
+//-----------------------------------------------------------------------------------
+Matrix4x4 Quaternion::ComposeMatrix(const Vector3& translation, const Quaternion& rotation, const Vector3& scale)
+{
+    Vector3 right, up, forward;
+    rotation.GetBasis(right, up, forward);
+    return Matrix4x4::MatrixFromBasis(right * scale.x, up * scale.y, forward * scale.z, translation);
+}
+
+//-----------------------------------------------------------------------------------
+//Smallest-three encoding, shared by everything that packs rotations: the largest component is dropped, since the unit length rebuilds it,
+//and the rest are flipped so it's positive (q and -q are the same rotation). Returns the dropped component's index, x y z w order.
+unsigned int Quaternion::ToSmallestThree(const Quaternion& rotation, float outSmallestThree[3])
+{
+    Quaternion normalized = rotation;
+    normalized.Normalize();
+    const float components[4] = { normalized.x, normalized.y, normalized.z, normalized.w };
+    unsigned int largestIndex = 0;
+    for (unsigned int i = 1; i < 4; ++i)
+    {
+        if (fabsf(components[i]) > fabsf(components[largestIndex]))
+        {
+            largestIndex = i;
+        }
+    }
+    float sign = (components[largestIndex] < 0.0f) ? -1.0f : 1.0f;
+    unsigned int smallIndex = 0;
+    for (unsigned int i = 0; i < 4; ++i)
+    {
+        if (i != largestIndex)
+        {
+            outSmallestThree[smallIndex++] = components[i] * sign;
+        }
+    }
+    return largestIndex;
+}
+
+//-----------------------------------------------------------------------------------
+Quaternion Quaternion::FromSmallestThree(unsigned int largestIndex, const float smallestThree[3])
+{
+    float components[4];
+    float sumOfSquares = 0.0f;
+    unsigned int smallIndex = 0;
+    for (unsigned int i = 0; i < 4; ++i)
+    {
+        if (i != largestIndex)
+        {
+            components[i] = smallestThree[smallIndex++];
+            sumOfSquares += components[i] * components[i];
+        }
+    }
+    components[largestIndex] = sqrtf(Max<float>(1.0f - sumOfSquares, 0.0f));
+    Quaternion rotation(components[0], components[1], components[2], components[3]);
+    rotation.Normalize();
+    return rotation;
+}
+
+//-----------------------------------------------------------------------------------
+void Quaternion::Normalize()
+{
+    float lengthSquared = Dot(*this, *this);
+    if (lengthSquared > 0.0f)
+    {
+        float inverseLength = 1.0f / sqrtf(lengthSquared);
+        x *= inverseLength;
+        y *= inverseLength;
+        z *= inverseLength;
+        w *= inverseLength;
+    }
+    else
+    {
+        *this = IDENTITY;
+    }
+}
+
+//-----------------------------------------------------------------------------------
+Quaternion Quaternion::GetConjugate() const
+{
+    return Quaternion(-x, -y, -z, w);
+}
+
+//-----------------------------------------------------------------------------------
+Matrix4x4 Quaternion::GetMatrix() const
+{
+    Vector3 right, up, forward;
+    GetBasis(right, up, forward);
+    return Matrix4x4::MatrixFromBasis(right, up, forward, Vector3::ZERO);
+}
+
+//-----------------------------------------------------------------------------------
+void Quaternion::GetBasis(Vector3& outRight, Vector3& outUp, Vector3& outForward) const
+{
+    float xx = x * x;  float yy = y * y;  float zz = z * z;
+    float xy = x * y;  float xz = x * z;  float yz = y * z;
+    float wx = w * x;  float wy = w * y;  float wz = w * z;
+
+    outRight = Vector3(1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy));
+    outUp = Vector3(2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx));
+    outForward = Vector3(2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy));
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include "Engine/Math/Vector3.hpp"
+
+class Matrix4x4;
+
+//-----------------------------------------------------------------------------------
+//Unit quaternion used to store joint rotations compactly. Follows the same convention as Matrix4x4,
+//where the basis vectors live in the columns (data[0], data[4], data[8] is right, etc).
+class Quaternion
+{
+public:
+    //CONSTRUCTORS//////////////////////////////////////////////////////////////////////////
+    Quaternion() {};
+    Quaternion(float initialX, float initialY, float initialZ, float initialW) : x(initialX), y(initialY), z(initialZ), w(initialW) {};
+
+    //STATIC FUNCTIONS//////////////////////////////////////////////////////////////////////////
+    static Quaternion FromMatrix(const Matrix4x4& rotationMatrix);
+    static float Dot(const Quaternion& first, const Quaternion& second);
+    static Quaternion Nlerp(const Quaternion& start, const Quaternion& end, float fraction);
+    static Quaternion Slerp(const Quaternion& start, const Quaternion& end, float fraction);
+    static float AngleBetweenRadians(const Quaternion& first, const Quaternion& second);
+    static void DecomposeMatrix(const Matrix4x4& transform, Vector3& outTranslation, Quaternion& outRotation, Vector3& outScale);
+    static Matrix4x4 ComposeMatrix(const Vector3& translation, const Quaternion& rotation, const Vector3& scale);
+    static unsigned int ToSmallestThree(const Quaternion& rotation, float outSmallestThree[3]);
+    static Quaternion FromSmallestThree(unsigned int largestIndex, const float smallestThree[3]);
+
+    //FUNCTIONS//////////////////////////////////////////////////////////////////////////
+    void Normalize();
+    Quaternion GetConjugate() const;
+    Matrix4x4 GetMatrix() const;
+    void GetBasis(Vector3& outRight, Vector3& outUp, Vector3& outForward) const;
+
+    //CONSTANTS//////////////////////////////////////////////////////////////////////////
+    static const Quaternion IDENTITY;
+    static const float SMALLEST_THREE_RANGE; //Once the largest component is dropped, the other three all fit in [-SMALLEST_THREE_RANGE, SMALLEST_THREE_RANGE]
+
+    //MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
+    float x;
+    float y;
+    float z;
+    float w;
+};
+
+//----------------------------------------------------------------------
+inline Quaternion operator*(const Quaternion& lhs, const Quaternion& rhs)
+{
+    return Quaternion(
+        (lhs.w * rhs.x) + (lhs.x * rhs.w) + (lhs.y * rhs.z) - (lhs.z * rhs.y),
+        (lhs.w * rhs.y) - (lhs.x * rhs.z) + (lhs.y * rhs.w) + (lhs.z * rhs.x),
+        (lhs.w * rhs.z) + (lhs.x * rhs.y) - (lhs.y * rhs.x) + (lhs.z * rhs.w),
+        (lhs.w * rhs.w) - (lhs.x * rhs.x) - (lhs.y * rhs.y) - (lhs.z * rhs.z)
+        );
+}
+
+//----------------------------------------------------------------------
+inline Quaternion operator-(const Quaternion& rhs)
+{
+    return Quaternion(-rhs.x, -rhs.y, -rhs.z, -rhs.w);
+}
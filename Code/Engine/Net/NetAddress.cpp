@@ -0,0 +1,113 @@
+#include "Engine/Net/NetAddress.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include <string.h>
+#include <stdio.h>
+
+//Code based off of code written by Professor Christopher Forseth
+
+//-----------------------------------------------------------------------------------
+//Get Local Host Name (stored in a global buffer - NOT THREAD SAFE)
+const char* NetAddress::GetLocalHostName()
+{
+    static char buffer[256];
+    if (gethostname(buffer, 256) == 0) 
+    {
+        return buffer;
+    }
+    else 
+    {
+#if defined(_WIN32)
+        int error = WSAGetLastError();
+#else
+        int error = errno;
+#endif
+        ERROR_RECOVERABLE(Stringf("Failed to get the local host name. Error[%u]\n", error));
+        return "localhost";
+    }
+}
+
+//-----------------------------------------------------------------------------------
+//Converting a sockaddr_in to a String
+//Again, doing this in a global buffer so it is NOT THREAD SAFE
+const char* NetAddress::SockAddrToString(const sockaddr* address)
+{
+    static char buffer[256];
+
+    if (!address)
+    {
+        return "Invalid Sockaddr";
+    }
+
+    // Hard coding this for sockaddr_in for brevity
+    // You can make this work for IPv6 as well
+    sockaddr_in *addr_in = (sockaddr_in*)address;
+
+    // inet_ntop converts an address type to a human readable string,
+    // ie 0x7f000001 => "127.0.0.1"
+    // GetInAddr (defined below) gets the pointer to the address part of the sockaddr
+    char hostname[256];
+    inet_ntop(addr_in->sin_family, GetInAddr(address), hostname, 256);
+
+    // Combine the above with the port.  
+    // Port is stored in network order, so convert it to host order
+    // using ntohs (Network TO Host Short)
+    snprintf(buffer, 256, "%s:%u", hostname, ntohs(addr_in->sin_port));
+
+    // buffer is static - so will not go out of scope, but that means this is not thread safe.
+    return buffer;
+}
+
+//-----------------------------------------------------------------------------------
+bool NetAddress::StringToSockAddrIPv4(sockaddr_in& outSockAddr, const char* string)
+{
+#pragma todo("Does this actually work?")
+    unsigned long address = inet_addr(string);
+    if (address == INADDR_NONE) 
+    {
+        DebuggerPrintf("StringToSockAddrIPv4 failed and returned INADDR_NONE.\n");
+        return false;
+    }
+    if (address == INADDR_ANY) 
+    {
+        DebuggerPrintf("StringToSockAddrIPv4 failed and returned INADDR_ANY.\n");
+        return false;
+    }
+    outSockAddr.sin_addr.s_addr = (uint32_t)address;
+    return true;
+}
+
+//-----------------------------------------------------------------------------------
+sockaddr_in NetAddress::StringToSockAddrIPv4(const char* ip, const uint16_t port)
+{
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(sockaddr_in));
+    addr.sin_addr.s_addr = inet_addr(ip);
+    addr.sin_port = htons(port);
+    addr.sin_family = AF_INET;
+
+    return addr;
+}
+
+//-----------------------------------------------------------------------------------
+//Get address part of a sockaddr, IPv4 or IPv6:
+void* NetAddress::GetInAddr(const sockaddr* socketAddress)
+{
+    if (socketAddress->sa_family == AF_INET) 
+    {
+        return &(((sockaddr_in*)socketAddress)->sin_addr);
+    }
+    else 
+    {
+        return &(((sockaddr_in6*)socketAddress)->sin6_addr);
+    }
+}
+
+//-----------------------------------------------------------------------------------
+bool NetAddress::SockaddrCompare(const sockaddr_in& first, const sockaddr_in& second)
+{
+#pragma todo("Move this into a sockaddr wrapper class")
+    bool addressesMatch = ntohl(first.sin_addr.s_addr) == ntohl(second.sin_addr.s_addr);
+    bool portsMatch = ntohs(first.sin_port) == ntohs(second.sin_port);
+    return addressesMatch && portsMatch;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+#if defined(_WIN32)
+#pragma comment(lib, "ws2_32")
+#define _WINSOCK_DEPRECATED_NO_WARNINGS
+#include <WinSock2.h>
+#include <WS2tcpip.h>
+#else
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+typedef int SOCKET;
+#define INVALID_SOCKET (-1)
+#define SOCKET_ERROR (-1)
+#endif
+
+//-----------------------------------------------------------------------------------
+//Address helpers that don't need the socket library started, so the UDP session code can use them on any platform.
+//Sockets themselves are NetSystem's (TCP) or a UDPTransport's.
+class NetAddress
+{
+public:
+    //STATIC FUNCTIONS/////////////////////////////////////////////////////////////////////
+    static const char* GetLocalHostName();
+    static const char* SockAddrToString(const sockaddr* address);
+    static bool StringToSockAddrIPv4(sockaddr_in& outSockAddr, const char* string);
+    static sockaddr_in StringToSockAddrIPv4(const char* ip, const uint16_t port);
+    static void* GetInAddr(const sockaddr* socketAddress);
+    static bool SockaddrCompare(const sockaddr_in& first, const sockaddr_in& second);
+};
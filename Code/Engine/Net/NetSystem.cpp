@@ -30,23 +30,6 @@ NetSystem::~NetSystem()
     WSACleanup();
 }
 
-//-----------------------------------------------------------------------------------
-//Get Local Host Name (stored in a global buffer - NOT THREAD SAFE)
-const char* NetSystem::GetLocalHostName()
-{
-    static char buffer[256];
-    if (gethostname(buffer, 256) == 0) 
-    {
-        return buffer;
-    }
-    else 
-    {
-        int error = WSAGetLastError();
-        ERROR_RECOVERABLE(Stringf("Failed to get the local host name. Error[%u]\n", error));
-        return "localhost";
-    }
-}
-
 //-----------------------------------------------------------------------------------
 // Get All Addresses that match our criteria
 addrinfo* NetSystem::AllocAddressesForHost(char const* hostName, // host, like google.com
@@ -92,7 +75,7 @@ void NetSystem::FreeAddresses(addrinfo* addresses)
 sockaddr* NetSystem::GetLocalHostAddressUDP(const char* portNumber)
 {
 #pragma todo("I'm pretty sure this leaks memory, clean this up")
-    addrinfo* infoList = AllocAddressesForHost(GetLocalHostName(), // an address for this machine
+    addrinfo* infoList = AllocAddressesForHost(NetAddress::GetLocalHostName(), // an address for this machine
         portNumber, //service, which for TCP/IP is the port as a string (ex: "80")
         AF_INET, //We're doing IPv4 in class
         SOCK_DGRAM, //UDP
@@ -107,15 +90,6 @@ sockaddr* NetSystem::GetLocalHostAddressUDP(const char* portNumber)
     }
 }
 
-//-----------------------------------------------------------------------------------
-bool NetSystem::SockaddrCompare(const sockaddr_in& first, const sockaddr_in& second)
-{
-#pragma todo("Move this into a sockaddr wrapper class")
-    bool addressesMatch = ntohl(first.sin_addr.s_addr) == ntohl(second.sin_addr.s_addr);
-    bool portsMatch = ntohs(first.sin_port) == ntohs(second.sin_port);
-    return addressesMatch && portsMatch;
-}
-
 //-----------------------------------------------------------------------------------
 // Binding a TCP Socket for Listening Purposes
 SOCKET NetSystem::CreateListenSocket(const char* hostName, 
@@ -133,7 +107,7 @@ SOCKET NetSystem::CreateListenSocket(const char* hostName,
     if (infoList == nullptr) 
     {
         //No addresses match - FAIL
-        return false;
+        return INVALID_SOCKET;
     }
 
     //Alright, try to create a SOCKET from this address info
@@ -159,7 +133,7 @@ SOCKET NetSystem::CreateListenSocket(const char* hostName,
                 ioctlsocket(mySocket, FIONBIO, &non_blocking);
 
                 // Set it to listen - this will allow people to connect to us
-                result = listen(mySocket, 2);
+                result = listen(mySocket, SOMAXCONN); //Many tools can connect in the same frame
                 ASSERT_OR_DIE(result != SOCKET_ERROR, "Error occurred while creating a listen socket."); // sanity check
 
                 // Save off the address if available.
@@ -234,7 +208,7 @@ SOCKET NetSystem::JoinSocket(const char* address, const char* service, sockaddr_
     // We'll be sending to it.
     addrinfo* infoList = AllocAddressesForHost(address, service, AF_INET, SOCK_STREAM, 0);
     if (infoList == nullptr) {
-        return false;
+        return INVALID_SOCKET;
     }
 
     SOCKET mySocket = INVALID_SOCKET;
@@ -282,6 +256,31 @@ void NetSystem::CloseSocket(SOCKET sock)
     closesocket(sock);
 }
 
+//-----------------------------------------------------------------------------------
+bool NetSystem::SetSocketNonBlocking(SOCKET sock)
+{
+    u_long non_blocking = 1;
+    return ioctlsocket(sock, FIONBIO, &non_blocking) != SOCKET_ERROR;
+}
+
+//-----------------------------------------------------------------------------------
+//One call to find out which of many sockets can be read or written, instead of a recv per socket per frame.
+//With a timeout of 0 this never blocks, it just reports what's already ready.
+int NetSystem::PollSockets(WSAPOLLFD* sockets, size_t numSockets, int timeoutMs)
+{
+    if (numSockets == 0)
+    {
+        return 0;
+    }
+    int numReady = WSAPoll(sockets, (ULONG)numSockets, timeoutMs);
+    if (numReady == SOCKET_ERROR)
+    {
+        LogPrintf(LogLevel::WARNING, "Network: Failed to poll %u sockets. Error[%u]", (unsigned int)numSockets, WSAGetLastError());
+        return 0;
+    }
+    return numReady;
+}
+
 //-----------------------------------------------------------------------------------
 size_t NetSystem::SendOnSocket(bool& outShouldDisconnect, SOCKET mySocket, const void* data, const size_t dataSize)
 {
@@ -293,17 +292,15 @@ size_t NetSystem::SendOnSocket(bool& outShouldDisconnect, SOCKET mySocket, const
         if (size < 0) 
         {
             int32_t error = WSAGetLastError();
-            if (SocketErrorShouldDisconnect(error)) 
+            if (SocketErrorShouldDisconnect(error) || error == WSAECONNRESET) 
             {
                 //If the error is critical - disconnect this socket
                 outShouldDisconnect = true;
             }
-        }
-        else 
-        {
-            ASSERT_OR_DIE((size_t)size == dataSize, "The size of the data sent wasn't the same as the size we attempted to send");
+            return 0U;
         }
 
+        //A non-blocking stream socket can take less than we gave it when its send buffer fills up, the caller keeps the rest
         return (size_t)size;
     }
     else
@@ -327,7 +324,7 @@ size_t NetSystem::RecieveFromSocket(bool& outShouldDisconnect, SOCKET mySocket,
         if (size < 0) 
         {
             int32_t error = WSAGetLastError();
-            if (SocketErrorShouldDisconnect(error)) 
+            if (SocketErrorShouldDisconnect(error) || error == WSAECONNRESET) 
             {
                 outShouldDisconnect = true;
             }
@@ -335,6 +332,8 @@ size_t NetSystem::RecieveFromSocket(bool& outShouldDisconnect, SOCKET mySocket,
         }
         else 
         {
+            //0 with room in the buffer means the other side closed the connection
+            outShouldDisconnect = (size == 0 && bufferSize > 0);
             return (size_t)size;
         }
     }
@@ -344,83 +343,6 @@ size_t NetSystem::RecieveFromSocket(bool& outShouldDisconnect, SOCKET mySocket,
     }
 }
 
-//-----------------------------------------------------------------------------------
-//Converting a sockaddr_in to a String
-//Again, doing this in a global buffer so it is NOT THREAD SAFE
-const char* NetSystem::SockAddrToString(const sockaddr* address)
-{
-    static char buffer[256];
-
-    if (!address)
-    {
-        return "Invalid Sockaddr";
-    }
-
-    // Hard coding this for sockaddr_in for brevity
-    // You can make this work for IPv6 as well
-    sockaddr_in *addr_in = (sockaddr_in*)address;
-
-    // inet_ntop converts an address type to a human readable string,
-    // ie 0x7f000001 => "127.0.0.1"
-    // GetInAddr (defined below) gets the pointer to the address part of the sockaddr
-    char hostname[256];
-    inet_ntop(addr_in->sin_family, GetInAddr(address), hostname, 256);
-
-    // Combine the above with the port.  
-    // Port is stored in network order, so convert it to host order
-    // using ntohs (Network TO Host Short)
-    sprintf_s(buffer, 256, "%s:%u", hostname, ntohs(addr_in->sin_port));
-
-    // buffer is static - so will not go out of scope, but that means this is not thread safe.
-    return buffer;
-}
-
-//-----------------------------------------------------------------------------------
-bool NetSystem::StringToSockAddrIPv4(sockaddr_in& outSockAddr, const char* string)
-{
-#pragma todo("Does this actually work?")
-    unsigned long address = inet_addr(string);
-    if (address == INADDR_NONE) 
-    {
-        LogPrintf(LogLevel::SEVERE, "StringToSockAddrIPv4 failed and returned INADDR_NONE.\n");
-        return false;
-    }
-    if (address == INADDR_ANY) 
-    {
-        LogPrintf(LogLevel::SEVERE, "StringToSockAddrIPv4 failed and returned INADDR_ANY.\n");
-        return false;
-    }
-    outSockAddr.sin_addr.S_un.S_addr = address;
-    return true;
-}
-
-//-----------------------------------------------------------------------------------
-sockaddr_in NetSystem::StringToSockAddrIPv4(const char* ip, const uint16_t port)
-{
-    sockaddr_in addr;
-    memset(&addr, 0, sizeof(sockaddr_in));
-    addr.sin_addr.S_un.S_addr = inet_addr(ip);
-    addr.sin_port = htons(port);
-    addr.sin_family = AF_INET;
-
-    return addr;
-}
-
-
-//-----------------------------------------------------------------------------------
-//Get address part of a sockaddr, IPv4 or IPv6:
-void* NetSystem::GetInAddr(const sockaddr* socketAddress)
-{
-    if (socketAddress->sa_family == AF_INET) 
-    {
-        return &(((sockaddr_in*)socketAddress)->sin_addr);
-    }
-    else 
-    {
-        return &(((sockaddr_in6*)socketAddress)->sin6_addr);
-    }
-}
-
 //-----------------------------------------------------------------------------------
 // Ignoring Non-Critical Errors
 // These errors are non-fatal and are more or less ignorable.
@@ -442,5 +364,5 @@ bool NetSystem::SocketErrorShouldDisconnect(const int32_t error)
 CONSOLE_COMMAND(getlocalhostname)
 {
     UNUSED(args);
-    Console::instance->PrintLine(NetSystem::instance->GetLocalHostName(), RGBA::GBDARKGREEN);
+    Console::instance->PrintLine(NetAddress::GetLocalHostName(), RGBA::GBDARKGREEN);
 }
\ No newline at end of file
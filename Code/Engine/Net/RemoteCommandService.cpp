@@ -1,14 +1,38 @@
 #include "Engine/Net/RemoteCommandService.hpp"
 #include "Engine/Input/Console.hpp"
 #include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Time/Time.hpp"
+#include "Engine/Input/Logging.hpp"
+#include "Engine/DataStructures/BytePacker.hpp"
+#include "Engine/Core/BuildConfig.hpp"
+#include "Engine/Core/ProfilingUtils.h"
+#if defined(TRACK_MEMORY)
+#include "Engine/Core/Memory/MemoryTracking.hpp"
+#endif
 #include "NetSystem.hpp"
 #include <string.h>
+#include <stdio.h>
+#include <algorithm>
 
 RemoteCommandService* RemoteCommandService::instance = nullptr;
 
 //-----------------------------------------------------------------------------------
 RemoteCommandService::RemoteCommandService()
     : m_listener(nullptr)
+    , m_actsForLocalConsole(true)
+    , m_numDroppedEchoLines(0)
+    , m_numDroppedLogLines(0)
+    , m_numDroppedEchoLinesThisFrame(0)
+    , m_firstConnectionPoll(0)
+    , m_isListeningToConsole(false)
+    , m_isPrintingRemoteEcho(false)
+    , m_isUpdating(false)
+    , m_nextLogSequence(0)
+    , m_isFeedingLog(false)
+    , m_lastUpdateSeconds(0.0)
+    , m_lastFrameMs(0.0f)
+    , m_averageFrameMs(0.0f)
 {
 
 }
@@ -16,23 +40,32 @@ RemoteCommandService::RemoteCommandService()
 //-----------------------------------------------------------------------------------
 RemoteCommandService::~RemoteCommandService()
 {
+    if (m_isListeningToConsole && Console::instance)
+    {
+        Console::instance->m_onPrintLine.UnregisterMethod(this, &RemoteCommandService::OnConsolePrintLine);
+    }
     if (m_listener)
     {
+        m_listener->Stop();
         delete m_listener;
     }
     for (RemoteCommandServiceConnection* connection : m_connections)
     {
-#pragma todo("Close out any connections first")
         delete connection;
     }
     m_connections.clear();
 }
 
 //-----------------------------------------------------------------------------------
-bool RemoteCommandService::Host(const char* hostName)
+bool RemoteCommandService::Host(const char* hostName, const char* port)
 {
-    UNUSED(hostName)
-    m_listener = new TCPListener(REMOTE_COMMAND_SERVICE_PORT_STRING);
+    m_listener = new TCPListener(hostName, port);
+    if (!m_listener->IsListening())
+    {
+        delete m_listener;
+        m_listener = nullptr;
+        return false;
+    }
     return true;
 }
 
@@ -40,7 +73,14 @@ bool RemoteCommandService::Host(const char* hostName)
 bool RemoteCommandService::StopHosting()
 {
     ASSERT_OR_DIE(m_listener != nullptr, "Tried to stop hosting without having an existing listener");
-#pragma todo("Close out connections here.")
+    for (RemoteCommandServiceConnection* connection : m_connections)
+    {
+        connection->m_tcpConnection->Disconnect();
+    }
+    if (!m_isUpdating)
+    {
+        CheckForDisconnection(); //Otherwise the update cleans them up once it's done with them
+    }
     m_listener->Stop();
     delete m_listener;
     m_listener = nullptr;
@@ -51,15 +91,18 @@ bool RemoteCommandService::StopHosting()
 void RemoteCommandService::DisconnectFromHost()
 {
     ASSERT_OR_DIE(m_connections.size() == 1 && m_connections[0] != nullptr, "Tried to disconnect without a valid connection");
-    delete m_connections[0];
-    m_connections.clear();
+    m_connections[0]->m_tcpConnection->Disconnect();
+    if (!m_isUpdating)
+    {
+        CheckForDisconnection();
+    }
 }
 
 //-----------------------------------------------------------------------------------
-bool RemoteCommandService::Join(const char* hostName)
+bool RemoteCommandService::Join(const char* hostName, const char* port)
 {
-    RemoteCommandServiceConnection* connection = new RemoteCommandServiceConnection(new TCPConnection(hostName, REMOTE_COMMAND_SERVICE_PORT_STRING));
-    connection->m_tcpConnection->m_socket = NetSystem::JoinSocket(hostName, REMOTE_COMMAND_SERVICE_PORT_STRING, &connection->m_tcpConnection->m_address);
+    RemoteCommandServiceConnection* connection = new RemoteCommandServiceConnection(new TCPConnection(hostName, port));
+    connection->m_tcpConnection->m_socket = NetSystem::JoinSocket(hostName, port, &connection->m_tcpConnection->m_address);
     bool isValid = connection->m_tcpConnection->m_socket != INVALID_SOCKET;
     if (isValid)
     {
@@ -84,9 +127,36 @@ void RemoteCommandService::SendCommand(byte commandId, const char* command)
 //-----------------------------------------------------------------------------------
 void RemoteCommandService::Update()
 {
-    CheckForConnection(); //Accepts
-    CheckForMessages(); //Recieves
+    m_isUpdating = true;
+    FlushEcho(); //Last frame's console output goes into the send buffers first, so the poll below picks up the sockets that have something to send
+    UpdateFeeds();
+
+    m_pollSockets.clear();
+    m_firstConnectionPoll = (m_listener != nullptr) ? 1 : 0;
+    if (m_listener)
+    {
+        WSAPOLLFD listenerPoll;
+        listenerPoll.fd = m_listener->m_socket;
+        listenerPoll.events = POLLRDNORM;
+        listenerPoll.revents = 0;
+        m_pollSockets.push_back(listenerPoll);
+    }
+    for (RemoteCommandServiceConnection* connection : m_connections)
+    {
+        WSAPOLLFD connectionPoll;
+        connectionPoll.fd = connection->m_tcpConnection->m_socket;
+        connectionPoll.events = POLLRDNORM | (connection->m_tcpConnection->HasQueuedSends() ? POLLWRNORM : 0);
+        connectionPoll.revents = 0;
+        m_pollSockets.push_back(connectionPoll);
+    }
+
+    if (NetSystem::PollSockets(m_pollSockets.data(), m_pollSockets.size(), 0) > 0)
+    {
+        CheckForMessages(); //Recieves and sends
+        CheckForConnection(); //Accepts
+    }
     CheckForDisconnection(); //Disconeccts
+    m_isUpdating = false;
 }
 
 //-----------------------------------------------------------------------------------
@@ -94,26 +164,285 @@ void RemoteCommandService::AddConnection(RemoteCommandServiceConnection* connect
 {
     connection->m_onMessage.RegisterMethod(this, &RemoteCommandService::OnRecieveRemoteMessage);
     m_connections.push_back(connection);
+    if (m_actsForLocalConsole && !m_isListeningToConsole && Console::instance)
+    {
+        Console::instance->m_onPrintLine.RegisterMethod(this, &RemoteCommandService::OnConsolePrintLine);
+        m_isListeningToConsole = true;
+    }
+    m_onConnectionJoin.Trigger(connection);
+}
+
+//-----------------------------------------------------------------------------------
+void RemoteCommandService::OnRecieveRemoteMessage(RemoteCommandServiceConnection* connectionPointer, const byte id, const char* msg)
+{
+    m_onMessage.Trigger(connectionPointer, id, msg);
+    if (id == MSG_SUBSCRIBE)
+    {
+        const byte* payload = (const byte*)msg;
+        size_t payloadSize = connectionPointer->GetReceivedPayloadSize();
+        byte feeds = (payloadSize >= 1) ? payload[0] : 0;
+        unsigned int metricsIntervalMs = (payloadSize >= 3) ? (((unsigned int)payload[1] << 8) | payload[2]) : DEFAULT_METRICS_INTERVAL_MS;
+        connectionPointer->Subscribe(feeds, metricsIntervalMs);
+        return;
+    }
+    if (!m_actsForLocalConsole || !Console::instance)
+    {
+        return;
+    }
+
+    if (id == MSG_COMMAND)
+    {
+        Console::instance->PrintLine(Stringf("Running remote command: %s", msg), RGBA::FOREST_GREEN);
+        Console::instance->RunCommand(msg);
+    }
+    else if (id == MSG_ECHO)
+    {
+        m_isPrintingRemoteEcho = true;
+        size_t payloadSize = connectionPointer->GetReceivedPayloadSize();
+        size_t offset = 0;
+        while (offset + ECHO_LINE_HEADER_SIZE < payloadSize)
+        {
+            const byte* color = (const byte*)msg + offset;
+            const char* text = msg + offset + ECHO_LINE_HEADER_SIZE;
+            Console::instance->PrintLine(text, RGBA::CreateFromUChars(color[0], color[1], color[2], color[3]));
+            offset += ECHO_LINE_HEADER_SIZE + strlen(text) + 1;
+        }
+        m_isPrintingRemoteEcho = false;
+    }
+    else if (id == MSG_RENAME)
+    {
+        connectionPointer->m_name = msg;
+    }
+    else if (id == MSG_FEED_LOG)
+    {
+        size_t payloadSize = connectionPointer->GetReceivedPayloadSize();
+        size_t offset = 6; //Sequence and line count
+        m_isPrintingRemoteEcho = true;
+        while (offset < payloadSize)
+        {
+            const char* line = msg + offset;
+            Console::instance->PrintLine(line, RGBA::CERULEAN);
+            offset += strlen(line) + 1;
+        }
+        m_isPrintingRemoteEcho = false;
+    }
+    else if (id == MSG_FEED_METRICS)
+    {
+        RemoteMetricsSample sample;
+        BytePacker packer((void*)msg, 0, connectionPointer->GetReceivedPayloadSize(), IBinaryReader::BIG_ENDIAN);
+        if (sample.Read(packer))
+        {
+            m_isPrintingRemoteEcho = true;
+            Console::instance->PrintLine(Stringf("[%s] frame %.2fms (avg %.2fms), %u allocations / %.2f MB live, net %u out %u in, %u resends, %u unsent, %.0fms rtt, %.1f%% loss, %u feed frames dropped",
+                connectionPointer->GetAddressString(), sample.frameMs, sample.averageFrameMs, sample.numLiveAllocations, sample.numLiveBytes / (1024.0 * 1024.0),
+                (unsigned int)sample.numNetBytesSent, (unsigned int)sample.numNetBytesReceived, sample.numNetResends, sample.numNetUnsentReliables, sample.netRoundTripMs, sample.netLossRate * 100.0f,
+                sample.numDroppedFeedFrames), RGBA::CERULEAN);
+            m_isPrintingRemoteEcho = false;
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------------
+void RemoteCommandService::OnConsolePrintLine(const std::string& line, const RGBA& color)
+{
+    if (IsHosting() && !m_isPrintingRemoteEcho && !m_connections.empty())
+    {
+        QueueEcho(line.c_str(), color);
+    }
 }
 
 //-----------------------------------------------------------------------------------
-void RemoteCommandService::OnRecieveRemoteMessage(RemoteCommandServiceConnection* , const byte , const char* msg)
+void RemoteCommandService::QueueEcho(const char* line, const RGBA& color)
 {
-    Console::instance->PrintLine(Stringf("Running remote command: %s", msg), RGBA::FOREST_GREEN);
-    Console::instance->RunCommand(msg);
+    const size_t MAX_LINE_LENGTH = RemoteCommandServiceConnection::MAX_PAYLOAD_SIZE - ECHO_LINE_HEADER_SIZE - 1;
+    size_t lineLength = std::min<size_t>(strlen(line), MAX_LINE_LENGTH);
+    size_t encodedSize = ECHO_LINE_HEADER_SIZE + lineLength + 1;
+    if (m_pendingEcho.size() + encodedSize > MAX_ECHO_BYTES_PER_FRAME)
+    {
+        ++m_numDroppedEchoLines;
+        ++m_numDroppedEchoLinesThisFrame;
+        return;
+    }
+    m_pendingEcho.push_back((char)color.red);
+    m_pendingEcho.push_back((char)color.green);
+    m_pendingEcho.push_back((char)color.blue);
+    m_pendingEcho.push_back((char)color.alpha);
+    m_pendingEcho.append(line, lineLength);
+    m_pendingEcho.push_back('\0');
+}
+
+//-----------------------------------------------------------------------------------
+//Every line printed this frame goes to each client in as few messages as fit, split only between lines.
+void RemoteCommandService::FlushEcho()
+{
+    if (m_numDroppedEchoLinesThisFrame > 0)
+    {
+        std::string note = Stringf("(%u lines dropped)", m_numDroppedEchoLinesThisFrame);
+        const RGBA& color = RGBA::RED;
+        m_pendingEcho.push_back((char)color.red);
+        m_pendingEcho.push_back((char)color.green);
+        m_pendingEcho.push_back((char)color.blue);
+        m_pendingEcho.push_back((char)color.alpha);
+        m_pendingEcho.append(note.c_str(), note.size() + 1);
+        m_numDroppedEchoLinesThisFrame = 0;
+    }
+    if (m_pendingEcho.empty())
+    {
+        return;
+    }
+
+    size_t chunkStart = 0;
+    while (chunkStart < m_pendingEcho.size())
+    {
+        size_t chunkEnd = chunkStart;
+        while (chunkEnd < m_pendingEcho.size())
+        {
+            size_t lineEnd = m_pendingEcho.find('\0', chunkEnd + ECHO_LINE_HEADER_SIZE) + 1;
+            if (lineEnd - chunkStart > RemoteCommandServiceConnection::MAX_PAYLOAD_SIZE)
+            {
+                break;
+            }
+            chunkEnd = lineEnd;
+        }
+        for (RemoteCommandServiceConnection* connection : m_connections)
+        {
+            connection->Send(MSG_ECHO, m_pendingEcho.data() + chunkStart, chunkEnd - chunkStart);
+        }
+        chunkStart = chunkEnd;
+    }
+    m_pendingEcho.clear();
+}
+
+//-----------------------------------------------------------------------------------
+//Log lines the logger has written since last update go to every log subscriber in as few frames as fit, and each metrics subscriber
+//whose interval is up gets a sample. Both go through the connection's feed queue, which is then moved along into the send buffer.
+void RemoteCommandService::UpdateFeeds()
+{
+    double nowSeconds = GetCurrentTimeSeconds();
+    if (m_lastUpdateSeconds > 0.0)
+    {
+        m_lastFrameMs = (float)((nowSeconds - m_lastUpdateSeconds) * 1000.0);
+        m_averageFrameMs = (m_averageFrameMs == 0.0f) ? m_lastFrameMs : (m_averageFrameMs * 0.95f) + (m_lastFrameMs * 0.05f);
+    }
+    m_lastUpdateSeconds = nowSeconds;
+
+    byte subscribedFeeds = 0;
+    for (RemoteCommandServiceConnection* connection : m_connections)
+    {
+        subscribedFeeds |= connection->m_subscribedFeeds;
+    }
+    if (subscribedFeeds == 0)
+    {
+        m_isFeedingLog = false;
+        return;
+    }
+
+    if ((subscribedFeeds & FEED_LOG) && Logger::instance)
+    {
+        const size_t LOG_FRAME_HEADER_SIZE = 6;
+        for (unsigned int i = 0; i < Logger::NUM_RECENT_LINES; ++i) //The logger keeps writing while we read, don't chase it forever
+        {
+            m_logFeedLines.assign(LOG_FRAME_HEADER_SIZE, '\0');
+            unsigned int numLines = 0;
+            unsigned int numOverwritten = Logger::instance->ReadRecentLines(m_nextLogSequence, m_logFeedLines, RemoteCommandServiceConnection::MAX_PAYLOAD_SIZE, numLines);
+            m_numDroppedLogLines += m_isFeedingLog ? numOverwritten : 0;
+            m_isFeedingLog = true;
+            if (numLines == 0)
+            {
+                break;
+            }
+            uint32_t firstSequence = (uint32_t)(m_nextLogSequence - numLines);
+            m_logFeedLines[0] = (char)(firstSequence >> 24);
+            m_logFeedLines[1] = (char)(firstSequence >> 16);
+            m_logFeedLines[2] = (char)(firstSequence >> 8);
+            m_logFeedLines[3] = (char)firstSequence;
+            m_logFeedLines[4] = (char)(numLines >> 8);
+            m_logFeedLines[5] = (char)numLines;
+            for (RemoteCommandServiceConnection* connection : m_connections)
+            {
+                if (connection->m_subscribedFeeds & FEED_LOG)
+                {
+                    connection->QueueFeedFrame(MSG_FEED_LOG, m_logFeedLines.data(), m_logFeedLines.size());
+                }
+            }
+        }
+    }
+    else
+    {
+        m_isFeedingLog = false;
+    }
+
+    bool hasSample = false;
+    RemoteMetricsSample sample;
+    for (RemoteCommandServiceConnection* connection : m_connections)
+    {
+        if ((connection->m_subscribedFeeds & FEED_METRICS) && (nowSeconds - connection->m_lastMetricsSeconds) * 1000.0 >= connection->m_metricsIntervalMs)
+        {
+            if (!hasSample)
+            {
+                SampleMetrics(sample);
+                hasSample = true;
+            }
+            sample.sampleIndex = connection->m_numMetricsSamples++;
+            sample.numDroppedFeedFrames = connection->m_numDroppedFeedFrames;
+            byte packed[RemoteMetricsSample::PACKED_SIZE];
+            BytePacker packer(packed, sizeof(packed), 0, IBinaryReader::BIG_ENDIAN);
+            sample.Write(packer);
+            connection->QueueFeedFrame(MSG_FEED_METRICS, packed, sizeof(packed));
+            connection->m_lastMetricsSeconds = nowSeconds;
+        }
+    }
+
+    for (RemoteCommandServiceConnection* connection : m_connections)
+    {
+        connection->FlushFeed();
+    }
+}
+
+//-----------------------------------------------------------------------------------
+void RemoteCommandService::SampleMetrics(RemoteMetricsSample& outSample)
+{
+    outSample.frameMs = m_lastFrameMs;
+    outSample.averageFrameMs = m_averageFrameMs;
+    outSample.numDroppedLogLines = m_numDroppedLogLines;
+#if defined(TRACK_MEMORY)
+    outSample.numLiveAllocations = g_memoryAnalytics.m_numberOfAllocations;
+    outSample.numLiveBytes = g_memoryAnalytics.m_numberOfBytes;
+    outSample.highwaterBytes = g_memoryAnalytics.m_highwaterInBytes;
+    outSample.numTotalAllocations = g_memoryAnalytics.m_totalNumberOfAllocations;
+#endif
+#ifdef PROFILING_ENABLED
+    if (ProfilingSystem::IsProfilingEnabled() && ProfilingSystem::instance->GetLastFrame())
+    {
+        //The net counters land on whichever sample was active, NetSessionUpdate normally, so gather them from the whole frame
+        ProfileSample netTotals;
+        ProfilingSystem::instance->GetLastFrame()->SumNetCounters(netTotals);
+        outSample.numNetBytesSent = netTotals.numNetBytesSent;
+        outSample.numNetBytesReceived = netTotals.numNetBytesReceived;
+        outSample.numNetResends = (uint32_t)netTotals.numNetResends;
+        outSample.numNetUnsentReliables = (uint32_t)netTotals.numNetUnsentReliables;
+        outSample.netRoundTripMs = netTotals.netRoundTripMs;
+        outSample.netLossRate = netTotals.netLossRate;
+    }
+#endif
 }
 
 //-----------------------------------------------------------------------------------
 void RemoteCommandService::CheckForConnection()
 {
-    if (m_listener)
+    if (m_listener && !m_pollSockets.empty() && m_pollSockets[0].fd == m_listener->m_socket && (m_pollSockets[0].revents & POLLRDNORM))
     {
+        //Everyone who connected since the last poll is waiting, take them all now
         TCPConnection* connection = m_listener->ListenAndAcceptConnection();
-        if (connection)
+        while (connection)
         {
             RemoteCommandServiceConnection* rcs = new RemoteCommandServiceConnection(connection);
             AddConnection(rcs);
-            Console::instance->PrintLine(Stringf("Connected with %s", rcs->GetAddressString()), RGBA::GBLIGHTGREEN);
+            if (m_actsForLocalConsole)
+            {
+                Console::instance->PrintLine(Stringf("Connected with %s", rcs->GetAddressString()), RGBA::GBLIGHTGREEN);
+            }
+            connection = m_listener->ListenAndAcceptConnection();
         }
     }
 }
@@ -121,21 +450,59 @@ void RemoteCommandService::CheckForConnection()
 //-----------------------------------------------------------------------------------
 void RemoteCommandService::CheckForMessages()
 {
-    for (RemoteCommandServiceConnection* connection : m_connections)
+    //Connections made while handling messages go on the end, and nothing is removed until CheckForDisconnection, so these still line up
+    size_t numPolledConnections = m_pollSockets.size() - m_firstConnectionPoll;
+    for (size_t i = 0; i < numPolledConnections; ++i)
     {
-        connection->Receive();
+        RemoteCommandServiceConnection* connection = m_connections[i];
+        short events = m_pollSockets[m_firstConnectionPoll + i].revents;
+        if (events & (POLLERR | POLLNVAL))
+        {
+            connection->m_tcpConnection->Disconnect();
+            continue;
+        }
+        if (events & (POLLRDNORM | POLLHUP))
+        {
+            connection->Receive();
+        }
+        if (events & POLLWRNORM)
+        {
+            connection->Flush();
+        }
     }
 }
 
 //-----------------------------------------------------------------------------------
 void RemoteCommandService::CheckForDisconnection()
 {
-
+    for (size_t i = 0; i < m_connections.size(); )
+    {
+        RemoteCommandServiceConnection* connection = m_connections[i];
+        if (connection->IsConnected())
+        {
+            ++i;
+            continue;
+        }
+        m_onConnectionLeave.Trigger(connection);
+        if (m_actsForLocalConsole && Console::instance)
+        {
+            Console::instance->PrintLine(Stringf("Disconnected from %s", connection->GetAddressString()), RGBA::CHOCOLATE);
+        }
+        delete connection;
+        m_connections.erase(m_connections.begin() + i);
+    }
 }
 
 //-----------------------------------------------------------------------------------
 RemoteCommandServiceConnection::RemoteCommandServiceConnection(TCPConnection* tcpConn)
     : m_tcpConnection(tcpConn)
+    , m_numDroppedMessages(0)
+    , m_subscribedFeeds(0)
+    , m_metricsIntervalMs(0)
+    , m_lastMetricsSeconds(0.0)
+    , m_numMetricsSamples(0)
+    , m_numDroppedFeedFrames(0)
+    , m_feedQueue(nullptr)
 {
 
 }
@@ -143,39 +510,134 @@ RemoteCommandServiceConnection::RemoteCommandServiceConnection(TCPConnection* tc
 //-----------------------------------------------------------------------------------
 RemoteCommandServiceConnection::~RemoteCommandServiceConnection()
 {
-    if (m_tcpConnection && m_tcpConnection->IsConnected())
+    if (m_tcpConnection)
     {
         m_tcpConnection->Disconnect();
         delete m_tcpConnection;
     }
+    delete m_feedQueue;
 }
 
 //-----------------------------------------------------------------------------------
-void RemoteCommandServiceConnection::Send(byte commandId, const char* command)
+bool RemoteCommandServiceConnection::Send(byte commandId, const char* command)
 {
-    m_tcpConnection->Send(&commandId, 1);
-    m_tcpConnection->Send(command, strlen(command));
-    char nil = NULL;
-    m_tcpConnection->Send(&nil, 1);
+    return Send(commandId, command, strlen(command));
+}
+
+//-----------------------------------------------------------------------------------
+bool RemoteCommandServiceConnection::Send(byte commandId, const void* payload, size_t payloadSize)
+{
+    if (payloadSize > MAX_PAYLOAD_SIZE || m_tcpConnection->m_sendBuffer.GetFreeSpace() < FRAME_HEADER_SIZE + 1 + payloadSize)
+    {
+        ++m_numDroppedMessages;
+        return false;
+    }
+    size_t frameLength = payloadSize + 1;
+    byte header[FRAME_HEADER_SIZE + 1] = { (byte)(frameLength >> 8), (byte)(frameLength & 0xFF), commandId };
+    m_tcpConnection->QueueSend(header, sizeof(header));
+    m_tcpConnection->QueueSend(payload, payloadSize);
+    return true;
 }
 
 //-----------------------------------------------------------------------------------
 void RemoteCommandServiceConnection::Receive()
 {
-    const size_t BUFFER_SIZE = 1024;
-    byte buffer[BUFFER_SIZE];
-    size_t read = m_tcpConnection->Receive(buffer, BUFFER_SIZE);
-    for (size_t i = 0; i < read; ++i)
+    ByteRingBuffer& received = m_tcpConnection->m_receiveBuffer;
+    for (unsigned int pass = 0; pass < MAX_RECEIVE_PASSES && m_tcpConnection->IsConnected(); ++pass)
     {
-        char c = buffer[i];
-        m_nextMessage.push_back(c);
-        if (c == NULL)
+        m_tcpConnection->ReceiveAvailable();
+        bool wasFull = (received.GetFreeSpace() == 0);
+
+        byte header[FRAME_HEADER_SIZE];
+        while (m_tcpConnection->IsConnected() && received.Peek(header, FRAME_HEADER_SIZE) == FRAME_HEADER_SIZE)
         {
+            size_t frameLength = ((size_t)header[0] << 8) | header[1];
+            if (frameLength == 0)
+            {
+                m_tcpConnection->Disconnect(); //Not something we'd send, the stream is out of step
+                break;
+            }
+            if (received.GetSize() < FRAME_HEADER_SIZE + frameLength)
+            {
+                break;
+            }
+            m_nextMessage.resize(frameLength + 1);
+            received.Peek(&m_nextMessage[0], frameLength, FRAME_HEADER_SIZE);
+            received.Consume(FRAME_HEADER_SIZE + frameLength);
+            m_nextMessage[frameLength] = '\0';
             m_onMessage.Trigger(this, m_nextMessage[0], &m_nextMessage[1]);
-            m_nextMessage.clear();
         }
+
+        if (!wasFull)
+        {
+            break; //Drained the socket, anything else can wait for the next poll
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------------
+void RemoteCommandServiceConnection::Subscribe(byte feeds, unsigned int metricsIntervalMs)
+{
+    m_subscribedFeeds = feeds;
+    m_metricsIntervalMs = metricsIntervalMs;
+    m_lastMetricsSeconds = 0.0;
+    if (feeds != 0 && !m_feedQueue)
+    {
+        m_feedQueue = new ByteRingBuffer(FEED_QUEUE_SIZE);
+    }
+    else if (feeds == 0 && m_feedQueue)
+    {
+        delete m_feedQueue;
+        m_feedQueue = nullptr;
+    }
+}
+
+//-----------------------------------------------------------------------------------
+void RemoteCommandServiceConnection::QueueFeedFrame(byte feedId, const void* payload, size_t payloadSize)
+{
+    size_t frameSize = FRAME_HEADER_SIZE + 1 + payloadSize;
+    if (!m_feedQueue || payloadSize > MAX_PAYLOAD_SIZE || frameSize > m_feedQueue->GetCapacity())
+    {
+        return;
+    }
+    while (m_feedQueue->GetFreeSpace() < frameSize)
+    {
+        byte header[FRAME_HEADER_SIZE];
+        m_feedQueue->Peek(header, FRAME_HEADER_SIZE);
+        m_feedQueue->Consume(FRAME_HEADER_SIZE + (((size_t)header[0] << 8) | header[1]));
+        ++m_numDroppedFeedFrames;
+    }
+    size_t frameLength = payloadSize + 1;
+    byte header[FRAME_HEADER_SIZE + 1] = { (byte)(frameLength >> 8), (byte)(frameLength & 0xFF), feedId };
+    m_feedQueue->Write(header, sizeof(header));
+    m_feedQueue->Write(payload, payloadSize);
+}
+
+//-----------------------------------------------------------------------------------
+void RemoteCommandServiceConnection::FlushFeed()
+{
+    ByteRingBuffer& sendBuffer = m_tcpConnection->m_sendBuffer;
+    while (m_feedQueue && !m_feedQueue->IsEmpty())
+    {
+        byte header[FRAME_HEADER_SIZE];
+        m_feedQueue->Peek(header, FRAME_HEADER_SIZE);
+        size_t frameSize = FRAME_HEADER_SIZE + (((size_t)header[0] << 8) | header[1]);
+        bool isOverFeedLimit = !sendBuffer.IsEmpty() && (sendBuffer.GetSize() + frameSize > MAX_FEED_BYTES_IN_SEND_BUFFER);
+        if (isOverFeedLimit || sendBuffer.GetFreeSpace() < frameSize)
+        {
+            break; //Wait here, where newer frames can still push it out
+        }
+        m_feedScratch.resize(frameSize);
+        m_feedQueue->Peek(m_feedScratch.data(), frameSize);
+        m_feedQueue->Consume(frameSize);
+        m_tcpConnection->QueueSend(m_feedScratch.data(), frameSize);
     }
-    read = m_tcpConnection->Receive(buffer, BUFFER_SIZE);
+}
+
+//-----------------------------------------------------------------------------------
+void RemoteCommandServiceConnection::Flush()
+{
+    m_tcpConnection->FlushSend();
 }
 
 //-----------------------------------------------------------------------------------
@@ -184,6 +646,72 @@ const char* RemoteCommandServiceConnection::GetAddressString()
     return this->m_tcpConnection->GetAddressString();
 }
 
+//-----------------------------------------------------------------------------------
+RemoteMetricsSample::RemoteMetricsSample()
+    : sampleIndex(0)
+    , frameMs(0.0f)
+    , averageFrameMs(0.0f)
+    , numLiveAllocations(0)
+    , numLiveBytes(0)
+    , highwaterBytes(0)
+    , numTotalAllocations(0)
+    , numNetBytesSent(0)
+    , numNetBytesReceived(0)
+    , numNetResends(0)
+    , numNetUnsentReliables(0)
+    , netRoundTripMs(0.0f)
+    , netLossRate(0.0f)
+    , numDroppedFeedFrames(0)
+    , numDroppedLogLines(0)
+{
+
+}
+
+//-----------------------------------------------------------------------------------
+void RemoteMetricsSample::Write(BytePacker& packer) const
+{
+    packer.Write<uint32_t>(sampleIndex);
+    packer.Write<float>(frameMs);
+    packer.Write<float>(averageFrameMs);
+    packer.Write<uint32_t>(numLiveAllocations);
+    packer.Write<uint64_t>(numLiveBytes);
+    packer.Write<uint64_t>(highwaterBytes);
+    packer.Write<uint64_t>(numTotalAllocations);
+    packer.Write<uint64_t>(numNetBytesSent);
+    packer.Write<uint64_t>(numNetBytesReceived);
+    packer.Write<uint32_t>(numNetResends);
+    packer.Write<uint32_t>(numNetUnsentReliables);
+    packer.Write<float>(netRoundTripMs);
+    packer.Write<float>(netLossRate);
+    packer.Write<uint32_t>(numDroppedFeedFrames);
+    packer.Write<uint32_t>(numDroppedLogLines);
+}
+
+//-----------------------------------------------------------------------------------
+bool RemoteMetricsSample::Read(BytePacker& packer)
+{
+    if (packer.GetReadableBytes() < PACKED_SIZE)
+    {
+        return false;
+    }
+    packer.Read<uint32_t>(sampleIndex);
+    packer.Read<float>(frameMs);
+    packer.Read<float>(averageFrameMs);
+    packer.Read<uint32_t>(numLiveAllocations);
+    packer.Read<uint64_t>(numLiveBytes);
+    packer.Read<uint64_t>(highwaterBytes);
+    packer.Read<uint64_t>(numTotalAllocations);
+    packer.Read<uint64_t>(numNetBytesSent);
+    packer.Read<uint64_t>(numNetBytesReceived);
+    packer.Read<uint32_t>(numNetResends);
+    packer.Read<uint32_t>(numNetUnsentReliables);
+    packer.Read<float>(netRoundTripMs);
+    packer.Read<float>(netLossRate);
+    packer.Read<uint32_t>(numDroppedFeedFrames);
+    packer.Read<uint32_t>(numDroppedLogLines);
+    return true;
+}
+
 //-----------------------------------------------------------------------------------
 CONSOLE_COMMAND(cshost)
 {
@@ -193,7 +721,7 @@ CONSOLE_COMMAND(cshost)
         Console::instance->PrintLine("Error: Already hosting.", RGBA::MAROON);
         return;
     }
-    if (RemoteCommandService::instance->Host(NetSystem::instance->GetLocalHostName()))
+    if (RemoteCommandService::instance->Host(NetAddress::GetLocalHostName()))
     {
         Console::instance->PrintLine("Now Hosting", RGBA::GBBLACK);
         Console::instance->PrintLine(Stringf("Host: %s:%s, Address: %s", RemoteCommandService::instance->m_listener->m_host, RemoteCommandService::instance->m_listener->m_port, RemoteCommandService::instance->m_listener->GetAddressString()), RGBA::GBLIGHTGREEN);
@@ -232,10 +760,12 @@ CONSOLE_COMMAND(commandserverinfo)
         Console::instance->PrintLine("Server State: Hosting", RGBA::GBLIGHTGREEN);
         for (RemoteCommandServiceConnection* conn : RemoteCommandService::instance->m_connections)
         {
-            const char* hostname = conn->m_tcpConnection->m_host;
+            const char* hostname = conn->m_name.empty() ? conn->m_tcpConnection->m_host : conn->m_name.c_str();
             sockaddr* address = (sockaddr*)&conn->m_tcpConnection->m_address;
-            Console::instance->PrintLine(Stringf("Client: %s, Address: %s", hostname, NetSystem::SockAddrToString(address)), RGBA::GBLIGHTGREEN);
+            Console::instance->PrintLine(Stringf("Client: %s, Address: %s, Queued: %u bytes, Dropped: %u messages", hostname, NetAddress::SockAddrToString(address), 
+                (unsigned int)conn->m_tcpConnection->m_sendBuffer.GetSize(), conn->m_numDroppedMessages), RGBA::GBLIGHTGREEN);
         }
+        Console::instance->PrintLine(Stringf("Echo lines dropped: %u", RemoteCommandService::instance->m_numDroppedEchoLines), RGBA::GBLIGHTGREEN);
         return;
     }
     else if (RemoteCommandService::instance->m_connections.size() == 1)
@@ -244,7 +774,7 @@ CONSOLE_COMMAND(commandserverinfo)
 
         const char* hostname = RemoteCommandService::instance->m_connections[0]->m_tcpConnection->m_host;
         sockaddr* address = (sockaddr*)&RemoteCommandService::instance->m_connections[0]->m_tcpConnection->m_address;
-        Console::instance->PrintLine(Stringf("Host: %s, Address: %s", hostname, NetSystem::SockAddrToString(address)), RGBA::GBLIGHTGREEN);
+        Console::instance->PrintLine(Stringf("Host: %s, Address: %s", hostname, NetAddress::SockAddrToString(address)), RGBA::GBLIGHTGREEN);
         return;
     }
     else
@@ -272,7 +802,7 @@ CONSOLE_COMMAND(csjoin)
 
     if (args.HasArgs(0))
     {
-        if (RemoteCommandService::instance->Join(NetSystem::GetLocalHostName()))
+        if (RemoteCommandService::instance->Join(NetAddress::GetLocalHostName()))
         {
             Console::instance->PrintLine("Joined remote session", RGBA::GBLIGHTGREEN);
         }
@@ -319,10 +849,7 @@ CONSOLE_COMMAND(bcmd)
         Console::instance->PrintLine("bcmd <command name> <command's arguments>", RGBA::GRAY);
         return;
     }
-    for (RemoteCommandServiceConnection* connection : RemoteCommandService::instance->m_connections)
-    {
-        connection->Send(MSG_COMMAND, args.GetAllArguments().c_str());
-    }
+    RemoteCommandService::instance->SendCommand(MSG_COMMAND, args.GetAllArguments().c_str());
     Console::instance->RunCommand(args.GetAllArguments());
 }
 
@@ -335,10 +862,29 @@ CONSOLE_COMMAND(rcmd)
         Console::instance->PrintLine("rcmd <command name> <command's arguments>", RGBA::GRAY);
         return;
     }
-    for (RemoteCommandServiceConnection* connection : RemoteCommandService::instance->m_connections)
+    RemoteCommandService::instance->SendCommand(MSG_COMMAND, args.GetAllArguments().c_str());
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(cssubscribe)
+{
+    if (!(args.HasArgs(1) || args.HasArgs(2)))
     {
-        connection->Send(MSG_COMMAND, args.GetAllArguments().c_str());
+        Console::instance->PrintLine("cssubscribe <log | metrics | all | none> <metrics interval ms>", RGBA::GRAY);
+        return;
     }
+    if (!RemoteCommandService::instance->IsJoined())
+    {
+        Console::instance->PrintLine("Failed to subscribe because you're not connected to a host.", RGBA::RED);
+        return;
+    }
+    std::string feedName = args.GetStringArgument(0);
+    byte feeds = (feedName == "log") ? FEED_LOG : (feedName == "metrics") ? FEED_METRICS : (feedName == "all") ? (FEED_LOG | FEED_METRICS) : 0;
+    unsigned int intervalMs = args.HasArgs(2) ? (unsigned int)args.GetIntArgument(1) : RemoteCommandService::DEFAULT_METRICS_INTERVAL_MS;
+    intervalMs = std::min<unsigned int>(intervalMs, 0xFFFF);
+    byte payload[3] = { feeds, (byte)(intervalMs >> 8), (byte)(intervalMs & 0xFF) };
+    RemoteCommandService::instance->m_connections[0]->Send(MSG_SUBSCRIBE, payload, sizeof(payload));
+    Console::instance->PrintLine(Stringf("Subscribed to %s", (feeds == 0) ? "nothing" : feedName.c_str()), RGBA::GBLIGHTGREEN);
 }
 
 //-----------------------------------------------------------------------------------
@@ -354,4 +900,484 @@ CONSOLE_COMMAND(commandserverleave)
     {
         Console::instance->PrintLine("Failed to disconnect because you're not connected to a host.", RGBA::RED);
     }
-}
\ No newline at end of file
+}
+//TESTS/////////////////////////////////////////////////////////////////////
+static const byte MSG_LOOPBACK_TEST = 200; //Neither end acts on it, only the test's listeners see it
+
+//-----------------------------------------------------------------------------------
+static inline uint32_t NextRemoteCommandTestRandom(uint32_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+//-----------------------------------------------------------------------------------
+static inline char GetRemoteCommandTestFiller(unsigned int clientIndex, unsigned int sequence, unsigned int index)
+{
+    return (char)('a' + ((clientIndex * 7 + sequence + index) % 26));
+}
+
+//-----------------------------------------------------------------------------------
+static inline RGBA GetRemoteCommandTestColor(unsigned int lineIndex)
+{
+    return RGBA::CreateFromUChars((unsigned char)lineIndex, (unsigned char)(lineIndex * 7), (unsigned char)(lineIndex * 13), 255);
+}
+
+//-----------------------------------------------------------------------------------
+//Checks what the host gets from every client: each message intact and each client's in the order it sent them.
+struct RemoteCommandLoopbackHostCheck
+{
+    RemoteCommandLoopbackHostCheck(unsigned int numClients) : nextSequences(numClients, 0), numReceived(0), numCorrupt(0), numOutOfOrder(0) {};
+
+    //-----------------------------------------------------------------------------------
+    void OnMessage(RemoteCommandServiceConnection* connection, const byte id, const char* msg)
+    {
+        if (id != MSG_LOOPBACK_TEST)
+        {
+            return;
+        }
+        ++numReceived;
+        unsigned int clientIndex = 0;
+        unsigned int sequence = 0;
+        unsigned int fillerLength = 0;
+        int headerLength = 0;
+        if (sscanf_s(msg, "%u %u %u %n", &clientIndex, &sequence, &fillerLength, &headerLength) != 3 || clientIndex >= nextSequences.size()
+            || connection->GetReceivedPayloadSize() != (size_t)headerLength + fillerLength)
+        {
+            ++numCorrupt;
+            return;
+        }
+        for (unsigned int i = 0; i < fillerLength; ++i)
+        {
+            if (msg[headerLength + i] != GetRemoteCommandTestFiller(clientIndex, sequence, i))
+            {
+                ++numCorrupt;
+                return;
+            }
+        }
+        numOutOfOrder += (sequence != nextSequences[clientIndex]) ? 1 : 0;
+        nextSequences[clientIndex] = sequence + 1;
+    };
+
+    std::vector<unsigned int> nextSequences; //By client index
+    unsigned int numReceived;
+    unsigned int numCorrupt;
+    unsigned int numOutOfOrder;
+};
+
+//-----------------------------------------------------------------------------------
+//Checks the host's console echo on one client: every line, in order, in its color, in few messages.
+struct RemoteCommandLoopbackClientCheck
+{
+    RemoteCommandLoopbackClientCheck() : numEchoMessages(0), numEchoLines(0), numEchoMismatches(0) {};
+
+    //-----------------------------------------------------------------------------------
+    void OnMessage(RemoteCommandServiceConnection* connection, const byte id, const char* msg)
+    {
+        if (id != MSG_ECHO)
+        {
+            return;
+        }
+        ++numEchoMessages;
+        size_t payloadSize = connection->GetReceivedPayloadSize();
+        size_t offset = 0;
+        while (offset + RemoteCommandService::ECHO_LINE_HEADER_SIZE < payloadSize)
+        {
+            const byte* color = (const byte*)msg + offset;
+            const char* text = msg + offset + RemoteCommandService::ECHO_LINE_HEADER_SIZE;
+            RGBA expectedColor = GetRemoteCommandTestColor(numEchoLines);
+            bool colorMatches = color[0] == expectedColor.red && color[1] == expectedColor.green && color[2] == expectedColor.blue && color[3] == expectedColor.alpha;
+            numEchoMismatches += (!colorMatches || Stringf("echo line %u", numEchoLines) != text) ? 1 : 0;
+            ++numEchoLines;
+            offset += RemoteCommandService::ECHO_LINE_HEADER_SIZE + strlen(text) + 1;
+        }
+    };
+
+    unsigned int numEchoMessages;
+    unsigned int numEchoLines;
+    unsigned int numEchoMismatches;
+};
+
+//-----------------------------------------------------------------------------------
+static void UpdateRemoteCommandLoopback(RemoteCommandService* host, std::vector<RemoteCommandService*>& clients)
+{
+    for (RemoteCommandService* client : clients)
+    {
+        if (client)
+        {
+            client->Update();
+        }
+    }
+    host->Update();
+}
+
+//-----------------------------------------------------------------------------------
+//A host and a set of tool clients in this process over real loopback sockets: everyone connects, every client streams framed
+//messages of random sizes at the host, the host echoes a burst of console lines back in one frame, then one client leaves.
+CONSOLE_COMMAND(rcstest)
+{
+    if (!(args.HasArgs(0) || args.HasArgs(2) || args.HasArgs(3)))
+    {
+        Console::instance->PrintLine("rcstest <clients> <messages per client> <port>", RGBA::RED);
+        return;
+    }
+    unsigned int numClients = args.HasArgs(0) ? 16 : (unsigned int)args.GetIntArgument(0);
+    unsigned int numMessages = args.HasArgs(0) ? 500 : (unsigned int)args.GetIntArgument(1);
+    std::string port = args.HasArgs(3) ? args.GetStringArgument(2) : "4326";
+    const unsigned int MESSAGES_PER_CLIENT_PER_FRAME = 8;
+    const unsigned int MAX_FILLER_LENGTH = 4096;
+    const unsigned int NUM_ECHO_LINES = 10000; //Enough to need several messages
+    const unsigned int NUM_IDLE_UPDATES = 1000;
+    const double TIMEOUT_SECONDS = 10.0;
+    if (numClients == 0)
+    {
+        Console::instance->PrintLine("rcstest: need at least one client", RGBA::RED);
+        return;
+    }
+
+    RemoteCommandService* host = new RemoteCommandService();
+    host->m_actsForLocalConsole = false;
+    if (!host->Host("127.0.0.1", port.c_str()))
+    {
+        Console::instance->PrintLine(Stringf("rcstest: couldn't host on 127.0.0.1:%s", port.c_str()), RGBA::RED);
+        delete host;
+        return;
+    }
+    RemoteCommandLoopbackHostCheck hostCheck(numClients);
+    host->m_onMessage.RegisterMethod(&hostCheck, &RemoteCommandLoopbackHostCheck::OnMessage);
+
+    std::vector<RemoteCommandService*> clients(numClients, nullptr);
+    std::vector<RemoteCommandLoopbackClientCheck> clientChecks(numClients);
+    unsigned int numJoined = 0;
+    for (unsigned int i = 0; i < numClients; ++i)
+    {
+        clients[i] = new RemoteCommandService();
+        clients[i]->m_actsForLocalConsole = false;
+        clients[i]->m_onMessage.RegisterMethod(&clientChecks[i], &RemoteCommandLoopbackClientCheck::OnMessage);
+        numJoined += clients[i]->Join("127.0.0.1", port.c_str()) ? 1 : 0;
+    }
+    double deadline = GetCurrentTimeSeconds() + TIMEOUT_SECONDS;
+    while (host->m_connections.size() < numJoined && GetCurrentTimeSeconds() < deadline)
+    {
+        UpdateRemoteCommandLoopback(host, clients);
+    }
+    unsigned int numAccepted = (unsigned int)host->m_connections.size();
+
+    //Every client streams at the host
+    std::vector<unsigned int> numSent(numClients, 0);
+    std::vector<char> payload;
+    uint32_t random = 1;
+    unsigned int numFrames = 0;
+    size_t numPayloadBytes = 0;
+    double sendStartSeconds = GetCurrentTimeSeconds();
+    deadline = sendStartSeconds + TIMEOUT_SECONDS;
+    while (hostCheck.numReceived < numJoined * numMessages && GetCurrentTimeSeconds() < deadline)
+    {
+        for (unsigned int i = 0; i < numClients; ++i)
+        {
+            if (!clients[i]->IsJoined())
+            {
+                continue;
+            }
+            for (unsigned int j = 0; j < MESSAGES_PER_CLIENT_PER_FRAME && numSent[i] < numMessages; ++j)
+            {
+                uint32_t fillerRandom = random;
+                unsigned int fillerLength = NextRemoteCommandTestRandom(fillerRandom) % MAX_FILLER_LENGTH;
+                std::string header = Stringf("%u %u %u ", i, numSent[i], fillerLength);
+                payload.assign(header.begin(), header.end());
+                for (unsigned int k = 0; k < fillerLength; ++k)
+                {
+                    payload.push_back(GetRemoteCommandTestFiller(i, numSent[i], k));
+                }
+                if (!clients[i]->m_connections[0]->Send(MSG_LOOPBACK_TEST, payload.data(), payload.size()))
+                {
+                    break; //Send buffer's full, try again next frame
+                }
+                random = fillerRandom;
+                numPayloadBytes += payload.size();
+                ++numSent[i];
+            }
+        }
+        UpdateRemoteCommandLoopback(host, clients);
+        ++numFrames;
+    }
+    double sendSeconds = GetCurrentTimeSeconds() - sendStartSeconds;
+
+    //One frame of console spam on the host, echoed to everyone
+    size_t numEchoBytes = 0;
+    for (unsigned int i = 0; i < NUM_ECHO_LINES; ++i)
+    {
+        std::string line = Stringf("echo line %u", i);
+        host->QueueEcho(line.c_str(), GetRemoteCommandTestColor(i));
+        numEchoBytes += RemoteCommandService::ECHO_LINE_HEADER_SIZE + line.size() + 1;
+    }
+    unsigned int numClientsWithAllLines = 0;
+    deadline = GetCurrentTimeSeconds() + TIMEOUT_SECONDS;
+    while (numClientsWithAllLines < numJoined && GetCurrentTimeSeconds() < deadline)
+    {
+        UpdateRemoteCommandLoopback(host, clients);
+        numClientsWithAllLines = 0;
+        for (const RemoteCommandLoopbackClientCheck& check : clientChecks)
+        {
+            numClientsWithAllLines += (check.numEchoLines >= NUM_ECHO_LINES) ? 1 : 0;
+        }
+    }
+    unsigned int maxEchoMessages = (unsigned int)((numEchoBytes + RemoteCommandServiceConnection::MAX_PAYLOAD_SIZE - 1) / RemoteCommandServiceConnection::MAX_PAYLOAD_SIZE);
+    unsigned int numEchoMismatches = 0;
+    unsigned int numUnbatchedClients = 0;
+    for (const RemoteCommandLoopbackClientCheck& check : clientChecks)
+    {
+        numEchoMismatches += check.numEchoMismatches + ((check.numEchoLines != NUM_ECHO_LINES) ? 1 : 0);
+        numUnbatchedClients += (check.numEchoMessages > maxEchoMessages) ? 1 : 0;
+    }
+
+    //What the host costs a frame with everyone attached and nothing happening
+    double idleStartSeconds = GetCurrentTimeSeconds();
+    for (unsigned int i = 0; i < NUM_IDLE_UPDATES; ++i)
+    {
+        host->Update();
+    }
+    double idleMicroseconds = ((GetCurrentTimeSeconds() - idleStartSeconds) * 1000000.0) / NUM_IDLE_UPDATES;
+
+    //One tool goes away
+    delete clients[0];
+    clients[0] = nullptr;
+    deadline = GetCurrentTimeSeconds() + TIMEOUT_SECONDS;
+    while (host->m_connections.size() + 1 > numAccepted && GetCurrentTimeSeconds() < deadline)
+    {
+        UpdateRemoteCommandLoopback(host, clients);
+    }
+    unsigned int numAfterLeave = (unsigned int)host->m_connections.size();
+
+    int numChecks = 0;
+    int numPassed = 0;
+    bool passed = (numJoined == numClients) && (numAccepted == numClients);
+    numChecks += 1;
+    numPassed += passed ? 1 : 0;
+    Console::instance->PrintLine(Stringf("  %s: %u joined, %u accepted", passed ? "PASS" : "FAIL", numJoined, numAccepted), passed ? RGBA::GREEN : RGBA::RED);
+
+    passed = (hostCheck.numReceived == numJoined * numMessages) && (hostCheck.numCorrupt == 0) && (hostCheck.numOutOfOrder == 0);
+    numChecks += 1;
+    numPassed += passed ? 1 : 0;
+    Console::instance->PrintLine(Stringf("  %s: %u/%u messages, %u corrupt, %u out of order, %.1f MB in %u frames (%.1f MB/s)", passed ? "PASS" : "FAIL",
+        hostCheck.numReceived, numJoined * numMessages, hostCheck.numCorrupt, hostCheck.numOutOfOrder, numPayloadBytes / (1024.0 * 1024.0), numFrames,
+        (sendSeconds > 0.0) ? (numPayloadBytes / (1024.0 * 1024.0)) / sendSeconds : 0.0), passed ? RGBA::GREEN : RGBA::RED);
+
+    passed = (numClientsWithAllLines == numJoined) && (numEchoMismatches == 0) && (numUnbatchedClients == 0);
+    numChecks += 1;
+    numPassed += passed ? 1 : 0;
+    Console::instance->PrintLine(Stringf("  %s: %u/%u clients got all %u echo lines, %u mismatches, %u over %u messages", passed ? "PASS" : "FAIL",
+        numClientsWithAllLines, numJoined, NUM_ECHO_LINES, numEchoMismatches, numUnbatchedClients, maxEchoMessages), passed ? RGBA::GREEN : RGBA::RED);
+
+    passed = (numAfterLeave + 1 == numAccepted);
+    numChecks += 1;
+    numPassed += passed ? 1 : 0;
+    Console::instance->PrintLine(Stringf("  %s: %u connections after one left, idle host update %.1fus with %u attached", passed ? "PASS" : "FAIL",
+        numAfterLeave, idleMicroseconds, numAccepted), passed ? RGBA::GREEN : RGBA::RED);
+
+    for (RemoteCommandService* client : clients)
+    {
+        delete client;
+    }
+    delete host;
+    Console::instance->PrintLine(Stringf("rcstest: %i/%i checks passed", numPassed, numChecks), (numPassed == numChecks) ? RGBA::GREEN : RGBA::RED);
+}
+
+//-----------------------------------------------------------------------------------
+//Follows one client's feeds: the test's own log lines, whether the log sequence skipped anywhere, and the metrics samples.
+struct RemoteCommandFeedCheck
+{
+    RemoteCommandFeedCheck() : nextSequence(0), numSequenceGaps(0), numLines(0), lastLineIndex(-1), numLinesOutOfOrder(0), numSamples(0), numSampleGaps(0), nextSampleIndex(0), hasSequence(false) {};
+
+    //-----------------------------------------------------------------------------------
+    void OnMessage(RemoteCommandServiceConnection* connection, const byte id, const char* msg)
+    {
+        size_t payloadSize = connection->GetReceivedPayloadSize();
+        if (id == MSG_FEED_LOG && payloadSize >= 6)
+        {
+            const byte* header = (const byte*)msg;
+            uint32_t firstSequence = ((uint32_t)header[0] << 24) | ((uint32_t)header[1] << 16) | ((uint32_t)header[2] << 8) | header[3];
+            unsigned int lineCount = ((unsigned int)header[4] << 8) | header[5];
+            numSequenceGaps += (hasSequence && firstSequence != nextSequence) ? 1 : 0;
+            nextSequence = firstSequence + lineCount;
+            hasSequence = true;
+            size_t offset = 6;
+            while (offset < payloadSize)
+            {
+                const char* line = msg + offset;
+                int lineIndex = 0;
+                if (sscanf_s(line, "rcsfeedtest line %i", &lineIndex) == 1)
+                {
+                    numLinesOutOfOrder += (lineIndex <= lastLineIndex) ? 1 : 0;
+                    lastLineIndex = lineIndex;
+                    ++numLines;
+                }
+                offset += strlen(line) + 1;
+            }
+        }
+        else if (id == MSG_FEED_METRICS)
+        {
+            RemoteMetricsSample sample;
+            BytePacker packer((void*)msg, 0, payloadSize, IBinaryReader::BIG_ENDIAN);
+            if (sample.Read(packer))
+            {
+                numSampleGaps += (sample.sampleIndex != nextSampleIndex) ? 1 : 0;
+                nextSampleIndex = sample.sampleIndex + 1;
+                ++numSamples;
+            }
+        }
+    };
+
+    uint32_t nextSequence;
+    unsigned int numSequenceGaps;
+    unsigned int numLines;
+    int lastLineIndex;
+    unsigned int numLinesOutOfOrder;
+    unsigned int numSamples;
+    unsigned int numSampleGaps;
+    uint32_t nextSampleIndex;
+    bool hasSequence;
+};
+
+//-----------------------------------------------------------------------------------
+//Tools following the log and metrics of a host that's logging heavily. The prompt ones have to see every line and sample,
+//the one that stops reading for a while has to cost the host nothing, lose its oldest data, and still end up with the newest.
+CONSOLE_COMMAND(rcsfeedtest)
+{
+    if (!(args.HasArgs(0) || args.HasArgs(2) || args.HasArgs(3)))
+    {
+        Console::instance->PrintLine("rcsfeedtest <frames> <lines per frame> <port>", RGBA::RED);
+        return;
+    }
+    if (!Logger::instance)
+    {
+        Console::instance->PrintLine("rcsfeedtest: the logger isn't running", RGBA::RED);
+        return;
+    }
+    unsigned int numFrames = args.HasArgs(0) ? 600 : (unsigned int)args.GetIntArgument(0);
+    unsigned int linesPerFrame = args.HasArgs(0) ? 40 : (unsigned int)args.GetIntArgument(1);
+    std::string port = args.HasArgs(3) ? args.GetStringArgument(2) : "4327";
+    const unsigned int NUM_PROMPT_CLIENTS = 3;
+    const double TIMEOUT_SECONDS = 10.0;
+    const char* FILLER = "................................................................................................................................................................";
+    int lastLineIndex = (int)(numFrames * linesPerFrame) - 1;
+
+    RemoteCommandService* host = new RemoteCommandService();
+    host->m_actsForLocalConsole = false;
+    if (!host->Host("127.0.0.1", port.c_str()))
+    {
+        Console::instance->PrintLine(Stringf("rcsfeedtest: couldn't host on 127.0.0.1:%s", port.c_str()), RGBA::RED);
+        delete host;
+        return;
+    }
+    std::vector<RemoteCommandService*> clients(NUM_PROMPT_CLIENTS + 1, nullptr);
+    std::vector<RemoteCommandFeedCheck> checks(clients.size());
+    unsigned int numJoined = 0;
+    for (size_t i = 0; i < clients.size(); ++i)
+    {
+        clients[i] = new RemoteCommandService();
+        clients[i]->m_actsForLocalConsole = false;
+        clients[i]->m_onMessage.RegisterMethod(&checks[i], &RemoteCommandFeedCheck::OnMessage);
+        if (clients[i]->Join("127.0.0.1", port.c_str()))
+        {
+            ++numJoined;
+            byte subscription[3] = { FEED_LOG | FEED_METRICS, 0, 0 }; //Metrics every update
+            clients[i]->m_connections[0]->Send(MSG_SUBSCRIBE, subscription, sizeof(subscription));
+        }
+    }
+    std::vector<RemoteCommandService*> promptClients(clients.begin(), clients.end() - 1);
+    double deadline = GetCurrentTimeSeconds() + TIMEOUT_SECONDS;
+    while (host->m_connections.size() < numJoined && GetCurrentTimeSeconds() < deadline)
+    {
+        UpdateRemoteCommandLoopback(host, clients);
+    }
+    for (unsigned int i = 0; i < 10; ++i)
+    {
+        UpdateRemoteCommandLoopback(host, clients); //Subscriptions land
+    }
+
+    //Heavy logging, the slow client isn't reading
+    double maxHostUpdateSeconds = 0.0;
+    double totalHostUpdateSeconds = 0.0;
+    unsigned int numHostUpdates = 0;
+    int nextLineIndex = 0;
+    deadline = GetCurrentTimeSeconds() + TIMEOUT_SECONDS * 3.0;
+    while (GetCurrentTimeSeconds() < deadline)
+    {
+        if ((unsigned int)nextLineIndex < numFrames * linesPerFrame)
+        {
+            for (unsigned int i = 0; i < linesPerFrame; ++i, ++nextLineIndex)
+            {
+                LogPrintf("rcsfeedtest line %i %s\n", nextLineIndex, FILLER);
+            }
+        }
+        for (RemoteCommandService* client : promptClients)
+        {
+            client->Update();
+        }
+        double startSeconds = GetCurrentTimeSeconds();
+        host->Update();
+        double hostUpdateSeconds = GetCurrentTimeSeconds() - startSeconds;
+        maxHostUpdateSeconds = std::max(maxHostUpdateSeconds, hostUpdateSeconds);
+        totalHostUpdateSeconds += hostUpdateSeconds;
+        ++numHostUpdates;
+
+        bool havePromptClientsCaughtUp = true;
+        for (unsigned int i = 0; i < NUM_PROMPT_CLIENTS; ++i)
+        {
+            havePromptClientsCaughtUp = havePromptClientsCaughtUp && (checks[i].lastLineIndex == lastLineIndex);
+        }
+        if (havePromptClientsCaughtUp)
+        {
+            break;
+        }
+    }
+    unsigned int numSlowDroppedFrames = 0;
+    size_t maxQueuedForSlowClient = 0;
+    for (RemoteCommandServiceConnection* connection : host->m_connections)
+    {
+        numSlowDroppedFrames = std::max(numSlowDroppedFrames, connection->m_numDroppedFeedFrames);
+        maxQueuedForSlowClient = std::max(maxQueuedForSlowClient, connection->m_tcpConnection->m_sendBuffer.GetSize() + (connection->m_feedQueue ? connection->m_feedQueue->GetSize() : 0));
+    }
+
+    //The slow client catches up
+    deadline = GetCurrentTimeSeconds() + TIMEOUT_SECONDS;
+    while (checks.back().lastLineIndex != lastLineIndex && GetCurrentTimeSeconds() < deadline)
+    {
+        UpdateRemoteCommandLoopback(host, clients);
+    }
+
+    int numChecks = 0;
+    int numPassed = 0;
+    for (unsigned int i = 0; i < NUM_PROMPT_CLIENTS; ++i)
+    {
+        const RemoteCommandFeedCheck& check = checks[i];
+        bool passed = (check.numLines == numFrames * linesPerFrame) && (check.numLinesOutOfOrder == 0) && (check.numSequenceGaps == 0) && (check.numSamples > 0) && (check.numSampleGaps == 0);
+        numChecks += 1;
+        numPassed += passed ? 1 : 0;
+        Console::instance->PrintLine(Stringf("  %s: prompt client %u got %u/%u lines, %u out of order, %u sequence gaps, %u metrics samples with %u gaps", passed ? "PASS" : "FAIL",
+            i, check.numLines, numFrames * linesPerFrame, check.numLinesOutOfOrder, check.numSequenceGaps, check.numSamples, check.numSampleGaps), passed ? RGBA::GREEN : RGBA::RED);
+    }
+
+    const RemoteCommandFeedCheck& slowCheck = checks.back();
+    size_t maxQueuedBytes = RemoteCommandServiceConnection::FEED_QUEUE_SIZE + TCPConnection::SEND_BUFFER_SIZE;
+    bool hasDroppedForSlowClient = (numSlowDroppedFrames > 0) && (slowCheck.numSequenceGaps > 0); //With little enough logging the socket buffers soak it all up
+    bool hasDeliveredEverything = (numSlowDroppedFrames == 0) && (slowCheck.numSequenceGaps == 0) && (slowCheck.numLines == numFrames * linesPerFrame);
+    bool passed = (hasDroppedForSlowClient || hasDeliveredEverything) && (slowCheck.lastLineIndex == lastLineIndex) && (slowCheck.numLinesOutOfOrder == 0)
+        && (maxQueuedForSlowClient <= maxQueuedBytes);
+    numChecks += 1;
+    numPassed += passed ? 1 : 0;
+    Console::instance->PrintLine(Stringf("  %s: slow client got %u lines ending at %i, %u sequence gaps, host dropped %u frames and held %u bytes for it", passed ? "PASS" : "FAIL",
+        slowCheck.numLines, slowCheck.lastLineIndex, slowCheck.numSequenceGaps, numSlowDroppedFrames, (unsigned int)maxQueuedForSlowClient), passed ? RGBA::GREEN : RGBA::RED);
+    Console::instance->PrintLine(Stringf("  host update %.1fus average, %.1fus worst over %u updates, %u log lines dropped before being read", (totalHostUpdateSeconds * 1000000.0) / std::max(numHostUpdates, 1u),
+        maxHostUpdateSeconds * 1000000.0, numHostUpdates, host->m_numDroppedLogLines), RGBA::GRAY);
+
+    for (RemoteCommandService* client : clients)
+    {
+        delete client;
+    }
+    delete host;
+    Console::instance->PrintLine(Stringf("rcsfeedtest: %i/%i checks passed", numPassed, numChecks), (numPassed == numChecks) ? RGBA::GREEN : RGBA::RED);
+}
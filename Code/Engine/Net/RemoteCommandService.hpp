@@ -2,7 +2,12 @@
 #include "Engine/Net/TCPIP/TCPConnection.hpp"
 #include "Engine/Net/TCPIP/TCPListener.hpp"
 #include "Engine/Core/Events/Event.hpp"
+#include "Engine/DataStructures/ByteRingBuffer.hpp"
+#include "Engine/Renderer/RGBA.hpp"
 #include <vector>
+#include <string>
+
+class BytePacker;
 
 //TYPEDEFS/////////////////////////////////////////////////////////////////////
 typedef unsigned char byte;
@@ -13,41 +18,120 @@ typedef unsigned char byte;
 const byte MSG_COMMAND = 1; //Run a console command
 const byte MSG_ECHO = 2; //Print on the remote console
 const byte MSG_RENAME = 3; //Give the remote connection a name
+const byte MSG_SUBSCRIBE = 4; //Ask for feeds: a byte of FEED_ flags, then the metrics interval in ms as a uint16. No flags unsubscribes
+const byte MSG_FEED_LOG = 5; //First line's log sequence as a uint32, the line count as a uint16, then each line followed by a null
+const byte MSG_FEED_METRICS = 6; //One RemoteMetricsSample
+const byte FEED_LOG = 1 << 0;
+const byte FEED_METRICS = 1 << 1;
+
+//-----------------------------------------------------------------------------------
+//How a server is doing at one moment, as sent on the metrics feed. Fields go big endian in declaration order.
+struct RemoteMetricsSample
+{
+    //CONSTRUCTORS/////////////////////////////////////////////////////////////////////
+    RemoteMetricsSample();
+
+    //FUNCTIONS/////////////////////////////////////////////////////////////////////
+    void Write(BytePacker& packer) const;
+    bool Read(BytePacker& packer);
+
+    //CONSTANTS/////////////////////////////////////////////////////////////////////
+    static const size_t PACKED_SIZE = 4 + 4 + 4 + 4 + 8 + 8 + 8 + 8 + 8 + 4 + 4 + 4 + 4 + 4 + 4;
+
+    //MEMBER VARIABLES/////////////////////////////////////////////////////////////////////
+    uint32_t sampleIndex; //Counts up per connection, so a gap means samples were dropped
+    float frameMs; //Between the service's last two updates
+    float averageFrameMs;
+    uint32_t numLiveAllocations; //Memory counters are 0 without TRACK_MEMORY
+    uint64_t numLiveBytes;
+    uint64_t highwaterBytes;
+    uint64_t numTotalAllocations;
+    uint64_t numNetBytesSent; //In the last profiled frame, 0 without PROFILING_ENABLED
+    uint64_t numNetBytesReceived;
+    uint32_t numNetResends; //Also the last profiled frame's, summed over connections
+    uint32_t numNetUnsentReliables;
+    float netRoundTripMs; //The worst connection's
+    float netLossRate;
+    uint32_t numDroppedFeedFrames; //This connection's, since it connected
+    uint32_t numDroppedLogLines; //Overwritten in the logger before the service got to them, since startup
+};
 
 //-----------------------------------------------------------------------------------
+//Messages are framed as a 2 byte big endian length, then the id, then the payload, the length counting the id and payload.
+//Sends are queued in the connection's send buffer and go out when the service flushes, so a tool that stops reading only fills
+//its own buffer instead of stalling the frame. Once that's full, further sends to it are dropped and counted.
 class RemoteCommandServiceConnection
 {
 public:
     RemoteCommandServiceConnection(TCPConnection* tcpConnection);
     ~RemoteCommandServiceConnection();
-    void Send(byte commandId, const char* command);
-    void Receive();
+    bool Send(byte commandId, const char* command);
+    bool Send(byte commandId, const void* payload, size_t payloadSize); //False if it was dropped
+    void Receive(); //Triggers m_onMessage for every complete message that has arrived
+    void Flush();
+    inline bool IsConnected() { return m_tcpConnection->IsConnected(); };
     const char* GetAddressString();
+    inline size_t GetReceivedPayloadSize() const { return m_nextMessage.size() - 2; }; //Only valid inside m_onMessage, payloads can hold nulls
+    void Subscribe(byte feeds, unsigned int metricsIntervalMs);
+    void QueueFeedFrame(byte feedId, const void* payload, size_t payloadSize); //Drops the oldest queued feed frames to make room
+    void FlushFeed(); //Moves queued feed frames into the send buffer while it has room for them
+
+    //CONSTANTS/////////////////////////////////////////////////////////////////////
+    static const size_t FRAME_HEADER_SIZE = 2;
+    static const size_t MAX_PAYLOAD_SIZE = 0xFFFF - 1; //The length field also covers the id
+    static const unsigned int MAX_RECEIVE_PASSES = 4; //Bounds the time one chatty connection can take in a frame
+    static const size_t FEED_QUEUE_SIZE = 128 * 1024; //How far behind a subscriber can get before the oldest feed data goes
+    static const size_t MAX_FEED_BYTES_IN_SEND_BUFFER = 16 * 1024; //Keeps stale feed data from piling up where it can't be dropped
+
     //MEMBER VARIABLES/////////////////////////////////////////////////////////////////////
     TCPConnection* m_tcpConnection;
-    std::vector<char> m_nextMessage;
+    std::vector<char> m_nextMessage; //Id then payload then a null, reused between messages
+    std::string m_name;
+    unsigned int m_numDroppedMessages;
+    byte m_subscribedFeeds; //FEED_ flags
+    unsigned int m_metricsIntervalMs;
+    double m_lastMetricsSeconds;
+    uint32_t m_numMetricsSamples;
+    unsigned int m_numDroppedFeedFrames;
+    ByteRingBuffer* m_feedQueue; //Framed like the stream, only allocated once the connection subscribes
+    std::vector<char> m_feedScratch;
     Event<RemoteCommandServiceConnection*, byte, const char*> m_onMessage;
 };
 
 //-----------------------------------------------------------------------------------
+//Accepts, receives and flushes every connection off a single poll of all the sockets, so an idle service costs one call a frame
+//however many tools are attached. While hosting, console output is collected over the frame and sent to each client as one echo.
+//Tools can also subscribe to a feed of log lines and periodic metrics. Feed frames wait in a per connection queue that drops the
+//oldest when a tool falls behind, so a slow tool sees a gap rather than stalling the server or getting further and further behind.
 class RemoteCommandService
 {
 public:
     RemoteCommandService();
     ~RemoteCommandService();
-    bool Host(const char* hostName); //Create a socket
+    bool Host(const char* hostName, const char* port = REMOTE_COMMAND_SERVICE_PORT_STRING); //Create a socket
     bool StopHosting();
-    bool Join(const char* hostName); //Create a TCPConnection and add it to the connection list
+    bool Join(const char* hostName, const char* port = REMOTE_COMMAND_SERVICE_PORT_STRING); //Create a TCPConnection and add it to the connection list
     void SendCommand(byte commandId, const char* command);
     void Update();
     void AddConnection(RemoteCommandServiceConnection* connection);
     void OnRecieveRemoteMessage(RemoteCommandServiceConnection* connectionPointer, const byte id, const char* msg);
+    void OnConsolePrintLine(const std::string& line, const RGBA& color);
+    void QueueEcho(const char* line, const RGBA& color); //Goes to every client at the end of the frame
     void CheckForConnection();
     void CheckForMessages();
     void CheckForDisconnection();
+    void FlushEcho();
+    void UpdateFeeds();
+    void SampleMetrics(RemoteMetricsSample& outSample);
     inline bool IsHosting() { return m_listener != nullptr; };
     inline bool IsJoined() { return !IsHosting() && (m_connections.size() > 0); };
     void DisconnectFromHost();
+
+    //CONSTANTS/////////////////////////////////////////////////////////////////////
+    static const size_t MAX_ECHO_BYTES_PER_FRAME = 256 * 1024; //Lines past this in one frame are dropped and counted
+    static const size_t ECHO_LINE_HEADER_SIZE = 4; //Red, green, blue, alpha, then the text and a null
+    static const unsigned int DEFAULT_METRICS_INTERVAL_MS = 1000;
+
     //MEMBER VARIABLES/////////////////////////////////////////////////////////////////////
     static RemoteCommandService* instance;
 
@@ -56,4 +140,23 @@ public:
     Event<RemoteCommandServiceConnection*> m_onConnectionJoin;
     Event<RemoteCommandServiceConnection*> m_onConnectionLeave;
     Event<RemoteCommandServiceConnection*, const byte, const char*> m_onMessage;
-};
\ No newline at end of file
+    bool m_actsForLocalConsole; //Runs received commands, prints received echoes, and mirrors the console while hosting. Off for services that only relay
+    unsigned int m_numDroppedEchoLines;
+    unsigned int m_numDroppedLogLines;
+
+private:
+    //MEMBER VARIABLES/////////////////////////////////////////////////////////////////////
+    std::vector<WSAPOLLFD> m_pollSockets; //Listener first if hosting, then one per connection. Rebuilt every update without reallocating
+    std::string m_pendingEcho; //Encoded lines waiting for the end of the frame
+    unsigned int m_numDroppedEchoLinesThisFrame;
+    size_t m_firstConnectionPoll;
+    bool m_isListeningToConsole;
+    bool m_isPrintingRemoteEcho; //So a client printing what the host sent never echoes it back
+    bool m_isUpdating; //Connections dropped during an update are only deleted at its end
+    uint64_t m_nextLogSequence;
+    bool m_isFeedingLog; //Lines the logger overwrote while nobody was subscribed aren't drops
+    std::string m_logFeedLines; //Scratch for the lines going out this update
+    double m_lastUpdateSeconds;
+    float m_lastFrameMs;
+    float m_averageFrameMs;
+};
@@ -5,14 +5,20 @@
 TCPConnection::TCPConnection(SOCKET socket, sockaddr_in& inAddress)
     : m_socket(socket)
     , m_address(inAddress)
-    , m_host(NetSystem::SockAddrToString((sockaddr*)&inAddress))
+    , m_host(NetAddress::SockAddrToString((sockaddr*)&inAddress))
+    , m_port(nullptr)
+    , m_sendBuffer(SEND_BUFFER_SIZE)
+    , m_receiveBuffer(RECEIVE_BUFFER_SIZE)
 {
 }
 
 //-----------------------------------------------------------------------------------
 TCPConnection::TCPConnection(const char* host, const char* portNumber)
-    : m_host(host)
+    : m_socket(INVALID_SOCKET)
+    , m_host(host)
     , m_port(portNumber)
+    , m_sendBuffer(SEND_BUFFER_SIZE)
+    , m_receiveBuffer(RECEIVE_BUFFER_SIZE)
 {
 
 }
@@ -20,6 +26,10 @@ TCPConnection::TCPConnection(const char* host, const char* portNumber)
 //-----------------------------------------------------------------------------------
 void TCPConnection::Disconnect()
 {
+    if (m_socket == INVALID_SOCKET)
+    {
+        return;
+    }
     NetSystem::CloseSocket(m_socket);
     m_socket = INVALID_SOCKET;
 }
@@ -29,6 +39,10 @@ size_t TCPConnection::Send(const void* data, size_t size)
 {
     bool shouldDisconnect = false;
     size_t sizeSent = NetSystem::SendOnSocket(shouldDisconnect, m_socket, data, size);
+    if (shouldDisconnect)
+    {
+        Disconnect();
+    }
     return sizeSent;
 }
 
@@ -37,9 +51,57 @@ size_t TCPConnection::Receive(void* buffer, size_t size)
 {
     bool shouldDisconnect = false;
     size_t sizeRecieved = NetSystem::RecieveFromSocket(shouldDisconnect, m_socket, buffer, size);
+    if (shouldDisconnect)
+    {
+        Disconnect();
+    }
     return sizeRecieved;
 }
 
+//-----------------------------------------------------------------------------------
+bool TCPConnection::QueueSend(const void* data, size_t size)
+{
+    return IsConnected() && m_sendBuffer.Write(data, size);
+}
+
+//-----------------------------------------------------------------------------------
+size_t TCPConnection::FlushSend()
+{
+    size_t totalSent = 0;
+    while (IsConnected() && !m_sendBuffer.IsEmpty())
+    {
+        size_t regionSize = 0;
+        const byte* region = m_sendBuffer.GetReadRegion(regionSize);
+        size_t sizeSent = Send(region, regionSize);
+        m_sendBuffer.Consume(sizeSent);
+        totalSent += sizeSent;
+        if (sizeSent < regionSize)
+        {
+            break; //The socket's own buffer is full, try again next frame
+        }
+    }
+    return totalSent;
+}
+
+//-----------------------------------------------------------------------------------
+size_t TCPConnection::ReceiveAvailable()
+{
+    size_t totalReceived = 0;
+    while (IsConnected() && m_receiveBuffer.GetFreeSpace() > 0)
+    {
+        size_t regionSize = 0;
+        byte* region = m_receiveBuffer.GetWriteRegion(regionSize);
+        size_t sizeReceived = Receive(region, regionSize);
+        m_receiveBuffer.CommitWrite(sizeReceived);
+        totalReceived += sizeReceived;
+        if (sizeReceived < regionSize)
+        {
+            break; //Nothing more waiting, or the socket closed
+        }
+    }
+    return totalReceived;
+}
+
 //-----------------------------------------------------------------------------------
 bool TCPConnection::IsConnected()
 {
@@ -50,5 +112,5 @@ bool TCPConnection::IsConnected()
 const char* TCPConnection::GetAddressString()
 {
     sockaddr* address = (sockaddr*)&m_address;
-    return NetSystem::SockAddrToString(address);
+    return NetAddress::SockAddrToString(address);
 }
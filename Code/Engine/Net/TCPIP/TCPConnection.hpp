@@ -3,7 +3,11 @@
 #include <stdint.h>
 #include <WinSock2.h>
 #include <WS2tcpip.h>
+#include "Engine/DataStructures/ByteRingBuffer.hpp"
 
+//Stream over a non-blocking socket. Sends can go straight to the socket, or into a send buffer that FlushSend() drains as fast as the
+//socket takes it, so a slow reader never stalls the frame. Likewise ReceiveAvailable() pulls whatever has arrived into a receive buffer
+//for the owner to pick complete messages out of.
 class TCPConnection
 {
 public:
@@ -13,12 +17,22 @@ public:
     void Disconnect(); //Close Socket
     size_t Send(const void* data, size_t size); //Send On Socket
     size_t Receive(void* buffer, size_t size); //ReceiveOnSocket
+    bool QueueSend(const void* data, size_t size); //All or nothing, false if the send buffer is full
+    size_t FlushSend(); //Sends as much of the send buffer as the socket will take without blocking
+    size_t ReceiveAvailable(); //Reads from the socket into the receive buffer until it would block or the buffer is full
     bool IsConnected(); //Socket != INVALID_SOCKET
+    inline bool HasQueuedSends() const { return !m_sendBuffer.IsEmpty(); };
     const char* GetAddressString();
 
+    //CONSTANTS////////////////////////////////////////////////////////////////////
+    static const size_t SEND_BUFFER_SIZE = 256 * 1024;
+    static const size_t RECEIVE_BUFFER_SIZE = 128 * 1024; //Room for the largest remote command service message
+
     //MEMBER VARIABLES////////////////////////////////////////////////////////////////////
     SOCKET m_socket;
     sockaddr_in m_address;
     const char* m_host;
     const char* m_port;
-};
\ No newline at end of file
+    ByteRingBuffer m_sendBuffer;
+    ByteRingBuffer m_receiveBuffer;
+};
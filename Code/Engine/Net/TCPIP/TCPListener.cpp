@@ -12,7 +12,7 @@ TCPListener::TCPListener(const char* host, const char* port, int /*= 1*/)
 }
 
 //-----------------------------------------------------------------------------------
-TCPListener::TCPListener(const char* port) : TCPListener(NetSystem::instance->GetLocalHostName(), port)
+TCPListener::TCPListener(const char* port) : TCPListener(NetAddress::GetLocalHostName(), port)
 {
 
 }
@@ -24,6 +24,7 @@ TCPConnection* TCPListener::ListenAndAcceptConnection()
     SOCKET socket = NetSystem::AcceptConnection(m_socket, &address);
     if (socket != INVALID_SOCKET)
     {
+        NetSystem::SetSocketNonBlocking(socket); //Winsock carries it over from the listener, but don't count on it
         TCPConnection* newConnection = new TCPConnection(socket, address);
         return newConnection;
     }
@@ -49,5 +50,5 @@ bool TCPListener::IsListening()
 const char* TCPListener::GetAddressString()
 {
     sockaddr* address = (sockaddr*)&m_address;
-    return NetSystem::SockAddrToString(address);
+    return NetAddress::SockAddrToString(address);
 }
@@ -13,7 +13,7 @@ public:
     TCPListener(const char* port); //default to localhost (host name ip) 
 
     //FUNCTIONS/////////////////////////////////////////////////////////////////////
-    TCPConnection* ListenAndAcceptConnection(); //::accept and creates socket
+    TCPConnection* ListenAndAcceptConnection(); //::accept and creates socket, nullptr straight away if nobody is waiting
     void Stop(); //Close Socket
     bool IsListening(); //Store as is_connected
     const char* GetAddressString();
@@ -0,0 +1,283 @@
+#include "Engine/Net/UDPIP/InterestManager.hpp"
+#include "Engine/Net/UDPIP/NetSession.hpp"
+#include "Engine/Net/UDPIP/NetConnection.hpp"
+#include "Engine/Net/UDPIP/NetMessage.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include <algorithm>
+#include <cmath>
+
+//-----------------------------------------------------------------------------------
+InterestManager::InterestManager()
+    : m_maxEntitiesPerUpdate(DEFAULT_MAX_ENTITIES_PER_UPDATE)
+    , m_cellSize(1.0f)
+    , m_numCellsX(1)
+    , m_numCellsY(1)
+    , m_entities(MAX_ENTITIES)
+{
+    SetWorldBounds(Vector2(-512.0f), Vector2(512.0f), 32.0f);
+}
+
+//-----------------------------------------------------------------------------------
+void InterestManager::SetWorldBounds(const Vector2& mins, const Vector2& maxs, float cellSize)
+{
+    ASSERT_OR_DIE(maxs.x > mins.x && maxs.y > mins.y && cellSize > 0.0f, "Interest grid needs a non-empty world and a positive cell size");
+    m_worldMins = mins;
+    m_cellSize = cellSize;
+    m_numCellsX = (unsigned int)Max<float>(ceilf((maxs.x - mins.x) / cellSize), 1.0f);
+    m_numCellsY = (unsigned int)Max<float>(ceilf((maxs.y - mins.y) / cellSize), 1.0f);
+    ASSERT_OR_DIE(m_numCellsX * m_numCellsY <= MAX_GRID_CELLS, "Interest grid cells are too small for the world, use bigger ones");
+    m_cellStarts.assign((m_numCellsX * m_numCellsY) + 1, 0);
+}
+
+//-----------------------------------------------------------------------------------
+void InterestManager::SetEntity(uint16_t entityId, const Vector2& position, float importance)
+{
+    ASSERT_OR_DIE(entityId < MAX_ENTITIES, "Entity id is too big for the interest manager");
+    Entity& entity = m_entities[entityId];
+    if (!entity.isActive)
+    {
+        entity.isActive = true;
+        entity.activeSlot = (uint16_t)m_activeIds.size();
+        m_activeIds.push_back(entityId);
+    }
+    entity.position = position;
+    entity.importance = importance;
+}
+
+//-----------------------------------------------------------------------------------
+//Forgets the entity's priority on every connection too, so a new entity reusing the id starts from nothing
+void InterestManager::RemoveEntity(uint16_t entityId)
+{
+    if (!HasEntity(entityId))
+    {
+        return;
+    }
+    Entity& entity = m_entities[entityId];
+    uint16_t lastId = m_activeIds.back();
+    m_activeIds[entity.activeSlot] = lastId;
+    m_entities[lastId].activeSlot = entity.activeSlot;
+    m_activeIds.pop_back();
+    entity.isActive = false;
+    for (Interest& interest : m_interests)
+    {
+        if (!interest.accumulators.empty())
+        {
+            interest.accumulators[entityId] = 0.0f;
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------------
+void InterestManager::SetInterest(uint16_t connectionIndex, const Vector2& center, float radius)
+{
+    if (connectionIndex >= m_interests.size())
+    {
+        m_interests.resize(connectionIndex + 1);
+    }
+    Interest& interest = m_interests[connectionIndex];
+    if (interest.accumulators.empty())
+    {
+        interest.accumulators.assign(MAX_ENTITIES, 0.0f);
+        interest.selected.reserve(m_maxEntitiesPerUpdate);
+    }
+    interest.center = center;
+    interest.radius = Max<float>(radius, 0.0f);
+    interest.isActive = true;
+}
+
+//-----------------------------------------------------------------------------------
+//Keeps the accumulators allocated, since connection indices get reused by whoever joins next
+void InterestManager::ClearInterest(uint16_t connectionIndex)
+{
+    if (connectionIndex >= m_interests.size())
+    {
+        return;
+    }
+    Interest& interest = m_interests[connectionIndex];
+    interest.isActive = false;
+    interest.numRelevant = 0;
+    interest.selected.clear();
+    std::fill(interest.accumulators.begin(), interest.accumulators.end(), 0.0f);
+}
+
+//-----------------------------------------------------------------------------------
+void InterestManager::Update()
+{
+    RebuildGrid();
+    for (Interest& interest : m_interests)
+    {
+        UpdateInterest(interest);
+    }
+}
+
+//-----------------------------------------------------------------------------------
+//Every update is a fresh set of picks, so the messages are only worth sending unreliably
+void InterestManager::SendUpdates(NetSession& session, uint8_t messageType, InterestEntityWriter* writeEntity, size_t maxEntityBytes)
+{
+    const size_t maxPayloadBytes = MESSAGE_MTU - NetConnection::MESSAGE_HEADER_BYTES;
+    ASSERT_OR_DIE(maxEntityBytes > 0 && maxEntityBytes <= maxPayloadBytes, "An entity update has to fit in a message");
+    NetConnection* myConnection = session.GetMyConnection();
+    NetMessage msg(messageType);
+    for (unsigned int activeIndex = 0; activeIndex < session.GetNumActiveConnections(); ++activeIndex)
+    {
+        NetConnection* connection = session.GetActiveConnection(activeIndex);
+        if (connection == myConnection || !connection->IsConnected())
+        {
+            continue;
+        }
+        msg.SetReadableBytes(0);
+        for (uint16_t entityId : GetSelectedEntities(connection->m_index))
+        {
+            if (msg.GetPayloadSize() + maxEntityBytes > maxPayloadBytes)
+            {
+                connection->SendMessage(msg);
+                msg.SetReadableBytes(0);
+            }
+            writeEntity(entityId, msg);
+        }
+        if (msg.GetPayloadSize() > 0)
+        {
+            connection->SendMessage(msg);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------------
+const std::vector<uint16_t>& InterestManager::GetSelectedEntities(uint16_t connectionIndex) const
+{
+    return (connectionIndex < m_interests.size()) ? m_interests[connectionIndex].selected : m_noEntities;
+}
+
+//-----------------------------------------------------------------------------------
+unsigned int InterestManager::GetNumRelevantEntities(uint16_t connectionIndex) const
+{
+    return (connectionIndex < m_interests.size()) ? m_interests[connectionIndex].numRelevant : 0;
+}
+
+//-----------------------------------------------------------------------------------
+bool InterestManager::HasInterest(uint16_t connectionIndex) const
+{
+    return connectionIndex < m_interests.size() && m_interests[connectionIndex].isActive;
+}
+
+//-----------------------------------------------------------------------------------
+bool InterestManager::IsRelevant(uint16_t connectionIndex, uint16_t entityId) const
+{
+    if (!HasEntity(entityId))
+    {
+        return true;
+    }
+    if (!HasInterest(connectionIndex))
+    {
+        return false;
+    }
+    const Interest& interest = m_interests[connectionIndex];
+    float deltaX = m_entities[entityId].position.x - interest.center.x;
+    float deltaY = m_entities[entityId].position.y - interest.center.y;
+    return (deltaX * deltaX) + (deltaY * deltaY) <= interest.radius * interest.radius;
+}
+
+//-----------------------------------------------------------------------------------
+bool InterestManager::IsSelected(uint16_t connectionIndex, uint16_t entityId) const
+{
+    const std::vector<uint16_t>& selected = GetSelectedEntities(connectionIndex);
+    return std::binary_search(selected.begin(), selected.end(), entityId);
+}
+
+//-----------------------------------------------------------------------------------
+//Counting sort by cell. Counts go in each cell's slot, a running sum turns them into ends, and placing entities walks each end back to its start.
+void InterestManager::RebuildGrid()
+{
+    const unsigned int numCells = m_numCellsX * m_numCellsY;
+    std::fill(m_cellStarts.begin(), m_cellStarts.end(), 0);
+    for (uint16_t entityId : m_activeIds)
+    {
+        const Vector2& position = m_entities[entityId].position;
+        ++m_cellStarts[(GetCellY(position.y) * m_numCellsX) + GetCellX(position.x)];
+    }
+    unsigned int runningTotal = 0;
+    for (unsigned int cell = 0; cell < numCells; ++cell)
+    {
+        runningTotal += m_cellStarts[cell];
+        m_cellStarts[cell] = runningTotal;
+    }
+    m_cellStarts[numCells] = runningTotal;
+    m_cellEntities.resize(m_activeIds.size());
+    for (uint16_t entityId : m_activeIds)
+    {
+        const Vector2& position = m_entities[entityId].position;
+        m_cellEntities[--m_cellStarts[(GetCellY(position.y) * m_numCellsX) + GetCellX(position.x)]] = entityId;
+    }
+}
+
+//-----------------------------------------------------------------------------------
+void InterestManager::UpdateInterest(Interest& interest)
+{
+    interest.selected.clear();
+    interest.numRelevant = 0;
+    if (!interest.isActive || interest.radius <= 0.0f)
+    {
+        return;
+    }
+    m_candidates.clear();
+    const float radiusSquared = interest.radius * interest.radius;
+    const float inverseRadius = 1.0f / interest.radius;
+    const unsigned int minCellX = GetCellX(interest.center.x - interest.radius);
+    const unsigned int maxCellX = GetCellX(interest.center.x + interest.radius);
+    const unsigned int minCellY = GetCellY(interest.center.y - interest.radius);
+    const unsigned int maxCellY = GetCellY(interest.center.y + interest.radius);
+    for (unsigned int cellY = minCellY; cellY <= maxCellY; ++cellY)
+    {
+        for (unsigned int cellX = minCellX; cellX <= maxCellX; ++cellX)
+        {
+            unsigned int cell = (cellY * m_numCellsX) + cellX;
+            for (unsigned int i = m_cellStarts[cell]; i < m_cellStarts[cell + 1]; ++i)
+            {
+                uint16_t entityId = m_cellEntities[i];
+                const Entity& entity = m_entities[entityId];
+                float deltaX = entity.position.x - interest.center.x;
+                float deltaY = entity.position.y - interest.center.y;
+                float distanceSquared = (deltaX * deltaX) + (deltaY * deltaY);
+                if (distanceSquared > radiusSquared)
+                {
+                    continue;
+                }
+                float closeness = 1.0f - (sqrtf(distanceSquared) * inverseRadius);
+                float& accumulator = interest.accumulators[entityId];
+                accumulator += entity.importance * (EDGE_PRIORITY_SCALE + ((1.0f - EDGE_PRIORITY_SCALE) * closeness));
+                Candidate candidate;
+                candidate.priority = accumulator;
+                candidate.entityId = entityId;
+                m_candidates.push_back(candidate);
+            }
+        }
+    }
+
+    interest.numRelevant = (unsigned int)m_candidates.size();
+    if (m_candidates.size() > m_maxEntitiesPerUpdate)
+    {
+        std::nth_element(m_candidates.begin(), m_candidates.begin() + m_maxEntitiesPerUpdate, m_candidates.end());
+        m_candidates.resize(m_maxEntitiesPerUpdate);
+    }
+    for (const Candidate& candidate : m_candidates)
+    {
+        interest.selected.push_back(candidate.entityId);
+        interest.accumulators[candidate.entityId] = 0.0f;
+    }
+    std::sort(interest.selected.begin(), interest.selected.end());
+}
+
+//-----------------------------------------------------------------------------------
+unsigned int InterestManager::GetCellX(float x) const
+{
+    float cell = floorf((x - m_worldMins.x) / m_cellSize);
+    return (unsigned int)MathUtils::Clamp(cell, 0.0f, (float)(m_numCellsX - 1));
+}
+
+//-----------------------------------------------------------------------------------
+unsigned int InterestManager::GetCellY(float y) const
+{
+    float cell = floorf((y - m_worldMins.y) / m_cellSize);
+    return (unsigned int)MathUtils::Clamp(cell, 0.0f, (float)(m_numCellsY - 1));
+}
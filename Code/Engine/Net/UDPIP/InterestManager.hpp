@@ -0,0 +1,104 @@
+#pragma once
+#include "Engine/Math/Vector2.hpp"
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+class NetSession;
+class NetMessage;
+
+typedef void(InterestEntityWriter)(uint16_t entityId, NetMessage& msg); //Appends one entity's update to a message
+
+//-----------------------------------------------------------------------------------
+//Decides which entities each connection hears about, and how often. Every connection has a circular area of interest, and only
+//entities inside it are relevant to that connection. Relevant entities build up priority every update, faster the more important
+//and the closer to the middle of the area they are, and each update only the highest priority few per connection are picked and
+//have their priority reset. Nearby entities end up updating every tick or two and ones at the edge every few ticks, while the cost
+//per connection stays bounded no matter how many entities are in the world.
+//
+//Entities live in a uniform grid over the world bounds, rebuilt each update, so finding what's inside an area only looks at the
+//cells it overlaps. Accumulators are one float per entity per connection with an area, allocated when the area is first set, so
+//updates don't allocate once the scratch lists have grown to size.
+class InterestManager
+{
+public:
+    //CONSTRUCTORS/////////////////////////////////////////////////////////////////////
+    InterestManager();
+
+    //FUNCTIONS/////////////////////////////////////////////////////////////////////
+    void SetWorldBounds(const Vector2& mins, const Vector2& maxs, float cellSize); //Entities outside are treated as sitting in the nearest edge cell
+    void SetEntity(uint16_t entityId, const Vector2& position, float importance = 1.0f); //Adds or moves an entity
+    void RemoveEntity(uint16_t entityId);
+    void SetInterest(uint16_t connectionIndex, const Vector2& center, float radius);
+    void ClearInterest(uint16_t connectionIndex); //Nothing is relevant to a connection without an area
+    void Update(); //Once a tick, picks each connection's entities for this tick
+    void SendUpdates(NetSession& session, uint8_t messageType, InterestEntityWriter* writeEntity, size_t maxEntityBytes); //Packs each connection's picks into as few messages as fit
+
+    //GETTERS/////////////////////////////////////////////////////////////////////
+    const std::vector<uint16_t>& GetSelectedEntities(uint16_t connectionIndex) const; //From the last update, empty for a connection without an area
+    unsigned int GetNumRelevantEntities(uint16_t connectionIndex) const; //Inside the area as of the last update, picked or not
+    bool HasInterest(uint16_t connectionIndex) const;
+    bool IsRelevant(uint16_t connectionIndex, uint16_t entityId) const; //Inside the area now, or not tracked here at all
+    bool IsSelected(uint16_t connectionIndex, uint16_t entityId) const; //Picked in the last update
+    inline unsigned int GetNumEntities() const { return (unsigned int)m_activeIds.size(); };
+    inline bool HasEntity(uint16_t entityId) const { return entityId < MAX_ENTITIES && m_entities[entityId].isActive; };
+
+    //CONSTANTS/////////////////////////////////////////////////////////////////////
+    static const unsigned int MAX_ENTITIES = 16384; //Entity ids have to be below this
+    static const unsigned int MAX_GRID_CELLS = 256 * 256;
+    static const unsigned int DEFAULT_MAX_ENTITIES_PER_UPDATE = 32;
+    static constexpr float EDGE_PRIORITY_SCALE = 0.1f; //How fast an entity at the very edge of an area gains priority, compared to one in the middle
+
+    //MEMBER VARIABLES/////////////////////////////////////////////////////////////////////
+    unsigned int m_maxEntitiesPerUpdate; //Per connection
+
+private:
+    //STRUCTS/////////////////////////////////////////////////////////////////////
+    struct Entity
+    {
+        Entity() : importance(0.0f), activeSlot(0), isActive(false) {};
+
+        Vector2 position;
+        float importance;
+        uint16_t activeSlot; //Where its id sits in m_activeIds
+        bool isActive;
+    };
+
+    struct Interest
+    {
+        Interest() : radius(0.0f), numRelevant(0), isActive(false) {};
+
+        Vector2 center;
+        float radius;
+        unsigned int numRelevant;
+        bool isActive;
+        std::vector<float> accumulators; //By entity id, MAX_ENTITIES long once the area has been set
+        std::vector<uint16_t> selected; //In id order
+    };
+
+    struct Candidate
+    {
+        float priority;
+        uint16_t entityId;
+        inline bool operator<(const Candidate& other) const { return priority != other.priority ? priority > other.priority : entityId < other.entityId; }; //Highest first
+    };
+
+    //PRIVATE FUNCTIONS/////////////////////////////////////////////////////////////////////
+    void RebuildGrid();
+    void UpdateInterest(Interest& interest);
+    unsigned int GetCellX(float x) const;
+    unsigned int GetCellY(float y) const;
+
+    //MEMBER VARIABLES/////////////////////////////////////////////////////////////////////
+    Vector2 m_worldMins;
+    float m_cellSize;
+    unsigned int m_numCellsX;
+    unsigned int m_numCellsY;
+    std::vector<Entity> m_entities; //By entity id
+    std::vector<uint16_t> m_activeIds; //Dense, in no particular order
+    std::vector<unsigned int> m_cellStarts; //Cell c's entities are m_cellEntities[m_cellStarts[c], m_cellStarts[c + 1])
+    std::vector<uint16_t> m_cellEntities;
+    std::vector<Interest> m_interests; //By connection index
+    std::vector<Candidate> m_candidates; //Scratch for one connection's update
+    std::vector<uint16_t> m_noEntities;
+};
@@ -0,0 +1,265 @@
+#include "Engine/Net/UDPIP/InterestManager.hpp"
+#include "Engine/Net/UDPIP/NetTests.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Engine/Time/Time.hpp"
+#include <cstring>
+#include <vector>
+
+//TESTS/////////////////////////////////////////////////////////////////////
+//A synthetic world of wandering entities watched by wandering areas of interest. Everything random comes from the seed.
+
+//-----------------------------------------------------------------------------------
+struct InterestSimSettings
+{
+    unsigned int numEntities;
+    unsigned int numConnections;
+    float worldSize;
+    float radius;
+    float cellSize;
+    unsigned int maxEntitiesPerUpdate;
+    unsigned int numTicks;
+    bool isValidating; //Checks every pick against a brute force scan, which costs far more than the update itself
+    uint32_t seed;
+};
+
+//-----------------------------------------------------------------------------------
+struct InterestSimResults
+{
+    double updateSeconds;
+    double bruteForceSeconds; //Finding what's relevant by checking every entity against every area, for comparison
+    size_t numSelected;
+    size_t numRelevant;
+    unsigned int numRelevantMismatches; //Grid and brute force disagreed on how many entities were in an area
+    unsigned int numSelectedOutside; //Picked but not in the area
+    double nearIntervalTicks; //Average ticks between updates of entities in the inner third of an area
+    double farIntervalTicks; //And the outer third
+    unsigned int maxTicksWaiting; //Longest an entity stayed relevant without being picked
+};
+
+//-----------------------------------------------------------------------------------
+static inline uint32_t NextInterestTestRandom(uint32_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+//-----------------------------------------------------------------------------------
+static inline float GetInterestTestRandomFloat(uint32_t& state, float minValue, float maxValue)
+{
+    return minValue + ((maxValue - minValue) * (float)(NextInterestTestRandom(state) & 0xFFFF) / 65535.0f);
+}
+
+//-----------------------------------------------------------------------------------
+//Bounces off the edges of the world
+static void StepInterestTestPosition(Vector2& position, Vector2& velocity, float worldSize)
+{
+    position += velocity;
+    if (position.x < 0.0f || position.x > worldSize)
+    {
+        velocity.x = -velocity.x;
+        position.x = MathUtils::Clamp(position.x, 0.0f, worldSize);
+    }
+    if (position.y < 0.0f || position.y > worldSize)
+    {
+        velocity.y = -velocity.y;
+        position.y = MathUtils::Clamp(position.y, 0.0f, worldSize);
+    }
+}
+
+//-----------------------------------------------------------------------------------
+static void RunInterestSim(const InterestSimSettings& settings, InterestSimResults& results)
+{
+    memset(&results, 0, sizeof(results));
+    uint32_t random = (settings.seed != 0) ? settings.seed : 1;
+    InterestManager* interest = new InterestManager(); //Accumulators and the id table are too big for the stack
+    interest->SetWorldBounds(Vector2(0.0f), Vector2(settings.worldSize), settings.cellSize);
+    interest->m_maxEntitiesPerUpdate = settings.maxEntitiesPerUpdate;
+
+    std::vector<Vector2> entityPositions(settings.numEntities);
+    std::vector<Vector2> entityVelocities(settings.numEntities);
+    for (unsigned int i = 0; i < settings.numEntities; ++i)
+    {
+        entityPositions[i] = Vector2(GetInterestTestRandomFloat(random, 0.0f, settings.worldSize), GetInterestTestRandomFloat(random, 0.0f, settings.worldSize));
+        entityVelocities[i] = Vector2(GetInterestTestRandomFloat(random, -1.0f, 1.0f), GetInterestTestRandomFloat(random, -1.0f, 1.0f));
+    }
+    std::vector<Vector2> centers(settings.numConnections);
+    std::vector<Vector2> centerVelocities(settings.numConnections);
+    for (unsigned int i = 0; i < settings.numConnections; ++i)
+    {
+        centers[i] = Vector2(GetInterestTestRandomFloat(random, 0.0f, settings.worldSize), GetInterestTestRandomFloat(random, 0.0f, settings.worldSize));
+        centerVelocities[i] = Vector2(GetInterestTestRandomFloat(random, -2.0f, 2.0f), GetInterestTestRandomFloat(random, -2.0f, 2.0f));
+    }
+
+    //Per connection and entity, for validating
+    std::vector<int> lastSelectedTick(settings.isValidating ? settings.numConnections * settings.numEntities : 0, -1);
+    std::vector<unsigned int> ticksWaiting(lastSelectedTick.size(), 0);
+    std::vector<unsigned char> isRelevant(lastSelectedTick.size(), 0);
+    double nearIntervalSum = 0.0;
+    double farIntervalSum = 0.0;
+    unsigned int numNearIntervals = 0;
+    unsigned int numFarIntervals = 0;
+    const float radiusSquared = settings.radius * settings.radius;
+
+    for (unsigned int tick = 0; tick < settings.numTicks; ++tick)
+    {
+        for (unsigned int i = 0; i < settings.numEntities; ++i)
+        {
+            StepInterestTestPosition(entityPositions[i], entityVelocities[i], settings.worldSize);
+            interest->SetEntity((uint16_t)i, entityPositions[i]);
+        }
+        for (unsigned int i = 0; i < settings.numConnections; ++i)
+        {
+            StepInterestTestPosition(centers[i], centerVelocities[i], settings.worldSize);
+            interest->SetInterest((uint16_t)i, centers[i], settings.radius);
+        }
+
+        double startSeconds = GetCurrentTimeSeconds();
+        interest->Update();
+        results.updateSeconds += GetCurrentTimeSeconds() - startSeconds;
+        for (unsigned int conn = 0; conn < settings.numConnections; ++conn)
+        {
+            results.numSelected += interest->GetSelectedEntities((uint16_t)conn).size();
+            results.numRelevant += interest->GetNumRelevantEntities((uint16_t)conn);
+        }
+        if (!settings.isValidating)
+        {
+            continue;
+        }
+
+        startSeconds = GetCurrentTimeSeconds();
+        for (unsigned int conn = 0; conn < settings.numConnections; ++conn)
+        {
+            unsigned int numRelevant = 0;
+            unsigned char* connRelevant = &isRelevant[conn * settings.numEntities];
+            for (unsigned int i = 0; i < settings.numEntities; ++i)
+            {
+                Vector2 offset = entityPositions[i];
+                offset -= centers[conn];
+                connRelevant[i] = (offset.CalculateMagnitudeSquared() <= radiusSquared) ? 1 : 0;
+                numRelevant += connRelevant[i];
+            }
+            results.numRelevantMismatches += (numRelevant != interest->GetNumRelevantEntities((uint16_t)conn)) ? 1 : 0;
+        }
+        results.bruteForceSeconds += GetCurrentTimeSeconds() - startSeconds;
+
+        for (unsigned int conn = 0; conn < settings.numConnections; ++conn)
+        {
+            size_t base = conn * settings.numEntities;
+            for (uint16_t entityId : interest->GetSelectedEntities((uint16_t)conn))
+            {
+                size_t slot = base + entityId;
+                results.numSelectedOutside += isRelevant[slot] ? 0 : 1;
+                if (lastSelectedTick[slot] >= 0 && ticksWaiting[slot] + 1 == tick - (unsigned int)lastSelectedTick[slot])
+                {
+                    //Relevant the whole time since it was last picked, so this is a clean interval
+                    Vector2 offset = entityPositions[entityId];
+                    offset -= centers[conn];
+                    float distanceFraction = offset.CalculateMagnitude() / settings.radius;
+                    if (distanceFraction < 1.0f / 3.0f)
+                    {
+                        nearIntervalSum += (double)(tick - lastSelectedTick[slot]);
+                        ++numNearIntervals;
+                    }
+                    else if (distanceFraction > 2.0f / 3.0f)
+                    {
+                        farIntervalSum += (double)(tick - lastSelectedTick[slot]);
+                        ++numFarIntervals;
+                    }
+                }
+                lastSelectedTick[slot] = (int)tick;
+                isRelevant[slot] = 2; //Picked, so not waiting
+            }
+            for (unsigned int i = 0; i < settings.numEntities; ++i)
+            {
+                size_t slot = base + i;
+                if (isRelevant[slot] == 1)
+                {
+                    ++ticksWaiting[slot];
+                    results.maxTicksWaiting = Max<unsigned int>(results.maxTicksWaiting, ticksWaiting[slot]);
+                }
+                else
+                {
+                    ticksWaiting[slot] = 0;
+                    lastSelectedTick[slot] = (isRelevant[slot] == 2) ? lastSelectedTick[slot] : -1;
+                }
+            }
+        }
+    }
+    results.nearIntervalTicks = nearIntervalSum / (double)Max<unsigned int>(numNearIntervals, 1);
+    results.farIntervalTicks = farIntervalSum / (double)Max<unsigned int>(numFarIntervals, 1);
+    delete interest;
+}
+
+//-----------------------------------------------------------------------------------
+//Randomized worlds, each checked against brute force: the grid finds exactly the entities in each area, only those get picked,
+//nearby entities update more often than distant ones, and nothing relevant gets starved.
+bool RunInterestTest(int numRuns, uint32_t seed, NetTestPrintCallback* print)
+{
+    const unsigned int MAX_TICKS_WAITING = 100;
+    int numPassed = 0;
+    for (int run = 0; run < numRuns; ++run)
+    {
+        uint32_t random = seed + (uint32_t)run * 7919u;
+        NextInterestTestRandom(random);
+        InterestSimSettings settings;
+        settings.numEntities = 500 + (NextInterestTestRandom(random) % 1500);
+        settings.numConnections = 1 + (NextInterestTestRandom(random) % 16);
+        settings.worldSize = GetInterestTestRandomFloat(random, 200.0f, 1000.0f);
+        settings.radius = GetInterestTestRandomFloat(random, 30.0f, 150.0f);
+        settings.cellSize = GetInterestTestRandomFloat(random, 10.0f, 80.0f);
+        settings.maxEntitiesPerUpdate = 16 + (NextInterestTestRandom(random) % 48);
+        settings.numTicks = 300;
+        settings.isValidating = true;
+        settings.seed = random;
+
+        InterestSimResults results;
+        RunInterestSim(settings, results);
+        bool passed = results.numRelevantMismatches == 0 && results.numSelectedOutside == 0 && results.maxTicksWaiting <= MAX_TICKS_WAITING
+            && (results.maxTicksWaiting == 0 || results.nearIntervalTicks < results.farIntervalTicks); //With no contention everything goes every tick
+        numPassed += passed ? 1 : 0;
+        print(Stringf("  %s: %4u entities, %2u areas of r%3.0f in %4.0f, %2u per update -> %u mismatches, %u outside, every %.1f ticks near / %.1f far, %u max wait",
+            passed ? "PASS" : "FAIL", settings.numEntities, settings.numConnections, settings.radius, settings.worldSize, settings.maxEntitiesPerUpdate,
+            results.numRelevantMismatches, results.numSelectedOutside, results.nearIntervalTicks, results.farIntervalTicks, results.maxTicksWaiting), passed ? RGBA::GREEN : RGBA::RED);
+    }
+    print(Stringf("interesttest: %i/%i runs passed", numPassed, numRuns), (numPassed == numRuns) ? RGBA::GREEN : RGBA::RED);
+    return numPassed == numRuns;
+}
+
+//-----------------------------------------------------------------------------------
+//Thousands of entities and a full server's worth of areas. Compares entity updates queued per tick against sending everything to everyone.
+void RunInterestBenchmark(unsigned int numEntities, unsigned int numConnections, float radius, unsigned int maxEntitiesPerUpdate, NetTestPrintCallback* print)
+{
+    const unsigned int ENTITY_UPDATE_BYTES = 16; //Rough size of a quantized position, rotation and a few flags
+    InterestSimSettings settings;
+    settings.numEntities = numEntities;
+    settings.numConnections = numConnections;
+    settings.radius = radius;
+    settings.maxEntitiesPerUpdate = maxEntitiesPerUpdate;
+    settings.worldSize = 2000.0f;
+    settings.cellSize = 50.0f;
+    settings.numTicks = 600;
+    settings.isValidating = false;
+    settings.seed = 12345;
+
+    InterestSimResults results;
+    RunInterestSim(settings, results);
+    settings.numTicks = 30;
+    settings.isValidating = true;
+    InterestSimResults bruteForceResults;
+    RunInterestSim(settings, bruteForceResults);
+
+    double ticks = 600.0;
+    double broadcastPerTick = (double)settings.numEntities * (double)settings.numConnections;
+    double selectedPerTick = (double)results.numSelected / ticks;
+    print(Stringf("interestbench: %u entities, %u connections, radius %.0f in a %.0f world, %u per update",
+        settings.numEntities, settings.numConnections, settings.radius, settings.worldSize, settings.maxEntitiesPerUpdate), RGBA::CORNFLOWER_BLUE);
+    print(Stringf("  update: %.3fms a tick, brute force relevancy alone %.3fms a tick",
+        results.updateSeconds * 1000.0 / ticks, bruteForceResults.bruteForceSeconds * 1000.0 / (double)settings.numTicks), RGBA::GREEN);
+    print(Stringf("  entity updates a tick: %.0f relevant, %.0f sent, against %.0f broadcasting everything (%.2f%%)",
+        (double)results.numRelevant / ticks, selectedPerTick, broadcastPerTick, 100.0 * selectedPerTick / broadcastPerTick), RGBA::GREEN);
+    print(Stringf("  at %uB an entity and 60 ticks a second: %.1f KB/s a connection, against %.1f KB/s",
+        ENTITY_UPDATE_BYTES, selectedPerTick * ENTITY_UPDATE_BYTES * 60.0 / (1024.0 * settings.numConnections), (double)settings.numEntities * ENTITY_UPDATE_BYTES * 60.0 / 1024.0), RGBA::GREEN);
+}
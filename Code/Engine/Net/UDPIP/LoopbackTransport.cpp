@@ -0,0 +1,39 @@
+#include "Engine/Net/UDPIP/LoopbackTransport.hpp"
+#include "Engine/Net/UDPIP/NetSimulator.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include <cstdlib>
+
+//-----------------------------------------------------------------------------------
+void LoopbackTransport::Bind(const char* address, const char* portNumber)
+{
+    UNUSED(address);
+    ASSERT_OR_DIE(!m_isBound, "Attempted to bind a loopback transport twice");
+    m_address = m_simulator->AddEndpoint((uint16_t)atoi(portNumber));
+    m_isBound = true;
+}
+
+//-----------------------------------------------------------------------------------
+void LoopbackTransport::Unbind()
+{
+    m_simulator->RemoveEndpoint(m_address);
+    m_isBound = false;
+}
+
+//-----------------------------------------------------------------------------------
+size_t LoopbackTransport::SendBatch(const UDPDatagram* datagrams, size_t numDatagrams)
+{
+    return m_isBound ? m_simulator->Send(m_address, datagrams, numDatagrams) : 0;
+}
+
+//-----------------------------------------------------------------------------------
+size_t LoopbackTransport::ReceiveBatch(UDPDatagram* outDatagrams, size_t maxDatagrams)
+{
+    return m_isBound ? m_simulator->Receive(m_address, outDatagrams, maxDatagrams) : 0;
+}
+
+//-----------------------------------------------------------------------------------
+bool LoopbackTransport::WaitForData(unsigned int timeoutMilliseconds)
+{
+    UNUSED(timeoutMilliseconds);
+    return m_isBound && m_simulator->HasArrived(m_address);
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include "Engine/Net/UDPIP/UDPTransport.hpp"
+
+class NetSimulator;
+
+//-----------------------------------------------------------------------------------
+//Stands in for a UDPSocket, with a NetSimulator as the network. Hand one to PacketChannel::SetTransport and several sessions can
+//talk to each other in one process without touching a real socket. The simulator has to outlive the transport.
+class LoopbackTransport : public UDPTransport
+{
+public:
+    LoopbackTransport(NetSimulator* simulator) : m_simulator(simulator), m_isBound(false) {};
+    virtual ~LoopbackTransport() { if (IsBound()) Unbind(); };
+    virtual void Bind(const char* address, const char* portNumber) override; //The simulator makes up the host, only the port is used
+    virtual void Unbind() override;
+    virtual bool IsBound() const override { return m_isBound; };
+    virtual sockaddr_in GetAddress() const override { return m_address; };
+    virtual size_t SendBatch(const UDPDatagram* datagrams, size_t numDatagrams) override;
+    virtual size_t ReceiveBatch(UDPDatagram* outDatagrams, size_t maxDatagrams) override;
+    virtual bool WaitForData(unsigned int timeoutMilliseconds) override; //Never blocks, simulated time doesn't pass while waiting
+
+    NetSimulator* m_simulator;
+    sockaddr_in m_address;
+    bool m_isBound;
+};
@@ -1,17 +1,30 @@
 #include "Engine/Net/UDPIP/NetConnection.hpp"
 #include "Engine/Net/UDPIP/NetSession.hpp"
 #include "Engine/Net/UDPIP/NetMessage.hpp"
-#include "Engine/Net/NetSystem.hpp"
-#include "Engine/Time/Time.hpp"
+#include "Engine/Net/UDPIP/NetMessagePool.hpp"
+#include "Engine/DataStructures/InPlaceLinkedList.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include <cmath>
 
 //-----------------------------------------------------------------------------------
-NetConnection::NetConnection(uint8_t index, const char* guid, const sockaddr_in& address, NetSession* session)
+NetConnection::NetConnection(uint16_t index, const char* guid, const sockaddr_in& address, NetSession* session)
     : m_index(index)
+    , m_activeSlot(0)
     , m_address(address)
     , m_session(session)
     , m_state(State::UNCONFIRMED)
-    , m_lastSentTimeMs(GetCurrentTimeMilliseconds())
-    , m_lastRecievedTimeMs(GetCurrentTimeMilliseconds())
+    , m_lastSentTimeMs(session->GetNetTimeMilliseconds())
+    , m_lastRecievedTimeMs(session->GetNetTimeMilliseconds())
+    , m_smoothedRoundTripTimeMs(-1.0f)
+    , m_roundTripVarianceMs(0.0f)
+    , m_retransmitTimeoutMs(INITIAL_RETRANSMIT_TIMEOUT_MS)
+    , m_numStaleUnreliablesDropped(0)
+    , m_ackedSnapshotId(INVALID_SNAPSHOT_ID)
+    , m_compressionId(0)
+    , m_numBytesBeforeCompression(0)
+    , m_numBytesAfterCompression(0)
+    , m_numUnsentReliables(0)
+    , m_highestConfirmedSentAck(INVALID_PACKET_ACK)
     , m_previousHighestReceivedAcksBitfield(0)
     , m_highestReceivedAck(INVALID_PACKET_ACK)
     , m_nextSentAck(0)
@@ -21,109 +34,261 @@ NetConnection::NetConnection(uint8_t index, const char* guid, const sockaddr_in&
     , m_lastSentReliableId(0)
     , m_nextSentSequenceId(13)
     , m_nextExpectedReceivedSequenceId(13)
+    , m_nextLargeMessageId(0)
+    , m_oldestUnfinishedLargeMessageId(0)
+    , m_unsentInOrderReliables(nullptr)
+    , m_sentReliables(nullptr)
+    , m_unsentFragments(nullptr)
+    , m_queuedSnapshot(nullptr)
+    , m_queuedSnapshotId(INVALID_SNAPSHOT_ID)
 {
-    memcpy(m_guid, guid, MAX_GUID_LENGTH);
+    strncpy(m_guid, guid, MAX_GUID_LENGTH - 1); //Guids come in as literals too, so don't read past them
+    m_guid[MAX_GUID_LENGTH - 1] = '\0';
+    memset(m_inOrderRing, 0, sizeof(m_inOrderRing));
+    memset(m_unreliables, 0, sizeof(m_unreliables));
+    memset(m_unsentReliables, 0, sizeof(m_unsentReliables));
+    memset(m_priorityAccumulators, 0, sizeof(m_priorityAccumulators));
+    memset(m_numUnsentInOrderReliables, 0, sizeof(m_numUnsentInOrderReliables));
 }
 
 //-----------------------------------------------------------------------------------
 NetConnection::~NetConnection()
 {
-    for (NetMessage* msg : m_unreliables)
+    for (unsigned int priorityClass = 0; priorityClass < NUM_PRIORITY_CLASSES; ++priorityClass)
     {
-        delete msg;
+        FreeAllMessages(m_unreliables[priorityClass]);
+        FreeAllMessages(m_unsentReliables[priorityClass]);
     }
-    while(!m_unsentReliables.empty())
+    FreeAllMessages(m_unsentInOrderReliables);
+    FreeAllMessages(m_sentReliables);
+    FreeAllMessages(m_unsentFragments);
+    for (PooledNetMessage* msg : m_inOrderRing)
     {
-        NetMessage* msg = m_unsentReliables.front();
-        delete msg;
-        m_unsentReliables.pop();
-    }
-    while (!m_sentReliables.empty())
-    {
-        NetMessage* msg = m_sentReliables.front();
-        delete msg;
-        m_sentReliables.pop();
+        if (msg != nullptr)
+        {
+            m_session->m_messagePool.Free(msg);
+        }
     }
-    for (NetMessage* msg : m_outOfOrderReceivedSequencedMessages)
+    for (IncomingLargeMessage& incoming : m_incomingLargeMessages)
     {
-        delete msg;
+        ReleaseIncomingLargeMessage(incoming);
     }
 }
 
 //-----------------------------------------------------------------------------------
+//Encodes the message into a pooled block sized to its payload, so queueing it never hits the heap once the pool has warmed up
 void NetConnection::SendMessage(NetMessage& msg)
 {
-    NetMessage* nextMsg = new NetMessage(msg);
-    if (nextMsg->IsInOrder())
+    PooledNetMessage* nextMsg = m_session->m_messagePool.Alloc(msg);
+    const NetMessageDefinition* definition = msg.GetDefinition(*m_session);
+    unsigned int priorityClass = GetPriorityClass(definition);
+    nextMsg->m_priority = (uint8_t)priorityClass;
+    bool isInOrder = definition->HasOptionFlag(NetMessage::Option::INORDER);
+    if (isInOrder)
     {
         nextMsg->m_sequenceId = m_nextSentSequenceId;
         m_nextSentSequenceId++;
     }
-    if (nextMsg->IsReliable()) 
+    if (definition->HasOptionFlag(NetMessage::Option::RELIABLE) && isInOrder)
     {
-        m_unsentReliables.push(nextMsg);
+        AddInPlace(m_unsentInOrderReliables, nextMsg);
+        ++m_numUnsentInOrderReliables[priorityClass];
+        ++m_numUnsentReliables;
+    }
+    else if (definition->HasOptionFlag(NetMessage::Option::RELIABLE))
+    {
+        AddInPlace(m_unsentReliables[priorityClass], nextMsg);
+        ++m_numUnsentReliables;
     }
     else 
     {
-        m_unreliables.push_back(nextMsg);
+        //Unreliables can wait a few ticks for send budget, so stamp when they were queued to know when they've gone stale
+        nextMsg->m_lastSentTimestampMs = (uint32_t)m_session->GetNetTimeMilliseconds();
+        AddInPlace(m_unreliables[priorityClass], nextMsg);
+    }
+}
+
+//-----------------------------------------------------------------------------------
+//Queued like any unreliable, but remembered so the ack bundle of the packet it goes out in can record which snapshot that was.
+//Only the newest snapshot is worth sending, so one that's still waiting is thrown away.
+void NetConnection::SendSnapshot(NetMessage& msg, uint16_t snapshotId)
+{
+    if (m_queuedSnapshot != nullptr)
+    {
+        RemoveInPlace(m_unreliables[m_queuedSnapshot->m_priority], m_queuedSnapshot);
+        m_session->m_messagePool.Free(m_queuedSnapshot);
     }
+    PooledNetMessage* nextMsg = m_session->m_messagePool.Alloc(msg);
+    nextMsg->m_priority = (uint8_t)GetPriorityClass(msg.GetDefinition(*m_session));
+    nextMsg->m_lastSentTimestampMs = (uint32_t)m_session->GetNetTimeMilliseconds();
+    AddInPlace(m_unreliables[nextMsg->m_priority], nextMsg);
+    m_queuedSnapshot = nextMsg;
+    m_queuedSnapshotId = snapshotId;
+}
+
+//-----------------------------------------------------------------------------------
+//Every fragment is queued up front, copied into the message pool, so the caller's data can go away as soon as this returns.
+//[uint16 large message id][uint8 type][uint16 fragment index][uint32 total size][payload]
+void NetConnection::SendLargeMessage(uint8_t type, const void* data, size_t numBytes)
+{
+    ASSERT_OR_DIE(m_session->m_netMessageDefinitions[type].largeCallbackFunction != nullptr, "Large messages have to be registered with RegisterLargeMessage");
+    ASSERT_OR_DIE(numBytes <= MAX_LARGE_MESSAGE_BYTES, "Attempted to send a message larger than MAX_LARGE_MESSAGE_BYTES");
+    uint16_t largeMessageId = m_nextLargeMessageId++;
+    uint16_t numFragments = (uint16_t)Max<size_t>((numBytes + FRAGMENT_PAYLOAD_BYTES - 1) / FRAGMENT_PAYLOAD_BYTES, 1);
+    const byte* source = (const byte*)data;
+    NetMessage fragment(NetMessage::FRAGMENT);
+    for (uint16_t fragmentIndex = 0; fragmentIndex < numFragments; ++fragmentIndex)
+    {
+        size_t offset = fragmentIndex * FRAGMENT_PAYLOAD_BYTES;
+        fragment.SetReadableBytes(0);
+        fragment.Write<uint16_t>(largeMessageId);
+        fragment.Write<uint8_t>(type);
+        fragment.Write<uint16_t>(fragmentIndex);
+        fragment.Write<uint32_t>((uint32_t)numBytes);
+        fragment.WriteBytes(source + offset, Min<size_t>(numBytes - offset, (size_t)FRAGMENT_PAYLOAD_BYTES));
+        AddInPlace(m_unsentFragments, m_session->m_messagePool.Alloc(fragment));
+    }
+    m_numUnsentReliables += numFragments;
 }
 
 //-----------------------------------------------------------------------------------
 void NetConnection::ConstructAndSendPacket()
 {
-    //Initialize the packet
     NetPacket packet(m_session->GetMyConnectionIndex());
+    ConstructPacket(packet);
+    m_session->m_packetChannel.SendTo(m_address, packet.m_buffer, packet.GetTotalReadableBytes());
+}
+
+//-----------------------------------------------------------------------------------
+//Fills in this tick's packet without sending it, so the session can send every connection's packet in one batch
+void NetConnection::ConstructPacket(NetPacket& packet)
+{
+    //Initialize the packet
+    packet.Reset(m_session->GetMyConnectionIndex());
     packet.m_header.ack = m_nextSentAck++;
     packet.m_header.highestReceivedAck = m_highestReceivedAck;
     packet.m_header.previousReceivedAcksBitfield = m_previousHighestReceivedAcksBitfield;
 
-    //Prepare the packet body
+    //Prepare the packet body. The packet keeps the message count in its header up to date as messages go in.
     packet.WriteHeader();
-    // Reserve space
-    uint8_t* msgsWritten = packet.GetMessageCountBookmark();
+
+    //Messages only get what the send rate allows this tick. The header always goes out so acks keep flowing both ways.
+    double nowMs = m_session->GetNetTimeMilliseconds();
+    m_sendRate.SetMaxBytesPerSecond(m_session->m_bandwidthBudgetBytesPerSecond);
+    m_sendRate.Update(nowMs, GetRoundTripTimeMs());
+    int budgetBytes = m_sendRate.GetSendBudgetBytes(nowMs) - (int)SendRateController::UDP_IP_HEADER_BYTES;
+    if (m_session->m_isCongestionControlEnabled)
+    {
+        packet.LimitSize((size_t)Max<int>(budgetBytes, 0));
+    }
+    //With compression on, the budget and the MTU limit the compressed size, so the packet takes messages for as long as they'd fit once it's compressed
+    bool isCompressed = m_compressionId != 0 && m_compressionId == m_session->m_packetCompressor.GetId();
+    if (isCompressed)
+    {
+        packet.CompressWith(m_session->m_packetCompressor);
+    }
 
     AckBundle* bundle = CreateBundle(packet.m_header.ack);
 
-    uint8_t sent = 0;
-    sent += AttachOldReliables(packet, bundle);
+    //Resends first since something is already waiting on them, then new traffic by priority class
+    AttachOldReliables(packet, bundle);
+    AttachByPriority(packet, bundle);
 
-    sent += AttachUnsentReliables(packet, bundle);
+    //Compressing last means the send rate is charged for what actually goes out
+    m_session->RecordOutgoingPacket(packet);
+    m_numBytesBeforeCompression += packet.GetTotalReadableBytes();
+    if (isCompressed)
+    {
+        packet.Compress(m_session->m_packetCompressor);
+    }
+    m_numBytesAfterCompression += packet.GetTotalReadableBytes();
+    m_sendRate.OnPacketSent(packet.GetTotalReadableBytes());
+    m_telemetry.OnPacketSent(packet.GetTotalReadableBytes());
+    m_telemetry.Update(nowMs, m_numUnsentReliables, GetLiveReliableRange(), GetRoundTripTimeMs(), m_sendRate.GetLossRate());
+    m_lastSentTimeMs = nowMs;
+}
 
-    sent += AttachUnreliables(packet);
-    for (NetMessage* msg : m_unreliables)
+//-----------------------------------------------------------------------------------
+//Every class with something waiting gains its weight in priority each packet, and the classes take turns in order of that priority.
+//A turn is up to the class's weight in PRIORITY_QUANTUM_BYTES, at least one message, and resets its priority. Whatever room is left
+//after every class has had a turn goes to them in the same order. When the budget runs out before a class's turn it keeps gaining
+//priority until it goes first, so bulk traffic can't starve, and a class that only ever has a little waiting, like input, goes out
+//almost as soon as it's queued.
+uint8_t NetConnection::AttachByPriority(NetPacket& packet, AckBundle* ackBundle)
+{
+    unsigned int order[NUM_PRIORITY_CLASSES];
+    unsigned int numWaiting = 0;
+    for (unsigned int priorityClass = NUM_PRIORITY_CLASSES; priorityClass-- > 0;)
     {
-        delete msg;
+        if (!HasUnsentMessages(priorityClass))
+        {
+            m_priorityAccumulators[priorityClass] = 0;
+            continue;
+        }
+        m_priorityAccumulators[priorityClass] += GetPriorityWeight(priorityClass);
+        //Highest priority first. Classes come in from the top, so ties go to the higher class.
+        unsigned int slot = numWaiting++;
+        while (slot > 0 && m_priorityAccumulators[order[slot - 1]] < m_priorityAccumulators[priorityClass])
+        {
+            order[slot] = order[slot - 1];
+            --slot;
+        }
+        order[slot] = priorityClass;
     }
-    m_unreliables.clear();
 
-    *msgsWritten = sent;
-    m_lastSentTimeMs = GetCurrentTimeMilliseconds();
+    uint8_t numMessagesAdded = 0;
+    for (unsigned int i = 0; i < numWaiting; ++i)
+    {
+        size_t turnBytes = GetPriorityWeight(order[i]) * PRIORITY_QUANTUM_BYTES;
+        uint8_t numAdded = AttachPriorityClass(packet, ackBundle, order[i], packet.GetTotalReadableBytes() + turnBytes);
+        m_priorityAccumulators[order[i]] = (numAdded > 0) ? 0 : m_priorityAccumulators[order[i]];
+        numMessagesAdded += numAdded;
+    }
+    for (unsigned int i = 0; i < numWaiting; ++i)
+    {
+        numMessagesAdded += AttachPriorityClass(packet, ackBundle, order[i], SIZE_MAX);
+    }
+    return numMessagesAdded;
+}
 
-    m_session->m_packetChannel.SendTo(m_address, packet.m_buffer, packet.GetTotalReadableBytes());
+//-----------------------------------------------------------------------------------
+//Within a class, in-order reliables first, then other reliables, then unreliables, then for the lowest class large message fragments
+uint8_t NetConnection::AttachPriorityClass(NetPacket& packet, AckBundle* ackBundle, unsigned int priorityClass, size_t stopAtBytes)
+{
+    uint8_t numMessagesAdded = 0;
+    numMessagesAdded += AttachUnsentInOrderReliables(packet, ackBundle, priorityClass, stopAtBytes);
+    numMessagesAdded += AttachUnsentReliables(packet, ackBundle, m_unsentReliables[priorityClass], stopAtBytes);
+    numMessagesAdded += AttachUnreliables(packet, ackBundle, m_unreliables[priorityClass], stopAtBytes);
+    if (priorityClass == 0)
+    {
+        numMessagesAdded += AttachUnsentFragments(packet, ackBundle, stopAtBytes);
+    }
+    return numMessagesAdded;
 }
 
 //-----------------------------------------------------------------------------------
 uint8_t NetConnection::AttachOldReliables(NetPacket& p, AckBundle* ackBundle)
 {
     uint8_t numMessagesAdded = 0;
-    while (!m_sentReliables.empty())
+    while (m_sentReliables != nullptr && ackBundle->reliableCount < MAX_RELIABLES_PER_PACKET)
     {
-        NetMessage* msg = m_sentReliables.front();
+        PooledNetMessage* msg = GetFirst(m_sentReliables);
         if (IsReliableConfirmed(msg->m_reliableId))
         {
-            m_sentReliables.pop();
-            delete msg;
+            RemoveInPlace(m_sentReliables, msg);
+            m_session->m_messagePool.Free(msg);
             continue;
         }
         if (IsOld(msg) && p.CanWrite(msg))
         {
-            m_sentReliables.pop();
-            msg->m_lastSentTimestampMs = (uint32_t)GetCurrentTimeMilliseconds();
+            //Resend and rotate to the back of the queue
+            RemoveInPlace(m_sentReliables, msg);
+            msg->m_lastSentTimestampMs = (uint32_t)m_session->GetNetTimeMilliseconds();
             p.WriteMessage(msg);
             ++numMessagesAdded;
             ackBundle->AddReliable(msg->m_reliableId);
-            m_sentReliables.push(msg);
+            AddInPlace(m_sentReliables, msg);
+            m_telemetry.OnResend();
         }
         else
         {
@@ -134,21 +299,23 @@ uint8_t NetConnection::AttachOldReliables(NetPacket& p, AckBundle* ackBundle)
 }
 
 //-----------------------------------------------------------------------------------
-uint8_t NetConnection::AttachUnsentReliables(NetPacket& packet, AckBundle* ackBundle)
+uint8_t NetConnection::AttachUnsentReliables(NetPacket& packet, AckBundle* ackBundle, PooledNetMessage*& queue, size_t stopAtBytes, uint8_t maxMessages)
 {
     uint8_t numMessagesAdded = 0;
-    while (!m_unsentReliables.empty() && CanAttachNewReliable())
+    while (queue != nullptr && numMessagesAdded < maxMessages && CanAttachNewReliable() && ackBundle->reliableCount < MAX_RELIABLES_PER_PACKET && packet.GetTotalReadableBytes() < stopAtBytes)
     {
-        NetMessage* msg = m_unsentReliables.front();
+        PooledNetMessage* msg = GetFirst(queue);
+        msg->m_reliableId = m_nextSentReliableId; //Before CanWrite so a compression trial sees the message as it'll be sent
         if (packet.CanWrite(msg))
         {
             msg->m_reliableId = GetNextReliableID();
-            msg->m_lastSentTimestampMs = (uint32_t)GetCurrentTimeMilliseconds();
+            msg->m_lastSentTimestampMs = (uint32_t)m_session->GetNetTimeMilliseconds();
             packet.WriteMessage(msg);
             ++numMessagesAdded;
             ackBundle->AddReliable(msg->m_reliableId);
-            m_unsentReliables.pop();
-            m_sentReliables.push(msg);
+            RemoveInPlace(queue, msg);
+            AddInPlace(m_sentReliables, msg);
+            --m_numUnsentReliables;
         }
         else
         {
@@ -159,43 +326,214 @@ uint8_t NetConnection::AttachUnsentReliables(NetPacket& packet, AckBundle* ackBu
 }
 
 //-----------------------------------------------------------------------------------
-uint8_t NetConnection::AttachUnreliables(NetPacket& p)
+//In-order reliables share one sequence, so the receiver holds back anything that arrives ahead of a gap. They're sent in that order
+//as one queue, whose class is the highest it holds: lower class messages ahead of an urgent one go out with it instead of making it wait.
+uint8_t NetConnection::AttachUnsentInOrderReliables(NetPacket& packet, AckBundle* ackBundle, unsigned int priorityClass, size_t stopAtBytes)
 {
-    return (uint8_t)p.WriteMessages(m_unreliables.data(), m_unreliables.size());
+    uint8_t numMessagesAdded = 0;
+    while (m_unsentInOrderReliables != nullptr && GetInOrderPriorityClass() == priorityClass)
+    {
+        unsigned int messageClass = GetFirst(m_unsentInOrderReliables)->m_priority;
+        if (AttachUnsentReliables(packet, ackBundle, m_unsentInOrderReliables, stopAtBytes, 1) == 0)
+        {
+            break;
+        }
+        --m_numUnsentInOrderReliables[messageClass];
+        ++numMessagesAdded;
+    }
+    return numMessagesAdded;
 }
 
 //-----------------------------------------------------------------------------------
+//Unreliables go out oldest first, and anything that doesn't fit waits for a later tick until it's too stale to be worth sending.
+//Smaller messages further down can still fill the space a big one couldn't use.
+uint8_t NetConnection::AttachUnreliables(NetPacket& p, AckBundle* ackBundle, PooledNetMessage*& queue, size_t stopAtBytes)
+{
+    uint8_t numMessagesAdded = 0;
+    uint32_t nowMs = (uint32_t)m_session->GetNetTimeMilliseconds();
+    PooledNetMessage* waiting = nullptr;
+    while (queue != nullptr && p.GetTotalReadableBytes() < stopAtBytes)
+    {
+        PooledNetMessage* msg = GetFirst(queue);
+        RemoveInPlace(queue, msg);
+        if (nowMs - msg->m_lastSentTimestampMs > STALE_UNRELIABLE_AGE_MS)
+        {
+            ++m_numStaleUnreliablesDropped;
+            m_queuedSnapshot = (msg == m_queuedSnapshot) ? nullptr : m_queuedSnapshot;
+            m_session->m_messagePool.Free(msg);
+        }
+        else if (p.CanWrite(msg))
+        {
+            p.WriteMessage(msg);
+            ++numMessagesAdded;
+            if (msg == m_queuedSnapshot)
+            {
+                ackBundle->snapshotId = m_queuedSnapshotId;
+                m_queuedSnapshot = nullptr;
+            }
+            m_session->m_messagePool.Free(msg);
+        }
+        else
+        {
+            AddInPlace(waiting, msg);
+        }
+    }
+    //What was skipped is older than what the turn didn't get to
+    AppendListInPlace(waiting, queue);
+    queue = waiting;
+    return numMessagesAdded;
+}
+
+//-----------------------------------------------------------------------------------
+//Fragments get new reliable ids in queue order, so a large message's last fragment has the highest id of any of its fragments.
+//A fragment of a large message that isn't one of the oldest MAX_CONCURRENT_LARGE_MESSAGES unfinished ones waits, which is what lets the receiver get by with that many slots.
+uint8_t NetConnection::AttachUnsentFragments(NetPacket& packet, AckBundle* ackBundle, size_t stopAtBytes)
+{
+    RetireFinishedLargeMessages();
+    uint8_t numMessagesAdded = 0;
+    while (m_unsentFragments != nullptr && CanAttachNewReliable() && ackBundle->reliableCount < MAX_RELIABLES_PER_PACKET && packet.GetTotalReadableBytes() < stopAtBytes)
+    {
+        PooledNetMessage* msg = GetFirst(m_unsentFragments);
+        const byte* header = msg->GetPayload();
+        uint16_t largeMessageId = (uint16_t)((header[0] << 8) | header[1]);
+        msg->m_reliableId = m_nextSentReliableId;
+        if ((uint16_t)(largeMessageId - m_oldestUnfinishedLargeMessageId) >= MAX_CONCURRENT_LARGE_MESSAGES || !packet.CanWrite(msg))
+        {
+            break;
+        }
+        msg->m_reliableId = GetNextReliableID();
+        msg->m_lastSentTimestampMs = (uint32_t)m_session->GetNetTimeMilliseconds();
+        packet.WriteMessage(msg);
+        ++numMessagesAdded;
+        ackBundle->AddReliable(msg->m_reliableId);
+        RemoveInPlace(m_unsentFragments, msg);
+        AddInPlace(m_sentReliables, msg);
+        --m_numUnsentReliables;
+
+        uint16_t fragmentIndex = (uint16_t)((header[3] << 8) | header[4]);
+        uint32_t totalSize = ((uint32_t)header[5] << 24) | ((uint32_t)header[6] << 16) | ((uint32_t)header[7] << 8) | (uint32_t)header[8];
+        uint16_t numFragments = (uint16_t)Max<size_t>((totalSize + FRAGMENT_PAYLOAD_BYTES - 1) / FRAGMENT_PAYLOAD_BYTES, 1);
+        if (fragmentIndex == numFragments - 1)
+        {
+            OutgoingLargeMessage& outgoing = m_outgoingLargeMessages[largeMessageId % MAX_CONCURRENT_LARGE_MESSAGES];
+            outgoing.lastReliableId = msg->m_reliableId;
+            outgoing.isFullySent = true;
+        }
+    }
+    return numMessagesAdded;
+}
+
+//-----------------------------------------------------------------------------------
+//A large message is finished once the oldest unconfirmed reliable is past its last fragment. That can lag a little behind its own fragments
+//being confirmed when an older reliable is still outstanding, which only delays the next large message, never lets one through early.
+void NetConnection::RetireFinishedLargeMessages()
+{
+    while (m_oldestUnfinishedLargeMessageId != m_nextLargeMessageId)
+    {
+        OutgoingLargeMessage& oldest = m_outgoingLargeMessages[m_oldestUnfinishedLargeMessageId % MAX_CONCURRENT_LARGE_MESSAGES];
+        uint16_t distanceAhead = oldest.lastReliableId - m_oldestUnconfirmedReliableId;
+        if (!oldest.isFullySent || distanceAhead < 0x8000)
+        {
+            return;
+        }
+        oldest.isFullySent = false;
+        ++m_oldestUnfinishedLargeMessageId;
+    }
+}
+
+//-----------------------------------------------------------------------------------
+bool NetConnection::HasUnsentMessages(unsigned int priorityClass) const
+{
+    return (m_unsentInOrderReliables != nullptr && GetInOrderPriorityClass() == priorityClass)
+        || m_unsentReliables[priorityClass] != nullptr
+        || m_unreliables[priorityClass] != nullptr
+        || (priorityClass == 0 && m_unsentFragments != nullptr);
+}
+
+//-----------------------------------------------------------------------------------
+unsigned int NetConnection::GetInOrderPriorityClass() const
+{
+    unsigned int priorityClass = NUM_PRIORITY_CLASSES - 1;
+    while (priorityClass > 0 && m_numUnsentInOrderReliables[priorityClass] == 0)
+    {
+        --priorityClass;
+    }
+    return priorityClass;
+}
+
+//-----------------------------------------------------------------------------------
+unsigned int NetConnection::GetPriorityClass(const NetMessageDefinition* definition)
+{
+    return Min<unsigned int>(definition->priority, NUM_PRIORITY_CLASSES - 1);
+}
+
+//-----------------------------------------------------------------------------------
+void NetConnection::FreeAllMessages(PooledNetMessage*& list)
+{
+    while (list != nullptr)
+    {
+        PooledNetMessage* msg = GetFirst(list);
+        RemoveInPlace(list, msg);
+        m_session->m_messagePool.Free(msg);
+    }
+}
+
+//-----------------------------------------------------------------------------------
+//Bit n of the bitfield means (highest received ack - (n + 1)) was received too
 void NetConnection::UpdateHighestValue(uint16_t newValue)
 {
+    const uint16_t NUM_BITFIELD_ACKS = sizeof(m_previousHighestReceivedAcksBitfield) * 8;
     if (CycleGreaterThanEqual(newValue, m_highestReceivedAck))
     {
         uint16_t shift = newValue - m_highestReceivedAck;
-        m_previousHighestReceivedAcksBitfield = m_previousHighestReceivedAcksBitfield << shift;
+        if (shift > NUM_BITFIELD_ACKS)
+        {
+            m_previousHighestReceivedAcksBitfield = 0;
+        }
+        else
+        {
+            //Slide the window up, and the old highest becomes one of the previous acks
+            m_previousHighestReceivedAcksBitfield = (uint16_t)((m_previousHighestReceivedAcksBitfield << shift) | (1 << (shift - 1)));
+        }
         m_highestReceivedAck = newValue;
-        m_previousHighestReceivedAcksBitfield |= shift - 1;
     }
     else
     {
         uint16_t offset = m_highestReceivedAck - newValue;
-        m_previousHighestReceivedAcksBitfield |= offset - 1;
+        if (offset == 0 || (offset <= NUM_BITFIELD_ACKS && (m_previousHighestReceivedAcksBitfield & (1 << (offset - 1))) != 0))
+        {
+            m_telemetry.OnDuplicate();
+        }
+        else
+        {
+            m_telemetry.OnOutOfOrder();
+        }
+        if (offset >= 1 && offset <= NUM_BITFIELD_ACKS)
+        {
+            m_previousHighestReceivedAcksBitfield |= (uint16_t)(1 << (offset - 1));
+        }
     }
 }
 
 //-----------------------------------------------------------------------------------
 void NetConnection::MarkPacketReceived(const NetPacket& packet)
 {
-    //First, update this NetConnection's highest value and previous received acks bitfield (see interview question's AddNewValue).
-    //-- > See Class 7's MarkPacketReceived, which puts the below in a subfunction called ProcessConfirmedAcks.
+    //Update our own view of what we've received, then confirm everything the other side says it received from us.
     UpdateHighestValue(packet.m_header.ack);
-    ConfirmAck(packet.m_header.highestReceivedAck);
-    for (size_t bitIndex = 0; bitIndex < sizeof(packet.m_header.previousReceivedAcksBitfield); ++bitIndex)
+    if (packet.m_header.highestReceivedAck != INVALID_PACKET_ACK)
     {
-        if (((1 << bitIndex) & packet.m_header.previousReceivedAcksBitfield) != 0) //IsBitSetAtIndex( size_t idx, size_t bitfield ) { return ( ( 1<<idx ) & bitfield ) != 0 ; }
+        ConfirmAck(packet.m_header.highestReceivedAck);
+        const unsigned int NUM_BITFIELD_ACKS = sizeof(packet.m_header.previousReceivedAcksBitfield) * 8;
+        for (unsigned int bitIndex = 0; bitIndex < NUM_BITFIELD_ACKS; ++bitIndex)
         {
-            ConfirmAck(packet.m_header.highestReceivedAck - (m_previousHighestReceivedAcksBitfield + 1)); //You're sending in "confirm me as true" for one index of the field?
+            if (((1 << bitIndex) & packet.m_header.previousReceivedAcksBitfield) != 0)
+            {
+                ConfirmAck(packet.m_header.highestReceivedAck - (uint16_t)(bitIndex + 1));
+            }
         }
+        DetectLostPackets(packet.m_header.highestReceivedAck);
     }
-    m_lastRecievedTimeMs = GetCurrentTimeMilliseconds();
+    m_lastRecievedTimeMs = packet.m_arrivalTimeMs;
     if (!IsMyConnection())
     {
         m_state = NetConnection::State::CONFIRMED;
@@ -205,23 +543,69 @@ void NetConnection::MarkPacketReceived(const NetPacket& packet)
 //-----------------------------------------------------------------------------------
 void NetConnection::ConfirmAck(uint16_t ack)
 {
-    //Find the ack bundle.
-    AckBundle* correspondingBundle = FindBundle(ack); //Using the bundles[] on NetConnection.
+    AckBundle* correspondingBundle = FindBundle(ack);
     if (correspondingBundle != nullptr)
     {
-        for each (uint16_t id in correspondingBundle->sentReliableIds)
+        for (uint32_t i = 0; i < correspondingBundle->reliableCount; ++i)
+        {
+            MarkReliableConfirmed(correspondingBundle->sentReliableIds[i]);
+        }
+        //The same ack gets reported in up to 17 packets, only the first one has anything to do
+        correspondingBundle->reliableCount = 0;
+        if (correspondingBundle->sentTimeMs >= 0.0)
+        {
+            //Each ack is only ever sent once (resent reliables go out under a new ack), so every sample is unambiguous
+            float roundTripMs = (float)(m_session->GetNetTimeMilliseconds() - correspondingBundle->sentTimeMs);
+            UpdateRoundTripTime(roundTripMs);
+            m_sendRate.OnPacketAcked(roundTripMs);
+            correspondingBundle->sentTimeMs = -1.0;
+        }
+        if (correspondingBundle->snapshotId != INVALID_SNAPSHOT_ID)
+        {
+            //Acks can be confirmed out of order, and an older snapshot than the one we have is no use as a baseline
+            uint16_t distanceAhead = correspondingBundle->snapshotId - m_ackedSnapshotId;
+            if (m_ackedSnapshotId == INVALID_SNAPSHOT_ID || (distanceAhead != 0 && distanceAhead < 0x8000))
+            {
+                m_ackedSnapshotId = correspondingBundle->snapshotId;
+            }
+            correspondingBundle->snapshotId = INVALID_SNAPSHOT_ID;
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------------
+//Once one of our acks is more than a bitfield behind the highest ack the other side has reported, no later packet can confirm it.
+//Anything that slid out of reach unconfirmed since the last report was lost (or every packet reporting it was), which the send rate treats as congestion.
+void NetConnection::DetectLostPackets(uint16_t highestConfirmedAck)
+{
+    uint16_t numAdvanced = highestConfirmedAck - m_highestConfirmedSentAck;
+    if (m_highestConfirmedSentAck != INVALID_PACKET_ACK)
+    {
+        if (numAdvanced == 0 || numAdvanced >= 0x8000)
         {
-            MarkReliableConfirmed(id); //confirmedIds.push_back() but more logic.
+            return; //A report older than one we've already seen
+        }
+        numAdvanced = Min<uint16_t>(numAdvanced, (uint16_t)MAX_ACK_BUNDLES);
+        for (uint16_t i = 0; i < numAdvanced; ++i)
+        {
+            AckBundle* bundle = FindBundle(highestConfirmedAck - NUM_REPORTED_ACKS - i);
+            if (bundle != nullptr && bundle->sentTimeMs >= 0.0)
+            {
+                bundle->sentTimeMs = -1.0;
+                m_sendRate.OnPacketLost();
+                m_telemetry.OnPacketLost();
+            }
         }
     }
+    m_highestConfirmedSentAck = highestConfirmedAck;
 }
 
 //-----------------------------------------------------------------------------------
 bool NetConnection::IsHostConnection()
 {
-    if (NetSession::instance->m_hostConnection)
+    if (m_session->m_hostConnection)
     {
-        return NetSystem::SockaddrCompare(this->m_address, NetSession::instance->m_hostConnection->m_address);
+        return NetAddress::SockaddrCompare(this->m_address, m_session->m_hostConnection->m_address);
     }
     else
     {
@@ -232,7 +616,7 @@ bool NetConnection::IsHostConnection()
 //-----------------------------------------------------------------------------------
 bool NetConnection::IsMyConnection()
 {
-    return NetSystem::SockaddrCompare(this->m_address, NetSession::instance->m_packetChannel.m_socket.m_address);
+    return NetAddress::SockaddrCompare(this->m_address, m_session->m_packetChannel.GetAddress());
 }
 
 //-----------------------------------------------------------------------------------
@@ -256,7 +640,7 @@ const char* NetConnection::GetStateCstr()
 //-----------------------------------------------------------------------------------
 void NetConnection::MarkMessageReceived(const NetMessage& msg)
 {
-    if (msg.IsReliable())
+    if (msg.IsReliable(*m_session))
     {
         MarkReliableReceived(msg.m_reliableId);
     }
@@ -265,9 +649,12 @@ void NetConnection::MarkMessageReceived(const NetMessage& msg)
 //-----------------------------------------------------------------------------------
 void NetConnection::ProcessMessage(const NetSender& from, NetMessage& msg)
 {
-    if (msg.IsInOrder())
+    if (msg.IsInOrder(*m_session))
     {
-        ProcessInOrder(from, msg);
+        if (!ProcessInOrder(from, msg))
+        {
+            return;
+        }
     }
     else
     {
@@ -277,54 +664,150 @@ void NetConnection::ProcessMessage(const NetSender& from, NetMessage& msg)
 }
 
 //-----------------------------------------------------------------------------------
-void NetConnection::ProcessInOrder(const NetSender& from, NetMessage& msg)
+//Fragments can arrive in any order. Each one is copied straight to its place in the reassembly buffer, and the last to arrive hands the whole thing to the game.
+void NetConnection::ProcessFragment(const NetSender& from, NetMessage& msg)
 {
-    if (msg.m_sequenceId == m_nextExpectedReceivedSequenceId)
+    size_t messageSize = msg.GetPayloadSize(); //Reading shrinks what's left, so take it before the header
+    if (messageSize < FRAGMENT_HEADER_BYTES)
     {
-        msg.Process(from);
-        ++m_nextExpectedReceivedSequenceId;
-        while (!m_outOfOrderReceivedSequencedMessages.empty() && m_outOfOrderReceivedSequencedMessages[0]->m_sequenceId == m_nextExpectedReceivedSequenceId)
-        {
-            m_outOfOrderReceivedSequencedMessages[0]->Process(from);
-            ++m_nextExpectedReceivedSequenceId;
-            delete m_outOfOrderReceivedSequencedMessages[0];
-            m_outOfOrderReceivedSequencedMessages.erase(m_outOfOrderReceivedSequencedMessages.begin());
-        }
+        return;
     }
-    else
+    uint16_t largeMessageId = 0;
+    uint8_t type = 0;
+    uint16_t fragmentIndex = 0;
+    uint32_t totalSize = 0;
+    msg.Read<uint16_t>(largeMessageId);
+    msg.Read<uint8_t>(type);
+    msg.Read<uint16_t>(fragmentIndex);
+    msg.Read<uint32_t>(totalSize);
+    const NetMessageDefinition& definition = m_session->m_netMessageDefinitions[type];
+    uint16_t numFragments = (uint16_t)Max<size_t>((totalSize + FRAGMENT_PAYLOAD_BYTES - 1) / FRAGMENT_PAYLOAD_BYTES, 1);
+    size_t offset = fragmentIndex * FRAGMENT_PAYLOAD_BYTES;
+    size_t payloadSize = messageSize - FRAGMENT_HEADER_BYTES;
+    if (totalSize > MAX_LARGE_MESSAGE_BYTES || fragmentIndex >= numFragments || definition.largeCallbackFunction == nullptr
+        || payloadSize != Min<size_t>(totalSize - offset, (size_t)FRAGMENT_PAYLOAD_BYTES))
+    {
+        return;
+    }
+
+    IncomingLargeMessage& incoming = m_incomingLargeMessages[largeMessageId % MAX_CONCURRENT_LARGE_MESSAGES];
+    if (incoming.buffer == nullptr)
+    {
+        incoming.buffer = m_session->AcquireReassemblyBuffer();
+        incoming.id = largeMessageId;
+        incoming.type = type;
+        incoming.totalSize = totalSize;
+        incoming.numFragments = numFragments;
+        incoming.numFragmentsReceived = 0;
+        memset(incoming.receivedFragments, 0, sizeof(incoming.receivedFragments));
+    }
+    else if (incoming.id != largeMessageId || incoming.type != type || incoming.totalSize != totalSize)
+    {
+        return; //A sender that doesn't respect the cap, there's nowhere to put it
+    }
+
+    uint32_t fragmentBit = 1u << (fragmentIndex % 32);
+    uint32_t& fragmentWord = incoming.receivedFragments[fragmentIndex / 32];
+    if ((fragmentWord & fragmentBit) != 0)
+    {
+        return;
+    }
+    fragmentWord |= fragmentBit;
+    memcpy(incoming.buffer + offset, msg.GetHead(), payloadSize);
+    if (++incoming.numFragmentsReceived == incoming.numFragments)
     {
-        NetMessage* copy = new NetMessage(msg);
-        AddInOrderOfSequenceId(copy);
+        byte* buffer = incoming.buffer;
+        incoming.buffer = nullptr;
+        definition.largeCallbackFunction(from, buffer, totalSize);
+        m_session->ReleaseReassemblyBuffer(buffer);
     }
 }
 
 //-----------------------------------------------------------------------------------
-void NetConnection::AddInOrderOfSequenceId(NetMessage* newMessage)
+void NetConnection::ReleaseIncomingLargeMessage(IncomingLargeMessage& incoming)
 {
-    for (auto iter = m_outOfOrderReceivedSequencedMessages.begin(); iter != m_outOfOrderReceivedSequencedMessages.end(); ++iter)
+    if (incoming.buffer != nullptr)
     {
-        if (newMessage->m_sequenceId < (*iter)->m_sequenceId)
+        m_session->ReleaseReassemblyBuffer(incoming.buffer);
+        incoming.buffer = nullptr;
+    }
+}
+
+//-----------------------------------------------------------------------------------
+//Early messages wait in a ring slot for their sequence id. When the expected one shows up, it and the run waiting behind it are delivered, O(1) each.
+bool NetConnection::ProcessInOrder(const NetSender& from, NetMessage& msg)
+{
+    uint16_t distanceAhead = msg.m_sequenceId - m_nextExpectedReceivedSequenceId;
+    if (distanceAhead >= 0x8000)
+    {
+        return true; //Already delivered, this is a resend of one whose ack got lost
+    }
+    if (distanceAhead >= IN_ORDER_WINDOW_SIZE)
+    {
+        return false; //Too far ahead to hold, leave it unmarked so the sender resends it once we've caught up
+    }
+    if (distanceAhead > 0)
+    {
+        PooledNetMessage*& slot = m_inOrderRing[msg.m_sequenceId % IN_ORDER_WINDOW_SIZE];
+        if (slot == nullptr)
         {
-            m_outOfOrderReceivedSequencedMessages.insert(iter, newMessage);
-            return;
+            slot = m_session->m_messagePool.Alloc(msg);
         }
+        return true;
     }
-    m_outOfOrderReceivedSequencedMessages.push_back(newMessage);
+
+    msg.Process(from);
+    ++m_nextExpectedReceivedSequenceId;
+    PooledNetMessage** slot = &m_inOrderRing[m_nextExpectedReceivedSequenceId % IN_ORDER_WINDOW_SIZE];
+    if (*slot != nullptr)
+    {
+        NetMessage heldMessage;
+        do
+        {
+            (*slot)->CopyTo(heldMessage);
+            m_session->m_messagePool.Free(*slot);
+            *slot = nullptr;
+            heldMessage.Process(from);
+            ++m_nextExpectedReceivedSequenceId;
+            slot = &m_inOrderRing[m_nextExpectedReceivedSequenceId % IN_ORDER_WINDOW_SIZE];
+        } while (*slot != nullptr);
+    }
+    return true;
 }
 
 //-----------------------------------------------------------------------------------
-bool NetConnection::IsOld(NetMessage* msg)
+//A reliable is old once it's gone a retransmit timeout without its ack being confirmed
+bool NetConnection::IsOld(PooledNetMessage* msg)
 {
-    const float ROUND_TRIP_TIME_MS = 150.0f;
-    const uint32_t OLD_AGE_MS = (uint32_t)((ROUND_TRIP_TIME_MS + (ROUND_TRIP_TIME_MS * 0.1f)) / (ROUND_TRIP_TIME_MS * 0.2f));
-    uint32_t age = (uint32_t)GetCurrentTimeMilliseconds() - msg->m_lastSentTimestampMs;
-    return age > OLD_AGE_MS;
+    uint32_t age = (uint32_t)m_session->GetNetTimeMilliseconds() - msg->m_lastSentTimestampMs;
+    return (float)age >= m_retransmitTimeoutMs;
+}
+
+//-----------------------------------------------------------------------------------
+//Jacobson/Karels estimator (RFC 6298): smoothed round trip plus four deviations, so the timeout tracks both latency and jitter
+void NetConnection::UpdateRoundTripTime(float sampleMs)
+{
+    const float RTT_GAIN = 1.0f / 8.0f;
+    const float VARIANCE_GAIN = 1.0f / 4.0f;
+    if (!HasRoundTripSample())
+    {
+        m_smoothedRoundTripTimeMs = sampleMs;
+        m_roundTripVarianceMs = sampleMs * 0.5f;
+    }
+    else
+    {
+        float error = sampleMs - m_smoothedRoundTripTimeMs;
+        m_roundTripVarianceMs += VARIANCE_GAIN * (fabsf(error) - m_roundTripVarianceMs);
+        m_smoothedRoundTripTimeMs += RTT_GAIN * error;
+    }
+    m_retransmitTimeoutMs = MathUtils::Clamp(m_smoothedRoundTripTimeMs + (4.0f * m_roundTripVarianceMs), MIN_RETRANSMIT_TIMEOUT_MS, MAX_RETRANSMIT_TIMEOUT_MS);
 }
 
 //-----------------------------------------------------------------------------------
+//The confirmed and received windows are RELIABLE_WINDOW_SIZE wide, so never have more than that in flight or ids would alias
 bool NetConnection::CanAttachNewReliable()
 {
-    return true;
+    return GetLiveReliableRange() < RELIABLE_WINDOW_SIZE;
 }
 
 //-----------------------------------------------------------------------------------
@@ -338,49 +821,30 @@ uint16_t NetConnection::GetNextReliableID()
 //-----------------------------------------------------------------------------------
 void NetConnection::MarkReliableConfirmed(const uint16_t reliableId)
 {
-    if (reliableId < m_oldestUnconfirmedReliableId)
+    uint16_t distance = reliableId - m_oldestUnconfirmedReliableId;
+    if (distance >= GetLiveReliableRange())
     {
-        return; //We already know it was confirmed--because it's below the oldest unconfirmed we have.
+        return; //Below the oldest unconfirmed, so we already know it was confirmed.
     }
-    else if (reliableId == m_oldestUnconfirmedReliableId)
-    {
-        //The main reason we insert reliableId just to remove it, is to increment m_oldest correctly.
-        auto ridIter = m_confirmedReliableIds.insert(reliableId).first; //Iter to inserted key.
+    m_confirmedReliableIds.Set(reliableId);
 
-        //This may not be as simple as just incrementing once.
-        //e.g. m_oldestUnconfirmedReliableID was 3, and now we've received 2 for the first time.
-        //So, we need to advance as many times as it takes to find m_oldest.
-        while (ridIter != m_confirmedReliableIds.end())
-        {
-            m_confirmedReliableIds.erase(ridIter);
-            ++m_oldestUnconfirmedReliableId; //Be sure it comes after the erase!
-            ridIter = m_confirmedReliableIds.find(m_oldestUnconfirmedReliableId);
-        } //Each time we remove at the oldest, we'll increment oldest for the next go-around, so we'll remove 0, 1, 2, but not 4 if find(3) fails.
-    }
-    else //The oldest is staying the oldest, but the new received id exceeds it. This above is when we receive 3, but still are missing 2.
+    //Confirming the oldest can free up a whole run, e.g. oldest was 2 and we'd already heard about 3 and 4.
+    while (m_oldestUnconfirmedReliableId != m_nextSentReliableId && m_confirmedReliableIds.IsSet(m_oldestUnconfirmedReliableId))
     {
-        m_confirmedReliableIds.emplace(reliableId);
+        m_confirmedReliableIds.Clear(m_oldestUnconfirmedReliableId);
+        ++m_oldestUnconfirmedReliableId;
     }
 }
 
 //-----------------------------------------------------------------------------------
 bool NetConnection::IsReliableConfirmed(const uint16_t reliableId)
 {
-    if (reliableId < m_oldestUnconfirmedReliableId)
+    uint16_t distance = reliableId - m_oldestUnconfirmedReliableId;
+    if (distance >= GetLiveReliableRange())
     {
-        return true; //We already know it was confirmed--because it's below the oldest unconfirmed we have.
-    }
-    else
-    {
-        for (uint16_t id : m_confirmedReliableIds)
-        {
-            if (id == reliableId)
-            {
-                return true;
-            }
-        }
-        return false;
+        return true; //Below the oldest unconfirmed we have.
     }
+    return m_confirmedReliableIds.IsSet(reliableId);
 }
 
 //-----------------------------------------------------------------------------------
@@ -394,43 +858,38 @@ bool NetConnection::CycleGreaterThanEqual(uint16_t a, uint16_t b)
 NetConnection::AckBundle* NetConnection::FindBundle(uint16_t ack)
 {
     uint16_t idx = ack % MAX_ACK_BUNDLES;
-    return &(m_ackBundles[idx]);
+    AckBundle* bundle = &(m_ackBundles[idx]);
+    return bundle->ack == ack ? bundle : nullptr; //Otherwise the slot was reused by a newer packet
 }
 
 //-----------------------------------------------------------------------------------
 bool NetConnection::HasReceivedReliable(const uint16_t reliableId)
 {
-    uint16_t min = m_nextExpectedReliableId - MAX_RELIABLE_RANGE;
-    uint16_t max = m_nextExpectedReliableId;
-    ASSERT_OR_DIE(reliableId <= (max + MAX_RELIABLE_RANGE), "Received a reliable outside of our expected max active reliables range");
-    
-    if (!CycleGreaterThanEqual(reliableId, min))
-    {
-        return true;
-    }
-    else if (CycleGreaterThanEqual(reliableId, m_nextExpectedReliableId))
+    uint16_t distanceAhead = reliableId - m_nextExpectedReliableId;
+    if (distanceAhead < 0x8000)
     {
-        return false;
+        //The sender never has more than a window in flight past what we've acked, anything further out is garbage
+        return distanceAhead >= RELIABLE_WINDOW_SIZE;
     }
-    else
+    uint16_t distanceBehind = m_nextExpectedReliableId - reliableId;
+    if (distanceBehind > RELIABLE_WINDOW_SIZE)
     {
-        for (uint16_t id : m_receivedReliableIds)
-        {
-            if (id == reliableId)
-            {
-                return true;
-            }
-        }
-        return false;
+        return true; //Fell out of the window long ago
     }
+    return m_receivedReliableIds.IsSet(reliableId);
 }
 
 //-----------------------------------------------------------------------------------
 bool NetConnection::CanProcessMessage(const NetMessage& msg)
 {
-    if (msg.IsReliable())
+    if (msg.IsReliable(*m_session))
     {
-        return !HasReceivedReliable(msg.m_reliableId);
+        if (HasReceivedReliable(msg.m_reliableId))
+        {
+            m_telemetry.OnDuplicate();
+            return false;
+        }
+        return true;
     }
     else
     {
@@ -441,51 +900,25 @@ bool NetConnection::CanProcessMessage(const NetMessage& msg)
 //-----------------------------------------------------------------------------------
 void NetConnection::MarkReliableReceived(const uint16_t reliableId)
 {
-    if (CycleGreaterThanEqual(reliableId, m_nextExpectedReliableId))
+    uint16_t distanceAhead = reliableId - m_nextExpectedReliableId;
+    if (distanceAhead < 0x8000)
     {
-        uint16_t distance = reliableId - m_nextExpectedReliableId;
-        if (distance > MAX_RELIABLE_RANGE)
-        {
-            ERROR_AND_DIE("Received a reliable id outside of the window");
-        }
-        m_receivedReliableIds.push_back(reliableId);
+        //Slide the window forward. The bits for the newly covered ids still hold ids from a window ago, so wipe them first.
+        m_receivedReliableIds.ClearRange(m_nextExpectedReliableId, distanceAhead + 1);
         m_nextExpectedReliableId = reliableId + 1;
     }
-    else
-    {
-        uint16_t diff = m_nextExpectedReliableId - reliableId;
-        if (diff < MAX_RELIABLE_RANGE)
-        {
-            m_receivedReliableIds.push_back(reliableId);
-        }
-        if (m_nextExpectedReliableId == reliableId)
-        {
-            m_nextExpectedReliableId++;
-        }
-    }
-    RemoveAllReliableIdsLessThan(reliableId - MAX_RELIABLE_RANGE);
-}
-
-//-----------------------------------------------------------------------------------
-void NetConnection::RemoveAllReliableIdsLessThan(const uint16_t value)
-{
-    for (auto iter = m_receivedReliableIds.begin(); iter != m_receivedReliableIds.end();)
+    else if ((uint16_t)(m_nextExpectedReliableId - reliableId) > RELIABLE_WINDOW_SIZE)
     {
-        if (!CycleGreaterThanEqual(*iter, value))
-        {
-            iter = m_receivedReliableIds.erase(iter);
-        }
-        else
-        {
-            ++iter;
-        }
+        return; //Too old to track, its bit belongs to a newer id now
     }
+    m_receivedReliableIds.Set(reliableId);
 }
 
 //-----------------------------------------------------------------------------------
 void NetConnection::AckBundle::AddReliable(uint16_t reliableId)
 {
-    sentReliableIds.push_back(reliableId);
+    ASSERT_OR_DIE(reliableCount < MAX_RELIABLES_PER_PACKET, "Attached more reliables to a packet than an ack bundle can hold");
+    sentReliableIds[reliableCount++] = reliableId;
 }
 
 //-----------------------------------------------------------------------------------
@@ -495,5 +928,7 @@ NetConnection::AckBundle* NetConnection::CreateBundle(uint16_t ack)
     AckBundle* bundle = &(m_ackBundles[idx]);
     bundle->ack = ack;
     bundle->reliableCount = 0;
+    bundle->sentTimeMs = m_session->GetNetTimeMilliseconds();
+    bundle->snapshotId = INVALID_SNAPSHOT_ID;
     return bundle;
-}
\ No newline at end of file
+}
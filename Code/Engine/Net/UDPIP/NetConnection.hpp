@@ -1,17 +1,17 @@
 #pragma once
-#pragma comment(lib, "ws2_32")
+#include "Engine/Net/UDPIP/UDPTransport.hpp"
+#include "Engine/Net/UDPIP/NetMessage.hpp"
+#include "Engine/Net/UDPIP/SendRateController.hpp"
+#include "Engine/Net/UDPIP/NetConnectionTelemetry.hpp"
+#include "Engine/DataStructures/SequenceBitset.hpp"
 #include <stdint.h>
-#include <WinSock2.h>
-#include <WS2tcpip.h>
-#include <stdint.h>
-#include <vector>
-#include <queue>
-#include <set>
 
 class NetSession;
 class NetMessage;
 class NetPacket;
 struct NetSender;
+struct PooledNetMessage;
+struct NetMessageDefinition;
 
 class NetConnection
 {
@@ -23,8 +23,23 @@ public:
     static const int TIMEOUT_TIME_MS = 15000;
     static const int BAD_CONNECTION_TIME_MS = 5000;
     static const int MAX_RELIABLES_PER_PACKET = 32;
-    static const uint16_t MAX_RELIABLE_RANGE = 1000;
+    static const uint16_t RELIABLE_WINDOW_SIZE = 1024; //Most reliable ids that can be in flight, and how far back the receiver remembers ids
+    static const uint16_t IN_ORDER_WINDOW_SIZE = RELIABLE_WINDOW_SIZE; //How far past the next expected sequence id we'll hold messages
     static const uint16_t INVALID_PACKET_ACK = 0xFFFF;
+    static const uint16_t INVALID_SNAPSHOT_ID = 0xFFFF;
+    static constexpr float INITIAL_RETRANSMIT_TIMEOUT_MS = 1000.0f; //Used until the first ack comes back with a round trip sample. RFC 6298's 1s, so a slow link doesn't resend everything it sent before then.
+    static constexpr float MIN_RETRANSMIT_TIMEOUT_MS = 10.0f;
+    static constexpr float MAX_RETRANSMIT_TIMEOUT_MS = 2000.0f;
+    static const uint32_t STALE_UNRELIABLE_AGE_MS = 100; //Unreliables still waiting on send budget after this long are dropped
+    static const uint16_t NUM_REPORTED_ACKS = 17; //The highest received ack plus the bitfield behind it
+    static const unsigned int MAX_CONCURRENT_LARGE_MESSAGES = 4; //Large messages the sender lets out at once, and reassembly slots the receiver keeps
+    static const size_t FRAGMENT_HEADER_BYTES = 9; //Large message id, type, fragment index, total size
+    static const size_t MESSAGE_HEADER_BYTES = 5; //Type, reliable id, sequence id. MESSAGE_MTU counts these too.
+    static const size_t FRAGMENT_PAYLOAD_BYTES = MESSAGE_MTU - MESSAGE_HEADER_BYTES - FRAGMENT_HEADER_BYTES;
+    static const uint16_t MAX_LARGE_MESSAGE_FRAGMENTS = 256;
+    static const size_t MAX_LARGE_MESSAGE_BYTES = MAX_LARGE_MESSAGE_FRAGMENTS * FRAGMENT_PAYLOAD_BYTES; //A little over 252KB
+    static const unsigned int NUM_PRIORITY_CLASSES = 4; //A definition's priority is its class, anything above the top class is in it
+    static const size_t PRIORITY_QUANTUM_BYTES = 128; //How much a class can send on its turn, times its weight of 1 << class
 
     //ENUMS/////////////////////////////////////////////////////////////////////
     enum State
@@ -41,51 +56,98 @@ public:
     // so upon that ack being confirmed, we can do some cleanup
     struct AckBundle
     {
+        AckBundle() : ack(INVALID_PACKET_ACK), sentTimeMs(-1.0), snapshotId(INVALID_SNAPSHOT_ID), reliableCount(0) {};
         void AddReliable(uint16_t reliableId);
 
         uint16_t ack;
+        double sentTimeMs; //Negative once the ack has been confirmed, so only the first confirmation is used as a round trip sample
+        uint16_t snapshotId; //The snapshot that went out in this packet, if any
         uint32_t reliableCount;
         // What reliables were sent with this ack?
-        std::vector<uint16_t> sentReliableIds;
+        uint16_t sentReliableIds[MAX_RELIABLES_PER_PACKET];
+    };
+
+    //A large message being put back together. The buffer comes from the session's reassembly pool, and the slot is free while it's null.
+    struct IncomingLargeMessage
+    {
+        IncomingLargeMessage() : buffer(nullptr) {};
+
+        byte* buffer;
+        uint32_t totalSize;
+        uint16_t id;
+        uint16_t numFragments;
+        uint16_t numFragmentsReceived;
+        uint8_t type;
+        uint32_t receivedFragments[MAX_LARGE_MESSAGE_FRAGMENTS / 32];
+    };
+
+    //A large message the sender has let out. It's finished once every reliable up to its last fragment has been confirmed.
+    struct OutgoingLargeMessage
+    {
+        OutgoingLargeMessage() : lastReliableId(0), isFullySent(false) {};
+
+        uint16_t lastReliableId;
+        bool isFullySent;
     };
 
     struct Info
     {
         sockaddr_in address;
         char m_guid[MAX_GUID_LENGTH];
-        uint8_t index;
+        uint16_t index;
     };
 
     //CONSTRUCTORS/////////////////////////////////////////////////////////////////////
-    NetConnection(uint8_t index, const char* guid, const sockaddr_in& address, NetSession* session);
+    NetConnection(uint16_t index, const char* guid, const sockaddr_in& address, NetSession* session);
     ~NetConnection();
 
     //FUNCTIONS/////////////////////////////////////////////////////////////////////
     void SendMessage(NetMessage& msg);
+    void SendSnapshot(NetMessage& msg, uint16_t snapshotId); //Replaces a snapshot still waiting to be sent
+    void SendLargeMessage(uint8_t type, const void* data, size_t numBytes); //Split into reliable fragments, for types registered with RegisterLargeMessage
     void ConstructAndSendPacket();
+    void ConstructPacket(NetPacket& packet);
     uint8_t AttachOldReliables(NetPacket& p, AckBundle* ackBundle);
-    uint8_t AttachUnsentReliables(NetPacket& p, AckBundle* ab);
-    uint8_t AttachUnreliables(NetPacket& p);
+    uint8_t AttachByPriority(NetPacket& p, AckBundle* ackBundle);
+    uint8_t AttachPriorityClass(NetPacket& p, AckBundle* ackBundle, unsigned int priorityClass, size_t stopAtBytes);
+    uint8_t AttachUnsentReliables(NetPacket& p, AckBundle* ab, PooledNetMessage*& queue, size_t stopAtBytes = SIZE_MAX, uint8_t maxMessages = 0xFF); //Each Attach stops once the packet has grown to stopAtBytes
+    uint8_t AttachUnsentInOrderReliables(NetPacket& p, AckBundle* ackBundle, unsigned int priorityClass, size_t stopAtBytes);
+    uint8_t AttachUnreliables(NetPacket& p, AckBundle* ackBundle, PooledNetMessage*& queue, size_t stopAtBytes = SIZE_MAX);
+    uint8_t AttachUnsentFragments(NetPacket& p, AckBundle* ackBundle, size_t stopAtBytes = SIZE_MAX);
+    void FreeAllMessages(PooledNetMessage*& list);
+    bool HasUnsentMessages(unsigned int priorityClass) const;
+    unsigned int GetInOrderPriorityClass() const;
+    static unsigned int GetPriorityClass(const NetMessageDefinition* definition);
+    static inline unsigned int GetPriorityWeight(unsigned int priorityClass) { return 1u << priorityClass; };
     void UpdateHighestValue(uint16_t newValue);
     void MarkPacketReceived(const NetPacket& packet);
     void ConfirmAck(uint16_t ack);
+    void DetectLostPackets(uint16_t highestConfirmedAck);
     bool IsHostConnection();
     bool IsMyConnection();
     inline bool IsConnected() { return m_state == CONFIRMED || m_state == LOCAL || m_state == BAD; };
     const char* GetStateCstr();
     void MarkMessageReceived(const NetMessage& msg);
     void ProcessMessage(const NetSender& from, NetMessage& msg); //Called if we can process a message and will mark the message as recieved
-    void ProcessInOrder(const NetSender& from, NetMessage& msg);
-    void AddInOrderOfSequenceId(NetMessage* msg);
-    bool IsOld(NetMessage* msg);
+    bool ProcessInOrder(const NetSender& from, NetMessage& msg); //Returns false if the message couldn't be held, so it shouldn't be marked as received
+    void ProcessFragment(const NetSender& from, NetMessage& msg);
+    bool IsOld(PooledNetMessage* msg);
     AckBundle* CreateBundle(uint16_t ack);
     bool CanProcessMessage(const NetMessage& msg); // should we process this message (checks controls and records) such as it already being received
     uint16_t GetLastSentAck() { return m_nextSentAck - 1; };
     uint16_t GetMostRecentConfirmedAck() { return m_highestReceivedAck; };
+    uint16_t GetLiveReliableRange() { return m_nextSentReliableId - m_oldestUnconfirmedReliableId; }; // how many reliable ids are sent but not yet confirmed
+    void UpdateRoundTripTime(float sampleMs);
+    inline bool HasRoundTripSample() const { return m_smoothedRoundTripTimeMs >= 0.0f; };
+    inline float GetRoundTripTimeMs() const { return HasRoundTripSample() ? m_smoothedRoundTripTimeMs : 0.0f; };
+    inline float GetRoundTripVarianceMs() const { return m_roundTripVarianceMs; };
+    inline float GetRetransmitTimeoutMs() const { return m_retransmitTimeoutMs; };
+    inline unsigned int GetNumLargeMessagesQueued() const { return (uint16_t)(m_nextLargeMessageId - m_oldestUnfinishedLargeMessageId); }; //Sent or waiting, but not yet confirmed
 
     //MEMBER VARIABLES/////////////////////////////////////////////////////////////////////
     //Identifying info
-    uint8_t m_index;
+    uint16_t m_index;
+    uint16_t m_activeSlot; //Where this sits in the session's compact array of active connections
     sockaddr_in m_address;
     char m_guid[MAX_GUID_LENGTH];
     NetSession* m_session;
@@ -95,11 +157,31 @@ public:
     double m_lastSentTimeMs;
     double m_lastRecievedTimeMs;
 
+    //Round trip estimation, from the time between sending a packet and first hearing its ack confirmed
+    float m_smoothedRoundTripTimeMs; //Negative until the first sample
+    float m_roundTripVarianceMs;
+    float m_retransmitTimeoutMs; //How long a sent reliable waits for its ack before IsOld resends it
+
+    //Send rate
+    SendRateController m_sendRate;
+    unsigned int m_numStaleUnreliablesDropped;
+
+    //Snapshot replication
+    uint16_t m_ackedSnapshotId; //Newest snapshot the other side is known to have, from the ack bundle it went out in
+
+    //Compression
+    uint32_t m_compressionId; //Compressor id both ends agreed on when joining, packets go out uncompressed while it's 0
+    size_t m_numBytesBeforeCompression; //Every packet sent, as built and as it went out
+    size_t m_numBytesAfterCompression;
+
+    //Telemetry
+    NetConnectionTelemetry m_telemetry;
+    uint32_t m_numUnsentReliables; //Reliables and fragments queued but never sent, counted as they come and go since the queues are lists
+
 private:
     //PRIVATE FUNCTIONS/////////////////////////////////////////////////////////////////////
     //Send side:  reliable traffic
     bool CanAttachNewReliable(); // determines if we can send a new reliable message (have reliables IDs to spare)
-    size_t GetLiveReliableRange() { return m_lastSentReliableId - m_oldestUnconfirmedReliableId; }; // distance between last_sent_reliable_id, and oldest_unconfirmed_reliable_id
     uint16_t GetNextReliableID();
 
     // Mark a reliable ID as confirmed - that is, we know the other guy has processed it
@@ -108,40 +190,63 @@ private:
     bool CycleGreaterThanEqual(uint16_t a, uint16_t b);
     AckBundle* FindBundle(uint16_t ack);
 
+    //Large messages
+    void RetireFinishedLargeMessages();
+    void ReleaseIncomingLargeMessage(IncomingLargeMessage& incoming);
+
     // recv_side: reliable traffic
     bool HasReceivedReliable(const uint16_t reliableId);	// check if a reliable_id is marked as received
     void MarkReliableReceived(const uint16_t reliableId); 	// after processing a message, mark it as received
-    void RemoveAllReliableIdsLessThan(const uint16_t value);
 
     //PRIVATE MEMBERS/////////////////////////////////////////////////////////////////////
+    //The counters and queue heads every packet touches are packed together up front, so handling a packet for one of hundreds of
+    //connections pulls in a couple of cache lines. The per-window arrays below them are only touched at the entries in use.
+
+    //Messages, in place linked lists of blocks from the session's NetMessagePool. Each list pointer is the front of its queue.
+    //New messages wait in their priority class's queues, oldest first.
+    PooledNetMessage* m_unreliables[NUM_PRIORITY_CLASSES];
+    PooledNetMessage* m_unsentInOrderReliables; //One queue in sequence order, taking its turns as the highest class it holds, so nothing urgent waits behind a gap
+    PooledNetMessage* m_unsentReliables[NUM_PRIORITY_CLASSES];
+    PooledNetMessage* m_sentReliables;
+    PooledNetMessage* m_unsentFragments; //Fragments of large messages, always in the lowest class, let out once fewer than MAX_CONCURRENT_LARGE_MESSAGES are unfinished
+    PooledNetMessage* m_queuedSnapshot; //Sits in its class's unreliables until it's sent, dropped or replaced
+    uint16_t m_queuedSnapshotId;
+    uint32_t m_priorityAccumulators[NUM_PRIORITY_CLASSES]; //Grows by the class's weight every packet it has something waiting, reset when it gets its turn
+    uint16_t m_numUnsentInOrderReliables[NUM_PRIORITY_CLASSES]; //How many of each class are in m_unsentInOrderReliables
+
     //Acks
     //sending
     uint16_t m_nextSentAck;
-    AckBundle m_ackBundles[MAX_ACK_BUNDLES];
+    uint16_t m_highestConfirmedSentAck; // highest of our acks the other side has reported receiving
     //recieving
     uint16_t m_nextExpectedAck; // should always be highest_received_ack + 1.
     uint16_t m_highestReceivedAck; // so there's no real need for both
     uint16_t m_previousHighestReceivedAcksBitfield; // bitfield of previous received acks
 
-    //Messages
-    std::vector<NetMessage*> m_unreliables;
-    std::queue<NetMessage*> m_unsentReliables;
-    std::queue<NetMessage*> m_sentReliables;
-
     //Sending reliable traffic
     uint16_t m_nextSentReliableId;
     uint16_t m_lastSentReliableId;
     uint16_t m_oldestUnconfirmedReliableId;
-    std::set<uint16_t> m_confirmedReliableIds;
 
     //Recieving reliable traffic
     uint16_t m_nextExpectedReliableId;
-    std::vector<uint16_t> m_receivedReliableIds;
 
     //Sending InOrder
     uint16_t m_nextSentSequenceId;
 
     //Receiving InOrder
     uint16_t m_nextExpectedReceivedSequenceId;
-    std::vector<NetMessage*> m_outOfOrderReceivedSequencedMessages;
+
+    //Sending large messages
+    uint16_t m_nextLargeMessageId;
+    uint16_t m_oldestUnfinishedLargeMessageId;
+    OutgoingLargeMessage m_outgoingLargeMessages[MAX_CONCURRENT_LARGE_MESSAGES]; //By large message id modulo the cap
+
+    //Per-window state
+    SequenceBitset<RELIABLE_WINDOW_SIZE> m_confirmedReliableIds; // ids between oldest unconfirmed and next sent that were confirmed out of order
+    SequenceBitset<RELIABLE_WINDOW_SIZE> m_receivedReliableIds; // the RELIABLE_WINDOW_SIZE ids below next expected that have been processed
+    AckBundle m_ackBundles[MAX_ACK_BUNDLES];
+    PooledNetMessage* m_inOrderRing[IN_ORDER_WINDOW_SIZE]; //Messages that arrived early, indexed by sequence id modulo the window
+    IncomingLargeMessage m_incomingLargeMessages[MAX_CONCURRENT_LARGE_MESSAGES]; //By large message id modulo the cap, which the sender never lets overlap
+
 };
\ No newline at end of file
@@ -0,0 +1,107 @@
+#include "Engine/Net/UDPIP/NetConnectionTelemetry.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Math/MathUtils.hpp"
+
+//-----------------------------------------------------------------------------------
+void NetTelemetrySample::Clear()
+{
+    ClearCounts();
+    numUnsentReliables = 0;
+    numUnconfirmedReliables = 0;
+    roundTripMs = 0.0f;
+    lossRate = 0.0f;
+}
+
+//-----------------------------------------------------------------------------------
+void NetTelemetrySample::ClearCounts()
+{
+    numBytesSent = 0;
+    numBytesReceived = 0;
+    numPacketsSent = 0;
+    numPacketsReceived = 0;
+    numPacketsLost = 0;
+    numResends = 0;
+    numDuplicates = 0;
+    numOutOfOrder = 0;
+    durationMs = 0.0f;
+}
+
+//-----------------------------------------------------------------------------------
+void NetTelemetrySample::Accumulate(const NetTelemetrySample& other)
+{
+    numBytesSent += other.numBytesSent;
+    numBytesReceived += other.numBytesReceived;
+    numPacketsSent += other.numPacketsSent;
+    numPacketsReceived += other.numPacketsReceived;
+    numPacketsLost += other.numPacketsLost;
+    numResends += other.numResends;
+    numDuplicates += other.numDuplicates;
+    numOutOfOrder += other.numOutOfOrder;
+    numUnsentReliables = other.numUnsentReliables;
+    numUnconfirmedReliables = other.numUnconfirmedReliables;
+    roundTripMs = other.roundTripMs;
+    lossRate = other.lossRate;
+    durationMs += other.durationMs;
+}
+
+//-----------------------------------------------------------------------------------
+NetConnectionTelemetry::NetConnectionTelemetry()
+    : m_nextHistoryIndex(0)
+    , m_numHistorySamples(0)
+    , m_intervalStartMs(-1.0)
+{
+}
+
+//-----------------------------------------------------------------------------------
+void NetConnectionTelemetry::Update(double nowMs, uint32_t numUnsentReliables, uint32_t numUnconfirmedReliables, float roundTripMs, float lossRate)
+{
+    m_current.numUnsentReliables = numUnsentReliables;
+    m_current.numUnconfirmedReliables = numUnconfirmedReliables;
+    m_current.roundTripMs = roundTripMs;
+    m_current.lossRate = lossRate;
+    if (m_intervalStartMs < 0.0)
+    {
+        m_intervalStartMs = nowMs;
+    }
+    if (nowMs - m_intervalStartMs < (double)INTERVAL_MS)
+    {
+        return;
+    }
+
+    m_current.durationMs = (float)(nowMs - m_intervalStartMs);
+    m_totals.Accumulate(m_current);
+    m_history[m_nextHistoryIndex] = m_current;
+    m_nextHistoryIndex = (m_nextHistoryIndex + 1) % HISTORY_LENGTH;
+    m_numHistorySamples = Min<unsigned int>(m_numHistorySamples + 1, (unsigned int)HISTORY_LENGTH);
+    m_current.ClearCounts();
+    m_intervalStartMs = nowMs;
+}
+
+//-----------------------------------------------------------------------------------
+const NetTelemetrySample& NetConnectionTelemetry::GetHistorySample(unsigned int age) const
+{
+    ASSERT_OR_DIE(age < m_numHistorySamples, "Asked for telemetry older than the history holds");
+    return m_history[(m_nextHistoryIndex + HISTORY_LENGTH - 1 - age) % HISTORY_LENGTH];
+}
+
+//-----------------------------------------------------------------------------------
+float NetConnectionTelemetry::GetBytesPerSecondSent(unsigned int age) const
+{
+    if (age >= m_numHistorySamples)
+    {
+        return 0.0f;
+    }
+    const NetTelemetrySample& sample = GetHistorySample(age);
+    return (float)sample.numBytesSent * 1000.0f / sample.durationMs;
+}
+
+//-----------------------------------------------------------------------------------
+float NetConnectionTelemetry::GetBytesPerSecondReceived(unsigned int age) const
+{
+    if (age >= m_numHistorySamples)
+    {
+        return 0.0f;
+    }
+    const NetTelemetrySample& sample = GetHistorySample(age);
+    return (float)sample.numBytesReceived * 1000.0f / sample.durationMs;
+}
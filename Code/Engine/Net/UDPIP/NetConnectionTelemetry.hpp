@@ -0,0 +1,72 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+//-----------------------------------------------------------------------------------
+//What a connection did over a stretch of time. The counts cover the whole stretch, the queue depths, round trip and loss are as of its end.
+struct NetTelemetrySample
+{
+    //CONSTRUCTORS/////////////////////////////////////////////////////////////////////
+    NetTelemetrySample() { Clear(); };
+
+    //FUNCTIONS/////////////////////////////////////////////////////////////////////
+    void Clear();
+    void ClearCounts(); //Leaves the queue depths, round trip and loss as they were
+    void Accumulate(const NetTelemetrySample& other); //Adds the counts and takes the other sample's gauges
+
+    //MEMBER VARIABLES/////////////////////////////////////////////////////////////////////
+    uint64_t numBytesSent; //Packets as they went on the wire, after compression
+    uint64_t numBytesReceived;
+    uint32_t numPacketsSent;
+    uint32_t numPacketsReceived;
+    uint32_t numPacketsLost; //Ours that slid past the other side's ack report unconfirmed
+    uint32_t numResends; //Reliables sent again after their retransmit timeout
+    uint32_t numDuplicates; //Reliables that arrived after we'd already processed them, and packets we'd already seen
+    uint32_t numOutOfOrder; //Packets that arrived after a newer one
+    uint32_t numUnsentReliables; //New reliables and fragments waiting for send budget or reliable ids
+    uint32_t numUnconfirmedReliables; //Sent, not yet known to have arrived
+    float roundTripMs;
+    float lossRate; //From the send rate controller, over its last round trip
+    float durationMs; //At least INTERVAL_MS, longer if ticks were far apart
+};
+
+//-----------------------------------------------------------------------------------
+//Counters for one connection, plus a ring of the last HISTORY_LENGTH intervals so it's possible to tell after the fact whether bandwidth,
+//resends or queues went first when a connection went bad. Everything is fixed size and lives inside the connection, so counting never allocates.
+class NetConnectionTelemetry
+{
+public:
+    //CONSTRUCTORS/////////////////////////////////////////////////////////////////////
+    NetConnectionTelemetry();
+
+    //FUNCTIONS/////////////////////////////////////////////////////////////////////
+    inline void OnPacketSent(size_t numBytes) { ++m_current.numPacketsSent; m_current.numBytesSent += numBytes; };
+    inline void OnPacketReceived(size_t numBytes) { ++m_current.numPacketsReceived; m_current.numBytesReceived += numBytes; };
+    inline void OnPacketLost() { ++m_current.numPacketsLost; };
+    inline void OnResend() { ++m_current.numResends; };
+    inline void OnDuplicate() { ++m_current.numDuplicates; };
+    inline void OnOutOfOrder() { ++m_current.numOutOfOrder; };
+    void Update(double nowMs, uint32_t numUnsentReliables, uint32_t numUnconfirmedReliables, float roundTripMs, float lossRate); //Once a tick, closes the interval into the history when it's due
+
+    //GETTERS/////////////////////////////////////////////////////////////////////
+    inline const NetTelemetrySample& GetTotals() const { return m_totals; }; //Since the connection was made, up to the last closed interval
+    inline const NetTelemetrySample& GetCurrent() const { return m_current; }; //The interval still being counted, its gauges are the latest
+    inline uint32_t GetNumResends() const { return m_totals.numResends + m_current.numResends; }; //Since the connection was made
+    inline unsigned int GetNumHistorySamples() const { return m_numHistorySamples; };
+    const NetTelemetrySample& GetHistorySample(unsigned int age) const; //0 is the most recently closed interval
+    float GetBytesPerSecondSent(unsigned int age = 0) const;
+    float GetBytesPerSecondReceived(unsigned int age = 0) const;
+
+    //CONSTANTS/////////////////////////////////////////////////////////////////////
+    static const unsigned int INTERVAL_MS = 1000;
+    static const unsigned int HISTORY_LENGTH = 60;
+
+private:
+    //MEMBER VARIABLES/////////////////////////////////////////////////////////////////////
+    NetTelemetrySample m_current;
+    NetTelemetrySample m_totals;
+    NetTelemetrySample m_history[HISTORY_LENGTH];
+    unsigned int m_nextHistoryIndex;
+    unsigned int m_numHistorySamples;
+    double m_intervalStartMs; //Negative until the first update
+};
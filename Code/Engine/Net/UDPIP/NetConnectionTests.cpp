@@ -0,0 +1,1098 @@
+#include "Engine/Net/UDPIP/NetConnection.hpp"
+#include "Engine/Net/UDPIP/NetSession.hpp"
+#include "Engine/Net/UDPIP/NetMessage.hpp"
+#include "Engine/Net/UDPIP/NetPacket.hpp"
+#include "Engine/Net/UDPIP/PacketCompressor.hpp"
+#include "Engine/Net/UDPIP/NetSimulator.hpp"
+#include "Engine/Net/UDPIP/NetTests.hpp"
+#include "Engine/Time/Time.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include <vector>
+
+//TESTS/////////////////////////////////////////////////////////////////////
+//Two connections in the same process talking over a NetSimulator, stepped one millisecond at a time on the session's manual clock.
+//Every run builds a session of its own with the core messages and the test's types registered, and throws it away afterwards.
+//Everything random comes from the seed, so a failing run can be replayed exactly.
+
+//-----------------------------------------------------------------------------------
+struct SimulatedLinkSettings
+{
+    SimulatedLinkSettings()
+        : minLatencyMs(0)
+        , sendIntervalMs(1)
+        , expectedRoundTripMs(0.0f)
+        , bottleneckBytesPerSecond(0.0f)
+        , bottleneckQueueBytes(0)
+        , unreliablesPerTick(0)
+        , unreliablePayloadBytes(0)
+        , isCongestionControlled(false)
+        , isInOrder(false)
+        , compressor(nullptr)
+        , recording(nullptr)
+    {};
+
+    unsigned int numMessages;
+    unsigned int messagesPerTick;
+    float lossRate;
+    float duplicateRate;
+    unsigned int minLatencyMs; //Like PacketChannel's simulated lag range, each packet takes 1 + minLatencyMs + [0, maxJitterMs] to arrive
+    unsigned int maxJitterMs; //The spread is what reorders them
+    unsigned int sendIntervalMs; //Both ends send a packet every this many ms, the link is still stepped every ms
+    float expectedRoundTripMs; //If non-zero, track how long the sender's round trip estimate takes to settle near this
+    float bottleneckBytesPerSecond; //If non-zero, packets (plus UDP/IP headers) queue to go through at this rate before their latency starts
+    unsigned int bottleneckQueueBytes; //Packets arriving to a queue this full are dropped, like a router's buffer
+    unsigned int unreliablesPerTick; //Filler the sender queues every send, alternating between a high and a low priority type
+    unsigned int unreliablePayloadBytes;
+    bool isCongestionControlled; //Off by default, so the other tests measure reliability without the send rate in the way
+    bool isInOrder; //The test messages are reliable either way
+    const PacketCompressor* compressor; //If set both ends compress with it, as if they'd agreed on it when joining
+    std::vector<unsigned char>* recording; //If set, gets the first packets the run builds, as nsrecord would record them
+    uint32_t seed;
+};
+
+//-----------------------------------------------------------------------------------
+struct SimulatedLinkResults
+{
+    unsigned int numDelivered;
+    unsigned int numDuplicatesProcessed;
+    unsigned int numProcessedOutOfOrder;
+    unsigned int numPacketsReordered;
+    unsigned int numRedundantReliables; //Reliables that arrived after already being processed, i.e. resends that weren't needed
+    unsigned int maxLiveReliableRange;
+    unsigned int numTicks;
+    unsigned int numPacketsSent;
+    unsigned int roundTripSettledMs; //When the sender's estimate first came within tolerance of the expected round trip, 0 if it never did
+    float roundTripMeanMs; //Sender's round trip estimate averaged over every ms after it settled
+    float roundTripTimeMs; //Sender's estimates when the run finished
+    float roundTripVarianceMs;
+    float retransmitTimeoutMs;
+    unsigned int numBottleneckDrops;
+    unsigned int numUndecodablePackets; //Compressed packets the receiving end couldn't decompress
+    size_t numBytesBeforeCompression; //Sender's packets, as built and as they went out
+    size_t numBytesAfterCompression;
+    double totalLatencyMs; //From queueing each test message to the receiver processing it
+    unsigned int maxLatencyMs;
+    unsigned int numUnreliablesSent[2]; //Low, high priority
+    unsigned int numUnreliablesDelivered[2];
+    unsigned int numStaleUnreliablesDropped;
+    float sendRateBytesPerSecond; //Sender's rate when the run finished
+    unsigned int numSendRateBackoffs;
+    double seconds;
+};
+
+//-----------------------------------------------------------------------------------
+//The tests' own types, registered after the core messages on each run's session. Filler for the unreliable traffic alternates between the
+//low and high priority types, and the priority test has a type per class, the offset from the first being its class.
+static const uint8_t SIMULATED_RELIABLE_TYPE = (uint8_t)NetMessage::NUM_MESSAGES;
+static const uint8_t SIMULATED_INORDER_TYPE = SIMULATED_RELIABLE_TYPE + 1;
+static const uint8_t SIMULATED_LOW_PRIORITY_TYPE = SIMULATED_RELIABLE_TYPE + 2;
+static const uint8_t SIMULATED_HIGH_PRIORITY_TYPE = SIMULATED_RELIABLE_TYPE + 3;
+static const uint8_t SIMULATED_LARGE_MESSAGE_TYPE = SIMULATED_RELIABLE_TYPE + 4;
+static const uint8_t SIMULATED_PRIORITY_BASE_TYPE = SIMULATED_RELIABLE_TYPE + 5;
+
+//-----------------------------------------------------------------------------------
+//Both ways between the two connections, each an endpoint on the simulator with the link settings as its default
+struct SimulatedLink
+{
+    SimulatedLink(const SimulatedLinkSettings& settings);
+
+    NetSimulator simulator;
+    sockaddr_in senderAddress;
+    sockaddr_in receiverAddress;
+};
+
+//-----------------------------------------------------------------------------------
+//Where the test message callback records what the receiving connection handed to the game
+struct SimulatedLinkRecorder
+{
+    std::vector<uint8_t> timesProcessed;
+    uint32_t nextInOrderId;
+    SimulatedLinkResults* results;
+};
+static SimulatedLinkRecorder* s_simulatedLinkRecorder = nullptr;
+
+//-----------------------------------------------------------------------------------
+static inline uint32_t NextSimulatedRandom(uint32_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+//-----------------------------------------------------------------------------------
+//Payloads carry the test id the message was sent with, then when it was queued.
+static void OnSimulatedLinkMessage(const NetSender& from, NetMessage& msg)
+{
+    SimulatedLinkRecorder& recorder = *s_simulatedLinkRecorder;
+    uint32_t testId;
+    uint32_t queuedTimeMs;
+    memcpy(&testId, msg.m_msgBuffer, sizeof(testId));
+    memcpy(&queuedTimeMs, msg.m_msgBuffer + sizeof(testId), sizeof(queuedTimeMs));
+    if (testId >= recorder.timesProcessed.size())
+    {
+        return;
+    }
+    uint8_t& count = recorder.timesProcessed[testId];
+    if (count == 0)
+    {
+        uint32_t latencyMs = (uint32_t)from.session->GetNetTimeMilliseconds() - queuedTimeMs;
+        recorder.results->totalLatencyMs += (double)latencyMs;
+        recorder.results->maxLatencyMs = Max<unsigned int>(recorder.results->maxLatencyMs, latencyMs);
+    }
+    recorder.results->numDelivered += (count == 0) ? 1 : 0;
+    recorder.results->numDuplicatesProcessed += (count == 0) ? 0 : 1;
+    count = (uint8_t)Min<int>(count + 1, 255);
+    if (msg.IsInOrder(*from.session))
+    {
+        recorder.results->numProcessedOutOfOrder += (testId == recorder.nextInOrderId) ? 0 : 1;
+        recorder.nextInOrderId = testId + 1;
+    }
+}
+
+//-----------------------------------------------------------------------------------
+static void OnSimulatedLinkUnreliable(const NetSender& from, NetMessage& msg)
+{
+    UNUSED(from);
+    ++s_simulatedLinkRecorder->results->numUnreliablesDelivered[msg.m_type == SIMULATED_HIGH_PRIORITY_TYPE ? 1 : 0];
+}
+
+//-----------------------------------------------------------------------------------
+//A session that's only a definition table, message pool, reassembly buffers and manual clock for the run's two connections. It never starts.
+static NetSession* CreateSimulatedLinkSession(const SimulatedLinkSettings& settings)
+{
+    NetSession* session = new NetSession(1.0f / 60.0f);
+    session->RegisterCoreMessages();
+    session->m_isCongestionControlEnabled = settings.isCongestionControlled;
+    session->m_manualClockMs = 0.0;
+    if (settings.compressor != nullptr)
+    {
+        session->m_packetCompressor = *settings.compressor;
+    }
+    return session;
+}
+
+//-----------------------------------------------------------------------------------
+SimulatedLink::SimulatedLink(const SimulatedLinkSettings& settings)
+    : simulator(settings.seed)
+{
+    NetSimulatorLinkSettings link;
+    link.minLatencyMs = 1 + settings.minLatencyMs;
+    link.jitterMs = settings.maxJitterMs;
+    link.lossRate = settings.lossRate;
+    link.duplicateRate = settings.duplicateRate;
+    link.bottleneckBytesPerSecond = settings.bottleneckBytesPerSecond;
+    link.bottleneckQueueBytes = settings.bottleneckQueueBytes;
+    simulator.SetDefaultLinkSettings(link);
+    senderAddress = simulator.AddEndpoint(1);
+    receiverAddress = simulator.AddEndpoint(2);
+}
+
+//-----------------------------------------------------------------------------------
+static void SendOverSimulatedLink(NetConnection& from, NetSimulator& simulator, const sockaddr_in& fromAddress, const sockaddr_in& toAddress, NetPacket& scratch)
+{
+    from.ConstructPacket(scratch);
+    UDPDatagram datagram;
+    datagram.address = toAddress;
+    datagram.buffer = scratch.m_buffer;
+    datagram.size = scratch.GetTotalReadableBytes();
+    simulator.Send(fromAddress, &datagram, 1);
+}
+
+//-----------------------------------------------------------------------------------
+//Mirrors NetSession::ProcessIncomingPacket for a packet that came from a known connection
+static void DeliverSimulatedLink(NetConnection& to, NetSimulator& simulator, const sockaddr_in& toAddress, NetPacket& scratch, SimulatedLinkResults& results)
+{
+    NetSender from;
+    from.session = to.m_session;
+    from.connection = &to;
+    NetMessage msg;
+    UDPDatagram datagram;
+    datagram.buffer = scratch.m_buffer;
+    while (simulator.Receive(toAddress, &datagram, 1) == 1)
+    {
+        scratch.Reset(NetPacket::INVALID_CONNECTION_INDEX);
+        scratch.SetReadableBytes(datagram.size);
+        scratch.m_arrivalTimeMs = simulator.GetTimeMilliseconds();
+        if (!scratch.Decompress(to.m_session->m_packetCompressor))
+        {
+            ++results.numUndecodablePackets;
+            continue;
+        }
+        scratch.ReadHeader();
+        uint16_t acksBehind = to.GetMostRecentConfirmedAck() - scratch.m_header.ack;
+        results.numPacketsReordered += (acksBehind != 0 && acksBehind < 0x8000) ? 1 : 0;
+        for (uint8_t messageIndex = 0; messageIndex < scratch.m_header.messageCount; ++messageIndex)
+        {
+            scratch.ReadMessage(msg);
+            if (to.CanProcessMessage(msg))
+            {
+                to.ProcessMessage(from, msg);
+            }
+            else
+            {
+                results.numRedundantReliables += msg.IsReliable(*to.m_session) ? 1 : 0;
+            }
+        }
+        to.MarkPacketReceived(scratch);
+    }
+}
+
+//-----------------------------------------------------------------------------------
+//Moves the link on a millisecond, has both ends send a packet if it's a send tick, then hands each end whatever has arrived for it
+static void StepSimulatedLink(SimulatedLink& link, NetConnection& sender, NetConnection& receiver, bool isSendTick, NetPacket& scratch, SimulatedLinkResults& results)
+{
+    link.simulator.AdvanceTime(1.0);
+    if (isSendTick)
+    {
+        SendOverSimulatedLink(sender, link.simulator, link.senderAddress, link.receiverAddress, scratch);
+        SendOverSimulatedLink(receiver, link.simulator, link.receiverAddress, link.senderAddress, scratch);
+    }
+    DeliverSimulatedLink(receiver, link.simulator, link.receiverAddress, scratch, results);
+    DeliverSimulatedLink(sender, link.simulator, link.senderAddress, scratch, results);
+    results.numBottleneckDrops = link.simulator.GetStats().numBottleneckDrops;
+}
+
+//-----------------------------------------------------------------------------------
+//Sends settings.numMessages messages tagged 0..n-1 from one connection to another and runs until they've all been processed (or it gives up)
+static void RunSimulatedLink(const SimulatedLinkSettings& settings, SimulatedLinkResults& results)
+{
+    NetSession* session = CreateSimulatedLinkSession(settings);
+    session->RegisterMessage(SIMULATED_RELIABLE_TYPE, "simreliable", &OnSimulatedLinkMessage, (uint32_t)NetMessage::Option::RELIABLE, (uint32_t)NetMessage::Control::NONE);
+    session->RegisterMessage(SIMULATED_INORDER_TYPE, "siminorder", &OnSimulatedLinkMessage, (uint32_t)NetMessage::Option::RELIABLE | (uint32_t)NetMessage::Option::INORDER, (uint32_t)NetMessage::Control::NONE);
+    session->RegisterMessage(SIMULATED_LOW_PRIORITY_TYPE, "simlow", &OnSimulatedLinkUnreliable, (uint32_t)NetMessage::Option::UNRELIABLE, (uint32_t)NetMessage::Control::NONE);
+    session->RegisterMessage(SIMULATED_HIGH_PRIORITY_TYPE, "simhigh", &OnSimulatedLinkUnreliable, (uint32_t)NetMessage::Option::UNRELIABLE, (uint32_t)NetMessage::Control::NONE, 1);
+    if (settings.recording != nullptr)
+    {
+        session->StartRecordingPackets(4096, "");
+    }
+
+    memset(&results, 0, sizeof(results));
+    SimulatedLinkRecorder recorder;
+    recorder.timesProcessed.resize(settings.numMessages, 0);
+    recorder.nextInOrderId = 0;
+    recorder.results = &results;
+    s_simulatedLinkRecorder = &recorder;
+
+    {
+        char senderGuid[NetConnection::MAX_GUID_LENGTH] = "simsender";
+        char receiverGuid[NetConnection::MAX_GUID_LENGTH] = "simreceiver";
+        NetConnection sender(NetSession::INVALID_CONNECTION_INDEX, senderGuid, session->GetAddress(), session);
+        NetConnection receiver(NetSession::INVALID_CONNECTION_INDEX, receiverGuid, session->GetAddress(), session);
+        sender.m_compressionId = (settings.compressor != nullptr) ? session->m_packetCompressor.GetId() : 0;
+        receiver.m_compressionId = sender.m_compressionId;
+        SimulatedLink link(settings);
+        NetPacket scratch;
+        NetMessage msg(settings.isInOrder ? SIMULATED_INORDER_TYPE : SIMULATED_RELIABLE_TYPE);
+        uint32_t testId = 0;
+        msg.Write<uint32_t>(testId);
+        msg.Write<uint32_t>(0);
+        NetMessage unreliables[2] = { NetMessage(SIMULATED_LOW_PRIORITY_TYPE), NetMessage(SIMULATED_HIGH_PRIORITY_TYPE) };
+        for (NetMessage& unreliable : unreliables)
+        {
+            unreliable.SetReadableBytes(Min<unsigned int>(settings.unreliablePayloadBytes, MESSAGE_MTU));
+        }
+
+        unsigned int sendIntervalMs = Max<unsigned int>(settings.sendIntervalMs, 1);
+        //Past RELIABLE_WINDOW_SIZE in flight the sender waits on the oldest id, which over a bad enough link can take several resend timeouts,
+        //so allow a second of simulated time per window's worth of messages on top of what the send rate needs
+        unsigned int maxTicks = (((settings.numMessages / settings.messagesPerTick) * 4) + ((settings.numMessages / NetConnection::RELIABLE_WINDOW_SIZE) * 1000) + 20000) * sendIntervalMs;
+        float roundTripToleranceMs = (settings.expectedRoundTripMs * 0.1f) + 2.0f;
+        double roundTripSumMs = 0.0;
+        double startSeconds = GetCurrentTimeSeconds();
+        for (uint32_t nowMs = 1; results.numDelivered < settings.numMessages && results.numTicks < maxTicks; ++nowMs)
+        {
+            session->m_manualClockMs = (double)nowMs;
+            bool isSendTick = (nowMs % sendIntervalMs) == 0;
+            if (isSendTick)
+            {
+                for (unsigned int i = 0; i < settings.messagesPerTick && testId < settings.numMessages; ++i, ++testId)
+                {
+                    memcpy(msg.m_msgBuffer, &testId, sizeof(testId));
+                    memcpy(msg.m_msgBuffer + sizeof(testId), &nowMs, sizeof(nowMs));
+                    sender.SendMessage(msg);
+                }
+                for (unsigned int i = 0; i < settings.unreliablesPerTick; ++i)
+                {
+                    sender.SendMessage(unreliables[i % 2]);
+                    ++results.numUnreliablesSent[i % 2];
+                }
+                results.numPacketsSent += 2;
+            }
+            StepSimulatedLink(link, sender, receiver, isSendTick, scratch, results);
+            results.maxLiveReliableRange = Max<unsigned int>(results.maxLiveReliableRange, sender.GetLiveReliableRange());
+            if (settings.expectedRoundTripMs > 0.0f && results.roundTripSettledMs == 0 && sender.HasRoundTripSample() && fabsf(sender.GetRoundTripTimeMs() - settings.expectedRoundTripMs) <= roundTripToleranceMs)
+            {
+                results.roundTripSettledMs = nowMs;
+            }
+            roundTripSumMs += (results.roundTripSettledMs != 0) ? sender.GetRoundTripTimeMs() : 0.0f;
+            ++results.numTicks;
+        }
+        results.seconds = GetCurrentTimeSeconds() - startSeconds;
+        results.roundTripMeanMs = (results.roundTripSettledMs != 0) ? (float)(roundTripSumMs / (double)(results.numTicks + 1 - results.roundTripSettledMs)) : 0.0f;
+        results.roundTripTimeMs = sender.GetRoundTripTimeMs();
+        results.roundTripVarianceMs = sender.GetRoundTripVarianceMs();
+        results.retransmitTimeoutMs = sender.GetRetransmitTimeoutMs();
+        results.numStaleUnreliablesDropped = sender.m_numStaleUnreliablesDropped;
+        results.sendRateBytesPerSecond = sender.m_sendRate.GetBytesPerSecond();
+        results.numSendRateBackoffs = sender.m_sendRate.GetNumBackoffs();
+        results.numBytesBeforeCompression = sender.m_numBytesBeforeCompression;
+        results.numBytesAfterCompression = sender.m_numBytesAfterCompression;
+    }
+
+    s_simulatedLinkRecorder = nullptr;
+    if (settings.recording != nullptr)
+    {
+        settings.recording->swap(session->m_packetRecording);
+    }
+    delete session;
+}
+
+//-----------------------------------------------------------------------------------
+//Property test across reliable id, sequence id and packet ack wraparound: every message is processed exactly once (and in order, for in-order types)
+//no matter how the link drops, duplicates and reorders packets, and the sender never has more than a window of ids in flight.
+static bool RunSimulatedLinkPropertyTest(const char* testName, int numRuns, uint32_t seed, bool isInOrder, unsigned int maxJitterMs, NetTestPrintCallback* print)
+{
+    int numFailed = 0;
+    for (int run = 0; run < numRuns; ++run)
+    {
+        //Pick this run's link from the seed. Even runs send 1 to 24 a tick and wrap reliable ids. Odd runs send 2 a tick for 70000 ticks,
+        //so acks wrap with messages in flight and reliable ids wrap twice. Past a couple a tick the window, not the send rate, decides
+        //how long a lossy link takes, so sending more a tick on the long runs only makes them outlast the tick cap.
+        uint32_t random = seed + (uint32_t)run * 7919;
+        NextSimulatedRandom(random);
+        SimulatedLinkSettings settings;
+        settings.messagesPerTick = 1 + (NextSimulatedRandom(random) % 24);
+        settings.numMessages = 70000;
+        if (run % 2 == 1)
+        {
+            settings.messagesPerTick = 2;
+            settings.numMessages = 140000;
+        }
+        settings.lossRate = (float)(NextSimulatedRandom(random) % 31) / 100.0f;
+        settings.duplicateRate = (float)(NextSimulatedRandom(random) % 11) / 100.0f;
+        settings.maxJitterMs = NextSimulatedRandom(random) % (maxJitterMs + 1);
+        settings.seed = NextSimulatedRandom(random);
+        settings.isInOrder = isInOrder;
+
+        SimulatedLinkResults results;
+        RunSimulatedLink(settings, results);
+        bool passed = results.numDelivered == settings.numMessages
+            && results.numDuplicatesProcessed == 0
+            && results.numProcessedOutOfOrder == 0
+            && results.maxLiveReliableRange <= NetConnection::RELIABLE_WINDOW_SIZE;
+        numFailed += passed ? 0 : 1;
+        print(Stringf("  %s: %7u msgs, %2u/tick, %2.0f%% loss, %2.0f%% dup, %2ums jitter -> %u delivered, %u duplicates, %u out of order, %u max in flight, %u packets each way (%u reordered)",
+            passed ? "PASS" : "FAIL",
+            settings.numMessages,
+            settings.messagesPerTick,
+            settings.lossRate * 100.0f,
+            settings.duplicateRate * 100.0f,
+            settings.maxJitterMs,
+            results.numDelivered,
+            results.numDuplicatesProcessed,
+            results.numProcessedOutOfOrder,
+            results.maxLiveReliableRange,
+            results.numTicks,
+            results.numPacketsReordered), passed ? RGBA::GREEN : RGBA::RED);
+    }
+    print(Stringf("%s: %i/%i runs passed", testName, numRuns - numFailed, numRuns), numFailed == 0 ? RGBA::GREEN : RGBA::RED);
+    return numFailed == 0;
+}
+
+//-----------------------------------------------------------------------------------
+static void PrintSimulatedLinkBenchmark(const char* title, const SimulatedLinkSettings& settings, const SimulatedLinkResults& results, NetTestPrintCallback* print)
+{
+    print(Stringf("%s, %.0f%% loss, %ums jitter, %u msgs/tick", title, settings.lossRate * 100.0f, settings.maxJitterMs, settings.messagesPerTick), RGBA::CORNFLOWER_BLUE);
+    print(Stringf("  %u/%u delivered in %u simulated ms, %u packets (%u arrived out of order), %u redundant resends", results.numDelivered, settings.numMessages, results.numTicks, results.numPacketsSent, results.numPacketsReordered, results.numRedundantReliables), RGBA::GREEN);
+    print(Stringf("  %.3f s CPU, %.0f msgs/s, %.0f ns/msg", results.seconds, (double)results.numDelivered / results.seconds, (results.seconds * 1e9) / (double)Max<unsigned int>(results.numDelivered, 1)), RGBA::GREEN);
+}
+
+//-----------------------------------------------------------------------------------
+bool RunReliableTest(int numRuns, uint32_t seed, NetTestPrintCallback* print)
+{
+    return RunSimulatedLinkPropertyTest("reliabletest", numRuns, seed, false, 24, print);
+}
+
+//-----------------------------------------------------------------------------------
+//Same properties for reliable in-order messages, with far more jitter so long runs arrive ahead of a missing message
+bool RunInOrderTest(int numRuns, uint32_t seed, NetTestPrintCallback* print)
+{
+    return RunSimulatedLinkPropertyTest("inordertest", numRuns, seed, true, 80, print);
+}
+
+//-----------------------------------------------------------------------------------
+//CPU cost of reliable bookkeeping on both ends of a lossy link. Time is simulated, so this is all sends, acks, resends and duplicate checks.
+void RunReliableBenchmark(unsigned int numMessages, float lossRate, unsigned int messagesPerTick, NetTestPrintCallback* print)
+{
+    SimulatedLinkSettings settings;
+    settings.numMessages = numMessages;
+    settings.lossRate = lossRate;
+    settings.messagesPerTick = messagesPerTick;
+    settings.duplicateRate = 0.0f;
+    settings.maxJitterMs = 4;
+    settings.seed = 12345;
+
+    SimulatedLinkResults results;
+    RunSimulatedLink(settings, results);
+    PrintSimulatedLinkBenchmark("Reliable link", settings, results, print);
+}
+
+//-----------------------------------------------------------------------------------
+//CPU cost of in-order delivery when most packets arrive out of order, so runs of messages are always waiting on a gap
+void RunInOrderBenchmark(unsigned int numMessages, unsigned int maxJitterMs, float lossRate, NetTestPrintCallback* print)
+{
+    SimulatedLinkSettings settings;
+    settings.numMessages = numMessages;
+    settings.maxJitterMs = maxJitterMs;
+    settings.lossRate = lossRate;
+    settings.messagesPerTick = 16;
+    settings.duplicateRate = 0.0f;
+    settings.seed = 12345;
+    settings.isInOrder = true;
+
+    SimulatedLinkResults results;
+    RunSimulatedLink(settings, results);
+    PrintSimulatedLinkBenchmark("In-order link", settings, results, print);
+}
+
+//-----------------------------------------------------------------------------------
+//Runs one lag range over the simulated link and checks the sender's round trip estimate converges on what the link actually does,
+//and that a lossless link resends at most 1% of its messages needlessly, first round trip included.
+bool RunRoundTripTest(unsigned int minLagMs, unsigned int maxLagMs, float lossRate, uint32_t seed, NetTestPrintCallback* print)
+{
+    SimulatedLinkSettings settings;
+    settings.numMessages = 3000;
+    settings.messagesPerTick = 1;
+    settings.lossRate = lossRate;
+    settings.duplicateRate = 0.0f;
+    settings.minLatencyMs = minLagMs;
+    settings.maxJitterMs = maxLagMs - minLagMs;
+    settings.sendIntervalMs = 16;
+    settings.seed = seed;
+    //Both ends send on the same ticks, so a packet that arrives after d ms has its ack sent back on the next send tick after that.
+    //Average that over every lag the link can pick, then add the trip back.
+    double meanOneWayMs = 1.0 + (double)minLagMs + ((double)settings.maxJitterMs * 0.5);
+    double meanAckSentMs = 0.0;
+    for (unsigned int lagMs = minLagMs; lagMs <= maxLagMs; ++lagMs)
+    {
+        meanAckSentMs += (double)((((1 + lagMs) / settings.sendIntervalMs) + 1) * settings.sendIntervalMs);
+    }
+    meanAckSentMs /= (double)(settings.maxJitterMs + 1);
+    settings.expectedRoundTripMs = (float)(meanAckSentMs + meanOneWayMs);
+
+    SimulatedLinkResults results;
+    RunSimulatedLink(settings, results);
+    //Lost acks make some resends legitimate, so only hold lossless links to the no-needless-resends bar
+    unsigned int maxRedundant = (lossRate > 0.0f) ? settings.numMessages : settings.numMessages / 100;
+    bool passed = results.numDelivered == settings.numMessages
+        && results.roundTripSettledMs != 0
+        && fabsf(results.roundTripMeanMs - settings.expectedRoundTripMs) <= (settings.expectedRoundTripMs * 0.05f) + 1.0f
+        && results.retransmitTimeoutMs >= results.roundTripTimeMs
+        && results.numRedundantReliables <= maxRedundant;
+    print(Stringf("  %s: lag %3u~%3ums, %2.0f%% loss -> expected rtt %5.1fms, estimated %5.1fms (mean %5.1fms) +-%4.1f, rto %5.1fms, settled after %5ums, %u/%u delivered, %u redundant resends",
+        passed ? "PASS" : "FAIL",
+        minLagMs,
+        maxLagMs,
+        lossRate * 100.0f,
+        settings.expectedRoundTripMs,
+        results.roundTripTimeMs,
+        results.roundTripMeanMs,
+        results.roundTripVarianceMs,
+        results.retransmitTimeoutMs,
+        results.roundTripSettledMs,
+        results.numDelivered,
+        settings.numMessages,
+        results.numRedundantReliables), passed ? RGBA::GREEN : RGBA::RED);
+    return passed;
+}
+
+//-----------------------------------------------------------------------------------
+//Round trip estimation and retransmit timeouts across a spread of simulated lag ranges, as set with setpacketlatency
+bool RunRoundTripTests(NetTestPrintCallback* print)
+{
+    const unsigned int NUM_CASES = 7;
+    const unsigned int LAG_RANGES[NUM_CASES][2] = { { 0, 0 }, { 10, 10 }, { 20, 40 }, { 50, 100 }, { 100, 150 }, { 200, 300 }, { 50, 100 } };
+    const float LOSS_RATES[NUM_CASES] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.1f };
+    unsigned int numPassed = 0;
+    for (unsigned int i = 0; i < NUM_CASES; ++i)
+    {
+        numPassed += RunRoundTripTest(LAG_RANGES[i][0], LAG_RANGES[i][1], LOSS_RATES[i], 12345 + i, print) ? 1 : 0;
+    }
+    print(Stringf("rtttest: %u/%u cases passed", numPassed, NUM_CASES), numPassed == NUM_CASES ? RGBA::GREEN : RGBA::RED);
+    return numPassed == NUM_CASES;
+}
+
+//-----------------------------------------------------------------------------------
+static void PrintCongestionResults(const char* title, const SimulatedLinkSettings& settings, const SimulatedLinkResults& results, bool passed, NetTestPrintCallback* print)
+{
+    double simulatedSeconds = (double)results.numTicks * 0.001;
+    double unreliableGoodput = (double)((results.numUnreliablesDelivered[0] + results.numUnreliablesDelivered[1]) * settings.unreliablePayloadBytes) / simulatedSeconds;
+    print(Stringf("  %s: %s: reliables %u/%u, latency mean %.0fms max %ums | unreliables high %u/%u low %u/%u, %u stale, %.1fKB/s goodput | %u bottleneck drops | rate %.1fKB/s after %u backoffs",
+        passed ? "PASS" : "FAIL",
+        title,
+        results.numDelivered,
+        settings.numMessages,
+        results.totalLatencyMs / (double)Max<unsigned int>(results.numDelivered, 1),
+        results.maxLatencyMs,
+        results.numUnreliablesDelivered[1],
+        results.numUnreliablesSent[1],
+        results.numUnreliablesDelivered[0],
+        results.numUnreliablesSent[0],
+        results.numStaleUnreliablesDropped,
+        unreliableGoodput / 1024.0,
+        results.numBottleneckDrops,
+        results.sendRateBytesPerSecond / 1024.0f,
+        results.numSendRateBackoffs), passed ? RGBA::GREEN : RGBA::RED);
+}
+
+//-----------------------------------------------------------------------------------
+//Offers more unreliable traffic than a bottleneck link can carry, alongside a trickle of reliables, with and without the send rate controller.
+//Without it the bottleneck's queue fills and everything waits behind it or gets dropped. With it the rate should settle near the bottleneck,
+//reliables should only see the link's latency plus a little queueing, and the high priority unreliables should get through ahead of the low ones.
+bool RunCongestionTest(float bottleneckBytesPerSecond, unsigned int lagMs, NetTestPrintCallback* print)
+{
+    SimulatedLinkSettings settings;
+    settings.numMessages = 1500;
+    settings.messagesPerTick = 1;
+    settings.lossRate = 0.0f;
+    settings.duplicateRate = 0.0f;
+    settings.minLatencyMs = lagMs;
+    settings.maxJitterMs = 4;
+    settings.sendIntervalMs = 16;
+    settings.bottleneckBytesPerSecond = bottleneckBytesPerSecond;
+    settings.bottleneckQueueBytes = (unsigned int)(settings.bottleneckBytesPerSecond * 0.5f); //Half a second of buffer, bloated like a home router
+    settings.unreliablePayloadBytes = 100;
+    //Offer twice what the bottleneck can carry
+    float unreliableBytesPerTick = (settings.bottleneckBytesPerSecond * 2.0f * (float)settings.sendIntervalMs * 0.001f);
+    settings.unreliablesPerTick = Max<unsigned int>((unsigned int)(unreliableBytesPerTick / (float)(settings.unreliablePayloadBytes + 7)), 2);
+    settings.seed = 12345;
+    settings.isInOrder = true;
+    print(Stringf("congestiontest: %.0fKB/s bottleneck, %ums lag, %u x %uB unreliables offered per %ums tick", settings.bottleneckBytesPerSecond / 1024.0f, settings.minLatencyMs, settings.unreliablesPerTick, settings.unreliablePayloadBytes, settings.sendIntervalMs), RGBA::CORNFLOWER_BLUE);
+
+    SimulatedLinkResults uncontrolled;
+    settings.isCongestionControlled = false;
+    RunSimulatedLink(settings, uncontrolled);
+    PrintCongestionResults("uncontrolled", settings, uncontrolled, true, print);
+
+    SimulatedLinkResults controlled;
+    settings.isCongestionControlled = true;
+    RunSimulatedLink(settings, controlled);
+    float linkLatencyMs = 1.0f + (float)settings.minLatencyMs + ((float)settings.maxJitterMs * 0.5f);
+    double meanLatencyMs = controlled.totalLatencyMs / (double)Max<unsigned int>(controlled.numDelivered, 1);
+    bool passed = controlled.numDelivered == settings.numMessages
+        && meanLatencyMs <= (double)(linkLatencyMs + 100.0f)
+        && controlled.numBottleneckDrops <= controlled.numPacketsSent / 100
+        && controlled.sendRateBytesPerSecond >= settings.bottleneckBytesPerSecond * 0.4f
+        && controlled.sendRateBytesPerSecond <= settings.bottleneckBytesPerSecond * 1.25f
+        && controlled.numUnreliablesDelivered[1] >= controlled.numUnreliablesDelivered[0];
+    PrintCongestionResults("controlled", settings, controlled, passed, print);
+    print(Stringf("congestiontest: %s", passed ? "passed" : "failed"), passed ? RGBA::GREEN : RGBA::RED);
+    return passed;
+}
+
+//-----------------------------------------------------------------------------------
+//What each class offers every send tick at a 32KB/s bottleneck. Together they're a little over twice what it carries, with the
+//bulk class alone well over it, so a class only gets through as fast as the scheduler lets it. Bulk and state scale with the bottleneck.
+struct PriorityTestTraffic
+{
+    const char* name;
+    bool isReliable;
+    unsigned int messagesPerTick;
+    unsigned int payloadBytes; //Starts with when the message was queued
+    bool scalesWithBottleneck;
+};
+static const PriorityTestTraffic PRIORITY_TEST_TRAFFIC[NetConnection::NUM_PRIORITY_CLASSES] =
+{
+    { "bulk", true, 4, 200, true },
+    { "state", false, 3, 100, true },
+    { "events", true, 1, 48, false },
+    { "input", false, 1, 16, false },
+};
+
+//-----------------------------------------------------------------------------------
+struct PriorityTestClassResults
+{
+    unsigned int numSent;
+    unsigned int numDelivered;
+    double totalLatencyMs;
+    unsigned int maxLatencyMs;
+    unsigned int maxDeliveryGapMs; //Longest stretch between deliveries, counting from the first send
+    uint32_t lastDeliveredMs;
+};
+
+//-----------------------------------------------------------------------------------
+struct PriorityTestResults
+{
+    PriorityTestClassResults classes[NetConnection::NUM_PRIORITY_CLASSES];
+    SimulatedLinkResults link;
+    unsigned int numTicks;
+};
+static PriorityTestResults* s_priorityTestResults = nullptr;
+
+//-----------------------------------------------------------------------------------
+static void OnPriorityTestMessage(const NetSender& from, NetMessage& msg)
+{
+    uint32_t queuedTimeMs;
+    memcpy(&queuedTimeMs, msg.m_msgBuffer, sizeof(queuedTimeMs));
+    uint32_t nowMs = (uint32_t)from.session->GetNetTimeMilliseconds();
+    PriorityTestClassResults& results = s_priorityTestResults->classes[msg.m_type - SIMULATED_PRIORITY_BASE_TYPE];
+    results.totalLatencyMs += (double)(nowMs - queuedTimeMs);
+    results.maxLatencyMs = Max<unsigned int>(results.maxLatencyMs, nowMs - queuedTimeMs);
+    results.maxDeliveryGapMs = Max<unsigned int>(results.maxDeliveryGapMs, nowMs - results.lastDeliveredMs);
+    results.lastDeliveredMs = nowMs;
+    ++results.numDelivered;
+}
+
+//-----------------------------------------------------------------------------------
+//Offers PRIORITY_TEST_TRAFFIC for offerMs over a congestion controlled bottleneck, then keeps the link running until every reliable has
+//arrived. Without priority classes every type is in the lowest class, which drains the queues in a fixed order like it used to.
+static void RunPriorityTraffic(const SimulatedLinkSettings& settings, unsigned int offerMs, bool usePriorityClasses, PriorityTestResults& results)
+{
+    NetSession* session = CreateSimulatedLinkSession(settings);
+    for (unsigned int priorityClass = 0; priorityClass < NetConnection::NUM_PRIORITY_CLASSES; ++priorityClass)
+    {
+        const PriorityTestTraffic& traffic = PRIORITY_TEST_TRAFFIC[priorityClass];
+        uint32_t optionFlags = (uint32_t)(traffic.isReliable ? NetMessage::Option::RELIABLE : NetMessage::Option::UNRELIABLE);
+        session->RegisterMessage((uint8_t)(SIMULATED_PRIORITY_BASE_TYPE + priorityClass), traffic.name, &OnPriorityTestMessage, optionFlags, (uint32_t)NetMessage::Control::NONE, usePriorityClasses ? (uint8_t)priorityClass : 0);
+    }
+    memset(&results, 0, sizeof(results));
+    s_priorityTestResults = &results;
+
+    {
+        char senderGuid[NetConnection::MAX_GUID_LENGTH] = "prisender";
+        char receiverGuid[NetConnection::MAX_GUID_LENGTH] = "prireceiver";
+        NetConnection sender(NetSession::INVALID_CONNECTION_INDEX, senderGuid, session->GetAddress(), session);
+        NetConnection receiver(NetSession::INVALID_CONNECTION_INDEX, receiverGuid, session->GetAddress(), session);
+        SimulatedLink link(settings);
+        NetPacket scratch;
+        NetMessage messages[NetConnection::NUM_PRIORITY_CLASSES];
+        unsigned int messagesPerTick[NetConnection::NUM_PRIORITY_CLASSES];
+        for (unsigned int priorityClass = 0; priorityClass < NetConnection::NUM_PRIORITY_CLASSES; ++priorityClass)
+        {
+            const PriorityTestTraffic& traffic = PRIORITY_TEST_TRAFFIC[priorityClass];
+            float scale = traffic.scalesWithBottleneck ? settings.bottleneckBytesPerSecond / (32.0f * 1024.0f) : 1.0f;
+            messagesPerTick[priorityClass] = Max<unsigned int>((unsigned int)((float)traffic.messagesPerTick * scale + 0.5f), 1);
+            messages[priorityClass].m_type = (uint8_t)(SIMULATED_PRIORITY_BASE_TYPE + priorityClass);
+            messages[priorityClass].SetReadableBytes(traffic.payloadBytes);
+            memset(messages[priorityClass].m_msgBuffer, 0, traffic.payloadBytes);
+        }
+
+        unsigned int sendIntervalMs = Max<unsigned int>(settings.sendIntervalMs, 1);
+        unsigned int maxMs = offerMs + 120000;
+        bool isFinished = false;
+        for (uint32_t nowMs = 1; nowMs <= maxMs && !isFinished; ++nowMs)
+        {
+            session->m_manualClockMs = (double)nowMs;
+            bool isSendTick = (nowMs % sendIntervalMs) == 0;
+            for (unsigned int priorityClass = 0; isSendTick && priorityClass < NetConnection::NUM_PRIORITY_CLASSES && nowMs <= offerMs; ++priorityClass)
+            {
+                memcpy(messages[priorityClass].m_msgBuffer, &nowMs, sizeof(nowMs));
+                for (unsigned int i = 0; i < messagesPerTick[priorityClass]; ++i)
+                {
+                    sender.SendMessage(messages[priorityClass]);
+                    ++results.classes[priorityClass].numSent;
+                }
+            }
+            StepSimulatedLink(link, sender, receiver, isSendTick, scratch, results.link);
+            ++results.numTicks;
+
+            //Unreliables still waiting are stale well within a second of the traffic stopping
+            isFinished = nowMs > offerMs + 1000;
+            for (unsigned int priorityClass = 0; priorityClass < NetConnection::NUM_PRIORITY_CLASSES; ++priorityClass)
+            {
+                const PriorityTestClassResults& classResults = results.classes[priorityClass];
+                isFinished = isFinished && (!PRIORITY_TEST_TRAFFIC[priorityClass].isReliable || classResults.numDelivered >= classResults.numSent);
+            }
+        }
+    }
+
+    s_priorityTestResults = nullptr;
+    delete session;
+}
+
+//-----------------------------------------------------------------------------------
+static void PrintPriorityTestResults(const char* title, const PriorityTestResults& results, NetTestPrintCallback* print)
+{
+    for (unsigned int priorityClass = NetConnection::NUM_PRIORITY_CLASSES; priorityClass-- > 0;)
+    {
+        const PriorityTestClassResults& classResults = results.classes[priorityClass];
+        print(Stringf("  %-16s %-6s (%s): %5u/%5u delivered, latency mean %6.0fms max %6ums, longest gap %5ums"
+            , (priorityClass == NetConnection::NUM_PRIORITY_CLASSES - 1) ? title : ""
+            , PRIORITY_TEST_TRAFFIC[priorityClass].name
+            , PRIORITY_TEST_TRAFFIC[priorityClass].isReliable ? "reliable  " : "unreliable"
+            , classResults.numDelivered
+            , classResults.numSent
+            , classResults.totalLatencyMs / (double)Max<unsigned int>(classResults.numDelivered, 1)
+            , classResults.maxLatencyMs
+            , classResults.maxDeliveryGapMs), RGBA::CORNFLOWER_BLUE);
+    }
+}
+
+//-----------------------------------------------------------------------------------
+//Saturates a bottleneck link with four classes of traffic, from a small trickle of input up to far more bulk data than fits, and measures
+//each class's latency with and without priority classes. With them, input should arrive about as fast as the link allows and events well
+//ahead of bulk, while bulk keeps moving instead of being starved by everything above it.
+bool RunPriorityTest(float bottleneckBytesPerSecond, unsigned int lagMs, NetTestPrintCallback* print)
+{
+    SimulatedLinkSettings settings;
+    settings.numMessages = 0;
+    settings.messagesPerTick = 0;
+    settings.lossRate = 0.0f;
+    settings.duplicateRate = 0.0f;
+    settings.minLatencyMs = lagMs;
+    settings.maxJitterMs = 4;
+    settings.sendIntervalMs = 16;
+    settings.bottleneckBytesPerSecond = bottleneckBytesPerSecond;
+    settings.bottleneckQueueBytes = (unsigned int)(settings.bottleneckBytesPerSecond * 0.5f);
+    settings.isCongestionControlled = true;
+    settings.seed = 12345;
+    const unsigned int OFFER_MS = 10000;
+    print(Stringf("prioritytest: %.0fKB/s bottleneck, %ums lag, traffic offered for %ums", settings.bottleneckBytesPerSecond / 1024.0f, settings.minLatencyMs, OFFER_MS), RGBA::CORNFLOWER_BLUE);
+
+    PriorityTestResults fixedOrder;
+    RunPriorityTraffic(settings, OFFER_MS, false, fixedOrder);
+    PrintPriorityTestResults("one class:", fixedOrder, print);
+    PriorityTestResults prioritized;
+    RunPriorityTraffic(settings, OFFER_MS, true, prioritized);
+    PrintPriorityTestResults("priority classes:", prioritized, print);
+
+    const PriorityTestClassResults& bulk = prioritized.classes[0];
+    const PriorityTestClassResults& state = prioritized.classes[1];
+    const PriorityTestClassResults& events = prioritized.classes[2];
+    const PriorityTestClassResults& input = prioritized.classes[3];
+    double bulkMeanMs = bulk.totalLatencyMs / (double)Max<unsigned int>(bulk.numDelivered, 1);
+    double eventsMeanMs = events.totalLatencyMs / (double)Max<unsigned int>(events.numDelivered, 1);
+    double inputMeanMs = input.totalLatencyMs / (double)Max<unsigned int>(input.numDelivered, 1);
+    double fixedOrderEventsMeanMs = fixedOrder.classes[2].totalLatencyMs / (double)Max<unsigned int>(fixedOrder.classes[2].numDelivered, 1);
+    double fixedOrderInputMeanMs = fixedOrder.classes[3].totalLatencyMs / (double)Max<unsigned int>(fixedOrder.classes[3].numDelivered, 1);
+    //Slower links spread the same aging over fewer packets, so allow bulk proportionally longer between deliveries
+    unsigned int maxBulkGapMs = (unsigned int)(500.0f * Max<float>(32.0f * 1024.0f / settings.bottleneckBytesPerSecond, 1.0f)) + settings.minLatencyMs;
+    const unsigned int NUM_CHECKS = 6;
+    bool checks[NUM_CHECKS] =
+    {
+        events.numDelivered == events.numSent && bulk.numDelivered == bulk.numSent,
+        input.numDelivered * 10 >= input.numSent * 9,
+        inputMeanMs <= eventsMeanMs && eventsMeanMs * 4.0 <= bulkMeanMs,
+        eventsMeanMs * 4.0 <= fixedOrderEventsMeanMs && inputMeanMs <= fixedOrderInputMeanMs,
+        state.numDelivered >= fixedOrder.classes[1].numDelivered,
+        bulk.maxDeliveryGapMs <= maxBulkGapMs,
+    };
+    const char* CHECK_NAMES[NUM_CHECKS] =
+    {
+        "every reliable delivered",
+        "at least 90% of input delivered",
+        "higher classes see lower latency",
+        "events and input faster than with one class",
+        "state delivered at least as often as with one class",
+        "bulk never starved",
+    };
+    unsigned int numPassed = 0;
+    for (unsigned int i = 0; i < NUM_CHECKS; ++i)
+    {
+        print(Stringf("  %s: %s", checks[i] ? "PASS" : "FAIL", CHECK_NAMES[i]), checks[i] ? RGBA::GREEN : RGBA::RED);
+        numPassed += checks[i] ? 1 : 0;
+    }
+    print(Stringf("prioritytest: %u/%u checks passed", numPassed, NUM_CHECKS), numPassed == NUM_CHECKS ? RGBA::GREEN : RGBA::RED);
+    return numPassed == NUM_CHECKS;
+}
+
+//-----------------------------------------------------------------------------------
+struct FragmentTestResults
+{
+    unsigned int numDelivered;
+    unsigned int numDuplicates;
+    unsigned int numCorrupt; //Wrong size or contents for the index they claim
+    unsigned int numTicks;
+    unsigned int numPacketsSent; //By the sender
+    unsigned int maxReassemblyBuffersInUse;
+    unsigned int maxLiveReliableRange;
+    size_t numBytesDelivered;
+    double seconds;
+};
+
+//-----------------------------------------------------------------------------------
+struct FragmentTestRecorder
+{
+    std::vector<uint8_t> timesDelivered;
+    uint32_t seed;
+    FragmentTestResults* results;
+};
+static FragmentTestRecorder* s_fragmentTestRecorder = nullptr;
+
+//-----------------------------------------------------------------------------------
+//Every eighth message is as large as they get and the next is as small as the index allows, the rest are anywhere up to 32KB
+static size_t GetFragmentTestMessageSize(uint32_t index, uint32_t seed)
+{
+    uint32_t random = (seed ^ (index * 2654435761u)) | 1;
+    NextSimulatedRandom(random);
+    switch (index % 8)
+    {
+    case 0:
+        return NetConnection::MAX_LARGE_MESSAGE_BYTES;
+    case 1:
+        return sizeof(uint32_t);
+    default:
+        return sizeof(uint32_t) + (NextSimulatedRandom(random) % (32 * 1024));
+    }
+}
+
+//-----------------------------------------------------------------------------------
+//[uint32 index][bytes that depend on the index and position], so the receiver can check every byte without a copy of what was sent
+static inline byte GetFragmentTestByte(uint32_t index, size_t position)
+{
+    return (byte)((index * 31) + (position * 7) + (position >> 9));
+}
+
+//-----------------------------------------------------------------------------------
+static void FillFragmentTestMessage(std::vector<byte>& data, uint32_t index, uint32_t seed)
+{
+    data.resize(GetFragmentTestMessageSize(index, seed));
+    memcpy(data.data(), &index, sizeof(index));
+    for (size_t i = sizeof(index); i < data.size(); ++i)
+    {
+        data[i] = GetFragmentTestByte(index, i);
+    }
+}
+
+//-----------------------------------------------------------------------------------
+static void OnFragmentTestMessage(const NetSender& from, const byte* data, size_t numBytes)
+{
+    UNUSED(from);
+    FragmentTestRecorder& recorder = *s_fragmentTestRecorder;
+    FragmentTestResults& results = *recorder.results;
+    uint32_t index = 0;
+    if (numBytes < sizeof(index))
+    {
+        ++results.numCorrupt;
+        return;
+    }
+    memcpy(&index, data, sizeof(index));
+    if (index >= recorder.timesDelivered.size() || numBytes != GetFragmentTestMessageSize(index, recorder.seed))
+    {
+        ++results.numCorrupt;
+        return;
+    }
+    for (size_t i = sizeof(index); i < numBytes; ++i)
+    {
+        if (data[i] != GetFragmentTestByte(index, i))
+        {
+            ++results.numCorrupt;
+            return;
+        }
+    }
+    uint8_t& count = recorder.timesDelivered[index];
+    results.numDelivered += (count == 0) ? 1 : 0;
+    results.numDuplicates += (count == 0) ? 0 : 1;
+    results.numBytesDelivered += (count == 0) ? numBytes : 0;
+    count = (uint8_t)Min<int>(count + 1, 255);
+}
+
+//-----------------------------------------------------------------------------------
+//Sends numMessages large messages over the simulated link, keeping up to maxQueued of them handed to the sender at once so the
+//in-flight cap is what holds them back
+static void RunFragmentLink(const SimulatedLinkSettings& settings, unsigned int maxQueued, FragmentTestResults& results)
+{
+    NetSession* session = CreateSimulatedLinkSession(settings);
+    session->RegisterLargeMessage(SIMULATED_LARGE_MESSAGE_TYPE, "simlarge", &OnFragmentTestMessage);
+
+    memset(&results, 0, sizeof(results));
+    FragmentTestRecorder recorder;
+    recorder.timesDelivered.resize(settings.numMessages, 0);
+    recorder.seed = settings.seed;
+    recorder.results = &results;
+    s_fragmentTestRecorder = &recorder;
+    unsigned int numBuffersAtStart = session->m_numReassemblyBuffers - (unsigned int)session->m_freeReassemblyBuffers.size();
+
+    {
+        char senderGuid[NetConnection::MAX_GUID_LENGTH] = "fragsender";
+        char receiverGuid[NetConnection::MAX_GUID_LENGTH] = "fragreceiver";
+        NetConnection sender(NetSession::INVALID_CONNECTION_INDEX, senderGuid, session->GetAddress(), session);
+        NetConnection receiver(NetSession::INVALID_CONNECTION_INDEX, receiverGuid, session->GetAddress(), session);
+        SimulatedLink link(settings);
+        SimulatedLinkResults linkResults;
+        memset(&linkResults, 0, sizeof(linkResults));
+        NetPacket scratch;
+        std::vector<byte> data;
+        data.reserve(NetConnection::MAX_LARGE_MESSAGE_BYTES);
+
+        uint32_t nextIndex = 0;
+        unsigned int sendIntervalMs = Max<unsigned int>(settings.sendIntervalMs, 1);
+        unsigned int maxTicks = (settings.numMessages * 2000) + 20000;
+        double startSeconds = GetCurrentTimeSeconds();
+        for (uint32_t nowMs = 1; results.numDelivered < settings.numMessages && results.numTicks < maxTicks; ++nowMs)
+        {
+            session->m_manualClockMs = (double)nowMs;
+            while (nextIndex < settings.numMessages && sender.GetNumLargeMessagesQueued() < maxQueued)
+            {
+                FillFragmentTestMessage(data, nextIndex++, settings.seed);
+                sender.SendLargeMessage(SIMULATED_LARGE_MESSAGE_TYPE, data.data(), data.size());
+            }
+            bool isSendTick = (nowMs % sendIntervalMs) == 0;
+            results.numPacketsSent += isSendTick ? 1 : 0;
+            StepSimulatedLink(link, sender, receiver, isSendTick, scratch, linkResults);
+            unsigned int buffersInUse = session->m_numReassemblyBuffers - (unsigned int)session->m_freeReassemblyBuffers.size() - numBuffersAtStart;
+            results.maxReassemblyBuffersInUse = Max<unsigned int>(results.maxReassemblyBuffersInUse, buffersInUse);
+            results.maxLiveReliableRange = Max<unsigned int>(results.maxLiveReliableRange, sender.GetLiveReliableRange());
+            ++results.numTicks;
+        }
+        results.seconds = GetCurrentTimeSeconds() - startSeconds;
+    }
+
+    s_fragmentTestRecorder = nullptr;
+    delete session;
+}
+
+//-----------------------------------------------------------------------------------
+//Every large message arrives exactly once and intact no matter how the link drops, duplicates and reorders fragments,
+//and the receiver never needs more than MAX_CONCURRENT_LARGE_MESSAGES reassembly buffers.
+bool RunFragmentTest(int numRuns, uint32_t seed, NetTestPrintCallback* print)
+{
+    int numFailed = 0;
+    for (int run = 0; run < numRuns; ++run)
+    {
+        uint32_t random = seed + (uint32_t)run * 7919;
+        NextSimulatedRandom(random);
+        SimulatedLinkSettings settings;
+        settings.numMessages = 48;
+        settings.messagesPerTick = 0;
+        settings.lossRate = (float)(NextSimulatedRandom(random) % 21) / 100.0f;
+        settings.duplicateRate = (float)(NextSimulatedRandom(random) % 11) / 100.0f;
+        settings.maxJitterMs = NextSimulatedRandom(random) % 61;
+        settings.seed = NextSimulatedRandom(random);
+
+        FragmentTestResults results;
+        RunFragmentLink(settings, 2 * NetConnection::MAX_CONCURRENT_LARGE_MESSAGES, results);
+        bool passed = results.numDelivered == settings.numMessages
+            && results.numDuplicates == 0
+            && results.numCorrupt == 0
+            && results.maxReassemblyBuffersInUse <= NetConnection::MAX_CONCURRENT_LARGE_MESSAGES
+            && results.maxLiveReliableRange <= NetConnection::RELIABLE_WINDOW_SIZE;
+        numFailed += passed ? 0 : 1;
+        print(Stringf("  %s: %u msgs (%.1fMB), %2.0f%% loss, %2.0f%% dup, %2ums jitter -> %u delivered, %u duplicates, %u corrupt, %u reassembling at most, %u simulated ms",
+            passed ? "PASS" : "FAIL",
+            settings.numMessages,
+            (double)results.numBytesDelivered / (1024.0 * 1024.0),
+            settings.lossRate * 100.0f,
+            settings.duplicateRate * 100.0f,
+            settings.maxJitterMs,
+            results.numDelivered,
+            results.numDuplicates,
+            results.numCorrupt,
+            results.maxReassemblyBuffersInUse,
+            results.numTicks), passed ? RGBA::GREEN : RGBA::RED);
+    }
+    print(Stringf("fragmenttest: %i/%i runs passed", numRuns - numFailed, numRuns), numFailed == 0 ? RGBA::GREEN : RGBA::RED);
+    return numFailed == 0;
+}
+
+//-----------------------------------------------------------------------------------
+//Throughput of large messages over the simulated link, both in simulated time (how much of each packet is payload) and CPU time
+void RunFragmentBenchmark(unsigned int numMessages, float lossRate, unsigned int sendIntervalMs, NetTestPrintCallback* print)
+{
+    SimulatedLinkSettings settings;
+    settings.numMessages = numMessages;
+    settings.lossRate = lossRate;
+    settings.sendIntervalMs = sendIntervalMs;
+    settings.messagesPerTick = 0;
+    settings.duplicateRate = 0.0f;
+    settings.minLatencyMs = 20;
+    settings.maxJitterMs = 10;
+    settings.seed = 12345;
+
+    FragmentTestResults results;
+    RunFragmentLink(settings, 2 * NetConnection::MAX_CONCURRENT_LARGE_MESSAGES, results);
+    double simulatedSeconds = (double)results.numTicks * 0.001;
+    double megabytes = (double)results.numBytesDelivered / (1024.0 * 1024.0);
+    print(Stringf("Large messages, %.0f%% loss, %u-%ums latency, a packet every %ums", settings.lossRate * 100.0f, settings.minLatencyMs + 1, settings.minLatencyMs + settings.maxJitterMs + 1, settings.sendIntervalMs), RGBA::CORNFLOWER_BLUE);
+    print(Stringf("  %u/%u delivered (%.1fMB) in %u simulated ms, %.0fKB/s, %.0f payload bytes per packet sent", results.numDelivered, settings.numMessages, megabytes, results.numTicks
+        , ((double)results.numBytesDelivered / 1024.0) / simulatedSeconds, (double)results.numBytesDelivered / (double)Max<unsigned int>(results.numPacketsSent, 1)), RGBA::GREEN);
+    print(Stringf("  %.3f s CPU, %.0f MB/s", results.seconds, megabytes / results.seconds), RGBA::GREEN);
+}
+
+//-----------------------------------------------------------------------------------
+//Trains a dictionary on one recorded run, then checks that compressed runs over a lossy, duplicating, reordering link still deliver
+//everything exactly once, that every compressed packet decodes, and that fewer bytes went out
+bool RunCompressedLinkTest(int numRuns, uint32_t seed, NetTestPrintCallback* print)
+{
+    SimulatedLinkSettings settings;
+    settings.numMessages = 4000;
+    settings.messagesPerTick = 4;
+    settings.lossRate = 0.05f;
+    settings.duplicateRate = 0.0f;
+    settings.maxJitterMs = 10;
+    settings.unreliablesPerTick = 2;
+    settings.unreliablePayloadBytes = 24;
+    settings.seed = seed;
+    std::vector<unsigned char> recording;
+    settings.recording = &recording;
+    SimulatedLinkResults results;
+    RunSimulatedLink(settings, results);
+    settings.recording = nullptr;
+    std::vector<unsigned char> dictionary;
+    PacketCompressor::TrainDictionary(recording, PacketCompressor::MAX_DICTIONARY_BYTES, dictionary);
+    PacketCompressor compressor;
+    compressor.Enable(dictionary.data(), dictionary.size());
+
+    int numFailed = 0;
+    for (int run = 0; run < numRuns; ++run)
+    {
+        uint32_t random = seed + (uint32_t)run * 7919;
+        NextSimulatedRandom(random);
+        settings.numMessages = 20000;
+        settings.messagesPerTick = 1 + (NextSimulatedRandom(random) % 16);
+        settings.lossRate = (float)(NextSimulatedRandom(random) % 21) / 100.0f;
+        settings.duplicateRate = (float)(NextSimulatedRandom(random) % 11) / 100.0f;
+        settings.maxJitterMs = NextSimulatedRandom(random) % 41;
+        settings.seed = NextSimulatedRandom(random);
+        settings.compressor = &compressor;
+        RunSimulatedLink(settings, results);
+        bool passed = results.numDelivered == settings.numMessages
+            && results.numDuplicatesProcessed == 0
+            && results.numUndecodablePackets == 0
+            && results.numBytesAfterCompression < results.numBytesBeforeCompression;
+        numFailed += passed ? 0 : 1;
+        print(Stringf("  %s: %5u msgs, %2u/tick, %2.0f%% loss, %2.0f%% dup, %2ums jitter -> %u delivered, %u duplicates, %u undecodable, %.1f%% of the uncompressed bytes",
+            passed ? "PASS" : "FAIL",
+            settings.numMessages,
+            settings.messagesPerTick,
+            settings.lossRate * 100.0f,
+            settings.duplicateRate * 100.0f,
+            settings.maxJitterMs,
+            results.numDelivered,
+            results.numDuplicatesProcessed,
+            results.numUndecodablePackets,
+            100.0 * (double)results.numBytesAfterCompression / (double)Max<size_t>(results.numBytesBeforeCompression, 1)), passed ? RGBA::GREEN : RGBA::RED);
+    }
+
+    //Far more small unreliables offered than a packet holds, so packets are always full. Filled against their compressed size they
+    //should each carry a good deal more than packets filled to the MTU.
+    settings.numMessages = 500;
+    settings.messagesPerTick = 1;
+    settings.lossRate = 0.0f;
+    settings.duplicateRate = 0.0f;
+    settings.maxJitterMs = 0;
+    settings.unreliablesPerTick = 200;
+    settings.unreliablePayloadBytes = 24;
+    settings.seed = seed;
+    SimulatedLinkResults saturatedResults[2];
+    unsigned int numUnreliablesDelivered[2];
+    for (int isCompressed = 0; isCompressed < 2; ++isCompressed)
+    {
+        settings.compressor = (isCompressed != 0) ? &compressor : nullptr;
+        RunSimulatedLink(settings, saturatedResults[isCompressed]);
+        numUnreliablesDelivered[isCompressed] = saturatedResults[isCompressed].numUnreliablesDelivered[0] + saturatedResults[isCompressed].numUnreliablesDelivered[1];
+    }
+    bool fitsMore = numUnreliablesDelivered[1] * 2 >= numUnreliablesDelivered[0] * 3 && saturatedResults[1].numUndecodablePackets == 0;
+    numFailed += fitsMore ? 0 : 1;
+    ++numRuns;
+    print(Stringf("  %s: saturated with %uB unreliables -> %.1f per packet filled to the MTU, %.1f per packet filled against its compressed size",
+        fitsMore ? "PASS" : "FAIL",
+        settings.unreliablePayloadBytes,
+        (double)numUnreliablesDelivered[0] / (double)Max<unsigned int>(saturatedResults[0].numTicks, 1),
+        (double)numUnreliablesDelivered[1] / (double)Max<unsigned int>(saturatedResults[1].numTicks, 1)), fitsMore ? RGBA::GREEN : RGBA::RED);
+
+    print(Stringf("compressedlinktest: %i/%i runs passed with a %u byte dictionary", numRuns - numFailed, numRuns, (unsigned int)dictionary.size()), numFailed == 0 ? RGBA::GREEN : RGBA::RED);
+    return numFailed == 0;
+}
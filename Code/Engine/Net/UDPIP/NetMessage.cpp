@@ -2,9 +2,10 @@
 #include "Engine/Net/UDPIP/NetSession.hpp"
 
 //-----------------------------------------------------------------------------------
+//Type, reliable id and sequence id
 size_t NetMessage::GetHeaderSize() const
 {
-    return sizeof(uint8_t) + sizeof(uint16_t);
+    return sizeof(uint8_t) + sizeof(uint16_t) + sizeof(uint16_t);
 }
 
 //-----------------------------------------------------------------------------------
@@ -16,7 +17,7 @@ size_t NetMessage::GetPayloadSize() const
 //-----------------------------------------------------------------------------------
 void NetMessage::Process(const NetSender& from)
 {
-    const NetMessageDefinition* messageDef = NetSession::instance->FindDefinition(m_type);
+    const NetMessageDefinition* messageDef = from.session->FindDefinition(m_type);
     if (messageDef != nullptr)
     {
         messageDef->callbackFunction(from, *this);
@@ -24,25 +25,25 @@ void NetMessage::Process(const NetSender& from)
 }
 
 //-----------------------------------------------------------------------------------
-bool NetMessage::IsReliable() const
+bool NetMessage::IsReliable(const NetSession& session) const
 {
-    return GetDefinition()->HasOptionFlag(Option::RELIABLE);
+    return GetDefinition(session)->HasOptionFlag(Option::RELIABLE);
 }
 
 //-----------------------------------------------------------------------------------
-const NetMessageDefinition* NetMessage::GetDefinition() const
+const NetMessageDefinition* NetMessage::GetDefinition(const NetSession& session) const
 {
-    return NetSession::instance->FindDefinition(m_type);
+    return session.FindDefinition(m_type);
 }
 
 //-----------------------------------------------------------------------------------
-bool NetMessage::RequiresConnection() const
+bool NetMessage::RequiresConnection(const NetSession& session) const
 {
-    return !GetDefinition()->HasControlFlag(NetMessage::Control::PROCESS_CONNECTIONLESS);
+    return !GetDefinition(session)->HasControlFlag(NetMessage::Control::PROCESS_CONNECTIONLESS);
 }
 
 //-----------------------------------------------------------------------------------
-bool NetMessage::IsInOrder()
+bool NetMessage::IsInOrder(const NetSession& session) const
 {
-    return GetDefinition()->HasOptionFlag(Option::INORDER);
+    return GetDefinition(session)->HasOptionFlag(Option::INORDER);
 }
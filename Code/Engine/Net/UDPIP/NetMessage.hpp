@@ -5,6 +5,7 @@
 typedef unsigned char byte;
 struct NetSender; 
 struct NetMessageDefinition;
+class NetSession;
 
 #define MESSAGE_MTU 1024
 #define BIT_FLAG(f) (1 << (f))
@@ -26,6 +27,8 @@ public:
         CONNECTION_LEAVE,
         KICK,
         QUIT,
+        SNAPSHOT,
+        FRAGMENT,
         NUM_MESSAGES
 
     };
@@ -85,11 +88,11 @@ public:
     //FUNCTIONS/////////////////////////////////////////////////////////////////////
     size_t GetHeaderSize() const;
     size_t GetPayloadSize() const;
-    void Process(const NetSender& from);
-    bool IsReliable() const;
-    const NetMessageDefinition* GetDefinition() const;
-    bool RequiresConnection() const;
-    bool IsInOrder();
+    void Process(const NetSender& from); //Through from.session's definition for this type
+    bool IsReliable(const NetSession& session) const;
+    const NetMessageDefinition* GetDefinition(const NetSession& session) const;
+    bool RequiresConnection(const NetSession& session) const;
+    bool IsInOrder(const NetSession& session) const;
 
     //MEMBER VARIABLES/////////////////////////////////////////////////////////////////////
     byte m_type;
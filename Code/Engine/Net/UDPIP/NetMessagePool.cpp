@@ -0,0 +1,112 @@
+#include "Engine/Net/UDPIP/NetMessagePool.hpp"
+#include "Engine/Net/UDPIP/NetMessage.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+
+//-----------------------------------------------------------------------------------
+void PooledNetMessage::CopyTo(NetMessage& outMessage) const
+{
+    outMessage.m_type = m_type;
+    outMessage.m_reliableId = m_reliableId;
+    outMessage.m_sequenceId = m_sequenceId;
+    outMessage.m_lastSentTimestampMs = m_lastSentTimestampMs;
+    memcpy(outMessage.m_msgBuffer, GetPayload(), m_payloadSize);
+    outMessage.SetReadableBytes(m_payloadSize);
+}
+
+//-----------------------------------------------------------------------------------
+NetMessagePool::NetMessagePool()
+    : m_numLiveMessages(0)
+    , m_numBytesReserved(0)
+{
+    for (unsigned int i = 0; i < NUM_SIZE_CLASSES; ++i)
+    {
+        m_freeLists[i] = nullptr;
+    }
+}
+
+//-----------------------------------------------------------------------------------
+NetMessagePool::~NetMessagePool()
+{
+    ASSERT_RECOVERABLE(m_numLiveMessages == 0, "Net message pool destroyed with messages still queued");
+    for (byte* chunk : m_chunks)
+    {
+        delete[] chunk;
+    }
+}
+
+//-----------------------------------------------------------------------------------
+PooledNetMessage* NetMessagePool::Alloc(const NetMessage& msg)
+{
+    size_t payloadSize = msg.GetPayloadSize();
+    ASSERT_OR_DIE(payloadSize <= MESSAGE_MTU, "Attempted to pool a message larger than the message MTU");
+    uint8_t sizeClass = GetSizeClass(payloadSize);
+    if (m_freeLists[sizeClass] == nullptr)
+    {
+        Grow(sizeClass);
+    }
+
+    PooledNetMessage* pooled = m_freeLists[sizeClass];
+    m_freeLists[sizeClass] = pooled->next;
+    pooled->next = nullptr;
+    pooled->prev = nullptr;
+    pooled->m_type = msg.m_type;
+    pooled->m_sizeClass = sizeClass;
+    pooled->m_payloadSize = (uint16_t)payloadSize;
+    pooled->m_reliableId = msg.m_reliableId;
+    pooled->m_sequenceId = msg.m_sequenceId;
+    pooled->m_priority = 0;
+    pooled->m_lastSentTimestampMs = msg.m_lastSentTimestampMs;
+    memcpy(pooled->GetPayload(), msg.m_msgBuffer, payloadSize);
+    ++m_numLiveMessages;
+    return pooled;
+}
+
+//-----------------------------------------------------------------------------------
+void NetMessagePool::Free(PooledNetMessage* msg)
+{
+    msg->next = m_freeLists[msg->m_sizeClass];
+    m_freeLists[msg->m_sizeClass] = msg;
+    --m_numLiveMessages;
+}
+
+//-----------------------------------------------------------------------------------
+uint8_t NetMessagePool::GetSizeClass(size_t payloadSize)
+{
+    uint8_t sizeClass = 0;
+    size_t classSize = MIN_PAYLOAD_CLASS_SIZE;
+    while (classSize < payloadSize)
+    {
+        classSize <<= 1;
+        ++sizeClass;
+    }
+    return sizeClass;
+}
+
+//-----------------------------------------------------------------------------------
+size_t NetMessagePool::GetBlockSize(uint8_t sizeClass)
+{
+    //Keep every block pointer-aligned so the next block's header lines up
+    size_t blockSize = sizeof(PooledNetMessage) + (MIN_PAYLOAD_CLASS_SIZE << sizeClass);
+    return (blockSize + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+}
+
+//-----------------------------------------------------------------------------------
+void NetMessagePool::Grow(uint8_t sizeClass)
+{
+    size_t blockSize = GetBlockSize(sizeClass);
+    size_t numBlocks = TARGET_CHUNK_SIZE / blockSize;
+    if (numBlocks < 8)
+    {
+        numBlocks = 8;
+    }
+
+    byte* chunk = new byte[blockSize * numBlocks];
+    m_chunks.push_back(chunk);
+    m_numBytesReserved += blockSize * numBlocks;
+    for (size_t i = 0; i < numBlocks; ++i)
+    {
+        PooledNetMessage* block = (PooledNetMessage*)(chunk + (i * blockSize));
+        block->next = m_freeLists[sizeClass];
+        m_freeLists[sizeClass] = block;
+    }
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+typedef unsigned char byte;
+class NetMessage;
+
+//-----------------------------------------------------------------------------------
+//A message copied into pooled storage, either queued for sending or held back until it can be delivered in order.
+//The payload lives directly after the struct in the same block, and next/prev let NetConnection keep its outgoing queues as in place linked lists.
+struct PooledNetMessage
+{
+    //FUNCTIONS/////////////////////////////////////////////////////////////////////
+    inline byte* GetPayload() { return (byte*)(this + 1); };
+    inline const byte* GetPayload() const { return (const byte*)(this + 1); };
+    inline size_t GetHeaderSize() const { return sizeof(uint8_t) + sizeof(uint16_t) + sizeof(uint16_t); }; //Same as NetMessage::GetHeaderSize
+    inline size_t GetPayloadSize() const { return m_payloadSize; };
+    void CopyTo(NetMessage& outMessage) const;
+
+    //MEMBER VARIABLES/////////////////////////////////////////////////////////////////////
+    PooledNetMessage* next;
+    PooledNetMessage* prev;
+    uint8_t m_type;
+    uint8_t m_sizeClass;
+    uint16_t m_payloadSize;
+    uint16_t m_reliableId;
+    uint16_t m_sequenceId;
+    uint8_t m_priority; //The priority class it was queued in
+    uint32_t m_lastSentTimestampMs; //For unreliables, when they were queued
+};
+
+//-----------------------------------------------------------------------------------
+//Slab allocator for PooledNetMessages. Blocks come in power of two payload size classes (8B to MESSAGE_MTU) and are
+//carved out of chunks that are never given back until the pool dies, so once a session warms up sending never touches the heap.
+class NetMessagePool
+{
+public:
+    //CONSTRUCTORS/////////////////////////////////////////////////////////////////////
+    NetMessagePool();
+    ~NetMessagePool();
+
+    //FUNCTIONS/////////////////////////////////////////////////////////////////////
+    PooledNetMessage* Alloc(const NetMessage& msg);
+    void Free(PooledNetMessage* msg);
+
+    //GETTERS/////////////////////////////////////////////////////////////////////
+    inline unsigned int GetNumLiveMessages() const { return m_numLiveMessages; };
+    inline unsigned int GetNumChunkAllocations() const { return (unsigned int)m_chunks.size(); };
+    inline size_t GetNumBytesReserved() const { return m_numBytesReserved; };
+
+    //CONSTANTS/////////////////////////////////////////////////////////////////////
+    static const unsigned int MIN_PAYLOAD_CLASS_SIZE = 8;
+    static const unsigned int NUM_SIZE_CLASSES = 8; //8, 16, 32 ... 1024
+    static const size_t TARGET_CHUNK_SIZE = 16 * 1024;
+
+private:
+    //PRIVATE FUNCTIONS/////////////////////////////////////////////////////////////////////
+    static uint8_t GetSizeClass(size_t payloadSize);
+    static size_t GetBlockSize(uint8_t sizeClass);
+    void Grow(uint8_t sizeClass);
+
+    //MEMBER VARIABLES/////////////////////////////////////////////////////////////////////
+    PooledNetMessage* m_freeLists[NUM_SIZE_CLASSES]; //Singly linked through next
+    std::vector<byte*> m_chunks;
+    unsigned int m_numLiveMessages;
+    size_t m_numBytesReserved;
+};
@@ -1,11 +1,47 @@
 #include "Engine/Net/UDPIP/NetPacket.hpp"
 #include "Engine/Net/UDPIP/NetSession.hpp"
-#include "Engine/Input/Logging.hpp"
+#include "Engine/Net/UDPIP/NetMessagePool.hpp"
+#include "Engine/Net/UDPIP/PacketCompressor.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Math/MathUtils.hpp"
+
+static_assert(NetPacket::MAX_UNCOMPRESSED_BYTES - PacketCompressor::SKIPPED_PACKET_BYTES <= PacketCompressor::MAX_SOURCE_BYTES, "The compressor has to take a full packet body");
+
+//-----------------------------------------------------------------------------------
+//Lets a packet be reused for building another outgoing packet without reconstructing it
+void NetPacket::Reset(uint16_t connectionIndex)
+{
+    m_writeSizeMax = PACKET_MTU;
+    m_maxWireBytes = PACKET_MTU;
+    m_compressor = nullptr;
+    m_numCompressionTrials = 0;
+    m_trialReadableBytes = 0;
+    m_trialWireBytes = 0;
+    m_msgCountBookmark = nullptr;
+    SetReadableBytes(0);
+    m_header = Header(connectionIndex);
+}
+
+//-----------------------------------------------------------------------------------
+void NetPacket::LimitSize(size_t maxBytes)
+{
+    m_maxWireBytes = Min<size_t>(maxBytes, PACKET_MTU);
+    m_writeSizeMax = (m_compressor != nullptr) ? MAX_UNCOMPRESSED_BYTES : m_maxWireBytes;
+}
+
+//-----------------------------------------------------------------------------------
+//Messages that fit uncompressed go in as usual. Past that, CanWrite budgets the fill against what goes out on the wire, trying a
+//compression whenever it can't tell from the last one that a message still fits. Compress has to be called once the packet is finished.
+void NetPacket::CompressWith(const PacketCompressor& compressor)
+{
+    m_compressor = &compressor;
+    m_writeSizeMax = MAX_UNCOMPRESSED_BYTES;
+}
 
 //-----------------------------------------------------------------------------------
 void NetPacket::WriteHeader()
 {
-    Write<uint8_t>(m_header.fromConnectionIndex);
+    Write<uint16_t>(m_header.fromConnectionIndex);
     m_msgCountBookmark = Reserve<uint8_t>(m_header.messageCount);
     Write<uint16_t>(m_header.ack);
     Write<uint16_t>(m_header.highestReceivedAck);
@@ -15,17 +51,169 @@ void NetPacket::WriteHeader()
 //-----------------------------------------------------------------------------------
 void NetPacket::ReadHeader()
 {
-    Read<uint8_t>(m_header.fromConnectionIndex);
+    Read<uint16_t>(m_header.fromConnectionIndex);
     Read<uint8_t>(m_header.messageCount);
     Read<uint16_t>(m_header.ack);
     Read<uint16_t>(m_header.highestReceivedAck);
     Read<uint16_t>(m_header.previousReceivedAcksBitfield);
 }
 
+//-----------------------------------------------------------------------------------
+//Everything but the sender index and message count gets compressed, so the receiver can still see who it's from and that it's compressed
+bool NetPacket::Compress(const PacketCompressor& compressor)
+{
+    const size_t skippedBytes = PacketCompressor::SKIPPED_PACKET_BYTES;
+    size_t numBytes = GetTotalReadableBytes();
+    if (numBytes <= skippedBytes)
+    {
+        return false;
+    }
+    size_t bodySize = numBytes - skippedBytes;
+    byte compressed[PACKET_MTU];
+    size_t compressedSize = compressor.Compress(m_buffer + skippedBytes, bodySize, compressed, Min<size_t>(bodySize - 1, sizeof(compressed)));
+    if (compressedSize == 0)
+    {
+        //Anything let in past the MTU was only let in once a trial showed it would fit, so this can only happen to packets that fit as they are
+        ASSERT_OR_DIE(numBytes <= PACKET_MTU, "A packet filled for compression didn't compress");
+        return false;
+    }
+    uint16_t flippedIndex = m_header.fromConnectionIndex ^ COMPRESSED_INDEX_BIT;
+    m_buffer[0] = (byte)(flippedIndex >> 8);
+    m_buffer[1] = (byte)(flippedIndex & 0xFF);
+    memcpy(m_buffer + skippedBytes, compressed, compressedSize);
+    SetReadableBytes(skippedBytes + compressedSize);
+    return true;
+}
+
+//-----------------------------------------------------------------------------------
+bool NetPacket::Decompress(const PacketCompressor& compressor)
+{
+    const size_t skippedBytes = PacketCompressor::SKIPPED_PACKET_BYTES;
+    size_t numBytes = GetTotalReadableBytes();
+    if (numBytes < sizeof(uint16_t))
+    {
+        return true;
+    }
+    uint16_t flippedIndex = (uint16_t)((m_buffer[0] << 8) | m_buffer[1]);
+    if (!IsCompressedConnectionIndex(flippedIndex))
+    {
+        return true;
+    }
+    if (numBytes < skippedBytes)
+    {
+        return false;
+    }
+    byte decompressed[MAX_UNCOMPRESSED_BYTES];
+    size_t bodySize = compressor.Decompress(m_buffer + skippedBytes, numBytes - skippedBytes, decompressed, MAX_UNCOMPRESSED_BYTES - skippedBytes);
+    if (bodySize == 0)
+    {
+        return false;
+    }
+    uint16_t connectionIndex = flippedIndex ^ COMPRESSED_INDEX_BIT;
+    m_buffer[0] = (byte)(connectionIndex >> 8);
+    m_buffer[1] = (byte)(connectionIndex & 0xFF);
+    memcpy(m_buffer + skippedBytes, decompressed, bodySize);
+    SetReadableBytes(skippedBytes + bodySize);
+    return true;
+}
+
+//-----------------------------------------------------------------------------------
+bool NetPacket::IsCompressedConnectionIndex(uint16_t connectionIndex)
+{
+    uint16_t unflipped = connectionIndex ^ COMPRESSED_INDEX_BIT;
+    return unflipped == INVALID_CONNECTION_INDEX || unflipped < NetSession::MAX_CONNECTIONS;
+}
+
 //-----------------------------------------------------------------------------------
 bool NetPacket::CanWrite(NetMessage* msg)
 {
-    return GetWritableBytes() >= msg->GetHeaderSize() + msg->GetPayloadSize() + sizeof(uint16_t);
+    size_t numBytes = msg->GetHeaderSize() + msg->GetPayloadSize() + sizeof(uint16_t);
+    if (!CanWriteBytes(numBytes))
+    {
+        return false;
+    }
+    if (!NeedsCompressionTrial(numBytes))
+    {
+        return true;
+    }
+    WriteMessage(msg);
+    return TrialCompressLastMessage(numBytes);
+}
+
+//-----------------------------------------------------------------------------------
+bool NetPacket::CanWrite(const PooledNetMessage* msg)
+{
+    size_t numBytes = msg->GetHeaderSize() + msg->GetPayloadSize() + sizeof(uint16_t);
+    if (!CanWriteBytes(numBytes))
+    {
+        return false;
+    }
+    if (!NeedsCompressionTrial(numBytes))
+    {
+        return true;
+    }
+    WriteMessage(msg);
+    return TrialCompressLastMessage(numBytes);
+}
+
+//-----------------------------------------------------------------------------------
+//Room in the buffer, in the message count, and either on the wire or in a compressed packet
+bool NetPacket::CanWriteBytes(size_t numBytes)
+{
+    if (GetWritableBytes() < numBytes || m_header.messageCount == 0xFF)
+    {
+        return false;
+    }
+    return !NeedsCompressionTrial(numBytes) || (m_compressor != nullptr && m_numCompressionTrials < MAX_COMPRESSION_TRIALS);
+}
+
+//-----------------------------------------------------------------------------------
+//Compressing a longer packet only changes the end of what the shorter one compressed to, so the last trial that fit bounds what the
+//packet can come out to with more written after it
+bool NetPacket::NeedsCompressionTrial(size_t numBytes)
+{
+    size_t totalBytes = GetTotalReadableBytes() + numBytes;
+    if (totalBytes <= m_maxWireBytes)
+    {
+        return false;
+    }
+    return m_compressor == nullptr || m_trialReadableBytes == 0 || m_trialWireBytes + PacketCompressor::GetMaxAppendedGrowth(totalBytes - m_trialReadableBytes) > m_maxWireBytes;
+}
+
+//-----------------------------------------------------------------------------------
+//Compresses the packet with the message just written to see whether it still fits on the wire, then takes the message back out. Every
+//message past the limit either gets a trial or fits within the bound from the last one, so the finished packet is sure to fit.
+bool NetPacket::TrialCompressLastMessage(size_t numBytes)
+{
+    const size_t skippedBytes = PacketCompressor::SKIPPED_PACKET_BYTES;
+    ++m_numCompressionTrials;
+    byte compressed[PACKET_MTU];
+    size_t compressedSize = 0;
+    if (m_maxWireBytes > skippedBytes)
+    {
+        compressedSize = m_compressor->Compress(m_buffer + skippedBytes, GetTotalReadableBytes() - skippedBytes, compressed, m_maxWireBytes - skippedBytes);
+    }
+    if (compressedSize != 0)
+    {
+        m_trialReadableBytes = GetTotalReadableBytes();
+        m_trialWireBytes = skippedBytes + compressedSize;
+    }
+    Rewind(numBytes);
+    if (m_msgCountBookmark != nullptr)
+    {
+        *m_msgCountBookmark = --m_header.messageCount;
+    }
+    return compressedSize != 0;
+}
+
+//-----------------------------------------------------------------------------------
+//Keeps the count in the header up to date as messages go in, so a compression trial sees the packet as it will be sent
+void NetPacket::CountWrittenMessage()
+{
+    if (m_msgCountBookmark != nullptr)
+    {
+        *m_msgCountBookmark = ++m_header.messageCount;
+    }
 }
 
 //-----------------------------------------------------------------------------------
@@ -39,18 +227,39 @@ size_t NetPacket::WriteMessage(NetMessage* msg)
 {
 #pragma todo("Replace the other redundant functions once you're not on fire")
 
-    const NetMessageDefinition* definition = NetSession::instance->FindDefinition(msg->m_type);
-
     size_t messageSize = msg->GetHeaderSize() + msg->GetPayloadSize();
     size_t total = messageSize + sizeof(uint16_t);
     if (GetWritableBytes() >= total)
     {
         //Can write!
         Write<uint16_t>((const uint16_t)messageSize);
-        Write<uint8_t>((const uint8_t)definition->id);
+        Write<uint8_t>(msg->m_type);
         Write<uint16_t>(msg->m_reliableId);
         Write<uint16_t>(msg->m_sequenceId);
         WriteBytes(msg->m_buffer, msg->GetPayloadSize());
+        CountWrittenMessage();
+        return total;
+    }
+    else
+    {
+        return 0;
+    }
+}
+
+//-----------------------------------------------------------------------------------
+//Same wire format as above, but for an already encoded pooled message
+size_t NetPacket::WriteMessage(const PooledNetMessage* msg)
+{
+    size_t messageSize = msg->GetHeaderSize() + msg->GetPayloadSize();
+    size_t total = messageSize + sizeof(uint16_t);
+    if (GetWritableBytes() >= total)
+    {
+        Write<uint16_t>((const uint16_t)messageSize);
+        Write<uint8_t>(msg->m_type);
+        Write<uint16_t>(msg->m_reliableId);
+        Write<uint16_t>(msg->m_sequenceId);
+        WriteBytes(msg->GetPayload(), msg->GetPayloadSize());
+        CountWrittenMessage();
         return total;
     }
     else
@@ -77,9 +286,8 @@ size_t NetPacket::WriteMessages(NetMessage** messages, size_t count)
     for (size_t i = 0; i < numMessagesCanFit; ++i)
     {
         NetMessage* message = messages[i];
-        const NetMessageDefinition* definition = NetSession::instance->FindDefinition(message->m_type);
         Write<uint16_t>((const uint16_t)(message->GetHeaderSize() + message->GetPayloadSize()));
-        Write<uint8_t>(definition->id);
+        Write<uint8_t>(message->m_type);
         Write<uint16_t>(message->m_reliableId);
         Write<uint16_t>(message->m_sequenceId);
         WriteBytes(message->m_buffer, message->GetPayloadSize());
@@ -94,15 +302,13 @@ void NetPacket::WriteMessageAndFinalize(const NetMessage& message)
     m_header.messageCount = 1;
     WriteHeader();
 
-    const NetMessageDefinition* definition = NetSession::instance->FindDefinition(message.m_type);
-
     size_t messageSize = message.GetHeaderSize() + message.GetPayloadSize();
     size_t total = messageSize + sizeof(uint16_t);
     if (GetWritableBytes() >= total)
     {
         //Can write!
         Write<uint16_t>((const uint16_t)messageSize);
-        Write<uint8_t>((const uint8_t)definition->id);
+        Write<uint8_t>(message.m_type);
         Write<uint16_t>(message.m_reliableId);
         Write<uint16_t>(message.m_sequenceId);
         WriteBytes(message.m_buffer, message.GetPayloadSize());
@@ -128,9 +334,8 @@ size_t NetPacket::WriteMessagesAndFinalize(NetMessage** messages, size_t count)
     for (size_t i = 0; i < numMessagesCanFit; ++i)
     {
         NetMessage* message = messages[i];
-        const NetMessageDefinition* definition = NetSession::instance->FindDefinition(message->m_type);
         Write<uint16_t>((const uint16_t)(message->GetHeaderSize() + message->GetPayloadSize()));
-        Write<uint8_t>(definition->id);
+        Write<uint8_t>(message->m_type);
         Write<uint16_t>(message->m_reliableId);
         Write<uint16_t>(message->m_sequenceId);
         WriteBytes(message->m_buffer, message->GetPayloadSize());
@@ -154,7 +359,7 @@ void NetPacket::ReadMessage(NetMessage& outMessage)
     Read<uint16_t>(msgSize);
     if (msgSize > (MESSAGE_MTU))
     {
-        LogPrintf(LogLevel::WARNING, "Invalid Packet thrown out.");
+        DebuggerPrintf("Invalid Packet thrown out.\n");
         return;
     }
 
@@ -1,12 +1,11 @@
 #pragma once
 #include "Engine/DataStructures/BytePacker.hpp"
 #include "Engine/Net/UDPIP/NetMessage.hpp"
-#pragma comment(lib, "ws2_32")
+#include "Engine/Net/UDPIP/UDPTransport.hpp"
 #include <stdint.h>
-#include <WinSock2.h>
-#include <WS2tcpip.h>
 
-#define PACKET_MTU 1232
+struct PooledNetMessage;
+class PacketCompressor;
 
 class NetPacket : public BytePacker
 {
@@ -16,10 +15,10 @@ public:
     {
         //CONSTRUCTORS/////////////////////////////////////////////////////////////////////
         Header() : fromConnectionIndex(INVALID_CONNECTION_INDEX), messageCount(0) {};
-        Header(uint8_t connectionIndex = INVALID_CONNECTION_INDEX) : fromConnectionIndex(connectionIndex), messageCount(0) {};
+        Header(uint16_t connectionIndex = INVALID_CONNECTION_INDEX) : fromConnectionIndex(connectionIndex), messageCount(0) {};
 
         //MEMBER VARIABLES/////////////////////////////////////////////////////////////////////
-        uint8_t fromConnectionIndex;
+        uint16_t fromConnectionIndex;
         uint16_t ack;
         uint16_t highestReceivedAck;
         uint16_t previousReceivedAcksBitfield;
@@ -27,33 +26,64 @@ public:
     };
 
     //CONSTRUCTORS/////////////////////////////////////////////////////////////////////
-    NetPacket(uint8_t connectionIndex = 0)
+    NetPacket(uint16_t connectionIndex = 0)
         : BytePacker(m_buffer, PACKET_MTU, 0, IBinaryReader::BIG_ENDIAN)
         , m_header(connectionIndex)
+        , m_arrivalTimeMs(0.0)
+        , m_msgCountBookmark(nullptr)
+        , m_compressor(nullptr)
+        , m_maxWireBytes(PACKET_MTU)
+        , m_numCompressionTrials(0)
+        , m_trialReadableBytes(0)
+        , m_trialWireBytes(0)
     {
 
     }
 
     //FUNCTIONS/////////////////////////////////////////////////////////////////////
+    void Reset(uint16_t connectionIndex);
     void WriteHeader();
     void ReadHeader();
     size_t WriteMessage(NetMessage* msg);
+    size_t WriteMessage(const PooledNetMessage* msg);
     size_t WriteMessages(NetMessage** messages, size_t count);
     void WriteMessageAndFinalize(const NetMessage& message);
     size_t WriteMessagesAndFinalize(NetMessage** messages, size_t count);
     void ReadMessage(NetMessage& outMessage);
     NetMessage ReadMessage();
     bool CanWrite(NetMessage* msg);
+    bool CanWrite(const PooledNetMessage* msg);
     uint8_t* GetMessageCountBookmark();
+    void LimitSize(size_t maxBytes); //Limits what goes out on the wire, lasts until the next Reset. Anything already written stays.
+    void CompressWith(const PacketCompressor& compressor); //Lets messages past the size limit while the compressed packet still fits it. Lasts until the next Reset.
+    bool Compress(const PacketCompressor& compressor); //After it's finished. False, leaving it as it was, if it wouldn't come out smaller.
+    bool Decompress(const PacketCompressor& compressor); //Before reading the header. True if it's ready to read, which uncompressed packets already are.
+    static bool IsCompressedConnectionIndex(uint16_t connectionIndex);
 
     //CONSTANTS/////////////////////////////////////////////////////////////////////
-    static const uint8_t INVALID_CONNECTION_INDEX = 255;
+    static const uint16_t INVALID_CONNECTION_INDEX = 0xFFFF;
+    static const size_t MAX_UNCOMPRESSED_BYTES = 2 * PACKET_MTU; //What a packet can hold before it's compressed, and once it's decompressed
+    static const unsigned int MAX_COMPRESSION_TRIALS = 8; //Compressions tried per packet to see whether one more message fits
+    static const uint16_t COMPRESSED_INDEX_BIT = 0x8000; //Flipped in the sender index of compressed packets. Real indices are all below MAX_CONNECTIONS or invalid, so a flipped one can't pass for either.
 
     //MEMBER VARIABLES/////////////////////////////////////////////////////////////////////
-    byte m_buffer[PACKET_MTU];
+    byte m_buffer[MAX_UNCOMPRESSED_BYTES];
     Header m_header;
     sockaddr_in m_fromAddress;
+    double m_arrivalTimeMs;
 
 private:
+    //PRIVATE FUNCTIONS/////////////////////////////////////////////////////////////////////
+    bool CanWriteBytes(size_t numBytes);
+    bool NeedsCompressionTrial(size_t numBytes);
+    bool TrialCompressLastMessage(size_t numBytes);
+    void CountWrittenMessage();
+
+    //PRIVATE MEMBERS/////////////////////////////////////////////////////////////////////
     uint8_t* m_msgCountBookmark;
+    const PacketCompressor* m_compressor;
+    size_t m_maxWireBytes;
+    unsigned int m_numCompressionTrials;
+    size_t m_trialReadableBytes; //How much was written at the last trial that fit, 0 before one has
+    size_t m_trialWireBytes; //What that trial came out to on the wire
 };
\ No newline at end of file
@@ -1,20 +1,21 @@
 #include "Engine/Net/UDPIP/NetSession.hpp"
 #include "Engine/Net/UDPIP/NetConnection.hpp"
-#include "Engine/Input/Console.hpp"
-#include "Engine/Net/NetSystem.hpp"
 #include "Engine/Core/StringUtils.hpp"
 #include "Engine/Net/UDPIP/NetPacket.hpp"
 #include "Engine/Core/Events/Event.hpp"
-#include "Engine/Input/Logging.hpp"
 #include "Engine/Time/Time.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Engine/Input/InputOutputUtils.hpp"
+#include "Engine/Core/BuildConfig.hpp"
+#include "Engine/Core/ProfilingUtils.h"
 
 NetSession* NetSession::instance = nullptr;
 extern Event<float> NetworkUpdate;
-extern Event<> NetworkCleanup;
 
 //-----------------------------------------------------------------------------------
 NetSession::NetSession(float tickRatePerSecond) 
-    : m_myConnection(nullptr)
+    : m_snapshots(this)
+    , m_myConnection(nullptr)
     , m_hostConnection(nullptr)
     , m_tickRate(tickRatePerSecond)
     , m_timeLastJoinRequestSent(0.0f)
@@ -23,26 +24,46 @@ NetSession::NetSession(float tickRatePerSecond)
     , m_sessionState(State::INVALID)
     , m_lastError(ErrorCode::NONE)
     , m_timeoutEnabled(false)
-    , m_sessionInfoText(nullptr)
-    , m_netLagText(nullptr)
-    , m_netLossText(nullptr)
-    , m_connectionCountText(nullptr)
     , m_isListening(true)
-{
+    , m_manualClockMs(-1.0)
+    , m_bandwidthBudgetBytesPerSecond(SendRateController::DEFAULT_MAX_BYTES_PER_SECOND)
+    , m_isCongestionControlEnabled(true)
+    , m_numReassemblyBuffers(0)
+    , m_numPacketsLeftToRecord(0)
+    , m_interestEntityWriter(nullptr)
+    , m_interestMessageType(0)
+    , m_maxInterestEntityBytes(0)
+{
+    m_snapshots.SetInterestManager(&m_interest);
     m_packetChannel.m_additionalLagMilliseconds = 0;//Range<double>(50, 150);
     m_packetChannel.m_dropRate = 0.0f;//0.1f;
     for (int i = 0; i < MAX_CONNECTIONS; ++i)
     {
         m_allConnections[i] = nullptr;
     }
+    m_activeConnections.reserve(MAX_CONNECTIONS);
+    m_connectionsByAddress.reserve(MAX_CONNECTIONS);
+    for (size_t i = 0; i < PACKET_BATCH_SIZE; ++i)
+    {
+        m_receiveDatagrams[i].buffer = m_receivePackets[i].m_buffer;
+    }
+    for (unsigned int i = 0; i < NUM_PREALLOCATED_REASSEMBLY_BUFFERS; ++i)
+    {
+        m_freeReassemblyBuffers.push_back(new byte[NetConnection::MAX_LARGE_MESSAGE_BYTES]);
+        ++m_numReassemblyBuffers;
+    }
 }
 
 //-----------------------------------------------------------------------------------
 NetSession::~NetSession()
 {
-    for (uint8_t i = 0; i < MAX_CONNECTIONS; ++i)
+    while (!m_activeConnections.empty())
+    {
+        Disconnect(m_activeConnections.back());
+    }
+    for (byte* buffer : m_freeReassemblyBuffers)
     {
-        Disconnect(m_allConnections[i]);
+        delete[] buffer;
     }
 }
 
@@ -50,14 +71,14 @@ NetSession::~NetSession()
 bool NetSession::Start(const char* portNumber)
 {
     ASSERT_OR_DIE(m_sessionState == State::INVALID, "Attempted to start the session after starting it once");
-    m_packetChannel.Bind(NetSystem::GetLocalHostName(), portNumber);
+    m_packetChannel.Bind(NetAddress::GetLocalHostName(), portNumber);
     if (!m_packetChannel.IsBound())
     {
         m_lastError = ErrorCode::START_FAILED_TO_CREATE_SOCKET;
     }
     SetSessionState(State::DISCONNECTED);
     OnEnterDisconnectedState();
-    NetworkUpdate.RegisterMethod(NetSession::instance, &NetSession::Update);
+    NetworkUpdate.RegisterMethod(this, &NetSession::Update);
     return m_packetChannel.IsBound();
 }
 
@@ -76,7 +97,7 @@ void NetSession::Stop()
 //-----------------------------------------------------------------------------------
 void NetSession::Cleanup()
 {
-    Console::instance->PrintLine("Shutting down net session.", RGBA::CORNFLOWER_BLUE);
+    m_OnStatusMessage.Trigger("Shutting down net session.", RGBA::CORNFLOWER_BLUE);
     if (m_sessionState != State::INVALID)
     {
         Stop();
@@ -112,47 +133,131 @@ bool NetSession::SetSessionState(State newState, void(NetSession::*onStateSwitch
 //-----------------------------------------------------------------------------------
 void NetSession::Update(float deltaSeconds)
 {
+#ifdef PROFILING_ENABLED
+    bool isProfiling = ProfilingSystem::IsProfilingEnabled();
+    if (isProfiling)
+    {
+        ProfilingSystem::instance->PushSample("NetSessionUpdate");
+    }
+#endif
     ProcessIncomingPackets(); 
     m_timeSinceLastUpdate += deltaSeconds;
     if (m_timeSinceLastUpdate >= m_tickRate)
     {
-        for (NetConnection* conn : m_allConnections)
-        {
-            if (conn)
-            {
-                m_OnNetTick.Trigger(conn);
-                conn->ConstructAndSendPacket();
-            }
-        }
+        SendOutgoingPackets();
         m_timeSinceLastUpdate = 0.0f;
     }
     CheckForTimeouts();
     CheckForJoinResponse();
+#ifdef PROFILING_ENABLED
+    if (isProfiling)
+    {
+        ProfilingSystem::instance->PopSample("NetSessionUpdate");
+    }
+#endif
+}
+
+//-----------------------------------------------------------------------------------
+//Every connection's packet for this tick is built first and then handed to the channel as one batch.
+void NetSession::SendOutgoingPackets()
+{
+    //This tick's picks go out with it, and snapshots the game sends before the next tick are filtered by them
+    if (m_interest.GetNumEntities() > 0)
+    {
+        m_interest.Update();
+        if (m_interestEntityWriter != nullptr)
+        {
+            m_interest.SendUpdates(*this, m_interestMessageType, m_interestEntityWriter, m_maxInterestEntityBytes);
+        }
+    }
+    size_t numPackets = 0;
+    for (NetConnection* conn : m_activeConnections)
+    {
+        m_OnNetTick.Trigger(conn);
+        NetPacket& packet = m_sendPackets[numPackets];
+        uint32_t numResendsBefore = conn->m_telemetry.GetNumResends();
+        conn->ConstructPacket(packet);
+        m_sendDatagrams[numPackets].address = conn->m_address;
+        m_sendDatagrams[numPackets].buffer = packet.m_buffer;
+        m_sendDatagrams[numPackets].size = packet.GetTotalReadableBytes();
+#ifdef PROFILING_ENABLED
+        if (ProfilingSystem::IsProfilingEnabled() && ProfilingSystem::instance->m_activeSample)
+        {
+            const NetTelemetrySample& telemetry = conn->m_telemetry.GetCurrent();
+            ProfilingSystem::instance->m_activeSample->numNetBytesSent += packet.GetTotalReadableBytes();
+            ProfilingSystem::instance->m_activeSample->AddNetConnection(conn->m_telemetry.GetNumResends() - numResendsBefore, telemetry.numUnsentReliables, telemetry.numUnconfirmedReliables, telemetry.roundTripMs, telemetry.lossRate);
+        }
+#else
+        UNUSED(numResendsBefore)
+#endif
+        if (++numPackets == PACKET_BATCH_SIZE)
+        {
+            m_packetChannel.SendBatch(m_sendDatagrams, numPackets);
+            numPackets = 0;
+        }
+    }
+    if (numPackets > 0)
+    {
+        m_packetChannel.SendBatch(m_sendDatagrams, numPackets);
+    }
 }
 
 //-----------------------------------------------------------------------------------
 void NetSession::ProcessIncomingPackets(const size_t maxPacketsToProcess)
 {
-    UNUSED(maxPacketsToProcess)
-    NetPacket packet(INVALID_CONNECTION_INDEX);
     NetSender from;
     from.session = this;
-    size_t read = m_packetChannel.RecieveFrom(from.address, packet.m_buffer);
-    while (read > 0)
+    size_t numProcessed = 0;
+    while (numProcessed < maxPacketsToProcess)
     {
-        packet.SetReadableBytes(read);
-        ProcessIncomingPacket(from, packet);
-        read = m_packetChannel.RecieveFrom(from.address, packet.m_buffer);
+        size_t batchSize = Min<size_t>(PACKET_BATCH_SIZE, maxPacketsToProcess - numProcessed);
+        size_t numReceived = m_packetChannel.ReceiveBatch(m_receiveDatagrams, batchSize);
+        for (size_t i = 0; i < numReceived; ++i)
+        {
+            NetPacket& packet = m_receivePackets[i];
+            packet.SetReadableBytes(m_receiveDatagrams[i].size);
+            packet.m_arrivalTimeMs = m_receiveDatagrams[i].arrivalTimeMs;
+            from.address = m_receiveDatagrams[i].address;
+            from.connection = nullptr;
+            ProcessIncomingPacket(from, packet);
+        }
+        numProcessed += numReceived;
+        if (numReceived < batchSize)
+        {
+            break;
+        }
     }
 }
 
 //-----------------------------------------------------------------------------------
 void NetSession::ProcessIncomingPacket(NetSender& from, NetPacket& packet)
 {
+    size_t numWireBytes = packet.GetTotalReadableBytes();
+#ifdef PROFILING_ENABLED
+    if (ProfilingSystem::IsProfilingEnabled() && ProfilingSystem::instance->m_activeSample)
+    {
+        ProfilingSystem::instance->m_activeSample->numNetBytesReceived += numWireBytes;
+    }
+#endif
+    if (!packet.Decompress(m_packetCompressor))
+    {
+        DebuggerPrintf("Compressed packet we couldn't decompress thrown out.\n");
+        return;
+    }
     packet.ReadHeader();
 
-    //Get the connection this packet came from, if it did.
-    from.connection = GetConnection(packet.m_header.fromConnectionIndex);
+    //Get the connection this packet came from, if it did. The address is what we trust, the index in the header only covers
+    //peers that reach us from a different address than the one we know them by.
+    NetConnection* sender = FindConnection(from.address);
+    if (sender == nullptr)
+    {
+        sender = GetConnection(packet.m_header.fromConnectionIndex);
+    }
+    from.connection = sender;
+    if (sender)
+    {
+        sender->m_telemetry.OnPacketReceived(numWireBytes);
+    }
 
     //Process the messages in the packet.
     uint8_t numMessages = packet.m_header.messageCount;
@@ -175,21 +280,21 @@ void NetSession::ProcessIncomingPacket(NetSender& from, NetPacket& packet)
             else
             {
                 msg.Process(from);
-                if (msg.IsReliable())
+                if (msg.IsReliable(*this))
                 {
-                    from.connection = GetConnection(GetConnectionIndexFromAddress(from.address));
+                    from.connection = FindConnection(from.address);
                 }
             }
         }
     }
-    if (GetConnection(packet.m_header.fromConnectionIndex) && m_myConnection && m_myConnection->m_index != INVALID_CONNECTION_INDEX)
+    if (sender && m_myConnection && m_myConnection->m_index != INVALID_CONNECTION_INDEX)
     {
-        from.connection->MarkPacketReceived(packet);
+        sender->MarkPacketReceived(packet);
     }
 }
 
 //-----------------------------------------------------------------------------------
-void NetSession::RegisterMessage(uint8_t type, const char* messageName, NetMessageCallback* functionPointer, uint32_t optionFlags, uint32_t controlFlags)
+void NetSession::RegisterMessage(uint8_t type, const char* messageName, NetMessageCallback* functionPointer, uint32_t optionFlags, uint32_t controlFlags, uint8_t priority)
 {
     ASSERT_OR_DIE(m_sessionState == State::INVALID, "Attempted to register a message after the session was initialized");
     ASSERT_OR_DIE(m_netMessageDefinitions[type].callbackFunction == nullptr, "Attempted to overwrite an existing message definition");
@@ -199,6 +304,89 @@ void NetSession::RegisterMessage(uint8_t type, const char* messageName, NetMessa
     m_netMessageDefinitions[type].callbackFunction = functionPointer;
     m_netMessageDefinitions[type].m_optionFlags = optionFlags;
     m_netMessageDefinitions[type].m_controlFlags = controlFlags;
+    m_netMessageDefinitions[type].priority = priority;
+}
+
+//-----------------------------------------------------------------------------------
+void NetSession::RegisterLargeMessage(uint8_t type, const char* messageName, NetLargeMessageCallback* functionPointer)
+{
+    ASSERT_OR_DIE(m_sessionState == State::INVALID, "Attempted to register a message after the session was initialized");
+    ASSERT_OR_DIE(m_netMessageDefinitions[type].callbackFunction == nullptr && m_netMessageDefinitions[type].largeCallbackFunction == nullptr, "Attempted to overwrite an existing message definition");
+
+    m_netMessageDefinitions[type].id = type;
+    m_netMessageDefinitions[type].debugName = messageName;
+    m_netMessageDefinitions[type].largeCallbackFunction = functionPointer;
+    m_netMessageDefinitions[type].m_optionFlags = (uint32_t)NetMessage::Option::RELIABLE;
+    m_netMessageDefinitions[type].m_controlFlags = (uint32_t)NetMessage::Control::NONE;
+}
+
+//-----------------------------------------------------------------------------------
+//The game still keeps m_interest's entities and areas up to date itself, this only takes care of picking and sending every tick
+void NetSession::SetInterestUpdates(uint8_t type, InterestEntityWriter* writeEntity, size_t maxEntityBytes)
+{
+    ASSERT_OR_DIE(writeEntity == nullptr || m_netMessageDefinitions[type].callbackFunction != nullptr, "Register the interest update message before sending it");
+    m_interestEntityWriter = writeEntity;
+    m_interestMessageType = type;
+    m_maxInterestEntityBytes = maxEntityBytes;
+}
+
+//-----------------------------------------------------------------------------------
+//Buffers are only ever added to the pool, never given back until the session dies, so once enough large messages have overlapped reassembly doesn't allocate
+byte* NetSession::AcquireReassemblyBuffer()
+{
+    if (m_freeReassemblyBuffers.empty())
+    {
+        ++m_numReassemblyBuffers;
+        return new byte[NetConnection::MAX_LARGE_MESSAGE_BYTES];
+    }
+    byte* buffer = m_freeReassemblyBuffers.back();
+    m_freeReassemblyBuffers.pop_back();
+    return buffer;
+}
+
+//-----------------------------------------------------------------------------------
+void NetSession::ReleaseReassemblyBuffer(byte* buffer)
+{
+    m_freeReassemblyBuffers.push_back(buffer);
+}
+
+//-----------------------------------------------------------------------------------
+void NetSession::StartRecordingPackets(unsigned int numPackets, const char* filePath)
+{
+    m_packetRecording.clear();
+    m_packetRecording.reserve(numPackets * 64);
+    m_numPacketsLeftToRecord = numPackets;
+    m_packetRecordingPath = filePath;
+}
+
+//-----------------------------------------------------------------------------------
+void NetSession::StopRecordingPackets()
+{
+    m_numPacketsLeftToRecord = 0;
+    m_packetRecordingPath.clear();
+}
+
+//-----------------------------------------------------------------------------------
+void NetSession::RecordOutgoingPacket(const NetPacket& packet)
+{
+    if (m_numPacketsLeftToRecord == 0)
+    {
+        return;
+    }
+    PacketCompressor::AppendRecordedPacket(m_packetRecording, packet.m_buffer, packet.GetTotalReadableBytes());
+    if (--m_numPacketsLeftToRecord == 0 && !m_packetRecordingPath.empty())
+    {
+        if (SaveBufferToBinaryFile(m_packetRecording, m_packetRecordingPath))
+        {
+            m_OnStatusMessage.Trigger(Stringf("Recorded %u bytes of packets to %s.", (unsigned int)m_packetRecording.size(), m_packetRecordingPath.c_str()), RGBA::GREEN);
+        }
+        else
+        {
+            m_OnStatusMessage.Trigger(Stringf("Couldn't write %s.", m_packetRecordingPath.c_str()), RGBA::RED);
+        }
+        m_packetRecording.clear();
+        StopRecordingPackets();
+    }
 }
 
 //-----------------------------------------------------------------------------------
@@ -234,6 +422,13 @@ bool NetSession::IsRunning()
     return m_packetChannel.IsBound();
 }
 
+//-----------------------------------------------------------------------------------
+//The clock connections stamp and age reliables with
+double NetSession::GetNetTimeMilliseconds() const
+{
+    return m_manualClockMs >= 0.0 ? m_manualClockMs : GetCurrentTimeMilliseconds();
+}
+
 //-----------------------------------------------------------------------------------
 bool NetSession::IsHost()
 {
@@ -241,9 +436,9 @@ bool NetSession::IsHost()
 }
 
 //-----------------------------------------------------------------------------------
-const NetMessageDefinition* NetSession::FindDefinition(byte messageType)
+const NetMessageDefinition* NetSession::FindDefinition(byte messageType) const
 {
-    NetMessageDefinition* def = &m_netMessageDefinitions[messageType];
+    const NetMessageDefinition* def = &m_netMessageDefinitions[messageType];
     if (def->callbackFunction != nullptr)
     {
         return def;
@@ -255,7 +450,7 @@ const NetMessageDefinition* NetSession::FindDefinition(byte messageType)
 }
 
 //-----------------------------------------------------------------------------------
-NetConnection* NetSession::CreateConnection(uint8_t index, const char* guid, sockaddr_in address)
+NetConnection* NetSession::CreateConnection(uint16_t index, const char* guid, sockaddr_in address)
 {
     if (GetConnection(index) != nullptr)
     {
@@ -282,7 +477,7 @@ NetConnection* NetSession::CreateConnection(uint8_t index, const char* guid, soc
 }
 
 //-----------------------------------------------------------------------------------
-NetConnection* NetSession::GetConnection(uint8_t index)
+NetConnection* NetSession::GetConnection(uint16_t index)
 {
     if (index < MAX_CONNECTIONS)
     {
@@ -295,7 +490,14 @@ NetConnection* NetSession::GetConnection(uint8_t index)
 }
 
 //-----------------------------------------------------------------------------------
-void NetSession::DestroyConnection(uint8_t index)
+NetConnection* NetSession::FindConnection(const sockaddr_in& address)
+{
+    auto found = m_connectionsByAddress.find(GetAddressKey(address));
+    return (found != m_connectionsByAddress.end()) ? found->second : nullptr;
+}
+
+//-----------------------------------------------------------------------------------
+void NetSession::DestroyConnection(uint16_t index)
 {
     NetConnection* conn = GetConnection(index);
     if (conn == nullptr)
@@ -312,13 +514,47 @@ void NetSession::DestroyConnection(uint8_t index)
     }
 
     m_OnConnectionLeave.Trigger(conn);
+    m_interest.ClearInterest(index);
+    RemoveActiveConnection(conn);
     delete conn;
     --m_numConnections;
     m_allConnections[index] = nullptr;
 }
 
 //-----------------------------------------------------------------------------------
-uint8_t NetSession::GetMyConnectionIndex()
+//Swaps the last active connection into the hole so the array stays dense. Anyone iterating it while removing should walk it backwards.
+void NetSession::RemoveActiveConnection(NetConnection* cp)
+{
+    ASSERT_OR_DIE(cp->m_activeSlot < m_activeConnections.size() && m_activeConnections[cp->m_activeSlot] == cp, "Connection wasn't in the active list");
+    NetConnection* last = m_activeConnections.back();
+    m_activeConnections[cp->m_activeSlot] = last;
+    last->m_activeSlot = cp->m_activeSlot;
+    m_activeConnections.pop_back();
+
+    auto found = m_connectionsByAddress.find(GetAddressKey(cp->m_address));
+    if (found != m_connectionsByAddress.end() && found->second == cp)
+    {
+        m_connectionsByAddress.erase(found);
+    }
+}
+
+//-----------------------------------------------------------------------------------
+//If two connections share an address, lookups find whichever was connected first
+void NetSession::AddActiveConnection(NetConnection* cp)
+{
+    cp->m_activeSlot = (uint16_t)m_activeConnections.size();
+    m_activeConnections.push_back(cp);
+    m_connectionsByAddress.emplace(GetAddressKey(cp->m_address), cp);
+}
+
+//-----------------------------------------------------------------------------------
+uint64_t NetSession::GetAddressKey(const sockaddr_in& address)
+{
+    return ((uint64_t)ntohl(address.sin_addr.s_addr) << 16) | (uint64_t)ntohs(address.sin_port);
+}
+
+//-----------------------------------------------------------------------------------
+uint16_t NetSession::GetMyConnectionIndex()
 {
     if (m_myConnection)
     {
@@ -331,16 +567,10 @@ uint8_t NetSession::GetMyConnectionIndex()
 }
 
 //-----------------------------------------------------------------------------------
-uint8_t NetSession::GetConnectionIndexFromAddress(const sockaddr_in& address)
+uint16_t NetSession::GetConnectionIndexFromAddress(const sockaddr_in& address)
 {
-    for (uint8_t i = 0; i < MAX_CONNECTIONS; ++i)
-    {
-        if (m_allConnections[i] && NetSystem::SockaddrCompare(m_allConnections[i]->m_address, address))
-        {
-            return i;
-        }
-    }
-    return INVALID_CONNECTION_INDEX;
+    NetConnection* conn = FindConnection(address);
+    return (conn != nullptr) ? conn->m_index : INVALID_CONNECTION_INDEX;
 }
 
 //-----------------------------------------------------------------------------------
@@ -348,22 +578,22 @@ void OnPingReceived(const NetSender& sender, NetMessage& msg)
 {
     const char* str = msg.ReadString();
 
-    Console::instance->PrintLine(Stringf("Ping Receieved from %s. [%s]", NetSystem::SockAddrToString((sockaddr*)&sender.address), ((nullptr != str) ? str : "null")), RGBA::FOREST_GREEN);
+    sender.session->m_OnStatusMessage.Trigger(Stringf("Ping Receieved from %s. [%s]", NetAddress::SockAddrToString((sockaddr*)&sender.address), ((nullptr != str) ? str : "null")), RGBA::FOREST_GREEN);
 
     NetMessage pong(NetMessage::PONG);
-    NetSession::instance->SendMessageDirect(sender.address, pong);
+    sender.session->SendMessageDirect(sender.address, pong);
 }
 
 //-----------------------------------------------------------------------------------
 void OnPongReceived(const NetSender& sender, NetMessage&)
 {
-    Console::instance->PrintLine(Stringf("Pong received from %s.", NetSystem::SockAddrToString((sockaddr*)&sender.address)), RGBA::GBWHITE);
+    sender.session->m_OnStatusMessage.Trigger(Stringf("Pong received from %s.", NetAddress::SockAddrToString((sockaddr*)&sender.address)), RGBA::GBWHITE);
 }
 
 //-----------------------------------------------------------------------------------
 void OnHeartbeatReceived(const NetSender& sender, NetMessage& msg)
 {
-    Console::instance->PrintLine(Stringf("[%i] Heartbeat received from %s. <3", msg.m_reliableId, NetSystem::SockAddrToString((sockaddr*)&sender.address)), RGBA::VAPORWAVE);
+    sender.session->m_OnStatusMessage.Trigger(Stringf("[%i] Heartbeat received from %s. <3", msg.m_reliableId, NetAddress::SockAddrToString((sockaddr*)&sender.address)), RGBA::VAPORWAVE);
 }
 
 //-----------------------------------------------------------------------------------
@@ -378,22 +608,32 @@ void OnJoinAcceptReceived(const NetSender& sender, NetMessage& msg)
 //         return;
 //     }
     
-    Console::instance->PrintLine(Stringf("Joined the host at %s.", NetSystem::SockAddrToString((sockaddr*)&sender.address)), RGBA::VAPORWAVE);
+    sender.session->m_OnStatusMessage.Trigger(Stringf("Joined the host at %s.", NetAddress::SockAddrToString((sockaddr*)&sender.address)), RGBA::VAPORWAVE);
 #pragma todo("ReadConnectionInfo function would simplify this")
 
     NetConnection* host = sender.session->GetHostConnection();
     const char* hostGuid = msg.ReadString();
     memcpy(host->m_guid, hostGuid, strlen(hostGuid));
-    msg.Read<uint8_t>(host->m_index);
+    msg.Read<uint16_t>(host->m_index);
 
     NetConnection* me = sender.session->GetMyConnection();
     ASSERT_OR_DIE(strcmp(me->m_guid, msg.ReadString()) == 0, "Got back a different guid, potentially corrputed packet detected");
-    msg.Read<uint8_t>(me->m_index);
+    msg.Read<uint16_t>(me->m_index);
+    uint32_t compressionId = 0;
+    msg.Read<uint32_t>(compressionId);
+    host->m_compressionId = (compressionId == sender.session->m_packetCompressor.GetId()) ? compressionId : 0;
 
     sender.session->Connect(me, me->m_index);
+    me->m_state = NetConnection::State::LOCAL; //Same as CreateConnection does for our own connection, otherwise AmIConnected never comes true on a client
     sender.session->SetSessionState(NetSession::State::CONNECTED);
 }
 
+//-----------------------------------------------------------------------------------
+void OnFragmentReceived(const NetSender& sender, NetMessage& msg)
+{
+    sender.connection->ProcessFragment(sender, msg);
+}
+
 //-----------------------------------------------------------------------------------
 void OnConnectionLeaveReceived(const NetSender& sender, NetMessage&)
 {
@@ -415,8 +655,8 @@ void OnJoinDenyReceived(const NetSender& sender, NetMessage& msg)
 
     NetSession::ErrorCode code = NetSession::ErrorCode::NONE;
     msg.Read<NetSession::ErrorCode>(code);
-    Console::instance->PrintLine(Stringf("Failed to join the host at %s.", NetSystem::SockAddrToString((sockaddr*)&sender.address)), RGBA::RED);
-    Console::instance->PrintLine(Stringf("Reason: %s", NetSession::GetErrorCodeCstr(code)), RGBA::VAPORWAVE);
+    sender.session->m_OnStatusMessage.Trigger(Stringf("Failed to join the host at %s.", NetAddress::SockAddrToString((sockaddr*)&sender.address)), RGBA::RED);
+    sender.session->m_OnStatusMessage.Trigger(Stringf("Reason: %s", NetSession::GetErrorCodeCstr(code)), RGBA::VAPORWAVE);
     sender.session->m_lastError = code;
 
     sender.session->SetSessionState(NetSession::DISCONNECTED);
@@ -429,6 +669,8 @@ void OnJoinRequestReceived(const NetSender& sender, NetMessage& msg)
 {
     NetSession* sp = sender.session;
     const char* guid = msg.ReadString();
+    uint32_t compressionId = 0;
+    msg.Read<uint32_t>(compressionId);
 
     if (sp->m_myConnection != sp->m_hostConnection)
     {
@@ -454,16 +696,35 @@ void OnJoinRequestReceived(const NetSender& sender, NetMessage& msg)
         return;
     }
 
+    //Compression is on for the connection if the joiner has the same compressor we do. It already has it, so the accept can go out compressed.
     NetConnection* cp = sp->CreateConnection(sp->GetNextAvailableIndex(), guid, sender.address);
+    cp->m_compressionId = (compressionId == sp->m_packetCompressor.GetId()) ? compressionId : 0;
     NetMessage accept(NetMessage::CoreMessageTypes::JOIN_ACCEPT);
 #pragma todo("Make this a 'writeConnInfo' function")
     accept.WriteString(sp->GetHostConnection()->m_guid);
-    accept.Write<uint8_t>(sp->GetHostConnection()->m_index);
+    accept.Write<uint16_t>(sp->GetHostConnection()->m_index);
     accept.WriteString(cp->m_guid);
-    accept.Write<uint8_t>(cp->m_index);
+    accept.Write<uint16_t>(cp->m_index);
+    accept.Write<uint32_t>(cp->m_compressionId);
     cp->SendMessage(accept);
 }
 
+//-----------------------------------------------------------------------------------
+//The messages the session itself needs to ping, join, leave and replicate. Every session in the process must register these.
+void NetSession::RegisterCoreMessages()
+{
+    RegisterMessage((uint8_t)NetMessage::PING, "ping", &OnPingReceived, (uint32_t)NetMessage::Option::UNRELIABLE, (uint32_t)NetMessage::Control::PROCESS_CONNECTIONLESS);
+    RegisterMessage((uint8_t)NetMessage::PONG, "pong", &OnPongReceived, (uint32_t)NetMessage::Option::UNRELIABLE, (uint32_t)NetMessage::Control::PROCESS_CONNECTIONLESS);
+    RegisterMessage((uint8_t)NetMessage::HEARTBEAT, "<3", &OnHeartbeatReceived, (uint32_t)NetMessage::Option::RELIABLE, (uint32_t)NetMessage::Control::NONE);
+    RegisterMessage((uint8_t)NetMessage::INORDER_HEARTBEAT, "Inorder<3", &OnHeartbeatReceived, (uint32_t)NetMessage::Option::RELIABLE | (uint32_t)NetMessage::Option::INORDER, (uint32_t)NetMessage::Control::NONE);
+    RegisterMessage((uint8_t)NetMessage::JOIN_REQUEST, "joinRequest", &OnJoinRequestReceived, (uint32_t)NetMessage::Option::RELIABLE, (uint32_t)NetMessage::Control::PROCESS_CONNECTIONLESS);
+    RegisterMessage((uint8_t)NetMessage::JOIN_ACCEPT, "joinAccept", &OnJoinAcceptReceived, (uint32_t)NetMessage::Option::RELIABLE | (uint32_t)NetMessage::Option::INORDER, (uint32_t)NetMessage::Control::NONE);
+    RegisterMessage((uint8_t)NetMessage::JOIN_DENY, "joinDeny", &OnJoinDenyReceived, (uint32_t)NetMessage::Option::UNRELIABLE, (uint32_t)NetMessage::Control::NONE);
+    RegisterMessage((uint8_t)NetMessage::CONNECTION_LEAVE, "connectionLeave", &OnConnectionLeaveReceived, (uint32_t)NetMessage::Option::UNRELIABLE, (uint32_t)NetMessage::Control::PROCESS_CONNECTIONLESS);
+    RegisterMessage((uint8_t)NetMessage::SNAPSHOT, "snapshot", &OnSnapshotReceived, (uint32_t)NetMessage::Option::UNRELIABLE, (uint32_t)NetMessage::Control::NONE, 1);
+    RegisterMessage((uint8_t)NetMessage::FRAGMENT, "fragment", &OnFragmentReceived, (uint32_t)NetMessage::Option::RELIABLE, (uint32_t)NetMessage::Control::NONE);
+}
+
 //-----------------------------------------------------------------------------------
 void NetSession::SendDeny(ErrorCode reason, const sockaddr_in& address)
 {
@@ -473,86 +734,12 @@ void NetSession::SendDeny(ErrorCode reason, const sockaddr_in& address)
     SendMessageDirect(address, deny);
 }
 
-//-----------------------------------------------------------------------------------
-void NetSession::UpdateNetDebug()
-{
-    if (!NetSession::instance)
-    {
-        ShutdownNetDebug();
-        return;
-    }
-    if (m_sessionInfoText)
-    {
-        sockaddr_in addr = m_packetChannel.GetAddress();
-        const sockaddr* address = m_packetChannel.IsBound() ? (const sockaddr*)&addr : nullptr;
-        m_sessionInfoText->text = Stringf("Session bound to [%s] - State: %s", NetSystem::SockAddrToString(address), GetStateCstr(m_sessionState));
-    }
-    if (m_netLagText)
-    {
-        m_netLagText->text = Stringf("Simulated Net Lag: %.0fms ~ %.0fms", m_packetChannel.m_additionalLagMilliseconds.minValue, m_packetChannel.m_additionalLagMilliseconds.maxValue);
-    }
-    if (m_netLossText)
-    {
-        m_netLossText->text = Stringf("Simulated Net Loss: %.2f%%", m_packetChannel.m_dropRate * 100.0f);
-    }
-    if (m_connectionCountText)
-    {
-        m_connectionCountText->text = Stringf("Connection Count: %i/%i", m_numConnections, MAX_CONNECTIONS);
-    }
-    if (m_connectionsText.size() > 0)
-    {
-        for (unsigned int i = 0; i < NetSession::MAX_CONNECTIONS; ++i)
-        {
-            ColoredText* textLine = m_connectionsText[i];
-            NetConnection* conn = GetConnection((uint8_t)i);
-            if (textLine)
-            {
-                if (conn)
-                {
-                    textLine->text = Stringf("%s%s[%i %s] %s <%s> lRcv[%.0fms] lSnd[%.0fms] sAck[%i] cAck[%i]",
-                        conn->IsMyConnection() ? "*" : " ",
-                        conn->IsHostConnection() ? "H" : " ",
-                        i,
-                        NetSystem::SockAddrToString((const sockaddr*)&conn->m_address),
-                        conn->m_guid,
-                        conn->GetStateCstr(),
-                        conn->m_lastRecievedTimeMs,
-                        conn->m_lastSentTimeMs,
-                        conn->GetLastSentAck(),
-                        conn->GetMostRecentConfirmedAck());
-                }
-                else
-                {
-                    textLine->text = Stringf("  [%i] No Connection", i);
-                }
-            }
-        }
-    }
-}
-
-//-----------------------------------------------------------------------------------
-void NetSession::ShutdownNetDebug()
-{
-    m_sessionInfoText = nullptr;
-    m_netLagText = nullptr;
-    m_netLossText = nullptr;
-    m_connectionCountText = nullptr;
-    for (unsigned int i = 0; i < m_connectionsText.size(); ++i)
-    {
-        m_connectionsText[i] = nullptr;
-    }
-}
-
 //-----------------------------------------------------------------------------------
 void NetSession::Host(const char* username)
 {
-    const int MAX_CHARACTERS = 32;
-    char portString[MAX_CHARACTERS];
     ASSERT_OR_DIE(m_sessionState == DISCONNECTED, "Wasn't in a valid state before hosting");
     SetSessionState(HOSTING);
-    _itoa_s(htons(m_packetChannel.GetAddress().sin_port), portString, 10);
-    sockaddr_in localAddress = *(sockaddr_in*)NetSystem::GetLocalHostAddressUDP(portString);
-    m_hostConnection = CreateConnection(0, username, localAddress);
+    m_hostConnection = CreateConnection(0, username, GetAddress());
     m_myConnection = m_hostConnection;
     SetSessionState(CONNECTED);
 }
@@ -563,9 +750,10 @@ void NetSession::Join(const char* username, sockaddr_in& hostAddress)
     SetSessionState(JOINING);
     m_hostConnection = CreateConnection(0, "hostDefault", hostAddress);
     m_myConnection = new NetConnection(INVALID_CONNECTION_INDEX, username, GetAddress(), this);
-    m_timeLastJoinRequestSent = GetCurrentTimeMilliseconds();
+    m_timeLastJoinRequestSent = GetNetTimeMilliseconds();
     NetMessage request(NetMessage::CoreMessageTypes::JOIN_REQUEST);
     request.WriteString(username);
+    request.Write<uint32_t>(m_packetCompressor.GetId());
     m_hostConnection->SendMessage(request);
     //SendMessageDirect(hostAddress, request);
 }
@@ -575,9 +763,9 @@ void NetSession::Leave()
 {
     ASSERT_OR_DIE(m_sessionState == CONNECTED, "Wasn't connected before leaving");
     NetMessage leaveMessage(NetMessage::CoreMessageTypes::CONNECTION_LEAVE);
-    for (NetConnection* conn : m_allConnections)
+    for (NetConnection* conn : m_activeConnections)
     {
-        if (conn && conn != m_myConnection)
+        if (conn != m_myConnection)
         {
             SendMessageDirect(conn->m_address, leaveMessage);
         }
@@ -591,17 +779,18 @@ void NetSession::Leave()
 }
 
 //------------------------------------------------------------------------
-bool NetSession::Connect(NetConnection* cp, const uint8_t idx)
+bool NetSession::Connect(NetConnection* cp, const uint16_t idx)
 {
     //This guy better not be connected, and this slot needs to be free
     ASSERT_OR_DIE(!cp->IsConnected(), "Attempted to reconnect a connected connection");
-    if (GetConnection(idx) != nullptr)
+    if (idx >= MAX_CONNECTIONS || GetConnection(idx) != nullptr)
     {
         return false;
     }
 
     cp->m_index = idx;
     m_allConnections[idx] = cp;
+    AddActiveConnection(cp);
 
     // If you're the host, and in a P2P environment
     // you would tell everyone else about this connection
@@ -624,10 +813,9 @@ bool NetSession::Connect(NetConnection* cp, const uint8_t idx)
         // Finally, if this is me, trigger everyone else
         if (cp->IsMyConnection()) 
         {
-            for (size_t i = 0; i < MAX_CONNECTIONS; ++i) 
+            for (NetConnection* otherConnection : m_activeConnections) 
             {
-                NetConnection* otherConnection = m_allConnections[i];
-                if ((nullptr != otherConnection) && (cp != otherConnection) && !otherConnection->IsHostConnection()) 
+                if ((cp != otherConnection) && !otherConnection->IsHostConnection()) 
                 {
                     m_OnConnectionJoin.Trigger(otherConnection);
                 }
@@ -639,7 +827,7 @@ bool NetSession::Connect(NetConnection* cp, const uint8_t idx)
 }
 
 //-----------------------------------------------------------------------------------
-void NetSession::Disconnect(uint8_t index)
+void NetSession::Disconnect(uint16_t index)
 {
     Disconnect(m_allConnections[index]);
 }
@@ -654,7 +842,7 @@ void NetSession::Disconnect(NetConnection* cp)
         return;
     }
 
-    uint8_t const idx = cp->m_index;
+    uint16_t const idx = cp->m_index;
     ASSERT_OR_DIE(m_allConnections[idx] == cp, "Passed a nonexistant connection to disconnect");
 
     // Not connected - just remove it silently.
@@ -682,11 +870,11 @@ void NetSession::Disconnect(NetConnection* cp)
     if (cp->IsMyConnection()) 
     {
         // Disconnect everyone else in the session that is NOT the host
-        // and NOT me.
-        for (size_t i = 0; i < MAX_CONNECTIONS; ++i) 
+        // and NOT me. Backwards, since each one removed swaps the last into its place.
+        for (size_t i = m_activeConnections.size(); i > 0; --i) 
         {
-            NetConnection* other_cp = m_allConnections[i];
-            if ((nullptr != other_cp) && !other_cp->IsMyConnection() && !other_cp->IsHostConnection()) 
+            NetConnection* other_cp = m_activeConnections[i - 1];
+            if (!other_cp->IsMyConnection() && !other_cp->IsHostConnection()) 
             {
                 Disconnect(other_cp);
             }
@@ -695,10 +883,13 @@ void NetSession::Disconnect(NetConnection* cp)
 
     // Disconnect the guy, or me, if that is the case.
     // Condition of event is connection is removed from array, but before destroyed
+    // Asked before destroying it, cp is gone after.
+    bool wasMyConnection = cp->IsMyConnection();
+    bool wasHostConnection = cp->IsHostConnection();
     DestroyConnection(idx);
 
     // I'm disconnecting myself, and I'm not the host, finally disconnect the host last
-    if (cp->IsMyConnection() && (m_hostConnection != nullptr) && !cp->IsHostConnection()) 
+    if (wasMyConnection && (m_hostConnection != nullptr) && !wasHostConnection) 
     {
         DestroyConnection(m_hostConnection->m_index);
         ASSERT_OR_DIE(m_hostConnection == nullptr, "Failed to set the host connection ptr back to nullptr");
@@ -712,11 +903,17 @@ void NetSession::CheckForTimeouts()
     {
         return;
     }
-    for (NetConnection* conn : m_allConnections)
+    //Backwards, since disconnecting swaps the last connection into the hole. Losing the host takes everyone with it, hence the size check.
+    for (size_t i = m_activeConnections.size(); i > 0; --i)
     {
-        if (conn && !conn->IsMyConnection())
+        if (i > m_activeConnections.size())
+        {
+            continue;
+        }
+        NetConnection* conn = m_activeConnections[i - 1];
+        if (!conn->IsMyConnection())
         {
-            double msSinceLastContact = GetCurrentTimeMilliseconds() - conn->m_lastRecievedTimeMs;
+            double msSinceLastContact = GetNetTimeMilliseconds() - conn->m_lastRecievedTimeMs;
             if (msSinceLastContact >= NetConnection::BAD_CONNECTION_TIME_MS)
             {
                 conn->m_state = NetConnection::State::BAD;
@@ -752,9 +949,9 @@ const char* NetSession::GetStateCstr(const NetSession::State& state)
 //-----------------------------------------------------------------------------------
 void NetSession::OnEnterDisconnectedState()
 {
-    for (uint8_t i = 0; i < MAX_CONNECTIONS; ++i)
+    while (!m_activeConnections.empty())
     {
-        Disconnect(m_allConnections[i]);
+        Disconnect(m_activeConnections.back());
     }
     //Check to make sure we aren't leaking a placeholder connection
     if (m_myConnection && m_myConnection->m_index == INVALID_CONNECTION_INDEX)
@@ -768,15 +965,7 @@ void NetSession::OnEnterDisconnectedState()
 //-----------------------------------------------------------------------------------
 bool NetSession::HasConnectionFor(const sockaddr_in& address)
 {
-    for (uint8_t i = 0; i < MAX_CONNECTIONS; ++i)
-    {
-        NetConnection* conn = m_allConnections[i];
-        if (conn && NetSystem::SockaddrCompare(address, conn->m_address) == 0)
-        {
-            return true;
-        }
-    }
-    return false;
+    return FindConnection(address) != nullptr;
 }
 
 //-----------------------------------------------------------------------------------
@@ -788,10 +977,9 @@ bool NetSession::IsPartyFull()
 //-----------------------------------------------------------------------------------
 bool NetSession::IsGuidInUse(const char* guid)
 {
-    for (uint8_t i = 0; i < MAX_CONNECTIONS; ++i)
+    for (NetConnection* conn : m_activeConnections)
     {
-        NetConnection* conn = m_allConnections[i];
-        if (conn && strcmp(guid, conn->m_guid) == 0)
+        if (strcmp(guid, conn->m_guid) == 0)
         {
             return true;
         }
@@ -800,9 +988,10 @@ bool NetSession::IsGuidInUse(const char* guid)
 }
 
 //-----------------------------------------------------------------------------------
-uint8_t NetSession::GetNextAvailableIndex()
+//Lowest free index. Only runs when someone joins, so the scan isn't worth a free list.
+uint16_t NetSession::GetNextAvailableIndex()
 {
-    for (uint8_t i = 0; i < MAX_CONNECTIONS; ++i)
+    for (uint16_t i = 0; i < MAX_CONNECTIONS; ++i)
     {
         NetConnection* conn = m_allConnections[i];
         if (!conn)
@@ -820,10 +1009,10 @@ void NetSession::CheckForJoinResponse()
     {
         return;
     }
-    if (GetCurrentTimeMilliseconds() - m_timeLastJoinRequestSent >= NetConnection::TIMEOUT_TIME_MS)
+    if (GetNetTimeMilliseconds() - m_timeLastJoinRequestSent >= NetConnection::TIMEOUT_TIME_MS)
     {
         m_lastError = JOIN_ERROR_HOST_TIMEOUT;
-        Console::instance->PrintLine(Stringf("Failed to join the host. Reason: %s", NetSession::GetErrorCodeCstr(m_lastError)), RGBA::RED);
+        m_OnStatusMessage.Trigger(Stringf("Failed to join the host. Reason: %s", NetSession::GetErrorCodeCstr(m_lastError)), RGBA::RED);
         SetSessionState(DISCONNECTED);
         OnEnterDisconnectedState();
     }
@@ -872,7 +1061,7 @@ bool NetSession::CanProcessMessage(const NetSender& from, const NetMessage& msg)
 {
     if (from.connection == nullptr)
     {
-        return !msg.RequiresConnection();
+        return !msg.RequiresConnection(*this);
     }
     else
     {
@@ -915,457 +1104,3 @@ void NetMessageDefinition::ClearControlFlag(NetMessage::Control flag)
 {
     m_controlFlags &= ~(uint8_t)flag;
 }
-
-//-----------------------------------------------------------------------------------
-CONSOLE_COMMAND(nsinit)
-{
-    UNUSED(args)
-    if (nullptr != NetSession::instance)
-    {
-        Console::instance->PrintLine("Net session already initialized.", RGBA::ORANGE);
-        return;
-    }
-
-    NetSession::instance = new NetSession(1.0f/60.0f);
-    NetworkCleanup.RegisterMethod(NetSession::instance, &NetSession::Cleanup);
-
-    // Setup
-    NetSession::instance->RegisterMessage((uint8_t)NetMessage::PING, "ping", &OnPingReceived, (uint32_t)NetMessage::Option::UNRELIABLE, (uint32_t)NetMessage::Control::PROCESS_CONNECTIONLESS);
-    NetSession::instance->RegisterMessage((uint8_t)NetMessage::PONG, "pong", &OnPongReceived, (uint32_t)NetMessage::Option::UNRELIABLE, (uint32_t)NetMessage::Control::PROCESS_CONNECTIONLESS);
-    NetSession::instance->RegisterMessage((uint8_t)NetMessage::HEARTBEAT, "<3", &OnHeartbeatReceived, (uint32_t)NetMessage::Option::RELIABLE, (uint32_t)NetMessage::Control::NONE);
-    NetSession::instance->RegisterMessage((uint8_t)NetMessage::INORDER_HEARTBEAT, "Inorder<3", &OnHeartbeatReceived, (uint32_t)NetMessage::Option::RELIABLE | (uint32_t)NetMessage::Option::INORDER, (uint32_t)NetMessage::Control::NONE);
-    NetSession::instance->RegisterMessage((uint8_t)NetMessage::JOIN_REQUEST, "joinRequest", &OnJoinRequestReceived, (uint32_t)NetMessage::Option::RELIABLE, (uint32_t)NetMessage::Control::PROCESS_CONNECTIONLESS);
-    NetSession::instance->RegisterMessage((uint8_t)NetMessage::JOIN_ACCEPT, "joinAccept", &OnJoinAcceptReceived, (uint32_t)NetMessage::Option::RELIABLE | (uint32_t)NetMessage::Option::INORDER, (uint32_t)NetMessage::Control::NONE);
-    NetSession::instance->RegisterMessage((uint8_t)NetMessage::JOIN_DENY, "joinDeny", &OnJoinDenyReceived, (uint32_t)NetMessage::Option::UNRELIABLE, (uint32_t)NetMessage::Control::NONE);
-    NetSession::instance->RegisterMessage((uint8_t)NetMessage::CONNECTION_LEAVE, "connectionLeave", &OnConnectionLeaveReceived, (uint32_t)NetMessage::Option::UNRELIABLE, (uint32_t)NetMessage::Control::PROCESS_CONNECTIONLESS);
-}
-
-//-----------------------------------------------------------------------------------
-CONSOLE_COMMAND(nsstart)
-{
-    UNUSED(args)
-    if (NetSession::instance && NetSession::instance->Start(GAME_PORT_STR))
-    {
-        // Log Success and Connection Address
-        Console::instance->PrintLine(Stringf("Successfully created session at [%s]", NetSystem::SockAddrToString((sockaddr*)&NetSession::instance->m_packetChannel.m_socket.m_address)), RGBA::BADDAD);
-    }
-    else 
-    {
-        Console::instance->PrintLine("Failed to bring the net session online.", RGBA::RED);
-        delete NetSession::instance;
-        NetSession::instance = nullptr;
-    }
-}
-
-//-----------------------------------------------------------------------------------
-CONSOLE_COMMAND(nscleanup)
-{
-    UNUSED(args)
-    if (nullptr == NetSession::instance)
-    {
-        Console::instance->PrintLine("Net session isn't running.", RGBA::ORANGE);
-        return;
-    }
-
-    NetSession::instance->Cleanup();
-    NetworkCleanup.UnregisterMethod(NetSession::instance, &NetSession::Cleanup);
-}
-
-//-----------------------------------------------------------------------------------
-CONSOLE_COMMAND(nsstop)
-{
-    UNUSED(args)
-    if (nullptr == NetSession::instance)
-    {
-        Console::instance->PrintLine("Net session isn't running.", RGBA::ORANGE);
-        return;
-    }
-
-    NetSession::instance->Stop();
-}
-
-//-----------------------------------------------------------------------------------
-CONSOLE_COMMAND(ping)
-{
-    if (!(args.HasArgs(0) || args.HasArgs(1) || args.HasArgs(2)))
-    {
-        Console::instance->PrintLine("ping <ip address> [optional message]", RGBA::RED);
-        return;
-    }
-    if (NetSession::instance != nullptr)
-    {
-        // so it's expecting a full address string,
-        // ex: 192.168.52.127:4334
-        sockaddr_in to;
-        if (args.HasArgs(0))
-        {
-            to = *(sockaddr_in*)NetSystem::GetLocalHostAddressUDP(GAME_PORT_STR);
-        }
-        else
-        {
-            std::string fullIPString = args.GetStringArgument(0);
-            size_t portLocation = fullIPString.find(":");
-            if (portLocation == fullIPString.npos)
-            {
-                to = NetSystem::StringToSockAddrIPv4(fullIPString.c_str(), GAME_PORT);
-            }
-            else
-            {
-                std::string ipPart = fullIPString.substr(0, portLocation);
-                std::string portPart = fullIPString.substr(portLocation + 1, fullIPString.length() - portLocation);
-                to = NetSystem::StringToSockAddrIPv4(ipPart.c_str(), (uint16_t)std::stoi(portPart));
-            }
-        }
-
-        NetMessage msg(NetMessage::PING);
-        const char* optionalMessage = nullptr;
-        std::string message;
-        if (args.HasArgs(2))
-        {
-            message = args.GetStringArgument(1);
-            optionalMessage = message.c_str();
-        }
-        msg.WriteString(optionalMessage);
-
-        NetSession::instance->SendMessageDirect(to, msg);
-    }
-    else
-    {
-        Console::instance->PrintLine("NetSession hasn't been started yet. Please run NetSessionStart first.", RGBA::RED);
-    }
-}
-
-//-----------------------------------------------------------------------------------
-CONSOLE_COMMAND(setpacketlatency)
-{
-    if (!(args.HasArgs(1) || args.HasArgs(2)))
-    {
-        Console::instance->PrintLine("setpacketloss <latency lower bound (ms)> [latency upper bound (ms)]", RGBA::RED);
-        return;
-    }
-    if (NetSession::instance != nullptr)
-    {
-        float latencyLowerBound = args.GetFloatArgument(0);
-        float latencyUpperBound = latencyLowerBound;
-        if (args.HasArgs(2))
-        {
-            latencyUpperBound = args.GetFloatArgument(1);
-        }
-        NetSession::instance->m_packetChannel.m_additionalLagMilliseconds = Range<double>(latencyLowerBound, latencyUpperBound);
-    }
-    else
-    {
-        Console::instance->PrintLine("NetSession isn't running. Please run NetSessionStart first.", RGBA::RED);
-    }
-}
-
-//-----------------------------------------------------------------------------------
-CONSOLE_COMMAND(setpacketloss)
-{
-    if (!(args.HasArgs(1)))
-    {
-        Console::instance->PrintLine("setpacketloss <float lossPercentage>", RGBA::RED);
-        return;
-    }
-    if (NetSession::instance != nullptr)
-    {
-        float lossPercentage = args.GetFloatArgument(0);
-        if (lossPercentage < 0.0f || lossPercentage > 1.0f)
-        {
-            Console::instance->PrintLine("Please enter a percentage between 0 and 1.", RGBA::RED);
-            return;
-        }
-        NetSession::instance->m_packetChannel.m_dropRate = lossPercentage;
-    }
-    else
-    {
-        Console::instance->PrintLine("NetSession isn't running. Please run NetSessionStart first.", RGBA::RED);
-    }
-}
-
-//-----------------------------------------------------------------------------------
-CONSOLE_COMMAND(nscreateconn)
-{
-    if (!(args.HasArgs(3)))
-    {
-        Console::instance->PrintLine("nscreateconn <index> <guid> <address>", RGBA::RED);
-        return;
-    }
-    if (nullptr != NetSession::instance)
-    {
-        sockaddr_in address;
-        std::string guid = args.GetStringArgument(1);
-        std::string fullIPString = args.GetStringArgument(2);
-
-        size_t portLocation = fullIPString.find(":");
-        if (portLocation == fullIPString.npos)
-        {
-            address = NetSystem::StringToSockAddrIPv4(fullIPString.c_str(), GAME_PORT);
-        }
-        else
-        {
-            std::string ipPart = fullIPString.substr(0, portLocation);
-            std::string portPart = fullIPString.substr(portLocation + 1, fullIPString.length() - portLocation);
-            address = NetSystem::StringToSockAddrIPv4(ipPart.c_str(), (uint16_t)std::stoi(portPart));
-        }
-
-        NetSession::instance->CreateConnection((uint8_t)args.GetIntArgument(0), guid.c_str(), address);
-        Console::instance->PrintLine(Stringf("Created connection at index %i", args.GetIntArgument(0)), RGBA::ORANGE);
-    }
-    else
-    {
-        Console::instance->PrintLine("NetSession isn't running. Please run NetSessionStart first.", RGBA::RED);
-    }
-}
-
-//-----------------------------------------------------------------------------------
-CONSOLE_COMMAND(nsdestroyconn)
-{
-    if (!(args.HasArgs(1)))
-    {
-        Console::instance->PrintLine("nscreateconn <index>", RGBA::RED);
-        return;
-    }
-    if (nullptr != NetSession::instance)
-    {
-        NetSession::instance->Disconnect((uint8_t)args.GetIntArgument(0));
-        Console::instance->PrintLine(Stringf("Destroyed connection at index %i", args.GetIntArgument(0)), RGBA::ORANGE);        
-    }
-    else
-    {
-        Console::instance->PrintLine("NetSession isn't running. Please run NetSessionStart first.", RGBA::RED);
-    }
-}
-
-//-----------------------------------------------------------------------------------
-CONSOLE_COMMAND(nsdebug)
-{
-    UNUSED(args);
-    if (!NetSession::instance)
-    {
-        Console::instance->PrintLine("Error: NetSession not initialized. Run nsinit.", RGBA::SEA_GREEN);
-        return;
-    }
-    NetSession::instance->m_sessionInfoText = Console::instance->PrintDynamicLine("Session bound to [null]", RGBA::CHOCOLATE);
-    NetSession::instance->m_netLagText = Console::instance->PrintDynamicLine("Simulated Net Lag: null", RGBA::CHOCOLATE);
-    NetSession::instance->m_netLossText = Console::instance->PrintDynamicLine("Simulated Net Loss: null", RGBA::CHOCOLATE);
-    NetSession::instance->m_connectionCountText = Console::instance->PrintDynamicLine("Connection Count: null", RGBA::CHOCOLATE);
-    NetSession::instance->m_connectionsText.clear();
-    for (unsigned int i = 0; i < NetSession::MAX_CONNECTIONS; ++i)
-    {
-        NetSession::instance->m_connectionsText.push_back(Console::instance->PrintDynamicLine(Stringf("  [%i] No Connection", i), RGBA::CHOCOLATE));
-    }
-    Console::instance->m_consoleUpdate.RegisterMethod(NetSession::instance, &NetSession::UpdateNetDebug);
-    Console::instance->m_consoleClear.RegisterMethod(NetSession::instance, &NetSession::ShutdownNetDebug);
-}
-
-//-----------------------------------------------------------------------------------
-CONSOLE_COMMAND(toggletimeout)
-{
-    UNUSED(args);
-    NetSession::instance->m_timeoutEnabled = !NetSession::instance->m_timeoutEnabled;
-    const char* enabledText = NetSession::instance->m_timeoutEnabled ? "Enabled" : "Disabled";
-    Console::instance->PrintLine(Stringf("Net Session timeout %s.", enabledText));
-}
-
-//-----------------------------------------------------------------------------------
-CONSOLE_COMMAND(hb)
-{
-    if (!(args.HasArgs(0) || args.HasArgs(1)))
-    {
-        Console::instance->PrintLine("hb <ip address>", RGBA::RED);
-        return;
-    }
-    if (NetSession::instance != nullptr)
-    {
-        // so it's expecting a full address string,
-        // ex: 192.168.52.127:4334
-        sockaddr_in to;
-        if (args.HasArgs(0))
-        {
-            to = *(sockaddr_in*)NetSystem::GetLocalHostAddressUDP(GAME_PORT_STR);
-        }
-        else
-        {
-            std::string fullIPString = args.GetStringArgument(0);
-            size_t portLocation = fullIPString.find(":");
-            if (portLocation == fullIPString.npos)
-            {
-                to = NetSystem::StringToSockAddrIPv4(fullIPString.c_str(), GAME_PORT);
-            }
-            else
-            {
-                std::string ipPart = fullIPString.substr(0, portLocation);
-                std::string portPart = fullIPString.substr(portLocation + 1, fullIPString.length() - portLocation);
-                to = NetSystem::StringToSockAddrIPv4(ipPart.c_str(), (uint16_t)std::stoi(portPart));
-            }
-        }
-
-        NetMessage msg(NetMessage::HEARTBEAT);
-        NetConnection* conn = NetSession::instance->GetConnection(NetSession::instance->GetConnectionIndexFromAddress(to));
-        conn->SendMessage(msg);
-    }
-    else
-    {
-        Console::instance->PrintLine("NetSession hasn't been initialized yet. Please run nsinit first.", RGBA::RED);
-    }
-}
-
-//-----------------------------------------------------------------------------------
-CONSOLE_COMMAND(iohb)
-{
-    if (!(args.HasArgs(0) || args.HasArgs(1)))
-    {
-        Console::instance->PrintLine("iohb <ip address>", RGBA::RED);
-        return;
-    }
-    if (NetSession::instance != nullptr)
-    {
-        // so it's expecting a full address string,
-        // ex: 192.168.52.127:4334
-        sockaddr_in to;
-        if (args.HasArgs(0))
-        {
-            to = *(sockaddr_in*)NetSystem::GetLocalHostAddressUDP(GAME_PORT_STR);
-        }
-        else
-        {
-            std::string fullIPString = args.GetStringArgument(0);
-            size_t portLocation = fullIPString.find(":");
-            if (portLocation == fullIPString.npos)
-            {
-                to = NetSystem::StringToSockAddrIPv4(fullIPString.c_str(), GAME_PORT);
-            }
-            else
-            {
-                std::string ipPart = fullIPString.substr(0, portLocation);
-                std::string portPart = fullIPString.substr(portLocation + 1, fullIPString.length() - portLocation);
-                to = NetSystem::StringToSockAddrIPv4(ipPart.c_str(), (uint16_t)std::stoi(portPart));
-            }
-        }
-
-        NetMessage msg(NetMessage::INORDER_HEARTBEAT);
-        NetConnection* conn = NetSession::instance->GetConnection(NetSession::instance->GetConnectionIndexFromAddress(to));
-        conn->SendMessage(msg);
-    }
-    else
-    {
-        Console::instance->PrintLine("NetSession hasn't been initialized yet. Please run nsinit first.", RGBA::RED);
-    }
-}
-
-//-----------------------------------------------------------------------------------
-CONSOLE_COMMAND(nethost)
-{
-    if (!(args.HasArgs(0) || args.HasArgs(1)))
-    {
-        Console::instance->PrintLine("nethost <username>", RGBA::RED);
-        return;
-    }
-    if (NetSession::instance != nullptr)
-    {
-        if (NetSession::instance->m_hostConnection != nullptr)
-        {
-            Console::instance->PrintLine("Already have a host connection", RGBA::SADDLE_BROWN);
-            return;
-        }
-        if (NetSession::instance->GetSessionState() != NetSession::DISCONNECTED)
-        {
-            Console::instance->PrintLine("In an invalid state, must be disconnected to run this command", RGBA::SADDLE_BROWN);
-            return;
-        }
-        std::string username;
-        if (args.HasArgs(0))
-        {
-            username = NetSystem::GetLocalHostName();
-        }
-        else
-        {
-            username = args.GetStringArgument(0);
-        }
-        NetSession::instance->Host(username.c_str());
-        Console::instance->PrintLine("Began hosting.", RGBA::SADDLE_BROWN);
-    }
-    else
-    {
-        Console::instance->PrintLine("NetSession hasn't been initialized yet. Please run nsinit first.", RGBA::RED);
-    }
-}
-
-//-----------------------------------------------------------------------------------
-CONSOLE_COMMAND(netleave)
-{
-    UNUSED(args)
-    if (NetSession::instance != nullptr)
-    {
-        if (NetSession::instance->GetSessionState() != NetSession::CONNECTED)
-        {
-            Console::instance->PrintLine("Not currently connected", RGBA::KHAKI);
-            return;
-        }
-        NetSession::instance->Leave();
-        Console::instance->PrintLine("Left the session.", RGBA::KHAKI);
-    }
-    else
-    {
-        Console::instance->PrintLine("NetSession hasn't been initialized yet. Please run nsinit first.", RGBA::RED);
-    }
-}
-
-//-----------------------------------------------------------------------------------
-CONSOLE_COMMAND(netjoin)
-{
-    if (!(args.HasArgs(2)))
-    {
-        Console::instance->PrintLine("netjoin <username> <hostaddr : hostport>", RGBA::RED);
-        return;
-    }
-    if (NetSession::instance != nullptr)
-    {
-        if (NetSession::instance->m_hostConnection != nullptr)
-        {
-            Console::instance->PrintLine("Already have a host connection", RGBA::SADDLE_BROWN);
-            return;
-        }
-        if (NetSession::instance->GetSessionState() != NetSession::DISCONNECTED)
-        {
-            Console::instance->PrintLine("In an invalid state, must be disconnected to run this command", RGBA::SADDLE_BROWN);
-            return;
-        }
-        sockaddr_in address;
-        std::string guid = args.GetStringArgument(0);
-        std::string fullIPString = args.GetStringArgument(1);
-
-        size_t portLocation = fullIPString.find(":");
-        if (portLocation == fullIPString.npos)
-        {
-            address = NetSystem::StringToSockAddrIPv4(fullIPString.c_str(), GAME_PORT);
-        }
-        else
-        {
-            std::string ipPart = fullIPString.substr(0, portLocation);
-            std::string portPart = fullIPString.substr(portLocation + 1, fullIPString.length() - portLocation);
-            address = NetSystem::StringToSockAddrIPv4(ipPart.c_str(), (uint16_t)std::stoi(portPart));
-        }
-
-        NetSession::instance->Join(guid.c_str(), address);
-        Console::instance->PrintLine("Submitted request to join.", RGBA::SADDLE_BROWN);
-    }
-    else
-    {
-        Console::instance->PrintLine("NetSession hasn't been initialized yet. Please run nsinit first.", RGBA::RED);
-    }
-}
-
-//-----------------------------------------------------------------------------------
-CONSOLE_COMMAND(go)
-{
-    UNUSED(args)
-    Console::instance->RunCommand("csjoin");
-    //Console::instance->RunCommand("bcmd nscreateconn 0 right 192.168.0.4:4334");
-    //Console::instance->RunCommand("bcmd nscreateconn 1 left 192.168.0.4:4335");    
-    Console::instance->RunCommand("bcmd nscreateconn 0 right 10.8.151.65:4334");
-    Console::instance->RunCommand("bcmd nscreateconn 1 left 10.8.151.65:4335");
-    Console::instance->RunCommand("nsdebug");
-    Console::instance->RunCommand("rcmd nsdebug");
-}
\ No newline at end of file
@@ -1,16 +1,22 @@
 #pragma once
 #include "Engine/Net/UDPIP/PacketChannel.hpp"
 #include "Engine/Net/UDPIP/NetMessage.hpp"
+#include "Engine/Net/UDPIP/NetMessagePool.hpp"
+#include "Engine/Net/UDPIP/SnapshotReplicator.hpp"
+#include "Engine/Net/UDPIP/InterestManager.hpp"
+#include "Engine/Net/UDPIP/PacketCompressor.hpp"
 #include "Engine/Core/Events/Event.hpp"
+#include "Engine/Renderer/RGBA.hpp"
+#include <vector>
+#include <unordered_map>
+#include <string>
 
 #define GAME_PORT_STR "4334"
 #define GAME_PORT 4334
-#define PACKET_MTU 1232
 #define MESSAGE_MTU 1024
 
 class NetSession;
 class NetConnection;
-struct ColoredText;
 
 //-----------------------------------------------------------------------------------
 struct NetSender
@@ -28,6 +34,7 @@ struct NetSender
 };
 
 typedef void(NetMessageCallback)(const NetSender&, NetMessage&);
+typedef void(NetLargeMessageCallback)(const NetSender&, const byte* data, size_t numBytes);
 
 //-----------------------------------------------------------------------------------
 struct NetMessageDefinition
@@ -37,8 +44,10 @@ struct NetMessageDefinition
         : id(0)
         , debugName(nullptr)
         , callbackFunction(nullptr)
+        , largeCallbackFunction(nullptr)
         , m_controlFlags(0)
         , m_optionFlags(0)
+        , priority(0)
     {};
 
     //FUNCTIONS/////////////////////////////////////////////////////////////////////
@@ -53,8 +62,10 @@ struct NetMessageDefinition
     uint8_t id;
     uint32_t m_controlFlags;
     uint32_t m_optionFlags;
+    uint8_t priority; //Priority class, see NetConnection::AttachByPriority. Higher classes get more of the send budget and go out first.
     const char* debugName;
     NetMessageCallback* callbackFunction;
+    NetLargeMessageCallback* largeCallbackFunction; //Set instead of callbackFunction for types sent with NetConnection::SendLargeMessage
 };
 
 //-----------------------------------------------------------------------------------
@@ -94,34 +105,44 @@ public:
     void Stop();
     void Cleanup();
     void Update(float deltaSeconds);
-    void UpdateNetDebug();
-    void ShutdownNetDebug();
 
     void Host(const char* username);
     void Join(const char* username, sockaddr_in& hostAddress);
     void Leave();
 
-    void ProcessIncomingPackets(const size_t maxPacketsToProcess = INFINITY);
+    void SendOutgoingPackets();
+    void ProcessIncomingPackets(const size_t maxPacketsToProcess = SIZE_MAX);
     void ProcessIncomingPacket(NetSender& from, NetPacket& packet);
-    void RegisterMessage(uint8_t type, const char* messageName, NetMessageCallback* functionPointer, uint32_t optionFlags, uint32_t controlFlags);
+    void RegisterMessage(uint8_t type, const char* messageName, NetMessageCallback* functionPointer, uint32_t optionFlags, uint32_t controlFlags, uint8_t priority = 0);
+    void RegisterCoreMessages();
+    void RegisterLargeMessage(uint8_t type, const char* messageName, NetLargeMessageCallback* functionPointer); //Always reliable, delivered in one piece once every fragment is in
+    void SetInterestUpdates(uint8_t type, InterestEntityWriter* writeEntity, size_t maxEntityBytes); //Sends each connection's picks as messages of that type every tick, null to stop
+    byte* AcquireReassemblyBuffer();
+    void ReleaseReassemblyBuffer(byte* buffer);
+    void StartRecordingPackets(unsigned int numPackets, const char* filePath); //Saved to the file once that many have gone out, or kept in m_packetRecording with no file
+    void StopRecordingPackets();
+    void RecordOutgoingPacket(const NetPacket& packet);
     void SendMessageDirect(const sockaddr_in& to, const NetMessage& msg);
     size_t SendMessagesDirect(sockaddr_in& to, NetMessage** messages, size_t numMessages);
-    bool Connect(NetConnection* cp, const uint8_t idx);
+    bool Connect(NetConnection* cp, const uint16_t idx);
     void Disconnect(NetConnection* cp);
-    void Disconnect(uint8_t index);
+    void Disconnect(uint16_t index);
     void CheckForTimeouts();
     void CheckForJoinResponse();
-    NetConnection* CreateConnection(uint8_t index, const char* guid, sockaddr_in address);
-    void DestroyConnection(uint8_t index);
+    NetConnection* CreateConnection(uint16_t index, const char* guid, sockaddr_in address);
+    void DestroyConnection(uint16_t index);
 
     //QUERIES/////////////////////////////////////////////////////////////////////
-    NetConnection* GetConnection(uint8_t index);
+    NetConnection* GetConnection(uint16_t index);
+    NetConnection* FindConnection(const sockaddr_in& address);
     inline NetConnection* GetMyConnection() { return m_myConnection; };
     inline NetConnection* GetHostConnection() { return m_hostConnection; };
-    uint8_t GetMyConnectionIndex();
-    uint8_t GetConnectionIndexFromAddress(const sockaddr_in& address);
+    inline unsigned int GetNumActiveConnections() const { return (unsigned int)m_activeConnections.size(); };
+    inline NetConnection* GetActiveConnection(unsigned int activeIndex) { return m_activeConnections[activeIndex]; }; //Order changes as connections come and go
+    uint16_t GetMyConnectionIndex();
+    uint16_t GetConnectionIndexFromAddress(const sockaddr_in& address);
     void SendDeny(ErrorCode reason, const sockaddr_in& address);
-    const NetMessageDefinition* FindDefinition(byte messageType);
+    const NetMessageDefinition* FindDefinition(byte messageType) const;
     bool CanProcessMessage(const NetSender& from, const NetMessage& msg) const;
     bool IsRunning();
     bool IsHost();
@@ -130,8 +151,9 @@ public:
     static const char* GetErrorCodeCstr(const ErrorCode& code);
     bool IsPartyFull();
     bool IsGuidInUse(const char* guid);
-    uint8_t GetNextAvailableIndex();
+    uint16_t GetNextAvailableIndex();
     sockaddr_in GetAddress() { return m_packetChannel.GetAddress(); };
+    double GetNetTimeMilliseconds() const;
 
     //STATE MANAGEMENT/////////////////////////////////////////////////////////////////////
     bool SetSessionState(State newState, void(NetSession::*onStateSwitchCallback)() = nullptr);
@@ -139,23 +161,45 @@ public:
     const char* GetStateCstr(const State& state);
     void OnEnterDisconnectedState();
     bool HasConnectionFor(const sockaddr_in& address);
+
     //CONSTANTS/////////////////////////////////////////////////////////////////////
-    static const uint8_t MAX_CONNECTIONS = 8;
-    static const uint8_t INVALID_CONNECTION_INDEX = 255;
+    static const uint16_t MAX_CONNECTIONS = 512;
+    static const uint16_t INVALID_CONNECTION_INDEX = 0xFFFF;
     static const int MAX_DEFINITIONS = 256;
+    static const size_t PACKET_BATCH_SIZE = 32; //Packets moved per transport call in each direction
+    static const unsigned int NUM_PREALLOCATED_REASSEMBLY_BUFFERS = 4;
 
     //STATIC VARIABLES/////////////////////////////////////////////////////////////////////
     static NetSession* instance;
 
     //MEMBER VARIABLES/////////////////////////////////////////////////////////////////////
     PacketChannel m_packetChannel;
+    NetMessagePool m_messagePool; //Backing storage for every connection's outgoing queues
+    SnapshotReplicator m_snapshots; //World state replication from the host, the game sets its schema and fills a snapshot each tick
+    InterestManager m_interest; //Which entities each connection hears about. Updated every tick once it has entities, and filters snapshots for connections with an area.
+    InterestEntityWriter* m_interestEntityWriter;
+    uint8_t m_interestMessageType;
+    size_t m_maxInterestEntityBytes;
+    std::vector<byte*> m_freeReassemblyBuffers; //Each MAX_LARGE_MESSAGE_BYTES, handed to connections while they put a large message together
+    unsigned int m_numReassemblyBuffers;
+    PacketCompressor m_packetCompressor; //Set before hosting or joining. A connection only compresses if the other end has the same one.
+    std::vector<unsigned char> m_packetRecording; //Outgoing packets as built, before compression, for training dictionaries
+    unsigned int m_numPacketsLeftToRecord;
+    std::string m_packetRecordingPath;
+    NetPacket m_receivePackets[PACKET_BATCH_SIZE];
+    UDPDatagram m_receiveDatagrams[PACKET_BATCH_SIZE];
+    NetPacket m_sendPackets[PACKET_BATCH_SIZE];
+    UDPDatagram m_sendDatagrams[PACKET_BATCH_SIZE];
     NetMessageDefinition m_netMessageDefinitions[MAX_DEFINITIONS]; //container of definitions
-    NetConnection* m_allConnections[MAX_CONNECTIONS];
+    NetConnection* m_allConnections[MAX_CONNECTIONS]; //By connection index, which is what packets identify their sender with
+    std::vector<NetConnection*> m_activeConnections; //Dense, so per-tick loops only visit connections that exist
+    std::unordered_map<uint64_t, NetConnection*> m_connectionsByAddress;
     NetConnection* m_myConnection;
     NetConnection* m_hostConnection;
     Event<NetConnection*> m_OnConnectionJoin;
     Event<NetConnection*> m_OnConnectionLeave;
     Event<NetConnection*> m_OnNetTick;
+    Event<const std::string&, const RGBA&> m_OnStatusMessage; //Joins, denies, pings and recordings, worded for a person to read. Nothing prints them unless something registers.
     Event<> m_OnStateSwitch; //ONE SHOT FUNCTIONS ONLY. These get registered when switching to the state, and then are fired when swapping away from that state and removed.
     float m_timeSinceLastUpdate;
     double m_timeLastJoinRequestSent;
@@ -165,11 +209,13 @@ public:
     ErrorCode m_lastError;
     bool m_timeoutEnabled;
     bool m_isListening;
-
-    //NetDebug console line references, used for making a dynamic updates in my god-awful console.
-    ColoredText* m_sessionInfoText;
-    ColoredText* m_netLagText;
-    ColoredText* m_netLossText;
-    ColoredText* m_connectionCountText;
-    std::vector<ColoredText*> m_connectionsText;
+    double m_manualClockMs; //Negative means reliable timing follows the real clock. Tests set this to step time deterministically.
+    float m_bandwidthBudgetBytesPerSecond; //Most any one connection's send rate is allowed to grow to
+    bool m_isCongestionControlEnabled; //If false connections fill every packet regardless of their send rate
+
+private:
+    //PRIVATE FUNCTIONS/////////////////////////////////////////////////////////////////////
+    void AddActiveConnection(NetConnection* cp);
+    void RemoveActiveConnection(NetConnection* cp);
+    static uint64_t GetAddressKey(const sockaddr_in& address);
 };
\ No newline at end of file
@@ -0,0 +1,748 @@
+#include "Engine/Net/UDPIP/NetSession.hpp"
+#include "Engine/Net/UDPIP/NetConnection.hpp"
+#include "Engine/Net/NetSystem.hpp"
+#include "Engine/Input/Console.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Engine/Input/InputOutputUtils.hpp"
+
+//The console side of NetSession: the commands for driving NetSession::instance by hand and the live NetDebug readout.
+//The session itself only raises m_OnStatusMessage, nsinit points that at the console.
+
+extern Event<> NetworkCleanup;
+
+//CONSTANTS/////////////////////////////////////////////////////////////////////
+static const unsigned int NUM_NET_DEBUG_CONNECTION_LINES = 16; //NetDebug shows this many active connections, and a count of the rest
+
+//NetDebug console line references, used for making a dynamic updates in my god-awful console.
+static ColoredText* s_sessionInfoText = nullptr;
+static ColoredText* s_netLagText = nullptr;
+static ColoredText* s_netLossText = nullptr;
+static ColoredText* s_connectionCountText = nullptr;
+static std::vector<ColoredText*> s_connectionsText;
+
+//-----------------------------------------------------------------------------------
+static void PrintNetSessionStatus(const std::string& line, const RGBA& color)
+{
+    if (Console::instance != nullptr)
+    {
+        Console::instance->PrintLine(line, color);
+    }
+}
+
+//-----------------------------------------------------------------------------------
+static void ShutdownNetDebug()
+{
+    s_sessionInfoText = nullptr;
+    s_netLagText = nullptr;
+    s_netLossText = nullptr;
+    s_connectionCountText = nullptr;
+    for (unsigned int i = 0; i < s_connectionsText.size(); ++i)
+    {
+        s_connectionsText[i] = nullptr;
+    }
+}
+
+//-----------------------------------------------------------------------------------
+static void UpdateNetDebug()
+{
+    NetSession* session = NetSession::instance;
+    if (!session)
+    {
+        ShutdownNetDebug();
+        return;
+    }
+    if (s_sessionInfoText)
+    {
+        sockaddr_in addr = session->m_packetChannel.GetAddress();
+        const sockaddr* address = session->m_packetChannel.IsBound() ? (const sockaddr*)&addr : nullptr;
+        s_sessionInfoText->text = Stringf("Session bound to [%s] - State: %s - I/O: %s", NetAddress::SockAddrToString(address), session->GetStateCstr(session->GetSessionState()), session->m_packetChannel.IsIOThreadRunning() ? "Thread" : "Inline");
+    }
+    if (s_netLagText)
+    {
+        s_netLagText->text = Stringf("Simulated Net Lag: %.0fms ~ %.0fms", session->m_packetChannel.m_additionalLagMilliseconds.minValue, session->m_packetChannel.m_additionalLagMilliseconds.maxValue);
+    }
+    if (s_netLossText)
+    {
+        s_netLossText->text = Stringf("Simulated Net Loss: %.2f%%", session->m_packetChannel.m_dropRate * 100.0f);
+    }
+    if (s_connectionCountText)
+    {
+        s_connectionCountText->text = Stringf("Connection Count: %i/%i", session->m_numConnections, NetSession::MAX_CONNECTIONS);
+    }
+    if (s_connectionsText.size() > 0)
+    {
+        //Too many connections to give each a line, so the lines show the first few active ones and the last line counts the rest
+        unsigned int numActive = session->GetNumActiveConnections();
+        unsigned int numLines = (unsigned int)s_connectionsText.size();
+        for (unsigned int line = 0; line < numLines; ++line)
+        {
+            ColoredText* textLine = s_connectionsText[line];
+            NetConnection* conn = (line < numActive) ? session->GetActiveConnection(line) : nullptr;
+            if (textLine)
+            {
+                if (line == numLines - 1 && numActive > numLines)
+                {
+                    textLine->text = Stringf("  ... and %u more connections", numActive - (numLines - 1));
+                }
+                else if (conn)
+                {
+                    //Traffic is from the last full telemetry interval, the queues are as of the last tick
+                    const NetConnectionTelemetry& telemetry = conn->m_telemetry;
+                    bool hasInterval = telemetry.GetNumHistorySamples() > 0;
+                    textLine->text = Stringf("%s%s[%i %s] %s <%s> lRcv[%.0fms] lSnd[%.0fms] sAck[%i] cAck[%i] rtt[%.0fms +-%.0f] rto[%.0fms] rate[%.1fKB/s%s] loss[%.0f%%] zip[%s] out[%.1fKB/s] in[%.1fKB/s] rs[%u] dup[%u] ooo[%u] q[%u/%u]",
+                        conn->IsMyConnection() ? "*" : " ",
+                        conn->IsHostConnection() ? "H" : " ",
+                        conn->m_index,
+                        NetAddress::SockAddrToString((const sockaddr*)&conn->m_address),
+                        conn->m_guid,
+                        conn->GetStateCstr(),
+                        conn->m_lastRecievedTimeMs,
+                        conn->m_lastSentTimeMs,
+                        conn->GetLastSentAck(),
+                        conn->GetMostRecentConfirmedAck(),
+                        conn->GetRoundTripTimeMs(),
+                        conn->GetRoundTripVarianceMs(),
+                        conn->GetRetransmitTimeoutMs(),
+                        conn->m_sendRate.GetBytesPerSecond() / 1024.0f,
+                        conn->m_sendRate.IsInSlowStart() ? " ss" : "",
+                        conn->m_sendRate.GetLossRate() * 100.0f,
+                        (conn->m_compressionId != 0) ? Stringf("%.0f%%", 100.0 * (double)conn->m_numBytesAfterCompression / (double)Max<size_t>(conn->m_numBytesBeforeCompression, 1)).c_str() : "off",
+                        telemetry.GetBytesPerSecondSent() / 1024.0f,
+                        telemetry.GetBytesPerSecondReceived() / 1024.0f,
+                        hasInterval ? telemetry.GetHistorySample(0).numResends : 0,
+                        hasInterval ? telemetry.GetHistorySample(0).numDuplicates : 0,
+                        hasInterval ? telemetry.GetHistorySample(0).numOutOfOrder : 0,
+                        telemetry.GetCurrent().numUnsentReliables,
+                        telemetry.GetCurrent().numUnconfirmedReliables);
+                }
+                else
+                {
+                    textLine->text = "  No Connection";
+                }
+            }
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(nsinit)
+{
+    UNUSED(args)
+    if (nullptr != NetSession::instance)
+    {
+        Console::instance->PrintLine("Net session already initialized.", RGBA::ORANGE);
+        return;
+    }
+
+    NetSession::instance = new NetSession(1.0f/60.0f);
+    NetworkCleanup.RegisterMethod(NetSession::instance, &NetSession::Cleanup);
+    NetSession::instance->m_OnStatusMessage.RegisterFunction(&PrintNetSessionStatus);
+
+    NetSession::instance->RegisterCoreMessages();
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(nsstart)
+{
+    UNUSED(args)
+    if (NetSession::instance && NetSession::instance->Start(GAME_PORT_STR))
+    {
+        // Log Success and Connection Address
+        sockaddr_in address = NetSession::instance->GetAddress();
+        Console::instance->PrintLine(Stringf("Successfully created session at [%s]", NetAddress::SockAddrToString((sockaddr*)&address)), RGBA::BADDAD);
+    }
+    else 
+    {
+        Console::instance->PrintLine("Failed to bring the net session online.", RGBA::RED);
+        delete NetSession::instance;
+        NetSession::instance = nullptr;
+    }
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(nsiothread)
+{
+    UNUSED(args)
+    if (nullptr == NetSession::instance || !NetSession::instance->IsRunning())
+    {
+        Console::instance->PrintLine("Net session isn't running.", RGBA::ORANGE);
+        return;
+    }
+
+    PacketChannel& channel = NetSession::instance->m_packetChannel;
+    if (channel.IsIOThreadRunning())
+    {
+        channel.StopIOThread();
+        Console::instance->PrintLine("Socket I/O moved back onto the game thread.", RGBA::BADDAD);
+    }
+    else
+    {
+        channel.StartIOThread();
+        Console::instance->PrintLine("Socket I/O moved onto its own thread.", RGBA::BADDAD);
+    }
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(nscleanup)
+{
+    UNUSED(args)
+    if (nullptr == NetSession::instance)
+    {
+        Console::instance->PrintLine("Net session isn't running.", RGBA::ORANGE);
+        return;
+    }
+
+    NetSession::instance->Cleanup();
+    NetworkCleanup.UnregisterMethod(NetSession::instance, &NetSession::Cleanup);
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(nsstop)
+{
+    UNUSED(args)
+    if (nullptr == NetSession::instance)
+    {
+        Console::instance->PrintLine("Net session isn't running.", RGBA::ORANGE);
+        return;
+    }
+
+    NetSession::instance->Stop();
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(ping)
+{
+    if (!(args.HasArgs(0) || args.HasArgs(1) || args.HasArgs(2)))
+    {
+        Console::instance->PrintLine("ping <ip address> [optional message]", RGBA::RED);
+        return;
+    }
+    if (NetSession::instance != nullptr)
+    {
+        // so it's expecting a full address string,
+        // ex: 192.168.52.127:4334
+        sockaddr_in to;
+        if (args.HasArgs(0))
+        {
+            to = *(sockaddr_in*)NetSystem::GetLocalHostAddressUDP(GAME_PORT_STR);
+        }
+        else
+        {
+            std::string fullIPString = args.GetStringArgument(0);
+            size_t portLocation = fullIPString.find(":");
+            if (portLocation == fullIPString.npos)
+            {
+                to = NetAddress::StringToSockAddrIPv4(fullIPString.c_str(), GAME_PORT);
+            }
+            else
+            {
+                std::string ipPart = fullIPString.substr(0, portLocation);
+                std::string portPart = fullIPString.substr(portLocation + 1, fullIPString.length() - portLocation);
+                to = NetAddress::StringToSockAddrIPv4(ipPart.c_str(), (uint16_t)std::stoi(portPart));
+            }
+        }
+
+        NetMessage msg(NetMessage::PING);
+        const char* optionalMessage = nullptr;
+        std::string message;
+        if (args.HasArgs(2))
+        {
+            message = args.GetStringArgument(1);
+            optionalMessage = message.c_str();
+        }
+        msg.WriteString(optionalMessage);
+
+        NetSession::instance->SendMessageDirect(to, msg);
+    }
+    else
+    {
+        Console::instance->PrintLine("NetSession hasn't been started yet. Please run NetSessionStart first.", RGBA::RED);
+    }
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(setpacketlatency)
+{
+    if (!(args.HasArgs(1) || args.HasArgs(2)))
+    {
+        Console::instance->PrintLine("setpacketloss <latency lower bound (ms)> [latency upper bound (ms)]", RGBA::RED);
+        return;
+    }
+    if (NetSession::instance != nullptr)
+    {
+        float latencyLowerBound = args.GetFloatArgument(0);
+        float latencyUpperBound = latencyLowerBound;
+        if (args.HasArgs(2))
+        {
+            latencyUpperBound = args.GetFloatArgument(1);
+        }
+        NetSession::instance->m_packetChannel.m_additionalLagMilliseconds = Range<double>(latencyLowerBound, latencyUpperBound);
+    }
+    else
+    {
+        Console::instance->PrintLine("NetSession isn't running. Please run NetSessionStart first.", RGBA::RED);
+    }
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(setpacketloss)
+{
+    if (!(args.HasArgs(1)))
+    {
+        Console::instance->PrintLine("setpacketloss <float lossPercentage>", RGBA::RED);
+        return;
+    }
+    if (NetSession::instance != nullptr)
+    {
+        float lossPercentage = args.GetFloatArgument(0);
+        if (lossPercentage < 0.0f || lossPercentage > 1.0f)
+        {
+            Console::instance->PrintLine("Please enter a percentage between 0 and 1.", RGBA::RED);
+            return;
+        }
+        NetSession::instance->m_packetChannel.m_dropRate = lossPercentage;
+    }
+    else
+    {
+        Console::instance->PrintLine("NetSession isn't running. Please run NetSessionStart first.", RGBA::RED);
+    }
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(setbandwidth)
+{
+    if (!(args.HasArgs(1) || args.HasArgs(2)))
+    {
+        Console::instance->PrintLine("setbandwidth <kilobytes per second per connection> [congestion control 0/1]", RGBA::RED);
+        return;
+    }
+    if (NetSession::instance != nullptr)
+    {
+        float kilobytesPerSecond = args.GetFloatArgument(0);
+        if (kilobytesPerSecond <= 0.0f)
+        {
+            Console::instance->PrintLine("Please enter a bandwidth above 0.", RGBA::RED);
+            return;
+        }
+        NetSession::instance->m_bandwidthBudgetBytesPerSecond = kilobytesPerSecond * 1024.0f;
+        if (args.HasArgs(2))
+        {
+            NetSession::instance->m_isCongestionControlEnabled = args.GetIntArgument(1) != 0;
+        }
+        Console::instance->PrintLine(Stringf("Send budget: %.1fKB/s per connection, congestion control %s", kilobytesPerSecond, NetSession::instance->m_isCongestionControlEnabled ? "on" : "off"), RGBA::GREEN);
+    }
+    else
+    {
+        Console::instance->PrintLine("NetSession isn't running. Please run NetSessionStart first.", RGBA::RED);
+    }
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(nsrecord)
+{
+    if (!(args.HasArgs(2)))
+    {
+        Console::instance->PrintLine("nsrecord <numPackets> <file>", RGBA::RED);
+        return;
+    }
+    if (NetSession::instance != nullptr)
+    {
+        unsigned int numPackets = (unsigned int)Max<int>(args.GetIntArgument(0), 1);
+        NetSession::instance->StartRecordingPackets(numPackets, args.GetStringArgument(1).c_str());
+        Console::instance->PrintLine(Stringf("Recording the next %u outgoing packets.", numPackets), RGBA::GREEN);
+    }
+    else
+    {
+        Console::instance->PrintLine("NetSession hasn't been initialized yet. Please run nsinit first.", RGBA::RED);
+    }
+}
+
+//-----------------------------------------------------------------------------------
+//Both ends need the same dictionary for it to get used, so this has to happen before hosting or joining
+CONSOLE_COMMAND(nscompression)
+{
+    if (!(args.HasArgs(1)))
+    {
+        Console::instance->PrintLine("nscompression <dictionaryFile | nodictionary | off>", RGBA::RED);
+        return;
+    }
+    if (NetSession::instance == nullptr)
+    {
+        Console::instance->PrintLine("NetSession hasn't been initialized yet. Please run nsinit first.", RGBA::RED);
+        return;
+    }
+    if (NetSession::instance->GetSessionState() != NetSession::INVALID && NetSession::instance->GetSessionState() != NetSession::DISCONNECTED)
+    {
+        Console::instance->PrintLine("In an invalid state, must be disconnected to run this command", RGBA::SADDLE_BROWN);
+        return;
+    }
+    PacketCompressor& compressor = NetSession::instance->m_packetCompressor;
+    std::string setting = args.GetStringArgument(0);
+    if (setting == "off")
+    {
+        compressor.Disable();
+        Console::instance->PrintLine("Packet compression off.", RGBA::GREEN);
+        return;
+    }
+    std::vector<unsigned char> dictionary;
+    if (setting != "nodictionary" && !LoadBufferFromBinaryFile(dictionary, setting))
+    {
+        Console::instance->PrintLine(Stringf("Couldn't read %s.", setting.c_str()), RGBA::RED);
+        return;
+    }
+    compressor.Enable(dictionary.data(), dictionary.size());
+    Console::instance->PrintLine(Stringf("Packet compression on with a %u byte dictionary, id %08x.", (unsigned int)compressor.GetDictionarySize(), compressor.GetId()), RGBA::GREEN);
+}
+
+//-----------------------------------------------------------------------------------
+//Trains a dictionary for nscompression on a recording made with nsrecord
+CONSOLE_COMMAND(compresstrain)
+{
+    if (!(args.HasArgs(2) || args.HasArgs(3)))
+    {
+        Console::instance->PrintLine("compresstrain <recordingFile> <dictionaryFile> [maxBytes]", RGBA::RED);
+        return;
+    }
+    std::vector<unsigned char> recording;
+    if (!LoadBufferFromBinaryFile(recording, args.GetStringArgument(0)))
+    {
+        Console::instance->PrintLine(Stringf("Couldn't read %s.", args.GetStringArgument(0).c_str()), RGBA::RED);
+        return;
+    }
+    size_t maxBytes = args.HasArgs(3) ? (size_t)Clamp<int>(args.GetIntArgument(2), 64, (int)PacketCompressor::MAX_DICTIONARY_BYTES) : PacketCompressor::MAX_DICTIONARY_BYTES;
+    std::vector<unsigned char> dictionary;
+    double startSeconds = GetCurrentTimeSeconds();
+    PacketCompressor::TrainDictionary(recording, maxBytes, dictionary);
+    double seconds = GetCurrentTimeSeconds() - startSeconds;
+    if (!SaveBufferToBinaryFile(dictionary, args.GetStringArgument(1)))
+    {
+        Console::instance->PrintLine(Stringf("Couldn't write %s.", args.GetStringArgument(1).c_str()), RGBA::RED);
+        return;
+    }
+    Console::instance->PrintLine(Stringf("Trained a %u byte dictionary from %u bytes of packets in %.2fs.", (unsigned int)dictionary.size(), (unsigned int)recording.size(), seconds), RGBA::GREEN);
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(nscreateconn)
+{
+    if (!(args.HasArgs(3)))
+    {
+        Console::instance->PrintLine("nscreateconn <index> <guid> <address>", RGBA::RED);
+        return;
+    }
+    if (nullptr != NetSession::instance)
+    {
+        sockaddr_in address;
+        std::string guid = args.GetStringArgument(1);
+        std::string fullIPString = args.GetStringArgument(2);
+
+        size_t portLocation = fullIPString.find(":");
+        if (portLocation == fullIPString.npos)
+        {
+            address = NetAddress::StringToSockAddrIPv4(fullIPString.c_str(), GAME_PORT);
+        }
+        else
+        {
+            std::string ipPart = fullIPString.substr(0, portLocation);
+            std::string portPart = fullIPString.substr(portLocation + 1, fullIPString.length() - portLocation);
+            address = NetAddress::StringToSockAddrIPv4(ipPart.c_str(), (uint16_t)std::stoi(portPart));
+        }
+
+        NetSession::instance->CreateConnection((uint16_t)args.GetIntArgument(0), guid.c_str(), address);
+        Console::instance->PrintLine(Stringf("Created connection at index %i", args.GetIntArgument(0)), RGBA::ORANGE);
+    }
+    else
+    {
+        Console::instance->PrintLine("NetSession isn't running. Please run NetSessionStart first.", RGBA::RED);
+    }
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(nsdestroyconn)
+{
+    if (!(args.HasArgs(1)))
+    {
+        Console::instance->PrintLine("nscreateconn <index>", RGBA::RED);
+        return;
+    }
+    if (nullptr != NetSession::instance)
+    {
+        NetSession::instance->Disconnect((uint16_t)args.GetIntArgument(0));
+        Console::instance->PrintLine(Stringf("Destroyed connection at index %i", args.GetIntArgument(0)), RGBA::ORANGE);        
+    }
+    else
+    {
+        Console::instance->PrintLine("NetSession isn't running. Please run NetSessionStart first.", RGBA::RED);
+    }
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(nsdebug)
+{
+    UNUSED(args);
+    if (!NetSession::instance)
+    {
+        Console::instance->PrintLine("Error: NetSession not initialized. Run nsinit.", RGBA::SEA_GREEN);
+        return;
+    }
+    s_sessionInfoText = Console::instance->PrintDynamicLine("Session bound to [null]", RGBA::CHOCOLATE);
+    s_netLagText = Console::instance->PrintDynamicLine("Simulated Net Lag: null", RGBA::CHOCOLATE);
+    s_netLossText = Console::instance->PrintDynamicLine("Simulated Net Loss: null", RGBA::CHOCOLATE);
+    s_connectionCountText = Console::instance->PrintDynamicLine("Connection Count: null", RGBA::CHOCOLATE);
+    s_connectionsText.clear();
+    for (unsigned int i = 0; i < NUM_NET_DEBUG_CONNECTION_LINES; ++i)
+    {
+        s_connectionsText.push_back(Console::instance->PrintDynamicLine("  No Connection", RGBA::CHOCOLATE));
+    }
+    Console::instance->m_consoleUpdate.RegisterFunction(&UpdateNetDebug);
+    Console::instance->m_consoleClear.RegisterFunction(&ShutdownNetDebug);
+}
+
+//-----------------------------------------------------------------------------------
+//One line per telemetry interval, newest first, to see which of bandwidth, resends or queue growth moved first
+CONSOLE_COMMAND(nstelemetry)
+{
+    if (!(args.HasArgs(1) || args.HasArgs(2)))
+    {
+        Console::instance->PrintLine("nstelemetry <connection index> [intervals]", RGBA::RED);
+        return;
+    }
+    if (nullptr == NetSession::instance)
+    {
+        Console::instance->PrintLine("NetSession hasn't been initialized yet. Please run nsinit first.", RGBA::RED);
+        return;
+    }
+    NetConnection* conn = NetSession::instance->GetConnection((uint16_t)args.GetIntArgument(0));
+    if (conn == nullptr)
+    {
+        Console::instance->PrintLine(Stringf("No connection at index %i", args.GetIntArgument(0)), RGBA::RED);
+        return;
+    }
+    const NetConnectionTelemetry& telemetry = conn->m_telemetry;
+    unsigned int numIntervals = args.HasArgs(2) ? (unsigned int)Max<int>(args.GetIntArgument(1), 1) : 10;
+    numIntervals = Min<unsigned int>(numIntervals, telemetry.GetNumHistorySamples());
+    const NetTelemetrySample& totals = telemetry.GetTotals();
+    Console::instance->PrintLine(Stringf("[%i] %s: %u/%u packets out/in (%.1f/%.1fKB), %u lost, %u resends, %u duplicates, %u out of order over %.0fs",
+        conn->m_index, conn->m_guid, totals.numPacketsSent, totals.numPacketsReceived, (double)totals.numBytesSent / 1024.0, (double)totals.numBytesReceived / 1024.0,
+        totals.numPacketsLost, totals.numResends, totals.numDuplicates, totals.numOutOfOrder, totals.durationMs / 1000.0f), RGBA::CORNFLOWER_BLUE);
+    Console::instance->PrintLine(Stringf("%6s%10s%10s%8s%8s%8s%8s%8s%8s%10s%10s%8s", "AGE", "OUT KB/s", "IN KB/s", "PK OUT", "PK IN", "LOST", "RESEND", "DUP", "OOO", "UNSENT", "UNCONF", "RTT"), RGBA::CORNFLOWER_BLUE);
+    for (unsigned int age = 0; age < numIntervals; ++age)
+    {
+        const NetTelemetrySample& sample = telemetry.GetHistorySample(age);
+        Console::instance->PrintLine(Stringf("%6u%10.1f%10.1f%8u%8u%8u%8u%8u%8u%10u%10u%8.0f",
+            age, telemetry.GetBytesPerSecondSent(age) / 1024.0f, telemetry.GetBytesPerSecondReceived(age) / 1024.0f, sample.numPacketsSent, sample.numPacketsReceived,
+            sample.numPacketsLost, sample.numResends, sample.numDuplicates, sample.numOutOfOrder, sample.numUnsentReliables, sample.numUnconfirmedReliables, sample.roundTripMs), RGBA::GREEN);
+    }
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(toggletimeout)
+{
+    UNUSED(args);
+    NetSession::instance->m_timeoutEnabled = !NetSession::instance->m_timeoutEnabled;
+    const char* enabledText = NetSession::instance->m_timeoutEnabled ? "Enabled" : "Disabled";
+    Console::instance->PrintLine(Stringf("Net Session timeout %s.", enabledText));
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(hb)
+{
+    if (!(args.HasArgs(0) || args.HasArgs(1)))
+    {
+        Console::instance->PrintLine("hb <ip address>", RGBA::RED);
+        return;
+    }
+    if (NetSession::instance != nullptr)
+    {
+        // so it's expecting a full address string,
+        // ex: 192.168.52.127:4334
+        sockaddr_in to;
+        if (args.HasArgs(0))
+        {
+            to = *(sockaddr_in*)NetSystem::GetLocalHostAddressUDP(GAME_PORT_STR);
+        }
+        else
+        {
+            std::string fullIPString = args.GetStringArgument(0);
+            size_t portLocation = fullIPString.find(":");
+            if (portLocation == fullIPString.npos)
+            {
+                to = NetAddress::StringToSockAddrIPv4(fullIPString.c_str(), GAME_PORT);
+            }
+            else
+            {
+                std::string ipPart = fullIPString.substr(0, portLocation);
+                std::string portPart = fullIPString.substr(portLocation + 1, fullIPString.length() - portLocation);
+                to = NetAddress::StringToSockAddrIPv4(ipPart.c_str(), (uint16_t)std::stoi(portPart));
+            }
+        }
+
+        NetMessage msg(NetMessage::HEARTBEAT);
+        NetConnection* conn = NetSession::instance->GetConnection(NetSession::instance->GetConnectionIndexFromAddress(to));
+        conn->SendMessage(msg);
+    }
+    else
+    {
+        Console::instance->PrintLine("NetSession hasn't been initialized yet. Please run nsinit first.", RGBA::RED);
+    }
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(iohb)
+{
+    if (!(args.HasArgs(0) || args.HasArgs(1)))
+    {
+        Console::instance->PrintLine("iohb <ip address>", RGBA::RED);
+        return;
+    }
+    if (NetSession::instance != nullptr)
+    {
+        // so it's expecting a full address string,
+        // ex: 192.168.52.127:4334
+        sockaddr_in to;
+        if (args.HasArgs(0))
+        {
+            to = *(sockaddr_in*)NetSystem::GetLocalHostAddressUDP(GAME_PORT_STR);
+        }
+        else
+        {
+            std::string fullIPString = args.GetStringArgument(0);
+            size_t portLocation = fullIPString.find(":");
+            if (portLocation == fullIPString.npos)
+            {
+                to = NetAddress::StringToSockAddrIPv4(fullIPString.c_str(), GAME_PORT);
+            }
+            else
+            {
+                std::string ipPart = fullIPString.substr(0, portLocation);
+                std::string portPart = fullIPString.substr(portLocation + 1, fullIPString.length() - portLocation);
+                to = NetAddress::StringToSockAddrIPv4(ipPart.c_str(), (uint16_t)std::stoi(portPart));
+            }
+        }
+
+        NetMessage msg(NetMessage::INORDER_HEARTBEAT);
+        NetConnection* conn = NetSession::instance->GetConnection(NetSession::instance->GetConnectionIndexFromAddress(to));
+        conn->SendMessage(msg);
+    }
+    else
+    {
+        Console::instance->PrintLine("NetSession hasn't been initialized yet. Please run nsinit first.", RGBA::RED);
+    }
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(nethost)
+{
+    if (!(args.HasArgs(0) || args.HasArgs(1)))
+    {
+        Console::instance->PrintLine("nethost <username>", RGBA::RED);
+        return;
+    }
+    if (NetSession::instance != nullptr)
+    {
+        if (NetSession::instance->m_hostConnection != nullptr)
+        {
+            Console::instance->PrintLine("Already have a host connection", RGBA::SADDLE_BROWN);
+            return;
+        }
+        if (NetSession::instance->GetSessionState() != NetSession::DISCONNECTED)
+        {
+            Console::instance->PrintLine("In an invalid state, must be disconnected to run this command", RGBA::SADDLE_BROWN);
+            return;
+        }
+        std::string username;
+        if (args.HasArgs(0))
+        {
+            username = NetAddress::GetLocalHostName();
+        }
+        else
+        {
+            username = args.GetStringArgument(0);
+        }
+        NetSession::instance->Host(username.c_str());
+        Console::instance->PrintLine("Began hosting.", RGBA::SADDLE_BROWN);
+    }
+    else
+    {
+        Console::instance->PrintLine("NetSession hasn't been initialized yet. Please run nsinit first.", RGBA::RED);
+    }
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(netleave)
+{
+    UNUSED(args)
+    if (NetSession::instance != nullptr)
+    {
+        if (NetSession::instance->GetSessionState() != NetSession::CONNECTED)
+        {
+            Console::instance->PrintLine("Not currently connected", RGBA::KHAKI);
+            return;
+        }
+        NetSession::instance->Leave();
+        Console::instance->PrintLine("Left the session.", RGBA::KHAKI);
+    }
+    else
+    {
+        Console::instance->PrintLine("NetSession hasn't been initialized yet. Please run nsinit first.", RGBA::RED);
+    }
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(netjoin)
+{
+    if (!(args.HasArgs(2)))
+    {
+        Console::instance->PrintLine("netjoin <username> <hostaddr : hostport>", RGBA::RED);
+        return;
+    }
+    if (NetSession::instance != nullptr)
+    {
+        if (NetSession::instance->m_hostConnection != nullptr)
+        {
+            Console::instance->PrintLine("Already have a host connection", RGBA::SADDLE_BROWN);
+            return;
+        }
+        if (NetSession::instance->GetSessionState() != NetSession::DISCONNECTED)
+        {
+            Console::instance->PrintLine("In an invalid state, must be disconnected to run this command", RGBA::SADDLE_BROWN);
+            return;
+        }
+        sockaddr_in address;
+        std::string guid = args.GetStringArgument(0);
+        std::string fullIPString = args.GetStringArgument(1);
+
+        size_t portLocation = fullIPString.find(":");
+        if (portLocation == fullIPString.npos)
+        {
+            address = NetAddress::StringToSockAddrIPv4(fullIPString.c_str(), GAME_PORT);
+        }
+        else
+        {
+            std::string ipPart = fullIPString.substr(0, portLocation);
+            std::string portPart = fullIPString.substr(portLocation + 1, fullIPString.length() - portLocation);
+            address = NetAddress::StringToSockAddrIPv4(ipPart.c_str(), (uint16_t)std::stoi(portPart));
+        }
+
+        NetSession::instance->Join(guid.c_str(), address);
+        Console::instance->PrintLine("Submitted request to join.", RGBA::SADDLE_BROWN);
+    }
+    else
+    {
+        Console::instance->PrintLine("NetSession hasn't been initialized yet. Please run nsinit first.", RGBA::RED);
+    }
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(go)
+{
+    UNUSED(args)
+    Console::instance->RunCommand("csjoin");
+    //Console::instance->RunCommand("bcmd nscreateconn 0 right 192.168.0.4:4334");
+    //Console::instance->RunCommand("bcmd nscreateconn 1 left 192.168.0.4:4335");    
+    Console::instance->RunCommand("bcmd nscreateconn 0 right 10.8.151.65:4334");
+    Console::instance->RunCommand("bcmd nscreateconn 1 left 10.8.151.65:4335");
+    Console::instance->RunCommand("nsdebug");
+    Console::instance->RunCommand("rcmd nsdebug");
+}
@@ -0,0 +1,492 @@
+#include "Engine/Net/UDPIP/NetSimulator.hpp"
+#include "Engine/Net/UDPIP/LoopbackTransport.hpp"
+#include "Engine/Net/UDPIP/NetSession.hpp"
+#include "Engine/Net/UDPIP/NetConnection.hpp"
+#include "Engine/Net/UDPIP/NetTests.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Engine/Time/Time.hpp"
+#include <algorithm>
+#include <cstring>
+
+//TESTS/////////////////////////////////////////////////////////////////////
+//A host and a few clients, each a whole NetSession on its own loopback transport, joining and trading reliable in-order messages
+//over a simulator. Run twice with the same seed, everything they see has to line up exactly.
+
+//-----------------------------------------------------------------------------------
+struct NetSimTestResults
+{
+    unsigned int numDelivered;
+    unsigned int numOutOfOrder; //Includes duplicates, an in-order stream should never see an id twice
+    unsigned int numConnected; //Clients that made it into the session
+    uint32_t digest; //Hash of who got what and when
+    double simulatedMs;
+    double seconds;
+    NetSimulatorStats networkStats;
+};
+
+//-----------------------------------------------------------------------------------
+struct NetSimTestRecorder
+{
+    std::vector<NetSession*> sessions; //Host first
+    std::vector<uint32_t> nextExpectedIds; //By receiver * sessions + sender
+    NetSimTestResults* results;
+};
+static NetSimTestRecorder* s_netSimTestRecorder = nullptr;
+
+//-----------------------------------------------------------------------------------
+//Registered after the core messages on each of the test's sessions
+static const uint8_t NET_SIM_TEST_TYPE = (uint8_t)NetMessage::NUM_MESSAGES;
+static const uint16_t NET_SIM_TEST_PORT = 4500;
+static const unsigned int NET_SIM_TEST_NUM_CLIENTS = 4;
+static const unsigned int NET_SIM_TEST_MESSAGES_PER_STREAM = 1000;
+static const unsigned int NET_SIM_TEST_MESSAGES_PER_TICK = 4;
+static const unsigned int NET_SIM_TEST_TICK_MS = 16;
+static const unsigned int NET_SIM_TEST_MAX_MS = 10 * 60 * 1000;
+
+//-----------------------------------------------------------------------------------
+static inline uint32_t NextNetSimTestRandom(uint32_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+//-----------------------------------------------------------------------------------
+static inline void HashNetSimTestValue(uint32_t& hash, uint32_t value)
+{
+    for (int i = 0; i < 4; ++i)
+    {
+        hash = (hash ^ ((value >> (i * 8)) & 0xFF)) * 16777619u;
+    }
+}
+
+//-----------------------------------------------------------------------------------
+static unsigned int GetNetSimTestSlot(const NetSession* session)
+{
+    const std::vector<NetSession*>& sessions = s_netSimTestRecorder->sessions;
+    return (unsigned int)(std::find(sessions.begin(), sessions.end(), session) - sessions.begin());
+}
+
+//-----------------------------------------------------------------------------------
+//Payloads carry the sending session's slot, then the id within its stream
+static void OnNetSimTestMessage(const NetSender& from, NetMessage& msg)
+{
+    NetSimTestRecorder& recorder = *s_netSimTestRecorder;
+    uint32_t senderSlot = 0;
+    uint32_t testId = 0;
+    msg.Read<uint32_t>(senderSlot);
+    msg.Read<uint32_t>(testId);
+    unsigned int receiverSlot = GetNetSimTestSlot(from.session);
+    uint32_t& nextExpectedId = recorder.nextExpectedIds[(receiverSlot * recorder.sessions.size()) + senderSlot];
+    recorder.results->numOutOfOrder += (testId == nextExpectedId) ? 0 : 1;
+    recorder.results->numDelivered += (testId == nextExpectedId) ? 1 : 0;
+    nextExpectedId = (testId == nextExpectedId) ? nextExpectedId + 1 : nextExpectedId;
+    HashNetSimTestValue(recorder.results->digest, receiverSlot);
+    HashNetSimTestValue(recorder.results->digest, senderSlot);
+    HashNetSimTestValue(recorder.results->digest, testId);
+    HashNetSimTestValue(recorder.results->digest, (uint32_t)from.session->GetNetTimeMilliseconds());
+}
+
+//-----------------------------------------------------------------------------------
+static NetSession* CreateNetSimTestSession(NetSimulator& simulator)
+{
+    NetSession* session = new NetSession(1.0f / 60.0f);
+    session->m_packetChannel.SetTransport(new LoopbackTransport(&simulator));
+    session->RegisterCoreMessages();
+    session->RegisterMessage(NET_SIM_TEST_TYPE, "netsimtest", &OnNetSimTestMessage, (uint32_t)NetMessage::Option::RELIABLE | (uint32_t)NetMessage::Option::INORDER, (uint32_t)NetMessage::Control::NONE);
+    session->m_manualClockMs = simulator.GetTimeMilliseconds();
+    session->Start(Stringf("%u", NET_SIM_TEST_PORT).c_str());
+    return session;
+}
+
+//-----------------------------------------------------------------------------------
+//Joins the clients, then has every client and the host stream NET_SIM_TEST_MESSAGES_PER_STREAM messages to each other until they've all arrived
+static void RunNetSimSessions(const NetSimulatorLinkSettings& settings, uint32_t seed, NetSimTestResults& results)
+{
+    memset(&results, 0, sizeof(results));
+    results.digest = 2166136261u;
+
+    NetSimulator simulator(seed);
+    simulator.SetDefaultLinkSettings(settings);
+    NetSimTestRecorder recorder;
+    recorder.results = &results;
+    s_netSimTestRecorder = &recorder;
+    for (unsigned int i = 0; i <= NET_SIM_TEST_NUM_CLIENTS; ++i)
+    {
+        recorder.sessions.push_back(CreateNetSimTestSession(simulator));
+    }
+    recorder.nextExpectedIds.resize(recorder.sessions.size() * recorder.sessions.size(), 0);
+    std::vector<uint32_t> numSent(recorder.sessions.size() * recorder.sessions.size(), 0);
+    NetSession* host = recorder.sessions[0];
+    sockaddr_in hostAddress = host->GetAddress();
+    host->Host("simhost");
+    for (unsigned int i = 1; i < recorder.sessions.size(); ++i)
+    {
+        recorder.sessions[i]->Join(Stringf("simclient%u", i).c_str(), hostAddress);
+    }
+
+    const unsigned int numStreams = NET_SIM_TEST_NUM_CLIENTS * 2;
+    NetMessage msg(NET_SIM_TEST_TYPE);
+    double startSeconds = GetCurrentTimeSeconds();
+    while (results.numDelivered < numStreams * NET_SIM_TEST_MESSAGES_PER_STREAM && simulator.GetTimeMilliseconds() < (double)NET_SIM_TEST_MAX_MS)
+    {
+        simulator.AdvanceTime(1.0);
+        bool isSendTick = ((unsigned int)simulator.GetTimeMilliseconds() % NET_SIM_TEST_TICK_MS) == 0;
+        for (unsigned int senderSlot = 0; senderSlot < recorder.sessions.size(); ++senderSlot)
+        {
+            NetSession* session = recorder.sessions[senderSlot];
+            session->m_manualClockMs = simulator.GetTimeMilliseconds();
+            if (isSendTick && session->AmIConnected())
+            {
+                //Clients talk to the host, the host talks to every client
+                for (unsigned int activeIndex = 0; activeIndex < session->GetNumActiveConnections(); ++activeIndex)
+                {
+                    NetConnection* conn = session->GetActiveConnection(activeIndex);
+                    NetSession* receiver = nullptr;
+                    for (NetSession* other : recorder.sessions)
+                    {
+                        receiver = NetAddress::SockaddrCompare(other->GetAddress(), conn->m_address) ? other : receiver;
+                    }
+                    if (conn->IsMyConnection() || receiver == nullptr)
+                    {
+                        continue;
+                    }
+                    uint32_t& streamSent = numSent[(GetNetSimTestSlot(receiver) * recorder.sessions.size()) + senderSlot];
+                    for (unsigned int i = 0; i < NET_SIM_TEST_MESSAGES_PER_TICK && streamSent < NET_SIM_TEST_MESSAGES_PER_STREAM; ++i)
+                    {
+                        msg.SetReadableBytes(0);
+                        msg.Write<uint32_t>(senderSlot);
+                        msg.Write<uint32_t>(streamSent++);
+                        conn->SendMessage(msg);
+                    }
+                }
+            }
+            session->Update(0.001f);
+        }
+    }
+    results.seconds = GetCurrentTimeSeconds() - startSeconds;
+    results.simulatedMs = simulator.GetTimeMilliseconds();
+    for (unsigned int i = 1; i < recorder.sessions.size(); ++i)
+    {
+        results.numConnected += recorder.sessions[i]->AmIConnected() ? 1 : 0;
+    }
+    results.networkStats = simulator.GetStats();
+
+    for (NetSession* session : recorder.sessions)
+    {
+        session->Stop();
+        delete session;
+    }
+    s_netSimTestRecorder = nullptr;
+}
+
+//-----------------------------------------------------------------------------------
+//Each run picks random network conditions from the seed, then runs them twice and once more on the next seed.
+//Passes if every message arrives once and in order, the repeat matches exactly, and the other seed doesn't.
+bool RunNetSimTest(int numRuns, uint32_t seed, NetTestPrintCallback* print)
+{
+    const char* distributionNames[NetSimulatorLinkSettings::NUM_DISTRIBUTIONS] = { "uniform", "normal", "long tail" };
+
+    int numFailed = 0;
+    for (int run = 0; run < numRuns; ++run)
+    {
+        uint32_t random = seed + (uint32_t)run * 7919;
+        NextNetSimTestRandom(random);
+        NetSimulatorLinkSettings settings;
+        settings.latencyDistribution = (NetSimulatorLinkSettings::LatencyDistribution)(run % NetSimulatorLinkSettings::NUM_DISTRIBUTIONS);
+        settings.minLatencyMs = 5 + (NextNetSimTestRandom(random) % 56);
+        settings.jitterMs = NextNetSimTestRandom(random) % 41;
+        settings.lossRate = (float)(NextNetSimTestRandom(random) % 11) / 100.0f;
+        settings.meanLossBurstLength = 1.0f + (float)(NextNetSimTestRandom(random) % 4);
+        settings.duplicateRate = (float)(NextNetSimTestRandom(random) % 6) / 100.0f;
+        settings.reorderRate = (float)(NextNetSimTestRandom(random) % 6) / 100.0f;
+        settings.reorderDelayMs = 30;
+        settings.bottleneckBytesPerSecond = (NextNetSimTestRandom(random) % 2 == 0) ? 0.0f : (float)(64 + (NextNetSimTestRandom(random) % 193)) * 1024.0f;
+        uint32_t runSeed = NextNetSimTestRandom(random);
+
+        NetSimTestResults results;
+        NetSimTestResults repeat;
+        NetSimTestResults otherSeed;
+        RunNetSimSessions(settings, runSeed, results);
+        RunNetSimSessions(settings, runSeed, repeat);
+        RunNetSimSessions(settings, runSeed + 1, otherSeed);
+        unsigned int numExpected = NET_SIM_TEST_NUM_CLIENTS * 2 * NET_SIM_TEST_MESSAGES_PER_STREAM;
+        bool isRepeatable = results.digest == repeat.digest && results.simulatedMs == repeat.simulatedMs && memcmp(&results.networkStats, &repeat.networkStats, sizeof(NetSimulatorStats)) == 0;
+        bool passed = results.numConnected == NET_SIM_TEST_NUM_CLIENTS
+            && results.numDelivered == numExpected
+            && results.numOutOfOrder == 0
+            && isRepeatable
+            && otherSeed.numDelivered == numExpected
+            && otherSeed.digest != results.digest;
+        numFailed += passed ? 0 : 1;
+        print(Stringf("  %s: %2ums + %2ums %s, %2.0f%% loss x%.0f, %.0f%% dup, %.0f%% reorder, %s -> %u/%u delivered, %u out of order, %s, %.1fs simulated in %.2fs",
+            passed ? "PASS" : "FAIL",
+            settings.minLatencyMs,
+            settings.jitterMs,
+            distributionNames[settings.latencyDistribution],
+            settings.lossRate * 100.0f,
+            settings.meanLossBurstLength,
+            settings.duplicateRate * 100.0f,
+            settings.reorderRate * 100.0f,
+            (settings.bottleneckBytesPerSecond > 0.0f) ? Stringf("%.0fKB/s", settings.bottleneckBytesPerSecond / 1024.0f).c_str() : "no cap",
+            results.numDelivered,
+            numExpected,
+            results.numOutOfOrder,
+            isRepeatable ? "repeatable" : "NOT REPEATABLE",
+            results.simulatedMs / 1000.0,
+            results.seconds), passed ? RGBA::GREEN : RGBA::RED);
+    }
+    print(Stringf("netsimtest: %i/%i runs passed", numRuns - numFailed, numRuns), numFailed == 0 ? RGBA::GREEN : RGBA::RED);
+    return numFailed == 0;
+}
+
+//-----------------------------------------------------------------------------------
+//Queues messagesPerTick messages and builds a packet, over and over. Every other message is reliable if mixReliables is set,
+//and each packet is acked straight away like a perfect link would, so the resend queue gets drained too. Returns messages per second.
+static double MeasurePooledSendThroughput(NetConnection& connection, NetPacket& packet, NetMessage& reliableMsg, NetMessage& unreliableMsg, int messagesPerTick, bool mixReliables, double seconds)
+{
+    uint64_t numMessages = 0;
+    double startSeconds = GetCurrentTimeSeconds();
+    double elapsedSeconds = 0.0;
+    while (elapsedSeconds < seconds)
+    {
+        for (int tick = 0; tick < 256; ++tick)
+        {
+            for (int i = 0; i < messagesPerTick; ++i)
+            {
+                connection.SendMessage((mixReliables && (i & 1)) ? reliableMsg : unreliableMsg);
+            }
+            connection.ConstructPacket(packet);
+            connection.ConfirmAck(packet.m_header.ack);
+        }
+        numMessages += 256 * messagesPerTick;
+        elapsedSeconds = GetCurrentTimeSeconds() - startSeconds;
+    }
+    return (double)numMessages / elapsedSeconds;
+}
+
+//-----------------------------------------------------------------------------------
+//The old unreliable path: a full NetMessage heap copy per queued message, written out, then deleted once the packet is built
+static double MeasureHeapCopySendThroughput(NetPacket& packet, NetMessage& unreliableMsg, int messagesPerTick, double seconds)
+{
+    NetMessage* heapCopies[255];
+    uint64_t numMessages = 0;
+    double startSeconds = GetCurrentTimeSeconds();
+    double elapsedSeconds = 0.0;
+    while (elapsedSeconds < seconds)
+    {
+        for (int tick = 0; tick < 256; ++tick)
+        {
+            for (int i = 0; i < messagesPerTick; ++i)
+            {
+                heapCopies[i] = new NetMessage(unreliableMsg);
+            }
+            packet.Reset(NetSession::INVALID_CONNECTION_INDEX);
+            packet.WriteHeader();
+            packet.WriteMessages(heapCopies, messagesPerTick);
+            for (int i = 0; i < messagesPerTick; ++i)
+            {
+                delete heapCopies[i];
+            }
+        }
+        numMessages += 256 * messagesPerTick;
+        elapsedSeconds = GetCurrentTimeSeconds() - startSeconds;
+    }
+    return (double)numMessages / elapsedSeconds;
+}
+
+//-----------------------------------------------------------------------------------
+//On a session of its own, so the pool starts empty and nothing else is queueing into it
+void RunNetMessageBenchmark(double seconds, int payloadSize, int messagesPerTick, NetTestPrintCallback* print)
+{
+    NetSession* session = new NetSession(1.0f / 60.0f);
+    session->RegisterCoreMessages();
+    char guid[NetConnection::MAX_GUID_LENGTH] = "netmsgbench";
+    NetConnection connection(NetSession::INVALID_CONNECTION_INDEX, guid, session->GetAddress(), session);
+    NetPacket packet;
+    NetMessage reliableMsg((uint8_t)NetMessage::HEARTBEAT);
+    NetMessage unreliableMsg((uint8_t)NetMessage::PING);
+    for (int i = 0; i < payloadSize; ++i)
+    {
+        reliableMsg.Write<uint8_t>((uint8_t)i);
+        unreliableMsg.Write<uint8_t>((uint8_t)i);
+    }
+
+    //Net time stands still here, so pacing would hold every message after the first packet. This measures bookkeeping, not the rate.
+    session->m_isCongestionControlEnabled = false;
+
+    //Warm up so the pool has grown to the working set before we start counting
+    MeasurePooledSendThroughput(connection, packet, reliableMsg, unreliableMsg, messagesPerTick, true, 0.01);
+    unsigned int chunksBefore = session->m_messagePool.GetNumChunkAllocations();
+    double pooledUnreliable = MeasurePooledSendThroughput(connection, packet, reliableMsg, unreliableMsg, messagesPerTick, false, seconds * 0.4);
+    double pooledMixed = MeasurePooledSendThroughput(connection, packet, reliableMsg, unreliableMsg, messagesPerTick, true, seconds * 0.4);
+    unsigned int chunkGrowth = session->m_messagePool.GetNumChunkAllocations() - chunksBefore;
+    double heapUnreliable = MeasureHeapCopySendThroughput(packet, unreliableMsg, messagesPerTick, seconds * 0.2);
+
+    print(Stringf("Net message throughput, %i byte payloads, %i messages per tick, one connection", payloadSize, messagesPerTick), RGBA::CORNFLOWER_BLUE);
+    print(Stringf("  Heap copy, unreliable:   %10.0f msgs/s", heapUnreliable), RGBA::GREEN);
+    print(Stringf("  Pooled, unreliable:      %10.0f msgs/s  (%.2fx)", pooledUnreliable, pooledUnreliable / heapUnreliable), RGBA::GREEN);
+    print(Stringf("  Pooled, half reliable:   %10.0f msgs/s", pooledMixed), RGBA::GREEN);
+    print(Stringf("  Pool chunks grown while timed: %u  (%u chunks, %i KB reserved)",
+        chunkGrowth,
+        session->m_messagePool.GetNumChunkAllocations(),
+        (int)(session->m_messagePool.GetNumBytesReserved() / 1024)), chunkGrowth == 0 ? RGBA::GREEN : RGBA::ORANGE);
+    delete session;
+}
+
+//-----------------------------------------------------------------------------------
+static const uint8_t SCALE_BENCH_UNRELIABLE_TYPE = (uint8_t)NetMessage::NUM_MESSAGES;
+static const uint8_t SCALE_BENCH_RELIABLE_TYPE = SCALE_BENCH_UNRELIABLE_TYPE + 1;
+static unsigned int s_numScaleBenchMessagesProcessed = 0;
+
+//-----------------------------------------------------------------------------------
+static void OnScaleBenchMessage(const NetSender&, NetMessage&)
+{
+    ++s_numScaleBenchMessagesProcessed;
+}
+
+//-----------------------------------------------------------------------------------
+//Reads a packet the way NetSession::ProcessIncomingPacket would for a client that only knows the server
+static void DeliverScaleBenchPacket(NetConnection& to, const NetPacket& sent, NetPacket& scratch)
+{
+    NetSender from;
+    from.session = to.m_session;
+    from.connection = &to;
+    memcpy(scratch.m_buffer, sent.m_buffer, sent.GetTotalReadableBytes());
+    scratch.Reset(NetSession::INVALID_CONNECTION_INDEX);
+    scratch.SetReadableBytes(sent.GetTotalReadableBytes());
+    scratch.ReadHeader();
+    NetMessage msg;
+    for (uint8_t i = 0; i < scratch.m_header.messageCount; ++i)
+    {
+        scratch.ReadMessage(msg);
+        if (to.CanProcessMessage(msg))
+        {
+            to.ProcessMessage(from, msg);
+        }
+    }
+    to.MarkPacketReceived(scratch);
+}
+
+//-----------------------------------------------------------------------------------
+//Runs the server end of a session with numClients simulated clients over a perfect loopback link, stepped on the manual clock.
+//Each tick every client sends an input and the server answers every client with a snapshot, plus a reliable both ways now and then.
+//Only the server's work is timed: taking in every client's packet, then queueing and building every client's packet.
+//Returns mean server microseconds per tick. Each measurement gets a fresh session, since the clients are created in its connection table.
+static double MeasureServerTickMicroseconds(unsigned int numClients, unsigned int numTicks, unsigned int& outNumServerMessagesProcessed)
+{
+    const unsigned int RELIABLE_INTERVAL_TICKS = 10;
+    const double TICK_MS = 16.0;
+    NetSession* session = new NetSession(1.0f / 60.0f);
+    session->RegisterCoreMessages();
+    session->RegisterMessage(SCALE_BENCH_UNRELIABLE_TYPE, "scaleunreliable", &OnScaleBenchMessage, (uint32_t)NetMessage::Option::UNRELIABLE, (uint32_t)NetMessage::Control::NONE);
+    session->RegisterMessage(SCALE_BENCH_RELIABLE_TYPE, "scalereliable", &OnScaleBenchMessage, (uint32_t)NetMessage::Option::RELIABLE, (uint32_t)NetMessage::Control::NONE);
+
+    char hostGuid[NetConnection::MAX_GUID_LENGTH] = "scalehost";
+    char clientGuid[NetConnection::MAX_GUID_LENGTH] = "scaleclient";
+    NetConnection benchHost(0, hostGuid, session->GetAddress(), session);
+    session->m_myConnection = &benchHost;
+
+    std::vector<sockaddr_in> clientAddresses(numClients);
+    std::vector<NetConnection*> clientSides(numClients);
+    std::vector<NetPacket> clientPackets(numClients);
+    std::vector<NetPacket> serverPackets(numClients);
+    NetPacket scratch;
+    for (unsigned int i = 0; i < numClients; ++i)
+    {
+        sockaddr_in& address = clientAddresses[i];
+        memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(0x0A000000 | (i + 1));
+        address.sin_port = htons(GAME_PORT);
+        session->CreateConnection((uint16_t)(i + 1), clientGuid, address);
+        clientSides[i] = new NetConnection(0, hostGuid, session->GetAddress(), session);
+    }
+
+    NetMessage input(SCALE_BENCH_UNRELIABLE_TYPE);
+    NetMessage snapshot(SCALE_BENCH_UNRELIABLE_TYPE);
+    NetMessage reliable(SCALE_BENCH_RELIABLE_TYPE);
+    input.SetReadableBytes(24);
+    snapshot.SetReadableBytes(160);
+    reliable.SetReadableBytes(32);
+
+    double serverSeconds = 0.0;
+    unsigned int numProcessedByServer = 0;
+    NetSender from;
+    from.session = session;
+    for (unsigned int tick = 0; tick < numTicks; ++tick)
+    {
+        session->m_manualClockMs = (double)(tick + 1) * TICK_MS;
+        bool sendsReliable = (tick % RELIABLE_INTERVAL_TICKS) == 0;
+
+        //Clients: the header names the sender by my connection's index, so borrow it for each client in turn
+        for (unsigned int i = 0; i < numClients; ++i)
+        {
+            clientSides[i]->SendMessage(input);
+            if (sendsReliable)
+            {
+                clientSides[i]->SendMessage(reliable);
+            }
+            benchHost.m_index = (uint16_t)(i + 1);
+            clientSides[i]->ConstructPacket(clientPackets[i]);
+            clientPackets[i].SetReadableBytes(clientPackets[i].GetTotalReadableBytes());
+        }
+        benchHost.m_index = 0;
+
+        double startSeconds = GetCurrentTimeSeconds();
+        unsigned int processedBefore = s_numScaleBenchMessagesProcessed;
+        for (unsigned int i = 0; i < numClients; ++i)
+        {
+            from.address = clientAddresses[i];
+            from.connection = nullptr;
+            session->ProcessIncomingPacket(from, clientPackets[i]);
+        }
+        numProcessedByServer += s_numScaleBenchMessagesProcessed - processedBefore;
+        for (unsigned int activeIndex = 0; activeIndex < session->GetNumActiveConnections(); ++activeIndex)
+        {
+            NetConnection* conn = session->GetActiveConnection(activeIndex);
+            conn->SendMessage(snapshot);
+            if (sendsReliable)
+            {
+                conn->SendMessage(reliable);
+            }
+            conn->ConstructPacket(serverPackets[conn->m_index - 1]);
+        }
+        serverSeconds += GetCurrentTimeSeconds() - startSeconds;
+
+        for (unsigned int i = 0; i < numClients; ++i)
+        {
+            DeliverScaleBenchPacket(*clientSides[i], serverPackets[i], scratch);
+        }
+    }
+
+    for (unsigned int i = 0; i < numClients; ++i)
+    {
+        session->DestroyConnection((uint16_t)(i + 1));
+        delete clientSides[i];
+    }
+    session->m_myConnection = nullptr;
+    delete session;
+    outNumServerMessagesProcessed = numProcessedByServer;
+    return (serverSeconds * 1e6) / (double)numTicks;
+}
+
+//-----------------------------------------------------------------------------------
+//Ramps simulated clients against the server end of a session and reports how long the server's tick takes at each step
+void RunServerScaleBenchmark(unsigned int maxClients, unsigned int numTicks, NetTestPrintCallback* print)
+{
+    print(Stringf("Server tick with N clients, %u ticks each, one input in and one snapshot out per client per tick", numTicks), RGBA::CORNFLOWER_BLUE);
+    for (unsigned int numClients = 8; ; numClients *= 2)
+    {
+        numClients = Min<unsigned int>(numClients, maxClients);
+        unsigned int numProcessed = 0;
+        double tickMicroseconds = MeasureServerTickMicroseconds(numClients, numTicks, numProcessed);
+        print(Stringf("  %3u clients: %9.1f us/tick  %6.2f us/client  %u messages taken in", numClients, tickMicroseconds, tickMicroseconds / (double)numClients, numProcessed), RGBA::GREEN);
+        if (numClients >= maxClients)
+        {
+            break;
+        }
+    }
+}
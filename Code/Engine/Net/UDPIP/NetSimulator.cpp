@@ -0,0 +1,276 @@
+#include "Engine/Net/UDPIP/NetSimulator.hpp"
+#include "Engine/Net/UDPIP/SendRateController.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+//-----------------------------------------------------------------------------------
+NetSimulator::NetSimulator(uint32_t seed)
+    : m_nowMs(0.0)
+    , m_random((seed != 0) ? seed : 1)
+    , m_nextSequence(0)
+    , m_nextHostAddress(FIRST_HOST_ADDRESS)
+{
+    ResetStats();
+}
+
+//-----------------------------------------------------------------------------------
+void NetSimulator::AdvanceTime(double milliseconds)
+{
+    m_nowMs += milliseconds;
+    while (!m_inFlight.empty() && m_inFlight.front().deliverTimeMs <= m_nowMs)
+    {
+        uint32_t datagramIndex = m_inFlight.front().datagramIndex;
+        std::pop_heap(m_inFlight.begin(), m_inFlight.end());
+        m_inFlight.pop_back();
+
+        Datagram& datagram = m_datagrams[datagramIndex];
+        auto found = m_endpoints.find(datagram.toKey);
+        if (found == m_endpoints.end())
+        {
+            ++m_stats.numUnroutable;
+            m_freeDatagrams.push_back(datagramIndex);
+        }
+        else if (found->second.inbox.size() >= MAX_INBOX_DATAGRAMS)
+        {
+            ++m_stats.numInboxDrops;
+            m_freeDatagrams.push_back(datagramIndex);
+        }
+        else
+        {
+            ++m_stats.numDelivered;
+            m_stats.numBytesDelivered += datagram.size;
+            found->second.inbox.push_back(datagramIndex);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------------
+void NetSimulator::SetDefaultLinkSettings(const NetSimulatorLinkSettings& settings)
+{
+    m_defaultSettings = settings;
+}
+
+//-----------------------------------------------------------------------------------
+void NetSimulator::SetLinkSettings(const sockaddr_in& from, const sockaddr_in& to, const NetSimulatorLinkSettings& settings)
+{
+    auto found = m_endpoints.find(GetAddressKey(from));
+    ASSERT_OR_DIE(found != m_endpoints.end(), "Attempted to set up a link from an address nothing is bound to");
+    GetLink(found->second, GetAddressKey(to)).settings = settings;
+}
+
+//-----------------------------------------------------------------------------------
+sockaddr_in NetSimulator::AddEndpoint(uint16_t port)
+{
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(m_nextHostAddress++);
+    address.sin_port = htons(port);
+    m_endpoints[GetAddressKey(address)];
+    return address;
+}
+
+//-----------------------------------------------------------------------------------
+//Anything still in flight to it is counted as unroutable when it lands
+void NetSimulator::RemoveEndpoint(const sockaddr_in& address)
+{
+    auto found = m_endpoints.find(GetAddressKey(address));
+    if (found == m_endpoints.end())
+    {
+        return;
+    }
+    for (uint32_t datagramIndex : found->second.inbox)
+    {
+        m_freeDatagrams.push_back(datagramIndex);
+    }
+    m_endpoints.erase(found);
+}
+
+//-----------------------------------------------------------------------------------
+//Each datagram goes through the link's loss, then its bottleneck, then picks up latency. Duplicates take the same
+//trip through the bottleneck but draw their own latency, like a copy made by a router past it.
+size_t NetSimulator::Send(const sockaddr_in& from, const UDPDatagram* datagrams, size_t numDatagrams)
+{
+    auto fromEndpoint = m_endpoints.find(GetAddressKey(from));
+    ASSERT_OR_DIE(fromEndpoint != m_endpoints.end(), "Attempted to send from an address nothing is bound to");
+    for (size_t i = 0; i < numDatagrams; ++i)
+    {
+        const UDPDatagram& datagram = datagrams[i];
+        uint64_t toKey = GetAddressKey(datagram.address);
+        Link& link = GetLink(fromEndpoint->second, toKey);
+        const NetSimulatorLinkSettings& settings = link.settings;
+        ++m_stats.numSent;
+
+        //Two state loss: a packet that starts a burst is lost along with every one after it until the burst ends, which it does
+        //with a chance that makes the mean length come out right. The packet that ends a burst gets through.
+        link.isInLossBurst = link.isInLossBurst ? !RollChance(1.0f / Max<float>(settings.meanLossBurstLength, 1.0f)) : RollChance(settings.lossRate);
+        if (link.isInLossBurst)
+        {
+            ++m_stats.numLost;
+            continue;
+        }
+
+        double departureMs = m_nowMs;
+        if (settings.bottleneckBytesPerSecond > 0.0f)
+        {
+            //Wait behind everything already queued, or get dropped if the queue is full
+            double wireBytes = (double)(datagram.size + SendRateController::UDP_IP_HEADER_BYTES);
+            double queuedBytes = Max<double>(link.bottleneckFreeAtMs - m_nowMs, 0.0) * settings.bottleneckBytesPerSecond * 0.001;
+            if (queuedBytes + wireBytes > (double)settings.bottleneckQueueBytes)
+            {
+                ++m_stats.numBottleneckDrops;
+                continue;
+            }
+            link.bottleneckFreeAtMs = Max<double>(link.bottleneckFreeAtMs, m_nowMs) + ((wireBytes * 1000.0) / settings.bottleneckBytesPerSecond);
+            departureMs = link.bottleneckFreeAtMs;
+        }
+
+        int numCopies = RollChance(settings.duplicateRate) ? 2 : 1;
+        m_stats.numDuplicated += numCopies - 1;
+        for (int copy = 0; copy < numCopies; ++copy)
+        {
+            double deliverTimeMs = departureMs + (double)settings.minLatencyMs + RollLatencyMs(settings);
+            if (RollChance(settings.reorderRate))
+            {
+                ++m_stats.numReordered;
+                deliverTimeMs += (double)settings.reorderDelayMs;
+            }
+            Enqueue(from, toKey, datagram, deliverTimeMs);
+        }
+    }
+    return numDatagrams;
+}
+
+//-----------------------------------------------------------------------------------
+size_t NetSimulator::Receive(const sockaddr_in& to, UDPDatagram* outDatagrams, size_t maxDatagrams)
+{
+    auto found = m_endpoints.find(GetAddressKey(to));
+    if (found == m_endpoints.end())
+    {
+        return 0;
+    }
+    std::deque<uint32_t>& inbox = found->second.inbox;
+    size_t numReceived = Min<size_t>(maxDatagrams, inbox.size());
+    for (size_t i = 0; i < numReceived; ++i)
+    {
+        uint32_t datagramIndex = inbox.front();
+        inbox.pop_front();
+        const Datagram& datagram = m_datagrams[datagramIndex];
+        UDPDatagram& out = outDatagrams[i];
+        out.address = datagram.from;
+        out.size = datagram.size;
+        out.arrivalTimeMs = datagram.deliverTimeMs;
+        memcpy(out.buffer, datagram.data, datagram.size);
+        m_freeDatagrams.push_back(datagramIndex);
+    }
+    return numReceived;
+}
+
+//-----------------------------------------------------------------------------------
+bool NetSimulator::HasArrived(const sockaddr_in& to) const
+{
+    auto found = m_endpoints.find(GetAddressKey(to));
+    return found != m_endpoints.end() && !found->second.inbox.empty();
+}
+
+//-----------------------------------------------------------------------------------
+void NetSimulator::ResetStats()
+{
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+//-----------------------------------------------------------------------------------
+NetSimulator::Link& NetSimulator::GetLink(Endpoint& from, uint64_t toKey)
+{
+    auto found = from.links.find(toKey);
+    if (found != from.links.end())
+    {
+        return found->second;
+    }
+    Link& link = from.links[toKey];
+    link.settings = m_defaultSettings;
+    link.bottleneckFreeAtMs = 0.0;
+    link.isInLossBurst = false;
+    return link;
+}
+
+//-----------------------------------------------------------------------------------
+double NetSimulator::RollLatencyMs(const NetSimulatorLinkSettings& settings)
+{
+    if (settings.jitterMs == 0)
+    {
+        return 0.0;
+    }
+    const double UNIT = 1.0 / (double)0x1000000;
+    double jitterMs = (double)settings.jitterMs;
+    switch (settings.latencyDistribution)
+    {
+    case NetSimulatorLinkSettings::NORMAL:
+    {
+        //Sum of four uniforms is close enough to a bell, and stays in range
+        double sum = 0.0;
+        for (int i = 0; i < 4; ++i)
+        {
+            sum += (double)(NextRandom() & 0xFFFFFF) * UNIT;
+        }
+        return jitterMs * sum * 0.25;
+    }
+    case NetSimulatorLinkSettings::LONG_TAIL:
+        return -log(1.0 - ((double)(NextRandom() & 0xFFFFFF) * UNIT)) * jitterMs * 0.25;
+    default:
+        return jitterMs * (double)(NextRandom() & 0xFFFFFF) * UNIT;
+    }
+}
+
+//-----------------------------------------------------------------------------------
+bool NetSimulator::RollChance(float chance)
+{
+    return (NextRandom() & 0xFFFFFF) < (uint32_t)(chance * (float)0x1000000);
+}
+
+//-----------------------------------------------------------------------------------
+uint32_t NetSimulator::NextRandom()
+{
+    m_random ^= m_random << 13;
+    m_random ^= m_random >> 17;
+    m_random ^= m_random << 5;
+    return m_random;
+}
+
+//-----------------------------------------------------------------------------------
+void NetSimulator::Enqueue(const sockaddr_in& from, uint64_t toKey, const UDPDatagram& datagram, double deliverTimeMs)
+{
+    uint32_t datagramIndex = 0;
+    if (m_freeDatagrams.empty())
+    {
+        datagramIndex = (uint32_t)m_datagrams.size();
+        m_datagrams.emplace_back();
+    }
+    else
+    {
+        datagramIndex = m_freeDatagrams.back();
+        m_freeDatagrams.pop_back();
+    }
+    Datagram& stored = m_datagrams[datagramIndex];
+    stored.from = from;
+    stored.toKey = toKey;
+    stored.deliverTimeMs = deliverTimeMs;
+    stored.size = Min<size_t>(datagram.size, PACKET_MTU);
+    memcpy(stored.data, datagram.buffer, stored.size);
+
+    InFlight inFlight;
+    inFlight.deliverTimeMs = deliverTimeMs;
+    inFlight.sequence = m_nextSequence++;
+    inFlight.datagramIndex = datagramIndex;
+    m_inFlight.push_back(inFlight);
+    std::push_heap(m_inFlight.begin(), m_inFlight.end());
+}
+
+//-----------------------------------------------------------------------------------
+uint64_t NetSimulator::GetAddressKey(const sockaddr_in& address)
+{
+    return ((uint64_t)ntohl(address.sin_addr.s_addr) << 16) | (uint64_t)ntohs(address.sin_port);
+}
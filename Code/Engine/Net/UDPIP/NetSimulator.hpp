@@ -0,0 +1,145 @@
+#pragma once
+#include "Engine/Net/UDPIP/UDPTransport.hpp"
+#include <vector>
+#include <deque>
+#include <unordered_map>
+
+//-----------------------------------------------------------------------------------
+//How one direction between two endpoints misbehaves
+struct NetSimulatorLinkSettings
+{
+    //ENUMS/////////////////////////////////////////////////////////////////////
+    enum LatencyDistribution
+    {
+        UNIFORM, //Anywhere in [0, jitterMs]
+        NORMAL, //Bunched up around jitterMs / 2, still never outside [0, jitterMs]
+        LONG_TAIL, //Exponential with a mean of jitterMs / 4 and no upper bound, so the odd packet is very late
+        NUM_DISTRIBUTIONS
+    };
+
+    //CONSTRUCTORS/////////////////////////////////////////////////////////////////////
+    NetSimulatorLinkSettings()
+        : minLatencyMs(0)
+        , jitterMs(0)
+        , latencyDistribution(UNIFORM)
+        , lossRate(0.0f)
+        , meanLossBurstLength(1.0f)
+        , duplicateRate(0.0f)
+        , reorderRate(0.0f)
+        , reorderDelayMs(0)
+        , bottleneckBytesPerSecond(0.0f)
+        , bottleneckQueueBytes(64 * 1024)
+    {};
+
+    //MEMBER VARIABLES/////////////////////////////////////////////////////////////////////
+    unsigned int minLatencyMs;
+    unsigned int jitterMs; //Added on top of minLatencyMs, shaped by latencyDistribution
+    LatencyDistribution latencyDistribution;
+    float lossRate; //Chance a packet starts a loss burst, if the link isn't already in one
+    float meanLossBurstLength; //Packets lost in a row once a burst starts, on average. 1 is independent loss.
+    float duplicateRate; //The copy draws its own latency
+    float reorderRate; //Chance a packet is held back reorderDelayMs longer, so packets sent after it get there first
+    unsigned int reorderDelayMs;
+    float bottleneckBytesPerSecond; //If non-zero, packets (plus UDP/IP headers) queue to go through at this rate before their latency starts
+    unsigned int bottleneckQueueBytes; //Packets arriving to a queue this full are dropped, like a router's buffer
+};
+
+//-----------------------------------------------------------------------------------
+struct NetSimulatorStats
+{
+    unsigned int numSent;
+    unsigned int numDelivered;
+    unsigned int numLost;
+    unsigned int numDuplicated;
+    unsigned int numReordered;
+    unsigned int numBottleneckDrops;
+    unsigned int numUnroutable; //Sent to an address nothing is bound to, or that unbound before it arrived
+    unsigned int numInboxDrops; //Arrived while the receiver already had MAX_INBOX_DATAGRAMS waiting
+    size_t numBytesDelivered;
+};
+
+//-----------------------------------------------------------------------------------
+//An in-memory network for LoopbackTransports. Time only moves when AdvanceTime is called, and every random decision comes from
+//the seed, so the same seed and the same sends always deliver the same packets at the same times. Sessions on it should run on
+//their manual clock, set to GetTimeMilliseconds, for the whole run to be repeatable.
+//
+//Not thread safe, so don't start a PacketChannel's I/O thread on a loopback transport.
+class NetSimulator
+{
+public:
+    //CONSTRUCTORS/////////////////////////////////////////////////////////////////////
+    NetSimulator(uint32_t seed);
+
+    //FUNCTIONS/////////////////////////////////////////////////////////////////////
+    void AdvanceTime(double milliseconds); //Moves everything due by then into the receivers' inboxes
+    void SetDefaultLinkSettings(const NetSimulatorLinkSettings& settings); //For links that haven't carried anything yet
+    void SetLinkSettings(const sockaddr_in& from, const sockaddr_in& to, const NetSimulatorLinkSettings& settings);
+    sockaddr_in AddEndpoint(uint16_t port); //Every endpoint gets its own made up host, so ports can repeat
+    void RemoveEndpoint(const sockaddr_in& address);
+    size_t Send(const sockaddr_in& from, const UDPDatagram* datagrams, size_t numDatagrams);
+    size_t Receive(const sockaddr_in& to, UDPDatagram* outDatagrams, size_t maxDatagrams);
+    bool HasArrived(const sockaddr_in& to) const;
+    void ResetStats();
+
+    //GETTERS/////////////////////////////////////////////////////////////////////
+    inline double GetTimeMilliseconds() const { return m_nowMs; };
+    inline const NetSimulatorStats& GetStats() const { return m_stats; };
+    inline size_t GetNumInFlight() const { return m_inFlight.size(); };
+
+    //CONSTANTS/////////////////////////////////////////////////////////////////////
+    static const size_t MAX_INBOX_DATAGRAMS = 4096; //Roughly what a default socket receive buffer holds
+    static const uint32_t FIRST_HOST_ADDRESS = 0x0A000001; //10.0.0.1
+
+private:
+    //STRUCTS/////////////////////////////////////////////////////////////////////
+    struct Link
+    {
+        NetSimulatorLinkSettings settings;
+        double bottleneckFreeAtMs; //When the bottleneck finishes sending everything already queued on it
+        bool isInLossBurst;
+    };
+
+    struct Endpoint
+    {
+        std::deque<uint32_t> inbox; //Datagram indices waiting to be received
+        std::unordered_map<uint64_t, Link> links; //Outgoing, by destination
+    };
+
+    struct Datagram
+    {
+        sockaddr_in from;
+        uint64_t toKey;
+        double deliverTimeMs;
+        size_t size;
+        unsigned char data[PACKET_MTU];
+    };
+
+    //Heap entry. The sequence breaks ties between packets due at the same time, so they come out in the order they were sent.
+    struct InFlight
+    {
+        double deliverTimeMs;
+        uint64_t sequence;
+        uint32_t datagramIndex;
+        inline bool operator<(const InFlight& other) const { return deliverTimeMs != other.deliverTimeMs ? deliverTimeMs > other.deliverTimeMs : sequence > other.sequence; };
+    };
+
+    //PRIVATE FUNCTIONS/////////////////////////////////////////////////////////////////////
+    Link& GetLink(Endpoint& from, uint64_t toKey);
+    double RollLatencyMs(const NetSimulatorLinkSettings& settings);
+    bool RollChance(float chance);
+    uint32_t NextRandom();
+    void Enqueue(const sockaddr_in& from, uint64_t toKey, const UDPDatagram& datagram, double deliverTimeMs);
+    static uint64_t GetAddressKey(const sockaddr_in& address);
+
+    //MEMBER VARIABLES/////////////////////////////////////////////////////////////////////
+    double m_nowMs;
+    uint32_t m_random;
+    uint64_t m_nextSequence;
+    uint32_t m_nextHostAddress;
+    NetSimulatorLinkSettings m_defaultSettings;
+    NetSimulatorStats m_stats;
+    std::unordered_map<uint64_t, Endpoint> m_endpoints;
+    std::vector<InFlight> m_inFlight; //Heap, soonest first
+    std::vector<Datagram> m_datagrams; //Storage for everything in flight or in an inbox, reused through m_freeDatagrams
+    std::vector<uint32_t> m_freeDatagrams;
+};
@@ -0,0 +1,274 @@
+#include "Engine/Net/UDPIP/NetTests.hpp"
+#include "Engine/Net/UDPIP/NetSession.hpp"
+#include "Engine/Net/UDPIP/NetConnection.hpp"
+#include "Engine/Net/UDPIP/InterestManager.hpp"
+#include "Engine/Input/Console.hpp"
+#include "Engine/Math/MathUtils.hpp"
+
+//The console side of the net tests in NetTests.hpp: argument parsing and defaults. None of them need nsinit, each run builds its own sessions.
+
+//-----------------------------------------------------------------------------------
+static void PrintNetTestLine(const std::string& line, const RGBA& color)
+{
+    Console::instance->PrintLine(line, color);
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(reliabletest)
+{
+    if (!(args.HasArgs(0) || args.HasArgs(2)))
+    {
+        Console::instance->PrintLine("reliabletest <runs> <seed>", RGBA::RED);
+        return;
+    }
+    int numRuns = args.HasArgs(2) ? args.GetIntArgument(0) : 8;
+    uint32_t seed = args.HasArgs(2) ? (uint32_t)args.GetIntArgument(1) : 1;
+    RunReliableTest(numRuns, seed, &PrintNetTestLine);
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(inordertest)
+{
+    if (!(args.HasArgs(0) || args.HasArgs(2)))
+    {
+        Console::instance->PrintLine("inordertest <runs> <seed>", RGBA::RED);
+        return;
+    }
+    int numRuns = args.HasArgs(2) ? args.GetIntArgument(0) : 8;
+    uint32_t seed = args.HasArgs(2) ? (uint32_t)args.GetIntArgument(1) : 1;
+    RunInOrderTest(numRuns, seed, &PrintNetTestLine);
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(reliablebench)
+{
+    if (!(args.HasArgs(0) || args.HasArgs(3)))
+    {
+        Console::instance->PrintLine("reliablebench <messages> <lossPercent> <messagesPerTick>", RGBA::RED);
+        return;
+    }
+    unsigned int numMessages = args.HasArgs(3) ? (unsigned int)args.GetIntArgument(0) : 500000;
+    float lossRate = args.HasArgs(3) ? Clamp<float>(args.GetFloatArgument(1) / 100.0f, 0.0f, 0.9f) : 0.1f;
+    unsigned int messagesPerTick = args.HasArgs(3) ? (unsigned int)Clamp<int>(args.GetIntArgument(2), 1, NetConnection::MAX_RELIABLES_PER_PACKET) : 16;
+    RunReliableBenchmark(numMessages, lossRate, messagesPerTick, &PrintNetTestLine);
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(inorderbench)
+{
+    if (!(args.HasArgs(0) || args.HasArgs(3)))
+    {
+        Console::instance->PrintLine("inorderbench <messages> <maxJitterMs> <lossPercent>", RGBA::RED);
+        return;
+    }
+    unsigned int numMessages = args.HasArgs(3) ? (unsigned int)args.GetIntArgument(0) : 500000;
+    unsigned int maxJitterMs = args.HasArgs(3) ? (unsigned int)Clamp<int>(args.GetIntArgument(1), 0, 1000) : 40;
+    float lossRate = args.HasArgs(3) ? Clamp<float>(args.GetFloatArgument(2) / 100.0f, 0.0f, 0.9f) : 0.05f;
+    RunInOrderBenchmark(numMessages, maxJitterMs, lossRate, &PrintNetTestLine);
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(rtttest)
+{
+    if (!(args.HasArgs(0) || args.HasArgs(2) || args.HasArgs(3)))
+    {
+        Console::instance->PrintLine("rtttest <minLagMs> <maxLagMs> [lossPercent]", RGBA::RED);
+        return;
+    }
+    if (args.HasArgs(0))
+    {
+        RunRoundTripTests(&PrintNetTestLine);
+        return;
+    }
+    unsigned int minLagMs = (unsigned int)Clamp<int>(args.GetIntArgument(0), 0, 1000);
+    unsigned int maxLagMs = (unsigned int)Clamp<int>(args.GetIntArgument(1), (int)minLagMs, 1000);
+    float lossRate = args.HasArgs(3) ? Clamp<float>(args.GetFloatArgument(2) / 100.0f, 0.0f, 0.5f) : 0.0f;
+    RunRoundTripTest(minLagMs, maxLagMs, lossRate, 12345, &PrintNetTestLine);
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(congestiontest)
+{
+    if (!(args.HasArgs(0) || args.HasArgs(1) || args.HasArgs(2)))
+    {
+        Console::instance->PrintLine("congestiontest <bottleneckKilobytesPerSecond> [lagMs]", RGBA::RED);
+        return;
+    }
+    float bottleneckBytesPerSecond = args.HasArgs(0) ? 32.0f * 1024.0f : Clamp<float>(args.GetFloatArgument(0), 4.0f, 1024.0f) * 1024.0f;
+    unsigned int lagMs = args.HasArgs(2) ? (unsigned int)Clamp<int>(args.GetIntArgument(1), 0, 500) : 30;
+    RunCongestionTest(bottleneckBytesPerSecond, lagMs, &PrintNetTestLine);
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(prioritytest)
+{
+    if (!(args.HasArgs(0) || args.HasArgs(1) || args.HasArgs(2)))
+    {
+        Console::instance->PrintLine("prioritytest <bottleneckKilobytesPerSecond> [lagMs]", RGBA::RED);
+        return;
+    }
+    float bottleneckBytesPerSecond = args.HasArgs(0) ? 32.0f * 1024.0f : Clamp<float>(args.GetFloatArgument(0), 4.0f, 1024.0f) * 1024.0f;
+    unsigned int lagMs = args.HasArgs(2) ? (unsigned int)Clamp<int>(args.GetIntArgument(1), 0, 500) : 30;
+    RunPriorityTest(bottleneckBytesPerSecond, lagMs, &PrintNetTestLine);
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(fragmenttest)
+{
+    if (!(args.HasArgs(0) || args.HasArgs(2)))
+    {
+        Console::instance->PrintLine("fragmenttest <runs> <seed>", RGBA::RED);
+        return;
+    }
+    int numRuns = args.HasArgs(2) ? args.GetIntArgument(0) : 8;
+    uint32_t seed = args.HasArgs(2) ? (uint32_t)args.GetIntArgument(1) : 1;
+    RunFragmentTest(numRuns, seed, &PrintNetTestLine);
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(fragmentbench)
+{
+    if (!(args.HasArgs(0) || args.HasArgs(3)))
+    {
+        Console::instance->PrintLine("fragmentbench <messages> <lossPercent> <sendIntervalMs>", RGBA::RED);
+        return;
+    }
+    unsigned int numMessages = args.HasArgs(3) ? (unsigned int)Max<int>(args.GetIntArgument(0), 1) : 256;
+    float lossRate = args.HasArgs(3) ? Clamp<float>(args.GetFloatArgument(1) / 100.0f, 0.0f, 0.9f) : 0.05f;
+    unsigned int sendIntervalMs = args.HasArgs(3) ? (unsigned int)Clamp<int>(args.GetIntArgument(2), 1, 100) : 1;
+    RunFragmentBenchmark(numMessages, lossRate, sendIntervalMs, &PrintNetTestLine);
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(compressedlinktest)
+{
+    if (!(args.HasArgs(0) || args.HasArgs(2)))
+    {
+        Console::instance->PrintLine("compressedlinktest <runs> <seed>", RGBA::RED);
+        return;
+    }
+    int numRuns = args.HasArgs(2) ? args.GetIntArgument(0) : 4;
+    uint32_t seed = args.HasArgs(2) ? (uint32_t)args.GetIntArgument(1) : 1;
+    RunCompressedLinkTest(numRuns, seed, &PrintNetTestLine);
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(netsimtest)
+{
+    if (!(args.HasArgs(0) || args.HasArgs(2)))
+    {
+        Console::instance->PrintLine("netsimtest <runs> <seed>", RGBA::RED);
+        return;
+    }
+    int numRuns = args.HasArgs(2) ? args.GetIntArgument(0) : 4;
+    uint32_t seed = args.HasArgs(2) ? (uint32_t)args.GetIntArgument(1) : 1;
+    RunNetSimTest(numRuns, seed, &PrintNetTestLine);
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(netmsgbench)
+{
+    if (!(args.HasArgs(0) || args.HasArgs(3)))
+    {
+        Console::instance->PrintLine("netmsgbench <seconds> <payloadBytes> <messagesPerTick>", RGBA::RED);
+        return;
+    }
+    double seconds = args.HasArgs(3) ? args.GetFloatArgument(0) : 1.0;
+    int payloadSize = args.HasArgs(3) ? Clamp<int>(args.GetIntArgument(1), 0, MESSAGE_MTU) : 32;
+    int messagesPerTick = args.HasArgs(3) ? Clamp<int>(args.GetIntArgument(2), 1, 255) : 16;
+    RunNetMessageBenchmark(seconds, payloadSize, messagesPerTick, &PrintNetTestLine);
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(nsscalebench)
+{
+    if (!(args.HasArgs(0) || args.HasArgs(2)))
+    {
+        Console::instance->PrintLine("nsscalebench <maxClients> <ticks>", RGBA::RED);
+        return;
+    }
+    unsigned int maxClients = args.HasArgs(2) ? (unsigned int)Clamp<int>(args.GetIntArgument(0), 1, NetSession::MAX_CONNECTIONS - 1) : 256;
+    unsigned int numTicks = args.HasArgs(2) ? (unsigned int)Clamp<int>(args.GetIntArgument(1), 1, 100000) : 600;
+    RunServerScaleBenchmark(maxClients, numTicks, &PrintNetTestLine);
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(netstalltest)
+{
+    if (!(args.HasArgs(0) || args.HasArgs(3)))
+    {
+        Console::instance->PrintLine("netstalltest <seconds> <stallMs> <packetsPerSecond>", RGBA::RED);
+        return;
+    }
+    double seconds = args.HasArgs(3) ? args.GetFloatArgument(0) : 5.0;
+    double stallMs = args.HasArgs(3) ? args.GetFloatArgument(1) : 200.0;
+    unsigned int packetsPerSecond = args.HasArgs(3) ? (unsigned int)args.GetIntArgument(2) : 10000;
+    RunStallTest(seconds, stallMs, packetsPerSecond, &PrintNetTestLine);
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(snapshottest)
+{
+    if (!(args.HasArgs(0) || args.HasArgs(2)))
+    {
+        Console::instance->PrintLine("snapshottest <ticks> <seed>", RGBA::RED);
+        return;
+    }
+    unsigned int numTicks = args.HasArgs(2) ? (unsigned int)Max<int>(args.GetIntArgument(0), 1) : 600;
+    uint32_t seed = args.HasArgs(2) ? (uint32_t)args.GetIntArgument(1) : 1;
+    RunSnapshotTest(numTicks, seed, &PrintNetTestLine);
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(interesttest)
+{
+    if (!(args.HasArgs(0) || args.HasArgs(2)))
+    {
+        Console::instance->PrintLine("interesttest <runs> <seed>", RGBA::RED);
+        return;
+    }
+    int numRuns = args.HasArgs(2) ? args.GetIntArgument(0) : 6;
+    uint32_t seed = args.HasArgs(2) ? (uint32_t)args.GetIntArgument(1) : 1;
+    RunInterestTest(numRuns, seed, &PrintNetTestLine);
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(interestbench)
+{
+    if (!(args.HasArgs(0) || args.HasArgs(4)))
+    {
+        Console::instance->PrintLine("interestbench <entities> <connections> <radius> <perUpdate>", RGBA::RED);
+        return;
+    }
+    unsigned int numEntities = args.HasArgs(4) ? (unsigned int)Clamp<int>(args.GetIntArgument(0), 1, (int)InterestManager::MAX_ENTITIES) : 10000;
+    unsigned int numConnections = args.HasArgs(4) ? (unsigned int)Clamp<int>(args.GetIntArgument(1), 1, (int)NetSession::MAX_CONNECTIONS) : 128;
+    float radius = args.HasArgs(4) ? args.GetFloatArgument(2) : 100.0f;
+    unsigned int maxEntitiesPerUpdate = args.HasArgs(4) ? (unsigned int)Max<int>(args.GetIntArgument(3), 1) : 32;
+    RunInterestBenchmark(numEntities, numConnections, radius, maxEntitiesPerUpdate, &PrintNetTestLine);
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(compresstest)
+{
+    if (!(args.HasArgs(0) || args.HasArgs(2)))
+    {
+        Console::instance->PrintLine("compresstest <runs> <seed>", RGBA::RED);
+        return;
+    }
+    int numRuns = args.HasArgs(2) ? Max<int>(args.GetIntArgument(0), 1) : 2000;
+    uint32_t seed = args.HasArgs(2) ? (uint32_t)args.GetIntArgument(1) : 1;
+    RunCompressorTest(numRuns, seed, &PrintNetTestLine);
+}
+
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(compressbench)
+{
+    if (!(args.HasArgs(1) || args.HasArgs(2)))
+    {
+        Console::instance->PrintLine("compressbench <recordingFile> [dictionaryFile]", RGBA::RED);
+        return;
+    }
+    std::string recordingPath = args.GetStringArgument(0);
+    std::string dictionaryPath = args.HasArgs(2) ? args.GetStringArgument(1) : "";
+    RunCompressorBenchmark(recordingPath.c_str(), args.HasArgs(2) ? dictionaryPath.c_str() : nullptr, &PrintNetTestLine);
+}
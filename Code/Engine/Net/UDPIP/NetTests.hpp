@@ -0,0 +1,44 @@
+#pragma once
+#include "Engine/Renderer/RGBA.hpp"
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+//Tests and benchmarks for the UDP session stack. Each module's live in <Module>Tests.cpp beside it, and every run builds the sessions,
+//connections and links it needs, so nothing here touches NetSession::instance. NetTestCommands.cpp wraps them as console commands,
+//and the NetTests runner calls them headless. Tests return whether every check passed, both print a line per result as they go.
+typedef void(NetTestPrintCallback)(const std::string& line, const RGBA& color);
+
+//NetConnectionTests.cpp/////////////////////////////////////////////////////////////////////
+bool RunReliableTest(int numRuns, uint32_t seed, NetTestPrintCallback* print);
+bool RunInOrderTest(int numRuns, uint32_t seed, NetTestPrintCallback* print);
+void RunReliableBenchmark(unsigned int numMessages, float lossRate, unsigned int messagesPerTick, NetTestPrintCallback* print);
+void RunInOrderBenchmark(unsigned int numMessages, unsigned int maxJitterMs, float lossRate, NetTestPrintCallback* print);
+bool RunRoundTripTest(unsigned int minLagMs, unsigned int maxLagMs, float lossRate, uint32_t seed, NetTestPrintCallback* print);
+bool RunRoundTripTests(NetTestPrintCallback* print); //A spread of lag ranges, one of them lossy
+bool RunCongestionTest(float bottleneckBytesPerSecond, unsigned int lagMs, NetTestPrintCallback* print);
+bool RunPriorityTest(float bottleneckBytesPerSecond, unsigned int lagMs, NetTestPrintCallback* print);
+bool RunFragmentTest(int numRuns, uint32_t seed, NetTestPrintCallback* print);
+void RunFragmentBenchmark(unsigned int numMessages, float lossRate, unsigned int sendIntervalMs, NetTestPrintCallback* print);
+bool RunCompressedLinkTest(int numRuns, uint32_t seed, NetTestPrintCallback* print);
+
+//NetSessionTests.cpp/////////////////////////////////////////////////////////////////////
+bool RunNetSimTest(int numRuns, uint32_t seed, NetTestPrintCallback* print);
+void RunNetMessageBenchmark(double seconds, int payloadSize, int messagesPerTick, NetTestPrintCallback* print);
+void RunServerScaleBenchmark(unsigned int maxClients, unsigned int numTicks, NetTestPrintCallback* print);
+
+//PacketChannelTests.cpp/////////////////////////////////////////////////////////////////////
+bool RunStallTest(double seconds, double stallMs, unsigned int packetsPerSecond, NetTestPrintCallback* print); //Binds real loopback sockets
+
+//SnapshotReplicatorTests.cpp/////////////////////////////////////////////////////////////////////
+bool RunSnapshotTest(unsigned int numTicks, uint32_t seed, NetTestPrintCallback* print);
+void RecordSnapshotTraffic(unsigned int numTicks, uint32_t seed, std::vector<unsigned char>& outRecording); //Delta + interest, in nsrecord's format
+
+//InterestManagerTests.cpp/////////////////////////////////////////////////////////////////////
+bool RunInterestTest(int numRuns, uint32_t seed, NetTestPrintCallback* print);
+void RunInterestBenchmark(unsigned int numEntities, unsigned int numConnections, float radius, unsigned int maxEntitiesPerUpdate, NetTestPrintCallback* print);
+
+//PacketCompressorTests.cpp/////////////////////////////////////////////////////////////////////
+bool RunCompressorTest(int numRuns, uint32_t seed, NetTestPrintCallback* print);
+bool RunCompressorBenchmark(const char* recordingPath, const char* dictionaryPath, NetTestPrintCallback* print); //Dictionary can be null
+bool WriteCompressorCorpus(const char* recordingPath, const char* dictionaryPath, NetTestPrintCallback* print);
@@ -1,11 +1,21 @@
 #include "Engine/Net/UDPIP/PacketChannel.hpp"
 #include "Engine/Time/Time.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include <vector>
 
 //-----------------------------------------------------------------------------------
 PacketChannel::PacketChannel()
     : m_additionalLagMilliseconds(0.0f, 0.0f)
     , m_dropRate(0.0f)
-    , m_pool(2048)
+    , m_pool(PACKET_POOL_SIZE)
+    , m_transport(new UDPSocket())
+    , m_ioThread(nullptr)
+    , m_isIOThreadRunning(false)
+    , m_inboundRing(nullptr)
+    , m_outboundRing(nullptr)
+    , m_numInboundRingDrops(0)
+    , m_numOutboundRingDrops(0)
 {
 
 }
@@ -13,26 +23,132 @@ PacketChannel::PacketChannel()
 //-----------------------------------------------------------------------------------
 PacketChannel::~PacketChannel()
 {
+    StopIOThread();
+    while (m_inboundPackets.Size() > 0)
+    {
+        m_pool.Free(m_inboundPackets.Dequeue());
+    }
+    delete m_transport;
+}
 
+//-----------------------------------------------------------------------------------
+void PacketChannel::SetTransport(UDPTransport* transport)
+{
+    ASSERT_OR_DIE(!m_transport->IsBound(), "Attempted to swap the transport on a bound packet channel");
+    delete m_transport;
+    m_transport = transport;
+}
+
+//-----------------------------------------------------------------------------------
+void PacketChannel::StartIOThread(unsigned int ringCapacity)
+{
+    ASSERT_OR_DIE(IsBound(), "Attempted to start the I/O thread before binding the packet channel");
+    if (IsIOThreadRunning())
+    {
+        return;
+    }
+    m_inboundRing = new SPSCRingBuffer<TimeStampedPacket>(ringCapacity);
+    m_outboundRing = new SPSCRingBuffer<TimeStampedPacket>(ringCapacity);
+    m_numInboundRingDrops = 0;
+    m_numOutboundRingDrops = 0;
+    m_isIOThreadRunning = true;
+    m_ioThread = new std::thread(&PacketChannel::IOThreadMain, this);
+}
+
+//-----------------------------------------------------------------------------------
+void PacketChannel::StopIOThread()
+{
+    if (!IsIOThreadRunning())
+    {
+        return;
+    }
+    m_isIOThreadRunning = false;
+    m_ioThread->join();
+    delete m_ioThread;
+    m_ioThread = nullptr;
+
+    //Anything the game thread never picked up goes away with the ring
+    delete m_inboundRing;
+    delete m_outboundRing;
+    m_inboundRing = nullptr;
+    m_outboundRing = nullptr;
 }
 
 //-----------------------------------------------------------------------------------
 size_t PacketChannel::SendTo(const sockaddr_in& toAddress, void const* data, const size_t dataSize)
 {
-    return m_socket.SendTo(toAddress, data, dataSize);
+    UDPDatagram datagram;
+    datagram.address = toAddress;
+    datagram.buffer = const_cast<void*>(data);
+    datagram.size = dataSize;
+    return SendBatch(&datagram, 1) == 1 ? dataSize : 0;
+}
+
+//-----------------------------------------------------------------------------------
+size_t PacketChannel::SendBatch(const UDPDatagram* datagrams, size_t numDatagrams)
+{
+    if (!IsIOThreadRunning())
+    {
+        return m_transport->SendBatch(datagrams, numDatagrams);
+    }
+
+    unsigned int numQueued = (unsigned int)Min<size_t>(numDatagrams, m_outboundRing->GetNumWritable());
+    for (unsigned int i = 0; i < numQueued; ++i)
+    {
+        TimeStampedPacket* slot = m_outboundRing->GetWriteSlot(i);
+        slot->packet.m_fromAddress = datagrams[i].address;
+        memcpy(slot->packet.m_buffer, datagrams[i].buffer, datagrams[i].size);
+        slot->packet.SetReadableBytes(datagrams[i].size);
+    }
+    m_outboundRing->CommitWrites(numQueued);
+    m_numOutboundRingDrops += numDatagrams - numQueued;
+    return numQueued;
 }
 
 //-----------------------------------------------------------------------------------
-void PacketChannel::ReceiveOffSocket(sockaddr_in& fromAddress)
+//Either straight off the transport, or out of the inbound ring if the I/O thread owns the transport
+size_t PacketChannel::ReceiveFromSource(UDPDatagram* outDatagrams, size_t maxDatagrams)
 {
+    if (!IsIOThreadRunning())
+    {
+        return m_transport->ReceiveBatch(outDatagrams, maxDatagrams);
+    }
+
+    unsigned int numReceived = (unsigned int)Min<size_t>(maxDatagrams, m_inboundRing->GetNumReadable());
+    for (unsigned int i = 0; i < numReceived; ++i)
+    {
+        TimeStampedPacket* slot = m_inboundRing->GetReadSlot(i);
+        UDPDatagram& datagram = outDatagrams[i];
+        datagram.address = slot->packet.m_fromAddress;
+        datagram.size = slot->packet.GetTotalReadableBytes();
+        datagram.arrivalTimeMs = slot->packet.m_arrivalTimeMs;
+        memcpy(datagram.buffer, slot->packet.m_buffer, datagram.size);
+    }
+    m_inboundRing->ReleaseReads(numReceived);
+    return numReceived;
+}
+
+//-----------------------------------------------------------------------------------
+void PacketChannel::ReceiveOffSocket()
+{
+    TimeStampedPacket* batch[UDPTransport::MAX_BATCH_SIZE];
+    UDPDatagram datagrams[UDPTransport::MAX_BATCH_SIZE];
     size_t read = 0;
-    do 
+    size_t batchSize = 0;
+    do
     {
-        TimeStampedPacket* timeStamped = m_pool.Alloc<TimeStampedPacket>();
-        read = m_socket.RecieveFrom(fromAddress, timeStamped->packet.m_buffer);
-        timeStamped->packet.m_fromAddress = fromAddress;
-        if (read > 0)
+        //Never hand out more than the pool has left, anything we can't hold stays in the kernel buffer
+        batchSize = Min<size_t>(UDPTransport::MAX_BATCH_SIZE, PACKET_POOL_SIZE - m_inboundPackets.Size());
+        for (size_t i = 0; i < batchSize; ++i)
+        {
+            batch[i] = m_pool.Alloc<TimeStampedPacket>();
+            datagrams[i].buffer = batch[i]->packet.m_buffer;
+        }
+
+        read = ReceiveFromSource(datagrams, batchSize);
+        for (size_t i = 0; i < read; ++i)
         {
+            TimeStampedPacket* timeStamped = batch[i];
             if (MathUtils::GetRandomFloatFromZeroTo(1.0f) < m_dropRate)
             {
                 m_pool.Free(timeStamped);
@@ -40,42 +156,148 @@ void PacketChannel::ReceiveOffSocket(sockaddr_in& fromAddress)
             else
             {
                 double delay = m_additionalLagMilliseconds.GetRandom();
-                timeStamped->packet.SetReadableBytes(read);
-                timeStamped->timeToProcess = GetCurrentTimeMilliseconds() + delay;
+                timeStamped->packet.m_fromAddress = datagrams[i].address;
+                timeStamped->packet.m_arrivalTimeMs = datagrams[i].arrivalTimeMs;
+                timeStamped->packet.SetReadableBytes(datagrams[i].size);
+                timeStamped->timeToProcess = datagrams[i].arrivalTimeMs + delay;
                 m_inboundPackets.Enqueue(timeStamped);
             }
         }
-        else
+        for (size_t i = read; i < batchSize; ++i)
         {
-            m_pool.Free(timeStamped);
+            m_pool.Free(batch[i]);
         }
-    } while (read > 0);
+    } while (read > 0 && read == batchSize);
+}
+
+//-----------------------------------------------------------------------------------
+size_t PacketChannel::ReceiveBatch(UDPDatagram* outDatagrams, size_t maxDatagrams)
+{
+    //Nothing to simulate and nothing held back, so the source can fill the caller's buffers directly
+    if (!IsSimulatingConditions() && m_inboundPackets.Size() == 0)
+    {
+        return ReceiveFromSource(outDatagrams, maxDatagrams);
+    }
+
+    ReceiveOffSocket();
+    size_t numReceived = 0;
+    double curentTimeMilliseconds = GetCurrentTimeMilliseconds();
+    while (numReceived < maxDatagrams && m_inboundPackets.Size() > 0 && curentTimeMilliseconds >= m_inboundPackets.Peek()->timeToProcess)
+    {
+        TimeStampedPacket* tsp = m_inboundPackets.Dequeue();
+        UDPDatagram& datagram = outDatagrams[numReceived];
+        datagram.address = tsp->packet.m_fromAddress;
+        datagram.size = tsp->packet.GetTotalReadableBytes();
+        datagram.arrivalTimeMs = tsp->packet.m_arrivalTimeMs;
+        memcpy(datagram.buffer, tsp->packet.m_buffer, datagram.size);
+        m_pool.Free(tsp);
+        ++numReceived;
+    }
+    return numReceived;
 }
 
 //-----------------------------------------------------------------------------------
 size_t PacketChannel::RecieveFrom(sockaddr_in& fromAddress, void* buffer)
 {
-    ReceiveOffSocket(fromAddress);
-    if (m_inboundPackets.Size() > 0)
+    UDPDatagram datagram;
+    datagram.buffer = buffer;
+    if (ReceiveBatch(&datagram, 1) == 1)
     {
-        double curentTimeMilliseconds = GetCurrentTimeMilliseconds();
-        if (curentTimeMilliseconds >= m_inboundPackets.Peek()->timeToProcess)
-        {
-            TimeStampedPacket* tsp = m_inboundPackets.Dequeue();
-            fromAddress = tsp->packet.m_fromAddress;
-            size_t size = tsp->packet.GetTotalReadableBytes();
-            memcpy(buffer, tsp->packet.m_buffer, size);
-            m_pool.Free(tsp);
-            return size;
-        }
+        fromAddress = datagram.address;
+        return datagram.size;
     }
     return 0;
-
 }
 
 //-----------------------------------------------------------------------------------
 sockaddr_in PacketChannel::GetAddress()
 {
-    return m_socket.m_address;
+    return m_transport->GetAddress();
 }
 
+//-----------------------------------------------------------------------------------
+void PacketChannel::IOThreadMain()
+{
+    std::vector<unsigned char> overflowBuffers(UDPTransport::MAX_BATCH_SIZE * PACKET_MTU);
+    while (m_isIOThreadRunning)
+    {
+        bool didSend = FlushOutboundRing();
+        bool didReceive = FillInboundRing(overflowBuffers.data());
+        if (!didSend && !didReceive)
+        {
+            m_transport->WaitForData(IO_THREAD_WAIT_MS);
+        }
+    }
+    //Whatever the game queued before stopping still goes out
+    FlushOutboundRing();
+}
+
+//-----------------------------------------------------------------------------------
+bool PacketChannel::FlushOutboundRing()
+{
+    UDPDatagram datagrams[UDPTransport::MAX_BATCH_SIZE];
+    unsigned int numOutbound = m_outboundRing->GetNumReadable();
+    bool didSend = numOutbound > 0;
+    while (numOutbound > 0)
+    {
+        unsigned int batchSize = Min<unsigned int>(numOutbound, UDPTransport::MAX_BATCH_SIZE);
+        for (unsigned int i = 0; i < batchSize; ++i)
+        {
+            TimeStampedPacket* slot = m_outboundRing->GetReadSlot(i);
+            datagrams[i].address = slot->packet.m_fromAddress;
+            datagrams[i].buffer = slot->packet.m_buffer;
+            datagrams[i].size = slot->packet.GetTotalReadableBytes();
+        }
+        m_transport->SendBatch(datagrams, batchSize);
+        m_outboundRing->ReleaseReads(batchSize);
+        numOutbound -= batchSize;
+    }
+    return didSend;
+}
+
+//-----------------------------------------------------------------------------------
+//Drains the transport into the inbound ring, a bounded number of batches per pass so outbound packets don't starve during a flood.
+bool PacketChannel::FillInboundRing(unsigned char* overflowBuffers)
+{
+    const int MAX_BATCHES_PER_PASS = 16;
+    UDPDatagram datagrams[UDPTransport::MAX_BATCH_SIZE];
+    bool didReceive = false;
+    size_t numReceived = 0;
+    size_t batchSize = 0;
+    int numBatches = 0;
+    do
+    {
+        unsigned int numWritable = m_inboundRing->GetNumWritable();
+        if (numWritable > 0)
+        {
+            batchSize = Min<size_t>(numWritable, UDPTransport::MAX_BATCH_SIZE);
+            for (size_t i = 0; i < batchSize; ++i)
+            {
+                datagrams[i].buffer = m_inboundRing->GetWriteSlot((unsigned int)i)->packet.m_buffer;
+            }
+            numReceived = m_transport->ReceiveBatch(datagrams, batchSize);
+            for (size_t i = 0; i < numReceived; ++i)
+            {
+                NetPacket& packet = m_inboundRing->GetWriteSlot((unsigned int)i)->packet;
+                packet.m_fromAddress = datagrams[i].address;
+                packet.m_arrivalTimeMs = datagrams[i].arrivalTimeMs;
+                packet.SetReadableBytes(datagrams[i].size);
+            }
+            m_inboundRing->CommitWrites((unsigned int)numReceived);
+        }
+        else
+        {
+            //The game thread is a whole ring behind. Keep draining the socket anyway so the kernel buffer doesn't overflow
+            //behind our back, and count what gets thrown away here instead.
+            batchSize = UDPTransport::MAX_BATCH_SIZE;
+            for (size_t i = 0; i < batchSize; ++i)
+            {
+                datagrams[i].buffer = overflowBuffers + (i * PACKET_MTU);
+            }
+            numReceived = m_transport->ReceiveBatch(datagrams, batchSize);
+            m_numInboundRingDrops += (unsigned int)numReceived;
+        }
+        didReceive |= numReceived > 0;
+    } while (numReceived == batchSize && ++numBatches < MAX_BATCHES_PER_PASS);
+    return didReceive;
+}
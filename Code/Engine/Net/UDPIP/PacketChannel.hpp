@@ -4,6 +4,9 @@
 #include "Engine/Math/MathUtils.hpp"
 #include "Engine/Net/UDPIP/UDPSocket.hpp"
 #include "Engine/DataStructures/ThreadSafePriorityQueue.hpp"
+#include "Engine/DataStructures/SPSCRingBuffer.hpp"
+#include <thread>
+#include <atomic>
 
 //-----------------------------------------------------------------------------------
 struct TimeStampedPacket
@@ -43,17 +46,46 @@ public:
     ~PacketChannel();
 
     //FUNCTIONS/////////////////////////////////////////////////////////////////////
-    inline void Bind(const char* address, const char* portNumber) { m_socket.Bind(address, portNumber); };
-    inline void Unbind() { m_socket.Unbind(); };
-    inline bool IsBound() { return m_socket.IsBound(); };
+    inline void Bind(const char* address, const char* portNumber) { m_transport->Bind(address, portNumber); };
+    inline void Unbind() { StopIOThread(); m_transport->Unbind(); };
+    inline bool IsBound() { return m_transport->IsBound(); };
+    void StartIOThread(unsigned int ringCapacity = DEFAULT_IO_RING_CAPACITY);
+    void StopIOThread();
+    inline bool IsIOThreadRunning() const { return m_ioThread != nullptr; };
+    void SetTransport(UDPTransport* transport);
     size_t SendTo(const sockaddr_in& toAddress, void const* data, const size_t dataSize);
+    size_t SendBatch(const UDPDatagram* datagrams, size_t numDatagrams);
     size_t RecieveFrom(sockaddr_in& fromAddress, void* buffer);
+    size_t ReceiveBatch(UDPDatagram* outDatagrams, size_t maxDatagrams);
     sockaddr_in GetAddress();
-    void ReceiveOffSocket(sockaddr_in& fromAddress);
+    void ReceiveOffSocket();
+    inline bool IsSimulatingConditions() { return m_dropRate > 0.0f || m_additionalLagMilliseconds.maxValue > 0.0; };
+
+    //CONSTANTS/////////////////////////////////////////////////////////////////////
+    static const size_t PACKET_POOL_SIZE = 2048;
+    static const unsigned int DEFAULT_IO_RING_CAPACITY = 1024;
+    static const unsigned int IO_THREAD_WAIT_MS = 1;
+
     //MEMBER VARIABLES/////////////////////////////////////////////////////////////////////
-    UDPSocket m_socket;
+    UDPTransport* m_transport; //Owned, a UDPSocket unless something else was handed to SetTransport
     float m_dropRate;
     ThreadSafePriorityQueue<TimeStampedPacket*, TimeStampedPacketComparison> m_inboundPackets;
     Range<double> m_additionalLagMilliseconds;
     ObjectPool<TimeStampedPacket> m_pool;
+
+    //Optional I/O thread. While it runs it is the only thing touching the transport; the game thread only sees the rings.
+    //Outbound slots reuse packet.m_fromAddress as the destination.
+    std::thread* m_ioThread;
+    std::atomic<bool> m_isIOThreadRunning;
+    SPSCRingBuffer<TimeStampedPacket>* m_inboundRing; //I/O thread -> game thread
+    SPSCRingBuffer<TimeStampedPacket>* m_outboundRing; //Game thread -> I/O thread
+    std::atomic<unsigned int> m_numInboundRingDrops; //Arrived while the game thread had the inbound ring full
+    unsigned int m_numOutboundRingDrops; //Sent while the I/O thread had the outbound ring full
+
+private:
+    //PRIVATE FUNCTIONS/////////////////////////////////////////////////////////////////////
+    size_t ReceiveFromSource(UDPDatagram* outDatagrams, size_t maxDatagrams);
+    void IOThreadMain();
+    bool FlushOutboundRing();
+    bool FillInboundRing(unsigned char* overflowBuffers);
 };
\ No newline at end of file
@@ -0,0 +1,152 @@
+#include "Engine/Net/UDPIP/PacketChannel.hpp"
+#include "Engine/Net/UDPIP/UDPSocket.hpp"
+#include "Engine/Net/UDPIP/NetTests.hpp"
+#include "Engine/Time/Time.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <cstring>
+
+//TESTS/////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------------
+struct StallTestResult
+{
+    unsigned int numSent;
+    unsigned int numReceived;
+    double totalDelayMs; //Send until the game thread saw it
+    double maxDelayMs;
+    double totalMeasuredMs; //Send until the arrival timestamp, what RTT sampling sees
+    double maxMeasuredMs;
+};
+
+//-----------------------------------------------------------------------------------
+//Streams timestamped packets at a PacketChannel over loopback from another thread while the "game thread" runs 16ms frames
+//with a long stall every 30 frames, then reports how many packets were lost and how late they were seen.
+static bool RunStallFrames(bool useIOThread, double seconds, double stallMs, unsigned int packetsPerSecond, StallTestResult& result)
+{
+    const double FRAME_MS = 16.0;
+    const int FRAMES_BETWEEN_STALLS = 30;
+    const double DRAIN_MS = 250.0;
+    const size_t PAYLOAD_SIZE = 64;
+    memset(&result, 0, sizeof(result));
+
+    PacketChannel receiver;
+    UDPSocket sender;
+    receiver.Bind("127.0.0.1", "4410");
+    sender.Bind("127.0.0.1", "4420");
+    if (!receiver.IsBound() || !sender.IsBound())
+    {
+        return false;
+    }
+    if (useIOThread)
+    {
+        receiver.StartIOThread(8192);
+    }
+
+    std::atomic<bool> isSending(true);
+    sockaddr_in receiverAddress = receiver.GetAddress();
+    std::thread senderThread([&]()
+    {
+        std::vector<unsigned char> payloads(UDPTransport::MAX_BATCH_SIZE * PAYLOAD_SIZE, 0);
+        UDPDatagram datagrams[UDPTransport::MAX_BATCH_SIZE];
+        double startMs = GetCurrentTimeMilliseconds();
+        double nowMs = startMs;
+        while (nowMs < startMs + (seconds * 1000.0))
+        {
+            unsigned int numDue = (unsigned int)(((nowMs - startMs) / 1000.0) * packetsPerSecond);
+            while (result.numSent < numDue)
+            {
+                size_t batchSize = Min<size_t>(numDue - result.numSent, UDPTransport::MAX_BATCH_SIZE);
+                for (size_t i = 0; i < batchSize; ++i)
+                {
+                    datagrams[i].address = receiverAddress;
+                    datagrams[i].buffer = &payloads[i * PAYLOAD_SIZE];
+                    datagrams[i].size = PAYLOAD_SIZE;
+                    memcpy(datagrams[i].buffer, &nowMs, sizeof(double));
+                }
+                sender.SendBatch(datagrams, batchSize);
+                result.numSent += (unsigned int)batchSize;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            nowMs = GetCurrentTimeMilliseconds();
+        }
+        isSending = false;
+    });
+
+    std::vector<unsigned char> buffers(UDPTransport::MAX_BATCH_SIZE * PACKET_MTU);
+    UDPDatagram datagrams[UDPTransport::MAX_BATCH_SIZE];
+    for (size_t i = 0; i < UDPTransport::MAX_BATCH_SIZE; ++i)
+    {
+        datagrams[i].buffer = &buffers[i * PACKET_MTU];
+    }
+    double drainEndMs = 0.0;
+    int frameIndex = 0;
+    while (isSending || GetCurrentTimeMilliseconds() < drainEndMs)
+    {
+        double frameStartMs = GetCurrentTimeMilliseconds();
+        if (!isSending && drainEndMs == 0.0)
+        {
+            drainEndMs = frameStartMs + DRAIN_MS;
+        }
+
+        size_t numReceived = 0;
+        do
+        {
+            numReceived = receiver.ReceiveBatch(datagrams, UDPTransport::MAX_BATCH_SIZE);
+            double nowMs = GetCurrentTimeMilliseconds();
+            for (size_t i = 0; i < numReceived; ++i)
+            {
+                double sentMs = 0.0;
+                memcpy(&sentMs, datagrams[i].buffer, sizeof(double));
+                double delayMs = nowMs - sentMs;
+                double measuredMs = datagrams[i].arrivalTimeMs - sentMs;
+                result.totalDelayMs += delayMs;
+                result.maxDelayMs = Max(result.maxDelayMs, delayMs);
+                result.totalMeasuredMs += measuredMs;
+                result.maxMeasuredMs = Max(result.maxMeasuredMs, measuredMs);
+            }
+            result.numReceived += (unsigned int)numReceived;
+        } while (numReceived == UDPTransport::MAX_BATCH_SIZE);
+
+        double frameMs = (++frameIndex % FRAMES_BETWEEN_STALLS == 0) ? stallMs : FRAME_MS;
+        double sleepMs = (frameStartMs + frameMs) - GetCurrentTimeMilliseconds();
+        if (sleepMs > 0.0)
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds((long long)(sleepMs * 1000.0)));
+        }
+    }
+    senderThread.join();
+    return true;
+}
+
+//-----------------------------------------------------------------------------------
+//Once reading inline on the game thread and once with the I/O thread. Only fails if the sockets can't be bound, the numbers are for reading.
+bool RunStallTest(double seconds, double stallMs, unsigned int packetsPerSecond, NetTestPrintCallback* print)
+{
+    print(Stringf("Frame stall test: %.1fs at %i packets/s, %.0fms stall every 30 frames", seconds, packetsPerSecond, stallMs), RGBA::CORNFLOWER_BLUE);
+    const char* modeNames[2] = { "inline   ", "io thread" };
+    for (int mode = 0; mode < 2; ++mode)
+    {
+        StallTestResult result;
+        if (!RunStallFrames(mode == 1, seconds, stallMs, packetsPerSecond, result))
+        {
+            print("netstalltest: Couldn't bind two loopback sockets.", RGBA::RED);
+            return false;
+        }
+        double numReceived = (double)Max<unsigned int>(result.numReceived, 1);
+        print(Stringf("  %s: lost %i/%i (%.2f%%)  seen after avg %.2fms max %.1fms  arrival stamp avg %.2fms max %.1fms",
+            modeNames[mode],
+            (int)(result.numSent - result.numReceived),
+            (int)result.numSent,
+            (100.0 * (result.numSent - result.numReceived)) / Max<double>(result.numSent, 1.0),
+            result.totalDelayMs / numReceived,
+            result.maxDelayMs,
+            result.totalMeasuredMs / numReceived,
+            result.maxMeasuredMs), RGBA::GREEN);
+    }
+    return true;
+}
@@ -0,0 +1,395 @@
+#include "Engine/Net/UDPIP/PacketCompressor.hpp"
+#include "Engine/Net/UDPIP/NetSession.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include <unordered_map>
+#include <string.h>
+
+static const size_t EXTENDED_LENGTH = 15; //A token nibble this big means more of the length follows
+static const size_t MAX_SHORT_OFFSET = 0x7F; //Offsets up to this take one byte
+static const size_t TRAINING_KGRAM_BYTES = 4;
+static const size_t TRAINING_SEGMENT_BYTES = 24;
+static const size_t MAX_TRAINING_PACKETS = 4096;
+
+//-----------------------------------------------------------------------------------
+static inline bool WriteExtendedLength(size_t length, byte* dest, size_t destCapacity, size_t& outSize)
+{
+    for (length -= EXTENDED_LENGTH; ; length -= 255)
+    {
+        if (outSize >= destCapacity)
+        {
+            return false;
+        }
+        dest[outSize++] = (byte)Min<size_t>(length, 255);
+        if (length < 255)
+        {
+            return true;
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------------
+static inline bool ReadExtendedLength(const byte*& source, const byte* sourceEnd, size_t& length)
+{
+    byte next = 255;
+    while (next == 255)
+    {
+        if (source == sourceEnd)
+        {
+            return false;
+        }
+        next = *source++;
+        length += next;
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------------
+//A match length of 0 writes literals only, which is how the last sequence ends
+static bool WriteSequence(const byte* literals, size_t numLiterals, size_t offset, size_t matchLength, byte* dest, size_t destCapacity, size_t& outSize)
+{
+    if (outSize >= destCapacity)
+    {
+        return false;
+    }
+    size_t matchNibble = (matchLength != 0) ? matchLength - PacketCompressor::MIN_MATCH_BYTES : 0;
+    dest[outSize++] = (byte)((Min<size_t>(numLiterals, EXTENDED_LENGTH) << 4) | Min<size_t>(matchNibble, EXTENDED_LENGTH));
+    if (numLiterals >= EXTENDED_LENGTH && !WriteExtendedLength(numLiterals, dest, destCapacity, outSize))
+    {
+        return false;
+    }
+    if (destCapacity - outSize < numLiterals)
+    {
+        return false;
+    }
+    memcpy(dest + outSize, literals, numLiterals);
+    outSize += numLiterals;
+    if (matchLength == 0)
+    {
+        return true;
+    }
+
+    if (destCapacity - outSize < 2)
+    {
+        return false;
+    }
+    if (offset <= MAX_SHORT_OFFSET)
+    {
+        dest[outSize++] = (byte)offset;
+    }
+    else
+    {
+        dest[outSize++] = (byte)(0x80 | (offset >> 8));
+        dest[outSize++] = (byte)(offset & 0xFF);
+    }
+    return matchNibble < EXTENDED_LENGTH || WriteExtendedLength(matchNibble, dest, destCapacity, outSize);
+}
+
+//CONSTRUCTORS/////////////////////////////////////////////////////////////////////
+//-----------------------------------------------------------------------------------
+PacketCompressor::PacketCompressor()
+    : m_id(0)
+    , m_dictionarySize(0)
+{
+    memset(m_dictionaryTable, 0, sizeof(m_dictionaryTable));
+}
+
+//FUNCTIONS/////////////////////////////////////////////////////////////////////
+//-----------------------------------------------------------------------------------
+//Only the last MAX_DICTIONARY_BYTES of an oversized dictionary are kept. Training puts the most useful strings at the end.
+void PacketCompressor::Enable(const byte* dictionary, size_t numBytes)
+{
+    if (numBytes > MAX_DICTIONARY_BYTES)
+    {
+        dictionary += numBytes - MAX_DICTIONARY_BYTES;
+        numBytes = MAX_DICTIONARY_BYTES;
+    }
+    m_dictionarySize = numBytes;
+    if (numBytes > 0)
+    {
+        memcpy(m_dictionary, dictionary, numBytes);
+    }
+
+    memset(m_dictionaryTable, 0, sizeof(m_dictionaryTable));
+    for (size_t position = 0; position + MIN_MATCH_BYTES <= m_dictionarySize; ++position)
+    {
+        m_dictionaryTable[Hash(m_dictionary + position)] = (uint16_t)(position + 1);
+    }
+
+    //FNV-1a, so both ends can tell whether they have the same dictionary without sending it
+    m_id = 2166136261u;
+    for (size_t i = 0; i < m_dictionarySize; ++i)
+    {
+        m_id = (m_id ^ m_dictionary[i]) * 16777619u;
+    }
+    m_id = (m_id != 0) ? m_id : 1;
+}
+
+//-----------------------------------------------------------------------------------
+void PacketCompressor::Disable()
+{
+    m_id = 0;
+    m_dictionarySize = 0;
+    memset(m_dictionaryTable, 0, sizeof(m_dictionaryTable));
+}
+
+//-----------------------------------------------------------------------------------
+//Greedy, taking the most recent earlier occurrence of each 3 byte string. The dictionary and the packet are laid out back to back
+//so matches into the dictionary are no different from matches into the packet.
+size_t PacketCompressor::Compress(const byte* source, size_t numBytes, byte* dest, size_t destCapacity) const
+{
+    if (!IsEnabled() || numBytes > MAX_SOURCE_BYTES)
+    {
+        return 0;
+    }
+    byte window[MAX_DICTIONARY_BYTES + MAX_SOURCE_BYTES];
+    uint16_t table[1 << HASH_BITS];
+    memcpy(window, m_dictionary, m_dictionarySize);
+    memcpy(window + m_dictionarySize, source, numBytes);
+    memcpy(table, m_dictionaryTable, sizeof(table));
+
+    const size_t end = m_dictionarySize + numBytes;
+    size_t position = m_dictionarySize;
+    size_t literalStart = position;
+    size_t outSize = 0;
+    while (position + MIN_MATCH_BYTES <= end)
+    {
+        uint32_t hash = Hash(window + position);
+        size_t candidate = table[hash];
+        table[hash] = (uint16_t)(position + 1);
+        if (candidate != 0)
+        {
+            size_t matchStart = candidate - 1;
+            size_t offset = position - matchStart;
+            size_t length = 0;
+            while (position + length < end && window[matchStart + length] == window[position + length])
+            {
+                ++length;
+            }
+            size_t minLength = (offset <= MAX_SHORT_OFFSET) ? MIN_MATCH_BYTES : MIN_MATCH_BYTES + 1; //A 3 byte match isn't worth a 2 byte offset
+            if (offset <= MAX_OFFSET && length >= minLength)
+            {
+                if (!WriteSequence(window + literalStart, position - literalStart, offset, length, dest, destCapacity, outSize))
+                {
+                    return 0;
+                }
+                for (size_t i = position + 1; i < position + length && i + MIN_MATCH_BYTES <= end; ++i)
+                {
+                    table[Hash(window + i)] = (uint16_t)(i + 1);
+                }
+                position += length;
+                literalStart = position;
+                continue;
+            }
+        }
+        ++position;
+    }
+    if (!WriteSequence(window + literalStart, end - literalStart, 0, 0, dest, destCapacity, outSize))
+    {
+        return 0;
+    }
+    return outSize;
+}
+
+//-----------------------------------------------------------------------------------
+//Everything read is bounds checked against both buffers, packets off the wire can't be trusted
+size_t PacketCompressor::Decompress(const byte* source, size_t numBytes, byte* dest, size_t destCapacity) const
+{
+    if (!IsEnabled())
+    {
+        return 0;
+    }
+    const byte* sourceEnd = source + numBytes;
+    size_t outSize = 0;
+    while (source < sourceEnd)
+    {
+        byte token = *source++;
+        size_t numLiterals = token >> 4;
+        if (numLiterals == EXTENDED_LENGTH && !ReadExtendedLength(source, sourceEnd, numLiterals))
+        {
+            return 0;
+        }
+        if ((size_t)(sourceEnd - source) < numLiterals || destCapacity - outSize < numLiterals)
+        {
+            return 0;
+        }
+        memcpy(dest + outSize, source, numLiterals);
+        source += numLiterals;
+        outSize += numLiterals;
+        if (source == sourceEnd)
+        {
+            break;
+        }
+
+        size_t offset = *source++;
+        if ((offset & 0x80) != 0)
+        {
+            if (source == sourceEnd)
+            {
+                return 0;
+            }
+            offset = ((offset & 0x7F) << 8) | *source++;
+        }
+        size_t matchLength = token & 0x0F;
+        if (matchLength == EXTENDED_LENGTH && !ReadExtendedLength(source, sourceEnd, matchLength))
+        {
+            return 0;
+        }
+        matchLength += MIN_MATCH_BYTES;
+        size_t available = m_dictionarySize + outSize;
+        if (offset == 0 || offset > available || destCapacity - outSize < matchLength)
+        {
+            return 0;
+        }
+        //Byte at a time, since a match can overlap what it's producing
+        size_t from = available - offset;
+        for (size_t i = 0; i < matchLength; ++i, ++from)
+        {
+            dest[outSize++] = (from < m_dictionarySize) ? m_dictionary[from] : dest[from - m_dictionarySize];
+        }
+    }
+    return outSize;
+}
+
+//STATIC FUNCTIONS/////////////////////////////////////////////////////////////////////
+//-----------------------------------------------------------------------------------
+void PacketCompressor::AppendRecordedPacket(std::vector<unsigned char>& recording, const byte* packet, size_t numBytes)
+{
+    recording.push_back((unsigned char)(numBytes >> 8));
+    recording.push_back((unsigned char)(numBytes & 0xFF));
+    recording.insert(recording.end(), packet, packet + numBytes);
+}
+
+//-----------------------------------------------------------------------------------
+bool PacketCompressor::ReadRecordedPacket(const std::vector<unsigned char>& recording, size_t& offset, const byte*& outPacket, size_t& outNumBytes)
+{
+    if (offset + sizeof(uint16_t) > recording.size())
+    {
+        return false;
+    }
+    outNumBytes = ((size_t)recording[offset] << 8) | (size_t)recording[offset + 1];
+    if (offset + sizeof(uint16_t) + outNumBytes > recording.size())
+    {
+        return false;
+    }
+    outPacket = recording.data() + offset + sizeof(uint16_t);
+    offset += sizeof(uint16_t) + outNumBytes;
+    return true;
+}
+
+//-----------------------------------------------------------------------------------
+//Picks the segments of recorded packets whose 4 byte strings show up in the most packets. After each pick its strings stop counting,
+//so the next one adds something new. Picks are laid out least useful first, which leaves the best ones closest to the packet and
+//within reach of one byte offsets.
+void PacketCompressor::TrainDictionary(const std::vector<unsigned char>& recording, size_t maxBytes, std::vector<unsigned char>& outDictionary)
+{
+    struct KgramCount
+    {
+        uint32_t numPackets;
+        uint32_t lastPacket;
+    };
+    struct Segment
+    {
+        const byte* start;
+        size_t numBytes;
+    };
+
+    std::vector<Segment> packets;
+    size_t offset = 0;
+    const byte* packet = nullptr;
+    size_t numBytes = 0;
+    while (ReadRecordedPacket(recording, offset, packet, numBytes))
+    {
+        if (numBytes > SKIPPED_PACKET_BYTES + TRAINING_KGRAM_BYTES)
+        {
+            packets.push_back({ packet + SKIPPED_PACKET_BYTES, numBytes - SKIPPED_PACKET_BYTES });
+        }
+    }
+    size_t stride = (packets.size() + MAX_TRAINING_PACKETS - 1) / MAX_TRAINING_PACKETS;
+    if (stride > 1)
+    {
+        size_t numKept = 0;
+        for (size_t i = 0; i < packets.size(); i += stride)
+        {
+            packets[numKept++] = packets[i];
+        }
+        packets.resize(numKept);
+    }
+
+    //Count each string once per packet it's in, then point every position at its string's count so picking doesn't hash again
+    std::unordered_map<uint32_t, KgramCount> counts;
+    std::vector<uint32_t*> kgramCounts;
+    std::vector<size_t> firstKgrams;
+    for (uint32_t packetIndex = 0; packetIndex < (uint32_t)packets.size(); ++packetIndex)
+    {
+        const Segment& body = packets[packetIndex];
+        firstKgrams.push_back(kgramCounts.size());
+        for (size_t i = 0; i + TRAINING_KGRAM_BYTES <= body.numBytes; ++i)
+        {
+            uint32_t kgram;
+            memcpy(&kgram, body.start + i, sizeof(kgram));
+            KgramCount& count = counts[kgram];
+            if (count.numPackets == 0 || count.lastPacket != packetIndex)
+            {
+                ++count.numPackets;
+                count.lastPacket = packetIndex;
+            }
+            kgramCounts.push_back(&count.numPackets);
+        }
+    }
+
+    maxBytes = Min<size_t>(maxBytes, (size_t)MAX_DICTIONARY_BYTES);
+    std::vector<Segment> picks;
+    size_t numPickedBytes = 0;
+    while (numPickedBytes + TRAINING_KGRAM_BYTES <= maxBytes)
+    {
+        //Best segment by the sum of its strings' counts. Strings seen in only one packet don't help, LZ already gets repeats within a packet.
+        size_t bestPacket = 0;
+        size_t bestStart = 0;
+        size_t bestBytes = 0;
+        uint64_t bestScore = 0;
+        size_t segmentBytes = Min<size_t>((size_t)TRAINING_SEGMENT_BYTES, maxBytes - numPickedBytes);
+        for (size_t packetIndex = 0; packetIndex < packets.size(); ++packetIndex)
+        {
+            uint32_t** positions = &kgramCounts[firstKgrams[packetIndex]];
+            size_t numKgrams = packets[packetIndex].numBytes - TRAINING_KGRAM_BYTES + 1;
+            size_t window = Min<size_t>(segmentBytes, packets[packetIndex].numBytes) - TRAINING_KGRAM_BYTES + 1;
+            uint64_t score = 0;
+            for (size_t i = 0; i < numKgrams; ++i)
+            {
+                uint32_t added = *positions[i];
+                score += (added > 1) ? added - 1 : 0;
+                if (i >= window)
+                {
+                    uint32_t removed = *positions[i - window];
+                    score -= (removed > 1) ? removed - 1 : 0;
+                }
+                if (i + 1 >= window && score > bestScore)
+                {
+                    bestScore = score;
+                    bestPacket = packetIndex;
+                    bestStart = i + 1 - window;
+                    bestBytes = window + TRAINING_KGRAM_BYTES - 1;
+                }
+            }
+        }
+        if (bestScore == 0)
+        {
+            break;
+        }
+        picks.push_back({ packets[bestPacket].start + bestStart, bestBytes });
+        numPickedBytes += bestBytes;
+        uint32_t** positions = &kgramCounts[firstKgrams[bestPacket]];
+        for (size_t i = 0; i + TRAINING_KGRAM_BYTES <= bestBytes; ++i)
+        {
+            *positions[bestStart + i] = 0;
+        }
+    }
+
+    outDictionary.clear();
+    outDictionary.reserve(numPickedBytes);
+    for (auto pick = picks.rbegin(); pick != picks.rend(); ++pick)
+    {
+        outDictionary.insert(outDictionary.end(), pick->start, pick->start + pick->numBytes);
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include "Engine/Net/UDPIP/UDPTransport.hpp"
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+typedef unsigned char byte;
+
+//-----------------------------------------------------------------------------------
+//Byte oriented LZ compression for packets, primed with a dictionary of byte strings that show up a lot in our traffic (message
+//headers, entity ids, common float bit patterns). Matches can reach back into the dictionary as if it came right before the packet,
+//so even the first message in a packet compresses. Both ends have to use the same dictionary, which is what the id is for.
+//
+//Each sequence is a token (high nibble literal count, low nibble match length past MIN_MATCH_BYTES, 15 meaning more follows in
+//bytes of up to 255), the literals, then the match offset in one byte under 128 or two with the top bit set. The last sequence is
+//literals only. Dictionaries are trained offline from packets recorded with nsrecord, see TrainDictionary.
+class PacketCompressor
+{
+public:
+    //CONSTRUCTORS/////////////////////////////////////////////////////////////////////
+    PacketCompressor();
+
+    //FUNCTIONS/////////////////////////////////////////////////////////////////////
+    void Enable(const byte* dictionary, size_t numBytes); //No dictionary is fine too, it just compresses worse
+    void Disable();
+    size_t Compress(const byte* source, size_t numBytes, byte* dest, size_t destCapacity) const; //0 if it wouldn't fit in destCapacity
+    size_t Decompress(const byte* source, size_t numBytes, byte* dest, size_t destCapacity) const; //0 if it's malformed or disabled
+
+    //GETTERS/////////////////////////////////////////////////////////////////////
+    inline uint32_t GetId() const { return m_id; }; //0 while disabled, otherwise a hash of the dictionary
+    inline bool IsEnabled() const { return m_id != 0; };
+    inline size_t GetDictionarySize() const { return m_dictionarySize; };
+
+    //STATIC FUNCTIONS/////////////////////////////////////////////////////////////////////
+    //Recordings are a run of [uint16 size][packet] in network byte order
+    static void AppendRecordedPacket(std::vector<unsigned char>& recording, const byte* packet, size_t numBytes);
+    static bool ReadRecordedPacket(const std::vector<unsigned char>& recording, size_t& offset, const byte*& outPacket, size_t& outNumBytes);
+    static void TrainDictionary(const std::vector<unsigned char>& recording, size_t maxBytes, std::vector<unsigned char>& outDictionary);
+    //Most the compressed size can grow by when numBytes are appended to the source. Everything before the last sequence compresses the same,
+    //so the new bytes cost at worst themselves as literals plus length bytes, and the old last sequence a few bytes more.
+    static inline size_t GetMaxAppendedGrowth(size_t numBytes) { return numBytes + numBytes / 64 + 16; };
+
+    //CONSTANTS/////////////////////////////////////////////////////////////////////
+    static const size_t MAX_DICTIONARY_BYTES = 2048;
+    static const size_t MAX_SOURCE_BYTES = 2 * PACKET_MTU; //Packets filled for compression hold more than the MTU until they're compressed
+    static const size_t MIN_MATCH_BYTES = 3;
+    static const size_t MAX_OFFSET = 0x7FFF;
+    static const unsigned int HASH_BITS = 11;
+    static const size_t SKIPPED_PACKET_BYTES = sizeof(uint16_t) + sizeof(uint8_t); //The sender index and message count stay readable, training and compression start after them
+
+private:
+    //PRIVATE FUNCTIONS/////////////////////////////////////////////////////////////////////
+    static inline uint32_t Hash(const byte* bytes) { return ((((uint32_t)bytes[0] << 16) | ((uint32_t)bytes[1] << 8) | (uint32_t)bytes[2]) * 2654435761u) >> (32 - HASH_BITS); };
+
+    //MEMBER VARIABLES/////////////////////////////////////////////////////////////////////
+    uint32_t m_id;
+    size_t m_dictionarySize;
+    byte m_dictionary[MAX_DICTIONARY_BYTES];
+    uint16_t m_dictionaryTable[1 << HASH_BITS]; //Latest dictionary position + 1 for each hash, so every packet starts with the dictionary already indexed
+};
@@ -0,0 +1,293 @@
+#include "Engine/Net/UDPIP/PacketCompressor.hpp"
+#include "Engine/Net/UDPIP/UDPTransport.hpp"
+#include "Engine/Net/UDPIP/NetTests.hpp"
+#include "Engine/Input/InputOutputUtils.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Engine/Time/Time.hpp"
+#include <string.h>
+#include <vector>
+
+//CONSTANTS/////////////////////////////////////////////////////////////////////
+static const unsigned int COMPRESS_CORPUS_TICKS = 1200; //20 seconds of snapshots at 60Hz
+static const uint32_t COMPRESS_CORPUS_SEED = 1;
+
+//TESTS/////////////////////////////////////////////////////////////////////
+//-----------------------------------------------------------------------------------
+static inline uint32_t NextCompressTestRandom(uint32_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+//-----------------------------------------------------------------------------------
+//Packet-like bytes: runs of small message headers, incrementing ids and slowly changing quantized values, with some noise
+static size_t MakeCompressTestPacket(uint32_t& random, byte* packet, size_t maxBytes)
+{
+    size_t numBytes = 0;
+    size_t targetBytes = 8 + (NextCompressTestRandom(random) % (maxBytes - 8));
+    uint16_t entityId = (uint16_t)(NextCompressTestRandom(random) % 64);
+    while (numBytes + 12 <= targetBytes)
+    {
+        uint32_t kind = NextCompressTestRandom(random) % 4;
+        packet[numBytes++] = 0;
+        packet[numBytes++] = 9;
+        packet[numBytes++] = (byte)(20 + kind);
+        packet[numBytes++] = (byte)(entityId >> 8);
+        packet[numBytes++] = (byte)entityId++;
+        float value = (float)(NextCompressTestRandom(random) % 16) * 0.25f;
+        memcpy(packet + numBytes, &value, sizeof(value));
+        numBytes += sizeof(value);
+        packet[numBytes++] = (kind == 3) ? (byte)NextCompressTestRandom(random) : 0;
+        packet[numBytes++] = 0xFF;
+        packet[numBytes++] = (byte)kind;
+    }
+    return numBytes;
+}
+
+//-----------------------------------------------------------------------------------
+//Round trips packet-like and random data with and without a dictionary, then feeds the decompressor truncated, corrupted and random input.
+//Bad input has to come back as a failure or as at most the destination's capacity, never a read or write out of bounds. Compressing
+//more than a prefix has to stay within GetMaxAppendedGrowth of the prefix, since packets filled for compression count on it.
+bool RunCompressorTest(int numRuns, uint32_t seed, NetTestPrintCallback* print)
+{
+    uint32_t random = seed | 1;
+
+    std::vector<unsigned char> recording;
+    byte packet[PacketCompressor::MAX_SOURCE_BYTES];
+    for (int i = 0; i < 512; ++i)
+    {
+        PacketCompressor::AppendRecordedPacket(recording, packet, MakeCompressTestPacket(random, packet, sizeof(packet)));
+    }
+    std::vector<unsigned char> dictionary;
+    PacketCompressor::TrainDictionary(recording, PacketCompressor::MAX_DICTIONARY_BYTES, dictionary);
+    PacketCompressor compressors[2];
+    compressors[0].Enable(nullptr, 0);
+    compressors[1].Enable(dictionary.data(), dictionary.size());
+
+    unsigned int numRoundTripFailures = 0;
+    unsigned int numBadInputOverruns = 0;
+    unsigned int numGrowthOverruns = 0;
+    size_t numBytesIn[2] = { 0, 0 };
+    size_t numBytesOut[2] = { 0, 0 };
+    byte compressed[PacketCompressor::MAX_SOURCE_BYTES * 2];
+    byte decompressed[PacketCompressor::MAX_SOURCE_BYTES];
+    for (int run = 0; run < numRuns; ++run)
+    {
+        size_t numBytes = 0;
+        if (run % 4 == 3)
+        {
+            numBytes = NextCompressTestRandom(random) % (sizeof(packet) + 1);
+            for (size_t i = 0; i < numBytes; ++i)
+            {
+                packet[i] = (byte)NextCompressTestRandom(random);
+            }
+        }
+        else
+        {
+            numBytes = MakeCompressTestPacket(random, packet, sizeof(packet));
+        }
+
+        for (int mode = 0; mode < 2; ++mode)
+        {
+            const PacketCompressor& compressor = compressors[mode];
+            size_t compressedSize = compressor.Compress(packet, numBytes, compressed, sizeof(compressed));
+            size_t decompressedSize = compressor.Decompress(compressed, compressedSize, decompressed, sizeof(decompressed));
+            if (numBytes > 0 && (decompressedSize != numBytes || memcmp(packet, decompressed, numBytes) != 0))
+            {
+                ++numRoundTripFailures;
+            }
+            numBytesIn[mode] += numBytes;
+            numBytesOut[mode] += compressedSize;
+            if (numBytes > 0)
+            {
+                size_t prefixSize = NextCompressTestRandom(random) % numBytes;
+                size_t compressedPrefixSize = compressor.Compress(packet, prefixSize, decompressed, sizeof(decompressed));
+                numGrowthOverruns += (compressedSize > compressedPrefixSize + PacketCompressor::GetMaxAppendedGrowth(numBytes - prefixSize)) ? 1 : 0;
+            }
+
+            //Truncate, flip a byte, or replace it all with noise
+            size_t badSize = compressedSize;
+            uint32_t damage = NextCompressTestRandom(random) % 3;
+            if (damage == 0 && badSize > 0)
+            {
+                badSize = NextCompressTestRandom(random) % badSize;
+            }
+            else if (damage == 1 && badSize > 0)
+            {
+                compressed[NextCompressTestRandom(random) % badSize] ^= (byte)(1 + (NextCompressTestRandom(random) % 255));
+            }
+            else
+            {
+                badSize = NextCompressTestRandom(random) % sizeof(compressed);
+                for (size_t i = 0; i < badSize; ++i)
+                {
+                    compressed[i] = (byte)NextCompressTestRandom(random);
+                }
+            }
+            size_t smallCapacity = NextCompressTestRandom(random) % (sizeof(decompressed) + 1);
+            numBadInputOverruns += (compressor.Decompress(compressed, badSize, decompressed, smallCapacity) > smallCapacity) ? 1 : 0;
+        }
+    }
+
+    bool passed = numRoundTripFailures == 0 && numBadInputOverruns == 0 && numGrowthOverruns == 0 && numBytesOut[1] < numBytesOut[0];
+    print(Stringf("  %s: %i packets, %u round trip failures, %u overruns on bad input, %u grew past the bound", passed ? "PASS" : "FAIL", numRuns, numRoundTripFailures, numBadInputOverruns, numGrowthOverruns), passed ? RGBA::GREEN : RGBA::RED);
+    print(Stringf("  no dictionary %.1f%%, %u byte dictionary %.1f%% of the original size", 100.0 * (double)numBytesOut[0] / (double)numBytesIn[0], (unsigned int)dictionary.size(), 100.0 * (double)numBytesOut[1] / (double)numBytesIn[1]), RGBA::CORNFLOWER_BLUE);
+    print(Stringf("compresstest: %s", passed ? "passed" : "failed"), passed ? RGBA::GREEN : RGBA::RED);
+    return passed;
+}
+
+//-----------------------------------------------------------------------------------
+//The first half of a recording's packets train, the second half are measured, so dictionaries are judged on traffic they haven't seen.
+//Halves rather than alternate packets, since recordings alternate between the two ends of a link.
+static unsigned int SplitCompressorRecording(const std::vector<unsigned char>& recording, std::vector<unsigned char>& outTrainingHalf, std::vector<unsigned char>& outTestHalf)
+{
+    size_t offset = 0;
+    const byte* packet = nullptr;
+    size_t numBytes = 0;
+    unsigned int numPackets = 0;
+    while (PacketCompressor::ReadRecordedPacket(recording, offset, packet, numBytes))
+    {
+        ++numPackets;
+    }
+    offset = 0;
+    for (unsigned int packetIndex = 0; PacketCompressor::ReadRecordedPacket(recording, offset, packet, numBytes); ++packetIndex)
+    {
+        PacketCompressor::AppendRecordedPacket((packetIndex < numPackets / 2) ? outTrainingHalf : outTestHalf, packet, numBytes);
+    }
+    return numPackets;
+}
+
+//-----------------------------------------------------------------------------------
+//Records a corpus of snapshot traffic and trains a full size dictionary on the first half of it, which is what compressbench measures against.
+//Run again whenever the snapshot format or the trainer changes, compressbench fails once the dictionary no longer matches a retrain.
+bool WriteCompressorCorpus(const char* recordingPath, const char* dictionaryPath, NetTestPrintCallback* print)
+{
+    std::vector<unsigned char> recording;
+    RecordSnapshotTraffic(COMPRESS_CORPUS_TICKS, COMPRESS_CORPUS_SEED, recording);
+    std::vector<unsigned char> trainingHalf;
+    std::vector<unsigned char> testHalf;
+    unsigned int numPackets = SplitCompressorRecording(recording, trainingHalf, testHalf);
+    std::vector<unsigned char> dictionary;
+    PacketCompressor::TrainDictionary(trainingHalf, PacketCompressor::MAX_DICTIONARY_BYTES, dictionary);
+    if (!SaveBufferToBinaryFile(recording, recordingPath) || !SaveBufferToBinaryFile(dictionary, dictionaryPath))
+    {
+        print(Stringf("Couldn't write %s and %s.", recordingPath, dictionaryPath), RGBA::RED);
+        return false;
+    }
+    print(Stringf("Wrote %u packets (%u bytes) to %s and a %u byte dictionary to %s", numPackets, (unsigned int)recording.size(), recordingPath, (unsigned int)dictionary.size(), dictionaryPath), RGBA::GREEN);
+    return true;
+}
+
+//-----------------------------------------------------------------------------------
+//Ratio against CPU cost over a recording made with nsrecord (or WriteCompressorCorpus), for no dictionary, the dictionary given, and
+//dictionaries of several sizes trained here. The given one should be the full size dictionary trained on the recording's first half.
+bool RunCompressorBenchmark(const char* recordingPath, const char* dictionaryPath, NetTestPrintCallback* print)
+{
+    std::vector<unsigned char> recording;
+    if (!LoadBufferFromBinaryFile(recording, recordingPath))
+    {
+        print(Stringf("Couldn't read %s.", recordingPath), RGBA::RED);
+        return false;
+    }
+    std::vector<unsigned char> savedDictionary;
+    if (dictionaryPath != nullptr && !LoadBufferFromBinaryFile(savedDictionary, dictionaryPath))
+    {
+        print(Stringf("Couldn't read %s.", dictionaryPath), RGBA::RED);
+        return false;
+    }
+
+    std::vector<unsigned char> trainingHalf;
+    std::vector<unsigned char> testHalf;
+    unsigned int numPackets = SplitCompressorRecording(recording, trainingHalf, testHalf);
+    if (testHalf.empty())
+    {
+        print("The recording has no packets in it.", RGBA::RED);
+        return false;
+    }
+    size_t offset = 0;
+    const byte* packet = nullptr;
+    size_t numBytes = 0;
+
+    const size_t dictionarySizes[] = { 0, 256, 512, 1024, PacketCompressor::MAX_DICTIONARY_BYTES };
+    const unsigned int numTrainedRows = sizeof(dictionarySizes) / sizeof(dictionarySizes[0]);
+    bool passed = true;
+    std::vector<unsigned char> retrainedDictionary;
+    print(Stringf("compressbench: %u packets recorded, %u bytes measured", numPackets, (unsigned int)testHalf.size()), RGBA::CORNFLOWER_BLUE);
+    for (unsigned int row = 0; row < numTrainedRows + (savedDictionary.empty() ? 0 : 1); ++row)
+    {
+        bool isSavedRow = row == numTrainedRows;
+        std::vector<unsigned char> dictionary;
+        double trainingSeconds = 0.0;
+        if (isSavedRow)
+        {
+            dictionary = savedDictionary;
+        }
+        else if (dictionarySizes[row] > 0)
+        {
+            double startSeconds = GetCurrentTimeSeconds();
+            PacketCompressor::TrainDictionary(trainingHalf, dictionarySizes[row], dictionary);
+            trainingSeconds = GetCurrentTimeSeconds() - startSeconds;
+            retrainedDictionary = dictionary;
+        }
+        PacketCompressor compressor;
+        compressor.Enable(dictionary.data(), dictionary.size());
+
+        size_t numBytesIn = 0;
+        size_t numBytesOut = 0;
+        unsigned int numIncompressible = 0;
+        unsigned int numMismatched = 0;
+        double compressSeconds = 0.0;
+        double decompressSeconds = 0.0;
+        byte compressed[PacketCompressor::MAX_SOURCE_BYTES];
+        byte decompressed[PacketCompressor::MAX_SOURCE_BYTES];
+        for (int pass = 0; pass < 4; ++pass)
+        {
+            offset = 0;
+            while (PacketCompressor::ReadRecordedPacket(testHalf, offset, packet, numBytes))
+            {
+                if (numBytes <= PacketCompressor::SKIPPED_PACKET_BYTES)
+                {
+                    continue;
+                }
+                const byte* body = packet + PacketCompressor::SKIPPED_PACKET_BYTES;
+                size_t bodySize = numBytes - PacketCompressor::SKIPPED_PACKET_BYTES;
+                double startSeconds = GetCurrentTimeSeconds();
+                size_t compressedSize = compressor.Compress(body, bodySize, compressed, bodySize - 1);
+                double midSeconds = GetCurrentTimeSeconds();
+                size_t decompressedSize = (compressedSize != 0) ? compressor.Decompress(compressed, compressedSize, decompressed, sizeof(decompressed)) : bodySize;
+                decompressSeconds += GetCurrentTimeSeconds() - midSeconds;
+                compressSeconds += midSeconds - startSeconds;
+                if (pass == 0)
+                {
+                    numBytesIn += numBytes;
+                    numBytesOut += PacketCompressor::SKIPPED_PACKET_BYTES + ((compressedSize != 0) ? compressedSize : bodySize);
+                    numIncompressible += (compressedSize == 0) ? 1 : 0;
+                    numMismatched += (compressedSize != 0 && (decompressedSize != bodySize || memcmp(body, decompressed, bodySize) != 0)) ? 1 : 0;
+                }
+            }
+        }
+        double megabytes = 4.0 * (double)numBytesIn / (1024.0 * 1024.0);
+        if (isSavedRow)
+        {
+            print(Stringf("  %4u byte %s: %5.1f%% of the original size, %u sent raw, %u mismatched, compress %.0f MB/s, decompress %.0f MB/s"
+                , (unsigned int)dictionary.size(), dictionaryPath, 100.0 * (double)numBytesOut / (double)numBytesIn, numIncompressible, numMismatched, megabytes / compressSeconds, megabytes / decompressSeconds), numMismatched == 0 ? RGBA::GREEN : RGBA::RED);
+        }
+        else
+        {
+            print(Stringf("  %4u byte dictionary: %5.1f%% of the original size, %u sent raw, %u mismatched, compress %.0f MB/s, decompress %.0f MB/s, trained in %.2fs"
+                , (unsigned int)dictionary.size(), 100.0 * (double)numBytesOut / (double)numBytesIn, numIncompressible, numMismatched, megabytes / compressSeconds, megabytes / decompressSeconds, trainingSeconds), numMismatched == 0 ? RGBA::GREEN : RGBA::RED);
+        }
+        passed = passed && numMismatched == 0;
+    }
+    if (!savedDictionary.empty())
+    {
+        //Otherwise the numbers above are for a dictionary the game wouldn't ship, rerun WriteCompressorCorpus
+        bool isCurrent = savedDictionary == retrainedDictionary;
+        passed = passed && isCurrent;
+        print(Stringf("  %s: %s matches a dictionary retrained on the first half", isCurrent ? "PASS" : "FAIL", dictionaryPath), isCurrent ? RGBA::GREEN : RGBA::RED);
+    }
+    return passed;
+}
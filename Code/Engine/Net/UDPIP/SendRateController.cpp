@@ -0,0 +1,157 @@
+#include "Engine/Net/UDPIP/SendRateController.hpp"
+#include "Engine/Net/UDPIP/UDPTransport.hpp"
+#include "Engine/Math/MathUtils.hpp"
+
+//-----------------------------------------------------------------------------------
+SendRateController::SendRateController()
+    : m_bytesPerSecond(INITIAL_BYTES_PER_SECOND)
+    , m_maxBytesPerSecond(DEFAULT_MAX_BYTES_PER_SECOND)
+    , m_budgetBytes(0.0f)
+    , m_lastRefillMs(-1.0)
+    , m_isInSlowStart(true)
+    , m_numBackoffs(0)
+    , m_epochStartMs(-1.0)
+    , m_epochBytesSent(0)
+    , m_epochPacketsAcked(0)
+    , m_epochPacketsLost(0)
+    , m_epochMinRoundTripMs(-1.0f)
+    , m_lastEpochLossRate(0.0f)
+    , m_nextRoundTripIndex(0)
+    , m_baseRoundTripMs(-1.0f)
+    , m_epochsUntilCongestionCheck(0)
+{
+    for (unsigned int i = 0; i < NUM_BASE_ROUND_TRIP_EPOCHS; ++i)
+    {
+        m_recentRoundTripsMs[i] = -1.0f;
+    }
+}
+
+//-----------------------------------------------------------------------------------
+//The bucket holds at most one full packet, since a connection never sends more than one packet a tick
+int SendRateController::GetSendBudgetBytes(double nowMs)
+{
+    if (m_lastRefillMs >= 0.0)
+    {
+        float elapsedSeconds = (float)(nowMs - m_lastRefillMs) * 0.001f;
+        m_budgetBytes = Min<float>(m_budgetBytes + (m_bytesPerSecond * elapsedSeconds), (float)(PACKET_MTU + UDP_IP_HEADER_BYTES));
+    }
+    else
+    {
+        m_budgetBytes = (float)(PACKET_MTU + UDP_IP_HEADER_BYTES);
+    }
+    m_lastRefillMs = nowMs;
+    return (int)m_budgetBytes;
+}
+
+//-----------------------------------------------------------------------------------
+void SendRateController::OnPacketSent(size_t numBytes)
+{
+    unsigned int wireBytes = (unsigned int)numBytes + UDP_IP_HEADER_BYTES;
+    m_budgetBytes -= (float)wireBytes;
+    m_epochBytesSent += wireBytes;
+}
+
+//-----------------------------------------------------------------------------------
+void SendRateController::OnPacketAcked(float roundTripMs)
+{
+    ++m_epochPacketsAcked;
+    m_epochMinRoundTripMs = (m_epochMinRoundTripMs < 0.0f) ? roundTripMs : Min<float>(m_epochMinRoundTripMs, roundTripMs);
+}
+
+//-----------------------------------------------------------------------------------
+void SendRateController::OnPacketLost()
+{
+    ++m_epochPacketsLost;
+}
+
+//-----------------------------------------------------------------------------------
+//Called once per tick before building the packet. Acts at most once per epoch, which is a round trip (or MIN_EPOCH_MS on fast links).
+void SendRateController::Update(double nowMs, float smoothedRoundTripMs)
+{
+    if (m_epochStartMs < 0.0)
+    {
+        m_epochStartMs = nowMs;
+        return;
+    }
+    if (nowMs - m_epochStartMs >= (double)Max<float>(smoothedRoundTripMs, MIN_EPOCH_MS))
+    {
+        EndEpoch(nowMs);
+    }
+}
+
+//-----------------------------------------------------------------------------------
+void SendRateController::SetMaxBytesPerSecond(float maxBytesPerSecond)
+{
+    m_maxBytesPerSecond = Max<float>(maxBytesPerSecond, MIN_BYTES_PER_SECOND);
+    m_bytesPerSecond = Min<float>(m_bytesPerSecond, m_maxBytesPerSecond);
+}
+
+//-----------------------------------------------------------------------------------
+void SendRateController::EndEpoch(double nowMs)
+{
+    unsigned int numPacketsResolved = m_epochPacketsAcked + m_epochPacketsLost;
+    m_lastEpochLossRate = (numPacketsResolved > 0) ? (float)m_epochPacketsLost / (float)numPacketsResolved : 0.0f;
+    float epochSeconds = Max<float>((float)(nowMs - m_epochStartMs) * 0.001f, 0.001f);
+    float sentBytesPerSecond = (float)m_epochBytesSent / epochSeconds;
+
+    if (m_epochsUntilCongestionCheck > 0)
+    {
+        //Still seeing the round trips and losses from before the last backoff took effect, so don't punish them twice
+        --m_epochsUntilCongestionCheck;
+    }
+    else if (IsCongested())
+    {
+        //Back off from what actually went out, the allowed rate can be well above that when there wasn't enough to send or the ticks capped it
+        //Slow start overshoots by up to double by the time the first signal comes back, so leaving it halves instead
+        m_bytesPerSecond = Min<float>(m_bytesPerSecond, sentBytesPerSecond) * (m_isInSlowStart ? 0.5f : BACKOFF_FACTOR);
+        m_isInSlowStart = false;
+        m_epochsUntilCongestionCheck = EPOCHS_TO_SETTLE_AFTER_BACKOFF;
+        ++m_numBackoffs;
+    }
+    else if (sentBytesPerSecond >= m_bytesPerSecond * 0.5f)
+    {
+        //Only grow when the connection actually used what it had, otherwise an idle link would claim a rate it never tested
+        m_bytesPerSecond = m_isInSlowStart ? m_bytesPerSecond * 2.0f : m_bytesPerSecond + ADDITIVE_INCREASE_BYTES_PER_SECOND;
+    }
+    m_bytesPerSecond = Clamp<float>(m_bytesPerSecond, MIN_BYTES_PER_SECOND, m_maxBytesPerSecond);
+    if (m_bytesPerSecond >= m_maxBytesPerSecond)
+    {
+        m_isInSlowStart = false;
+    }
+
+    if (m_epochMinRoundTripMs >= 0.0f)
+    {
+        m_recentRoundTripsMs[m_nextRoundTripIndex] = m_epochMinRoundTripMs;
+        m_nextRoundTripIndex = (m_nextRoundTripIndex + 1) % NUM_BASE_ROUND_TRIP_EPOCHS;
+        m_baseRoundTripMs = m_epochMinRoundTripMs;
+        for (float roundTripMs : m_recentRoundTripsMs)
+        {
+            if (roundTripMs >= 0.0f)
+            {
+                m_baseRoundTripMs = Min<float>(m_baseRoundTripMs, roundTripMs);
+            }
+        }
+    }
+
+    m_epochStartMs = nowMs;
+    m_epochBytesSent = 0;
+    m_epochPacketsAcked = 0;
+    m_epochPacketsLost = 0;
+    m_epochMinRoundTripMs = -1.0f;
+}
+
+//-----------------------------------------------------------------------------------
+bool SendRateController::IsCongested() const
+{
+    const unsigned int MIN_PACKETS_FOR_LOSS_RATE = 4;
+    if (m_epochPacketsAcked + m_epochPacketsLost >= MIN_PACKETS_FOR_LOSS_RATE && m_lastEpochLossRate > LOSS_THRESHOLD)
+    {
+        return true;
+    }
+    if (m_epochMinRoundTripMs >= 0.0f && m_baseRoundTripMs >= 0.0f)
+    {
+        float queueingDelayMs = m_epochMinRoundTripMs - m_baseRoundTripMs;
+        return queueingDelayMs > Max<float>(MIN_QUEUEING_DELAY_MS, m_baseRoundTripMs * 0.25f);
+    }
+    return false;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+//-----------------------------------------------------------------------------------
+//Decides how many bytes a connection may put on the wire each tick. A token bucket paces sends at the current rate, and the rate
+//is steered once per round trip: slow start doubles it until the first sign of congestion, after which it grows by a fixed step
+//per round trip and backs off multiplicatively on packet loss, or when even the fastest round trip of the epoch sits well above the
+//recent baseline (a queue building up somewhere along the way). Using the fastest sample keeps jitter from looking like congestion.
+//The rate never goes above the bandwidth budget the session hands it.
+class SendRateController
+{
+public:
+    //CONSTRUCTORS/////////////////////////////////////////////////////////////////////
+    SendRateController();
+
+    //FUNCTIONS/////////////////////////////////////////////////////////////////////
+    int GetSendBudgetBytes(double nowMs); //Refills the bucket, can be negative while paying off the last packet
+    void OnPacketSent(size_t numBytes);
+    void OnPacketAcked(float roundTripMs);
+    void OnPacketLost();
+    void Update(double nowMs, float smoothedRoundTripMs);
+    void SetMaxBytesPerSecond(float maxBytesPerSecond);
+
+    //GETTERS/////////////////////////////////////////////////////////////////////
+    inline float GetBytesPerSecond() const { return m_bytesPerSecond; };
+    inline float GetMaxBytesPerSecond() const { return m_maxBytesPerSecond; };
+    inline float GetLossRate() const { return m_lastEpochLossRate; }; //Fraction of packets lost over the last round trip
+    inline float GetBaseRoundTripMs() const { return m_baseRoundTripMs; };
+    inline bool IsInSlowStart() const { return m_isInSlowStart; };
+    inline unsigned int GetNumBackoffs() const { return m_numBackoffs; };
+
+    //CONSTANTS/////////////////////////////////////////////////////////////////////
+    static constexpr float MIN_BYTES_PER_SECOND = 2.0f * 1024.0f;
+    static constexpr float INITIAL_BYTES_PER_SECOND = 16.0f * 1024.0f;
+    static constexpr float DEFAULT_MAX_BYTES_PER_SECOND = 256.0f * 1024.0f;
+    static constexpr float ADDITIVE_INCREASE_BYTES_PER_SECOND = 2.0f * 1024.0f; //Per round trip without congestion, once out of slow start
+    static constexpr float BACKOFF_FACTOR = 0.7f;
+    static constexpr float LOSS_THRESHOLD = 0.1f; //Loss over a round trip that counts as congestion. Games see random loss, so not every drop should back off.
+    static constexpr float MIN_QUEUEING_DELAY_MS = 10.0f; //Round trips above the baseline by max(this, a quarter of the baseline) count as congestion
+    static constexpr float MIN_EPOCH_MS = 50.0f;
+    static const unsigned int UDP_IP_HEADER_BYTES = 28; //Charged against the budget for every packet on top of its payload
+    static const unsigned int NUM_BASE_ROUND_TRIP_EPOCHS = 32; //The baseline is the lowest round trip over this many epochs
+    static const unsigned int EPOCHS_TO_SETTLE_AFTER_BACKOFF = 1; //Acks in the epoch after a backoff are for packets sent before it
+
+private:
+    //PRIVATE FUNCTIONS/////////////////////////////////////////////////////////////////////
+    void EndEpoch(double nowMs);
+    bool IsCongested() const;
+
+    //MEMBER VARIABLES/////////////////////////////////////////////////////////////////////
+    float m_bytesPerSecond;
+    float m_maxBytesPerSecond;
+    float m_budgetBytes;
+    double m_lastRefillMs; //Negative until the first tick
+    bool m_isInSlowStart;
+    unsigned int m_numBackoffs;
+
+    //Current epoch, roughly one round trip long
+    double m_epochStartMs;
+    unsigned int m_epochBytesSent;
+    unsigned int m_epochPacketsAcked;
+    unsigned int m_epochPacketsLost;
+    float m_epochMinRoundTripMs; //Negative until a packet is acked this epoch
+    float m_lastEpochLossRate;
+
+    //Fastest round trip of each recent epoch, so queueing delay shows up as a rise above the lowest of them
+    float m_recentRoundTripsMs[NUM_BASE_ROUND_TRIP_EPOCHS];
+    unsigned int m_nextRoundTripIndex;
+    float m_baseRoundTripMs;
+    unsigned int m_epochsUntilCongestionCheck;
+};
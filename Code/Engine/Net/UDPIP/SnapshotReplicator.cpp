@@ -0,0 +1,431 @@
+#include "Engine/Net/UDPIP/SnapshotReplicator.hpp"
+#include "Engine/Net/UDPIP/NetSession.hpp"
+#include "Engine/Net/UDPIP/NetConnection.hpp"
+#include "Engine/Net/UDPIP/NetMessage.hpp"
+#include "Engine/Net/UDPIP/NetPacket.hpp"
+#include "Engine/Net/UDPIP/InterestManager.hpp"
+#include "Engine/DataStructures/BitPacker.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include <algorithm>
+
+static const unsigned int SNAPSHOT_ID_BITS = 16;
+static const unsigned int MAX_VAR_BITS = 34; //Largest a varint gets, the 2 bit size class and 32 bits of value
+
+//-----------------------------------------------------------------------------------
+static inline bool IsSnapshotNewer(uint16_t snapshotId, uint16_t thanId)
+{
+    uint16_t distanceAhead = snapshotId - thanId;
+    return distanceAhead != 0 && distanceAhead < 0x8000;
+}
+
+//-----------------------------------------------------------------------------------
+static inline bool CompareSnapshotEntityIds(const SnapshotEntity& first, const SnapshotEntity& second)
+{
+    return first.id < second.id;
+}
+
+//-----------------------------------------------------------------------------------
+Snapshot::Snapshot()
+    : id(NetConnection::INVALID_SNAPSHOT_ID)
+{
+}
+
+//-----------------------------------------------------------------------------------
+SnapshotReplicator::SnapshotReplicator(NetSession* session)
+    : m_session(session)
+    , m_interest(nullptr)
+    , m_isDeltaEnabled(true)
+    , m_numSnapshotsSent(0)
+    , m_numDeltaSnapshotsSent(0)
+    , m_numSnapshotsTooLarge(0)
+    , m_numSnapshotBytesSent(0)
+    , m_numSnapshotsReceived(0)
+    , m_numUndecodableSnapshots(0)
+    , m_numFields(0)
+    , m_currentSnapshotId(NetConnection::INVALID_SNAPSHOT_ID)
+    , m_latestReceivedId(NetConnection::INVALID_SNAPSHOT_ID)
+{
+}
+
+//-----------------------------------------------------------------------------------
+void SnapshotReplicator::SetSchema(const unsigned int* fieldBits, unsigned int numFields)
+{
+    ASSERT_OR_DIE(numFields <= SnapshotEntity::MAX_FIELDS, "Too many fields for a snapshot entity");
+    for (unsigned int i = 0; i < numFields; ++i)
+    {
+        ASSERT_OR_DIE(fieldBits[i] > 0 && fieldBits[i] <= 32, "Snapshot fields have to be between 1 and 32 bits");
+        m_fieldBits[i] = fieldBits[i];
+    }
+    m_numFields = numFields;
+}
+
+//-----------------------------------------------------------------------------------
+//Reuses the history slot the new id lands on, so after the first few laps building a snapshot doesn't allocate
+void SnapshotReplicator::BeginSnapshot()
+{
+    m_currentSnapshotId = (m_currentSnapshotId + 1 == NetConnection::INVALID_SNAPSHOT_ID) ? 0 : m_currentSnapshotId + 1;
+    Snapshot& snapshot = m_sentHistory[m_currentSnapshotId % HISTORY_SIZE];
+    snapshot.id = m_currentSnapshotId;
+    snapshot.entities.clear();
+}
+
+//-----------------------------------------------------------------------------------
+void SnapshotReplicator::AddEntity(const SnapshotEntity& entity)
+{
+    ASSERT_OR_DIE(m_currentSnapshotId != NetConnection::INVALID_SNAPSHOT_ID, "Call BeginSnapshot before adding entities");
+    std::vector<SnapshotEntity>& entities = m_sentHistory[m_currentSnapshotId % HISTORY_SIZE].entities;
+    ASSERT_OR_DIE(entities.empty() || entities.back().id < entity.id, "Snapshot entities have to be added in increasing id order");
+    entities.push_back(entity);
+    //Keep only what goes over the wire, so the copy deltas are taken against is the one the other end ends up with
+    SnapshotEntity& added = entities.back();
+    for (unsigned int i = 0; i < m_numFields; ++i)
+    {
+        if (m_fieldBits[i] < 32)
+        {
+            added.fields[i] &= (1u << m_fieldBits[i]) - 1;
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------------
+void SnapshotReplicator::SendSnapshot()
+{
+    NetConnection* myConnection = m_session->GetMyConnection();
+    for (unsigned int i = 0; i < m_session->GetNumActiveConnections(); ++i)
+    {
+        NetConnection* connection = m_session->GetActiveConnection(i);
+        if (connection != myConnection && connection->IsConnected())
+        {
+            SendSnapshotTo(connection);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------------
+void SnapshotReplicator::SendSnapshotTo(NetConnection* connection)
+{
+    ASSERT_OR_DIE(m_currentSnapshotId != NetConnection::INVALID_SNAPSHOT_ID, "Call BeginSnapshot before sending one");
+    const Snapshot* snapshot = &m_sentHistory[m_currentSnapshotId % HISTORY_SIZE];
+    const Snapshot* baseline = nullptr;
+    Snapshot* history = GetConnectionHistory(connection->m_index);
+    if (history == nullptr)
+    {
+        baseline = FindBaseline(m_sentHistory, connection->m_ackedSnapshotId);
+    }
+    else
+    {
+        baseline = FindBaseline(history, connection->m_ackedSnapshotId);
+        Snapshot& filtered = history[m_currentSnapshotId % HISTORY_SIZE];
+        FilterSnapshot(*snapshot, baseline, connection->m_index, filtered);
+        snapshot = &filtered;
+    }
+    NetMessage msg(NetMessage::SNAPSHOT);
+    if (!WriteSnapshot(msg, *snapshot, baseline))
+    {
+        ++m_numSnapshotsTooLarge;
+        return;
+    }
+    connection->SendSnapshot(msg, snapshot->id);
+    ++m_numSnapshotsSent;
+    m_numDeltaSnapshotsSent += (baseline != nullptr) ? 1 : 0;
+    m_numSnapshotBytesSent += msg.GetPayloadSize();
+}
+
+//-----------------------------------------------------------------------------------
+//[16 snapshot id][16 baseline id]
+//Then for each baseline entity in id order: a changed bit, and if it's set a removed bit, and if that isn't, a changed bit per field followed by its delta if set.
+//Then a count of entities the baseline doesn't have, each as the gap from the previous id and its fields at full width.
+bool SnapshotReplicator::WriteSnapshot(NetMessage& msg, const Snapshot& snapshot, const Snapshot* baseline)
+{
+    BitPacker packer(msg.GetHead(), msg.GetWritableBytes(), 0);
+    packer.WriteBits(snapshot.id, SNAPSHOT_ID_BITS);
+    packer.WriteBits((baseline != nullptr) ? baseline->id : NetConnection::INVALID_SNAPSHOT_ID, SNAPSHOT_ID_BITS);
+
+    const size_t numEntities = snapshot.entities.size();
+    const size_t maxEntityBits = GetMaxEntityBits();
+    size_t entityIndex = 0;
+    m_newEntityIndices.clear();
+    if (baseline != nullptr)
+    {
+        for (const SnapshotEntity& previous : baseline->entities)
+        {
+            while (entityIndex < numEntities && snapshot.entities[entityIndex].id < previous.id)
+            {
+                m_newEntityIndices.push_back((unsigned int)entityIndex++);
+            }
+            if (packer.GetWritableBits() < maxEntityBits + MAX_VAR_BITS)
+            {
+                return false;
+            }
+            bool isRemoved = (entityIndex == numEntities) || (snapshot.entities[entityIndex].id != previous.id);
+            const SnapshotEntity* current = isRemoved ? nullptr : &snapshot.entities[entityIndex];
+            bool isChanged = isRemoved || memcmp(current->fields, previous.fields, m_numFields * sizeof(uint32_t)) != 0;
+            packer.WriteBool(isChanged);
+            if (isChanged)
+            {
+                packer.WriteBool(isRemoved);
+                for (unsigned int i = 0; !isRemoved && i < m_numFields; ++i)
+                {
+                    bool isFieldChanged = current->fields[i] != previous.fields[i];
+                    packer.WriteBool(isFieldChanged);
+                    if (isFieldChanged)
+                    {
+                        packer.WriteVarInt((int32_t)(current->fields[i] - previous.fields[i]));
+                    }
+                }
+            }
+            entityIndex += isRemoved ? 0 : 1;
+        }
+    }
+    while (entityIndex < numEntities)
+    {
+        m_newEntityIndices.push_back((unsigned int)entityIndex++);
+    }
+
+    packer.WriteVarUInt((uint32_t)m_newEntityIndices.size());
+    uint16_t previousId = 0;
+    for (unsigned int newIndex : m_newEntityIndices)
+    {
+        if (packer.GetWritableBits() < maxEntityBits)
+        {
+            return false;
+        }
+        const SnapshotEntity& entity = snapshot.entities[newIndex];
+        packer.WriteVarUInt(entity.id - previousId);
+        WriteEntityFields(packer, entity);
+        previousId = entity.id;
+    }
+    msg.Advance(packer.GetNumBytesUsed());
+    return true;
+}
+
+//-----------------------------------------------------------------------------------
+bool SnapshotReplicator::ReceiveSnapshot(NetMessage& msg)
+{
+    BitPacker packer(msg.m_msgBuffer, 0, msg.GetPayloadSize());
+    uint16_t snapshotId = (uint16_t)packer.ReadBits(SNAPSHOT_ID_BITS);
+    uint16_t baselineId = (uint16_t)packer.ReadBits(SNAPSHOT_ID_BITS);
+    const Snapshot* baseline = nullptr;
+    if (baselineId != NetConnection::INVALID_SNAPSHOT_ID)
+    {
+        baseline = GetReceivedSnapshot(baselineId);
+    }
+    bool isDecodable = (snapshotId != NetConnection::INVALID_SNAPSHOT_ID) && (baselineId == NetConnection::INVALID_SNAPSHOT_ID || baseline != nullptr);
+    if (!isDecodable || !ReadSnapshot(packer, m_decoding, baseline))
+    {
+        ++m_numUndecodableSnapshots;
+        return false;
+    }
+
+    m_decoding.id = snapshotId;
+    std::swap(m_receivedHistory[snapshotId % HISTORY_SIZE], m_decoding);
+    ++m_numSnapshotsReceived;
+    if (m_latestReceivedId == NetConnection::INVALID_SNAPSHOT_ID || IsSnapshotNewer(snapshotId, m_latestReceivedId))
+    {
+        m_latestReceivedId = snapshotId;
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------------
+const Snapshot* SnapshotReplicator::GetSentSnapshot(uint16_t snapshotId) const
+{
+    const Snapshot& snapshot = m_sentHistory[snapshotId % HISTORY_SIZE];
+    return (snapshotId != NetConnection::INVALID_SNAPSHOT_ID && snapshot.id == snapshotId) ? &snapshot : nullptr;
+}
+
+//-----------------------------------------------------------------------------------
+const Snapshot* SnapshotReplicator::GetSentSnapshot(uint16_t snapshotId, uint16_t connectionIndex) const
+{
+    if (connectionIndex >= m_connectionHistories.size() || m_connectionHistories[connectionIndex].empty())
+    {
+        return GetSentSnapshot(snapshotId);
+    }
+    const Snapshot& snapshot = m_connectionHistories[connectionIndex][snapshotId % HISTORY_SIZE];
+    return (snapshotId != NetConnection::INVALID_SNAPSHOT_ID && snapshot.id == snapshotId) ? &snapshot : nullptr;
+}
+
+//-----------------------------------------------------------------------------------
+const Snapshot* SnapshotReplicator::GetReceivedSnapshot(uint16_t snapshotId) const
+{
+    const Snapshot& snapshot = m_receivedHistory[snapshotId % HISTORY_SIZE];
+    return (snapshotId != NetConnection::INVALID_SNAPSHOT_ID && snapshot.id == snapshotId) ? &snapshot : nullptr;
+}
+
+//-----------------------------------------------------------------------------------
+const Snapshot* SnapshotReplicator::GetLatestReceivedSnapshot() const
+{
+    return GetReceivedSnapshot(m_latestReceivedId);
+}
+
+//-----------------------------------------------------------------------------------
+//The other end is guaranteed to have decoded anything it acked: the baseline of every delta we send is itself something it acked, back to a full snapshot
+const Snapshot* SnapshotReplicator::FindBaseline(const Snapshot* history, uint16_t ackedSnapshotId) const
+{
+    if (!m_isDeltaEnabled || ackedSnapshotId == m_currentSnapshotId || ackedSnapshotId == NetConnection::INVALID_SNAPSHOT_ID)
+    {
+        return nullptr;
+    }
+    const Snapshot& baseline = history[ackedSnapshotId % HISTORY_SIZE];
+    return (baseline.id == ackedSnapshotId) ? &baseline : nullptr;
+}
+
+//-----------------------------------------------------------------------------------
+//Stays once it's made, even after the area is cleared, since the connection's acked snapshot could be one that was filtered. A connection
+//that's new to filtering has nothing in its history yet, so its first filtered snapshot goes out as full state.
+Snapshot* SnapshotReplicator::GetConnectionHistory(uint16_t connectionIndex)
+{
+    if (connectionIndex >= NetSession::MAX_CONNECTIONS)
+    {
+        return nullptr;
+    }
+    bool isFiltered = m_interest != nullptr && m_interest->HasInterest(connectionIndex);
+    if (connectionIndex >= m_connectionHistories.size())
+    {
+        if (!isFiltered)
+        {
+            return nullptr;
+        }
+        m_connectionHistories.resize(connectionIndex + 1);
+    }
+    std::vector<Snapshot>& history = m_connectionHistories[connectionIndex];
+    if (history.empty())
+    {
+        if (!isFiltered)
+        {
+            return nullptr;
+        }
+        history.resize(HISTORY_SIZE);
+    }
+    return history.data();
+}
+
+//-----------------------------------------------------------------------------------
+//Entities the interest manager doesn't track are always sent as they are, so games can keep some out of it
+void SnapshotReplicator::FilterSnapshot(const Snapshot& snapshot, const Snapshot* baseline, uint16_t connectionIndex, Snapshot& outFiltered) const
+{
+    outFiltered.id = snapshot.id;
+    if (m_interest == nullptr || !m_interest->HasInterest(connectionIndex))
+    {
+        outFiltered.entities = snapshot.entities;
+        return;
+    }
+    outFiltered.entities.clear();
+    size_t baselineIndex = 0;
+    for (const SnapshotEntity& entity : snapshot.entities)
+    {
+        if (!m_interest->IsRelevant(connectionIndex, entity.id))
+        {
+            continue;
+        }
+        while (baseline != nullptr && baselineIndex < baseline->entities.size() && baseline->entities[baselineIndex].id < entity.id)
+        {
+            ++baselineIndex;
+        }
+        bool isInBaseline = baseline != nullptr && baselineIndex < baseline->entities.size() && baseline->entities[baselineIndex].id == entity.id;
+        bool isDue = !isInBaseline || !m_interest->HasEntity(entity.id) || m_interest->IsSelected(connectionIndex, entity.id);
+        outFiltered.entities.push_back(isDue ? entity : baseline->entities[baselineIndex]);
+    }
+}
+
+//-----------------------------------------------------------------------------------
+//Mirrors WriteSnapshot
+bool SnapshotReplicator::ReadSnapshot(BitPacker& packer, Snapshot& outSnapshot, const Snapshot* baseline)
+{
+    outSnapshot.entities.clear();
+    if (baseline != nullptr)
+    {
+        for (const SnapshotEntity& previous : baseline->entities)
+        {
+            if (!packer.ReadBool())
+            {
+                outSnapshot.entities.push_back(previous);
+                continue;
+            }
+            if (packer.ReadBool())
+            {
+                continue; //Removed
+            }
+            outSnapshot.entities.push_back(previous);
+            SnapshotEntity& entity = outSnapshot.entities.back();
+            for (unsigned int i = 0; i < m_numFields; ++i)
+            {
+                if (packer.ReadBool())
+                {
+                    entity.fields[i] = previous.fields[i] + (uint32_t)packer.ReadVarInt();
+                }
+            }
+        }
+    }
+
+    size_t numKept = outSnapshot.entities.size();
+    uint32_t numNew = packer.ReadVarUInt();
+    if (packer.HasOverflowed() || numNew > packer.GetReadableBits())
+    {
+        return false;
+    }
+    uint32_t previousId = 0;
+    for (uint32_t i = 0; i < numNew; ++i)
+    {
+        uint32_t id = previousId + packer.ReadVarUInt();
+        if (id > 0xFFFF || (i > 0 && id == previousId))
+        {
+            return false;
+        }
+        outSnapshot.entities.emplace_back();
+        SnapshotEntity& entity = outSnapshot.entities.back();
+        entity.id = (uint16_t)id;
+        ReadEntityFields(packer, entity);
+        previousId = id;
+    }
+    if (packer.HasOverflowed())
+    {
+        return false;
+    }
+
+    //Both runs are sorted, new entities just have to be slotted in among the ones carried over
+    std::inplace_merge(outSnapshot.entities.begin(), outSnapshot.entities.begin() + numKept, outSnapshot.entities.end(), &CompareSnapshotEntityIds);
+    for (size_t i = 1; i < outSnapshot.entities.size(); ++i)
+    {
+        if (outSnapshot.entities[i - 1].id == outSnapshot.entities[i].id)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------------
+void SnapshotReplicator::WriteEntityFields(BitPacker& packer, const SnapshotEntity& entity)
+{
+    for (unsigned int i = 0; i < m_numFields; ++i)
+    {
+        packer.WriteBits(entity.fields[i], m_fieldBits[i]);
+    }
+}
+
+//-----------------------------------------------------------------------------------
+void SnapshotReplicator::ReadEntityFields(BitPacker& packer, SnapshotEntity& outEntity)
+{
+    for (unsigned int i = 0; i < m_numFields; ++i)
+    {
+        outEntity.fields[i] = packer.ReadBits(m_fieldBits[i]);
+    }
+}
+
+//-----------------------------------------------------------------------------------
+//Worst case for one entity in either section: an id gap or the changed and removed bits, then every field as a changed bit and a full size delta
+size_t SnapshotReplicator::GetMaxEntityBits() const
+{
+    return MAX_VAR_BITS + (m_numFields * (1 + MAX_VAR_BITS));
+}
+
+//-----------------------------------------------------------------------------------
+//Only the host replicates state, anything else claiming to is ignored
+void OnSnapshotReceived(const NetSender& from, NetMessage& msg)
+{
+    if (from.connection != nullptr && from.connection->IsHostConnection())
+    {
+        from.session->m_snapshots.ReceiveSnapshot(msg);
+    }
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+class NetSession;
+class NetConnection;
+class NetMessage;
+class InterestManager;
+class BitPacker;
+struct NetSender;
+
+//-----------------------------------------------------------------------------------
+//One entity's replicated state. Fields are already quantized by the game, each to the number of bits the replicator's schema gives it.
+struct SnapshotEntity
+{
+    static const unsigned int MAX_FIELDS = 16;
+
+    uint16_t id;
+    uint32_t fields[MAX_FIELDS];
+};
+
+//-----------------------------------------------------------------------------------
+struct Snapshot
+{
+    Snapshot();
+
+    uint16_t id;
+    std::vector<SnapshotEntity> entities; //Sorted by id
+};
+
+//-----------------------------------------------------------------------------------
+//Replicates world state from the host to every connection as a snapshot a tick. Each connection's snapshot is encoded against the
+//latest one it's known to have, which is the newest snapshot whose packet ack came back (tracked through the connection's ack bundles).
+//Against that baseline an unchanged entity costs one bit and an unchanged field of a changed entity one bit, so bandwidth follows how
+//much changed rather than how many entities there are. With no usable baseline (nothing acked yet, or it's older than the history)
+//the snapshot goes out as full state.
+//
+//Snapshots are unreliable, and a newer one replaces one still waiting to be sent. Losing one costs nothing but a slightly older baseline.
+//
+//With an interest manager, a connection that has an area only hears about the entities inside it, and of those only the ones picked
+//this update get their current state. The rest repeat the state the connection already has, which costs a bit each. Those snapshots
+//differ per connection, so a connection that's ever been filtered gets its own history to take baselines from.
+class SnapshotReplicator
+{
+public:
+    //CONSTRUCTORS/////////////////////////////////////////////////////////////////////
+    SnapshotReplicator(NetSession* session);
+
+    //FUNCTIONS/////////////////////////////////////////////////////////////////////
+    void SetSchema(const unsigned int* fieldBits, unsigned int numFields); //Has to match on both ends
+    inline void SetInterestManager(const InterestManager* interest) { m_interest = interest; }; //Null sends every connection everything
+    void BeginSnapshot();
+    void AddEntity(const SnapshotEntity& entity); //In increasing id order
+    void SendSnapshot(); //To every active connection but our own
+    void SendSnapshotTo(NetConnection* connection);
+    bool WriteSnapshot(NetMessage& msg, const Snapshot& snapshot, const Snapshot* baseline); //False if it doesn't fit in a message
+    bool ReceiveSnapshot(NetMessage& msg); //False if it was malformed or its baseline is gone
+
+    //GETTERS/////////////////////////////////////////////////////////////////////
+    const Snapshot* GetSentSnapshot(uint16_t snapshotId) const; //Null once it's fallen out of the history
+    const Snapshot* GetSentSnapshot(uint16_t snapshotId, uint16_t connectionIndex) const; //What that connection was sent, filtered if it has been
+    const Snapshot* GetReceivedSnapshot(uint16_t snapshotId) const;
+    const Snapshot* GetLatestReceivedSnapshot() const;
+    inline unsigned int GetNumFields() const { return m_numFields; };
+
+    //CONSTANTS/////////////////////////////////////////////////////////////////////
+    static const unsigned int HISTORY_SIZE = 32; //Snapshots kept on each end, so baselines can be this many ticks old before falling back to full state
+
+    //MEMBER VARIABLES/////////////////////////////////////////////////////////////////////
+    bool m_isDeltaEnabled; //If false every snapshot is full state, for comparing bandwidth
+    unsigned int m_numSnapshotsSent;
+    unsigned int m_numDeltaSnapshotsSent;
+    unsigned int m_numSnapshotsTooLarge;
+    size_t m_numSnapshotBytesSent;
+    unsigned int m_numSnapshotsReceived;
+    unsigned int m_numUndecodableSnapshots;
+
+private:
+    //PRIVATE FUNCTIONS/////////////////////////////////////////////////////////////////////
+    const Snapshot* FindBaseline(const Snapshot* history, uint16_t ackedSnapshotId) const;
+    Snapshot* GetConnectionHistory(uint16_t connectionIndex); //Null unless the connection has been filtered
+    void FilterSnapshot(const Snapshot& snapshot, const Snapshot* baseline, uint16_t connectionIndex, Snapshot& outFiltered) const;
+    bool ReadSnapshot(BitPacker& packer, Snapshot& outSnapshot, const Snapshot* baseline);
+    void WriteEntityFields(BitPacker& packer, const SnapshotEntity& entity);
+    void ReadEntityFields(BitPacker& packer, SnapshotEntity& outEntity);
+    size_t GetMaxEntityBits() const;
+
+    //MEMBER VARIABLES/////////////////////////////////////////////////////////////////////
+    NetSession* m_session;
+    const InterestManager* m_interest;
+    unsigned int m_fieldBits[SnapshotEntity::MAX_FIELDS];
+    unsigned int m_numFields;
+    uint16_t m_currentSnapshotId; //The one being built or last sent
+    uint16_t m_latestReceivedId;
+    Snapshot m_sentHistory[HISTORY_SIZE]; //By snapshot id modulo the history size
+    Snapshot m_receivedHistory[HISTORY_SIZE];
+    std::vector<std::vector<Snapshot>> m_connectionHistories; //By connection index, HISTORY_SIZE long once a connection has been filtered
+    Snapshot m_decoding; //Swapped into the received history once a snapshot decodes cleanly
+    std::vector<unsigned int> m_newEntityIndices; //Scratch for WriteSnapshot
+};
+
+void OnSnapshotReceived(const NetSender& from, NetMessage& msg);
@@ -0,0 +1,338 @@
+#include "Engine/Net/UDPIP/SnapshotReplicator.hpp"
+#include "Engine/Net/UDPIP/NetSession.hpp"
+#include "Engine/Net/UDPIP/NetConnection.hpp"
+#include "Engine/Net/UDPIP/NetMessage.hpp"
+#include "Engine/Net/UDPIP/NetPacket.hpp"
+#include "Engine/Net/UDPIP/InterestManager.hpp"
+#include "Engine/Net/UDPIP/NetSimulator.hpp"
+#include "Engine/Net/UDPIP/NetTests.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Engine/Time/Time.hpp"
+#include <cstring>
+#include <vector>
+
+//TESTS/////////////////////////////////////////////////////////////////////
+//A host and a client replicator talking through a pair of connections over a lossy NetSimulator link, stepped a millisecond at a time on the
+//manual clock of a session the run builds for itself. The world is a mix of moving and idle entities, with the odd one despawning and spawning.
+
+//-----------------------------------------------------------------------------------
+struct SnapshotTestResults
+{
+    unsigned int numTicks;
+    unsigned int numSent;
+    unsigned int numDeltas;
+    unsigned int numDecoded;
+    unsigned int numUndecodable;
+    unsigned int numMismatched; //Decoded snapshots that differ from what the host sent under that id
+    size_t numSnapshotBytes;
+    size_t numWireBytes; //Every packet to the client, with UDP/IP headers, whether the link dropped it or not
+    double seconds;
+};
+
+//-----------------------------------------------------------------------------------
+static const unsigned int SNAPSHOT_TEST_TICK_MS = 16;
+static const unsigned int SNAPSHOT_TEST_NUM_ENTITIES = 64;
+static const unsigned int SNAPSHOT_TEST_LATENCY_MS = 40;
+static const unsigned int SNAPSHOT_TEST_JITTER_MS = 20;
+static const float SNAPSHOT_TEST_LOSS_RATE = 0.05f;
+static const unsigned int SNAPSHOT_TEST_FIELD_BITS[] = { 18, 18, 18, 9, 10, 4 }; //x, y, z, yaw, health, flags
+static const unsigned int SNAPSHOT_TEST_NUM_FIELDS = sizeof(SNAPSHOT_TEST_FIELD_BITS) / sizeof(SNAPSHOT_TEST_FIELD_BITS[0]);
+
+static const uint16_t SNAPSHOT_TEST_CLIENT_INDEX = 1;
+static const float SNAPSHOT_TEST_INTEREST_RADIUS = 384.0f; //Around the middle of the test world, which holds about half the entities
+static const unsigned int SNAPSHOT_TEST_PICKS_PER_TICK = 8;
+
+static SnapshotReplicator* s_snapshotTestHost = nullptr;
+static SnapshotReplicator* s_snapshotTestClient = nullptr;
+static SnapshotTestResults* s_snapshotTestResults = nullptr;
+
+//-----------------------------------------------------------------------------------
+static inline uint32_t NextSnapshotTestRandom(uint32_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+//-----------------------------------------------------------------------------------
+static inline bool RollSnapshotTestChance(uint32_t& state, float chance)
+{
+    return (NextSnapshotTestRandom(state) & 0xFFFFFF) < (uint32_t)(chance * (float)0x1000000);
+}
+
+//-----------------------------------------------------------------------------------
+static inline uint32_t NudgeSnapshotTestField(uint32_t& random, uint32_t value, uint32_t maxStep)
+{
+    return value + (NextSnapshotTestRandom(random) % ((2 * maxStep) + 1)) - maxStep;
+}
+
+//-----------------------------------------------------------------------------------
+static void SpawnSnapshotTestEntity(std::vector<SnapshotEntity>& world, uint16_t id, uint32_t& random)
+{
+    world.emplace_back();
+    SnapshotEntity& entity = world.back();
+    entity.id = id;
+    for (unsigned int i = 0; i < SNAPSHOT_TEST_NUM_FIELDS; ++i)
+    {
+        entity.fields[i] = NextSnapshotTestRandom(random);
+    }
+}
+
+//-----------------------------------------------------------------------------------
+//A quarter of the entities move every tick, the rest sit still except for rare health and flag changes. Every two seconds one despawns and a new one spawns.
+static void StepSnapshotTestWorld(std::vector<SnapshotEntity>& world, uint16_t& nextEntityId, uint32_t& random, unsigned int tick)
+{
+    for (SnapshotEntity& entity : world)
+    {
+        if (entity.id % 4 == 0)
+        {
+            entity.fields[0] = NudgeSnapshotTestField(random, entity.fields[0], 12);
+            entity.fields[1] = NudgeSnapshotTestField(random, entity.fields[1], 12);
+            entity.fields[3] = NudgeSnapshotTestField(random, entity.fields[3], 3);
+            entity.fields[2] = RollSnapshotTestChance(random, 0.05f) ? NudgeSnapshotTestField(random, entity.fields[2], 8) : entity.fields[2];
+        }
+        entity.fields[4] = RollSnapshotTestChance(random, 0.01f) ? NextSnapshotTestRandom(random) : entity.fields[4];
+        entity.fields[5] = RollSnapshotTestChance(random, 0.005f) ? NextSnapshotTestRandom(random) : entity.fields[5];
+    }
+    if (tick % 120 == 119)
+    {
+        world.erase(world.begin() + (NextSnapshotTestRandom(random) % world.size()));
+        SpawnSnapshotTestEntity(world, nextEntityId++, random);
+    }
+}
+
+//-----------------------------------------------------------------------------------
+static bool AreSnapshotsEqual(const Snapshot& first, const Snapshot& second, unsigned int numFields)
+{
+    if (first.entities.size() != second.entities.size())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < first.entities.size(); ++i)
+    {
+        const SnapshotEntity& a = first.entities[i];
+        const SnapshotEntity& b = second.entities[i];
+        if (a.id != b.id || memcmp(a.fields, b.fields, numFields * sizeof(uint32_t)) != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------------
+//The test session's snapshot callback, checks every decoded snapshot against the host's copy
+static void OnSnapshotTestMessage(const NetSender& from, NetMessage& msg)
+{
+    UNUSED(from);
+    SnapshotTestResults& results = *s_snapshotTestResults;
+    if (!s_snapshotTestClient->ReceiveSnapshot(msg))
+    {
+        ++results.numUndecodable;
+        return;
+    }
+    ++results.numDecoded;
+    uint16_t snapshotId = (uint16_t)((msg.m_msgBuffer[0] << 8) | msg.m_msgBuffer[1]);
+    const Snapshot* sent = s_snapshotTestHost->GetSentSnapshot(snapshotId, SNAPSHOT_TEST_CLIENT_INDEX);
+    const Snapshot* received = s_snapshotTestClient->GetReceivedSnapshot(snapshotId);
+    if (sent == nullptr || received == nullptr || !AreSnapshotsEqual(*sent, *received, SNAPSHOT_TEST_NUM_FIELDS))
+    {
+        ++results.numMismatched;
+    }
+}
+
+//-----------------------------------------------------------------------------------
+static void SendSnapshotTestPacket(NetConnection& from, NetSimulator& simulator, const sockaddr_in& fromAddress, const sockaddr_in& toAddress, NetPacket& scratch, size_t& wireBytes)
+{
+    from.ConstructPacket(scratch);
+    wireBytes += scratch.GetTotalReadableBytes() + SendRateController::UDP_IP_HEADER_BYTES;
+    UDPDatagram datagram;
+    datagram.address = toAddress;
+    datagram.buffer = scratch.m_buffer;
+    datagram.size = scratch.GetTotalReadableBytes();
+    simulator.Send(fromAddress, &datagram, 1);
+}
+
+//-----------------------------------------------------------------------------------
+//Mirrors NetSession::ProcessIncomingPacket for a packet that came from a known connection
+static void DeliverSnapshotTestPackets(NetConnection& to, NetSimulator& simulator, const sockaddr_in& toAddress, NetPacket& scratch)
+{
+    NetSender from;
+    from.session = to.m_session;
+    from.connection = &to;
+    NetMessage msg;
+    UDPDatagram datagram;
+    datagram.buffer = scratch.m_buffer;
+    while (simulator.Receive(toAddress, &datagram, 1) == 1)
+    {
+        scratch.Reset(NetPacket::INVALID_CONNECTION_INDEX);
+        scratch.SetReadableBytes(datagram.size);
+        scratch.m_arrivalTimeMs = simulator.GetTimeMilliseconds();
+        if (!scratch.Decompress(to.m_session->m_packetCompressor))
+        {
+            continue;
+        }
+        scratch.ReadHeader();
+        for (uint8_t messageIndex = 0; messageIndex < scratch.m_header.messageCount; ++messageIndex)
+        {
+            scratch.ReadMessage(msg);
+            if (to.CanProcessMessage(msg))
+            {
+                to.ProcessMessage(from, msg);
+            }
+        }
+        to.MarkPacketReceived(scratch);
+    }
+}
+
+//-----------------------------------------------------------------------------------
+//The first two fields are positions across a 1024 unit wide world
+static Vector2 GetSnapshotTestPosition(const SnapshotEntity& entity)
+{
+    return Vector2(((float)(entity.fields[0] & 0x3FFFF) / 256.0f) - 512.0f, ((float)(entity.fields[1] & 0x3FFFF) / 256.0f) - 512.0f);
+}
+
+//-----------------------------------------------------------------------------------
+//The session registers the snapshot type to the test's callback instead of the core messages'. Congestion control is off so every mode sends every snapshot.
+//Both connections share the session, so a recording holds both ends of the link: snapshots one way, acks the other.
+static void RunSnapshotMode(bool isDeltaEnabled, bool isInterestFiltered, unsigned int numTicks, uint32_t seed, SnapshotTestResults& results, std::vector<unsigned char>* recording)
+{
+    NetSession* session = new NetSession(1.0f / 60.0f);
+    session->RegisterMessage((uint8_t)NetMessage::SNAPSHOT, "snapshot", &OnSnapshotTestMessage, (uint32_t)NetMessage::Option::UNRELIABLE, (uint32_t)NetMessage::Control::NONE, 1);
+    session->m_isCongestionControlEnabled = false;
+    if (recording != nullptr)
+    {
+        session->StartRecordingPackets(numTicks * 2, "");
+    }
+
+    memset(&results, 0, sizeof(results));
+    s_snapshotTestResults = &results;
+    {
+        char hostGuid[NetConnection::MAX_GUID_LENGTH] = "snapshothost";
+        char clientGuid[NetConnection::MAX_GUID_LENGTH] = "snapshotclient";
+        NetConnection toClient(SNAPSHOT_TEST_CLIENT_INDEX, clientGuid, session->GetAddress(), session);
+        NetConnection toHost(NetSession::INVALID_CONNECTION_INDEX, hostGuid, session->GetAddress(), session);
+        SnapshotReplicator host(session);
+        SnapshotReplicator client(session);
+        host.SetSchema(SNAPSHOT_TEST_FIELD_BITS, SNAPSHOT_TEST_NUM_FIELDS);
+        client.SetSchema(SNAPSHOT_TEST_FIELD_BITS, SNAPSHOT_TEST_NUM_FIELDS);
+        host.m_isDeltaEnabled = isDeltaEnabled;
+        InterestManager interest;
+        interest.m_maxEntitiesPerUpdate = SNAPSHOT_TEST_PICKS_PER_TICK;
+        if (isInterestFiltered)
+        {
+            interest.SetInterest(SNAPSHOT_TEST_CLIENT_INDEX, Vector2(0.0f), SNAPSHOT_TEST_INTEREST_RADIUS);
+            host.SetInterestManager(&interest);
+        }
+        s_snapshotTestHost = &host;
+        s_snapshotTestClient = &client;
+
+        uint32_t random = (seed != 0) ? seed : 1;
+        std::vector<SnapshotEntity> world;
+        world.reserve(SNAPSHOT_TEST_NUM_ENTITIES);
+        uint16_t nextEntityId = 0;
+        while (nextEntityId < SNAPSHOT_TEST_NUM_ENTITIES)
+        {
+            SpawnSnapshotTestEntity(world, nextEntityId++, random);
+        }
+        NetSimulator simulator(seed);
+        NetSimulatorLinkSettings link;
+        link.minLatencyMs = SNAPSHOT_TEST_LATENCY_MS;
+        link.jitterMs = SNAPSHOT_TEST_JITTER_MS;
+        link.lossRate = SNAPSHOT_TEST_LOSS_RATE;
+        simulator.SetDefaultLinkSettings(link);
+        sockaddr_in hostAddress = simulator.AddEndpoint(1);
+        sockaddr_in clientAddress = simulator.AddEndpoint(2);
+        NetPacket scratch;
+        size_t ackWireBytes = 0;
+
+        double startSeconds = GetCurrentTimeSeconds();
+        for (uint32_t nowMs = 1; results.numTicks < numTicks; ++nowMs)
+        {
+            session->m_manualClockMs = (double)nowMs;
+            simulator.AdvanceTime(1.0);
+            DeliverSnapshotTestPackets(toHost, simulator, clientAddress, scratch);
+            DeliverSnapshotTestPackets(toClient, simulator, hostAddress, scratch);
+            if (nowMs % SNAPSHOT_TEST_TICK_MS != 0)
+            {
+                continue;
+            }
+            StepSnapshotTestWorld(world, nextEntityId, random, results.numTicks);
+            if (isInterestFiltered)
+            {
+                //The world stays in id order, so anything it skips has despawned
+                size_t worldIndex = 0;
+                for (uint16_t entityId = 0; entityId < nextEntityId; ++entityId)
+                {
+                    if (worldIndex < world.size() && world[worldIndex].id == entityId)
+                    {
+                        interest.SetEntity(entityId, GetSnapshotTestPosition(world[worldIndex++]));
+                    }
+                    else
+                    {
+                        interest.RemoveEntity(entityId);
+                    }
+                }
+                interest.Update();
+            }
+            host.BeginSnapshot();
+            for (const SnapshotEntity& entity : world)
+            {
+                host.AddEntity(entity);
+            }
+            host.SendSnapshotTo(&toClient);
+            SendSnapshotTestPacket(toClient, simulator, hostAddress, clientAddress, scratch, results.numWireBytes);
+            SendSnapshotTestPacket(toHost, simulator, clientAddress, hostAddress, scratch, ackWireBytes);
+            ++results.numTicks;
+        }
+        results.seconds = GetCurrentTimeSeconds() - startSeconds;
+        results.numSent = host.m_numSnapshotsSent;
+        results.numDeltas = host.m_numDeltaSnapshotsSent;
+        results.numSnapshotBytes = host.m_numSnapshotBytesSent;
+        s_snapshotTestHost = nullptr;
+        s_snapshotTestClient = nullptr;
+    }
+    s_snapshotTestResults = nullptr;
+    if (recording != nullptr)
+    {
+        recording->swap(session->m_packetRecording);
+    }
+    delete session;
+}
+
+//-----------------------------------------------------------------------------------
+bool RunSnapshotTest(unsigned int numTicks, uint32_t seed, NetTestPrintCallback* print)
+{
+    print(Stringf("snapshottest: %u entities, 25%% moving, %u ticks at %ums, %.0f%% loss, %u-%ums latency", SNAPSHOT_TEST_NUM_ENTITIES, numTicks, SNAPSHOT_TEST_TICK_MS, SNAPSHOT_TEST_LOSS_RATE * 100.0f, SNAPSHOT_TEST_LATENCY_MS, SNAPSHOT_TEST_LATENCY_MS + SNAPSHOT_TEST_JITTER_MS), RGBA::CORNFLOWER_BLUE);
+    bool passed = true;
+    SnapshotTestResults modeResults[3];
+    const char* modeNames[3] = { "full state", "delta", "delta + interest" };
+    for (int mode = 0; mode < 3; ++mode)
+    {
+        SnapshotTestResults& results = modeResults[mode];
+        RunSnapshotMode(mode >= 1, mode == 2, numTicks, seed, results, nullptr);
+        float seconds = (float)(results.numTicks * SNAPSHOT_TEST_TICK_MS) * 0.001f;
+        bool modePassed = results.numMismatched == 0 && results.numUndecodable == 0 && results.numDecoded * 10 >= results.numTicks * 8;
+        passed = passed && modePassed;
+        print(Stringf("  %s %s: %.0f B/s on the wire, %.1f B/snapshot, %u/%u decoded (%u deltas sent), %u undecodable, %u mismatched, %.2fms", modePassed ? "PASS" : "FAIL", modeNames[mode]
+            , (float)results.numWireBytes / seconds, (float)results.numSnapshotBytes / (float)Max<unsigned int>(results.numSent, 1), results.numDecoded, results.numSent, results.numDeltas, results.numUndecodable, results.numMismatched, results.seconds * 1000.0), modePassed ? RGBA::GREEN : RGBA::RED);
+    }
+    float ratio = (float)modeResults[0].numWireBytes / (float)Max<size_t>(modeResults[1].numWireBytes, 1);
+    bool isSmaller = ratio >= 2.0f;
+    passed = passed && isSmaller;
+    print(Stringf("  %s delta uses %.2fx less bandwidth than full state", isSmaller ? "PASS" : "FAIL", ratio), isSmaller ? RGBA::GREEN : RGBA::RED);
+    bool isFilteredSmaller = modeResults[2].numSnapshotBytes < modeResults[1].numSnapshotBytes;
+    passed = passed && isFilteredSmaller;
+    print(Stringf("  %s interest filtering sends %.0f%% of the delta snapshot bytes", isFilteredSmaller ? "PASS" : "FAIL", 100.0f * (float)modeResults[2].numSnapshotBytes / (float)Max<size_t>(modeResults[1].numSnapshotBytes, 1)), isFilteredSmaller ? RGBA::GREEN : RGBA::RED);
+    print(Stringf("snapshottest: %s", passed ? "passed" : "failed"), passed ? RGBA::GREEN : RGBA::RED);
+    return passed;
+}
+
+//-----------------------------------------------------------------------------------
+void RecordSnapshotTraffic(unsigned int numTicks, uint32_t seed, std::vector<unsigned char>& outRecording)
+{
+    SnapshotTestResults results;
+    RunSnapshotMode(true, true, numTicks, seed, results, &outRecording);
+}
@@ -1,8 +1,15 @@
 #include "Engine/Net/UDPIP/UDPSocket.hpp"
-#include "Engine/Net/NetSystem.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
 #include "Engine/Core/StringUtils.hpp"
-#include "../../Input/Logging.hpp"
+#include "Engine/Time/Time.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include <string.h>
+
+#ifdef _WIN32
+#define CloseUDPSocket closesocket
+#else
+#define CloseUDPSocket close
+#endif
 
 //-----------------------------------------------------------------------------------
 SOCKET UDPSocket::CreateUDPSocket(char const* address,
@@ -15,46 +22,52 @@ SOCKET UDPSocket::CreateUDPSocket(char const* address,
     while (m_socket == INVALID_SOCKET && currNumRetries < MAX_RETRIES)
     {
         //Set up the portNumber
-        size_t bufferSize = strlen(portNumber) + 1;
-        char* portStr = new char[bufferSize];
+        char portStr[16];
         unsigned int port = atoi(portNumber) + currNumRetries;
-        _itoa_s(port, portStr, bufferSize, 10);
+        snprintf(portStr, sizeof(portStr), "%u", port);
 
-        // First, try to get network addresses for this
-        addrinfo *info_list = NetSystem::AllocAddressesForHost(address, // an address for this machine
-            portStr, // service, which for TCP/IP is the port as a string (ex: "80")
-            AF_INET, // We're doing IPv4 in class
-            SOCK_DGRAM, // UDP for now
-            AI_PASSIVE);  // And something we can bind (and therefore listen on)
+        // First, try to get network addresses for this. Done directly through getaddrinfo rather than NetSystem
+        // so the socket also builds on platforms without WinSock.
+        addrinfo hints;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_INET; // We're doing IPv4 in class
+        hints.ai_socktype = SOCK_DGRAM; // UDP for now
+        hints.ai_flags = AI_PASSIVE; // And something we can bind (and therefore listen on)
 
-        if (info_list == nullptr) 
+        addrinfo* info_list = nullptr;
+        if (getaddrinfo(address, portStr, &hints, &info_list) != 0 || info_list == nullptr)
         {
             // no addresses match - FAIL
-            return false;
+            DebuggerPrintf("Network: Failed to find addresses for [%s:%s]\n", address, portStr);
+            return INVALID_SOCKET;
         }
 
         // Alright, try to create a SOCKET from this addr info
         SOCKET my_socket = INVALID_SOCKET;
         addrinfo *iter = info_list;
-        while ((iter != nullptr) && (my_socket == INVALID_SOCKET)) 
+        while ((iter != nullptr) && (my_socket == INVALID_SOCKET))
         {
             // First, create a socket for this address.
             // family, socktype, and protocol are provided by the addrinfo
             // if you wanted to be manual, for an TCP/IPv4 socket you'd use
             // AF_INET, SOCK_DGRAM, IPPROTO_UDP
             my_socket = socket(iter->ai_family, iter->ai_socktype, iter->ai_protocol);
-            if (my_socket != INVALID_SOCKET) 
+            if (my_socket != INVALID_SOCKET)
             {
                 // Okay, we were able to create it,
-                // Now try to bind it (associates the address (ex: 192.168.1.52:4325) to this 
+                // Now try to bind it (associates the address (ex: 192.168.1.52:4325) to this
                 // socket so it will receive information for it.
-    
+
                 int result = bind(my_socket, iter->ai_addr, (int)(iter->ai_addrlen));
                 if (SOCKET_ERROR != result)
                 {
                     // Set it to non-block - since we'll be working with this on our main thread
+#ifdef _WIN32
                     u_long non_blocking = 1;
                     ioctlsocket(my_socket, FIONBIO, &non_blocking);
+#else
+                    fcntl(my_socket, F_SETFL, fcntl(my_socket, F_GETFL, 0) | O_NONBLOCK);
+#endif
 
                     // Save off the address if available.
                     ASSERT_OR_DIE(iter->ai_addrlen == sizeof(sockaddr_in), "Address length doesn't match.");
@@ -66,7 +79,7 @@ SOCKET UDPSocket::CreateUDPSocket(char const* address,
                 else
                 {
                     // Cleanup on Fail.
-                    closesocket(my_socket);
+                    CloseUDPSocket(my_socket);
                     my_socket = INVALID_SOCKET;
                 }
 
@@ -74,10 +87,9 @@ SOCKET UDPSocket::CreateUDPSocket(char const* address,
             iter = iter->ai_next;
         }
         ++currNumRetries;
-        delete portStr;
 
         // If we allocted, we must free eventually
-        NetSystem::FreeAddresses(info_list);
+        freeaddrinfo(info_list);
 
         // Return the socket we created.
         if (my_socket != INVALID_SOCKET)
@@ -87,84 +99,203 @@ SOCKET UDPSocket::CreateUDPSocket(char const* address,
     }
     if (currNumRetries == MAX_RETRIES)
     {
-        LogPrintf(LogLevel::WARNING, "Was unable to bind to a port after %i retries", MAX_RETRIES);
+        DebuggerPrintf("Was unable to bind to a port after %i retries\n", MAX_RETRIES);
     }
     return INVALID_SOCKET;
 }
 
 //-----------------------------------------------------------------------------------
-size_t UDPSocket::SendTo(const sockaddr_in& toAddress, void const* data, const size_t dataSize)
+void UDPSocket::Bind(const char* address, const char* portNumber)
+{
+    m_socket = CreateUDPSocket(address, portNumber, &m_address);
+}
+
+//-----------------------------------------------------------------------------------
+void UDPSocket::Unbind()
 {
-    if (m_socket != INVALID_SOCKET) 
+    CloseUDPSocket(m_socket);
+    m_socket = INVALID_SOCKET;
+}
+
+#if defined(__linux__)
+//-----------------------------------------------------------------------------------
+size_t UDPSocket::SendBatch(const UDPDatagram* datagrams, size_t numDatagrams)
+{
+    if (m_socket == INVALID_SOCKET)
+    {
+        return 0;
+    }
+
+    mmsghdr headers[MAX_BATCH_SIZE];
+    iovec vectors[MAX_BATCH_SIZE];
+    size_t numSent = 0;
+    size_t numProcessed = 0;
+    while (numProcessed < numDatagrams)
     {
-        // send will return the amount of data actually sent.
-        // It SHOULD match, or be an error.  
-        int size = ::sendto(m_socket,
-            (char const*)data,      // payload
-            (int)dataSize,         // payload size
-            0,                      // flags - unused
-            (sockaddr const*)&toAddress, // who we're sending to
-            sizeof(sockaddr_in));  // size of that structure
-
-        if (size > 0) 
+        unsigned int batchSize = (unsigned int)Min<size_t>(numDatagrams - numProcessed, MAX_BATCH_SIZE);
+        for (unsigned int i = 0; i < batchSize; ++i)
         {
-            return size;
+            const UDPDatagram& datagram = datagrams[numProcessed + i];
+            vectors[i].iov_base = datagram.buffer;
+            vectors[i].iov_len = datagram.size;
+            memset(&headers[i], 0, sizeof(mmsghdr));
+            headers[i].msg_hdr.msg_name = (void*)&datagram.address;
+            headers[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+            headers[i].msg_hdr.msg_iov = &vectors[i];
+            headers[i].msg_hdr.msg_iovlen = 1;
         }
-    }
 
-    // Not particularly interested in errors - you can 
-    // check this though if you want to see if something
-    // has happened to your socket.
-    return 0;
+        int result = ::sendmmsg(m_socket, headers, batchSize, 0);
+        if (result > 0)
+        {
+            numSent += result;
+            numProcessed += result;
+        }
+        else if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS)
+        {
+            // Send buffer is full, anything left over is dropped like any other lost datagram.
+            break;
+        }
+        else
+        {
+            // The datagram at the front was rejected (bad address, unreachable, etc.), skip it and keep going.
+            ++numProcessed;
+        }
+    }
+    return numSent;
 }
 
 //-----------------------------------------------------------------------------------
-void UDPSocket::Bind(const char* address, const char* portNumber)
+size_t UDPSocket::ReceiveBatch(UDPDatagram* outDatagrams, size_t maxDatagrams)
 {
-    m_socket = CreateUDPSocket(address, portNumber, &m_address);
+    if (m_socket == INVALID_SOCKET)
+    {
+        return 0;
+    }
+
+    mmsghdr headers[MAX_BATCH_SIZE];
+    iovec vectors[MAX_BATCH_SIZE];
+    sockaddr_storage addresses[MAX_BATCH_SIZE];
+    size_t numReceived = 0;
+    while (numReceived < maxDatagrams)
+    {
+        unsigned int batchSize = (unsigned int)Min<size_t>(maxDatagrams - numReceived, MAX_BATCH_SIZE);
+        for (unsigned int i = 0; i < batchSize; ++i)
+        {
+            vectors[i].iov_base = outDatagrams[numReceived + i].buffer;
+            vectors[i].iov_len = PACKET_MTU;
+            memset(&headers[i], 0, sizeof(mmsghdr));
+            headers[i].msg_hdr.msg_name = &addresses[i];
+            headers[i].msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+            headers[i].msg_hdr.msg_iov = &vectors[i];
+            headers[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        int result = ::recvmmsg(m_socket, headers, batchSize, MSG_DONTWAIT, nullptr);
+        if (result <= 0)
+        {
+            break;
+        }
+        double arrivalTimeMs = GetCurrentTimeMilliseconds();
+        for (int i = 0; i < result; ++i)
+        {
+            // We're only doing IPv4 - if we got a non-IPv4 address
+            // assume it's garbage
+            ASSERT_OR_DIE(headers[i].msg_hdr.msg_namelen == sizeof(sockaddr_in), "We got a non IPV4 address.");
+            UDPDatagram& datagram = outDatagrams[numReceived + i];
+            memcpy(&datagram.address, &addresses[i], sizeof(sockaddr_in));
+            datagram.size = headers[i].msg_len;
+            datagram.arrivalTimeMs = arrivalTimeMs;
+        }
+        numReceived += result;
+        if ((unsigned int)result < batchSize)
+        {
+            break;
+        }
+    }
+    return numReceived;
 }
 
+#else
 //-----------------------------------------------------------------------------------
-void UDPSocket::Unbind()
+size_t UDPSocket::SendBatch(const UDPDatagram* datagrams, size_t numDatagrams)
 {
-    NetSystem::CloseSocket(m_socket);
-    m_socket = INVALID_SOCKET;
+    size_t numSent = 0;
+    if (m_socket != INVALID_SOCKET)
+    {
+        for (size_t i = 0; i < numDatagrams; ++i)
+        {
+            // send will return the amount of data actually sent.
+            // It SHOULD match, or be an error. A failed datagram doesn't stop the rest of the batch.
+            int size = ::sendto(m_socket,
+                (char const*)datagrams[i].buffer,       // payload
+                (int)datagrams[i].size,                 // payload size
+                0,                                      // flags - unused
+                (sockaddr const*)&datagrams[i].address, // who we're sending to
+                sizeof(sockaddr_in));                   // size of that structure
+
+            if (size > 0)
+            {
+                ++numSent;
+            }
+        }
+    }
+    return numSent;
 }
 
 //-----------------------------------------------------------------------------------
-size_t UDPSocket::RecieveFrom(sockaddr_in& fromAddress, void* buffer)
+size_t UDPSocket::ReceiveBatch(UDPDatagram* outDatagrams, size_t maxDatagrams)
 {
+    size_t numReceived = 0;
     if (m_socket != INVALID_SOCKET)
     {
-        // recv will return amount of data read, should always be <= buffer_size
-        // Also, if you send, say, 3 KB with send, recv may actually
-        // end up returning multiple times (say, 1KB, 512B, and 1.5KB) because 
-        // the message got broken up - so be sure you application watches for it
-
-        sockaddr_storage addr;
-        int addrlen = sizeof(addr);
-
-        int size = ::recvfrom(m_socket,
-            (char*)buffer,    // what we're reading into
-            PACKET_MTU,      // max data we can read
-            0,                // optional flags (see docs if you're curious)
-            (sockaddr*)&addr, // Who sent the message
-            &addrlen);       // length of their address
-
-        if (size > 0)
+        // WinSock has no recvmmsg, so drain the socket in a tight loop until it would block
+        // or the caller's array is full.
+        while (numReceived < maxDatagrams)
         {
+            sockaddr_storage addr;
+            socklen_t addrlen = sizeof(addr);
+            UDPDatagram& datagram = outDatagrams[numReceived];
+
+            int size = ::recvfrom(m_socket,
+                (char*)datagram.buffer, // what we're reading into
+                PACKET_MTU,             // max data we can read
+                0,                      // optional flags (see docs if you're curious)
+                (sockaddr*)&addr,       // Who sent the message
+                &addrlen);              // length of their address
+
+            if (size <= 0)
+            {
+                // Again, I don't particularly care about the error code for now.
+                // It may tell us the guy we're sending to is bad, but we can't really do anything with that yet.
+                break;
+            }
+
             // We're only doing IPv4 - if we got a non-IPv4 address
             // assume it's garbage
             ASSERT_OR_DIE(addrlen == sizeof(sockaddr_in), "We got a non IPV4 address.");
-
-            memcpy(&fromAddress, &addr, addrlen);
-            return size;
+            memcpy(&datagram.address, &addr, sizeof(sockaddr_in));
+            datagram.size = size;
+            datagram.arrivalTimeMs = GetCurrentTimeMilliseconds();
+            ++numReceived;
         }
     }
+    return numReceived;
+}
+#endif
 
-    // Again, I don't particularly care about the 
-    // error code for now.  It may tell us
-    // the guy we're sending to is bad, but we can't really
-    // do anything with that yet. 
-    return 0U;
-}
\ No newline at end of file
+//-----------------------------------------------------------------------------------
+bool UDPSocket::WaitForData(unsigned int timeoutMilliseconds)
+{
+    if (m_socket == INVALID_SOCKET)
+    {
+        return false;
+    }
+    fd_set readSet;
+    FD_ZERO(&readSet);
+    FD_SET(m_socket, &readSet);
+    timeval timeout;
+    timeout.tv_sec = timeoutMilliseconds / 1000;
+    timeout.tv_usec = (timeoutMilliseconds % 1000) * 1000;
+    return ::select((int)m_socket + 1, &readSet, nullptr, nullptr, &timeout) > 0;
+}
@@ -1,24 +1,24 @@
 #pragma once
-#pragma comment(lib, "ws2_32")
-#include <stdint.h>
-#include <WinSock2.h>
-#include <WS2tcpip.h>
+#include "Engine/Net/UDPIP/UDPTransport.hpp"
 
-#define PACKET_MTU 1232
-
-class UDPSocket
+//-----------------------------------------------------------------------------------
+//Non-blocking UDP socket. On Linux batches go through recvmmsg/sendmmsg so a whole array of datagrams costs one kernel crossing,
+//WinSock and other POSIX platforms fall back to a tight recvfrom/sendto loop behind the same interface.
+class UDPSocket : public UDPTransport
 {
 public:
     UDPSocket() : m_socket(INVALID_SOCKET) {};
-    ~UDPSocket() {};
-    void Bind(const char* address, const char* portNumber);
-    void Unbind();
-    bool IsBound() { return m_socket != INVALID_SOCKET; };
-    size_t SendTo(const sockaddr_in& toAddress, void const* data, const size_t dataSize);
-    size_t RecieveFrom(sockaddr_in& fromAddress, void* buffer);
-    //You get back an address of who sent the data. 
+    virtual ~UDPSocket() { if (IsBound()) Unbind(); };
+    virtual void Bind(const char* address, const char* portNumber) override;
+    virtual void Unbind() override;
+    virtual bool IsBound() const override { return m_socket != INVALID_SOCKET; };
+    virtual sockaddr_in GetAddress() const override { return m_address; };
+    virtual size_t SendBatch(const UDPDatagram* datagrams, size_t numDatagrams) override;
+    virtual size_t ReceiveBatch(UDPDatagram* outDatagrams, size_t maxDatagrams) override;
+    virtual bool WaitForData(unsigned int timeoutMilliseconds) override;
+    //You get back an address of who sent the data.
     //You ask for max length, and if you get more than you asked for, you get the error
-    //Regardless of how much you ask for, you simply get one packet.
+    //Regardless of how much you ask for, you simply get one packet per datagram.
 
     SOCKET m_socket;
     sockaddr_in m_address;
@@ -0,0 +1,64 @@
+#pragma once
+#include "Engine/Net/NetAddress.hpp"
+#include <stdint.h>
+#include <stddef.h>
+
+#define PACKET_MTU 1232
+
+//-----------------------------------------------------------------------------------
+//One entry in a batched send or receive. For sends, size is the number of bytes in buffer.
+//For receives, buffer must hold PACKET_MTU bytes and size/address/arrivalTimeMs are filled in with what arrived.
+struct UDPDatagram
+{
+    sockaddr_in address;
+    void* buffer;
+    size_t size;
+    double arrivalTimeMs; //When the transport pulled it off the network, used for RTT instead of when the game got around to it
+};
+
+//-----------------------------------------------------------------------------------
+//Interface for anything that can move datagrams for a PacketChannel.
+//Backends are expected to move a whole array of datagrams per call, so callers should gather everything they have for a frame
+//and hand it over at once instead of calling SendTo/RecieveFrom in a loop.
+class UDPTransport
+{
+public:
+    //CONSTRUCTORS/////////////////////////////////////////////////////////////////////
+    virtual ~UDPTransport() {};
+
+    //FUNCTIONS/////////////////////////////////////////////////////////////////////
+    virtual void Bind(const char* address, const char* portNumber) = 0;
+    virtual void Unbind() = 0;
+    virtual bool IsBound() const = 0;
+    virtual sockaddr_in GetAddress() const = 0;
+    virtual size_t SendBatch(const UDPDatagram* datagrams, size_t numDatagrams) = 0; //Returns how many datagrams were handed to the network
+    virtual size_t ReceiveBatch(UDPDatagram* outDatagrams, size_t maxDatagrams) = 0; //Returns how many datagrams were filled in, never blocks
+    virtual bool WaitForData(unsigned int timeoutMilliseconds) = 0; //Blocks until something can be received or the timeout passes
+
+    //-----------------------------------------------------------------------------------
+    inline size_t SendTo(const sockaddr_in& toAddress, void const* data, const size_t dataSize)
+    {
+        UDPDatagram datagram;
+        datagram.address = toAddress;
+        datagram.buffer = const_cast<void*>(data);
+        datagram.size = dataSize;
+        return SendBatch(&datagram, 1) == 1 ? dataSize : 0;
+    }
+
+    //-----------------------------------------------------------------------------------
+    inline size_t RecieveFrom(sockaddr_in& fromAddress, void* buffer)
+    {
+        UDPDatagram datagram;
+        datagram.buffer = buffer;
+        datagram.size = 0;
+        if (ReceiveBatch(&datagram, 1) == 1)
+        {
+            fromAddress = datagram.address;
+            return datagram.size;
+        }
+        return 0;
+    }
+
+    //CONSTANTS/////////////////////////////////////////////////////////////////////
+    static const size_t MAX_BATCH_SIZE = 64;
+};
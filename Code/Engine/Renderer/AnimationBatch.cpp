@@ -0,0 +1,327 @@
+#include "Engine/Renderer/AnimationBatch.hpp"
+#include "Engine/Renderer/AnimationMotion.hpp"
+#include "Engine/Renderer/Skeleton.hpp"
+#include "Engine/Renderer/Vertex.hpp"
+#include "Engine/Math/Quaternion.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Engine/Core/JobSystem.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Input/Console.hpp"
+#include "Engine/Time/Time.hpp"
+#include <malloc.h>
+#include <cmath>
+
+//-----------------------------------------------------------------------------------
+//Builds a chain skeleton, a looping wiggle motion, and a vertex blob with four influences per vertex.
+//Runs the old serial path (ApplyMotionToSkeleton + scalar matrix math) against the batch and reports per-character cost.
+CONSOLE_COMMAND(animbench)
+{
+    if (!(args.HasArgs(0) || args.HasArgs(3)))
+    {
+        Console::instance->PrintLine("animBench <numCharacters> <numJoints> <numVerticesPerCharacter>", RGBA::RED);
+        return;
+    }
+    int numCharacters = args.HasArgs(3) ? args.GetIntArgument(0) : 500;
+    int numJoints = args.HasArgs(3) ? args.GetIntArgument(1) : 64;
+    int numVertices = args.HasArgs(3) ? args.GetIntArgument(2) : 2000;
+    const int NUM_FRAMES = 20;
+    const float FRAME_SECONDS = 1.0f / 60.0f;
+    if (numCharacters <= 0 || numJoints <= 0 || numVertices < 0)
+    {
+        Console::instance->PrintLine("Counts must be positive", RGBA::RED);
+        return;
+    }
+
+    Skeleton skeleton;
+    for (int jointIndex = 0; jointIndex < numJoints; ++jointIndex)
+    {
+        Matrix4x4 bindPose = Matrix4x4::IDENTITY;
+        Matrix4x4::MatrixMakeTranslation(&bindPose, Vector3(0.0f, 0.0f, (float)jointIndex));
+        skeleton.AddJoint(Stringf("joint%i", jointIndex).c_str(), jointIndex - 1, bindPose);
+    }
+
+    AnimationMotion motion("animbench", 2.0f, 30.0f, &skeleton);
+    motion.m_playbackMode = AnimationMotion::LOOP;
+    for (int jointIndex = 0; jointIndex < numJoints; ++jointIndex)
+    {
+        Matrix4x4* jointKeyframes = motion.GetJointKeyframes(jointIndex);
+        for (uint32_t frame = 0; frame < motion.m_frameCount; ++frame)
+        {
+            float angle = sinf(((float)frame * 0.2f) + (float)jointIndex) * 0.5f;
+            Quaternion rotation(0.0f, sinf(angle * 0.5f), 0.0f, cosf(angle * 0.5f));
+            jointKeyframes[frame] = Quaternion::ComposeMatrix(Vector3(0.0f, 0.0f, (float)jointIndex), rotation, Vector3::ONE);
+        }
+    }
+
+    std::vector<Vertex_SkinnedPCTN> bindPoseVertices(numVertices);
+    for (int vertexIndex = 0; vertexIndex < numVertices; ++vertexIndex)
+    {
+        Vertex_SkinnedPCTN& vertex = bindPoseVertices[vertexIndex];
+        vertex.pos = Vector3(MathUtils::GetRandomFloatFromZeroTo(1.0f), MathUtils::GetRandomFloatFromZeroTo(1.0f), MathUtils::GetRandomFloatFromZeroTo((float)numJoints));
+        vertex.normal = Vector3::UNIT_X;
+        vertex.boneWeights = Vector4(0.4f, 0.3f, 0.2f, 0.1f);
+        int baseJoint = (int)vertex.pos.z;
+        vertex.boneIndices = Vector4Int(baseJoint, Min(baseJoint + 1, numJoints - 1), Max(baseJoint - 1, 0), numJoints - 1);
+    }
+
+    //Serial reference
+    std::vector<Matrix4x4> serialPalette(numJoints);
+    std::vector<Vertex_SkinnedPCTN> serialVertices(bindPoseVertices);
+    double startSeconds = GetCurrentTimeSeconds();
+    for (int frame = 0; frame < NUM_FRAMES; ++frame)
+    {
+        for (int characterIndex = 0; characterIndex < numCharacters; ++characterIndex)
+        {
+            motion.ApplyMotionToSkeleton(&skeleton, (frame * FRAME_SECONDS) + (characterIndex * 0.01f));
+            for (int jointIndex = 0; jointIndex < numJoints; ++jointIndex)
+            {
+                serialPalette[jointIndex] = skeleton.m_modelToBoneSpace[jointIndex] * skeleton.m_boneToModelSpace[jointIndex];
+            }
+            for (int vertexIndex = 0; vertexIndex < numVertices; ++vertexIndex)
+            {
+                const Vertex_SkinnedPCTN& source = bindPoseVertices[vertexIndex];
+                const int* indices = &source.boneIndices.x;
+                const float* weights = &source.boneWeights.x;
+                Vector4 position = Vector4::ZERO;
+                for (int influence = 0; influence < 4; ++influence)
+                {
+                    position += (Vector4(source.pos, 1.0f) * serialPalette[indices[influence]]) * weights[influence];
+                }
+                serialVertices[vertexIndex].pos = Vector3(position.x, position.y, position.z);
+            }
+        }
+    }
+    double serialSeconds = (GetCurrentTimeSeconds() - startSeconds) / NUM_FRAMES;
+
+    //Batched
+    AnimationBatch batch;
+    for (int characterIndex = 0; characterIndex < numCharacters; ++characterIndex)
+    {
+        batch.AddCharacter(&skeleton, &motion, characterIndex * 0.01f, bindPoseVertices.data(), numVertices);
+    }
+    startSeconds = GetCurrentTimeSeconds();
+    for (int frame = 0; frame < NUM_FRAMES; ++frame)
+    {
+        batch.Update(frame == 0 ? 0.0f : FRAME_SECONDS, false);
+    }
+    double poseOnlySeconds = (GetCurrentTimeSeconds() - startSeconds) / NUM_FRAMES;
+    startSeconds = GetCurrentTimeSeconds();
+    for (int frame = 0; frame < NUM_FRAMES; ++frame)
+    {
+        batch.Update(FRAME_SECONDS, true);
+    }
+    double batchedSeconds = (GetCurrentTimeSeconds() - startSeconds) / NUM_FRAMES;
+
+    //Sanity check the last character against the serial result for the same time
+    float maxError = 0.0f;
+    const AnimatedCharacter& lastCharacter = batch.GetCharacter(numCharacters - 1);
+    motion.ApplyMotionToSkeleton(&skeleton, lastCharacter.time);
+    for (int jointIndex = 0; jointIndex < numJoints; ++jointIndex)
+    {
+        serialPalette[jointIndex] = skeleton.m_modelToBoneSpace[jointIndex] * skeleton.m_boneToModelSpace[jointIndex];
+    }
+    for (int vertexIndex = 0; vertexIndex < numVertices; ++vertexIndex)
+    {
+        const Vertex_SkinnedPCTN& source = bindPoseVertices[vertexIndex];
+        Vector4 position = Vector4::ZERO;
+        for (int influence = 0; influence < 4; ++influence)
+        {
+            position += (Vector4(source.pos, 1.0f) * serialPalette[(&source.boneIndices.x)[influence]]) * (&source.boneWeights.x)[influence];
+        }
+        maxError = Max(maxError, (Vector3(position.x, position.y, position.z) - lastCharacter.skinnedVertices[vertexIndex].pos).CalculateMagnitude());
+    }
+
+    Console::instance->PrintLine(Stringf("%i characters, %i joints, %i vertices each", numCharacters, numJoints, numVertices), RGBA::GREEN);
+    Console::instance->PrintLine(Stringf("Serial: %.3fms/frame (%.2fus/character)", serialSeconds * 1000.0, serialSeconds * 1000000.0 / numCharacters), RGBA::GREEN);
+    Console::instance->PrintLine(Stringf("Batched pose+palette: %.3fms/frame (%.2fus/character)", poseOnlySeconds * 1000.0, poseOnlySeconds * 1000000.0 / numCharacters), RGBA::GREEN);
+    Console::instance->PrintLine(Stringf("Batched pose+palette+skin: %.3fms/frame (%.2fus/character), max error vs serial %f",
+        batchedSeconds * 1000.0, batchedSeconds * 1000000.0 / numCharacters, maxError), RGBA::GREEN);
+}
+
+//-----------------------------------------------------------------------------------
+AnimationBatch::AnimationBatch()
+    : m_nextChunk(0)
+    , m_jobsRemaining(0)
+    , m_numChunks(0)
+    , m_skinVertices(false)
+{
+}
+
+//-----------------------------------------------------------------------------------
+AnimationBatch::~AnimationBatch()
+{
+    for (AnimatedCharacter& character : m_characters)
+    {
+        delete[] character.pose;
+        _aligned_free(character.skinningPalette);
+        delete[] character.skinnedVertices;
+    }
+}
+
+//-----------------------------------------------------------------------------------
+unsigned int AnimationBatch::AddCharacter(Skeleton* skeleton, AnimationMotion* motion, float startTime, const Vertex_SkinnedPCTN* bindPoseVertices, unsigned int numVertices)
+{
+    AnimatedCharacter character;
+    character.skeleton = skeleton;
+    character.motion = motion;
+    character.time = startTime;
+    character.jointCount = skeleton->GetJointCount();
+    character.pose = new Matrix4x4[character.jointCount];
+    character.skinningPalette = (SkinningMatrix*)_aligned_malloc(sizeof(SkinningMatrix) * character.jointCount, 16);
+    character.bindPoseVertices = bindPoseVertices;
+    character.numVertices = bindPoseVertices ? numVertices : 0;
+    character.skinnedVertices = character.numVertices > 0 ? new Vertex_SkinnedPCTN[character.numVertices] : nullptr;
+    for (unsigned int vertexIndex = 0; vertexIndex < character.numVertices; ++vertexIndex)
+    {
+        character.skinnedVertices[vertexIndex] = bindPoseVertices[vertexIndex];
+    }
+    m_characters.push_back(character);
+    return m_characters.size() - 1;
+}
+
+//-----------------------------------------------------------------------------------
+void AnimationBatch::Update(float deltaSeconds, bool skinVertices)
+{
+    unsigned int numCharacters = m_characters.size();
+    for (AnimatedCharacter& character : m_characters)
+    {
+        character.time += deltaSeconds;
+    }
+
+    if (!JobSystem::instance || numCharacters <= CHARACTERS_PER_JOB)
+    {
+        UpdateCharacters(0, numCharacters, skinVertices);
+        return;
+    }
+
+    //The caller takes chunks too, so one job fewer than there are chunks keeps every chunk claimable by somebody
+    m_numChunks = (numCharacters + CHARACTERS_PER_JOB - 1) / CHARACTERS_PER_JOB;
+    m_skinVertices = skinVertices;
+    m_nextChunk = 0;
+    int numJobs = static_cast<int>(m_numChunks) - 1;
+    m_jobsRemaining = numJobs;
+    for (int jobIndex = 0; jobIndex < numJobs; ++jobIndex)
+    {
+        JobSystem::instance->CreateAndDispatchJob(GENERIC, &AnimationBatch::UpdateCharactersJob, this);
+    }
+
+    //Help with this batch's chunks instead of idling, then wait out any job that hasn't been picked up yet.
+    //Jobs that start after every chunk is claimed return straight away.
+    UpdateClaimedChunks();
+    while (m_jobsRemaining > 0)
+    {
+        SwitchToThread();
+    }
+}
+
+//-----------------------------------------------------------------------------------
+void AnimationBatch::UpdateClaimedChunks()
+{
+    for (unsigned int chunk = m_nextChunk++; chunk < m_numChunks; chunk = m_nextChunk++)
+    {
+        unsigned int firstCharacter = chunk * CHARACTERS_PER_JOB;
+        UpdateCharacters(firstCharacter, Min(CHARACTERS_PER_JOB, static_cast<unsigned int>(m_characters.size()) - firstCharacter), m_skinVertices);
+    }
+}
+
+//-----------------------------------------------------------------------------------
+void AnimationBatch::UpdateCharactersJob(Job* job)
+{
+    AnimationBatch* batch = (AnimationBatch*)job->data;
+    batch->UpdateClaimedChunks();
+    --batch->m_jobsRemaining;
+}
+
+//-----------------------------------------------------------------------------------
+void AnimationBatch::UpdateCharacters(unsigned int firstCharacter, unsigned int numCharacters, bool skinVertices)
+{
+    for (unsigned int characterIndex = firstCharacter; characterIndex < firstCharacter + numCharacters; ++characterIndex)
+    {
+        AnimatedCharacter& character = m_characters[characterIndex];
+        character.motion->EvaluatePose(character.time, character.pose, character.jointCount);
+        CalculateSkinningPalette(character.pose, character.skeleton->m_modelToBoneSpace.data(), character.skinningPalette, character.jointCount);
+        if (skinVertices && character.numVertices > 0)
+        {
+            SkinVertices(character.skinningPalette, character.bindPoseVertices, character.skinnedVertices, character.numVertices);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------------
+//Equivalent to modelToBone * boneToModel, built a row at a time and then transposed into columns.
+void AnimationBatch::CalculateSkinningPalette(const Matrix4x4* boneToModel, const Matrix4x4* modelToBone, SkinningMatrix* outPalette, uint32_t jointCount)
+{
+    for (uint32_t jointIndex = 0; jointIndex < jointCount; ++jointIndex)
+    {
+        const float* bone = boneToModel[jointIndex].data;
+        const float* bind = modelToBone[jointIndex].data;
+        __m128 bindRow0 = _mm_loadu_ps(bind + 0);
+        __m128 bindRow1 = _mm_loadu_ps(bind + 4);
+        __m128 bindRow2 = _mm_loadu_ps(bind + 8);
+        __m128 bindRow3 = _mm_loadu_ps(bind + 12);
+
+        __m128 rows[4];
+        for (int row = 0; row < 4; ++row)
+        {
+            const float* boneRow = bone + (row * 4);
+            rows[row] = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(_mm_set1_ps(boneRow[0]), bindRow0), _mm_mul_ps(_mm_set1_ps(boneRow[1]), bindRow1)),
+                _mm_add_ps(_mm_mul_ps(_mm_set1_ps(boneRow[2]), bindRow2), _mm_mul_ps(_mm_set1_ps(boneRow[3]), bindRow3)));
+        }
+        _MM_TRANSPOSE4_PS(rows[0], rows[1], rows[2], rows[3]);
+
+        SkinningMatrix& skinningMatrix = outPalette[jointIndex];
+        skinningMatrix.columns[0] = rows[0];
+        skinningMatrix.columns[1] = rows[1];
+        skinningMatrix.columns[2] = rows[2];
+        skinningMatrix.columns[3] = rows[3];
+    }
+}
+
+//-----------------------------------------------------------------------------------
+//Linear blend skinning of position and normal, four influences per vertex. Everything but pos/normal is left as-is in outVertices.
+void AnimationBatch::SkinVertices(const SkinningMatrix* palette, const Vertex_SkinnedPCTN* bindPoseVertices, Vertex_SkinnedPCTN* outVertices, unsigned int numVertices)
+{
+    __declspec(align(16)) float result[4];
+    for (unsigned int vertexIndex = 0; vertexIndex < numVertices; ++vertexIndex)
+    {
+        const Vertex_SkinnedPCTN& source = bindPoseVertices[vertexIndex];
+        const int* indices = &source.boneIndices.x;
+        const float* weights = &source.boneWeights.x;
+
+        __m128 blended0 = _mm_setzero_ps();
+        __m128 blended1 = _mm_setzero_ps();
+        __m128 blended2 = _mm_setzero_ps();
+        __m128 blended3 = _mm_setzero_ps();
+        for (int influence = 0; influence < 4; ++influence)
+        {
+            if (weights[influence] == 0.0f)
+            {
+                continue;
+            }
+            const SkinningMatrix& skinningMatrix = palette[indices[influence]];
+            __m128 weight = _mm_set1_ps(weights[influence]);
+            blended0 = _mm_add_ps(blended0, _mm_mul_ps(skinningMatrix.columns[0], weight));
+            blended1 = _mm_add_ps(blended1, _mm_mul_ps(skinningMatrix.columns[1], weight));
+            blended2 = _mm_add_ps(blended2, _mm_mul_ps(skinningMatrix.columns[2], weight));
+            blended3 = _mm_add_ps(blended3, _mm_mul_ps(skinningMatrix.columns[3], weight));
+        }
+
+        __m128 normal = _mm_add_ps(_mm_add_ps(
+            _mm_mul_ps(blended0, _mm_set1_ps(source.normal.x)),
+            _mm_mul_ps(blended1, _mm_set1_ps(source.normal.y))),
+            _mm_mul_ps(blended2, _mm_set1_ps(source.normal.z)));
+        __m128 position = _mm_add_ps(_mm_add_ps(
+            _mm_mul_ps(blended0, _mm_set1_ps(source.pos.x)),
+            _mm_mul_ps(blended1, _mm_set1_ps(source.pos.y))),
+            _mm_add_ps(_mm_mul_ps(blended2, _mm_set1_ps(source.pos.z)), blended3));
+
+        Vertex_SkinnedPCTN& destination = outVertices[vertexIndex];
+        _mm_store_ps(result, position);
+        destination.pos = Vector3(result[0], result[1], result[2]);
+        _mm_store_ps(result, normal);
+        destination.normal = Vector3(result[0], result[1], result[2]);
+        destination.normal.Normalize();
+    }
+}
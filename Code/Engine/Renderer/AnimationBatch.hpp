@@ -0,0 +1,77 @@
+#pragma once
+#include "Engine/Math/Matrix4x4.hpp"
+#include <xmmintrin.h>
+#include <vector>
+#include <atomic>
+
+class Skeleton;
+class AnimationMotion;
+struct Vertex_SkinnedPCTN;
+struct Job;
+
+//-----------------------------------------------------------------------------------
+//Skinning matrix (bone to model * model to bone) stored transposed, so a point is transformed with
+//multiply-adds of whole columns instead of horizontal dot products.
+struct SkinningMatrix
+{
+    __m128 columns[4];
+};
+
+//-----------------------------------------------------------------------------------
+//One animated instance. The skeleton and motion can be shared between many characters, the pose and palette can't.
+struct AnimatedCharacter
+{
+    Skeleton* skeleton;
+    AnimationMotion* motion;
+    float time;
+    uint32_t jointCount;
+    Matrix4x4* pose; //Bone to model, [jointCount]
+    SkinningMatrix* skinningPalette; //16 byte aligned, [jointCount]
+    const Vertex_SkinnedPCTN* bindPoseVertices;
+    Vertex_SkinnedPCTN* skinnedVertices;
+    unsigned int numVertices;
+};
+
+//-----------------------------------------------------------------------------------
+//Updates a crowd of characters at once: pose evaluation, skinning palettes, and (optionally) CPU skinning,
+//split into chunks of characters on the job system. Workers and the calling thread claim chunks off a shared counter,
+//so the caller only ever runs this batch's work while it waits, never another system's jobs.
+class AnimationBatch
+{
+public:
+    //CONSTRUCTORS//////////////////////////////////////////////////////////////////////////
+    AnimationBatch();
+    ~AnimationBatch();
+    AnimationBatch(const AnimationBatch&) = delete; //Owns every character's pose, palette and vertices
+    AnimationBatch& operator=(const AnimationBatch&) = delete;
+
+    //FUNCTIONS//////////////////////////////////////////////////////////////////////////
+    unsigned int AddCharacter(Skeleton* skeleton, AnimationMotion* motion, float startTime = 0.0f, const Vertex_SkinnedPCTN* bindPoseVertices = nullptr, unsigned int numVertices = 0);
+    void Update(float deltaSeconds, bool skinVertices = true);
+    void UpdateCharacters(unsigned int firstCharacter, unsigned int numCharacters, bool skinVertices);
+
+    //GETTERS//////////////////////////////////////////////////////////////////////////
+    inline unsigned int GetNumCharacters() const { return m_characters.size(); };
+    inline const AnimatedCharacter& GetCharacter(unsigned int index) const { return m_characters[index]; };
+
+    //STATIC FUNCTIONS//////////////////////////////////////////////////////////////////////////
+    static void CalculateSkinningPalette(const Matrix4x4* boneToModel, const Matrix4x4* modelToBone, SkinningMatrix* outPalette, uint32_t jointCount);
+    static void SkinVertices(const SkinningMatrix* palette, const Vertex_SkinnedPCTN* bindPoseVertices, Vertex_SkinnedPCTN* outVertices, unsigned int numVertices);
+
+    //CONSTANTS//////////////////////////////////////////////////////////////////////////
+    static const unsigned int CHARACTERS_PER_JOB = 8;
+
+private:
+    //FUNCTIONS//////////////////////////////////////////////////////////////////////////
+    void UpdateClaimedChunks();
+
+    //STATIC FUNCTIONS//////////////////////////////////////////////////////////////////////////
+    static void UpdateCharactersJob(Job* job);
+
+    //MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
+    std::vector<AnimatedCharacter> m_characters;
+    std::atomic<unsigned int> m_nextChunk; //Next chunk of CHARACTERS_PER_JOB characters to claim this update
+    std::atomic<int> m_jobsRemaining; //Dispatched jobs that haven't returned yet, they all touch the batch
+    unsigned int m_numChunks;
+    bool m_skinVertices;
+};
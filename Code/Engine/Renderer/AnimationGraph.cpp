@@ -0,0 +1,400 @@
+#include "Engine/Renderer/AnimationGraph.hpp"
+#include "Engine/Renderer/AnimationMotion.hpp"
+#include "Engine/Renderer/Skeleton.hpp"
+#include "Engine/Math/Quaternion.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Input/Console.hpp"
+#include "Engine/Time/Time.hpp"
+#include <string.h>
+#include <cmath>
+
+//-----------------------------------------------------------------------------------
+static AnimationMotion* CreateTestMotion(Skeleton* skeleton, float frequency, float phase)
+{
+    AnimationMotion* motion = new AnimationMotion("animgraphtest", 2.0f, 30.0f, skeleton);
+    motion->m_playbackMode = AnimationMotion::LOOP;
+    for (int jointIndex = 0; jointIndex < motion->m_jointCount; ++jointIndex)
+    {
+        Matrix4x4* jointKeyframes = motion->GetJointKeyframes(jointIndex);
+        for (uint32_t frame = 0; frame < motion->m_frameCount; ++frame)
+        {
+            float angle = sinf(((float)frame * frequency) + phase + (float)jointIndex) * 0.5f;
+            Quaternion rotation(sinf(angle * 0.5f), 0.0f, 0.0f, cosf(angle * 0.5f));
+            jointKeyframes[frame] = Quaternion::ComposeMatrix(Vector3(angle, 0.0f, (float)jointIndex), rotation, Vector3::ONE);
+        }
+    }
+    return motion;
+}
+
+//-----------------------------------------------------------------------------------
+static float MaxPoseError(const Matrix4x4* first, const Matrix4x4* second, uint32_t jointCount)
+{
+    float maxError = 0.0f;
+    for (uint32_t jointIndex = 0; jointIndex < jointCount; ++jointIndex)
+    {
+        for (int i = 0; i < 16; ++i)
+        {
+            maxError = Max(maxError, fabsf(first[jointIndex].data[i] - second[jointIndex].data[i]));
+        }
+    }
+    return maxError;
+}
+
+//-----------------------------------------------------------------------------------
+//Checks each node type against the equivalent hand-written ApplyMotionToSkeleton/MatrixLerp chain, then times a layered graph against that chain.
+CONSOLE_COMMAND(animgraphtest)
+{
+    UNUSED(args);
+    const int NUM_JOINTS = 64;
+    const int NUM_ITERATIONS = 1000;
+    const float TEST_TIME = 0.73f;
+    const float TOLERANCE = 0.0001f;
+
+    Skeleton skeleton;
+    for (int jointIndex = 0; jointIndex < NUM_JOINTS; ++jointIndex)
+    {
+        Matrix4x4 bindPose = Matrix4x4::IDENTITY;
+        Matrix4x4::MatrixMakeTranslation(&bindPose, Vector3(0.0f, 0.0f, (float)jointIndex));
+        skeleton.AddJoint(Stringf("joint%i", jointIndex).c_str(), jointIndex - 1, bindPose);
+    }
+    AnimationMotion* walk = CreateTestMotion(&skeleton, 0.2f, 0.0f);
+    AnimationMotion* run = CreateTestMotion(&skeleton, 0.35f, 1.0f);
+    AnimationMotion* wave = CreateTestMotion(&skeleton, 0.5f, 2.0f);
+    AnimationMotion* lean = CreateTestMotion(&skeleton, 0.1f, 3.0f);
+    BoneMask upperBody(NUM_JOINTS);
+    for (int jointIndex = NUM_JOINTS / 2; jointIndex < NUM_JOINTS; ++jointIndex)
+    {
+        upperBody.boneMasks[jointIndex] = 1.0f;
+    }
+
+    std::vector<Matrix4x4> graphPose(NUM_JOINTS);
+    std::vector<Matrix4x4> referencePose(NUM_JOINTS);
+    std::vector<Matrix4x4> scratchPose(NUM_JOINTS);
+    bool allPassed = true;
+    auto report = [&](const char* testName, float error)
+    {
+        bool passed = error <= TOLERANCE;
+        allPassed = allPassed && passed;
+        Console::instance->PrintLine(Stringf("%s: %s (max error %f)", testName, passed ? "PASS" : "FAIL", error), passed ? RGBA::GREEN : RGBA::RED);
+    };
+
+    {
+        AnimationGraph graph(&skeleton);
+        graph.Compile(graph.AddClip(walk));
+        graph.Evaluate(TEST_TIME, graphPose.data());
+        walk->EvaluatePose(TEST_TIME, referencePose.data(), NUM_JOINTS);
+        report("Clip", MaxPoseError(graphPose.data(), referencePose.data(), NUM_JOINTS));
+    }
+    {
+        AnimationGraph graph(&skeleton);
+        graph.Compile(graph.AddBlend(graph.AddClip(walk), graph.AddClip(run), 0.3f));
+        graph.Evaluate(TEST_TIME, graphPose.data());
+        walk->EvaluatePose(TEST_TIME, referencePose.data(), NUM_JOINTS);
+        run->EvaluatePose(TEST_TIME, scratchPose.data(), NUM_JOINTS);
+        for (int jointIndex = 0; jointIndex < NUM_JOINTS; ++jointIndex)
+        {
+            referencePose[jointIndex] = Matrix4x4::MatrixLerp(referencePose[jointIndex], scratchPose[jointIndex], 0.3f);
+        }
+        report("Blend", MaxPoseError(graphPose.data(), referencePose.data(), NUM_JOINTS));
+    }
+    {
+        AnimationGraph graph(&skeleton);
+        graph.Compile(graph.AddMaskedLayer(graph.AddClip(walk), graph.AddClip(wave), &upperBody));
+        graph.Evaluate(TEST_TIME, graphPose.data());
+        walk->ApplyMotionToSkeleton(&skeleton, TEST_TIME);
+        wave->ApplyMotionToSkeleton(&skeleton, TEST_TIME, upperBody);
+        report("Masked layer", MaxPoseError(graphPose.data(), skeleton.m_boneToModelSpace.data(), NUM_JOINTS));
+    }
+    {
+        //Additive against its own reference frame is a no-op at time 0
+        AnimationGraph graph(&skeleton);
+        graph.Compile(graph.AddAdditive(graph.AddClip(walk), graph.AddClip(lean), lean));
+        graph.Evaluate(0.0f, graphPose.data());
+        walk->EvaluatePose(0.0f, referencePose.data(), NUM_JOINTS);
+        report("Additive identity", MaxPoseError(graphPose.data(), referencePose.data(), NUM_JOINTS));
+
+        //Zero weight is also a no-op at any time
+        AnimationGraph weightedGraph(&skeleton);
+        weightedGraph.Compile(weightedGraph.AddAdditive(weightedGraph.AddClip(walk), weightedGraph.AddClip(lean), lean, 0.0f));
+        weightedGraph.Evaluate(TEST_TIME, graphPose.data());
+        walk->EvaluatePose(TEST_TIME, referencePose.data(), NUM_JOINTS);
+        report("Additive zero weight", MaxPoseError(graphPose.data(), referencePose.data(), NUM_JOINTS));
+    }
+
+    //Benchmark: locomotion blend + upper body layer, then the same with an additive lean on top
+    AnimationGraph graph(&skeleton);
+    AnimationGraph::NodeIndex locomotion = graph.AddBlend(graph.AddClip(walk), graph.AddClip(run), 0.5f);
+    graph.Compile(graph.AddMaskedLayer(locomotion, graph.AddClip(wave), &upperBody));
+    AnimationGraph additiveGraph(&skeleton);
+    AnimationGraph::NodeIndex additiveLocomotion = additiveGraph.AddBlend(additiveGraph.AddClip(walk), additiveGraph.AddClip(run), 0.5f);
+    AnimationGraph::NodeIndex additiveLayered = additiveGraph.AddMaskedLayer(additiveLocomotion, additiveGraph.AddClip(wave), &upperBody);
+    additiveGraph.Compile(additiveGraph.AddAdditive(additiveLayered, additiveGraph.AddClip(lean), lean, 0.5f));
+
+    double startSeconds = GetCurrentTimeSeconds();
+    for (int iteration = 0; iteration < NUM_ITERATIONS; ++iteration)
+    {
+        graph.Evaluate(iteration * 0.016f);
+    }
+    double graphMicroseconds = (GetCurrentTimeSeconds() - startSeconds) * 1000000.0 / NUM_ITERATIONS;
+    startSeconds = GetCurrentTimeSeconds();
+    for (int iteration = 0; iteration < NUM_ITERATIONS; ++iteration)
+    {
+        additiveGraph.Evaluate(iteration * 0.016f);
+    }
+    double additiveGraphMicroseconds = (GetCurrentTimeSeconds() - startSeconds) * 1000000.0 / NUM_ITERATIONS;
+
+    //The ad hoc equivalent of the locomotion blend + layer
+    startSeconds = GetCurrentTimeSeconds();
+    for (int iteration = 0; iteration < NUM_ITERATIONS; ++iteration)
+    {
+        float time = iteration * 0.016f;
+        walk->ApplyMotionToSkeleton(&skeleton, time);
+        std::vector<Matrix4x4> walkPose = skeleton.m_boneToModelSpace;
+        run->ApplyMotionToSkeleton(&skeleton, time);
+        for (int jointIndex = 0; jointIndex < NUM_JOINTS; ++jointIndex)
+        {
+            skeleton.m_boneToModelSpace[jointIndex] = Matrix4x4::MatrixLerp(walkPose[jointIndex], skeleton.m_boneToModelSpace[jointIndex], 0.5f);
+        }
+        wave->ApplyMotionToSkeleton(&skeleton, time, upperBody);
+    }
+    double chainMicroseconds = (GetCurrentTimeSeconds() - startSeconds) * 1000000.0 / NUM_ITERATIONS;
+
+    Console::instance->PrintLine(Stringf("Graph (3 clips, blend, layer): %u steps, %u scratch poses, %.2fus/evaluate",
+        graph.GetNumSteps(), graph.GetNumScratchPoses(), graphMicroseconds), RGBA::GREEN);
+    Console::instance->PrintLine(Stringf("Ad hoc chain (3 clips, blend, layer): %.2fus/evaluate", chainMicroseconds), RGBA::GREEN);
+    Console::instance->PrintLine(Stringf("Graph (4 clips, blend, layer, weighted additive): %u steps, %u scratch poses, %.2fus/evaluate",
+        additiveGraph.GetNumSteps(), additiveGraph.GetNumScratchPoses(), additiveGraphMicroseconds), RGBA::GREEN);
+    Console::instance->PrintLine(allPassed ? "All animation graph tests passed" : "Animation graph tests FAILED", allPassed ? RGBA::GREEN : RGBA::RED);
+
+    delete walk;
+    delete run;
+    delete wave;
+    delete lean;
+}
+
+//-----------------------------------------------------------------------------------
+AnimationGraph::AnimationGraph(Skeleton* skeleton)
+    : m_skeleton(skeleton)
+    , m_jointCount(skeleton->GetJointCount())
+    , m_scratchPoses(nullptr)
+    , m_numScratchPoses(0)
+    , m_root(INVALID_NODE)
+{
+}
+
+//-----------------------------------------------------------------------------------
+AnimationGraph::~AnimationGraph()
+{
+    for (Node& node : m_nodes)
+    {
+        delete[] node.inverseReferencePose;
+    }
+    delete[] m_scratchPoses;
+}
+
+//-----------------------------------------------------------------------------------
+AnimationGraph::NodeIndex AnimationGraph::AddNode(NodeType type, NodeIndex first, NodeIndex second, float weight)
+{
+    ASSERT_OR_DIE(first < (NodeIndex)m_nodes.size() && second < (NodeIndex)m_nodes.size(), "Animation graph inputs must be added before the nodes that use them");
+    Node node;
+    node.type = type;
+    node.inputs[0] = first;
+    node.inputs[1] = second;
+    node.weight = weight;
+    node.motion = nullptr;
+    node.playbackRate = 1.0f;
+    node.timeOffset = 0.0f;
+    node.mask = nullptr;
+    node.inverseReferencePose = nullptr;
+    m_nodes.push_back(node);
+    return m_nodes.size() - 1;
+}
+
+//-----------------------------------------------------------------------------------
+AnimationGraph::NodeIndex AnimationGraph::AddClip(AnimationMotion* motion, float playbackRate, float timeOffset)
+{
+    ASSERT_OR_DIE((uint32_t)motion->m_jointCount >= m_jointCount, "Motion has fewer joints than the graph's skeleton");
+    NodeIndex index = AddNode(CLIP, INVALID_NODE, INVALID_NODE, 1.0f);
+    Node& node = m_nodes[index];
+    node.motion = motion;
+    node.playbackRate = playbackRate;
+    node.timeOffset = timeOffset;
+    return index;
+}
+
+//-----------------------------------------------------------------------------------
+AnimationGraph::NodeIndex AnimationGraph::AddBlend(NodeIndex first, NodeIndex second, float weight)
+{
+    return AddNode(BLEND, first, second, weight);
+}
+
+//-----------------------------------------------------------------------------------
+//The additive input is applied as an offset from the first frame of referenceMotion, which is sampled once here.
+AnimationGraph::NodeIndex AnimationGraph::AddAdditive(NodeIndex base, NodeIndex additive, AnimationMotion* referenceMotion, float weight)
+{
+    ASSERT_OR_DIE((uint32_t)referenceMotion->m_jointCount >= m_jointCount, "Reference motion has fewer joints than the graph's skeleton");
+    NodeIndex index = AddNode(ADDITIVE, base, additive, weight);
+    Matrix4x4* inverseReferencePose = new Matrix4x4[m_jointCount];
+    for (uint32_t jointIndex = 0; jointIndex < m_jointCount; ++jointIndex)
+    {
+        inverseReferencePose[jointIndex] = referenceMotion->SampleJoint(jointIndex, 0, 0, 0.0f);
+        Matrix4x4::MatrixInvert(&inverseReferencePose[jointIndex]);
+    }
+    m_nodes[index].inverseReferencePose = inverseReferencePose;
+    return index;
+}
+
+//-----------------------------------------------------------------------------------
+AnimationGraph::NodeIndex AnimationGraph::AddMaskedLayer(NodeIndex base, NodeIndex layer, const BoneMask* mask, float weight)
+{
+    ASSERT_OR_DIE(mask->boneMasks.size() >= m_jointCount, "Bone mask doesn't cover every joint in the skeleton");
+    NodeIndex index = AddNode(MASKED_LAYER, base, layer, weight);
+    m_nodes[index].mask = mask;
+    return index;
+}
+
+//-----------------------------------------------------------------------------------
+void AnimationGraph::SetWeight(NodeIndex node, float weight)
+{
+    m_nodes[node].weight = weight;
+}
+
+//-----------------------------------------------------------------------------------
+void AnimationGraph::AppendSteps(NodeIndex node, std::vector<NodeIndex>& outOrder)
+{
+    for (NodeIndex orderedNode : outOrder)
+    {
+        if (orderedNode == node)
+        {
+            return;
+        }
+    }
+    const Node& currentNode = m_nodes[node];
+    for (int input = 0; input < 2; ++input)
+    {
+        if (currentNode.inputs[input] != INVALID_NODE)
+        {
+            AppendSteps(currentNode.inputs[input], outOrder);
+        }
+    }
+    outOrder.push_back(node);
+}
+
+//-----------------------------------------------------------------------------------
+//Flattens the graph under root into dependency order, then hands out scratch poses like registers:
+//a pose goes back on the free list as soon as its last reader has run.
+void AnimationGraph::Compile(NodeIndex root)
+{
+    ASSERT_OR_DIE(root >= 0 && root < (NodeIndex)m_nodes.size(), "Invalid root node for animation graph");
+    m_root = root;
+
+    std::vector<NodeIndex> order;
+    AppendSteps(root, order);
+
+    std::vector<int> remainingReads(m_nodes.size(), 0);
+    for (NodeIndex node : order)
+    {
+        for (int input = 0; input < 2; ++input)
+        {
+            if (m_nodes[node].inputs[input] != INVALID_NODE)
+            {
+                ++remainingReads[m_nodes[node].inputs[input]];
+            }
+        }
+    }
+
+    std::vector<int> nodeOutputPose(m_nodes.size(), -1);
+    std::vector<int> freePoses;
+    m_numScratchPoses = 0;
+    m_steps.clear();
+    for (NodeIndex node : order)
+    {
+        Step step;
+        step.node = node;
+        if (freePoses.empty())
+        {
+            step.outputPose = m_numScratchPoses++;
+        }
+        else
+        {
+            step.outputPose = freePoses.back();
+            freePoses.pop_back();
+        }
+        for (int input = 0; input < 2; ++input)
+        {
+            NodeIndex inputNode = m_nodes[node].inputs[input];
+            step.inputPoses[input] = (inputNode != INVALID_NODE) ? nodeOutputPose[inputNode] : -1;
+            if (inputNode != INVALID_NODE && --remainingReads[inputNode] == 0)
+            {
+                freePoses.push_back(nodeOutputPose[inputNode]);
+            }
+        }
+        nodeOutputPose[node] = step.outputPose;
+        m_steps.push_back(step);
+    }
+
+    delete[] m_scratchPoses;
+    m_scratchPoses = new Matrix4x4[m_numScratchPoses * m_jointCount];
+}
+
+//-----------------------------------------------------------------------------------
+void AnimationGraph::Evaluate(float time)
+{
+    Evaluate(time, m_skeleton->m_boneToModelSpace.data());
+}
+
+//-----------------------------------------------------------------------------------
+void AnimationGraph::Evaluate(float time, Matrix4x4* outPose)
+{
+    ASSERT_OR_DIE(m_root != INVALID_NODE, "Animation graph evaluated before being compiled");
+    for (const Step& step : m_steps)
+    {
+        const Node& node = m_nodes[step.node];
+        Matrix4x4* output = GetScratchPose(step.outputPose);
+        const Matrix4x4* first = (step.inputPoses[0] >= 0) ? GetScratchPose(step.inputPoses[0]) : nullptr;
+        const Matrix4x4* second = (step.inputPoses[1] >= 0) ? GetScratchPose(step.inputPoses[1]) : nullptr;
+        float weight = MathUtils::Clamp(node.weight, 0.0f, 1.0f);
+
+        switch (node.type)
+        {
+        case CLIP:
+            node.motion->EvaluatePose((time * node.playbackRate) + node.timeOffset, output, m_jointCount);
+            break;
+        case BLEND:
+            for (uint32_t jointIndex = 0; jointIndex < m_jointCount; ++jointIndex)
+            {
+                output[jointIndex] = Matrix4x4::MatrixLerp(first[jointIndex], second[jointIndex], weight);
+            }
+            break;
+        case MASKED_LAYER:
+            for (uint32_t jointIndex = 0; jointIndex < m_jointCount; ++jointIndex)
+            {
+                float jointWeight = weight * node.mask->boneMasks[jointIndex];
+                output[jointIndex] = (jointWeight > 0.0f) ? Matrix4x4::MatrixLerp(first[jointIndex], second[jointIndex], jointWeight) : first[jointIndex];
+            }
+            break;
+        case ADDITIVE:
+            for (uint32_t jointIndex = 0; jointIndex < m_jointCount; ++jointIndex)
+            {
+                //Offset from the reference pose to the additive pose, in the joint's own space, then applied on top of the base
+                Matrix4x4 delta = second[jointIndex] * node.inverseReferencePose[jointIndex];
+                if (weight < 1.0f)
+                {
+                    Vector3 translation, scale;
+                    Quaternion rotation;
+                    Quaternion::DecomposeMatrix(delta, translation, rotation, scale);
+                    rotation = Quaternion::Nlerp(Quaternion::IDENTITY, rotation, weight);
+                    delta = Quaternion::ComposeMatrix(translation * weight, rotation, MathUtils::Lerp(weight, Vector3::ONE, scale));
+                }
+                output[jointIndex] = delta * first[jointIndex];
+            }
+            break;
+        default:
+            ERROR_AND_DIE("Unknown animation graph node type");
+        }
+    }
+
+    memcpy(outPose, GetScratchPose(m_steps.back().outputPose), sizeof(Matrix4x4) * m_jointCount);
+}
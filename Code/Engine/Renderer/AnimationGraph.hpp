@@ -0,0 +1,84 @@
+#pragma once
+#include "Engine/Math/Matrix4x4.hpp"
+#include <vector>
+
+class Skeleton;
+class AnimationMotion;
+struct BoneMask;
+
+//-----------------------------------------------------------------------------------
+//Blend tree over AnimationMotions. Nodes are added bottom up, then Compile() flattens everything reachable from the root
+//into a linear list of steps and assigns each step's output to a scratch pose, reusing scratch poses once nothing reads them.
+//Evaluate() then walks that list with no allocations and writes the final pose into the skeleton once.
+class AnimationGraph
+{
+public:
+    //TYPEDEFS//////////////////////////////////////////////////////////////////////////
+    typedef int NodeIndex;
+
+    //ENUMS//////////////////////////////////////////////////////////////////////////
+    enum NodeType
+    {
+        CLIP,
+        BLEND,
+        ADDITIVE,
+        MASKED_LAYER,
+        NUM_NODE_TYPES
+    };
+
+    //CONSTRUCTORS//////////////////////////////////////////////////////////////////////////
+    AnimationGraph(Skeleton* skeleton);
+    ~AnimationGraph();
+
+    //FUNCTIONS//////////////////////////////////////////////////////////////////////////
+    NodeIndex AddClip(AnimationMotion* motion, float playbackRate = 1.0f, float timeOffset = 0.0f);
+    NodeIndex AddBlend(NodeIndex first, NodeIndex second, float weight);
+    NodeIndex AddAdditive(NodeIndex base, NodeIndex additive, AnimationMotion* referenceMotion, float weight = 1.0f);
+    NodeIndex AddMaskedLayer(NodeIndex base, NodeIndex layer, const BoneMask* mask, float weight = 1.0f);
+    void SetWeight(NodeIndex node, float weight);
+    void Compile(NodeIndex root);
+    void Evaluate(float time);
+    void Evaluate(float time, Matrix4x4* outPose);
+
+    //GETTERS//////////////////////////////////////////////////////////////////////////
+    inline unsigned int GetNumSteps() const { return m_steps.size(); };
+    inline unsigned int GetNumScratchPoses() const { return m_numScratchPoses; };
+
+    //CONSTANTS//////////////////////////////////////////////////////////////////////////
+    static const NodeIndex INVALID_NODE = -1;
+
+private:
+    //STRUCTS//////////////////////////////////////////////////////////////////////////
+    struct Node
+    {
+        NodeType type;
+        NodeIndex inputs[2];
+        float weight;
+        AnimationMotion* motion;
+        float playbackRate;
+        float timeOffset;
+        const BoneMask* mask;
+        Matrix4x4* inverseReferencePose; //Additive only, [jointCount]
+    };
+
+    struct Step
+    {
+        NodeIndex node;
+        int outputPose;
+        int inputPoses[2];
+    };
+
+    //FUNCTIONS//////////////////////////////////////////////////////////////////////////
+    NodeIndex AddNode(NodeType type, NodeIndex first, NodeIndex second, float weight);
+    void AppendSteps(NodeIndex node, std::vector<NodeIndex>& outOrder);
+    inline Matrix4x4* GetScratchPose(int poseIndex) { return m_scratchPoses + (poseIndex * m_jointCount); };
+
+    //MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
+    Skeleton* m_skeleton;
+    uint32_t m_jointCount;
+    std::vector<Node> m_nodes;
+    std::vector<Step> m_steps;
+    Matrix4x4* m_scratchPoses;
+    unsigned int m_numScratchPoses;
+    NodeIndex m_root;
+};
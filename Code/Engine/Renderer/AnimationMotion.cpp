@@ -1,11 +1,15 @@
 #include "Engine/Renderer/AnimationMotion.hpp"
 #include "Engine/Renderer/Skeleton.hpp"
+#include "Engine/Renderer/CompressedMotion.hpp"
 #include "Engine/Math/MathUtils.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
 #include "Engine/Input/BinaryReader.hpp"
 #include "Engine/Input/BinaryWriter.hpp"
 #include "Engine/Input/Console.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Time/Time.hpp"
 #include <vector>
+#include <xmmintrin.h>
 
 extern Skeleton* g_loadedSkeleton;
 AnimationMotion* g_loadedMotion = nullptr;
@@ -71,6 +75,115 @@ CONSOLE_COMMAND(combinemotions)
     g_loadedMotions->at(1)->ReadFromFile(filename1.c_str());
 }
 
+//-----------------------------------------------------------------------------------
+CONSOLE_COMMAND(compressmotion)
+{
+    if (!(args.HasArgs(0) || args.HasArgs(2) || args.HasArgs(3)))
+    {
+        Console::instance->PrintLine("compressMotion <rotationToleranceDegrees> <translationTolerance> <outputFilename>", RGBA::RED);
+        return;
+    }
+    if (!g_loadedMotion || g_loadedMotion->m_storageMode != AnimationMotion::MATRIX_KEYFRAMES)
+    {
+        Console::instance->PrintLine("Error: Load an uncompressed motion first with loadMotion.", RGBA::RED);
+        return;
+    }
+
+    MotionCompressionSettings settings;
+    if (!args.HasArgs(0))
+    {
+        settings.rotationToleranceRadians = args.GetFloatArgument(0) * (3.14159265f / 180.0f);
+        settings.translationTolerance = args.GetFloatArgument(1);
+    }
+
+    AnimationMotion* motion = g_loadedMotion;
+    uint32_t jointCount = static_cast<uint32_t>(motion->m_jointCount);
+    double startSeconds = GetCurrentTimeSeconds();
+    CompressedMotion* compressed = CompressedMotion::CreateFromKeyframes(motion->m_motionName.c_str(), motion->m_keyframes, motion->m_frameCount, 
+        jointCount, motion->m_totalLengthSeconds, motion->m_frameRate, settings);
+    double compressMilliseconds = (GetCurrentTimeSeconds() - startSeconds) * 1000.0;
+
+    //Error bounds, measured on every original frame
+    float maxRotationErrorRadians = 0.0f;
+    float maxTranslationError = 0.0f;
+    float maxScaleError = 0.0f;
+    for (uint32_t jointIndex = 0; jointIndex < jointCount; ++jointIndex)
+    {
+        Matrix4x4* jointKeyframes = motion->GetJointKeyframes(jointIndex);
+        for (uint32_t frame = 0; frame < motion->m_frameCount; ++frame)
+        {
+            Vector3 originalTranslation, originalScale, sampledTranslation, sampledScale;
+            Quaternion originalRotation, sampledRotation;
+            Quaternion::DecomposeMatrix(jointKeyframes[frame], originalTranslation, originalRotation, originalScale);
+            compressed->SampleJoint(jointIndex, static_cast<float>(frame), sampledTranslation, sampledRotation, sampledScale);
+            maxRotationErrorRadians = Max(maxRotationErrorRadians, Quaternion::AngleBetweenRadians(originalRotation, sampledRotation));
+            maxTranslationError = Max(maxTranslationError, (originalTranslation - sampledTranslation).CalculateMagnitude());
+            Vector3 scaleDifference = originalScale - sampledScale;
+            maxScaleError = Max(maxScaleError, Max(fabsf(scaleDifference.x), Max(fabsf(scaleDifference.y), fabsf(scaleDifference.z))));
+        }
+    }
+
+    //Decompression cost of a full pose against the raw matrix lerp
+    const int NUM_BENCHMARK_POSES = 1000;
+    Matrix4x4 sink = Matrix4x4::IDENTITY;
+    float lastFrame = static_cast<float>(motion->m_frameCount - 1);
+    startSeconds = GetCurrentTimeSeconds();
+    for (int pose = 0; pose < NUM_BENCHMARK_POSES; ++pose)
+    {
+        float frame = lastFrame * (static_cast<float>(pose) / static_cast<float>(NUM_BENCHMARK_POSES));
+        uint32_t frame0 = static_cast<uint32_t>(frame);
+        uint32_t frame1 = (frame0 + 1 < motion->m_frameCount) ? frame0 + 1 : frame0;
+        for (uint32_t jointIndex = 0; jointIndex < jointCount; ++jointIndex)
+        {
+            Matrix4x4* jointKeyframes = motion->GetJointKeyframes(jointIndex);
+            sink.data[jointIndex & 15] += Matrix4x4::MatrixLerp(jointKeyframes[frame0], jointKeyframes[frame1], frame - frame0).data[3];
+        }
+    }
+    double matrixMicroseconds = (GetCurrentTimeSeconds() - startSeconds) * 1000000.0 / NUM_BENCHMARK_POSES;
+    startSeconds = GetCurrentTimeSeconds();
+    for (int pose = 0; pose < NUM_BENCHMARK_POSES; ++pose)
+    {
+        float frame = lastFrame * (static_cast<float>(pose) / static_cast<float>(NUM_BENCHMARK_POSES));
+        for (uint32_t jointIndex = 0; jointIndex < jointCount; ++jointIndex)
+        {
+            sink.data[jointIndex & 15] += compressed->SampleJoint(jointIndex, frame).data[3];
+        }
+    }
+    double compressedMicroseconds = (GetCurrentTimeSeconds() - startSeconds) * 1000000.0 / NUM_BENCHMARK_POSES;
+
+    unsigned int originalBytes = motion->m_frameCount * jointCount * sizeof(Matrix4x4);
+    unsigned int compressedBytes = static_cast<unsigned int>(compressed->GetSizeBytes());
+    Console::instance->PrintLine(Stringf("Compressed %s in %.2fms: %u bytes -> %u bytes (%.1f:1), %u keys for %u joints x %u frames", 
+        motion->m_motionName.c_str(), compressMilliseconds, originalBytes, compressedBytes, (float)originalBytes / (float)compressedBytes,
+        compressed->GetTotalKeyCount(), jointCount, motion->m_frameCount), RGBA::GREEN);
+    Console::instance->PrintLine(Stringf("Pose sample: matrix %.2fus, compressed %.2fus (checksum %f)", 
+        matrixMicroseconds, compressedMicroseconds, sink.data[0]), RGBA::GREEN);
+
+    //Rotations are quantized before they're reduced, so their bound is the tolerance plus the encoding's own error
+    bool isWithinTolerance = maxRotationErrorRadians <= settings.rotationToleranceRadians + CompressedMotion::QUANTIZATION_ERROR_RADIANS
+        && maxTranslationError <= settings.translationTolerance
+        && maxScaleError <= settings.scaleTolerance;
+    Console::instance->PrintLine(Stringf("Max error: rotation %.4f degrees, translation %.5f units, scale %.5f", 
+        maxRotationErrorRadians * (180.0f / 3.14159265f), maxTranslationError, maxScaleError), isWithinTolerance ? RGBA::GREEN : RGBA::RED);
+    if (!isWithinTolerance)
+    {
+        Console::instance->PrintLine(Stringf("FAIL: Error is past the tolerance (rotation %.4f degrees, translation %.5f units, scale %.5f), nothing was written", 
+            (settings.rotationToleranceRadians + CompressedMotion::QUANTIZATION_ERROR_RADIANS) * (180.0f / 3.14159265f), settings.translationTolerance, 
+            settings.scaleTolerance), RGBA::RED);
+        delete compressed;
+        return;
+    }
+
+    //The loaded motion stays as it was, the compressed copy only reaches disk if asked for; loadMotion on that file plays it compressed
+    if (args.HasArgs(3))
+    {
+        std::string filename = args.GetStringArgument(2);
+        bool didWrite = compressed->WriteToFile(filename.c_str());
+        Console::instance->PrintLine(didWrite ? Stringf("Wrote the compressed copy to %s", filename.c_str()) : Stringf("Error: Couldn't write %s", filename.c_str()), didWrite ? RGBA::GREEN : RGBA::RED);
+    }
+    delete compressed;
+}
+
 //-----------------------------------------------------------------------------------
 AnimationMotion::AnimationMotion(const std::string& motionName, float timeSpan, float framerate, Skeleton* skeleton)
     : m_motionName(motionName)
@@ -80,7 +193,9 @@ AnimationMotion::AnimationMotion(const std::string& motionName, float timeSpan,
     , m_frameTime(1.0f/framerate)
     , m_frameRate(framerate)
     , m_playbackMode(PLAYBACK_MODE::PAUSED)
+    , m_storageMode(STORAGE_MODE::MATRIX_KEYFRAMES)
     , m_keyframes(new Matrix4x4[m_frameCount * m_jointCount])
+    , m_compressedMotion(nullptr)
     , m_lastTime(0.0f)
 {
 }
@@ -89,6 +204,7 @@ AnimationMotion::AnimationMotion(const std::string& motionName, float timeSpan,
 AnimationMotion::~AnimationMotion()
 {
     delete[] m_keyframes;
+    delete m_compressedMotion;
 }
 
 //-----------------------------------------------------------------------------------
@@ -118,25 +234,43 @@ void AnimationMotion::GetFrameIndicesWithBlend(uint32_t& outFrameIndex0, uint32_
 }
 
 //-----------------------------------------------------------------------------------
-Matrix4x4* AnimationMotion::GetJointKeyframes(uint32_t jointIndex)
+Matrix4x4* AnimationMotion::GetJointKeyframes(uint32_t jointIndex) const
 {
     return m_keyframes + (m_frameCount * jointIndex);
 }
 
 //-----------------------------------------------------------------------------------
-void AnimationMotion::ApplyMotionToSkeleton(Skeleton* skeleton, float time)
+Matrix4x4 AnimationMotion::SampleJoint(uint32_t jointIndex, uint32_t frame0, uint32_t frame1, float blend)
 {
-    uint32_t frame0 = 0;
-    uint32_t frame1 = 0;
-    float blend;
+    if (m_storageMode == STORAGE_MODE::COMPRESSED_TRACKS)
+    {
+        float frame = static_cast<float>(frame0) + ((static_cast<float>(frame1) - static_cast<float>(frame0)) * blend);
+        return m_compressedMotion->SampleJoint(jointIndex, frame);
+    }
+    Matrix4x4* jointKeyframes = GetJointKeyframes(jointIndex);
+    return Matrix4x4::MatrixLerp(jointKeyframes[frame0], jointKeyframes[frame1], blend);
+}
 
-    if (m_playbackMode == PLAYBACK_MODE::PAUSED)
+//-----------------------------------------------------------------------------------
+void AnimationMotion::Compress(const MotionCompressionSettings& settings)
+{
+    if (m_storageMode == STORAGE_MODE::COMPRESSED_TRACKS)
     {
-        time = m_lastTime;
+        return;
     }
-    else
+    m_compressedMotion = CompressedMotion::CreateFromKeyframes(m_motionName.c_str(), m_keyframes, m_frameCount, m_jointCount, m_totalLengthSeconds, m_frameRate, settings);
+    m_storageMode = STORAGE_MODE::COMPRESSED_TRACKS;
+    delete[] m_keyframes;
+    m_keyframes = nullptr;
+}
+
+//-----------------------------------------------------------------------------------
+//Maps an absolute time onto the motion's timeline according to the playback mode. Doesn't touch m_lastTime, so it's safe to call from worker threads.
+float AnimationMotion::CalculatePlaybackTime(float time) const
+{
+    if (m_playbackMode == PLAYBACK_MODE::PAUSED)
     {
-        m_lastTime = fmodf(time, m_totalLengthSeconds);
+        time = m_lastTime;
     }
 
     if (m_playbackMode == PLAYBACK_MODE::CLAMP)
@@ -168,83 +302,79 @@ void AnimationMotion::ApplyMotionToSkeleton(Skeleton* skeleton, float time)
                 time = m_totalLengthSeconds - fmodf(time, m_totalLengthSeconds);
             }
         }
-    } 
-
-    GetFrameIndicesWithBlend(frame0, frame1, blend, time);
-
-    uint32_t jointCount = skeleton->GetJointCount();
-    for (uint32_t jointIndex = 0; jointIndex < jointCount; ++jointIndex)
-    {
-        Matrix4x4* jointKeyframes = GetJointKeyframes(jointIndex);
-        Matrix4x4& matrix0 = jointKeyframes[frame0];
-        Matrix4x4& matrix1 = jointKeyframes[frame1];
-
-        Matrix4x4 newModel = Matrix4x4::MatrixLerp(matrix0, matrix1, blend);
-
-        //Needs to set bone to model matrix
-        //(Or set your matrix tree's world to this, and set
-        //bone to model on Skelelton world's array
-        skeleton->m_boneToModelSpace[jointIndex] = newModel; //SetJointWorldTransform(jointIndex, newModel);
     }
+    return time;
 }
 
 //-----------------------------------------------------------------------------------
-void AnimationMotion::ApplyMotionToSkeleton(Skeleton* skeleton, float time, BoneMask& mask)
+//Writes the bone to model matrices for the given time into outBoneToModel. Read-only on the motion, so many characters can share one.
+void AnimationMotion::EvaluatePose(float time, Matrix4x4* outBoneToModel, uint32_t jointCount)
 {
     uint32_t frame0 = 0;
     uint32_t frame1 = 0;
     float blend;
+    GetFrameIndicesWithBlend(frame0, frame1, blend, CalculatePlaybackTime(time));
 
-    if (m_playbackMode == PLAYBACK_MODE::PAUSED)
-    {
-        time = m_lastTime;
-    }
-    else
+    if (m_storageMode == STORAGE_MODE::COMPRESSED_TRACKS)
     {
-        m_lastTime = fmodf(time, m_totalLengthSeconds);
+        for (uint32_t jointIndex = 0; jointIndex < jointCount; ++jointIndex)
+        {
+            outBoneToModel[jointIndex] = SampleJoint(jointIndex, frame0, frame1, blend);
+        }
+        return;
     }
 
-    if (m_playbackMode == PLAYBACK_MODE::CLAMP)
+    //Same result as MatrixLerp (lerp the basis and translation, identity bottom row), 4 floats at a time.
+    __m128 blend1 = _mm_set1_ps(blend);
+    __m128 blend0 = _mm_set1_ps(1.0f - blend);
+    __m128 bottomRow = _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f);
+    for (uint32_t jointIndex = 0; jointIndex < jointCount; ++jointIndex)
     {
-        time = fmodf(time, m_totalLengthSeconds);
-        if (time > m_totalLengthSeconds)
+        const Matrix4x4* jointKeyframes = GetJointKeyframes(jointIndex);
+        const float* matrix0 = jointKeyframes[frame0].data;
+        const float* matrix1 = jointKeyframes[frame1].data;
+        float* output = outBoneToModel[jointIndex].data;
+        for (int row = 0; row < 12; row += 4)
         {
-            time = m_totalLengthSeconds;
+            __m128 lerped = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(matrix0 + row), blend0), _mm_mul_ps(_mm_loadu_ps(matrix1 + row), blend1));
+            _mm_storeu_ps(output + row, lerped);
         }
+        _mm_storeu_ps(output + 12, bottomRow);
     }
-    else if (m_playbackMode == PLAYBACK_MODE::LOOP)
+}
+
+//-----------------------------------------------------------------------------------
+void AnimationMotion::ApplyMotionToSkeleton(Skeleton* skeleton, float time)
+{
+    if (m_playbackMode != PLAYBACK_MODE::PAUSED)
     {
-        if (time > m_totalLengthSeconds)
-        {
-            time = fmodf(time, m_totalLengthSeconds);
-        }
+        m_lastTime = fmodf(time, m_totalLengthSeconds);
     }
-    else if (m_playbackMode == PLAYBACK_MODE::PING_PONG)
+
+    //Needs to set bone to model matrix
+    //(Or set your matrix tree's world to this, and set
+    //bone to model on Skelelton world's array
+    EvaluatePose(time, skeleton->m_boneToModelSpace.data(), skeleton->GetJointCount());
+}
+
+//-----------------------------------------------------------------------------------
+void AnimationMotion::ApplyMotionToSkeleton(Skeleton* skeleton, float time, BoneMask& mask)
+{
+    uint32_t frame0 = 0;
+    uint32_t frame1 = 0;
+    float blend;
+
+    if (m_playbackMode != PLAYBACK_MODE::PAUSED)
     {
-        if (time > m_totalLengthSeconds)
-        {
-            float animTime = fmodf(time, m_totalLengthSeconds * 2.0f) - m_totalLengthSeconds;
-            if (animTime > 0.0f)
-            {
-                time = fmodf(time, m_totalLengthSeconds);
-            }
-            else if (animTime < 0.0f)
-            {
-                time = m_totalLengthSeconds - fmodf(time, m_totalLengthSeconds);
-            }
-        }
+        m_lastTime = fmodf(time, m_totalLengthSeconds);
     }
 
-    GetFrameIndicesWithBlend(frame0, frame1, blend, time);
+    GetFrameIndicesWithBlend(frame0, frame1, blend, CalculatePlaybackTime(time));
 
     uint32_t jointCount = skeleton->GetJointCount();
     for (uint32_t jointIndex = 0; jointIndex < jointCount; ++jointIndex)
     {
-        Matrix4x4* jointKeyframes = GetJointKeyframes(jointIndex);
-        Matrix4x4& matrix0 = jointKeyframes[frame0];
-        Matrix4x4& matrix1 = jointKeyframes[frame1];
-
-        Matrix4x4 newModel = Matrix4x4::MatrixLerp(matrix0, matrix1, blend);
+        Matrix4x4 newModel = SampleJoint(jointIndex, frame0, frame1, blend);
         Matrix4x4 initialPosition = skeleton->m_boneToModelSpace[jointIndex];
         Matrix4x4 finalModel = Matrix4x4::MatrixLerp(initialPosition, newModel, mask.boneMasks[jointIndex]);
 
@@ -258,6 +388,11 @@ void AnimationMotion::ApplyMotionToSkeleton(Skeleton* skeleton, float time, Bone
 //-----------------------------------------------------------------------------------
 void AnimationMotion::WriteToFile(const char* filename)
 {
+    if (m_storageMode == STORAGE_MODE::COMPRESSED_TRACKS)
+    {
+        ASSERT_OR_DIE(m_compressedMotion->WriteToFile(filename), "File Write failed!");
+        return;
+    }
     BinaryFileWriter writer;
     ASSERT_OR_DIE(writer.Open(filename), "File Open failed!");
     {
@@ -278,6 +413,7 @@ void AnimationMotion::WriteToStream(IBinaryWriter& writer)
     //Joint count
     //Keyframes
 
+    ASSERT_OR_DIE(m_storageMode == STORAGE_MODE::MATRIX_KEYFRAMES, "Compressed motions are written as a single block with WriteToFile");
     writer.Write<uint32_t>(FILE_VERSION);
     writer.Write<uint32_t>(m_frameCount);
     writer.Write<float>(m_totalLengthSeconds);
@@ -320,12 +456,14 @@ void AnimationMotion::ReadFromStream(IBinaryReader& reader)
     ASSERT_OR_DIE(reader.Read<float>(m_frameTime), "Failed to read frame count");
     const char* motionName = nullptr;
     reader.ReadString(motionName, 64);
-    m_motionName = std::string(motionName);
+    m_motionName = motionName ? std::string(motionName) : std::string();
+    delete[] motionName;
     ASSERT_OR_DIE(reader.Read<int>(m_jointCount), "Failed to read frame count");
     ASSERT_OR_DIE(reader.Read<PLAYBACK_MODE>(m_playbackMode), "Failed to read playback mode");
     ASSERT_OR_DIE(reader.Read<float>(m_lastTime), "Failed to read last time");
 
     unsigned int numKeyframes = m_frameCount * m_jointCount; 
+    delete[] m_keyframes;
     m_keyframes = new Matrix4x4[numKeyframes];
     for (unsigned int index = 0; index < numKeyframes; ++index)
     {
@@ -341,6 +479,28 @@ void AnimationMotion::ReadFromStream(IBinaryReader& reader)
 //-----------------------------------------------------------------------------------
 void AnimationMotion::ReadFromFile(const char* filename)
 {
+    //Whatever this motion held before is replaced, in either storage mode
+    delete[] m_keyframes;
+    m_keyframes = nullptr;
+    delete m_compressedMotion;
+    m_compressedMotion = nullptr;
+    m_storageMode = STORAGE_MODE::MATRIX_KEYFRAMES;
+
+    //Compressed motions are a single block that is used as-is, no per-field parsing.
+    if (CompressedMotion::IsCompressedMotionFile(filename))
+    {
+        m_compressedMotion = CompressedMotion::CreateFromFile(filename);
+        ASSERT_OR_DIE(m_compressedMotion, "Failed to load compressed motion!");
+        const CompressedMotionHeader* header = m_compressedMotion->GetHeader();
+        m_storageMode = STORAGE_MODE::COMPRESSED_TRACKS;
+        m_frameCount = header->frameCount;
+        m_jointCount = header->jointCount;
+        m_totalLengthSeconds = header->totalLengthSeconds;
+        m_frameRate = header->frameRate;
+        m_frameTime = 1.0f / header->frameRate;
+        m_motionName = std::string(header->motionName);
+        return;
+    }
     BinaryFileReader reader;
     ASSERT_OR_DIE(reader.Open(filename), "File Open failed!");
     {
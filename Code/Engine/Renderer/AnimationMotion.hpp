@@ -4,6 +4,8 @@
 #include <vector>
 
 class Skeleton;
+class CompressedMotion;
+struct MotionCompressionSettings;
 class IBinaryReader;
 class IBinaryWriter;
 
@@ -30,14 +32,25 @@ public:
         NUM_PLAYBACK_MODES
     };
 
+    enum STORAGE_MODE
+    {
+        MATRIX_KEYFRAMES,
+        COMPRESSED_TRACKS,
+        NUM_STORAGE_MODES
+    };
+
     //CONSTRUCTORS//////////////////////////////////////////////////////////////////////////
-    AnimationMotion() : m_playbackMode(PAUSED) {};
+    AnimationMotion() : m_keyframes(nullptr), m_playbackMode(PAUSED), m_storageMode(MATRIX_KEYFRAMES), m_compressedMotion(nullptr), m_lastTime(0.0f) {};
     AnimationMotion(const std::string& motionName, float timeSpan, float framerate, Skeleton* skeleton);
     ~AnimationMotion();
 
     //FUNCTIONS//////////////////////////////////////////////////////////////////////////
     void GetFrameIndicesWithBlend(uint32_t& outFrameIndex0, uint32_t& outFrameIndex1, float& outBlend, float inTime);
-    Matrix4x4* GetJointKeyframes(uint32_t jointIndex);
+    Matrix4x4* GetJointKeyframes(uint32_t jointIndex) const;
+    Matrix4x4 SampleJoint(uint32_t jointIndex, uint32_t frame0, uint32_t frame1, float blend);
+    void Compress(const MotionCompressionSettings& settings);
+    float CalculatePlaybackTime(float time) const;
+    void EvaluatePose(float time, Matrix4x4* outBoneToModel, uint32_t jointCount);
     void ApplyMotionToSkeleton(Skeleton* skeleton, float time);
     void ApplyMotionToSkeleton(Skeleton* skeleton, float time, BoneMask& boneMask);
     
@@ -57,6 +70,9 @@ public:
     //2D array of matrices, stride of sizeof(matrix4x4) * joint count
     Matrix4x4* m_keyframes;// [jointCount][frameCount];
     PLAYBACK_MODE m_playbackMode;
+    STORAGE_MODE m_storageMode;
+    //Only valid in COMPRESSED_TRACKS mode, m_keyframes is released once the motion is compressed.
+    CompressedMotion* m_compressedMotion;
     float m_lastTime;
 
     const unsigned int FILE_VERSION = 1;
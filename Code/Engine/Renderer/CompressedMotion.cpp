@@ -0,0 +1,426 @@
+#include "Engine/Renderer/CompressedMotion.hpp"
+#include "Engine/Math/Matrix4x4.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Input/InputOutputUtils.hpp"
+#include "Engine/Input/BinaryReader.hpp"
+#include <cmath>
+#include <string.h>
+
+static const float QUANTIZED_COMPONENT_MAX_VALUE = 32767.0f;
+static const uint16_t QUANTIZED_VALUE_MASK = 0x7FFF;
+static const uint16_t QUANTIZED_INDEX_BIT = 0x8000;
+
+//Half a step on each stored component moves the quaternion by under 6e-5, about 1.2e-4 radians of angle; rounded up for float slop
+const float CompressedMotion::QUANTIZATION_ERROR_RADIANS = 0.0002f;
+
+//-----------------------------------------------------------------------------------
+static inline uint16_t QuantizeComponent(float value)
+{
+    float normalized = (value + Quaternion::SMALLEST_THREE_RANGE) / (2.0f * Quaternion::SMALLEST_THREE_RANGE);
+    normalized = MathUtils::Clamp(normalized, 0.0f, 1.0f);
+    return static_cast<uint16_t>((normalized * QUANTIZED_COMPONENT_MAX_VALUE) + 0.5f);
+}
+
+//-----------------------------------------------------------------------------------
+static inline float DequantizeComponent(uint16_t value)
+{
+    float normalized = static_cast<float>(value & QUANTIZED_VALUE_MASK) / QUANTIZED_COMPONENT_MAX_VALUE;
+    return (normalized * 2.0f * Quaternion::SMALLEST_THREE_RANGE) - Quaternion::SMALLEST_THREE_RANGE;
+}
+
+//-----------------------------------------------------------------------------------
+QuantizedQuaternion QuantizedQuaternion::Encode(const Quaternion& rotation)
+{
+    float smallestThree[3];
+    unsigned int largestIndex = Quaternion::ToSmallestThree(rotation, smallestThree);
+    QuantizedQuaternion result;
+    for (int i = 0; i < 3; ++i)
+    {
+        result.components[i] = QuantizeComponent(smallestThree[i]);
+    }
+    if (largestIndex & 2)
+    {
+        result.components[0] |= QUANTIZED_INDEX_BIT;
+    }
+    if (largestIndex & 1)
+    {
+        result.components[1] |= QUANTIZED_INDEX_BIT;
+    }
+    return result;
+}
+
+//-----------------------------------------------------------------------------------
+Quaternion QuantizedQuaternion::Decode() const
+{
+    unsigned int largestIndex = ((components[0] & QUANTIZED_INDEX_BIT) ? 2 : 0) | ((components[1] & QUANTIZED_INDEX_BIT) ? 1 : 0);
+    const float smallestThree[3] = { DequantizeComponent(components[0]), DequantizeComponent(components[1]), DequantizeComponent(components[2]) };
+    return Quaternion::FromSmallestThree(largestIndex, smallestThree);
+}
+
+//-----------------------------------------------------------------------------------
+//Greedy reduction: from the last kept key, push the next key out as far as it can go while every skipped frame
+//can still be rebuilt (within tolerance) by interpolating between the two. First and last frames are always kept.
+template <typename SampleType, typename LerpFunction, typename ErrorFunction>
+static void ReduceTrack(const std::vector<SampleType>& samples, std::vector<uint32_t>& outKeptFrames, float tolerance, LerpFunction lerp, ErrorFunction error)
+{
+    outKeptFrames.clear();
+    uint32_t numSamples = static_cast<uint32_t>(samples.size());
+    outKeptFrames.push_back(0);
+    if (numSamples == 1)
+    {
+        return;
+    }
+
+    //A constant track collapses to a single key
+    bool isConstant = true;
+    for (uint32_t i = 1; i < numSamples && isConstant; ++i)
+    {
+        isConstant = error(samples[0], samples[i]) <= tolerance;
+    }
+    if (isConstant)
+    {
+        return;
+    }
+
+    uint32_t anchor = 0;
+    while (anchor < numSamples - 1)
+    {
+        uint32_t end = anchor + 1;
+        while (end + 1 < numSamples)
+        {
+            uint32_t candidate = end + 1;
+            bool isCandidateValid = true;
+            for (uint32_t skipped = anchor + 1; skipped < candidate && isCandidateValid; ++skipped)
+            {
+                float fraction = static_cast<float>(skipped - anchor) / static_cast<float>(candidate - anchor);
+                isCandidateValid = error(lerp(samples[anchor], samples[candidate], fraction), samples[skipped]) <= tolerance;
+            }
+            if (!isCandidateValid)
+            {
+                break;
+            }
+            end = candidate;
+        }
+        outKeptFrames.push_back(end);
+        anchor = end;
+    }
+}
+
+//-----------------------------------------------------------------------------------
+static inline uint32_t AlignTo4(uint32_t size)
+{
+    return (size + 3) & ~3u;
+}
+
+//-----------------------------------------------------------------------------------
+//Sampling divides by the gap between neighbouring keys, so a track's frames have to climb strictly and stay inside the motion.
+template <typename KeyType>
+static bool AreKeyFramesValid(const KeyType* keys, uint32_t numKeys, uint32_t frameCount)
+{
+    for (uint32_t keyIndex = 0; keyIndex < numKeys; ++keyIndex)
+    {
+        if (keys[keyIndex].frame >= frameCount || (keyIndex > 0 && keys[keyIndex].frame <= keys[keyIndex - 1].frame))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------------
+//Index of the last key with frame <= the requested frame.
+template <typename KeyType>
+static inline uint32_t FindKeyIndex(const KeyType* keys, uint32_t numKeys, float frame)
+{
+    uint32_t low = 0;
+    uint32_t high = numKeys;
+    while (high - low > 1)
+    {
+        uint32_t middle = (low + high) / 2;
+        if (static_cast<float>(keys[middle].frame) <= frame)
+        {
+            low = middle;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+//-----------------------------------------------------------------------------------
+static Vector3 SampleVectorTrack(const VectorKey* keys, uint32_t numKeys, float frame)
+{
+    uint32_t index = FindKeyIndex(keys, numKeys, frame);
+    const VectorKey& start = keys[index];
+    if (index + 1 >= numKeys || frame <= static_cast<float>(start.frame))
+    {
+        return Vector3(start.x, start.y, start.z);
+    }
+    const VectorKey& end = keys[index + 1];
+    if (end.frame <= start.frame)
+    {
+        return Vector3(start.x, start.y, start.z);
+    }
+    float fraction = (frame - static_cast<float>(start.frame)) / static_cast<float>(end.frame - start.frame);
+    fraction = MathUtils::Clamp(fraction, 0.0f, 1.0f);
+    return MathUtils::Lerp(fraction, Vector3(start.x, start.y, start.z), Vector3(end.x, end.y, end.z));
+}
+
+//-----------------------------------------------------------------------------------
+static Quaternion SampleRotationTrack(const RotationKey* keys, uint32_t numKeys, float frame)
+{
+    uint32_t index = FindKeyIndex(keys, numKeys, frame);
+    const RotationKey& start = keys[index];
+    if (index + 1 >= numKeys || frame <= static_cast<float>(start.frame))
+    {
+        return start.rotation.Decode();
+    }
+    const RotationKey& end = keys[index + 1];
+    if (end.frame <= start.frame)
+    {
+        return start.rotation.Decode();
+    }
+    float fraction = (frame - static_cast<float>(start.frame)) / static_cast<float>(end.frame - start.frame);
+    fraction = MathUtils::Clamp(fraction, 0.0f, 1.0f);
+    return Quaternion::Nlerp(start.rotation.Decode(), end.rotation.Decode(), fraction);
+}
+
+//-----------------------------------------------------------------------------------
+CompressedMotion::CompressedMotion()
+    : m_header(nullptr)
+    , m_tracks(nullptr)
+    , m_rotationKeys(nullptr)
+    , m_translationKeys(nullptr)
+    , m_scaleKeys(nullptr)
+{
+}
+
+//-----------------------------------------------------------------------------------
+CompressedMotion::~CompressedMotion()
+{
+}
+
+//-----------------------------------------------------------------------------------
+CompressedMotion* CompressedMotion::CreateFromKeyframes(const char* motionName, const Matrix4x4* keyframes, uint32_t frameCount, uint32_t jointCount,
+    float totalLengthSeconds, float frameRate, const MotionCompressionSettings& settings)
+{
+    ASSERT_OR_DIE(frameCount > 0 && frameCount <= 0xFFFF, "Compressed motions store frame numbers in 16 bits for rotation keys");
+
+    std::vector<CompressedJointTracks> tracks(jointCount);
+    std::vector<RotationKey> rotationKeys;
+    std::vector<VectorKey> translationKeys;
+    std::vector<VectorKey> scaleKeys;
+
+    std::vector<Vector3> translations(frameCount);
+    std::vector<Quaternion> rotations(frameCount);
+    std::vector<Vector3> scales(frameCount);
+    std::vector<uint32_t> keptFrames;
+    keptFrames.reserve(frameCount);
+
+    auto vectorLerp = [](const Vector3& start, const Vector3& end, float fraction) { return MathUtils::Lerp(fraction, start, end); };
+    auto translationError = [](const Vector3& first, const Vector3& second) { return (first - second).CalculateMagnitude(); };
+    auto scaleError = [](const Vector3& first, const Vector3& second)
+    {
+        return Max(fabsf(first.x - second.x), Max(fabsf(first.y - second.y), fabsf(first.z - second.z)));
+    };
+    auto rotationLerp = [](const Quaternion& start, const Quaternion& end, float fraction) { return Quaternion::Nlerp(start, end, fraction); };
+    auto rotationError = [](const Quaternion& first, const Quaternion& second) { return Quaternion::AngleBetweenRadians(first, second); };
+
+    for (uint32_t jointIndex = 0; jointIndex < jointCount; ++jointIndex)
+    {
+        const Matrix4x4* jointKeyframes = keyframes + (frameCount * jointIndex);
+        for (uint32_t frame = 0; frame < frameCount; ++frame)
+        {
+            Quaternion::DecomposeMatrix(jointKeyframes[frame], translations[frame], rotations[frame], scales[frame]);
+            //Reduction is done against what will actually be decoded, so quantization error is accounted for.
+            rotations[frame] = QuantizedQuaternion::Encode(rotations[frame]).Decode();
+        }
+
+        CompressedJointTracks& jointTracks = tracks[jointIndex];
+
+        ReduceTrack(rotations, keptFrames, settings.rotationToleranceRadians, rotationLerp, rotationError);
+        jointTracks.firstRotationKey = static_cast<uint32_t>(rotationKeys.size());
+        jointTracks.numRotationKeys = static_cast<uint32_t>(keptFrames.size());
+        for (uint32_t frame : keptFrames)
+        {
+            RotationKey key;
+            key.frame = static_cast<uint16_t>(frame);
+            key.rotation = QuantizedQuaternion::Encode(rotations[frame]);
+            rotationKeys.push_back(key);
+        }
+
+        ReduceTrack(translations, keptFrames, settings.translationTolerance, vectorLerp, translationError);
+        jointTracks.firstTranslationKey = static_cast<uint32_t>(translationKeys.size());
+        jointTracks.numTranslationKeys = static_cast<uint32_t>(keptFrames.size());
+        for (uint32_t frame : keptFrames)
+        {
+            const Vector3& translation = translations[frame];
+            VectorKey key = { translation.x, translation.y, translation.z, frame };
+            translationKeys.push_back(key);
+        }
+
+        ReduceTrack(scales, keptFrames, settings.scaleTolerance, vectorLerp, scaleError);
+        jointTracks.firstScaleKey = static_cast<uint32_t>(scaleKeys.size());
+        jointTracks.numScaleKeys = static_cast<uint32_t>(keptFrames.size());
+        for (uint32_t frame : keptFrames)
+        {
+            const Vector3& scale = scales[frame];
+            VectorKey key = { scale.x, scale.y, scale.z, frame };
+            scaleKeys.push_back(key);
+        }
+    }
+
+    //Lay everything out in one block
+    CompressedMotionHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = FILE_MAGIC;
+    header.version = FILE_VERSION;
+    header.frameCount = frameCount;
+    header.jointCount = jointCount;
+    header.totalLengthSeconds = totalLengthSeconds;
+    header.frameRate = frameRate;
+    strncpy_s(header.motionName, CompressedMotionHeader::MAX_NAME_LENGTH, motionName, _TRUNCATE);
+    header.tracksOffset = AlignTo4(sizeof(CompressedMotionHeader));
+    header.rotationKeysOffset = AlignTo4(header.tracksOffset + (jointCount * sizeof(CompressedJointTracks)));
+    header.translationKeysOffset = AlignTo4(header.rotationKeysOffset + static_cast<uint32_t>(rotationKeys.size() * sizeof(RotationKey)));
+    header.scaleKeysOffset = AlignTo4(header.translationKeysOffset + static_cast<uint32_t>(translationKeys.size() * sizeof(VectorKey)));
+    header.totalSizeBytes = AlignTo4(header.scaleKeysOffset + static_cast<uint32_t>(scaleKeys.size() * sizeof(VectorKey)));
+
+    CompressedMotion* motion = new CompressedMotion();
+    motion->m_data.resize(header.totalSizeBytes, 0);
+    unsigned char* data = motion->m_data.data();
+    memcpy(data, &header, sizeof(header));
+    memcpy(data + header.tracksOffset, tracks.data(), tracks.size() * sizeof(CompressedJointTracks));
+    memcpy(data + header.rotationKeysOffset, rotationKeys.data(), rotationKeys.size() * sizeof(RotationKey));
+    memcpy(data + header.translationKeysOffset, translationKeys.data(), translationKeys.size() * sizeof(VectorKey));
+    memcpy(data + header.scaleKeysOffset, scaleKeys.data(), scaleKeys.size() * sizeof(VectorKey));
+    ASSERT_OR_DIE(motion->BindToData(), "Failed to build a compressed motion");
+    return motion;
+}
+
+//-----------------------------------------------------------------------------------
+CompressedMotion* CompressedMotion::CreateFromFile(const char* filename)
+{
+    CompressedMotion* motion = new CompressedMotion();
+    if (!LoadBufferFromBinaryFile(motion->m_data, filename) || !motion->BindToData())
+    {
+        delete motion;
+        return nullptr;
+    }
+    return motion;
+}
+
+//-----------------------------------------------------------------------------------
+bool CompressedMotion::IsCompressedMotionFile(const char* filename)
+{
+    BinaryFileReader reader;
+    if (!reader.Open(filename))
+    {
+        return false;
+    }
+    uint32_t magic = 0;
+    bool didRead = reader.Read<uint32_t>(magic);
+    reader.Close();
+    return didRead && magic == FILE_MAGIC;
+}
+
+//-----------------------------------------------------------------------------------
+bool CompressedMotion::WriteToFile(const char* filename) const
+{
+    return SaveBufferToBinaryFile(m_data, filename);
+}
+
+//-----------------------------------------------------------------------------------
+//Points the typed views at the raw block, validating every offset so a truncated or foreign file is rejected.
+bool CompressedMotion::BindToData()
+{
+    if (m_data.size() < sizeof(CompressedMotionHeader))
+    {
+        return false;
+    }
+    const unsigned char* data = m_data.data();
+    const CompressedMotionHeader* header = reinterpret_cast<const CompressedMotionHeader*>(data);
+    if (header->magic != FILE_MAGIC || header->version != FILE_VERSION || header->totalSizeBytes != m_data.size())
+    {
+        return false;
+    }
+    //64 bit sums, so huge offsets or counts can't wrap around and pass
+    uint64_t tracksEnd = static_cast<uint64_t>(header->tracksOffset) + (static_cast<uint64_t>(header->jointCount) * sizeof(CompressedJointTracks));
+    if (header->tracksOffset < sizeof(CompressedMotionHeader)
+        || ((header->tracksOffset | header->rotationKeysOffset | header->translationKeysOffset | header->scaleKeysOffset) & 3) != 0
+        || tracksEnd > header->rotationKeysOffset
+        || header->rotationKeysOffset > header->translationKeysOffset
+        || header->translationKeysOffset > header->scaleKeysOffset
+        || header->scaleKeysOffset > header->totalSizeBytes)
+    {
+        return false;
+    }
+
+    const CompressedJointTracks* allTracks = reinterpret_cast<const CompressedJointTracks*>(data + header->tracksOffset);
+    const RotationKey* rotationKeys = reinterpret_cast<const RotationKey*>(data + header->rotationKeysOffset);
+    const VectorKey* translationKeys = reinterpret_cast<const VectorKey*>(data + header->translationKeysOffset);
+    const VectorKey* scaleKeys = reinterpret_cast<const VectorKey*>(data + header->scaleKeysOffset);
+
+    uint64_t numRotationKeys = (header->translationKeysOffset - header->rotationKeysOffset) / sizeof(RotationKey);
+    uint64_t numTranslationKeys = (header->scaleKeysOffset - header->translationKeysOffset) / sizeof(VectorKey);
+    uint64_t numScaleKeys = (header->totalSizeBytes - header->scaleKeysOffset) / sizeof(VectorKey);
+    for (uint32_t jointIndex = 0; jointIndex < header->jointCount; ++jointIndex)
+    {
+        const CompressedJointTracks& tracks = allTracks[jointIndex];
+        if (tracks.numRotationKeys == 0 || tracks.numTranslationKeys == 0 || tracks.numScaleKeys == 0
+            || static_cast<uint64_t>(tracks.firstRotationKey) + tracks.numRotationKeys > numRotationKeys
+            || static_cast<uint64_t>(tracks.firstTranslationKey) + tracks.numTranslationKeys > numTranslationKeys
+            || static_cast<uint64_t>(tracks.firstScaleKey) + tracks.numScaleKeys > numScaleKeys)
+        {
+            return false;
+        }
+        if (!AreKeyFramesValid(rotationKeys + tracks.firstRotationKey, tracks.numRotationKeys, header->frameCount)
+            || !AreKeyFramesValid(translationKeys + tracks.firstTranslationKey, tracks.numTranslationKeys, header->frameCount)
+            || !AreKeyFramesValid(scaleKeys + tracks.firstScaleKey, tracks.numScaleKeys, header->frameCount))
+        {
+            return false;
+        }
+    }
+
+    //Only bind once everything checks out, a rejected block leaves the views as they were
+    m_header = header;
+    m_tracks = allTracks;
+    m_rotationKeys = rotationKeys;
+    m_translationKeys = translationKeys;
+    m_scaleKeys = scaleKeys;
+    return true;
+}
+
+//-----------------------------------------------------------------------------------
+void CompressedMotion::SampleJoint(uint32_t jointIndex, float frame, Vector3& outTranslation, Quaternion& outRotation, Vector3& outScale) const
+{
+    const CompressedJointTracks& tracks = m_tracks[jointIndex];
+    outTranslation = SampleVectorTrack(m_translationKeys + tracks.firstTranslationKey, tracks.numTranslationKeys, frame);
+    outRotation = SampleRotationTrack(m_rotationKeys + tracks.firstRotationKey, tracks.numRotationKeys, frame);
+    outScale = SampleVectorTrack(m_scaleKeys + tracks.firstScaleKey, tracks.numScaleKeys, frame);
+}
+
+//-----------------------------------------------------------------------------------
+Matrix4x4 CompressedMotion::SampleJoint(uint32_t jointIndex, float frame) const
+{
+    Vector3 translation;
+    Quaternion rotation;
+    Vector3 scale;
+    SampleJoint(jointIndex, frame, translation, rotation, scale);
+    return Quaternion::ComposeMatrix(translation, rotation, scale);
+}
+
+//-----------------------------------------------------------------------------------
+uint32_t CompressedMotion::GetTotalKeyCount() const
+{
+    uint32_t totalKeys = 0;
+    for (uint32_t jointIndex = 0; jointIndex < m_header->jointCount; ++jointIndex)
+    {
+        const CompressedJointTracks& tracks = m_tracks[jointIndex];
+        totalKeys += tracks.numRotationKeys + tracks.numTranslationKeys + tracks.numScaleKeys;
+    }
+    return totalKeys;
+}
@@ -0,0 +1,125 @@
+#pragma once
+#include "Engine/Math/Quaternion.hpp"
+#include "Engine/Math/Vector3.hpp"
+#include <stdint.h>
+#include <vector>
+
+class Matrix4x4;
+
+//-----------------------------------------------------------------------------------
+//Tolerances used when throwing away keys that can be rebuilt by interpolating their neighbors.
+struct MotionCompressionSettings
+{
+    MotionCompressionSettings()
+        : rotationToleranceRadians(0.001f)
+        , translationTolerance(0.001f)
+        , scaleTolerance(0.0005f)
+    {};
+
+    float rotationToleranceRadians;
+    float translationTolerance;
+    float scaleTolerance;
+};
+
+//-----------------------------------------------------------------------------------
+//Smallest-three encoding (see Quaternion::ToSmallestThree) packed into 48 bits for the key arrays.
+//15 bits per remaining component, with the dropped component's index split across the top bits of the first two.
+struct QuantizedQuaternion
+{
+    static QuantizedQuaternion Encode(const Quaternion& rotation);
+    Quaternion Decode() const;
+
+    uint16_t components[3];
+};
+
+//-----------------------------------------------------------------------------------
+struct RotationKey
+{
+    uint16_t frame;
+    QuantizedQuaternion rotation;
+};
+
+//-----------------------------------------------------------------------------------
+struct VectorKey
+{
+    float x;
+    float y;
+    float z;
+    uint32_t frame;
+};
+
+//-----------------------------------------------------------------------------------
+//Which slice of each key array belongs to a joint.
+struct CompressedJointTracks
+{
+    uint32_t firstRotationKey;
+    uint32_t numRotationKeys;
+    uint32_t firstTranslationKey;
+    uint32_t numTranslationKeys;
+    uint32_t firstScaleKey;
+    uint32_t numScaleKeys;
+};
+
+//-----------------------------------------------------------------------------------
+struct CompressedMotionHeader
+{
+    static const int MAX_NAME_LENGTH = 64;
+
+    uint32_t magic;
+    uint32_t version;
+    uint32_t totalSizeBytes;
+    uint32_t frameCount;
+    uint32_t jointCount;
+    float totalLengthSeconds;
+    float frameRate;
+    uint32_t tracksOffset;
+    uint32_t rotationKeysOffset;
+    uint32_t translationKeysOffset;
+    uint32_t scaleKeysOffset;
+    char motionName[MAX_NAME_LENGTH];
+};
+
+//-----------------------------------------------------------------------------------
+//Per-joint rotation/translation/scale tracks with redundant keys removed. Everything lives in one contiguous block
+//addressed by offsets (no pointers), so the on-disk file is the in-memory format and can be mapped or read in one go.
+//Block layout: [header][joint tracks * jointCount][rotation keys][translation keys][scale keys], all 4 byte aligned.
+class CompressedMotion
+{
+public:
+    //CONSTRUCTORS//////////////////////////////////////////////////////////////////////////
+    CompressedMotion();
+    ~CompressedMotion();
+
+    //STATIC FUNCTIONS//////////////////////////////////////////////////////////////////////////
+    static CompressedMotion* CreateFromKeyframes(const char* motionName, const Matrix4x4* keyframes, uint32_t frameCount, uint32_t jointCount,
+        float totalLengthSeconds, float frameRate, const MotionCompressionSettings& settings = MotionCompressionSettings());
+    static CompressedMotion* CreateFromFile(const char* filename);
+    static bool IsCompressedMotionFile(const char* filename);
+
+    //FUNCTIONS//////////////////////////////////////////////////////////////////////////
+    void SampleJoint(uint32_t jointIndex, float frame, Vector3& outTranslation, Quaternion& outRotation, Vector3& outScale) const;
+    Matrix4x4 SampleJoint(uint32_t jointIndex, float frame) const;
+    bool WriteToFile(const char* filename) const;
+
+    //GETTERS//////////////////////////////////////////////////////////////////////////
+    inline const CompressedMotionHeader* GetHeader() const { return m_header; };
+    inline size_t GetSizeBytes() const { return m_data.size(); };
+    uint32_t GetTotalKeyCount() const;
+
+    //CONSTANTS//////////////////////////////////////////////////////////////////////////
+    static const uint32_t FILE_MAGIC = 0x434D544D; //"MTMC"
+    static const uint32_t FILE_VERSION = 1;
+    static const float QUANTIZATION_ERROR_RADIANS; //Most the 48 bit rotation encoding adds on top of the rotation tolerance
+
+private:
+    //FUNCTIONS//////////////////////////////////////////////////////////////////////////
+    bool BindToData();
+
+    //MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
+    std::vector<unsigned char> m_data;
+    const CompressedMotionHeader* m_header;
+    const CompressedJointTracks* m_tracks;
+    const RotationKey* m_rotationKeys;
+    const VectorKey* m_translationKeys;
+    const VectorKey* m_scaleKeys;
+};
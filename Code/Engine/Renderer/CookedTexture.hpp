@@ -0,0 +1,17 @@
+#pragma once
+#include <stdint.h>
+
+//-----------------------------------------------------------------------------------
+//Header of a cooked .ctex texture written by the AssetCooker, followed directly by width * height * numComponents bytes of pixels.
+//Pixels are stored exactly as stb_image decodes them, so loading one is a single read with no decoding.
+struct CookedTextureHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t numComponents;
+
+    static const uint32_t MAGIC = 0x58455443; //'CTEX'
+    static const uint32_t VERSION = 1;
+};
@@ -125,12 +125,13 @@ void MeshBuilder::End()
 }
 
 //-----------------------------------------------------------------------------------
-MeshBuilder* MeshBuilder::Merge(MeshBuilder* meshBuilderArray, unsigned int numberOfMeshes)
+MeshBuilder* MeshBuilder::Merge(MeshBuilder* meshBuilderArray, size_t numberOfMeshes)
 {
     MeshBuilder* combinedMesh = new MeshBuilder();
-    for (unsigned int i = 0; i < numberOfMeshes; i++)
+    for (size_t i = 0; i < numberOfMeshes; i++)
     {
-        int numPreexistingVerts = combinedMesh->m_indices.size();
+        //Each mesh's indices move past the vertices of the meshes merged before it
+        unsigned int numPreexistingVerts = static_cast<unsigned int>(combinedMesh->m_vertices.size());
         MeshBuilder& currentMesh = meshBuilderArray[i];
         for (Vertex_Master vert : currentMesh.m_vertices)
         {
@@ -138,7 +139,7 @@ MeshBuilder* MeshBuilder::Merge(MeshBuilder* meshBuilderArray, unsigned int numb
         }
         for (unsigned int index : currentMesh.m_indices)
         {
-            combinedMesh->m_indices.push_back(index + (i * numPreexistingVerts));
+            combinedMesh->m_indices.push_back(index + numPreexistingVerts);
         }
         combinedMesh->m_dataMask |= currentMesh.m_dataMask;
     }
@@ -52,7 +52,7 @@ public:
 
     //STATIC FUNCTIONS/////////////////////////////////////////////////////////////////////
     static Mesh* LoadMesh(const std::string& filePath);
-    static MeshBuilder* Merge(MeshBuilder* meshBuilderArray, unsigned int numberOfMeshes);
+    static MeshBuilder* Merge(MeshBuilder* meshBuilderArray, size_t numberOfMeshes);
 
     //MEMBER FUNCTIONS//////////////////////////////////////////////////////////////////////////
     void Begin();
@@ -1,6 +1,6 @@
 #pragma once
 #include <string>
-#include "Engine\Math\MathUtils.hpp"
+#include "Engine/Math/MathUtils.hpp"
 
 typedef unsigned char uchar;
 
@@ -46,12 +46,19 @@ CONSOLE_COMMAND(loadskel)
 //-----------------------------------------------------------------------------------
 Skeleton::~Skeleton()
 {
-    delete m_joints->m_mesh;
-    delete m_joints->m_material;
-    delete m_joints;
-    delete m_bones->m_mesh;
-    delete m_bones->m_material;
-    delete m_bones;
+    //Debug meshes only exist once the skeleton has been rendered
+    if (m_joints)
+    {
+        delete m_joints->m_mesh;
+        delete m_joints->m_material;
+        delete m_joints;
+    }
+    if (m_bones)
+    {
+        delete m_bones->m_mesh;
+        delete m_bones->m_material;
+        delete m_bones;
+    }
 }
 
 //-----------------------------------------------------------------------------------
@@ -12,12 +12,38 @@
 #include "Engine/Renderer/OpenGLExtensions.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
 #include "Engine/Renderer/Renderer.hpp"
+#include "Engine/Renderer/CookedTexture.hpp"
+#include "Engine/Input/InputOutputUtils.hpp"
 
 #define STBI_HEADER_FILE_ONLY
 #include "ThirdParty/stb_image.c"
 
 #define STATIC // Do-nothing indicator that method/member is static in class definition
 
+//-----------------------------------------------------------------------------------
+//Loads a .ctex written by the AssetCooker. The pixels are already decoded, so this is just a copy out of the file.
+//The copy is malloc'd so the destructor can free it through stbi_image_free like any other image loaded from disk.
+static unsigned char* LoadCookedTexture(const std::string& imageFilePath, Vector2Int& outTexelSize, int& outNumComponents)
+{
+    std::vector<unsigned char> buffer;
+    if (!LoadBufferFromBinaryFile(buffer, imageFilePath) || buffer.size() < sizeof(CookedTextureHeader))
+    {
+        return nullptr;
+    }
+    CookedTextureHeader header;
+    memcpy(&header, buffer.data(), sizeof(header));
+    size_t pixelBytes = (size_t)header.width * header.height * header.numComponents;
+    if (header.magic != CookedTextureHeader::MAGIC || header.version != CookedTextureHeader::VERSION || buffer.size() < sizeof(header) + pixelBytes)
+    {
+        return nullptr;
+    }
+    unsigned char* pixels = (unsigned char*)malloc(pixelBytes);
+    memcpy(pixels, buffer.data() + sizeof(header), pixelBytes);
+    outTexelSize = Vector2Int(header.width, header.height);
+    outNumComponents = header.numComponents;
+    return pixels;
+}
+
 //---------------------------------------------------------------------------
 STATIC std::map<size_t, Texture*, std::less<size_t>, UntrackedAllocator<std::pair<size_t, Texture*>>> Texture::s_textureRegistry;
 
@@ -41,7 +67,15 @@ Texture::Texture(const std::string& imageFilePath)
 {
     int numComponents = 0; // Filled in for us to indicate how many color/alpha components the image had (e.g. 3=RGB, 4=RGBA)
     int numComponentsRequested = 0; // don't care; we support 3 (RGB) or 4 (RGBA)
-    m_imageData = stbi_load( imageFilePath.c_str(), &m_texelSize.x, &m_texelSize.y, &numComponents, numComponentsRequested );
+    bool isCooked = imageFilePath.size() > 5 && imageFilePath.compare(imageFilePath.size() - 5, 5, ".ctex") == 0;
+    if (isCooked)
+    {
+        m_imageData = LoadCookedTexture(imageFilePath, m_texelSize, numComponents);
+    }
+    else
+    {
+        m_imageData = stbi_load( imageFilePath.c_str(), &m_texelSize.x, &m_texelSize.y, &numComponents, numComponentsRequested );
+    }
     ASSERT_OR_DIE(m_imageData != nullptr, Stringf("The texture at %s failed to load!", imageFilePath.c_str()));
 
     // Enable texturing
@@ -3,6 +3,7 @@
 
 //-----------------------------------------------------------------------------------------------
 #include "Engine/Time/Time.hpp"
+#if defined(_WIN32)
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
 
@@ -41,3 +42,33 @@ int GetTimeBasedSeed()
     QueryPerformanceCounter(&currentCount);
     return static_cast<int>(currentCount.QuadPart);
 }
+
+#else
+#include <chrono>
+
+//---------------------------------------------------------------------------
+static std::chrono::steady_clock::time_point InitializeTime()
+{
+    return std::chrono::steady_clock::now();
+}
+
+//---------------------------------------------------------------------------
+double GetCurrentTimeSeconds()
+{
+    static std::chrono::steady_clock::time_point initialTime = InitializeTime();
+    std::chrono::duration<double> elapsedSinceInitialTime = std::chrono::steady_clock::now() - initialTime;
+    return elapsedSinceInitialTime.count();
+}
+
+//-----------------------------------------------------------------------------------
+double GetCurrentTimeMilliseconds()
+{
+    return GetCurrentTimeSeconds() * 1000.0f;
+}
+
+//-----------------------------------------------------------------------------------
+int GetTimeBasedSeed()
+{
+    return static_cast<int>(std::chrono::steady_clock::now().time_since_epoch().count());
+}
+#endif
@@ -0,0 +1,735 @@
+#include "Engine/Tools/AssetCooker.hpp"
+#include "ThirdParty/Parsers/XMLParser.hpp"
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+
+#define STBI_HEADER_FILE_ONLY
+#include "ThirdParty/stb_image.c"
+
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+#else
+    #include <dirent.h>
+    #include <sys/stat.h>
+    #include <errno.h>
+    #include <limits.h>
+    #include <stdlib.h>
+#endif
+
+#if defined(TOOLS_BUILD)
+    #include "Engine/Tools/fbx.hpp"
+    #include "Engine/Core/ErrorWarningAssert.hpp"
+    #include "Engine/Math/Matrix4x4.hpp"
+    #include "Engine/Renderer/Skeleton.hpp"
+    #include "Engine/Renderer/AnimationMotion.hpp"
+#endif
+
+const char* const AssetCooker::MANIFEST_FILENAME = "CookManifest.txt";
+const uint32_t AssetCooker::COOK_STEP_VERSIONS[NUM_ASSET_TYPES] = { 1, 1, 1 };
+
+//-----------------------------------------------------------------------------------
+//Header of the stand-in FBX container, followed by the untouched source file.
+struct FbxStandInHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t sourceSize;
+
+    static const uint32_t MAGIC = 0x53584246; //'FBXS'
+    static const uint32_t VERSION = 1;
+};
+
+//FILE HELPERS//////////////////////////////////////////////////////////////////////////
+//These stay local instead of going through InputOutputUtils so the cooker builds without the rest of the engine.
+
+//-----------------------------------------------------------------------------------
+static double GetSecondsSince(const std::chrono::high_resolution_clock::time_point& start)
+{
+    return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+//-----------------------------------------------------------------------------------
+static bool ReadWholeFile(const std::string& path, std::vector<unsigned char>& outBuffer)
+{
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file)
+    {
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    outBuffer.resize(size > 0 ? (size_t)size : 0);
+    size_t numRead = outBuffer.empty() ? 0 : fread(outBuffer.data(), 1, outBuffer.size(), file);
+    fclose(file);
+    return numRead == outBuffer.size();
+}
+
+//-----------------------------------------------------------------------------------
+static bool WriteWholeFile(const std::string& path, const unsigned char* data, size_t numBytes)
+{
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file)
+    {
+        return false;
+    }
+    size_t numWritten = numBytes > 0 ? fwrite(data, 1, numBytes, file) : 0;
+    fclose(file);
+    return numWritten == numBytes;
+}
+
+//-----------------------------------------------------------------------------------
+static bool PathExists(const std::string& path)
+{
+#if defined(_WIN32)
+    return GetFileAttributesA(path.c_str()) != INVALID_FILE_ATTRIBUTES;
+#else
+    struct stat info;
+    return stat(path.c_str(), &info) == 0;
+#endif
+}
+
+//-----------------------------------------------------------------------------------
+static bool MakeDirectory(const std::string& path)
+{
+#if defined(_WIN32)
+    return CreateDirectoryA(path.c_str(), NULL) || GetLastError() == ERROR_ALREADY_EXISTS;
+#else
+    return mkdir(path.c_str(), 0755) == 0 || errno == EEXIST;
+#endif
+}
+
+//-----------------------------------------------------------------------------------
+static bool EnsureFolderExists(const std::string& folder)
+{
+    for (size_t slash = folder.find_first_of("/\\", 1); slash != std::string::npos; slash = folder.find_first_of("/\\", slash + 1))
+    {
+        MakeDirectory(folder.substr(0, slash));
+    }
+    return MakeDirectory(folder);
+}
+
+//-----------------------------------------------------------------------------------
+//Absolute, forward slashed and without a trailing slash. Empty if the folder can't be resolved.
+static std::string GetAbsoluteFolder(const std::string& folder)
+{
+#if defined(_WIN32)
+    char fullPath[MAX_PATH];
+    DWORD length = GetFullPathNameA(folder.c_str(), MAX_PATH, fullPath, NULL);
+    if (length == 0 || length >= MAX_PATH)
+    {
+        return std::string();
+    }
+    std::string result(fullPath, length);
+#else
+    char fullPath[PATH_MAX];
+    if (!realpath(folder.c_str(), fullPath))
+    {
+        return std::string();
+    }
+    std::string result(fullPath);
+#endif
+    std::replace(result.begin(), result.end(), '\\', '/');
+    while (result.size() > 1 && result.back() == '/')
+    {
+        result.pop_back();
+    }
+    return result;
+}
+
+//-----------------------------------------------------------------------------------
+static bool ArePathsEqual(const std::string& first, const std::string& second)
+{
+#if defined(_WIN32)
+    return _stricmp(first.c_str(), second.c_str()) == 0;
+#else
+    return first == second;
+#endif
+}
+
+//-----------------------------------------------------------------------------------
+static std::string GetFolder(const std::string& path)
+{
+    size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? std::string() : path.substr(0, slash);
+}
+
+//-----------------------------------------------------------------------------------
+static std::string RemoveExtension(const std::string& path)
+{
+    size_t dot = path.find_last_of('.');
+    size_t slash = path.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+    {
+        return path;
+    }
+    return path.substr(0, dot);
+}
+
+//-----------------------------------------------------------------------------------
+//Relative paths always use forward slashes so the manifest is the same on every platform. The excluded folder and everything in it are skipped.
+static void ListFilesRecursive(const std::string& baseFolder, const std::string& relativeFolder, const std::string& excludedRelativeFolder, std::vector<std::string>& outRelativePaths)
+{
+    if (!relativeFolder.empty() && ArePathsEqual(relativeFolder, excludedRelativeFolder))
+    {
+        return;
+    }
+    std::string folder = relativeFolder.empty() ? baseFolder : baseFolder + "/" + relativeFolder;
+    std::string prefix = relativeFolder.empty() ? std::string() : relativeFolder + "/";
+#if defined(_WIN32)
+    WIN32_FIND_DATAA findData;
+    HANDLE findHandle = FindFirstFileA((folder + "/*").c_str(), &findData);
+    if (findHandle == INVALID_HANDLE_VALUE)
+    {
+        return;
+    }
+    do
+    {
+        std::string name = findData.cFileName;
+        if (name == "." || name == "..")
+        {
+            continue;
+        }
+        if (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+        {
+            ListFilesRecursive(baseFolder, prefix + name, excludedRelativeFolder, outRelativePaths);
+        }
+        else
+        {
+            outRelativePaths.push_back(prefix + name);
+        }
+    } while (FindNextFileA(findHandle, &findData));
+    FindClose(findHandle);
+#else
+    DIR* directory = opendir(folder.c_str());
+    if (!directory)
+    {
+        return;
+    }
+    while (dirent* entry = readdir(directory))
+    {
+        std::string name = entry->d_name;
+        if (name == "." || name == "..")
+        {
+            continue;
+        }
+        struct stat info;
+        if (stat((folder + "/" + name).c_str(), &info) != 0)
+        {
+            continue;
+        }
+        if (S_ISDIR(info.st_mode))
+        {
+            ListFilesRecursive(baseFolder, prefix + name, excludedRelativeFolder, outRelativePaths);
+        }
+        else
+        {
+            outRelativePaths.push_back(prefix + name);
+        }
+    }
+    closedir(directory);
+#endif
+}
+
+//-----------------------------------------------------------------------------------
+AssetCooker::CookReport::CookReport()
+    : numThreads(0)
+    , totalSeconds(0.0)
+    , hashSeconds(0.0)
+{
+    memset(numResults, 0, sizeof(numResults));
+    memset(cookSecondsByType, 0, sizeof(cookSecondsByType));
+}
+
+//-----------------------------------------------------------------------------------
+AssetCooker::AssetCooker(const std::string& sourceFolder, const std::string& outputFolder, unsigned int numThreads /*= 0*/)
+    : m_sourceFolder(sourceFolder)
+    , m_outputFolder(outputFolder)
+    , m_numThreads(numThreads)
+    , m_nextItem(0)
+    , m_forceRebuild(false)
+{
+    if (m_numThreads == 0)
+    {
+        m_numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+//-----------------------------------------------------------------------------------
+AssetCooker::CookReport AssetCooker::Cook(bool forceRebuild /*= false*/)
+{
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+    CookReport report;
+    m_forceRebuild = forceRebuild;
+    LoadManifest();
+    EnsureFolderExists(m_outputFolder);
+
+    //Cooking into a folder under the source folder mustn't pick the cooked files up as sources next time
+    std::string excludedRelativeFolder;
+    std::string absoluteSource = GetAbsoluteFolder(m_sourceFolder);
+    std::string absoluteOutput = GetAbsoluteFolder(m_outputFolder);
+    if (!absoluteSource.empty() && !absoluteOutput.empty() && absoluteOutput.size() > absoluteSource.size() + 1
+        && ArePathsEqual(absoluteOutput.substr(0, absoluteSource.size()), absoluteSource) && absoluteOutput[absoluteSource.size()] == '/')
+    {
+        excludedRelativeFolder = absoluteOutput.substr(absoluteSource.size() + 1);
+    }
+
+    std::vector<std::string> relativePaths;
+    ListFilesRecursive(m_sourceFolder, std::string(), excludedRelativeFolder, relativePaths);
+    std::sort(relativePaths.begin(), relativePaths.end());
+    for (const std::string& relativePath : relativePaths)
+    {
+        AssetType type = GetAssetType(relativePath);
+        if (type == UNKNOWN_ASSET)
+        {
+            continue;
+        }
+        CookItem item;
+        item.relativePath = relativePath;
+        item.type = type;
+        item.contentHash = 0;
+        item.result = FAILED;
+        item.hashSeconds = 0.0;
+        item.cookSeconds = 0.0;
+        report.items.push_back(item);
+    }
+
+    //Workers pull the next item off a shared counter, so one slow FBX doesn't hold up a whole pre-assigned chunk.
+    report.numThreads = std::min<unsigned int>(m_numThreads, std::max<unsigned int>(1, report.items.size()));
+    m_nextItem = 0;
+    std::vector<std::thread> workers;
+    for (unsigned int i = 1; i < report.numThreads; ++i)
+    {
+        workers.push_back(std::thread(&AssetCooker::CookWorker, this, &report));
+    }
+    CookWorker(&report);
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+
+    for (const CookItem& item : report.items)
+    {
+        ++report.numResults[item.result];
+        report.hashSeconds += item.hashSeconds;
+        report.cookSecondsByType[item.type] += item.cookSeconds;
+    }
+    SaveManifest(report);
+    report.totalSeconds = GetSecondsSince(start);
+    return report;
+}
+
+//-----------------------------------------------------------------------------------
+void AssetCooker::CookWorker(CookReport* report)
+{
+    for (unsigned int index = m_nextItem++; index < report->items.size(); index = m_nextItem++)
+    {
+        CookSingleItem(report->items[index]);
+    }
+}
+
+//-----------------------------------------------------------------------------------
+void AssetCooker::CookSingleItem(CookItem& item)
+{
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+    std::string sourcePath = m_sourceFolder + "/" + item.relativePath;
+    std::vector<unsigned char> source;
+    if (!ReadWholeFile(sourcePath, source))
+    {
+        item.error = "Couldn't read source file";
+        return;
+    }
+    item.contentHash = HashBytes(source.data(), source.size());
+    item.contentHash = HashBytes((const unsigned char*)&COOK_STEP_VERSIONS[item.type], sizeof(uint32_t), item.contentHash);
+    item.hashSeconds = GetSecondsSince(start);
+
+    auto previousCook = m_manifest.find(item.relativePath);
+    if (!m_forceRebuild && previousCook != m_manifest.end() && previousCook->second.contentHash == item.contentHash && AreOutputsPresent(previousCook->second))
+    {
+        item.cookedPaths = previousCook->second.cookedPaths;
+        item.result = SKIPPED;
+        return;
+    }
+
+    start = std::chrono::high_resolution_clock::now();
+    std::string cookedPath = GetCookedPath(item.relativePath, item.type);
+    std::vector<unsigned char> cooked;
+    bool succeeded = false;
+    switch (item.type)
+    {
+    case TEXTURE:
+        succeeded = CookTexture(source, cooked, item.error) && WriteCookedFile(cookedPath, cooked);
+        item.cookedPaths.push_back(cookedPath);
+        break;
+    case XML_DEFINITION:
+        succeeded = CookXML(source, cooked, item.error) && WriteCookedFile(cookedPath, cooked);
+        item.cookedPaths.push_back(cookedPath);
+        break;
+    case FBX_SCENE:
+    {
+        {
+            //CookFbx writes its own files, possibly several of them, so only the folder is made here
+            std::lock_guard<std::mutex> directoryGuard(m_directoryLock);
+            EnsureFolderExists(GetFolder(m_outputFolder + "/" + cookedPath));
+        }
+        std::vector<std::string> writtenPaths;
+        std::lock_guard<std::mutex> fbxGuard(m_fbxLock);
+        succeeded = CookFbx(sourcePath, source, m_outputFolder + "/" + cookedPath, writtenPaths, item.error);
+        for (const std::string& writtenPath : writtenPaths)
+        {
+            item.cookedPaths.push_back(writtenPath.substr(std::min(writtenPath.size(), m_outputFolder.size() + 1)));
+        }
+        break;
+    }
+    default:
+        item.error = "Unknown asset type";
+        break;
+    }
+    if (succeeded)
+    {
+        item.result = COOKED;
+        RemoveStaleOutputs(item);
+    }
+    else if (item.error.empty())
+    {
+        item.error = "Couldn't write cooked file";
+    }
+    item.cookSeconds = GetSecondsSince(start);
+}
+
+//-----------------------------------------------------------------------------------
+//A recooked scene can lose a skeleton or motions, the files the last cook wrote for them would otherwise be left behind.
+void AssetCooker::RemoveStaleOutputs(const CookItem& item) const
+{
+    auto previousCook = m_manifest.find(item.relativePath);
+    if (previousCook == m_manifest.end())
+    {
+        return;
+    }
+    for (const std::string& previousPath : previousCook->second.cookedPaths)
+    {
+        if (std::find(item.cookedPaths.begin(), item.cookedPaths.end(), previousPath) == item.cookedPaths.end())
+        {
+            remove((m_outputFolder + "/" + previousPath).c_str());
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------------
+bool AssetCooker::AreOutputsPresent(const ManifestEntry& entry) const
+{
+    if (entry.cookedPaths.empty())
+    {
+        return false;
+    }
+    for (const std::string& cookedPath : entry.cookedPaths)
+    {
+        if (!PathExists(m_outputFolder + "/" + cookedPath))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------------
+bool AssetCooker::WriteCookedFile(const std::string& cookedPath, const std::vector<unsigned char>& cooked)
+{
+    std::string fullPath = m_outputFolder + "/" + cookedPath;
+    {
+        std::lock_guard<std::mutex> directoryGuard(m_directoryLock);
+        EnsureFolderExists(GetFolder(fullPath));
+    }
+    return WriteWholeFile(fullPath, cooked.data(), cooked.size());
+}
+
+//-----------------------------------------------------------------------------------
+//One line per cooked asset: <content hash> <tab> <source path> then <tab> <cooked path> for every file it cooked to
+void AssetCooker::LoadManifest()
+{
+    m_manifest.clear();
+    std::vector<unsigned char> buffer;
+    if (!ReadWholeFile(m_outputFolder + "/" + MANIFEST_FILENAME, buffer))
+    {
+        return;
+    }
+    std::string contents(buffer.begin(), buffer.end());
+    size_t lineStart = 0;
+    while (lineStart < contents.size())
+    {
+        size_t lineEnd = contents.find('\n', lineStart);
+        if (lineEnd == std::string::npos)
+        {
+            lineEnd = contents.size();
+        }
+        std::string line = contents.substr(lineStart, lineEnd - lineStart);
+        lineStart = lineEnd + 1;
+
+        size_t firstTab = line.find('\t');
+        size_t secondTab = line.find('\t', firstTab + 1);
+        if (firstTab == std::string::npos || secondTab == std::string::npos)
+        {
+            continue;
+        }
+        ManifestEntry entry;
+        entry.contentHash = strtoull(line.substr(0, firstTab).c_str(), nullptr, 16);
+        for (size_t pathStart = secondTab + 1; pathStart <= line.size();)
+        {
+            size_t pathEnd = line.find('\t', pathStart);
+            if (pathEnd == std::string::npos)
+            {
+                pathEnd = line.size();
+            }
+            if (pathEnd > pathStart)
+            {
+                entry.cookedPaths.push_back(line.substr(pathStart, pathEnd - pathStart));
+            }
+            pathStart = pathEnd + 1;
+        }
+        m_manifest[line.substr(firstTab + 1, secondTab - firstTab - 1)] = entry;
+    }
+}
+
+//-----------------------------------------------------------------------------------
+//Failed and deleted sources are left out, so they get another attempt next time.
+void AssetCooker::SaveManifest(const CookReport& report) const
+{
+    std::string contents;
+    char hashText[32];
+    for (const CookItem& item : report.items)
+    {
+        if (item.result == FAILED)
+        {
+            continue;
+        }
+        snprintf(hashText, sizeof(hashText), "%016llx", (unsigned long long)item.contentHash);
+        contents += hashText;
+        contents += '\t' + item.relativePath;
+        for (const std::string& cookedPath : item.cookedPaths)
+        {
+            contents += '\t' + cookedPath;
+        }
+        contents += '\n';
+    }
+    WriteWholeFile(m_outputFolder + "/" + MANIFEST_FILENAME, (const unsigned char*)contents.data(), contents.size());
+}
+
+//-----------------------------------------------------------------------------------
+void AssetCooker::PrintReport(const CookReport& report, bool listEveryFile /*= false*/) const
+{
+    for (const CookItem& item : report.items)
+    {
+        if (item.result == FAILED)
+        {
+            printf("FAILED  %s: %s\n", item.relativePath.c_str(), item.error.c_str());
+        }
+        else if (listEveryFile)
+        {
+            printf("%-7s %-40s %8.3fms\n", item.result == COOKED ? "COOKED" : "SKIPPED", item.relativePath.c_str(), (item.hashSeconds + item.cookSeconds) * 1000.0);
+        }
+    }
+    printf("%u files: %u cooked, %u skipped, %u failed on %u threads\n", (unsigned int)report.items.size(), report.numResults[COOKED], report.numResults[SKIPPED], report.numResults[FAILED], report.numThreads);
+    printf("Wall time %.3fms, reading + hashing %.3fms", report.totalSeconds * 1000.0, report.hashSeconds * 1000.0);
+    for (int type = 0; type < NUM_ASSET_TYPES; ++type)
+    {
+        printf(", %s %.3fms", GetAssetTypeName((AssetType)type), report.cookSecondsByType[type] * 1000.0);
+    }
+    printf(" (summed over threads)\n");
+}
+
+//-----------------------------------------------------------------------------------
+AssetCooker::AssetType AssetCooker::GetAssetType(const std::string& path)
+{
+    size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos)
+    {
+        return UNKNOWN_ASSET;
+    }
+    std::string extension = path.substr(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    if (extension == "png" || extension == "jpg" || extension == "jpeg" || extension == "tga" || extension == "bmp")
+    {
+        return TEXTURE;
+    }
+    if (extension == "xml")
+    {
+        return XML_DEFINITION;
+    }
+    if (extension == "fbx")
+    {
+        return FBX_SCENE;
+    }
+    return UNKNOWN_ASSET;
+}
+
+//-----------------------------------------------------------------------------------
+const char* AssetCooker::GetAssetTypeName(AssetType type)
+{
+    switch (type)
+    {
+    case TEXTURE:
+        return "textures";
+    case XML_DEFINITION:
+        return "xml";
+    case FBX_SCENE:
+        return "fbx";
+    default:
+        return "unknown";
+    }
+}
+
+//-----------------------------------------------------------------------------------
+std::string AssetCooker::GetCookedPath(const std::string& relativePath, AssetType type)
+{
+    switch (type)
+    {
+    case TEXTURE:
+        return RemoveExtension(relativePath) + ".ctex";
+    case FBX_SCENE:
+#if defined(TOOLS_BUILD)
+        return RemoveExtension(relativePath) + ".picomesh";
+#else
+        return RemoveExtension(relativePath) + ".fbxstandin";
+#endif
+    default:
+        return relativePath;
+    }
+}
+
+//-----------------------------------------------------------------------------------
+//FNV-1a, 64 bit. Pass the previous result back in as the hash to keep hashing more data.
+uint64_t AssetCooker::HashBytes(const unsigned char* data, size_t numBytes, uint64_t hash /*= FNV_OFFSET_BASIS*/)
+{
+    for (size_t i = 0; i < numBytes; ++i)
+    {
+        hash ^= data[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+//-----------------------------------------------------------------------------------
+bool AssetCooker::CookTexture(const std::vector<unsigned char>& source, std::vector<unsigned char>& outCooked, std::string& outError)
+{
+    int width = 0;
+    int height = 0;
+    int numComponents = 0;
+    unsigned char* pixels = stbi_load_from_memory(source.data(), source.size(), &width, &height, &numComponents, 0);
+    if (pixels && numComponents < 3)
+    {
+        //Texture only uploads RGB and RGBA, so expand grey and grey-alpha images here instead of at load time
+        stbi_image_free(pixels);
+        numComponents = 4;
+        pixels = stbi_load_from_memory(source.data(), source.size(), &width, &height, nullptr, numComponents);
+    }
+    if (!pixels)
+    {
+        outError = stbi_failure_reason() ? stbi_failure_reason() : "stb_image couldn't decode the image";
+        return false;
+    }
+
+    CookedTextureHeader header;
+    header.magic = CookedTextureHeader::MAGIC;
+    header.version = CookedTextureHeader::VERSION;
+    header.width = width;
+    header.height = height;
+    header.numComponents = numComponents;
+    size_t pixelBytes = (size_t)width * height * numComponents;
+    outCooked.resize(sizeof(header) + pixelBytes);
+    memcpy(outCooked.data(), &header, sizeof(header));
+    memcpy(outCooked.data() + sizeof(header), pixels, pixelBytes);
+    stbi_image_free(pixels);
+    return true;
+}
+
+//-----------------------------------------------------------------------------------
+bool AssetCooker::CookXML(const std::vector<unsigned char>& source, std::vector<unsigned char>& outCooked, std::string& outError)
+{
+    std::string text(source.begin(), source.end());
+    XMLResults results;
+    XMLNode root = XMLNode::parseString(text.c_str(), NULL, &results);
+    if (results.error != eXMLErrorNone)
+    {
+        char errorText[256];
+        snprintf(errorText, sizeof(errorText), "%s at line %i, column %i", XMLNode::getError(results.error), results.nLine, results.nColumn);
+        outError = errorText;
+        return false;
+    }
+    int numChars = 0;
+    XMLSTR minified = root.createXMLString(0, &numChars);
+    outCooked.assign((unsigned char*)minified, (unsigned char*)minified + numChars);
+    freeXMLString(minified);
+    return true;
+}
+
+//-----------------------------------------------------------------------------------
+bool AssetCooker::CookFbx(const std::string& sourcePath, const std::vector<unsigned char>& source, const std::string& cookedPath, std::vector<std::string>& outWrittenPaths, std::string& outError)
+{
+#if defined(TOOLS_BUILD)
+    UNUSED(source);
+    SceneImport* import = FbxLoadSceneFromFile(sourcePath.c_str(), Matrix4x4::IDENTITY, false, Matrix4x4::IDENTITY);
+    if (!import)
+    {
+        outError = "FBX SDK failed to import the scene";
+        return false;
+    }
+    std::string basePath = RemoveExtension(cookedPath);
+    if (import->meshes.size() > 0)
+    {
+        MeshBuilder* mergedMesh = MeshBuilder::Merge(import->meshes.data(), import->meshes.size());
+        mergedMesh->AddLinearIndices();
+        mergedMesh->WriteToFile(cookedPath.c_str());
+        outWrittenPaths.push_back(cookedPath);
+        delete mergedMesh;
+    }
+    for (size_t i = 0; i < import->skeletons.size(); ++i)
+    {
+        std::string skeletonPath = basePath + (i == 0 ? std::string() : "_" + std::to_string(i)) + ".picoskel";
+        import->skeletons[i]->WriteToFile(skeletonPath.c_str());
+        outWrittenPaths.push_back(skeletonPath);
+        delete import->skeletons[i];
+    }
+    for (size_t i = 0; i < import->motions.size(); ++i)
+    {
+        std::string motionPath = basePath + (i == 0 ? std::string() : "_" + std::to_string(i)) + ".picomotion";
+        import->motions[i]->WriteToFile(motionPath.c_str());
+        outWrittenPaths.push_back(motionPath);
+        delete import->motions[i];
+    }
+    delete import;
+    if (outWrittenPaths.empty())
+    {
+        outError = "Scene had no meshes, skeletons or motions";
+        return false;
+    }
+    return true;
+#else
+    //No FBX SDK outside of tools builds. Check the file at least looks like an FBX and wrap it up unchanged.
+    static const char BINARY_SIGNATURE[] = "Kaydara FBX Binary";
+    static const char ASCII_SIGNATURE[] = "; FBX";
+    bool isBinary = source.size() >= sizeof(BINARY_SIGNATURE) - 1 && memcmp(source.data(), BINARY_SIGNATURE, sizeof(BINARY_SIGNATURE) - 1) == 0;
+    bool isAscii = source.size() >= sizeof(ASCII_SIGNATURE) - 1 && memcmp(source.data(), ASCII_SIGNATURE, sizeof(ASCII_SIGNATURE) - 1) == 0;
+    if (!isBinary && !isAscii)
+    {
+        outError = "Not an FBX file: " + sourcePath;
+        return false;
+    }
+    FbxStandInHeader header;
+    header.magic = FbxStandInHeader::MAGIC;
+    header.version = FbxStandInHeader::VERSION;
+    header.sourceSize = source.size();
+    std::vector<unsigned char> cooked(sizeof(header) + source.size());
+    memcpy(cooked.data(), &header, sizeof(header));
+    memcpy(cooked.data() + sizeof(header), source.data(), source.size());
+    if (!WriteWholeFile(cookedPath, cooked.data(), cooked.size()))
+    {
+        return false;
+    }
+    outWrittenPaths.push_back(cookedPath);
+    return true;
+#endif
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <stdint.h>
+#include "Engine/Renderer/CookedTexture.hpp"
+
+//-----------------------------------------------------------------------------------
+//Offline cooker that turns source assets into load-ready engine binaries.
+//Every file under the source folder is hashed (content + cook step version); files whose hash matches the manifest
+//from the last cook and whose output still exists are skipped, everything else is cooked on a pool of worker threads.
+//Only depends on the standard library, stb_image and XMLParser so it can be built and run outside of the engine.
+//
+//  Images (.png .jpg .tga .bmp) -> .ctex   CookedTextureHeader + raw pixels, loaded by Texture without stb.
+//  XML (.xml)                   -> .xml    Validated and re-emitted without formatting whitespace. Stays text, every
+//                                          definition loader reads it through XMLParser and there is no binary reader.
+//  FBX (.fbx)                   -> .picomesh/.picoskel/.picomotion through FbxLoadSceneFromFile in TOOLS_BUILD.
+//                                  Other builds have no FBX SDK and store the source in a .fbxstandin container instead,
+//                                  which keeps hashing, scheduling and incremental behavior identical for testing.
+//The manifest records every file a source cooked to, so a scene's skeleton or motions going missing recooks the scene too.
+//An output folder inside the source folder is left out of the walk, so cooked files never get cooked again.
+class AssetCooker
+{
+public:
+    //ENUMS//////////////////////////////////////////////////////////////////////////
+    enum AssetType
+    {
+        TEXTURE,
+        XML_DEFINITION,
+        FBX_SCENE,
+        NUM_ASSET_TYPES,
+        UNKNOWN_ASSET
+    };
+
+    enum CookResult
+    {
+        COOKED,
+        SKIPPED,
+        FAILED,
+        NUM_COOK_RESULTS
+    };
+
+    //STRUCTS//////////////////////////////////////////////////////////////////////////
+    struct CookItem
+    {
+        std::string relativePath;
+        std::vector<std::string> cookedPaths; //Relative to the output folder, every file the cook wrote
+        AssetType type;
+        uint64_t contentHash;
+        CookResult result;
+        double hashSeconds;
+        double cookSeconds;
+        std::string error;
+    };
+
+    struct CookReport
+    {
+        CookReport();
+        unsigned int numResults[NUM_COOK_RESULTS];
+        unsigned int numThreads;
+        double totalSeconds;
+        double hashSeconds;
+        double cookSecondsByType[NUM_ASSET_TYPES];
+        std::vector<CookItem> items;
+    };
+
+    //CONSTRUCTORS//////////////////////////////////////////////////////////////////////////
+    AssetCooker(const std::string& sourceFolder, const std::string& outputFolder, unsigned int numThreads = 0);
+
+    //FUNCTIONS//////////////////////////////////////////////////////////////////////////
+    CookReport Cook(bool forceRebuild = false);
+    void PrintReport(const CookReport& report, bool listEveryFile = false) const;
+
+    //STATIC FUNCTIONS//////////////////////////////////////////////////////////////////////////
+    static AssetType GetAssetType(const std::string& path);
+    static const char* GetAssetTypeName(AssetType type);
+    static std::string GetCookedPath(const std::string& relativePath, AssetType type);
+    static uint64_t HashBytes(const unsigned char* data, size_t numBytes, uint64_t hash = FNV_OFFSET_BASIS);
+    static bool CookTexture(const std::vector<unsigned char>& source, std::vector<unsigned char>& outCooked, std::string& outError);
+    static bool CookXML(const std::vector<unsigned char>& source, std::vector<unsigned char>& outCooked, std::string& outError);
+    static bool CookFbx(const std::string& sourcePath, const std::vector<unsigned char>& source, const std::string& cookedPath, std::vector<std::string>& outWrittenPaths, std::string& outError);
+
+    //CONSTANTS//////////////////////////////////////////////////////////////////////////
+    static const uint64_t FNV_OFFSET_BASIS = 0xcbf29ce484222325ULL;
+    static const uint64_t FNV_PRIME = 0x100000001b3ULL;
+    static const char* const MANIFEST_FILENAME;
+    static const uint32_t COOK_STEP_VERSIONS[NUM_ASSET_TYPES]; //Bump to force a type to recook after changing its step
+
+private:
+    //STRUCTS//////////////////////////////////////////////////////////////////////////
+    struct ManifestEntry
+    {
+        uint64_t contentHash;
+        std::vector<std::string> cookedPaths;
+    };
+
+    //FUNCTIONS//////////////////////////////////////////////////////////////////////////
+    void CookWorker(CookReport* report);
+    void CookSingleItem(CookItem& item);
+    void RemoveStaleOutputs(const CookItem& item) const;
+    bool AreOutputsPresent(const ManifestEntry& entry) const;
+    bool WriteCookedFile(const std::string& cookedPath, const std::vector<unsigned char>& cooked);
+    void LoadManifest();
+    void SaveManifest(const CookReport& report) const;
+
+    //MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
+    std::string m_sourceFolder;
+    std::string m_outputFolder;
+    unsigned int m_numThreads;
+    std::map<std::string, ManifestEntry> m_manifest;
+    std::atomic<unsigned int> m_nextItem;
+    std::mutex m_fbxLock; //The FBX SDK importer isn't safe to run on several threads at once
+    std::mutex m_directoryLock;
+    bool m_forceRebuild;
+};
+
@@ -0,0 +1,329 @@
+#include "Engine/Tools/NetSoak.hpp"
+#include "Engine/Net/UDPIP/LoopbackTransport.hpp"
+#include "Engine/Net/UDPIP/NetSession.hpp"
+#include "Engine/Net/UDPIP/NetConnection.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Time/Time.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Engine/Core/BuildConfig.hpp"
+#if defined(TRACK_MEMORY)
+#include "Engine/Core/Memory/MemoryTracking.hpp"
+#endif
+#include <algorithm>
+#include <stdio.h>
+
+const uint8_t NetSoak::MESSAGE_TYPES[NUM_MESSAGE_KINDS] = { (uint8_t)NetMessage::NUM_MESSAGES, (uint8_t)(NetMessage::NUM_MESSAGES + 1), (uint8_t)(NetMessage::NUM_MESSAGES + 2) };
+
+//Message callbacks are plain functions, so the run in progress is found through these
+static NetSoak::Report* s_runningReport = nullptr;
+static bool s_isMeasuring = false;
+
+//-----------------------------------------------------------------------------------
+NetSoak::Settings::Settings()
+    : numClients(16)
+    , measuredMs(10000)
+    , messagesPerTick(1)
+    , minPayloadBytes(16)
+    , maxPayloadBytes(128)
+    , seed(1)
+{
+    for (unsigned int kind = 0; kind < NUM_MESSAGE_KINDS; ++kind)
+    {
+        isKindEnabled[kind] = true;
+    }
+    link.minLatencyMs = 30;
+    link.jitterMs = 10;
+    link.lossRate = 0.01f;
+}
+
+//-----------------------------------------------------------------------------------
+NetSoak::Report::Report()
+    : numPayloadBytesDelivered(0)
+    , numWireBytesDelivered(0)
+    , numServerAllocations(0)
+    , numAllocations(0)
+    , numMeasuredTicks(0)
+    , seconds(0.0)
+{
+    for (unsigned int kind = 0; kind < NUM_MESSAGE_KINDS; ++kind)
+    {
+        numSent[kind] = 0;
+        numDelivered[kind] = 0;
+    }
+}
+
+//-----------------------------------------------------------------------------------
+NetSoak::NetSoak(const Settings& settings)
+    : m_settings(settings)
+{
+}
+
+//-----------------------------------------------------------------------------------
+bool NetSoak::AreSettingsValid() const
+{
+    return m_settings.numClients > 0
+        && m_settings.numClients < NetSession::MAX_CONNECTIONS
+        && m_settings.measuredMs >= TICK_MS
+        && m_settings.maxPayloadBytes <= MESSAGE_MTU - sizeof(uint32_t)
+        && m_settings.minPayloadBytes <= m_settings.maxPayloadBytes;
+}
+
+//-----------------------------------------------------------------------------------
+//The send window is the ticks in (WARMUP_MS, endSendMs]. Sends, server tick times and allocations are only taken inside it,
+//so every per-tick number is divided by the ticks it was counted over. Deliveries keep counting through the drain.
+NetSoak::Report NetSoak::Run()
+{
+    Report report;
+    unsigned int numMeasuredTicks = m_settings.measuredMs / TICK_MS;
+    for (unsigned int kind = 0; kind < NUM_MESSAGE_KINDS; ++kind)
+    {
+        report.latenciesMs[kind].reserve(m_settings.isKindEnabled[kind] ? numMeasuredTicks * m_settings.messagesPerTick * m_settings.numClients * 2 : 0);
+    }
+    report.serverTickMicroseconds.reserve(numMeasuredTicks);
+    s_runningReport = &report;
+
+    NetSimulator simulator(m_settings.seed);
+    simulator.SetDefaultLinkSettings(m_settings.link);
+    std::vector<NetSession*> sessions; //Host first
+    for (unsigned int i = 0; i <= m_settings.numClients; ++i)
+    {
+        sessions.push_back(CreateSession(simulator));
+    }
+    NetSession* host = sessions[0];
+    sockaddr_in hostAddress = host->GetAddress();
+    host->Host("soakhost");
+    for (unsigned int i = 1; i < sessions.size(); ++i)
+    {
+        sessions[i]->Join(Stringf("soakclient%u", i).c_str(), hostAddress);
+    }
+
+    uint32_t random = (m_settings.seed != 0) ? m_settings.seed : 1;
+    unsigned int payloadRange = m_settings.maxPayloadBytes - m_settings.minPayloadBytes + 1;
+    NetMessage msg;
+    const unsigned int endSendMs = WARMUP_MS + (numMeasuredTicks * TICK_MS);
+    const unsigned int endMs = endSendMs + DRAIN_MS;
+    double serverTickSeconds = 0.0;
+    size_t allocationsAtStart = 0;
+    double startSeconds = 0.0;
+    for (unsigned int nowMs = 1; nowMs <= endMs; ++nowMs)
+    {
+        if (nowMs == WARMUP_MS + 1)
+        {
+            s_isMeasuring = true;
+            allocationsAtStart = GetAllocationCount();
+            simulator.ResetStats();
+            startSeconds = GetCurrentTimeSeconds();
+        }
+        simulator.AdvanceTime(1.0);
+        bool isInSendWindow = nowMs > WARMUP_MS && nowMs <= endSendMs;
+        bool isSendTick = isInSendWindow && (nowMs % TICK_MS) == 0;
+        for (NetSession* session : sessions)
+        {
+            session->m_manualClockMs = (double)nowMs;
+            if (isSendTick && session->AmIConnected())
+            {
+                for (unsigned int activeIndex = 0; activeIndex < session->GetNumActiveConnections(); ++activeIndex)
+                {
+                    NetConnection* conn = session->GetActiveConnection(activeIndex);
+                    if (conn->IsMyConnection() || (session != host && !conn->IsHostConnection()))
+                    {
+                        continue;
+                    }
+                    for (unsigned int kind = 0; kind < NUM_MESSAGE_KINDS; ++kind)
+                    {
+                        for (unsigned int i = 0; m_settings.isKindEnabled[kind] && i < m_settings.messagesPerTick; ++i)
+                        {
+                            msg.m_type = MESSAGE_TYPES[kind];
+                            msg.SetReadableBytes(0);
+                            msg.Write<uint32_t>(nowMs);
+                            msg.Advance(Max<unsigned int>(m_settings.minPayloadBytes + (NextRandom(random) % payloadRange), sizeof(uint32_t)) - sizeof(uint32_t));
+                            conn->SendMessage(msg);
+                            ++report.numSent[kind];
+                        }
+                    }
+                }
+            }
+
+            if (session == host)
+            {
+                size_t allocationsBefore = GetAllocationCount();
+                double updateStartSeconds = GetCurrentTimeSeconds();
+                session->Update(0.001f);
+                serverTickSeconds += GetCurrentTimeSeconds() - updateStartSeconds;
+                report.numServerAllocations += isInSendWindow ? GetAllocationCount() - allocationsBefore : 0;
+            }
+            else
+            {
+                session->Update(0.001f);
+            }
+        }
+        if (nowMs % TICK_MS == 0)
+        {
+            //WARMUP_MS is a whole number of ticks, so each of these covers exactly the TICK_MS before it
+            if (isInSendWindow)
+            {
+                report.serverTickMicroseconds.push_back((float)(serverTickSeconds * 1000000.0));
+                ++report.numMeasuredTicks;
+            }
+            serverTickSeconds = 0.0;
+        }
+        if (nowMs == endSendMs)
+        {
+            report.numAllocations = GetAllocationCount() - allocationsAtStart;
+        }
+    }
+    report.seconds = GetCurrentTimeSeconds() - startSeconds;
+    report.numWireBytesDelivered = simulator.GetStats().numBytesDelivered;
+    s_isMeasuring = false;
+    for (unsigned int activeIndex = 0; activeIndex < host->GetNumActiveConnections(); ++activeIndex)
+    {
+        const NetConnectionTelemetry& telemetry = host->GetActiveConnection(activeIndex)->m_telemetry;
+        report.hostTelemetry.Accumulate(telemetry.GetTotals());
+        report.hostTelemetry.Accumulate(telemetry.GetCurrent());
+    }
+
+    for (NetSession* session : sessions)
+    {
+        session->Stop();
+        delete session;
+    }
+    s_runningReport = nullptr;
+    return report;
+}
+
+//-----------------------------------------------------------------------------------
+void NetSoak::PrintReport(Report& report) const
+{
+    unsigned int totalDelivered = 0;
+    for (unsigned int kind = 0; kind < NUM_MESSAGE_KINDS; ++kind)
+    {
+        if (!m_settings.isKindEnabled[kind])
+        {
+            continue;
+        }
+        totalDelivered += report.numDelivered[kind];
+        printf("%-10s: %u/%u delivered, latency p50 %.0fms p99 %.0fms\n", GetMessageKindName((MessageKind)kind), report.numDelivered[kind], report.numSent[kind],
+            GetPercentile(report.latenciesMs[kind], 0.5f), GetPercentile(report.latenciesMs[kind], 0.99f));
+    }
+    double measuredSeconds = (double)(report.numMeasuredTicks * TICK_MS) / 1000.0;
+    printf("Throughput: %.0f messages/s, %.1f KB/s of payload, %.0f KB/s on the wire (simulated), %.0f messages/s wall clock\n",
+        (double)totalDelivered / measuredSeconds, (double)report.numPayloadBytesDelivered / (1024.0 * measuredSeconds),
+        (double)report.numWireBytesDelivered / (1024.0 * measuredSeconds), (double)totalDelivered / Max<double>(report.seconds, 0.000001));
+    printf("Server connections: %u resends, %u duplicates, %u out of order, %u packets lost\n",
+        report.hostTelemetry.numResends, report.hostTelemetry.numDuplicates, report.hostTelemetry.numOutOfOrder, report.hostTelemetry.numPacketsLost);
+    float averageTickMicroseconds = 0.0f;
+    for (float tickMicroseconds : report.serverTickMicroseconds)
+    {
+        averageTickMicroseconds += tickMicroseconds / (float)report.serverTickMicroseconds.size();
+    }
+    printf("Server tick: avg %.1fus, p50 %.1fus, p99 %.1fus over %u ticks\n",
+        averageTickMicroseconds, GetPercentile(report.serverTickMicroseconds, 0.5f), GetPercentile(report.serverTickMicroseconds, 0.99f), report.numMeasuredTicks);
+    if (IsTrackingAllocations())
+    {
+        double numTicks = (double)Max<unsigned int>(report.numMeasuredTicks, 1);
+        printf("Allocations per tick: %.2f server, %.2f everything\n", (double)report.numServerAllocations / numTicks, (double)report.numAllocations / numTicks);
+    }
+    else
+    {
+        printf("Allocations per tick: not counted, build with TRACK_MEMORY\n");
+    }
+}
+
+//-----------------------------------------------------------------------------------
+const char* NetSoak::GetMessageKindName(MessageKind kind)
+{
+    switch (kind)
+    {
+    case RELIABLE:
+        return "reliable";
+    case IN_ORDER:
+        return "in order";
+    case UNRELIABLE:
+        return "unreliable";
+    default:
+        return "unknown";
+    }
+}
+
+//-----------------------------------------------------------------------------------
+float NetSoak::GetPercentile(std::vector<float>& values, float percentile)
+{
+    if (values.empty())
+    {
+        return 0.0f;
+    }
+    size_t index = Min<size_t>((size_t)(percentile * (float)values.size()), values.size() - 1);
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+//-----------------------------------------------------------------------------------
+bool NetSoak::IsTrackingAllocations()
+{
+#if defined(TRACK_MEMORY)
+    return true;
+#else
+    return false;
+#endif
+}
+
+//-----------------------------------------------------------------------------------
+NetSession* NetSoak::CreateSession(NetSimulator& simulator) const
+{
+    NetSession* session = new NetSession(1.0f / 60.0f);
+    session->m_packetChannel.SetTransport(new LoopbackTransport(&simulator));
+    session->RegisterCoreMessages();
+    const uint32_t OPTION_FLAGS[NUM_MESSAGE_KINDS] =
+    {
+        (uint32_t)NetMessage::Option::RELIABLE,
+        (uint32_t)NetMessage::Option::RELIABLE | (uint32_t)NetMessage::Option::INORDER,
+        (uint32_t)NetMessage::Option::UNRELIABLE,
+    };
+    for (unsigned int kind = 0; kind < NUM_MESSAGE_KINDS; ++kind)
+    {
+        session->RegisterMessage(MESSAGE_TYPES[kind], GetMessageKindName((MessageKind)kind), &NetSoak::OnMessage, OPTION_FLAGS[kind], (uint32_t)NetMessage::Control::NONE);
+    }
+    session->m_manualClockMs = simulator.GetTimeMilliseconds();
+    session->Start(Stringf("%u", PORT).c_str());
+    return session;
+}
+
+//-----------------------------------------------------------------------------------
+//Payloads start with when they were queued, the rest is filler
+void NetSoak::OnMessage(const NetSender& from, NetMessage& msg)
+{
+    if (!s_isMeasuring)
+    {
+        return;
+    }
+    uint32_t queuedTimeMs = 0;
+    size_t payloadBytes = msg.GetPayloadSize();
+    msg.Read<uint32_t>(queuedTimeMs);
+    unsigned int kind = (unsigned int)(std::find(MESSAGE_TYPES, MESSAGE_TYPES + NUM_MESSAGE_KINDS, msg.m_type) - MESSAGE_TYPES);
+    std::vector<float>& latencies = s_runningReport->latenciesMs[kind];
+    if (latencies.size() < latencies.capacity())
+    {
+        latencies.push_back((float)(from.session->GetNetTimeMilliseconds() - (double)queuedTimeMs));
+    }
+    ++s_runningReport->numDelivered[kind];
+    s_runningReport->numPayloadBytesDelivered += payloadBytes;
+}
+
+//-----------------------------------------------------------------------------------
+size_t NetSoak::GetAllocationCount()
+{
+#if defined(TRACK_MEMORY)
+    return g_memoryAnalytics.m_totalNumberOfAllocations;
+#else
+    return 0;
+#endif
+}
+
+//-----------------------------------------------------------------------------------
+uint32_t NetSoak::NextRandom(uint32_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <vector>
+#include <stdint.h>
+#include "Engine/Net/UDPIP/NetSimulator.hpp"
+#include "Engine/Net/UDPIP/NetConnectionTelemetry.hpp"
+
+class NetSession;
+class NetMessage;
+struct NetSender;
+
+//-----------------------------------------------------------------------------------
+//Headless soak benchmark for the whole net stack, repeatable for a given seed.
+//One host and a number of clients, each a whole NetSession on its own loopback transport, share a NetSimulator. After a warmup to join,
+//everyone streams the message mix at the other end of each of their connections every game tick, then the link drains.
+//Per-tick numbers (server tick time, allocations) only cover the send window, deliveries and latencies also count the drain.
+class NetSoak
+{
+public:
+    //ENUMS//////////////////////////////////////////////////////////////////////////
+    enum MessageKind
+    {
+        RELIABLE,
+        IN_ORDER,
+        UNRELIABLE,
+        NUM_MESSAGE_KINDS
+    };
+
+    //STRUCTS//////////////////////////////////////////////////////////////////////////
+    struct Settings
+    {
+        Settings();
+        unsigned int numClients;
+        unsigned int measuredMs;
+        bool isKindEnabled[NUM_MESSAGE_KINDS];
+        unsigned int messagesPerTick; //Of each enabled kind, from every client to the host and from the host to every client
+        unsigned int minPayloadBytes;
+        unsigned int maxPayloadBytes;
+        uint32_t seed;
+        NetSimulatorLinkSettings link;
+    };
+
+    struct Report
+    {
+        Report();
+        unsigned int numSent[NUM_MESSAGE_KINDS];
+        unsigned int numDelivered[NUM_MESSAGE_KINDS];
+        size_t numPayloadBytesDelivered;
+        size_t numWireBytesDelivered; //Whole packets, headers and acks included
+        std::vector<float> latenciesMs[NUM_MESSAGE_KINDS]; //Queued to processed, reserved up front so recording them doesn't allocate
+        std::vector<float> serverTickMicroseconds; //Host's Update calls added up over each measured game tick
+        size_t numServerAllocations; //While the host updated, over the measured ticks
+        size_t numAllocations; //Everything over the measured ticks, clients and the simulator included
+        unsigned int numMeasuredTicks;
+        double seconds;
+        NetTelemetrySample hostTelemetry; //Every host connection's counters added up, over the whole run
+    };
+
+    //CONSTRUCTORS//////////////////////////////////////////////////////////////////////////
+    NetSoak(const Settings& settings);
+
+    //FUNCTIONS//////////////////////////////////////////////////////////////////////////
+    bool AreSettingsValid() const;
+    Report Run();
+    void PrintReport(Report& report) const; //Sorts the samples in the report to find percentiles
+
+    //STATIC FUNCTIONS//////////////////////////////////////////////////////////////////////////
+    static const char* GetMessageKindName(MessageKind kind);
+    static float GetPercentile(std::vector<float>& values, float percentile);
+    static bool IsTrackingAllocations();
+
+    //CONSTANTS//////////////////////////////////////////////////////////////////////////
+    static const unsigned int TICK_MS = 16;
+    static const unsigned int WARMUP_MS = 2000; //Joining and pools filling up, not measured. A whole number of ticks.
+    static const unsigned int DRAIN_MS = 2000; //After the last send, so reliables in flight still count
+    static const uint16_t PORT = 4500;
+    static const uint8_t MESSAGE_TYPES[NUM_MESSAGE_KINDS]; //Registered after the core messages on every session the soak creates
+
+private:
+    //FUNCTIONS//////////////////////////////////////////////////////////////////////////
+    NetSession* CreateSession(NetSimulator& simulator) const;
+    static void OnMessage(const NetSender& from, NetMessage& msg);
+    static size_t GetAllocationCount();
+    static uint32_t NextRandom(uint32_t& state);
+
+    //MEMBER VARIABLES//////////////////////////////////////////////////////////////////////////
+    Settings m_settings;
+};
@@ -17,8 +17,25 @@ extern AnimationMotion* g_loadedMotion;
     #include "ThirdParty/FBX/include/fbxsdk.h"
     #include "../Math/Vector4Int.hpp"
     #include "../Input/InputOutputUtils.hpp"
+    #include "../Time/Time.hpp"
+    #include "../Math/MathUtils.hpp"
+    #include <map>
+    #include <thread>
+    #include <atomic>
+    #include <functional>
+    #include <algorithm>
     #pragma comment(lib, "libfbxsdk-md.lib")
 
+    //-----------------------------------------------------------------------------------
+    static void PrintImportTimings(const FbxImportTimings& timings)
+    {
+        Console::instance->PrintLine(Stringf("Import took %.1fms on %u threads: load %.1fms, triangulate %.1fms, skeletons %.1fms, gather %.1fms, extraction %.1fms",
+            timings.totalSeconds * 1000.0, timings.numThreads, timings.loadSeconds * 1000.0, timings.triangulateSeconds * 1000.0,
+            timings.skeletonSeconds * 1000.0, timings.gatherSeconds * 1000.0, timings.extractionSeconds * 1000.0), RGBA::GREEN);
+        Console::instance->PrintLine(Stringf("    extraction tasks: skin weights %.1fms, vertices %.1fms, motions %.1fms",
+            timings.skinWeightSeconds * 1000.0, timings.vertexSeconds * 1000.0, timings.motionSeconds * 1000.0), RGBA::GREEN);
+    }
+
     //-----------------------------------------------------------------------------------
     CONSOLE_COMMAND(fbxlist)
     {
@@ -68,6 +85,7 @@ extern AnimationMotion* g_loadedMotion;
         {
             Console::instance->PrintLine(Stringf("Loaded '%s'. Had %i meshes.", filename.c_str(), import->meshes.size()));
             DebuggerPrintf("Loaded '%s'. Had %i meshes.", filename.c_str(), import->meshes.size());
+            PrintImportTimings(import->timings);
 
             if (shouldMerge) //This currently pulls in all of the other loading skeleton code and motion under here. We'll want to re-enable support for these later.
             {
@@ -259,91 +277,129 @@ extern AnimationMotion* g_loadedMotion;
     }
 
     //-----------------------------------------------------------------------------------
-    static bool GetPosition(Vector3* outPosition, const Matrix4x4& transform, FbxMesh* mesh, int polyIndex, int vertIndex)
+    //Copy of one FBX layer element. Extraction tasks only ever read these copies, never the SDK objects.
+    template <typename ElemType>
+    struct ElementSource
+    {
+        ElementSource() : mappingMode(FbxGeometryElement::eNone), referenceMode(FbxGeometryElement::eDirect) {};
+        std::vector<ElemType> direct;
+        std::vector<int> indices;
+        FbxGeometryElement::EMappingMode mappingMode;
+        FbxGeometryElement::EReferenceMode referenceMode;
+    };
+
+    //-----------------------------------------------------------------------------------
+    struct ClusterSource
+    {
+        int jointIndex;
+        std::vector<int> controlPointIndices;
+        std::vector<double> weights;
+    };
+
+    //-----------------------------------------------------------------------------------
+    //Everything needed to build one mesh, gathered from the SDK up front on the importing thread.
+    struct MeshExtraction
+    {
+        Matrix4x4 transform;
+        std::vector<FbxVector4> controlPoints;
+        std::vector<int> polygonVertices;
+        int polygonCount;
+        ElementSource<FbxVector4> normals;
+        ElementSource<FbxVector2> uvs;
+        ElementSource<FbxColor> colors;
+        std::string materialName;
+        bool hasSkinWeights;
+        std::vector<ClusterSource> clusters;
+        std::vector<SkinWeight> skinWeights;
+        double skinWeightSeconds;
+        double vertexSeconds;
+    };
+
+    //-----------------------------------------------------------------------------------
+    template <typename ElemType, typename FbxElementType>
+    static void CopyElement(ElementSource<ElemType>& outSource, FbxElementType* elem)
     {
-        FbxVector4 fbxPosition;
-        int controlIndex = mesh->GetPolygonVertex(polyIndex, vertIndex);
-        fbxPosition = mesh->GetControlPointAt(controlIndex);
-        *outPosition = Vector3(Vector4(ToEngineVec3(fbxPosition), 1.0f) * transform);
+        if (nullptr == elem)
+        {
+            return;
+        }
+        outSource.mappingMode = elem->GetMappingMode();
+        outSource.referenceMode = elem->GetReferenceMode();
+
+        FbxLayerElementArrayTemplate<ElemType>& directArray = elem->GetDirectArray();
+        ElemType* direct = directArray.GetLocked((ElemType*)nullptr, FbxLayerElementArray::eReadLock);
+        outSource.direct.assign(direct, direct + directArray.GetCount());
+        directArray.Release((void**)&direct);
+
+        if (outSource.referenceMode == FbxGeometryElement::eIndexToDirect)
+        {
+            FbxLayerElementArrayTemplate<int>& indexArray = elem->GetIndexArray();
+            int* indices = indexArray.GetLocked((int*)nullptr, FbxLayerElementArray::eReadLock);
+            outSource.indices.assign(indices, indices + indexArray.GetCount());
+            indexArray.Release((void**)&indices);
+        }
+    }
+
+    //-----------------------------------------------------------------------------------
+    static bool GetPosition(Vector3* outPosition, const MeshExtraction& extraction, int polyIndex, int vertIndex)
+    {
+        int controlIndex = extraction.polygonVertices[(polyIndex * 3) + vertIndex];
+        const FbxVector4& fbxPosition = extraction.controlPoints[controlIndex];
+        *outPosition = Vector3(Vector4(ToEngineVec3(fbxPosition), 1.0f) * extraction.transform);
         return true;
     }
 
     //-----------------------------------------------------------------------------------
     template <typename ElemType, typename VarType>
-    static bool GetObjectFromElement(FbxMesh* mesh, int polyIndex, int vertIndex, ElemType* elem, VarType* outVar)
+    static bool GetObjectFromElement(const MeshExtraction& extraction, int polyIndex, int vertIndex, const ElementSource<ElemType>& elem, VarType* outVar)
     {
-        if (nullptr == elem)
+        if (elem.direct.empty())
         {
             return false;
         }
-        switch(elem->GetMappingMode())
+        int elementIndex = 0;
+        switch(elem.mappingMode)
         {
             case FbxGeometryElement::eByControlPoint:
+                elementIndex = extraction.polygonVertices[(polyIndex * 3) + vertIndex];
+                break;
+            case FbxGeometryElement::eByPolygonVertex:
+                elementIndex = (polyIndex * 3) + vertIndex;
+                break;
+            default:
+                ERROR_AND_DIE("Undefined Mapping Mode")
+                break;
+        }
+        switch (elem.referenceMode)
+        {
+        case FbxGeometryElement::eDirect:
+            if (elementIndex < (int)elem.direct.size())
             {
-                int controlIndex = mesh->GetPolygonVertex(polyIndex, vertIndex);
-                switch (elem->GetReferenceMode())
-                {
-                case FbxGeometryElement::eDirect:
-                    if (controlIndex < elem->GetDirectArray().GetCount())
-                    {
-                        *outVar = elem->GetDirectArray().GetAt(controlIndex);
-                        return true;
-                    }
-                    break;
-                case FbxGeometryElement::eIndexToDirect:
-                    if (controlIndex < elem->GetIndexArray().GetCount())
-                    {
-                        int index = elem->GetIndexArray().GetAt(controlIndex);
-                        *outVar = elem->GetDirectArray().GetAt(index);
-                        return true;
-                    }
-                    break;
-                default:
-                    break;
-                }
+                *outVar = elem.direct[elementIndex];
+                return true;
             }
             break;
-            case FbxGeometryElement::eByPolygonVertex:
+        case FbxGeometryElement::eIndexToDirect:
+            if (elementIndex < (int)elem.indices.size())
             {
-                int directVertexIndex = (polyIndex * 3) + vertIndex;
-                switch (elem->GetReferenceMode())
-                {
-                case FbxGeometryElement::eDirect:
-                    if (directVertexIndex < elem->GetDirectArray().GetCount())
-                    {
-                        *outVar = elem->GetDirectArray().GetAt(directVertexIndex);
-                        return true;
-                    }
-                    break;
-                case FbxGeometryElement::eIndexToDirect:
-                    if (directVertexIndex < elem->GetIndexArray().GetCount())
-                    {
-                        int index = elem->GetIndexArray().GetAt(directVertexIndex);
-                        *outVar = elem->GetDirectArray().GetAt(index);
-                        return true;
-                    }
-                    break;
-                default:
-                    break;
-                }
+                *outVar = elem.direct[elem.indices[elementIndex]];
+                return true;
             }
             break;
-            default:
-                ERROR_AND_DIE("Undefined Mapping Mode")
-                break;
+        default:
+            break;
         }
         return false;
     }
 
     //-----------------------------------------------------------------------------------
-    static bool GetNormal(Vector3& outNormal, const Matrix4x4& transform, FbxMesh* mesh, int polyIndex, int vertIndex)
+    static bool GetNormal(Vector3& outNormal, const MeshExtraction& extraction, int polyIndex, int vertIndex)
     {
         FbxVector4 normal;
-        FbxGeometryElementNormal* normals = mesh->GetElementNormal(0);
-        if (GetObjectFromElement(mesh, polyIndex, vertIndex, normals, &normal))
+        if (GetObjectFromElement(extraction, polyIndex, vertIndex, extraction.normals, &normal))
         {
             Vector3 n = ToEngineVec3(normal);
-            outNormal = Vector3(Vector4(n, 0.0f) * transform);
+            outNormal = Vector3(Vector4(n, 0.0f) * extraction.transform);
             return true;
         }
 
@@ -351,11 +407,10 @@ extern AnimationMotion* g_loadedMotion;
     }
 
     //-----------------------------------------------------------------------------------
-    static bool GetUV(Vector2& outUV, FbxMesh* mesh, int polyIndex, int vertIndex, int uvIndex)
+    static bool GetUV(Vector2& outUV, const MeshExtraction& extraction, int polyIndex, int vertIndex)
     {
         FbxVector2 uv;
-        FbxGeometryElementUV* uvs = mesh->GetElementUV(uvIndex);
-        if (GetObjectFromElement(mesh, polyIndex, vertIndex, uvs, &uv))
+        if (GetObjectFromElement(extraction, polyIndex, vertIndex, extraction.uvs, &uv))
         {
             outUV = Vector2((float)uv.mData[0], (float)uv.mData[1]);
             return true;
@@ -365,11 +420,10 @@ extern AnimationMotion* g_loadedMotion;
     }
 
     //-----------------------------------------------------------------------------------
-    static bool GetColor(RGBA& outColor, FbxMesh* mesh, int polyIndex, int vertIndex)
+    static bool GetColor(RGBA& outColor, const MeshExtraction& extraction, int polyIndex, int vertIndex)
     {
         FbxColor color;
-        FbxGeometryElementVertexColor* colors = mesh->GetElementVertexColor(0);
-        if (GetObjectFromElement(mesh, polyIndex, vertIndex, colors, &color))
+        if (GetObjectFromElement(extraction, polyIndex, vertIndex, extraction.colors, &color))
         {
             outColor = ToEngineRGBA(color);
             return true;
@@ -379,10 +433,10 @@ extern AnimationMotion* g_loadedMotion;
     }
 
     //-----------------------------------------------------------------------------------
-    static void ImportVertex(MeshBuilder& builder, const Matrix4x4& transform, FbxMesh* mesh, int polyIndex, int vertIndex, std::vector<SkinWeight>& skinWeights)
+    static void ImportVertex(MeshBuilder& builder, const MeshExtraction& extraction, int polyIndex, int vertIndex)
     {
         Vector3 normal;
-        if (GetNormal(normal, transform, mesh, polyIndex, vertIndex))
+        if (GetNormal(normal, extraction, polyIndex, vertIndex))
         {
             builder.SetNormal(normal);
 
@@ -400,23 +454,23 @@ extern AnimationMotion* g_loadedMotion;
         }
         
         RGBA color;
-        if (GetColor(color, mesh, polyIndex, vertIndex))
+        if (GetColor(color, extraction, polyIndex, vertIndex))
         {
             builder.SetColor(color);
         }
 
         Vector2 uv;
-        if (GetUV(uv, mesh, polyIndex, vertIndex, 0))
+        if (GetUV(uv, extraction, polyIndex, vertIndex))
         {
             uv.y = 1.0f - uv.y; //STBI loads in textures upside down, this fixes it.
             builder.SetUV(uv);
         }
 
         //Set Skin Weights
-        int controlIndex = mesh->GetPolygonVertex(polyIndex, vertIndex);
-        if (controlIndex < skinWeights.size())
+        unsigned int controlIndex = (unsigned int)extraction.polygonVertices[(polyIndex * 3) + vertIndex];
+        if (controlIndex < extraction.skinWeights.size())
         {
-            builder.SetBoneWeights(skinWeights[controlIndex].indices, skinWeights[controlIndex].weights);
+            builder.SetBoneWeights(extraction.skinWeights[controlIndex].indices, extraction.skinWeights[controlIndex].weights);
             builder.RenormalizeSkinWeights(); //Just to be safe.
         }
         else
@@ -425,7 +479,7 @@ extern AnimationMotion* g_loadedMotion;
         }
 
         Vector3 position;
-        if (GetPosition(&position, transform, mesh, polyIndex, vertIndex))
+        if (GetPosition(&position, extraction, polyIndex, vertIndex))
         {
             builder.AddVertex(position);
         }
@@ -504,15 +558,8 @@ extern AnimationMotion* g_loadedMotion;
     }
 
     //-----------------------------------------------------------------------------------
-    static void GetSkinWeights(SceneImport* import, std::vector<SkinWeight>& skinWeights, const FbxMesh* mesh, std::map<int, FbxNode*>& nodeToJointIndex)
+    static void GatherSkinClusters(MeshExtraction& extraction, const FbxMesh* mesh, const std::map<const FbxNode*, int>& jointIndexByNode)
     {
-        int controlPointCount = mesh->GetControlPointsCount();
-        skinWeights.resize(controlPointCount);
-        for (size_t i = 0; i < skinWeights.size(); ++i) 
-        {
-            skinWeights[i].indices = Vector4Int(0, 0, 0, 0);
-            skinWeights[i].weights = Vector4(0.0f, 0.0f, 0.0f, 0.0f);
-        }
         int deformerCount = mesh->GetDeformerCount((FbxDeformer::eSkin));
         ASSERT_OR_DIE(deformerCount == 1, "Deformer count wasn't 1");
 
@@ -533,38 +580,43 @@ extern AnimationMotion* g_loadedMotion;
                 const FbxNode* linkNode = cluster->GetLink();
 
                 //Not associated with a bone? Ignore it, we don't care about it
-                if (linkNode == nullptr)
-                {
-                    continue;
-                }
-
-                int jointIndex = Skeleton::INVALID_JOINT_INDEX;
-                for (auto iter = nodeToJointIndex.begin(); iter != nodeToJointIndex.end(); ++iter)
-                {
-                    if (iter->second == linkNode)
-                    {
-                        jointIndex = iter->first;
-                        break;
-                    }
-                }
-
-                if (jointIndex == Skeleton::INVALID_JOINT_INDEX)
+                auto jointIter = jointIndexByNode.find(linkNode);
+                if (linkNode == nullptr || jointIter == jointIndexByNode.end())
                 {
                     continue;
                 }
 
                 int* controlPointIndices = cluster->GetControlPointIndices();
-                int indexCount = cluster->GetControlPointIndicesCount();
                 double* weights = cluster->GetControlPointWeights();
+                int indexCount = cluster->GetControlPointIndicesCount();
 
-                for (int i = 0; i < indexCount; ++i)
-                {
-                    int controlIndex = controlPointIndices[i];
-                    double weight = weights[i];
+                ClusterSource source;
+                source.jointIndex = jointIter->second;
+                source.controlPointIndices.assign(controlPointIndices, controlPointIndices + indexCount);
+                source.weights.assign(weights, weights + indexCount);
+                extraction.clusters.push_back(source);
+            }
+        }
+    }
 
-                    SkinWeight* skinWeight = &skinWeights[controlIndex];
-                    AddHighestWeightWhileKickingTheLowestWeightOut(skinWeight, jointIndex, (float)weight);
-                }
+    //-----------------------------------------------------------------------------------
+    static void CalculateSkinWeights(MeshExtraction& extraction)
+    {
+        double startTime = GetCurrentTimeSeconds();
+        std::vector<SkinWeight>& skinWeights = extraction.skinWeights;
+        skinWeights.resize(extraction.controlPoints.size());
+        for (size_t i = 0; i < skinWeights.size(); ++i) 
+        {
+            skinWeights[i].indices = Vector4Int(0, 0, 0, 0);
+            skinWeights[i].weights = Vector4(0.0f, 0.0f, 0.0f, 0.0f);
+        }
+
+        for (const ClusterSource& cluster : extraction.clusters)
+        {
+            for (unsigned int i = 0; i < cluster.controlPointIndices.size(); ++i)
+            {
+                SkinWeight* skinWeight = &skinWeights[cluster.controlPointIndices[i]];
+                AddHighestWeightWhileKickingTheLowestWeightOut(skinWeight, cluster.jointIndex, (float)cluster.weights[i]);
             }
         }
 
@@ -584,103 +636,66 @@ extern AnimationMotion* g_loadedMotion;
                 sw.weights = { 1.0f, 0.0f, 0.0f, 0.0f };
             }
         }
+        extraction.skinWeightSeconds = GetCurrentTimeSeconds() - startTime;
     }
 
-    //THIS MUST HAPPEN AFTER IMPORTING SKELETONS.
     //-----------------------------------------------------------------------------------
-    static void ImportMesh(SceneImport* import, FbxMesh* mesh, MatrixStack4x4& matrixStack, std::map<int, FbxNode*>& nodeToJointIndex)
+    static void ExtractMeshVertices(MeshExtraction& extraction, MeshBuilder& builder)
     {
-        MeshBuilder builder = MeshBuilder();
-        ASSERT_OR_DIE(mesh->IsTriangleMesh(), "Was unable to load the mesh, it's not a triangle mesh!");
-        Matrix4x4 geoTransform = GetGeometricTransform(mesh);
-        matrixStack.Push(geoTransform);
-
-        int controlPointCount = mesh->GetControlPointsCount();
-
-        //Figure out our weighs for all verts before importing any of them
-        std::vector<SkinWeight> skinWeights;
-        if (HasSkinWeights(mesh))
-        {
-            skinWeights.resize(controlPointCount);
-            GetSkinWeights(import, skinWeights, mesh, nodeToJointIndex);
-        }
-        else
-        {
-            FbxNode* node = mesh->GetNode();
-            //Walk tree up till you reach the node associated with that joint.
-            //Find the first parent node that has a joint associated with it
-            //All vertices (fully weighted)
-            //All Skin Weights = indices{jointINdex, 0, 0, 0 } weights{1.0f, 0.0f, 0.0f, 0.0f};
-
-            int jointIndex = Skeleton::INVALID_JOINT_INDEX;
-            for (auto iter = nodeToJointIndex.begin(); iter != nodeToJointIndex.end(); ++iter)
-            {
-                if (iter->second == node)
-                {
-                    jointIndex = iter->first;
-                    break;
-                }
-            }
-
-            if (jointIndex == Skeleton::INVALID_JOINT_INDEX)
-            {
-                for (unsigned int i = 0; i < skinWeights.size(); ++i)
-                {
-                    skinWeights[i].indices = Vector4Int::ZERO;
-                    skinWeights[i].weights = Vector4::UNIT_X;
-                }
-            }
-            else
-            {
-                for (unsigned int i = 0; i < skinWeights.size(); ++i)
-                {
-                    skinWeights[i].indices = Vector4Int(jointIndex, 0, 0, 0);
-                    skinWeights[i].weights = Vector4::UNIT_X;
-                }
-            }
-        }
-
+        double startTime = GetCurrentTimeSeconds();
         builder.Begin();
         {
-            Matrix4x4 transform = matrixStack.GetTop();
-            int polyCount = mesh->GetPolygonCount();
-            for (int polyIndex = 0; polyIndex < polyCount; ++polyIndex)
+            for (int polyIndex = 0; polyIndex < extraction.polygonCount; ++polyIndex)
             {
-                int vertCount = mesh->GetPolygonSize(polyIndex);
-                ASSERT_OR_DIE(vertCount == 3, "Vertex count was not 3");
-                for (int vertIndex = 0; vertIndex < vertCount; ++vertIndex)
+                for (int vertIndex = 0; vertIndex < 3; ++vertIndex)
                 {
-                    ImportVertex(builder, transform, mesh, polyIndex, vertIndex, skinWeights);
+                    ImportVertex(builder, extraction, polyIndex, vertIndex);
                 }
             }
         }
         builder.End();
 
-        FbxSurfaceMaterial* material = mesh->GetNode()->GetMaterial(0);
-        builder.SetMaterialName(material->GetName());
-
-        matrixStack.Pop();
-
-        import->meshes.push_back(builder);
+        builder.SetMaterialName(extraction.materialName.c_str());
+        extraction.vertexSeconds = GetCurrentTimeSeconds() - startTime;
     }
 
+    //THIS MUST HAPPEN AFTER IMPORTING SKELETONS.
+    //Copies the mesh out of the SDK so building it can happen on any thread. Meshes without a skin keep an empty
+    //skinWeights list and get cleared bone weights, same as they always have.
     //-----------------------------------------------------------------------------------
-    static void ImportNodeAttribute(SceneImport* import, FbxNodeAttribute* attrib, MatrixStack4x4& matrixStack, std::map<int, FbxNode*>& nodeToJointIndex)
+    static void GatherMesh(std::vector<MeshExtraction>& extractions, FbxMesh* mesh, MatrixStack4x4& matrixStack, const std::map<const FbxNode*, int>& jointIndexByNode)
     {
-        if (attrib == nullptr)
+        ASSERT_OR_DIE(mesh->IsTriangleMesh(), "Was unable to load the mesh, it's not a triangle mesh!");
+        Matrix4x4 geoTransform = GetGeometricTransform(mesh);
+        matrixStack.Push(geoTransform);
+
+        extractions.emplace_back();
+        MeshExtraction& extraction = extractions.back();
+        extraction.transform = matrixStack.GetTop();
+        extraction.skinWeightSeconds = 0.0;
+        extraction.vertexSeconds = 0.0;
+
+        FbxVector4* controlPoints = mesh->GetControlPoints();
+        extraction.controlPoints.assign(controlPoints, controlPoints + mesh->GetControlPointsCount());
+        extraction.polygonCount = mesh->GetPolygonCount();
+        int* polygonVertices = mesh->GetPolygonVertices();
+        ASSERT_OR_DIE(mesh->GetPolygonVertexCount() == extraction.polygonCount * 3, "Vertex count was not 3");
+        extraction.polygonVertices.assign(polygonVertices, polygonVertices + mesh->GetPolygonVertexCount());
+
+        CopyElement(extraction.normals, mesh->GetElementNormal(0));
+        CopyElement(extraction.uvs, mesh->GetElementUV(0));
+        CopyElement(extraction.colors, mesh->GetElementVertexColor(0));
+
+        extraction.hasSkinWeights = HasSkinWeights(mesh);
+        if (extraction.hasSkinWeights)
         {
-            return;
+            GatherSkinClusters(extraction, mesh, jointIndexByNode);
         }
 
-        switch (attrib->GetAttributeType())
-        {
-        case FbxNodeAttribute::eMesh:
-            ImportMesh(import, (FbxMesh*)attrib, matrixStack, nodeToJointIndex);
-            break;
+        FbxSurfaceMaterial* material = mesh->GetNode()->GetMaterial(0);
+        extraction.materialName = material ? material->GetName() : "";
 
-        default:
-            break;
-        }
+        matrixStack.Pop();
     }
 
     //-----------------------------------------------------------------------------------
@@ -691,7 +706,7 @@ extern AnimationMotion* g_loadedMotion;
     }
 
     //-----------------------------------------------------------------------------------
-    static void ImportSceneNode(SceneImport* import, FbxNode* node, MatrixStack4x4& matrixStack, std::map<int, FbxNode*>& nodeToJointIndex)
+    static void GatherSceneNode(std::vector<MeshExtraction>& extractions, FbxNode* node, MatrixStack4x4& matrixStack, const std::map<const FbxNode*, int>& jointIndexByNode)
     {
         if (node == nullptr)
         {
@@ -705,24 +720,54 @@ extern AnimationMotion* g_loadedMotion;
         int attributeCount = node->GetNodeAttributeCount();
         for (int attributeIndex = 0; attributeIndex < attributeCount; ++attributeIndex)
         {
-            ImportNodeAttribute(import, node->GetNodeAttributeByIndex(attributeIndex), matrixStack, nodeToJointIndex);
+            FbxNodeAttribute* attrib = node->GetNodeAttributeByIndex(attributeIndex);
+            if ((attrib != nullptr) && (attrib->GetAttributeType() == FbxNodeAttribute::eMesh))
+            {
+                GatherMesh(extractions, (FbxMesh*)attrib, matrixStack, jointIndexByNode);
+            }
         }
 
         //Import Children
         int childCount = node->GetChildCount();
         for (int childIndex = 0; childIndex < childCount; ++childIndex)
         {
-            ImportSceneNode(import, node->GetChild(childIndex), matrixStack, nodeToJointIndex);
+            GatherSceneNode(extractions, node->GetChild(childIndex), matrixStack, jointIndexByNode);
         }
 
         matrixStack.Pop();
     }
 
     //-----------------------------------------------------------------------------------
+    static void CollectMeshAttributes(FbxNode* node, std::vector<FbxNodeAttribute*>& outMeshes)
+    {
+        for (int attributeIndex = 0; attributeIndex < node->GetNodeAttributeCount(); ++attributeIndex)
+        {
+            FbxNodeAttribute* attrib = node->GetNodeAttributeByIndex(attributeIndex);
+            if ((attrib != nullptr) && (attrib->GetAttributeType() == FbxNodeAttribute::eMesh))
+            {
+                outMeshes.push_back(attrib);
+            }
+        }
+        for (int childIndex = 0; childIndex < node->GetChildCount(); ++childIndex)
+        {
+            CollectMeshAttributes(node->GetChild(childIndex), outMeshes);
+        }
+    }
+
+    //-----------------------------------------------------------------------------------
+    //Only converts meshes that actually have quads or ngons, exported game meshes are usually triangulated already.
     static void TriangulateScene(FbxScene* scene)
     {
+        std::vector<FbxNodeAttribute*> meshes;
+        CollectMeshAttributes(scene->GetRootNode(), meshes);
         FbxGeometryConverter converter(scene->GetFbxManager());
-        converter.Triangulate(scene, true); //True if we should replace the node, false if we want to make new nodes
+        for (FbxNodeAttribute* mesh : meshes)
+        {
+            if (!((FbxMesh*)mesh)->IsTriangleMesh())
+            {
+                converter.Triangulate(mesh, true); //True if we should replace the node, false if we want to make new nodes
+            }
+        }
     }
 
     //-----------------------------------------------------------------------------------
@@ -825,36 +870,32 @@ extern AnimationMotion* g_loadedMotion;
     }
 
     //-----------------------------------------------------------------------------------
-    static void ImportMotions(SceneImport* import, FbxScene* scene, Matrix4x4& matrixStackTop, std::map<int, FbxNode*>& map, float framerate)
+    //Sampling goes through the SDK's animation evaluator, which isn't thread safe, so every motion is sampled on one task.
+    //Frames are the outer loop so the evaluator's per-time cache of parent transforms gets reused by every joint in a frame.
+    static void SampleMotions(std::vector<AnimationMotion*>& outMotions, FbxScene* scene, const Matrix4x4& importTransform, const std::vector<Skeleton*>& skeletons, std::map<int, FbxNode*>& map, float framerate)
     {
         int animationCount = scene->GetSrcObjectCount<FbxAnimStack>();
         if (animationCount == 0)
         {
             return;
         }
-        if (import->skeletons.size() == 0)
+        if (skeletons.size() == 0)
         {
             return;
         }
 
-        //Timing information for animation in this scene. How fast is the framerate in this file?
-        FbxGlobalSettings& settings = scene->GetGlobalSettings();
-        FbxTime::EMode timeMode = settings.GetTimeMode();
-        double sceneFramerate;
-        if (timeMode == FbxTime::eCustom)
-        {
-            sceneFramerate = settings.GetCustomFrameRate();
-        }
-        else
-        {
-            sceneFramerate = FbxTime::GetFrameRate(timeMode);
-        }
-
         //Only supporting one skeleton for now, update when needed.
-        uint32_t skeletonCount = import->skeletons.size();
-        Skeleton* skeleton= import->skeletons.at(0);
+        uint32_t skeletonCount = skeletons.size();
+        Skeleton* skeleton = skeletons.at(0);
         ASSERT_OR_DIE(skeletonCount == 1, "Had multiple skeletons, we only support 1!");
 
+        int jointCount = skeleton->GetJointCount();
+        std::vector<FbxNode*> jointNodes(jointCount);
+        for (int jointIndex = 0; jointIndex < jointCount; ++jointIndex)
+        {
+            jointNodes[jointIndex] = map[jointIndex];
+        }
+
         //Time between frames
         FbxTime advance;
         advance.SetSecondDouble((double)(1.0f / framerate));
@@ -862,7 +903,7 @@ extern AnimationMotion* g_loadedMotion;
         for (int animIndex = 0; animIndex < animationCount; ++animIndex)
         {
             //Import Motions
-            FbxAnimStack* anim = scene->GetSrcObject<FbxAnimStack>();
+            FbxAnimStack* anim = scene->GetSrcObject<FbxAnimStack>(animIndex);
             if (nullptr == anim)
             {
                 continue;
@@ -878,42 +919,134 @@ extern AnimationMotion* g_loadedMotion;
             float timeSpan = duration.GetSecondDouble();
             AnimationMotion* motion = new AnimationMotion(motionName, timeSpan, framerate, skeleton);
 
-            int jointCount = skeleton->GetJointCount();
-            for (int jointIndex = 0; jointIndex < jointCount; ++jointIndex)
+            FbxTime evalTime = FbxTime(0);
+            for (uint32_t frameIndex = 0; frameIndex < motion->m_frameCount; ++frameIndex)
             {
-                FbxNode* node = map[jointIndex];
-
-                //Extracting world position
-                //local, you would need to grab parent as well
-                Matrix4x4* boneKeyframes = motion->GetJointKeyframes(jointIndex);
-
-                FbxTime evalTime = FbxTime(0);
-                for (uint32_t frameIndex = 0; frameIndex < motion->m_frameCount; ++frameIndex)
+                for (int jointIndex = 0; jointIndex < jointCount; ++jointIndex)
                 {
-                    Matrix4x4* boneKeyframe = boneKeyframes + frameIndex;
-
-                    Matrix4x4 boneTransform = GetNodeWorldTransformAtTime(node, evalTime, matrixStackTop);
-                    double seconds = evalTime.GetSecondDouble();
-                    seconds = seconds;
-                    *boneKeyframe = boneTransform;
-
-                    evalTime += advance;
+                    //Extracting world position
+                    //local, you would need to grab parent as well
+                    Matrix4x4* boneKeyframe = motion->GetJointKeyframes(jointIndex) + frameIndex;
+                    *boneKeyframe = GetNodeWorldTransformAtTime(jointNodes[jointIndex], evalTime, importTransform);
                 }
+                evalTime += advance;
             }
-            import->motions.push_back(motion);
+            outMotions.push_back(motion);
         }
     }
 
     //-----------------------------------------------------------------------------------
-    static void ImportScene(SceneImport* import, FbxScene* scene, MatrixStack4x4& matrixStack)
+    //Runs every task once across numThreads threads, the calling thread included. Tasks are handed out in order.
+    static void RunTasks(std::vector<std::function<void()>>& tasks, unsigned int numThreads)
     {
-        std::map<int, FbxNode*> nodeToJointIndex;
+        std::atomic<unsigned int> nextTask(0);
+        auto worker = [&tasks, &nextTask]()
+        {
+            for (unsigned int taskIndex = nextTask++; taskIndex < tasks.size(); taskIndex = nextTask++)
+            {
+                tasks[taskIndex]();
+            }
+        };
+
+        std::vector<std::thread> helpers;
+        unsigned int numHelpers = Min<unsigned int>(numThreads, tasks.size());
+        for (unsigned int i = 1; i < numHelpers; ++i)
+        {
+            helpers.push_back(std::thread(worker));
+        }
+        worker();
+        for (std::thread& helper : helpers)
+        {
+            helper.join();
+        }
+    }
+
+    //-----------------------------------------------------------------------------------
+    //Everything that talks to the SDK's scene graph (triangulation, skeletons, gathering mesh data) runs up front on this thread.
+    //After that skin weights and vertices are built as independent tasks per mesh while motions are sampled alongside them.
+    static void ImportScene(SceneImport* import, FbxScene* scene, MatrixStack4x4& matrixStack, unsigned int numThreads)
+    {
+        FbxImportTimings& timings = import->timings;
+        timings.numThreads = numThreads;
+
+        double stageStart = GetCurrentTimeSeconds();
         TriangulateScene(scene);
+        timings.triangulateSeconds = GetCurrentTimeSeconds() - stageStart;
+
+        stageStart = GetCurrentTimeSeconds();
+        std::map<int, FbxNode*> nodeToJointIndex;
         FbxNode* root = scene->GetRootNode();
         ImportSkeletons(import, root, matrixStack, nullptr, -1, nodeToJointIndex);
-        ImportSceneNode(import, root, matrixStack, nodeToJointIndex);
+        std::map<const FbxNode*, int> jointIndexByNode;
+        for (auto iter = nodeToJointIndex.begin(); iter != nodeToJointIndex.end(); ++iter)
+        {
+            jointIndexByNode[iter->second] = iter->first;
+        }
+        timings.skeletonSeconds = GetCurrentTimeSeconds() - stageStart;
+
+        stageStart = GetCurrentTimeSeconds();
+        std::vector<MeshExtraction> extractions;
+        GatherSceneNode(extractions, root, matrixStack, jointIndexByNode);
+        timings.gatherSeconds = GetCurrentTimeSeconds() - stageStart;
+
+        stageStart = GetCurrentTimeSeconds();
         //Top contains just our change of basis and scale matrices at this point
-        ImportMotions(import, scene, matrixStack.GetTop(), nodeToJointIndex, 10);
+        Matrix4x4 importTransform = matrixStack.GetTop();
+        std::vector<AnimationMotion*> motions;
+        auto sampleMotions = [&]()
+        {
+            double motionStart = GetCurrentTimeSeconds();
+            SampleMotions(motions, scene, importTransform, import->skeletons, nodeToJointIndex, 10);
+            timings.motionSeconds = GetCurrentTimeSeconds() - motionStart;
+        };
+        std::thread motionThread;
+        if (numThreads > 1)
+        {
+            motionThread = std::thread(sampleMotions);
+        }
+        else
+        {
+            sampleMotions();
+        }
+        unsigned int numMeshThreads = numThreads > 1 ? numThreads - 1 : 1;
+
+        std::vector<std::function<void()>> tasks;
+        for (MeshExtraction& extraction : extractions)
+        {
+            if (extraction.hasSkinWeights)
+            {
+                tasks.push_back([&extraction]() { CalculateSkinWeights(extraction); });
+            }
+        }
+        RunTasks(tasks, numMeshThreads);
+
+        //Biggest meshes first so a large one doesn't start last and leave the other threads idle
+        std::vector<unsigned int> meshOrder(extractions.size());
+        for (unsigned int i = 0; i < meshOrder.size(); ++i)
+        {
+            meshOrder[i] = i;
+        }
+        std::sort(meshOrder.begin(), meshOrder.end(), [&extractions](unsigned int a, unsigned int b) { return extractions[a].polygonCount > extractions[b].polygonCount; });
+        import->meshes.resize(extractions.size());
+        tasks.clear();
+        for (unsigned int meshIndex : meshOrder)
+        {
+            tasks.push_back([&extractions, import, meshIndex]() { ExtractMeshVertices(extractions[meshIndex], import->meshes[meshIndex]); });
+        }
+        RunTasks(tasks, numMeshThreads);
+
+        if (motionThread.joinable())
+        {
+            motionThread.join();
+        }
+        import->motions.insert(import->motions.end(), motions.begin(), motions.end());
+        timings.extractionSeconds = GetCurrentTimeSeconds() - stageStart;
+
+        for (const MeshExtraction& extraction : extractions)
+        {
+            timings.skinWeightSeconds += extraction.skinWeightSeconds;
+            timings.vertexSeconds += extraction.vertexSeconds;
+        }
     }
 
     //-----------------------------------------------------------------------------------
@@ -926,8 +1059,10 @@ extern AnimationMotion* g_loadedMotion;
     }
 
     //-----------------------------------------------------------------------------------
-    SceneImport* FbxLoadSceneFromFile(const char* fbxFilename, const Matrix4x4& engineBasis, bool isEngineBasisRightHanded, const Matrix4x4& transform)
+    //The threaded extraction is unverified the same way fbxbench is: it type-checks against the SDK headers but hasn't run.
+    SceneImport* FbxLoadSceneFromFile(const char* fbxFilename, const Matrix4x4& engineBasis, bool isEngineBasisRightHanded, const Matrix4x4& transform, unsigned int numThreads /*= 0*/)
     {
+        double loadStart = GetCurrentTimeSeconds();
         FbxScene* scene = nullptr;
         FbxManager* fbxManager = FbxManager::Create();
         if (nullptr == fbxManager)
@@ -955,9 +1090,14 @@ extern AnimationMotion* g_loadedMotion;
         {
             Console::instance->PrintLine(Stringf("Could not import scene: %s", fbxFilename));
             DebuggerPrintf("Could not import scene: %s", fbxFilename);
+            FBX_SAFE_DESTROY(importer);
+            FBX_SAFE_DESTROY(ioSettings);
+            FBX_SAFE_DESTROY(fbxManager);
+            return nullptr;
         }
 
         SceneImport* import = new SceneImport();
+        import->timings.loadSeconds = GetCurrentTimeSeconds() - loadStart;
         MatrixStack4x4 matrixStack;
 
         matrixStack.Push(transform);
@@ -974,20 +1114,246 @@ extern AnimationMotion* g_loadedMotion;
 
         matrixStack.Push(sceneBasis);
 
-        ImportScene(import, scene, matrixStack);
+        if (numThreads == 0)
+        {
+            numThreads = Max(1u, std::thread::hardware_concurrency());
+        }
+        ImportScene(import, scene, matrixStack, numThreads);
 
         FBX_SAFE_DESTROY(importer);
         FBX_SAFE_DESTROY(ioSettings);
         FBX_SAFE_DESTROY(scene);
         FBX_SAFE_DESTROY(fbxManager);
 
+        import->timings.totalSeconds = GetCurrentTimeSeconds() - loadStart;
         return import;
     }
 
+    //-----------------------------------------------------------------------------------
+    //Character-like scene built with the SDK: a chain of joints with rotation curves, and skinned meshes
+    //of unshared triangles with normals (by control point) and UVs (indexed, by polygon vertex).
+    static FbxScene* CreateSyntheticScene(FbxManager* fbxManager, int numMeshes, int trianglesPerMesh, int numJoints, float seconds)
+    {
+        FbxScene* scene = FbxScene::Create(fbxManager, "SyntheticScene");
+        FbxNode* root = scene->GetRootNode();
+
+        std::vector<FbxNode*> jointNodes;
+        FbxNode* parent = root;
+        for (int jointIndex = 0; jointIndex < numJoints; ++jointIndex)
+        {
+            FbxSkeleton* skeleton = FbxSkeleton::Create(scene, Stringf("joint%i", jointIndex).c_str());
+            skeleton->SetSkeletonType(jointIndex == 0 ? FbxSkeleton::eRoot : FbxSkeleton::eLimbNode);
+            FbxNode* jointNode = FbxNode::Create(scene, Stringf("joint%i", jointIndex).c_str());
+            jointNode->SetNodeAttribute(skeleton);
+            jointNode->LclTranslation.Set(FbxDouble3(0.0, jointIndex == 0 ? 0.0 : 1.0, 0.0));
+            parent->AddChild(jointNode);
+            jointNodes.push_back(jointNode);
+            parent = jointNode;
+        }
+
+        FbxAnimStack* animStack = FbxAnimStack::Create(scene, "SyntheticMotion");
+        FbxAnimLayer* animLayer = FbxAnimLayer::Create(scene, "Base");
+        animStack->AddMember(animLayer);
+        FbxTime endTime;
+        endTime.SetSecondDouble(seconds);
+        animStack->LocalStart.Set(FbxTime(0));
+        animStack->LocalStop.Set(endTime);
+        for (int jointIndex = 0; jointIndex < numJoints; ++jointIndex)
+        {
+            FbxAnimCurve* curve = jointNodes[jointIndex]->LclRotation.GetCurve(animLayer, FBXSDK_CURVENODE_COMPONENT_Z, true);
+            curve->KeyModifyBegin();
+            for (int second = 0; second <= (int)seconds; ++second)
+            {
+                FbxTime keyTime;
+                keyTime.SetSecondDouble((double)second);
+                int keyIndex = curve->KeyAdd(keyTime);
+                curve->KeySetValue(keyIndex, (float)(((second + jointIndex) % 4) * 10 - 15));
+                curve->KeySetInterpolation(keyIndex, FbxAnimCurveDef::eInterpolationLinear);
+            }
+            curve->KeyModifyEnd();
+        }
+
+        for (int meshIndex = 0; meshIndex < numMeshes; ++meshIndex)
+        {
+            FbxMesh* mesh = FbxMesh::Create(scene, Stringf("mesh%i", meshIndex).c_str());
+            int numControlPoints = trianglesPerMesh * 3;
+            mesh->InitControlPoints(numControlPoints);
+            FbxGeometryElementNormal* normals = mesh->CreateElementNormal();
+            normals->SetMappingMode(FbxGeometryElement::eByControlPoint);
+            normals->SetReferenceMode(FbxGeometryElement::eDirect);
+            FbxGeometryElementUV* uvs = mesh->CreateElementUV("UVSet");
+            uvs->SetMappingMode(FbxGeometryElement::eByPolygonVertex);
+            uvs->SetReferenceMode(FbxGeometryElement::eIndexToDirect);
+            uvs->GetDirectArray().Add(FbxVector2(0.0, 0.0));
+            uvs->GetDirectArray().Add(FbxVector2(1.0, 0.0));
+            uvs->GetDirectArray().Add(FbxVector2(0.0, 1.0));
+
+            for (int triangleIndex = 0; triangleIndex < trianglesPerMesh; ++triangleIndex)
+            {
+                double x = (double)(triangleIndex % 100);
+                double y = (double)(triangleIndex / 100) * ((double)numJoints / (double)(trianglesPerMesh / 100 + 1));
+                int firstControlPoint = triangleIndex * 3;
+                mesh->SetControlPointAt(FbxVector4(x, y, (double)meshIndex), firstControlPoint);
+                mesh->SetControlPointAt(FbxVector4(x + 1.0, y, (double)meshIndex), firstControlPoint + 1);
+                mesh->SetControlPointAt(FbxVector4(x, y + 1.0, (double)meshIndex), firstControlPoint + 2);
+                mesh->BeginPolygon();
+                for (int vertIndex = 0; vertIndex < 3; ++vertIndex)
+                {
+                    mesh->AddPolygon(firstControlPoint + vertIndex);
+                    normals->GetDirectArray().Add(FbxVector4(0.0, 0.0, -1.0));
+                    uvs->GetIndexArray().Add(vertIndex);
+                }
+                mesh->EndPolygon();
+            }
+
+            //Every vertex is split between the two joints nearest to its height
+            FbxSkin* skin = FbxSkin::Create(scene, "");
+            std::vector<FbxCluster*> clusters;
+            for (int jointIndex = 0; jointIndex < numJoints; ++jointIndex)
+            {
+                FbxCluster* cluster = FbxCluster::Create(scene, "");
+                cluster->SetLink(jointNodes[jointIndex]);
+                cluster->SetLinkMode(FbxCluster::eNormalize);
+                clusters.push_back(cluster);
+            }
+            for (int controlIndex = 0; controlIndex < numControlPoints; ++controlIndex)
+            {
+                double height = mesh->GetControlPointAt(controlIndex).mData[1];
+                int lowerJoint = Clamp((int)height, 0, numJoints - 1);
+                int upperJoint = Min(lowerJoint + 1, numJoints - 1);
+                double upperWeight = Clamp(height - (double)lowerJoint, 0.0, 1.0);
+                clusters[lowerJoint]->AddControlPointIndex(controlIndex, 1.0 - upperWeight);
+                if (upperJoint != lowerJoint)
+                {
+                    clusters[upperJoint]->AddControlPointIndex(controlIndex, upperWeight);
+                }
+            }
+            for (FbxCluster* cluster : clusters)
+            {
+                skin->AddCluster(cluster);
+            }
+            mesh->AddDeformer(skin);
+
+            FbxNode* meshNode = FbxNode::Create(scene, Stringf("meshNode%i", meshIndex).c_str());
+            meshNode->SetNodeAttribute(mesh);
+            meshNode->AddMaterial(FbxSurfacePhong::Create(scene, Stringf("material%i", meshIndex).c_str()));
+            root->AddChild(meshNode);
+        }
+        return scene;
+    }
+
+    //-----------------------------------------------------------------------------------
+    static bool ImportsMatch(const SceneImport* first, const SceneImport* second)
+    {
+        if (first->meshes.size() != second->meshes.size() || first->motions.size() != second->motions.size())
+        {
+            return false;
+        }
+        for (unsigned int i = 0; i < first->meshes.size(); ++i)
+        {
+            const std::vector<Vertex_Master>& firstVertices = first->meshes[i].m_vertices;
+            const std::vector<Vertex_Master>& secondVertices = second->meshes[i].m_vertices;
+            if (firstVertices.size() != secondVertices.size()
+                || memcmp(firstVertices.data(), secondVertices.data(), firstVertices.size() * sizeof(Vertex_Master)) != 0)
+            {
+                return false;
+            }
+        }
+        for (unsigned int i = 0; i < first->motions.size(); ++i)
+        {
+            AnimationMotion* firstMotion = first->motions[i];
+            AnimationMotion* secondMotion = second->motions[i];
+            if (firstMotion->m_frameCount != secondMotion->m_frameCount || firstMotion->m_jointCount != secondMotion->m_jointCount)
+            {
+                return false;
+            }
+            for (int jointIndex = 0; jointIndex < firstMotion->m_jointCount; ++jointIndex)
+            {
+                if (memcmp(firstMotion->GetJointKeyframes(jointIndex), secondMotion->GetJointKeyframes(jointIndex), firstMotion->m_frameCount * sizeof(Matrix4x4)) != 0)
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    //-----------------------------------------------------------------------------------
+    static void DeleteImport(SceneImport* import)
+    {
+        for (Skeleton* skeleton : import->skeletons)
+        {
+            delete skeleton;
+        }
+        for (AnimationMotion* motion : import->motions)
+        {
+            delete motion;
+        }
+        delete import;
+    }
+
+    //-----------------------------------------------------------------------------------
+    //Writes a synthetic character to disk, imports it on one thread and then on every thread, and checks both imports match.
+    //UNVERIFIED: only type-checked against the SDK headers, it has never been built against the SDK libraries or run.
+    //Neither the synthetic scene export, the parallel import nor the match check have been seen working yet.
+    CONSOLE_COMMAND(fbxbench)
+    {
+        Console::instance->PrintLine("Warning: fbxBench hasn't been verified against a real SDK build yet, treat its results with suspicion", RGBA::YELLOW);
+        if (!(args.HasArgs(0) || args.HasArgs(4)))
+        {
+            Console::instance->PrintLine("fbxBench <numMeshes> <trianglesPerMesh> <numJoints> <seconds>", RGBA::RED);
+            return;
+        }
+        int numMeshes = args.HasArgs(4) ? args.GetIntArgument(0) : 8;
+        int trianglesPerMesh = args.HasArgs(4) ? args.GetIntArgument(1) : 20000;
+        int numJoints = args.HasArgs(4) ? args.GetIntArgument(2) : 64;
+        float seconds = args.HasArgs(4) ? args.GetFloatArgument(3) : 10.0f;
+        if (numMeshes <= 0 || trianglesPerMesh <= 0 || numJoints <= 0 || seconds <= 0.0f)
+        {
+            Console::instance->PrintLine("Counts must be positive", RGBA::RED);
+            return;
+        }
+
+        const char* benchFilename = "fbxbench.fbx";
+        FbxManager* fbxManager = FbxManager::Create();
+        FbxIOSettings* ioSettings = FbxIOSettings::Create(fbxManager, IOSROOT);
+        fbxManager->SetIOSettings(ioSettings);
+        FbxScene* scene = CreateSyntheticScene(fbxManager, numMeshes, trianglesPerMesh, numJoints, seconds);
+        FbxExporter* exporter = FbxExporter::Create(fbxManager, "");
+        bool exported = exporter->Initialize(benchFilename, -1, fbxManager->GetIOSettings()) && exporter->Export(scene);
+        FBX_SAFE_DESTROY(exporter);
+        FBX_SAFE_DESTROY(scene);
+        FBX_SAFE_DESTROY(ioSettings);
+        FBX_SAFE_DESTROY(fbxManager);
+        if (!exported)
+        {
+            Console::instance->PrintLine("Couldn't write the synthetic scene", RGBA::RED);
+            return;
+        }
+
+        SceneImport* serialImport = FbxLoadSceneFromFile(benchFilename, Matrix4x4::IDENTITY, false, Matrix4x4::IDENTITY, 1);
+        SceneImport* parallelImport = FbxLoadSceneFromFile(benchFilename, Matrix4x4::IDENTITY, false, Matrix4x4::IDENTITY, 0);
+        if (!serialImport || !parallelImport)
+        {
+            Console::instance->PrintLine("Couldn't import the synthetic scene", RGBA::RED);
+            return;
+        }
+        PrintImportTimings(serialImport->timings);
+        PrintImportTimings(parallelImport->timings);
+        bool matches = ImportsMatch(serialImport, parallelImport);
+        Console::instance->PrintLine(Stringf("%i meshes x %i triangles, %i joints, %.1fs of motion: serial %.1fms, parallel %.1fms (%.2fx), results %s",
+            numMeshes, trianglesPerMesh, numJoints, seconds, serialImport->timings.totalSeconds * 1000.0, parallelImport->timings.totalSeconds * 1000.0,
+            serialImport->timings.totalSeconds / parallelImport->timings.totalSeconds, matches ? "match" : "DIFFER"), matches ? RGBA::GREEN : RGBA::RED);
+
+        DeleteImport(serialImport);
+        DeleteImport(parallelImport);
+        remove(benchFilename);
+    }
+
 
 #else
 
     void FbxListScene(const char*) {};
-    SceneImport* FbxLoadSceneFromFile(const char*, const Matrix4x4&, bool, const Matrix4x4&) { return nullptr; };
+    SceneImport* FbxLoadSceneFromFile(const char*, const Matrix4x4&, bool, const Matrix4x4&, unsigned int) { return nullptr; };
 
 #endif
@@ -9,17 +9,36 @@ class Matrix4x4;
 class Skeleton;
 class AnimationMotion;
 
+//Seconds spent in each stage of FbxLoadSceneFromFile. Skin weight, vertex and motion times are summed over their tasks,
+//extractionSeconds is the wall time of the stage those tasks run in.
+struct FbxImportTimings
+{
+	FbxImportTimings() : loadSeconds(0.0), triangulateSeconds(0.0), skeletonSeconds(0.0), gatherSeconds(0.0), skinWeightSeconds(0.0)
+		, vertexSeconds(0.0), motionSeconds(0.0), extractionSeconds(0.0), totalSeconds(0.0), numThreads(0) {};
+	double loadSeconds;
+	double triangulateSeconds;
+	double skeletonSeconds;
+	double gatherSeconds;
+	double skinWeightSeconds;
+	double vertexSeconds;
+	double motionSeconds;
+	double extractionSeconds;
+	double totalSeconds;
+	unsigned int numThreads;
+};
+
 class SceneImport
 {
 public:
 	std::vector<MeshBuilder> meshes;
 	std::vector<Skeleton*> skeletons;
 	std::vector<AnimationMotion*> motions;
+	FbxImportTimings timings;
 };
 
 //STANDALONE FUNCTIONS//////////////////////////////////////////////////////////////////////////
 void FbxListScene(const char* filename);
-SceneImport* FbxLoadSceneFromFile(const char* fbxFilename, const Matrix4x4& engineBasis, bool isEngineBasisRightHanded, const Matrix4x4& transform);
+SceneImport* FbxLoadSceneFromFile(const char* fbxFilename, const Matrix4x4& engineBasis, bool isEngineBasisRightHanded, const Matrix4x4& transform, unsigned int numThreads = 0);
 
 extern std::queue<Mesh*> g_loadedMeshes;
 
@@ -0,0 +1,91 @@
+//-----------------------------------------------------------------------------------
+//Command line front end for the NetSoak benchmark. Runs the whole net stack over a simulated network with no window, renderer or console.
+//  NetSoak [-clients N] [-seconds S] [-mix rou] [-perTick N] [-bytes min max] [-seed N] [-latency ms] [-jitter ms] [-loss percent]
+//
+//mix is any of r (reliable), o (in order) and u (unreliable). Links the engine for the net stack, build with TRACK_MEMORY
+//in BuildConfig.hpp for allocation counts (Windows only). Every link is a loopback transport over a NetSimulator, so no sockets
+//are opened and the socket library is never started. Returns 2 if any reliable or in-order message never arrived.
+#include "Engine/Tools/NetSoak.hpp"
+#include "Engine/Net/UDPIP/NetSession.hpp"
+#include "Engine/Core/Events/Event.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//The game owns these and fires them from its loop, the soak updates its sessions itself
+Event<float> NetworkUpdate;
+Event<> NetworkCleanup;
+
+//-----------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    NetSoak::Settings settings;
+    const char* mix = "rou";
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "-clients") == 0 && i + 1 < argc)
+        {
+            settings.numClients = (unsigned int)atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-seconds") == 0 && i + 1 < argc)
+        {
+            settings.measuredMs = (unsigned int)(atof(argv[++i]) * 1000.0);
+        }
+        else if (strcmp(argv[i], "-mix") == 0 && i + 1 < argc)
+        {
+            mix = argv[++i];
+        }
+        else if (strcmp(argv[i], "-perTick") == 0 && i + 1 < argc)
+        {
+            settings.messagesPerTick = (unsigned int)atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-bytes") == 0 && i + 2 < argc)
+        {
+            settings.minPayloadBytes = (unsigned int)atoi(argv[++i]);
+            settings.maxPayloadBytes = (unsigned int)atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-seed") == 0 && i + 1 < argc)
+        {
+            settings.seed = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "-latency") == 0 && i + 1 < argc)
+        {
+            settings.link.minLatencyMs = (unsigned int)atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-jitter") == 0 && i + 1 < argc)
+        {
+            settings.link.jitterMs = (unsigned int)atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-loss") == 0 && i + 1 < argc)
+        {
+            settings.link.lossRate = (float)atof(argv[++i]) / 100.0f;
+        }
+        else
+        {
+            printf("Unknown argument '%s'\n", argv[i]);
+            printf("Usage: NetSoak [-clients N] [-seconds S] [-mix rou] [-perTick N] [-bytes min max] [-seed N] [-latency ms] [-jitter ms] [-loss percent]\n");
+            return 1;
+        }
+    }
+    settings.isKindEnabled[NetSoak::RELIABLE] = strchr(mix, 'r') != nullptr;
+    settings.isKindEnabled[NetSoak::IN_ORDER] = strchr(mix, 'o') != nullptr;
+    settings.isKindEnabled[NetSoak::UNRELIABLE] = strchr(mix, 'u') != nullptr;
+
+    NetSoak soak(settings);
+    if (!soak.AreSettingsValid())
+    {
+        printf("Bad settings: needs 1 to %u clients, at least %ums, and payloads of at most %u bytes with min <= max\n",
+            NetSession::MAX_CONNECTIONS - 1, NetSoak::TICK_MS, (unsigned int)(MESSAGE_MTU - sizeof(uint32_t)));
+        return 1;
+    }
+
+    printf("%u clients, %.1fs, mix %s, %u per kind per tick each way, %u-%uB payloads, %ums + %ums jitter, %.0f%% loss, seed %u\n",
+        settings.numClients, (float)settings.measuredMs / 1000.0f, mix, settings.messagesPerTick, settings.minPayloadBytes, settings.maxPayloadBytes,
+        settings.link.minLatencyMs, settings.link.jitterMs, settings.link.lossRate * 100.0f, settings.seed);
+    NetSoak::Report report = soak.Run();
+    soak.PrintReport(report);
+    bool isReliableComplete = report.numDelivered[NetSoak::RELIABLE] == report.numSent[NetSoak::RELIABLE]
+        && report.numDelivered[NetSoak::IN_ORDER] == report.numSent[NetSoak::IN_ORDER];
+
+    return isReliableComplete ? 0 : 2;
+}
@@ -0,0 +1,116 @@
+//-----------------------------------------------------------------------------------
+//Command line runner for the UDP session tests in NetTests.hpp, with each test's console defaults. No window, renderer or console.
+//  NetTests [test ...]
+//
+//Runs every test when none are named. Returns 1 if any check failed, so ctest can run one test per entry. compressbench and
+//compresscorpus only run when named, from the NetTests folder: they read and write the corpus in Data.
+#include "Engine/Net/UDPIP/NetTests.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/Events/Event.hpp"
+#include <stdio.h>
+#include <string.h>
+
+static const char* COMPRESS_RECORDING_PATH = "Data/SnapshotTraffic.rec";
+static const char* COMPRESS_DICTIONARY_PATH = "Data/SnapshotTraffic.dict";
+
+//The game owns these and fires them from its loop, the tests update their sessions themselves
+Event<float> NetworkUpdate;
+Event<> NetworkCleanup;
+
+//-----------------------------------------------------------------------------------
+static void PrintNetTestLine(const std::string& line, const RGBA& color)
+{
+    UNUSED(color);
+    printf("%s\n", line.c_str());
+    fflush(stdout);
+}
+
+//-----------------------------------------------------------------------------------
+static bool RunReliableTestDefaults() { return RunReliableTest(8, 1, &PrintNetTestLine); }
+static bool RunInOrderTestDefaults() { return RunInOrderTest(8, 1, &PrintNetTestLine); }
+static bool RunRoundTripTestDefaults() { return RunRoundTripTests(&PrintNetTestLine); }
+static bool RunCongestionTestDefaults() { return RunCongestionTest(32.0f * 1024.0f, 30, &PrintNetTestLine); }
+static bool RunPriorityTestDefaults() { return RunPriorityTest(32.0f * 1024.0f, 30, &PrintNetTestLine); }
+static bool RunFragmentTestDefaults() { return RunFragmentTest(8, 1, &PrintNetTestLine); }
+static bool RunCompressedLinkTestDefaults() { return RunCompressedLinkTest(4, 1, &PrintNetTestLine); }
+static bool RunNetSimTestDefaults() { return RunNetSimTest(4, 1, &PrintNetTestLine); }
+static bool RunStallTestDefaults() { return RunStallTest(5.0, 200.0, 10000, &PrintNetTestLine); }
+static bool RunSnapshotTestDefaults() { return RunSnapshotTest(600, 1, &PrintNetTestLine); }
+static bool RunInterestTestDefaults() { return RunInterestTest(6, 1, &PrintNetTestLine); }
+static bool RunCompressorTestDefaults() { return RunCompressorTest(2000, 1, &PrintNetTestLine); }
+static bool RunCompressorBenchmarkDefaults() { return RunCompressorBenchmark(COMPRESS_RECORDING_PATH, COMPRESS_DICTIONARY_PATH, &PrintNetTestLine); }
+static bool WriteCompressorCorpusDefaults() { return WriteCompressorCorpus(COMPRESS_RECORDING_PATH, COMPRESS_DICTIONARY_PATH, &PrintNetTestLine); }
+
+//-----------------------------------------------------------------------------------
+struct NetTestEntry
+{
+    const char* name; //Same as the console command
+    bool(*function)();
+    bool isRunByDefault;
+};
+
+static const NetTestEntry NET_TESTS[] =
+{
+    { "reliabletest", &RunReliableTestDefaults, true },
+    { "inordertest", &RunInOrderTestDefaults, true },
+    { "rtttest", &RunRoundTripTestDefaults, true },
+    { "congestiontest", &RunCongestionTestDefaults, true },
+    { "prioritytest", &RunPriorityTestDefaults, true },
+    { "fragmenttest", &RunFragmentTestDefaults, true },
+    { "compressedlinktest", &RunCompressedLinkTestDefaults, true },
+    { "netsimtest", &RunNetSimTestDefaults, true },
+    { "netstalltest", &RunStallTestDefaults, true },
+    { "snapshottest", &RunSnapshotTestDefaults, true },
+    { "interesttest", &RunInterestTestDefaults, true },
+    { "compresstest", &RunCompressorTestDefaults, true },
+    { "compressbench", &RunCompressorBenchmarkDefaults, false },
+    { "compresscorpus", &WriteCompressorCorpusDefaults, false },
+};
+static const int NUM_NET_TESTS = sizeof(NET_TESTS) / sizeof(NET_TESTS[0]);
+
+//-----------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        bool isKnown = false;
+        for (int testIndex = 0; testIndex < NUM_NET_TESTS; ++testIndex)
+        {
+            isKnown = isKnown || strcmp(argv[i], NET_TESTS[testIndex].name) == 0;
+        }
+        if (!isKnown)
+        {
+            printf("Unknown test '%s'. Tests:", argv[i]);
+            for (int testIndex = 0; testIndex < NUM_NET_TESTS; ++testIndex)
+            {
+                printf(" %s", NET_TESTS[testIndex].name);
+            }
+            printf("\n");
+            return 1;
+        }
+    }
+
+    int numFailed = 0;
+    int numRun = 0;
+    for (int testIndex = 0; testIndex < NUM_NET_TESTS; ++testIndex)
+    {
+        bool isSelected = (argc == 1) && NET_TESTS[testIndex].isRunByDefault;
+        for (int i = 1; i < argc; ++i)
+        {
+            isSelected = isSelected || strcmp(argv[i], NET_TESTS[testIndex].name) == 0;
+        }
+        if (!isSelected)
+        {
+            continue;
+        }
+        printf("== %s\n", NET_TESTS[testIndex].name);
+        fflush(stdout);
+        ++numRun;
+        if (!NET_TESTS[testIndex].function())
+        {
+            ++numFailed;
+        }
+    }
+    printf("%i/%i tests passed\n", numRun - numFailed, numRun);
+    return numFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,156 @@
+//-----------------------------------------------------------------------------------
+//Command line UDP loopback throughput benchmark. Pushes packets between two loopback sockets one per call, then in batches.
+//  UDPBench [-seconds S] [-batch N] [-bytes N]
+//
+//Batched calls are recvmmsg/sendmmsg on Linux and a recvfrom/sendto loop elsewhere. Links the engine for UDPSocket only.
+#include "Engine/Net/UDPIP/UDPSocket.hpp"
+#include "Engine/Time/Time.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//-----------------------------------------------------------------------------------
+struct LoopbackThroughput
+{
+    size_t numSent;
+    size_t numReceived;
+    size_t numCalls;
+    double seconds;
+};
+
+//-----------------------------------------------------------------------------------
+//Pushes packets from one socket to another over loopback in batches of batchSize, draining the receiver after every send.
+static LoopbackThroughput MeasureLoopbackThroughput(UDPSocket& sender, UDPSocket& receiver, size_t batchSize, size_t packetSize, double seconds)
+{
+    std::vector<unsigned char> sendBuffer(packetSize, 0xAB);
+    std::vector<unsigned char> receiveBuffers(UDPTransport::MAX_BATCH_SIZE * PACKET_MTU);
+    UDPDatagram sends[UDPTransport::MAX_BATCH_SIZE];
+    UDPDatagram receives[UDPTransport::MAX_BATCH_SIZE];
+    for (size_t i = 0; i < UDPTransport::MAX_BATCH_SIZE; ++i)
+    {
+        sends[i].address = receiver.GetAddress();
+        sends[i].buffer = sendBuffer.data();
+        sends[i].size = packetSize;
+        receives[i].buffer = &receiveBuffers[i * PACKET_MTU];
+    }
+
+    LoopbackThroughput result;
+    result.numSent = 0;
+    result.numReceived = 0;
+    result.numCalls = 0;
+    double startTime = GetCurrentTimeSeconds();
+    double endTime = startTime + seconds;
+    double currentTime = startTime;
+    while (currentTime < endTime)
+    {
+        for (int i = 0; i < 64; ++i)
+        {
+            result.numSent += sender.SendBatch(sends, batchSize);
+            ++result.numCalls;
+            size_t numReceived = 0;
+            do
+            {
+                numReceived = receiver.ReceiveBatch(receives, batchSize);
+                result.numReceived += numReceived;
+                ++result.numCalls;
+            } while (numReceived == batchSize);
+        }
+        currentTime = GetCurrentTimeSeconds();
+    }
+    result.seconds = currentTime - startTime;
+
+    //Anything still in flight counts as received once it lands
+    size_t numReceived = 0;
+    do
+    {
+        numReceived = receiver.ReceiveBatch(receives, UDPTransport::MAX_BATCH_SIZE);
+        result.numReceived += numReceived;
+    } while (numReceived > 0);
+    return result;
+}
+
+//-----------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    double seconds = 2.0;
+    size_t batchSize = 32;
+    size_t packetSize = 256;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "-seconds") == 0 && i + 1 < argc)
+        {
+            seconds = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-batch") == 0 && i + 1 < argc)
+        {
+            batchSize = (size_t)Clamp<int>(atoi(argv[++i]), 1, (int)UDPTransport::MAX_BATCH_SIZE);
+        }
+        else if (strcmp(argv[i], "-bytes") == 0 && i + 1 < argc)
+        {
+            packetSize = (size_t)Clamp<int>(atoi(argv[++i]), 1, PACKET_MTU);
+        }
+        else
+        {
+            printf("Unknown argument '%s'\n", argv[i]);
+            printf("Usage: UDPBench [-seconds S] [-batch N] [-bytes N]\n");
+            return 1;
+        }
+    }
+
+#if defined(_WIN32)
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+    {
+        printf("Couldn't start WinSock\n");
+        return 1;
+    }
+#endif
+
+    int exitCode = 0;
+    {
+        UDPSocket sender;
+        UDPSocket receiver;
+        sender.Bind("127.0.0.1", "4390");
+        receiver.Bind("127.0.0.1", "4400");
+        if (!sender.IsBound() || !receiver.IsBound())
+        {
+            printf("Couldn't bind two loopback sockets\n");
+            exitCode = 1;
+        }
+        else
+        {
+#if defined(__linux__)
+            const char* backendName = "recvmmsg/sendmmsg";
+#else
+            const char* backendName = "recvfrom/sendto loop";
+#endif
+            printf("UDP loopback throughput, %i byte packets, %s backend\n", (int)packetSize, backendName);
+
+            LoopbackThroughput single = MeasureLoopbackThroughput(sender, receiver, 1, packetSize, seconds * 0.5);
+            LoopbackThroughput batched = MeasureLoopbackThroughput(sender, receiver, batchSize, packetSize, seconds * 0.5);
+            LoopbackThroughput* results[2] = { &single, &batched };
+            size_t batchSizes[2] = { 1, batchSize };
+            for (int i = 0; i < 2; ++i)
+            {
+                LoopbackThroughput& result = *results[i];
+                double packetsPerSecond = (double)result.numReceived / result.seconds;
+                printf("  batch %2i: %9.0f packets/s  %7.1f MB/s  %.3f calls/packet  lost %i/%i\n",
+                    (int)batchSizes[i],
+                    packetsPerSecond,
+                    (packetsPerSecond * packetSize) / (1024.0 * 1024.0),
+                    (double)result.numCalls / (double)Max<size_t>(result.numReceived, 1),
+                    (int)(result.numSent - result.numReceived),
+                    (int)result.numSent);
+            }
+            double speedup = ((double)batched.numReceived / batched.seconds) / Max<double>((double)single.numReceived / single.seconds, 1.0);
+            printf("  Batched speedup: %.2fx\n", speedup);
+        }
+    }
+
+#if defined(_WIN32)
+    WSACleanup();
+#endif
+    return exitCode;
+}